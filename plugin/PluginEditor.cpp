@@ -254,7 +254,7 @@ void FT2PluginEditor::processDiskOpRequests()
     if (inst == nullptr)
         return;
 
-    auto& diskop = inst->diskop;
+    auto& diskop = *inst->diskop;
 
     // Handle drop load request FIRST (works regardless of disk op screen visibility)
     if (diskop.requestDropLoad)
@@ -263,11 +263,12 @@ void FT2PluginEditor::processDiskOpRequests()
         juce::File file(diskop.pendingDropPath);
         if (file.exists())
         {
-            juce::MemoryBlock fileData;
-            if (file.loadFileAsData(fileData))
+            // Memory-mapped: the loader decodes samples straight from the file pages
+            FT2MappedFile fileData(file);
+            if (fileData.isValid())
             {
-                const uint8_t* data = static_cast<const uint8_t*>(fileData.getData());
-                uint32_t dataSize = static_cast<uint32_t>(fileData.getSize());
+                const uint8_t* data = fileData.getData();
+                uint32_t dataSize = fileData.getSize();
                 if (ft2_load_module(inst, data, dataSize))
                 {
                     inst->replayer.song.isModified = false;
@@ -480,7 +481,7 @@ void FT2PluginEditor::deleteDiskOpFile()
     if (instPtr == nullptr)
         return;
 
-    auto& diskop = instPtr->diskop;
+    auto& diskop = *instPtr->diskop;
     int32_t idx = diskop.selectedEntry + diskop.dirPos;
 
     if (diskop.entries == nullptr || idx < 0 || idx >= diskop.fileCount)
@@ -508,8 +509,8 @@ void FT2PluginEditor::deleteDiskOpFile()
                     ft2_instance_t* inst = audioProcessor.getInstance();
                     if (inst)
                     {
-                        inst->diskop.requestReadDir = true;
-                        inst->diskop.selectedEntry = -1;
+                        inst->diskop->requestReadDir = true;
+                        inst->diskop->selectedEntry = -1;
                     }
                 }
             })
@@ -523,7 +524,7 @@ void FT2PluginEditor::renameDiskOpFile()
     if (instPtr == nullptr)
         return;
 
-    auto& diskop = instPtr->diskop;
+    auto& diskop = *instPtr->diskop;
     int32_t idx = diskop.selectedEntry + diskop.dirPos;
 
     if (diskop.entries == nullptr || idx < 0 || idx >= diskop.fileCount)
@@ -555,7 +556,7 @@ void FT2PluginEditor::renameDiskOpFile()
 
                         ft2_instance_t* inst = audioProcessor.getInstance();
                         if (inst)
-                            inst->diskop.requestReadDir = true;
+                            inst->diskop->requestReadDir = true;
                     }
                 }
                 delete aw;
@@ -570,7 +571,7 @@ void FT2PluginEditor::makeDiskOpDirectory()
     if (inst == nullptr)
         return;
 
-    auto& diskop = inst->diskop;
+    auto& diskop = *inst->diskop;
 
     // Use directory name from FT2 dialog
     juce::String dirName(diskop.newDirName);
@@ -611,7 +612,7 @@ void FT2PluginEditor::saveDiskOpFile()
     if (inst == nullptr)
         return;
 
-    auto& diskop = inst->diskop;
+    auto& diskop = *inst->diskop;
 
     // Get filename from textbox, add extension if needed
     juce::String filename(diskop.filename);
@@ -671,8 +672,8 @@ void FT2PluginEditor::saveDiskOpFile()
             [inst](int result) {
                 if (result == 1) // Yes
                 {
-                    inst->diskop.requestSaveConfirmed = true;
-                    inst->diskop.requestSave = true;
+                    inst->diskop->requestSaveConfirmed = true;
+                    inst->diskop->requestSave = true;
                 }
             });
         return;
@@ -749,16 +750,17 @@ void FT2PluginEditor::loadDiskOpFile(const juce::File& file)
     if (inst == nullptr)
         return;
 
-    juce::MemoryBlock fileData;
-    if (!file.loadFileAsData(fileData))
+    // Memory-mapped: loaders read straight from the file pages, no intermediate copy
+    FT2MappedFile fileData(file);
+    if (!fileData.isValid())
         return;
 
-    const uint8_t* data = static_cast<const uint8_t*>(fileData.getData());
-    uint32_t dataSize = static_cast<uint32_t>(fileData.getSize());
+    const uint8_t* data = fileData.getData();
+    uint32_t dataSize = fileData.getSize();
 
     bool success = false;
 
-    switch (inst->diskop.itemType)
+    switch (inst->diskop->itemType)
     {
         case FT2_DISKOP_ITEM_MODULE:
             success = ft2_load_module(inst, data, dataSize);
@@ -838,7 +840,7 @@ void FT2PluginEditor::readDiskOpDirectory()
     if (inst == nullptr)
         return;
 
-    auto& diskop = inst->diskop;
+    auto& diskop = *inst->diskop;
     juce::File currentDir(diskop.currentPath);
 
     // Free existing entries
@@ -1189,13 +1191,13 @@ void FT2PluginEditor::filesDropped(const juce::StringArray& files, int x, int y)
         return;
     }
     
-    // Read file into memory for non-module formats
-    juce::MemoryBlock fileData;
-    if (!file.loadFileAsData(fileData))
+    // Map file for non-module formats
+    FT2MappedFile fileData(file);
+    if (!fileData.isValid())
         return;
     
-    const uint8_t* data = static_cast<const uint8_t*>(fileData.getData());
-    uint32_t dataSize = static_cast<uint32_t>(fileData.getSize());
+    const uint8_t* data = fileData.getData();
+    uint32_t dataSize = fileData.getSize();
     
     // XI Instrument format
     if (ext == ".xi")
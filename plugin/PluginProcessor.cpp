@@ -9,8 +9,10 @@ extern "C" {
 #include "../src/plugin/ft2_plugin_replayer.h"
 #include "../src/plugin/ft2_plugin_timemap.h"
 #include "../src/plugin/ft2_plugin_diskop.h"
+#include "../src/plugin/ft2_plugin_state_codec.h"
 #include "../src/plugin/ft2_plugin_loader.h"
 #include "../src/plugin/ft2_plugin_palette.h"
+#include "../src/plugin/ft2_plugin_sample_undo.h"
 }
 #if defined(_WIN32)
 #pragma pack(pop)
@@ -41,19 +43,19 @@ FT2PluginProcessor::FT2PluginProcessor()
     
     // Initialize disk op to home directory
     juce::File homeDir = juce::File::getSpecialLocation(juce::File::userHomeDirectory);
-    strncpy(instance->diskop.currentPath, homeDir.getFullPathName().toRawUTF8(), FT2_PATH_MAX - 1);
-    instance->diskop.currentPath[FT2_PATH_MAX - 1] = '\0';
+    strncpy(instance->diskop->currentPath, homeDir.getFullPathName().toRawUTF8(), FT2_PATH_MAX - 1);
+    instance->diskop->currentPath[FT2_PATH_MAX - 1] = '\0';
     
 #ifdef _WIN32
     // Initialize drive enumeration at startup (Windows only)
     juce::Array<juce::File> roots;
     juce::File::findFileSystemRoots(roots);
-    instance->diskop.numDrives = juce::jmin((int)roots.size(), (int)FT2_DISKOP_MAX_DRIVES);
-    for (int i = 0; i < instance->diskop.numDrives; i++)
+    instance->diskop->numDrives = juce::jmin((int)roots.size(), (int)FT2_DISKOP_MAX_DRIVES);
+    for (int i = 0; i < instance->diskop->numDrives; i++)
     {
         juce::String driveName = roots[i].getFullPathName();
-        strncpy(instance->diskop.driveNames[i], driveName.toRawUTF8(), 3);
-        instance->diskop.driveNames[i][3] = '\0';
+        strncpy(instance->diskop->driveNames[i], driveName.toRawUTF8(), 3);
+        instance->diskop->driveNames[i][3] = '\0';
     }
 #endif
     
@@ -168,6 +170,9 @@ void FT2PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 {
     juce::ScopedNoDenormals noDenormals;
 
+    ft2_profile_block_t prof;
+    ft2_profile_begin(&prof);
+
     const int numChannels = buffer.getNumChannels();
     const int numSamples = buffer.getNumSamples();
 
@@ -179,6 +184,12 @@ void FT2PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     if (instance == nullptr)
         return;
 
+    ft2_profile_attach(&prof, &instance->profile);
+
+    /* MIDI recording and the timemap below read and write patterns too,
+     * so the whole callback counts as one block for pattern swaps */
+    ft2_sample_handoff_block_begin(instance);
+
     /* Process MIDI input messages */
     if (instance->config.midiEnabled)
     {
@@ -186,6 +197,8 @@ void FT2PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
             processMidiInput(metadata.getMessage());
     }
 
+    ft2_profile_mark(&prof, FT2_PROFILE_MIDI_IN);
+
     /* DAW BPM Sync (independent of transport sync) */
     if (instance->config.syncBpmFromDAW)
     {
@@ -302,6 +315,8 @@ void FT2PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
         }
     }
 
+    ft2_profile_mark(&prof, FT2_PROFILE_SYNC);
+
     /* Check if we have more than stereo output (indicates multi-out is active) */
     const int totalChannels = buffer.getNumChannels();
     const bool hasMultiOut = (totalChannels > 2);
@@ -375,6 +390,12 @@ void FT2PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
             ft2_mix_voices_only(instance, mainL, mainR, static_cast<uint32_t>(numSamples));
     }
 
+    /* No voice was active in this block: flag the buffer as silent for the host */
+    if (instance->audio.outputSilent)
+        buffer.clear();
+
+    ft2_profile_mark(&prof, FT2_PROFILE_RENDER);
+
     /* Process MIDI output queue - convert FT2 events to JUCE MidiBuffer */
     ft2_midi_event_t midiEvent;
     while (ft2_midi_queue_pop(instance, &midiEvent))
@@ -402,6 +423,11 @@ void FT2PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                 break;
         }
     }
+
+    ft2_sample_handoff_block_end(instance);
+
+    ft2_profile_mark(&prof, FT2_PROFILE_MIDI_OUT);
+    ft2_instance_profile_end(instance, &prof, static_cast<uint32_t>(numSamples));
 }
 
 bool FT2PluginProcessor::hasEditor() const
@@ -421,7 +447,9 @@ void FT2PluginProcessor::getStateInformation(juce::MemoryBlock& destData)
     if (instance == nullptr)
         return;
     
-    uint32_t version = 2;
+    // Version 3 packs the module (ft2_plugin_state_codec.h), version 2 stores it as is
+    uint32_t version = instance->config.compressState ? 3 : 2;
+    const size_t versionPos = destData.getSize();
     destData.append(&version, sizeof(version));
     
     // Config - store size for forward compatibility
@@ -437,19 +465,63 @@ void FT2PluginProcessor::getStateInformation(juce::MemoryBlock& destData)
     int16_t songPos = instance->editor.songPos;
     destData.append(&songPos, sizeof(songPos));
     
-    // Module as XM
-    uint8_t *moduleData = nullptr;
-    uint32_t moduleSize = 0;
-    if (ft2_save_module(instance, &moduleData, &moduleSize) && moduleData != nullptr)
+    // Module, streamed straight into destData a chunk at a time
+    const size_t sizePos = destData.getSize();
+    const uint32_t moduleSize = ft2_save_module_size(instance);
+
+    struct ModuleSink { juce::MemoryBlock *block; size_t pos; };
+    ModuleSink sink { &destData, 0 };
+    auto writeChunk = [](void *userData, const uint8_t *data, uint32_t size) -> bool
+    {
+        auto *s = static_cast<ModuleSink *>(userData);
+        if (s->pos + size > s->block->getSize())
+            s->block->setSize(std::max(s->pos + size, s->block->getSize() + s->block->getSize() / 2));
+        s->block->copyFrom(data, static_cast<int>(s->pos), size);
+        s->pos += size;
+        return true;
+    };
+
+    bool saved = false;
+    if (moduleSize > 0 && version == 3)
+    {
+        // XM size, packed size, packed XM. Sized for the worst case up front,
+        // trimmed to what the packer wrote.
+        uint32_t packedSize = 0, written = 0;
+        sink.pos = sizePos + sizeof(moduleSize) + sizeof(packedSize);
+        destData.setSize(sink.pos + moduleSize + (moduleSize / 64) + 65536);
+
+        saved = ft2_state_pack_module(instance, writeChunk, &sink, &written, &packedSize) && written == moduleSize;
+        if (saved)
+        {
+            destData.setSize(sink.pos);
+            destData.copyFrom(&moduleSize, static_cast<int>(sizePos), sizeof(moduleSize));
+            destData.copyFrom(&packedSize, static_cast<int>(sizePos + sizeof(moduleSize)), sizeof(packedSize));
+        }
+        else
+        {
+            // Store it unpacked instead
+            version = 2;
+            destData.copyFrom(&version, static_cast<int>(versionPos), sizeof(version));
+        }
+    }
+
+    if (moduleSize > 0 && version == 2)
     {
-        destData.append(&moduleSize, sizeof(moduleSize));
-        destData.append(moduleData, moduleSize);
-        free(moduleData);
+        sink.pos = sizePos + sizeof(moduleSize);
+        destData.setSize(sink.pos + moduleSize);
+        destData.copyFrom(&moduleSize, static_cast<int>(sizePos), sizeof(moduleSize));
+
+        uint32_t written = 0;
+        saved = ft2_save_module_stream(instance, writeChunk, &sink, &written) && written == moduleSize;
     }
-    else
+
+    if (!saved)
     {
         uint32_t zero = 0;
+        destData.setSize(sizePos);
         destData.append(&zero, sizeof(zero));
+        if (version == 3)
+            destData.append(&zero, sizeof(zero));
     }
 }
 
@@ -471,6 +543,7 @@ void FT2PluginProcessor::setStateInformation(const void* data, int sizeInBytes)
     int16_t songPos = 0;
     const uint8_t* modulePtr = nullptr;
     uint32_t moduleSize = 0;
+    juce::HeapBlock<uint8_t> unpacked;
     
     if (version == 1)
     {
@@ -510,9 +583,9 @@ void FT2PluginProcessor::setStateInformation(const void* data, int sizeInBytes)
         }
         // Config uses defaults for v1 (already initialized in instance)
     }
-    else if (version == 2)
+    else if (version == 2 || version == 3)
     {
-        // Version 2: Config size is stored
+        // Version 2: Config size is stored. Version 3: same, with the module packed.
         if (remaining < 4)
             return;
         uint32_t savedConfigSize;
@@ -548,8 +621,29 @@ void FT2PluginProcessor::setStateInformation(const void* data, int sizeInBytes)
         ptr += sizeof(moduleSize);
         remaining -= 4;
         
-        if (moduleSize > 0 && remaining >= static_cast<int>(moduleSize))
+        if (version == 3)
+        {
+            if (remaining < 4)
+                return;
+            uint32_t packedSize;
+            memcpy(&packedSize, ptr, sizeof(packedSize));
+            ptr += sizeof(packedSize);
+            remaining -= 4;
+
+            // The stored size comes from the host's copy of the state, so
+            // bound it by what the packed bytes could unpack to before allocating
+            if (moduleSize > 0 && packedSize <= static_cast<uint32_t>(remaining)
+                && static_cast<uint64_t>(moduleSize) <= static_cast<uint64_t>(packedSize) * FT2_STATE_MAX_RATIO)
+            {
+                unpacked.malloc(moduleSize);
+                if (unpacked.get() != nullptr && ft2_state_unpack(ptr, packedSize, unpacked.get(), moduleSize))
+                    modulePtr = unpacked.get();
+            }
+        }
+        else if (moduleSize > 0 && remaining >= static_cast<int>(moduleSize))
+        {
             modulePtr = ptr;
+        }
     }
     else
     {
@@ -662,7 +756,7 @@ void FT2PluginProcessor::saveNibblesHighScores()
     
     for (int i = 0; i < 10; i++)
     {
-        auto& hs = instance->nibbles.highScores[i];
+        auto& hs = instance->nibbles->highScores[i];
         props->setValue("nibbles_hs_" + juce::String(i) + "_name", juce::String(hs.name));
         props->setValue("nibbles_hs_" + juce::String(i) + "_nameLen", hs.nameLen);
         props->setValue("nibbles_hs_" + juce::String(i) + "_score", hs.score);
@@ -670,11 +764,11 @@ void FT2PluginProcessor::saveNibblesHighScores()
     }
     
     // Also save nibbles settings
-    props->setValue("nibbles_numPlayers", instance->nibbles.numPlayers);
-    props->setValue("nibbles_speed", instance->nibbles.speed);
-    props->setValue("nibbles_surround", instance->nibbles.surround);
-    props->setValue("nibbles_grid", instance->nibbles.grid);
-    props->setValue("nibbles_wrap", instance->nibbles.wrap);
+    props->setValue("nibbles_numPlayers", instance->nibbles->numPlayers);
+    props->setValue("nibbles_speed", instance->nibbles->speed);
+    props->setValue("nibbles_surround", instance->nibbles->surround);
+    props->setValue("nibbles_grid", instance->nibbles->grid);
+    props->setValue("nibbles_wrap", instance->nibbles->wrap);
     
     props->saveIfNeeded();
 }
@@ -694,7 +788,7 @@ void FT2PluginProcessor::loadNibblesHighScores()
     
     for (int i = 0; i < 10; i++)
     {
-        auto& hs = instance->nibbles.highScores[i];
+        auto& hs = instance->nibbles->highScores[i];
         
         juce::String name = props->getValue("nibbles_hs_" + juce::String(i) + "_name", "");
         if (name.isNotEmpty())
@@ -709,11 +803,11 @@ void FT2PluginProcessor::loadNibblesHighScores()
     }
     
     // Also load nibbles settings
-    instance->nibbles.numPlayers = static_cast<uint8_t>(props->getIntValue("nibbles_numPlayers", 0));
-    instance->nibbles.speed = static_cast<uint8_t>(props->getIntValue("nibbles_speed", 0));
-    instance->nibbles.surround = props->getBoolValue("nibbles_surround", false);
-    instance->nibbles.grid = props->getBoolValue("nibbles_grid", true);
-    instance->nibbles.wrap = props->getBoolValue("nibbles_wrap", false);
+    instance->nibbles->numPlayers = static_cast<uint8_t>(props->getIntValue("nibbles_numPlayers", 0));
+    instance->nibbles->speed = static_cast<uint8_t>(props->getIntValue("nibbles_speed", 0));
+    instance->nibbles->surround = props->getBoolValue("nibbles_surround", false);
+    instance->nibbles->grid = props->getBoolValue("nibbles_grid", true);
+    instance->nibbles->wrap = props->getBoolValue("nibbles_wrap", false);
 }
 
 // Global config version - increment when adding new fields that need migration
@@ -766,6 +860,7 @@ void FT2PluginProcessor::saveGlobalConfig()
     
     // Sample editor settings
     props->setValue("config_smpEdNote", cfg.smpEdNote);
+    props->setValue("config_smpUndoMemMB", cfg.smpUndoMemMB);
     
     // Miscellaneous settings
     props->setValue("config_smpCutToBuffer", cfg.smpCutToBuffer);
@@ -775,6 +870,7 @@ void FT2PluginProcessor::saveGlobalConfig()
     // Disk operation settings
     props->setValue("config_dirSortPriority", cfg.dirSortPriority);
     props->setValue("config_overwriteWarning", cfg.overwriteWarning);
+    props->setValue("config_compressState", cfg.compressState);
     
     // DAW sync settings
     props->setValue("config_syncBpmFromDAW", cfg.syncBpmFromDAW);
@@ -907,6 +1003,8 @@ void FT2PluginProcessor::loadGlobalConfig()
     
     // Sample editor settings
     cfg.smpEdNote = static_cast<uint8_t>(props->getIntValue("config_smpEdNote", cfg.smpEdNote));
+    cfg.smpUndoMemMB = static_cast<uint16_t>(juce::jlimit(FT2_UNDO_MIN_MEM_MB, FT2_UNDO_MAX_MEM_MB,
+        props->getIntValue("config_smpUndoMemMB", cfg.smpUndoMemMB)));
     
     // Miscellaneous settings
     cfg.smpCutToBuffer = props->getBoolValue("config_smpCutToBuffer", cfg.smpCutToBuffer);
@@ -916,6 +1014,7 @@ void FT2PluginProcessor::loadGlobalConfig()
     // Disk operation settings
     cfg.dirSortPriority = static_cast<uint8_t>(props->getIntValue("config_dirSortPriority", cfg.dirSortPriority));
     cfg.overwriteWarning = props->getBoolValue("config_overwriteWarning", cfg.overwriteWarning);
+    cfg.compressState = props->getBoolValue("config_compressState", cfg.compressState);
     
     // DAW sync settings
     cfg.syncBpmFromDAW = props->getBoolValue("config_syncBpmFromDAW", cfg.syncBpmFromDAW);
@@ -14,6 +14,50 @@ extern "C" {
 #pragma pack(pop)
 #endif
 
+/**
+ * @class FT2MappedFile
+ * @brief Read-only view of a file's bytes for the C loaders.
+ *
+ * The file is memory-mapped so loaders decode straight from the page cache
+ * without an intermediate copy; pages are faulted in as the loader reaches
+ * them. Falls back to reading the file into memory if mapping fails.
+ */
+class FT2MappedFile
+{
+public:
+    explicit FT2MappedFile(const juce::File& file)
+    {
+        mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        if (mapped->getData() != nullptr && mapped->getSize() > 0)
+        {
+            data = static_cast<const uint8_t*>(mapped->getData());
+            size = mapped->getSize();
+            return;
+        }
+
+        mapped.reset();
+        if (file.loadFileAsData(fallback))
+        {
+            data = static_cast<const uint8_t*>(fallback.getData());
+            size = fallback.getSize();
+        }
+    }
+
+    /** True if the file was read and fits the loaders' 32-bit sizes. */
+    bool isValid() const { return data != nullptr && size > 0 && size <= 0xFFFFFFFFu; }
+
+    const uint8_t* getData() const { return data; }
+    uint32_t getSize() const { return static_cast<uint32_t>(size); }
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> mapped;
+    juce::MemoryBlock fallback;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(FT2MappedFile)
+};
+
 /**
  * @class FT2PluginProcessor
  * @brief JUCE AudioProcessor wrapper for the FT2 replayer.
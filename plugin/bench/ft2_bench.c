@@ -0,0 +1,1631 @@
+/**
+ * @file ft2_bench.c
+ * @brief Throughput benchmarks for the ft2_core mixer and replayer.
+ *
+ * Timing sweeps only; whether the optimized paths give the right output is
+ * checked by the tests in src/plugin/tests and src/tests (run with ctest).
+ * Results are written as JSON to stdout:
+ *  - "mix": each voice mixer path (interpolation mode x bit depth x loop
+ *    type) with 1..FT2_MAX_CHANNELS * 2 voices, driven through the note
+ *    trigger + ft2_mix_voices_only() path on synthetic samples. Past
+ *    FT2_MAX_CHANNELS the fadeout voices are held on as well.
+ *  - "tile": 1..64 looped voices rendered at host block sizes 64..4096,
+ *    with ticks long enough that each block is mixed in one go.
+ *  - "undo": the sample undo journal on a 4 MiB sample: memory and
+ *    time for a 1% selection vs. the whole sample, and for undoing and
+ *    redoing a 32-level history.
+ *  - "echo": the sample editor's echo against the direct sum over every
+ *    tap it replaced, at 1..64 echoes (time should not grow with the
+ *    count), then through a background job, run to the end and cancelled.
+ *  - "smpfx": the sample effects (filters with and without
+ *    normalization, bass/treble, amplify) on a 10M-frame sample (1M with
+ *    --quick) against the one-sample-at-a-time loops they replaced.
+ *  - "resample": the resample panel's converter on one thread and on the
+ *    worker pool.
+ *  - "idle": 64 instances with nothing to play, stopped and playing an
+ *    empty song, against the clear/mix/scale they used to run every block.
+ *  - "render": ft2_instance_render() and ft2_instance_render_multiout()
+ *    over the module files given on the command line, at several sample
+ *    rates and block sizes. The per-channel meters are read after every
+ *    block, as the editor would.
+ *  - "meter": each module file rendered in 64-frame blocks with and
+ *    without a reader for the levels.
+ *  - "output": the output stages (gain + clamp, and the multi-out sum
+ *    of 8 buffers) on a block that stays in cache and on one that
+ *    doesn't, against the scalar loops they replaced, and the
+ *    standalone's dithered 16-bit output, SSE2/NEON against scalar.
+ *  - "save": the XM writer on a synthetic ~100 MB module (~25 MB with
+ *    --quick) and on the module files: ft2_save_module() into one buffer
+ *    against the streaming writer.
+ *  - "state": the packed module the plugin state stores, on the same
+ *    modules: size against the plain XM, pack and unpack speed against
+ *    ft2_save_module(), and load time from the packed state against
+ *    loading the XM.
+ *  - "trim": the Trim screen's size estimate on a synthetic 256-pattern,
+ *    128-instrument song and on the module files, then on all of them at
+ *    once from one thread per instance.
+ *  - "profile": the first module file rendered by three instances in
+ *    turn, as processBlock() drives them: without the profiling calls,
+ *    with them while profiling is off, and with it on.
+ *  - "editor": ft2_ui_create() + ft2_ui_destroy() (editor open/close)
+ *    with an instance alive, first open vs. reopen.
+ *  - "ui": full redraws of the pattern screen for a 32-channel pattern,
+ *    scrolled through every channel, at several channel counts/fonts.
+ *
+ * The layout of ft2_instance_t (size of the hot block the audio thread
+ * touches, total size, voice size) is reported alongside the results.
+ *
+ * The "mix", "tile", "render" and "ui" sweeps hash their output (FNV-1a
+ * over the float bits, or over the framebuffer for "ui"). Pass
+ * --write-golden FILE to record the hashes and --golden FILE to compare
+ * against them; any mismatch is reported and makes the run fail, so an
+ * optimization can't silently change the audio at settings the tests
+ * don't cover.
+ *
+ * Without module files, the corpus in bench/corpus is used and checked
+ * against bench/corpus/golden.txt (golden_quick.txt with --quick) unless
+ * another golden file is given. After a deliberate change to the output,
+ * record them again with --write-golden.
+ *
+ * Usage: ft2_bench [--quick] [--seconds N] [--golden FILE | --write-golden FILE] [module ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "ft2_test.h"
+#include "ft2_instance.h"
+#include "ft2_plugin_loader.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_interpolation.h"
+#include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_undo.h"
+#include "ft2_plugin_sample_job.h"
+#include "ft2_plugin_echo_panel.h"
+#include "ft2_plugin_resampler.h"
+#include "ft2_plugin_smpfx.h"
+#include "ft2_plugin_workers.h"
+#include "ft2_plugin_output.h"
+#include "ft2_plugin_diskop.h"
+#include "ft2_plugin_state_codec.h"
+#include "ft2_plugin_trim.h"
+#include "ft2_audio_dither.h"
+
+/* Set by CMake; otherwise the bench is run from the repository root */
+#ifndef FT2_BENCH_CORPUS_DIR
+#define FT2_BENCH_CORPUS_DIR "plugin/bench/corpus"
+#endif
+
+#define MAX_BLOCK_SIZE 4096
+#define MAX_GOLDEN 4096
+
+typedef struct goldenEntry_t {
+	char key[256];
+	uint64_t hash;
+} goldenEntry_t;
+
+static goldenEntry_t golden[MAX_GOLDEN];
+static int32_t numGolden;
+static FILE *goldenOut;
+static int32_t numMismatches;
+static bool firstResult;
+
+static float outL[MAX_BLOCK_SIZE], outR[MAX_BLOCK_SIZE];
+
+static const char *interpNames[FT2_NUM_INTERP_MODES] = { "none", "linear", "quadratic", "cubic", "sinc8", "sinc16" };
+static const char *loopNames[3] = { "noloop", "loop", "bidi" };
+
+static bool loadGolden(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+		return false;
+
+	char line[512];
+	while (numGolden < MAX_GOLDEN && fgets(line, sizeof(line), f) != NULL) {
+		goldenEntry_t *g = &golden[numGolden];
+		unsigned long long hash;
+		if (sscanf(line, "%255s %llx", g->key, &hash) == 2) {
+			g->hash = hash;
+			numGolden++;
+		}
+	}
+
+	fclose(f);
+	return true;
+}
+
+/* Returns "ok", "mismatch" or "new" (no golden entry) */
+static const char *checkGolden(const char *key, uint64_t hash)
+{
+	if (goldenOut != NULL)
+		fprintf(goldenOut, "%s %016llx\n", key, (unsigned long long)hash);
+
+	for (int32_t i = 0; i < numGolden; i++) {
+		if (strcmp(golden[i].key, key) == 0) {
+			if (golden[i].hash == hash)
+				return "ok";
+
+			fprintf(stderr, "golden mismatch: %s (expected %016llx, got %016llx)\n",
+				key, (unsigned long long)golden[i].hash, (unsigned long long)hash);
+			numMismatches++;
+			return "mismatch";
+		}
+	}
+
+	return "new";
+}
+
+static void beginResult(void)
+{
+	printf(firstResult ? "\n    " : ",\n    ");
+	firstResult = false;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Mixer microbenchmarks                          */
+/* ------------------------------------------------------------------------- */
+
+/* Past FT2_MAX_CHANNELS voices, the fadeout slots are filled too. A real
+ * fadeout voice only lasts its ramp, so each is a copy of its channel's
+ * voice a fifth up with the ramp held flat, and keeps sounding. */
+static void holdFadeoutVoices(ft2_instance_t *inst, int32_t numVoices)
+{
+	if (numVoices <= FT2_MAX_CHANNELS)
+		return;
+
+	ft2_update_voices(inst); /* Start the triggered notes */
+	for (int32_t i = FT2_MAX_CHANNELS; i < numVoices; i++) {
+		ft2_voice_t *f = &inst->voice[i];
+		*f = inst->voice[i - FT2_MAX_CHANNELS];
+		f->delta += f->delta >> 1;
+		ft2_voice_update_sinc_lut(inst, f);
+		f->fCurrVolumeL = f->fTargetVolumeL;
+		f->fCurrVolumeR = f->fTargetVolumeR;
+		f->fVolumeLDelta = f->fVolumeRDelta = 0.0f;
+		f->volumeRampLength = UINT32_MAX;
+		f->isFadeOutVoice = true;
+	}
+}
+
+static void runMixBench(uint32_t sampleRate, double seconds)
+{
+	ft2_instance_t *inst = ft2_instance_create(sampleRate);
+	if (inst == NULL || !ft2_test_setup_mix_instruments(inst)) {
+		fprintf(stderr, "mix: instance setup failed\n");
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	inst->replayer.song.numChannels = FT2_MAX_CHANNELS;
+	const uint32_t blockSize = 512;
+	const uint32_t numBlocks = (uint32_t)((seconds * sampleRate) / blockSize) + 1;
+
+	for (uint8_t interp = 0; interp < FT2_NUM_INTERP_MODES; interp++) {
+		ft2_set_interpolation(inst, interp);
+
+		for (int32_t smp = 0; smp < 6; smp++) {
+			for (int32_t numVoices = 1; numVoices <= FT2_MAX_CHANNELS * 2; numVoices *= 2) {
+				ft2_instance_stop(inst);
+				for (int32_t ch = 0; ch < numVoices && ch < FT2_MAX_CHANNELS; ch++) {
+					/* Spread the pitches so voices don't run in lockstep */
+					ft2_instance_trigger_note(inst, (int8_t)(37 + (ch % 24)), (uint8_t)(smp + 1), (uint8_t)ch, 64, 0, 0);
+				}
+				holdFadeoutVoices(inst, numVoices);
+
+				/* Only the mixing is timed, not the hashing */
+				uint64_t hash = FT2_TEST_HASH_INIT;
+				double elapsed = 0.0;
+				for (uint32_t b = 0; b < numBlocks; b++) {
+					const double t0 = ft2_test_now();
+					ft2_mix_voices_only(inst, outL, outR, blockSize);
+					elapsed += ft2_test_now() - t0;
+
+					hash = ft2_test_hash_floats(hash, outL, blockSize);
+					hash = ft2_test_hash_floats(hash, outR, blockSize);
+				}
+
+				const double numFrames = (double)numBlocks * blockSize;
+				char key[256];
+				snprintf(key, sizeof(key), "mix:%s:%s:%s:%d:%u", interpNames[interp],
+					(smp >= 3) ? "16bit" : "8bit", loopNames[smp % 3], numVoices, sampleRate);
+
+				beginResult();
+				printf("{\"suite\": \"mix\", \"interpolation\": \"%s\", \"bits\": %d, \"loop\": \"%s\", "
+					"\"voices\": %d, \"sampleRate\": %u, \"frames\": %.0f, \"seconds\": %.6f, "
+					"\"nsPerVoiceSample\": %.3f, \"realtimeFactor\": %.2f, \"hash\": \"%016llx\", \"golden\": \"%s\"}",
+					interpNames[interp], (smp >= 3) ? 16 : 8, loopNames[smp % 3], numVoices, sampleRate, numFrames,
+					elapsed, (elapsed * 1e9) / (numFrames * numVoices), (numFrames / sampleRate) / elapsed,
+					(unsigned long long)hash, checkGolden(key, hash));
+			}
+		}
+	}
+
+	ft2_instance_destroy(inst);
+}
+
+/* Voice counts against host block sizes through ft2_instance_render(), at
+ * 32 BPM so a tick (3750 frames at 48 kHz) doesn't cut the blocks up. The
+ * looped samples keep every voice playing. */
+static void runTileBench(double seconds)
+{
+	static const int32_t voiceCounts[] = { 1, 4, 16, 32, 64 };
+	static const uint32_t tileBlockSizes[] = { 64, 256, 1024, 4096 };
+	static const uint8_t looped[4] = { 2, 3, 5, 6 };
+	const uint32_t sampleRate = 48000;
+
+	ft2_instance_t *inst = ft2_instance_create(sampleRate);
+	if (inst == NULL || !ft2_test_setup_mix_instruments(inst)) {
+		fprintf(stderr, "tile: instance setup failed\n");
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	inst->replayer.song.numChannels = FT2_MAX_CHANNELS;
+	const uint32_t numFrames = ((uint32_t)(seconds * sampleRate) + MAX_BLOCK_SIZE - 1) & ~(uint32_t)(MAX_BLOCK_SIZE - 1);
+
+	for (int32_t vc = 0; vc < (int32_t)(sizeof(voiceCounts) / sizeof(voiceCounts[0])); vc++) {
+		const int32_t numVoices = voiceCounts[vc];
+
+		for (int32_t bs = 0; bs < (int32_t)(sizeof(tileBlockSizes) / sizeof(tileBlockSizes[0])); bs++) {
+			const uint32_t blockSize = tileBlockSizes[bs];
+
+			ft2_instance_stop(inst);
+			inst->replayer.song.BPM = FT2_MIN_BPM;
+			ft2_instance_init_bpm_vars(inst);
+			inst->audio.tickSampleCounter = 0;
+			inst->audio.tickSampleCounterFrac = 0;
+			for (int32_t ch = 0; ch < numVoices && ch < FT2_MAX_CHANNELS; ch++)
+				ft2_instance_trigger_note(inst, (int8_t)(37 + (ch % 24)), looped[ch & 3], (uint8_t)ch, 64, 0, 0);
+			holdFadeoutVoices(inst, numVoices);
+
+			uint64_t hash = FT2_TEST_HASH_INIT;
+			double elapsed = 0.0;
+			for (uint32_t f = 0; f < numFrames; f += blockSize) {
+				const double t0 = ft2_test_now();
+				ft2_instance_render(inst, outL, outR, blockSize);
+				elapsed += ft2_test_now() - t0;
+
+				hash = ft2_test_hash_floats(hash, outL, blockSize);
+				hash = ft2_test_hash_floats(hash, outR, blockSize);
+			}
+
+			char key[256];
+			snprintf(key, sizeof(key), "tile:%d:%u", numVoices, blockSize);
+
+			beginResult();
+			printf("{\"suite\": \"tile\", \"voices\": %d, \"blockSize\": %u, \"frames\": %u, \"seconds\": %.6f, "
+				"\"nsPerVoiceSample\": %.3f, \"hash\": \"%016llx\", \"golden\": \"%s\"}",
+				numVoices, blockSize, numFrames, elapsed, (elapsed * 1e9) / ((double)numFrames * numVoices),
+				(unsigned long long)hash, checkGolden(key, hash));
+		}
+	}
+
+	ft2_instance_destroy(inst);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Sample undo                                  */
+/* ------------------------------------------------------------------------- */
+
+#define UNDO_SMP_LEN (1 << 21)
+#define UNDO_LEVELS 32
+
+/* No audio thread: two syncs free every buffer an undo step retired */
+static void settleHandoff(ft2_instance_t *inst)
+{
+	ft2_sample_handoff_sync(inst);
+	ft2_sample_handoff_sync(inst);
+}
+
+static void runUndoBench(void)
+{
+	ft2_undo_journal_t journal;
+	ft2_undo_init(&journal);
+
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (inst == NULL || !ft2_test_setup_undo_sample(inst, UNDO_SMP_LEN)) {
+		fprintf(stderr, "undo: instance setup failed\n");
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+
+	/* One edit of a 1% selection vs. the same edit of the whole sample */
+	for (int32_t c = 0; c < 2; c++) {
+		const bool whole = (c == 1);
+		const int32_t x1 = whole ? 0 : UNDO_SMP_LEN / 2;
+		const int32_t count = whole ? UNDO_SMP_LEN : UNDO_SMP_LEN / 100;
+
+		double t0 = ft2_test_now();
+		ft2_undo_begin(&journal, inst, 1, 0, x1, count, true);
+		double recordSeconds = ft2_test_now() - t0;
+		ft2_test_negate_range(s, x1, x1 + count);
+		t0 = ft2_test_now();
+		ft2_undo_end(&journal, inst);
+		recordSeconds += ft2_test_now() - t0;
+
+		const size_t journalBytes = journal.bytesUsed;
+
+		t0 = ft2_test_now();
+		ft2_undo_step(&journal, inst, 1, 0, false, NULL);
+		const double undoSeconds = ft2_test_now() - t0;
+		settleHandoff(inst);
+
+		t0 = ft2_test_now();
+		ft2_undo_step(&journal, inst, 1, 0, true, NULL);
+		const double redoSeconds = ft2_test_now() - t0;
+		settleHandoff(inst);
+
+		beginResult();
+		printf("{\"suite\": \"undo\", \"case\": \"%s\", \"sampleBytes\": %d, \"regionBytes\": %d, \"journalBytes\": %zu, "
+			"\"recordMs\": %.3f, \"undoMs\": %.3f, \"redoMs\": %.3f}",
+			whole ? "whole" : "range", UNDO_SMP_LEN * 2, count * 2, journalBytes,
+			recordSeconds * 1000.0, undoSeconds * 1000.0, redoSeconds * 1000.0);
+
+		ft2_undo_free(&journal);
+	}
+
+	/* History: in-place and length-changing edits mixed, all undone and
+	 * then redone */
+	uint32_t seed = 0x13579BDu;
+	for (int32_t i = 0; i < UNDO_LEVELS; i++) {
+		seed = seed * 1103515245u + 12345u;
+		const int32_t count = ((i & 3) == 3) ? 1000 : s->length / 100;
+		const int32_t x1 = (int32_t)((seed >> 8) % (uint32_t)(s->length - count));
+
+		ft2_undo_begin(&journal, inst, 1, 0, x1, count, true);
+		if ((i & 3) == 3)
+			ft2_test_delete_range(s, x1, x1 + count);
+		else
+			ft2_test_negate_range(s, x1, x1 + count);
+	}
+	ft2_undo_end(&journal, inst);
+
+	const size_t historyBytes = journal.bytesUsed;
+	double undoSeconds = 0.0, redoSeconds = 0.0;
+
+	for (int32_t i = 0; i < UNDO_LEVELS; i++) {
+		const double t0 = ft2_test_now();
+		ft2_undo_step(&journal, inst, 1, 0, false, NULL);
+		undoSeconds += ft2_test_now() - t0;
+		settleHandoff(inst);
+	}
+
+	for (int32_t i = 0; i < UNDO_LEVELS; i++) {
+		const double t0 = ft2_test_now();
+		ft2_undo_step(&journal, inst, 1, 0, true, NULL);
+		redoSeconds += ft2_test_now() - t0;
+		settleHandoff(inst);
+	}
+
+	beginResult();
+	printf("{\"suite\": \"undo\", \"case\": \"history\", \"levels\": %d, \"journalBytes\": %zu, "
+		"\"undoAllMs\": %.3f, \"redoAllMs\": %.3f}",
+		UNDO_LEVELS, historyBytes, undoSeconds * 1000.0, redoSeconds * 1000.0);
+
+	ft2_undo_free(&journal);
+	settleHandoff(inst);
+	ft2_instance_destroy(inst);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Sample echo                                  */
+/* ------------------------------------------------------------------------- */
+
+#define ECHO_SMP_LEN (1 << 20)
+
+typedef struct echoBenchJob_t {
+	const int8_t *src;
+	int8_t *dst;
+	int32_t srcLen, dstLen, distance, numTaps;
+	double volChange;
+	bool returned;
+} echoBenchJob_t;
+
+static bool echoBenchJobRun(ft2_sample_job_t *job, void *userData)
+{
+	echoBenchJob_t *ej = (echoBenchJob_t *)userData;
+	return ft2_echo_render(ej->src, ej->srcLen, ej->dst, ej->dstLen, true, ej->distance, ej->volChange, ej->numTaps, job);
+}
+
+static void echoBenchJobDone(ft2_instance_t *inst, void *userData, bool completed)
+{
+	(void)inst;
+	(void)completed;
+	((echoBenchJob_t *)userData)->returned = true;
+}
+
+/* Runs one echo job the way the editor does, polling once per "frame" */
+static void runEchoJob(echoBenchJob_t *ej, bool cancel, int32_t *frames)
+{
+	ft2_sample_job_t job;
+	memset(&job, 0, sizeof(job));
+	ej->returned = false;
+
+	*frames = 0;
+	if (!ft2_sample_job_start(&job, NULL, "Creating echo...", echoBenchJobRun, echoBenchJobDone, ej))
+		return;
+	if (cancel)
+		ft2_sample_job_cancel(&job);
+
+	while (!ej->returned) {
+		ft2_test_sleep_ms(1);
+		ft2_sample_job_poll(&job);
+		(*frames)++;
+	}
+}
+
+static void runEchoBench(void)
+{
+	static const int32_t echoCounts[] = { 1, 8, 64 };
+	const int32_t distance = 64 * 16;
+	const double volChange = 0.9;
+	const int32_t maxDstLen = ECHO_SMP_LEN + distance * 64;
+
+	int16_t *src = (int16_t *)malloc((size_t)ECHO_SMP_LEN * sizeof(int16_t));
+	int8_t *ref = (int8_t *)malloc((size_t)maxDstLen * sizeof(int16_t));
+	int8_t *out = (int8_t *)malloc((size_t)maxDstLen * sizeof(int16_t));
+	if (src == NULL || ref == NULL || out == NULL) {
+		fprintf(stderr, "echo: out of memory\n");
+		free(src); free(ref); free(out);
+		return;
+	}
+
+	uint32_t seed = 0x2468ACEu;
+	for (int32_t i = 0; i < ECHO_SMP_LEN; i++) {
+		seed = seed * 1103515245u + 12345u;
+		src[i] = (int16_t)((int32_t)(sin(i * 0.013) * 12000.0) + (int32_t)((seed >> 16) & 0x1FFF) - 0x1000);
+	}
+
+	for (int32_t b = 0; b < 2; b++) {
+		const bool sample16Bit = (b == 0);
+		for (int32_t c = 0; c < (int32_t)(sizeof(echoCounts) / sizeof(echoCounts[0])); c++) {
+			const int32_t numTaps = echoCounts[c] + 1;
+			const int32_t dstLen = ECHO_SMP_LEN + distance * (numTaps - 1);
+			const int32_t bytes = sample16Bit ? 2 : 1;
+
+			double t0 = ft2_test_now();
+			ft2_test_echo_by_taps((const int8_t *)src, ECHO_SMP_LEN, ref, dstLen, sample16Bit, distance, volChange, numTaps);
+			const double tapsSeconds = ft2_test_now() - t0;
+
+			t0 = ft2_test_now();
+			ft2_echo_render((const int8_t *)src, ECHO_SMP_LEN, out, dstLen, sample16Bit, distance, volChange, numTaps, NULL);
+			const double renderSeconds = ft2_test_now() - t0;
+
+			beginResult();
+			printf("{\"suite\": \"echo\", \"case\": \"%s_%d\", \"outBytes\": %d, \"tapsMs\": %.3f, \"renderMs\": %.3f}",
+				sample16Bit ? "16bit" : "8bit", echoCounts[c], dstLen * bytes, tapsSeconds * 1000.0, renderSeconds * 1000.0);
+		}
+	}
+
+	/* In the background: to the end, then cancelled */
+	echoBenchJob_t ej = { (const int8_t *)src, ref, ECHO_SMP_LEN, maxDstLen, distance, 65, volChange, false };
+	for (int32_t c = 0; c < 2; c++) {
+		const bool cancel = (c == 1);
+		int32_t frames;
+
+		const double t0 = ft2_test_now();
+		runEchoJob(&ej, cancel, &frames);
+		const double jobSeconds = ft2_test_now() - t0;
+
+		beginResult();
+		printf("{\"suite\": \"echo\", \"case\": \"%s\", \"jobMs\": %.3f, \"framesPolled\": %d}",
+			cancel ? "job_cancel" : "job", jobSeconds * 1000.0, frames);
+	}
+
+	free(src);
+	free(ref);
+	free(out);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Sample effects                               */
+/* ------------------------------------------------------------------------- */
+
+typedef struct smpFxBenchCase_t {
+	const char *name;
+	uint8_t op, filter; /* filter: 0 none, 1 lowpass, 2 highpass */
+	double cutoff, mix;
+	uint32_t resonance;
+	bool normalize, sample16Bit;
+	int32_t amp; /* Percent */
+} smpFxBenchCase_t;
+
+static void runSmpFxBench(int32_t len)
+{
+	/* The editor's buttons: bass/treble use these cutoffs, the filter
+	 * panel a cutoff in Hz (here already divided by the sample rate) */
+	static const smpFxBenchCase_t cases[] = {
+		{ "lowpass",       SMPFX_OP_FILTER,       1, 0.05,  0.0,   0,  false, true,  0 },
+		{ "lowpass_reso",  SMPFX_OP_FILTER,       1, 0.02,  0.0,   80, false, true,  0 },
+		{ "lowpass_norm",  SMPFX_OP_FILTER,       1, 0.05,  0.0,   0,  true,  true,  0 },
+		{ "highpass_norm", SMPFX_OP_FILTER,       2, 0.1,   0.0,   40, true,  true,  0 },
+		{ "sub_bass",      SMPFX_OP_FILTER,       2, 0.001, 0.0,   0,  false, true,  0 },
+		{ "add_bass",      SMPFX_OP_MIX_FILTERED, 1, 0.015, 0.25,  0,  false, true,  0 },
+		{ "add_treble",    SMPFX_OP_MIX_FILTERED, 2, 0.27,  -0.25, 0,  false, true,  0 },
+		{ "amp_75",        SMPFX_OP_AMP,          0, 0.0,   0.0,   0,  false, true,  75 },
+		{ "amp_250",       SMPFX_OP_AMP,          0, 0.0,   0.0,   0,  false, true,  250 },
+		{ "lowpass_8bit",  SMPFX_OP_FILTER,       1, 0.05,  0.0,   0,  false, false, 0 },
+		{ "add_treble_8bit", SMPFX_OP_MIX_FILTERED, 2, 0.27, -0.25, 0, false, false, 0 },
+		{ "amp_250_8bit",  SMPFX_OP_AMP,          0, 0.0,   0.0,   0,  false, false, 250 }
+	};
+
+	int16_t *src = (int16_t *)malloc((size_t)len * sizeof(int16_t));
+	int8_t *ref = (int8_t *)malloc((size_t)len * sizeof(int16_t));
+	int8_t *out = (int8_t *)malloc((size_t)len * sizeof(int16_t));
+	if (src == NULL || ref == NULL || out == NULL) {
+		fprintf(stderr, "smpfx: out of memory\n");
+		free(src); free(ref); free(out);
+		return;
+	}
+
+	for (int32_t c = 0; c < (int32_t)(sizeof(cases) / sizeof(cases[0])); c++) {
+		const smpFxBenchCase_t *bc = &cases[c];
+
+		/* A tone plus noise, at the bit depth of the case */
+		uint32_t seed = 0x13579BDu;
+		for (int32_t i = 0; i < len; i++) {
+			seed = seed * 1103515245u + 12345u;
+			const int32_t x = (int32_t)(sin(i * 0.021) * 14000.0) + (int32_t)((seed >> 16) & 0x3FFF) - 0x2000;
+			if (bc->sample16Bit)
+				src[i] = (int16_t)x;
+			else
+				((int8_t *)src)[i] = (int8_t)(x >> 8);
+		}
+
+		smpfx_params_t p;
+		memset(&p, 0, sizeof(p));
+		if (bc->filter == 1)
+			smpfx_setup_lowpass(&p, bc->cutoff, bc->resonance);
+		else if (bc->filter == 2)
+			smpfx_setup_highpass(&p, bc->cutoff, bc->resonance);
+		p.op = bc->op;
+		p.normalize = bc->normalize;
+		p.mix = bc->mix;
+		p.ampMul = (int32_t)round((1 << 22UL) * (bc->amp / 100.0));
+
+		double t0 = ft2_test_now();
+		ft2_test_smpfx_by_loop(&p, (const int8_t *)src, ref, len, bc->sample16Bit);
+		const double loopSeconds = ft2_test_now() - t0;
+
+		t0 = ft2_test_now();
+		smpfx_render(&p, (const int8_t *)src, out, len, bc->sample16Bit, NULL);
+		const double renderSeconds = ft2_test_now() - t0;
+
+		beginResult();
+		printf("{\"suite\": \"smpfx\", \"case\": \"%s\", \"samples\": %d, \"loopMsmpPerSec\": %.1f, \"renderMsmpPerSec\": %.1f}",
+			bc->name, len, len / loopSeconds / 1e6, len / renderSeconds / 1e6);
+	}
+
+	free(src);
+	free(ref);
+	free(out);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Resampling                                   */
+/* ------------------------------------------------------------------------- */
+
+#define RESAMPLE_SPEED_LEN (1 << 22)
+
+static void runResampleSpeed(int32_t semitones, const int16_t *src, int16_t *dst1, int16_t *dstN)
+{
+	const double ratio = pow(2.0, semitones / 12.0);
+	ft2_resampler_t rs;
+	if (!ft2_resampler_init(&rs, ratio))
+		return;
+
+	const ft2_resample_source_t source = { (const int8_t *)src, RESAMPLE_SPEED_LEN, 0, RESAMPLE_SPEED_LEN, FT2_SAMPLE_16BIT | FT2_LOOP_FWD };
+	const int32_t dstLen = (int32_t)floor(RESAMPLE_SPEED_LEN * ratio);
+
+	double t0 = ft2_test_now();
+	ft2_resampler_render(&rs, &source, (int8_t *)dst1, 0, dstLen);
+	const double oneSeconds = ft2_test_now() - t0;
+
+	t0 = ft2_test_now();
+	ft2_resampler_run(&rs, &source, (int8_t *)dstN, dstLen, NULL);
+	const double poolSeconds = ft2_test_now() - t0;
+
+	beginResult();
+	printf("{\"suite\": \"resample\", \"case\": \"speed_%+d\", \"taps\": %d, \"outSamples\": %d, \"threads\": %d, "
+		"\"oneThreadMsmpPerSec\": %.2f, \"poolMsmpPerSec\": %.2f}",
+		semitones, rs.numTaps, dstLen, ft2_workers_get_concurrency(), dstLen / oneSeconds / 1e6, dstLen / poolSeconds / 1e6);
+
+	ft2_resampler_free(&rs);
+}
+
+static void runResampleBench(void)
+{
+	static const int32_t speedShifts[] = { -12, 12 };
+
+	const size_t maxDst = (size_t)RESAMPLE_SPEED_LEN * 2 + 1;
+	int16_t *src = (int16_t *)malloc((size_t)RESAMPLE_SPEED_LEN * sizeof(int16_t));
+	int16_t *dst1 = (int16_t *)malloc(maxDst * sizeof(int16_t));
+	int16_t *dstN = (int16_t *)malloc(maxDst * sizeof(int16_t));
+	if (src == NULL || dst1 == NULL || dstN == NULL || !ft2_workers_init()) {
+		fprintf(stderr, "resample: out of memory\n");
+		free(src); free(dst1); free(dstN);
+		return;
+	}
+
+	uint32_t seed = 0x5EED1234u;
+	for (int32_t i = 0; i < RESAMPLE_SPEED_LEN; i++) {
+		seed = seed * 1103515245u + 12345u;
+		src[i] = (int16_t)(seed >> 16);
+	}
+	for (int32_t i = 0; i < (int32_t)(sizeof(speedShifts) / sizeof(speedShifts[0])); i++)
+		runResampleSpeed(speedShifts[i], src, dst1, dstN);
+
+	ft2_workers_free();
+	free(src); free(dst1); free(dstN);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           End-to-end render benchmarks                    */
+/* ------------------------------------------------------------------------- */
+
+static void runRenderBench(const char *path, const uint32_t *rates, int32_t numRates,
+	const uint32_t *blockSizes, int32_t numBlockSizes, double seconds)
+{
+	uint32_t fileSize = 0;
+	uint8_t *fileData = ft2_test_read_file(path, &fileSize);
+	if (fileData == NULL) {
+		fprintf(stderr, "render: can't read %s\n", path);
+		return;
+	}
+
+	for (int32_t r = 0; r < numRates; r++) {
+		for (int32_t bs = 0; bs < numBlockSizes; bs++) {
+			for (int32_t multiOut = 0; multiOut <= 1; multiOut++) {
+				ft2_instance_t *inst = ft2_instance_create(rates[r]);
+				if (inst == NULL || !ft2_load_module(inst, fileData, fileSize)) {
+					fprintf(stderr, "render: can't load %s\n", path);
+					ft2_instance_destroy(inst);
+					free(fileData);
+					return;
+				}
+
+				const uint32_t blockSize = blockSizes[bs];
+				if (multiOut && !ft2_instance_set_multiout(inst, true, blockSize)) {
+					ft2_instance_destroy(inst);
+					continue;
+				}
+
+				const uint32_t numBlocks = (uint32_t)((seconds * rates[r]) / blockSize) + 1;
+				uint64_t hash = FT2_TEST_HASH_INIT;
+
+				ft2_instance_play(inst, FT2_PLAYMODE_SONG, 0);
+				double elapsed = 0.0;
+				uint32_t meteredBlocks = 0;
+				float maxPeak = 0.0f;
+				for (uint32_t b = 0; b < numBlocks; b++) {
+					const double t0 = ft2_test_now();
+					if (multiOut)
+						ft2_instance_render_multiout(inst, outL, outR, blockSize);
+					else
+						ft2_instance_render(inst, outL, outR, blockSize);
+					elapsed += ft2_test_now() - t0;
+
+					/* Read the levels like the UI would, once per block */
+					ft2_meter_snapshot_t meter;
+					if (ft2_meter_read(&inst->meter, &meter))
+						meteredBlocks++;
+					for (int32_t ch = 0; ch < meter.numChannels; ch++) {
+						if (meter.channel[ch].peakL > maxPeak) maxPeak = meter.channel[ch].peakL;
+						if (meter.channel[ch].peakR > maxPeak) maxPeak = meter.channel[ch].peakR;
+					}
+
+					if (multiOut) {
+						for (int32_t ch = 0; ch < inst->replayer.song.numChannels; ch++) {
+							if (inst->audio.fChannelBufferL[ch] != NULL) {
+								hash = ft2_test_hash_floats(hash, inst->audio.fChannelBufferL[ch], blockSize);
+								hash = ft2_test_hash_floats(hash, inst->audio.fChannelBufferR[ch], blockSize);
+							}
+						}
+					}
+					hash = ft2_test_hash_floats(hash, outL, blockSize);
+					hash = ft2_test_hash_floats(hash, outR, blockSize);
+				}
+				const double numFrames = (double)numBlocks * blockSize;
+
+				char key[256];
+				snprintf(key, sizeof(key), "render:%s:%u:%u:%s", ft2_test_base_name(path), rates[r], blockSize,
+					multiOut ? "multiout" : "stereo");
+
+				beginResult();
+				printf("{\"suite\": \"render\", \"file\": \"%s\", \"mode\": \"%s\", \"sampleRate\": %u, "
+					"\"blockSize\": %u, \"frames\": %.0f, \"seconds\": %.6f, \"realtimeFactor\": %.2f, "
+					"\"meteredBlocks\": %u, \"maxChannelPeak\": %.4f, \"hash\": \"%016llx\", \"golden\": \"%s\"}",
+					ft2_test_base_name(path), multiOut ? "multiout" : "stereo", rates[r], blockSize, numFrames, elapsed,
+					(numFrames / rates[r]) / elapsed, meteredBlocks, maxPeak, (unsigned long long)hash,
+					checkGolden(key, hash));
+
+				ft2_instance_destroy(inst);
+			}
+		}
+	}
+
+	free(fileData);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Meter cost                                   */
+/* ------------------------------------------------------------------------- */
+
+#define METER_BLOCK_SIZE 64
+
+/* Stereo render at METER_BLOCK_SIZE, with or without reading the levels
+ * after every block. Returns the realtime factor. */
+static double timeMeteredRender(const uint8_t *fileData, uint32_t fileSize, uint32_t numBlocks, bool readLevels)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (inst == NULL || !ft2_load_module(inst, fileData, fileSize)) {
+		ft2_instance_destroy(inst);
+		return 0.0;
+	}
+
+	ft2_meter_snapshot_t meter;
+	double elapsed = 0.0;
+
+	ft2_instance_play(inst, FT2_PLAYMODE_SONG, 0);
+	for (uint32_t b = 0; b < numBlocks; b++) {
+		const double t0 = ft2_test_now();
+		ft2_instance_render(inst, outL, outR, METER_BLOCK_SIZE);
+		elapsed += ft2_test_now() - t0;
+
+		if (readLevels)
+			ft2_meter_read(&inst->meter, &meter);
+	}
+
+	ft2_instance_destroy(inst);
+	return ((double)numBlocks * METER_BLOCK_SIZE / 48000) / elapsed;
+}
+
+static void runMeterBench(const char *path, double seconds)
+{
+	uint32_t fileSize = 0;
+	uint8_t *fileData = ft2_test_read_file(path, &fileSize);
+	if (fileData == NULL) {
+		fprintf(stderr, "meter: can't read %s\n", path);
+		return;
+	}
+
+	const uint32_t numBlocks = (uint32_t)((seconds * 48000) / METER_BLOCK_SIZE) + 1;
+	const double unmetered = timeMeteredRender(fileData, fileSize, numBlocks, false);
+	const double metered = timeMeteredRender(fileData, fileSize, numBlocks, true);
+
+	beginResult();
+	printf("{\"suite\": \"meter\", \"file\": \"%s\", \"blockSize\": %u, \"blocks\": %u, "
+		"\"unmeteredRealtime\": %.1f, \"meteredRealtime\": %.1f}",
+		ft2_test_base_name(path), METER_BLOCK_SIZE, numBlocks, unmetered, metered);
+
+	free(fileData);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Idle instances                               */
+/* ------------------------------------------------------------------------- */
+
+#define IDLE_INSTANCES 64
+#define IDLE_BLOCK_SIZE 512
+
+/* What every block cost before silent blocks were skipped: clear, mix, scale */
+static void renderUnskipped(ft2_instance_t *inst)
+{
+	memset(inst->audio.fMixBufferL, 0, IDLE_BLOCK_SIZE * sizeof(float));
+	memset(inst->audio.fMixBufferR, 0, IDLE_BLOCK_SIZE * sizeof(float));
+	ft2_mix_voices(inst, 0, IDLE_BLOCK_SIZE);
+
+	const float mul = inst->fAudioNormalizeMul;
+	for (uint32_t i = 0; i < IDLE_BLOCK_SIZE; i++) {
+		const float l = inst->audio.fMixBufferL[i] * mul, r = inst->audio.fMixBufferR[i] * mul;
+		outL[i] = (l < -1.0f) ? -1.0f : (l > 1.0f) ? 1.0f : l;
+		outR[i] = (r < -1.0f) ? -1.0f : (r > 1.0f) ? 1.0f : r;
+	}
+}
+
+/* Blocks of IDLE_INSTANCES instances with nothing to play, stopped (jam
+ * path) or playing an empty song */
+static void runIdleCase(ft2_instance_t **insts, bool playing, uint32_t numBlocks)
+{
+	double elapsed = 0.0, unskipped = 0.0;
+
+	for (int32_t i = 0; i < IDLE_INSTANCES; i++) {
+		if (playing)
+			ft2_instance_play(insts[i], FT2_PLAYMODE_SONG, 0);
+		else
+			ft2_instance_stop(insts[i]);
+	}
+
+	for (uint32_t b = 0; b < numBlocks; b++) {
+		for (int32_t i = 0; i < IDLE_INSTANCES; i++) {
+			const double t0 = ft2_test_now();
+			if (playing)
+				ft2_instance_render(insts[i], outL, outR, IDLE_BLOCK_SIZE);
+			else
+				ft2_mix_voices_only(insts[i], outL, outR, IDLE_BLOCK_SIZE);
+			elapsed += ft2_test_now() - t0;
+		}
+
+		for (int32_t i = 0; i < IDLE_INSTANCES; i++) {
+			const double t0 = ft2_test_now();
+			renderUnskipped(insts[i]);
+			unskipped += ft2_test_now() - t0;
+		}
+	}
+
+	const double numInstanceBlocks = (double)numBlocks * IDLE_INSTANCES;
+	const double blockSeconds = (double)IDLE_BLOCK_SIZE / insts[0]->audio.freq;
+
+	beginResult();
+	printf("{\"suite\": \"idle\", \"case\": \"%s\", \"instances\": %d, \"blockSize\": %d, \"blocks\": %u, "
+		"\"nsPerInstanceBlock\": %.1f, \"unskippedNsPerInstanceBlock\": %.1f, \"cpuPercentAllInstances\": %.4f}",
+		playing ? "playing_empty" : "stopped", IDLE_INSTANCES, IDLE_BLOCK_SIZE, numBlocks,
+		(elapsed * 1e9) / numInstanceBlocks, (unskipped * 1e9) / numInstanceBlocks,
+		((elapsed / numBlocks) / blockSeconds) * 100.0);
+}
+
+static void runIdleBench(uint32_t numBlocks)
+{
+	ft2_instance_t *insts[IDLE_INSTANCES];
+	bool ok = true;
+
+	memset(insts, 0, sizeof(insts));
+	for (int32_t i = 0; i < IDLE_INSTANCES && ok; i++) {
+		insts[i] = ft2_instance_create(48000);
+		ok = (insts[i] != NULL);
+	}
+
+	if (ok) {
+		runIdleCase(insts, false, numBlocks);
+		runIdleCase(insts, true, numBlocks);
+	} else {
+		fprintf(stderr, "idle: instance setup failed\n");
+	}
+
+	for (int32_t i = 0; i < IDLE_INSTANCES; i++)
+		ft2_instance_destroy(insts[i]);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Output stages                                */
+/* ------------------------------------------------------------------------- */
+
+#define OUTPUT_SOURCES 8
+
+static void runOutputCase(const char *name, uint32_t n, int32_t reps)
+{
+	const float mul = 0.37f;
+	float *srcs[OUTPUT_SOURCES], *ref = NULL, *dst = NULL;
+	bool ok = true;
+
+	memset(srcs, 0, sizeof(srcs));
+	for (int32_t s = 0; s < OUTPUT_SOURCES; s++) {
+		srcs[s] = (float *)malloc(n * sizeof(float));
+		if (srcs[s] == NULL)
+			ok = false;
+		else
+			ft2_test_fill_output(srcs[s], n, 0x1234u + (uint32_t)s);
+	}
+	ref = (float *)malloc(n * sizeof(float));
+	dst = (float *)malloc(n * sizeof(float));
+
+	if (!ok || ref == NULL || dst == NULL) {
+		fprintf(stderr, "output: out of memory\n");
+	} else {
+		double tScalar = 0.0, tKernel = 0.0, tSumScalar = 0.0, tSumKernel = 0.0;
+		for (int32_t r = 0; r < reps; r++) {
+			double t0 = ft2_test_now();
+			ft2_test_scale_clamp(ref, srcs[0], mul, n);
+			tScalar += ft2_test_now() - t0;
+
+			t0 = ft2_test_now();
+			ft2_output_scale_clamp(dst, srcs[0], mul, n);
+			tKernel += ft2_test_now() - t0;
+		}
+
+		for (int32_t r = 0; r < reps; r++) {
+			double t0 = ft2_test_now();
+			ft2_test_sum_scale_clamp(ref, srcs, OUTPUT_SOURCES, mul, n);
+			tSumScalar += ft2_test_now() - t0;
+
+			t0 = ft2_test_now();
+			ft2_output_sum_scale_clamp(dst, (const float *const *)srcs, OUTPUT_SOURCES, mul, n);
+			tSumKernel += ft2_test_now() - t0;
+		}
+
+		const double scaleBytes = (double)n * reps * 2 * sizeof(float);
+		const double sumBytes = (double)n * reps * (OUTPUT_SOURCES + 1) * sizeof(float);
+
+		beginResult();
+		printf("{\"suite\": \"output\", \"case\": \"%s_scale_clamp\", \"samples\": %u, "
+			"\"scalarGBps\": %.2f, \"kernelGBps\": %.2f}",
+			name, n, scaleBytes / tScalar * 1e-9, scaleBytes / tKernel * 1e-9);
+
+		beginResult();
+		printf("{\"suite\": \"output\", \"case\": \"%s_sum%d_scale_clamp\", \"samples\": %u, "
+			"\"scalarGBps\": %.2f, \"kernelGBps\": %.2f}",
+			name, OUTPUT_SOURCES, n, sumBytes / tSumScalar * 1e-9, sumBytes / tSumKernel * 1e-9);
+	}
+
+	for (int32_t s = 0; s < OUTPUT_SOURCES; s++)
+		free(srcs[s]);
+	free(ref);
+	free(dst);
+}
+
+#define DITHER_BLOCK 1021
+
+/* The standalone's 16-bit output (ft2_audio_dither.h), SSE2/NEON against
+ * the scalar loop, on blocks of every length up to 67 and then odd-length
+ * ones */
+static void runDitherCase(int32_t reps)
+{
+	const float mul = 0.37f * 32768.0f;
+	static float mixL[2][DITHER_BLOCK], mixR[2][DITHER_BLOCK];
+	static int16_t out[2][DITHER_BLOCK * 2];
+	dither_t dither[2] = { { 0x12345000, 0.0f, 0.0f }, { 0x12345000, 0.0f, 0.0f } };
+	double tScalar = 0.0, tKernel = 0.0;
+	uint64_t frames = 0;
+
+	for (int32_t r = 0; r < reps; r++) {
+		const uint32_t n = (r < 68) ? (uint32_t)r : DITHER_BLOCK;
+		ft2_test_fill_output(mixL[0], n, 0x5678u + (uint32_t)r);
+		ft2_test_fill_output(mixR[0], n, 0x9ABCu + (uint32_t)r);
+		memcpy(mixL[1], mixL[0], n * sizeof(float));
+		memcpy(mixR[1], mixR[0], n * sizeof(float));
+
+		double t0 = ft2_test_now();
+		ditherStereo16Scalar(out[0], mixL[0], mixR[0], 0, n, mul, &dither[0]);
+		tScalar += ft2_test_now() - t0;
+
+		t0 = ft2_test_now();
+		ditherStereo16(out[1], mixL[1], mixR[1], n, mul, &dither[1]);
+		tKernel += ft2_test_now() - t0;
+
+		frames += n;
+	}
+
+	beginResult();
+	printf("{\"suite\": \"output\", \"case\": \"dither16\", \"frames\": %llu, "
+		"\"scalarMfps\": %.1f, \"kernelMfps\": %.1f}",
+		(unsigned long long)frames, frames / tScalar * 1e-6, frames / tKernel * 1e-6);
+}
+
+static void runOutputBench(bool quick)
+{
+	runOutputCase("block", 1021, quick ? 2000 : 20000); /* Odd length, so the tail runs too */
+	runOutputCase("stream", 1 << 21, quick ? 4 : 40);
+	runDitherCase(quick ? 2000 : 20000);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                               Module save                                 */
+/* ------------------------------------------------------------------------- */
+
+typedef struct saveSink_t {
+	uint32_t bytes, maxChunk;
+} saveSink_t;
+
+static bool saveSinkWrite(void *userData, const uint8_t *data, uint32_t size)
+{
+	saveSink_t *sink = (saveSink_t *)userData;
+	(void)data;
+	sink->bytes += size;
+	if (size > sink->maxChunk)
+		sink->maxChunk = size;
+	return true;
+}
+
+/* ft2_save_module() (one buffer the size of the file) against the
+ * streaming writer into a sink that only counts */
+static void runSaveCase(ft2_instance_t *inst, const char *name, int32_t reps)
+{
+	double bufferTime = 0.0, streamTime = 0.0;
+	uint32_t size = 0;
+	bool ok = true;
+
+	for (int32_t r = 0; r < reps && ok; r++) {
+		uint8_t *data = NULL;
+		const double t0 = ft2_test_now();
+		ok = ft2_save_module(inst, &data, &size);
+		bufferTime += ft2_test_now() - t0;
+		free(data);
+	}
+
+	saveSink_t sink;
+	memset(&sink, 0, sizeof(sink));
+	for (int32_t r = 0; r < reps && ok; r++) {
+		sink.bytes = 0;
+		const double t0 = ft2_test_now();
+		ok = ft2_save_module_stream(inst, saveSinkWrite, &sink, NULL);
+		streamTime += ft2_test_now() - t0;
+	}
+
+	if (!ok) {
+		fprintf(stderr, "save: %s failed\n", name);
+		return;
+	}
+
+	const double mb = (double)size * reps / (1024.0 * 1024.0);
+	beginResult();
+	printf("{\"suite\": \"save\", \"case\": \"%s\", \"bytes\": %u, \"bufferMBps\": %.1f, \"streamMBps\": %.1f, "
+		"\"bufferPeakBytes\": %u, \"streamPeakBytes\": %u}",
+		name, size, mb / bufferTime, mb / streamTime, size, sink.maxChunk);
+}
+
+static void runSaveBench(bool quick, char **files, int32_t numFiles)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (inst == NULL || !ft2_test_setup_save_module(inst, quick ? (1 << 20) : (1 << 22)))
+		fprintf(stderr, "save: setup failed\n");
+	else
+		runSaveCase(inst, "synthetic", quick ? 2 : 5);
+	ft2_instance_destroy(inst);
+
+	for (int32_t i = 0; i < numFiles; i++) {
+		uint32_t fileSize = 0;
+		uint8_t *fileData = ft2_test_read_file(files[i], &fileSize);
+		inst = ft2_instance_create(48000);
+		if (fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize))
+			runSaveCase(inst, ft2_test_base_name(files[i]), quick ? 2 : 10);
+		else
+			fprintf(stderr, "save: can't load %s\n", files[i]);
+		ft2_instance_destroy(inst);
+		free(fileData);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          Packed plugin state                              */
+/* ------------------------------------------------------------------------- */
+
+typedef struct stateBuf_t {
+	uint8_t *data;
+	uint32_t size, cap;
+} stateBuf_t;
+
+static bool stateBufWrite(void *userData, const uint8_t *data, uint32_t size)
+{
+	stateBuf_t *buf = (stateBuf_t *)userData;
+	if (buf->size + size > buf->cap) {
+		const uint32_t cap = (buf->size + size) + (buf->size + size) / 2;
+		uint8_t *p = (uint8_t *)realloc(buf->data, cap);
+		if (p == NULL)
+			return false;
+		buf->data = p;
+		buf->cap = cap;
+	}
+	memcpy(&buf->data[buf->size], data, size);
+	buf->size += size;
+	return true;
+}
+
+/* Plain XM load time, or unpack + load when packed != NULL */
+static double timeStateLoad(const uint8_t *xm, uint32_t xmSize, const stateBuf_t *packed, int32_t reps, bool *ok)
+{
+	double t = 0.0;
+	uint8_t *tmp = (packed != NULL) ? (uint8_t *)malloc(xmSize) : NULL;
+
+	for (int32_t r = 0; r < reps && *ok; r++) {
+		ft2_instance_t *inst = ft2_instance_create(48000);
+		if (inst == NULL || (packed != NULL && tmp == NULL)) {
+			*ok = false;
+		} else {
+			const double t0 = ft2_test_now();
+			if (packed != NULL)
+				*ok = ft2_state_unpack(packed->data, packed->size, tmp, xmSize) && ft2_load_module(inst, tmp, xmSize);
+			else
+				*ok = ft2_load_module(inst, xm, xmSize);
+			t += ft2_test_now() - t0;
+		}
+		ft2_instance_destroy(inst);
+	}
+
+	free(tmp);
+	return t / reps;
+}
+
+static void runStateCase(ft2_instance_t *inst, const char *name, int32_t reps)
+{
+	uint8_t *xm = NULL;
+	uint32_t xmSize = 0;
+	double saveTime = 0.0, packTime = 0.0, unpackTime = 0.0;
+	bool ok = true;
+
+	for (int32_t r = 0; r < reps && ok; r++) {
+		free(xm);
+		xm = NULL;
+		const double t0 = ft2_test_now();
+		ok = ft2_save_module(inst, &xm, &xmSize);
+		saveTime += ft2_test_now() - t0;
+	}
+
+	stateBuf_t packed = { NULL, 0, 0 };
+	for (int32_t r = 0; r < reps && ok; r++) {
+		packed.size = 0;
+		const double t0 = ft2_test_now();
+		ok = ft2_state_pack_module(inst, stateBufWrite, &packed, NULL, NULL);
+		packTime += ft2_test_now() - t0;
+	}
+
+	uint8_t *unpacked = ok ? (uint8_t *)malloc(xmSize) : NULL;
+	ok = ok && unpacked != NULL;
+	for (int32_t r = 0; r < reps && ok; r++) {
+		const double t0 = ft2_test_now();
+		ok = ft2_state_unpack(packed.data, packed.size, unpacked, xmSize);
+		unpackTime += ft2_test_now() - t0;
+	}
+	free(unpacked);
+
+	const double loadTime = ok ? timeStateLoad(xm, xmSize, NULL, reps, &ok) : 0.0;
+	const double unpackLoadTime = ok ? timeStateLoad(xm, xmSize, &packed, reps, &ok) : 0.0;
+
+	if (!ok) {
+		fprintf(stderr, "state: %s failed\n", name);
+	} else {
+		const double mb = (double)xmSize * reps / (1024.0 * 1024.0);
+		beginResult();
+		printf("{\"suite\": \"state\", \"case\": \"%s\", \"xmBytes\": %u, \"packedBytes\": %u, \"ratio\": %.3f, "
+			"\"saveMBps\": %.1f, \"packMBps\": %.1f, \"unpackMBps\": %.1f, \"loadMs\": %.2f, \"unpackLoadMs\": %.2f}",
+			name, xmSize, packed.size, (xmSize > 0) ? (double)packed.size / xmSize : 0.0,
+			mb / saveTime, mb / packTime, mb / unpackTime, loadTime * 1000.0, unpackLoadTime * 1000.0);
+	}
+
+	free(packed.data);
+	free(xm);
+}
+
+static void runStateBench(bool quick, char **files, int32_t numFiles)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (inst == NULL || !ft2_test_setup_save_module(inst, quick ? (1 << 20) : (1 << 22)))
+		fprintf(stderr, "state: setup failed\n");
+	else
+		runStateCase(inst, "synthetic", quick ? 2 : 5);
+	ft2_instance_destroy(inst);
+
+	/* Silence packs closest to FT2_STATE_MAX_RATIO */
+	inst = ft2_instance_create(48000);
+	if (inst == NULL || !ft2_test_setup_silent_module(inst, quick ? (1 << 20) : (1 << 22)))
+		fprintf(stderr, "state: setup failed\n");
+	else
+		runStateCase(inst, "silent", quick ? 2 : 5);
+	ft2_instance_destroy(inst);
+
+	for (int32_t i = 0; i < numFiles; i++) {
+		uint32_t fileSize = 0;
+		uint8_t *fileData = ft2_test_read_file(files[i], &fileSize);
+		inst = ft2_instance_create(48000);
+		if (fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize))
+			runStateCase(inst, ft2_test_base_name(files[i]), quick ? 2 : 10);
+		else
+			fprintf(stderr, "state: can't load %s\n", files[i]);
+		ft2_instance_destroy(inst);
+		free(fileData);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           Trim size estimate                              */
+/* ------------------------------------------------------------------------- */
+
+typedef struct trimCase_t {
+	ft2_instance_t *inst;
+	ft2_ui_t *ui;
+	int32_t reps;
+} trimCase_t;
+
+static void trimEstimateLoop(void *arg)
+{
+	trimCase_t *c = (trimCase_t *)arg;
+	for (int32_t r = 0; r < c->reps; r++)
+		pbTrimCalc(c->inst);
+}
+
+/* The Trim screen's "Calculate" with every option but 8-bit conversion on */
+static bool setupTrimCase(trimCase_t *c, ft2_instance_t *inst, const char *name, int32_t reps)
+{
+	c->inst = inst;
+	c->ui = ft2_ui_create();
+	c->reps = reps;
+	if (c->ui == NULL)
+		return false;
+
+	inst->ui = c->ui;
+	setInitialTrimFlags(inst);
+
+	const double t0 = ft2_test_now();
+	trimEstimateLoop(c);
+	const double elapsed = ft2_test_now() - t0;
+
+	beginResult();
+	printf("{\"suite\": \"trim\", \"case\": \"%s\", \"xmBytes\": %lld, \"afterTrimBytes\": %lld, \"msPerEstimate\": %.4f}",
+		name, (long long)c->ui->trimState.xmSize64, (long long)c->ui->trimState.xmAfterTrimSize64,
+		(elapsed / reps) * 1000.0);
+	return true;
+}
+
+#define MAX_TRIM_CASES 8
+
+static void runTrimBench(bool quick, char **files, int32_t numFiles)
+{
+	trimCase_t cases[MAX_TRIM_CASES];
+	int32_t numCases = 0;
+	const int32_t reps = quick ? 5 : 50;
+
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (inst != NULL && ft2_test_setup_trim_module(inst) && setupTrimCase(&cases[numCases], inst, "synthetic", reps))
+		numCases++;
+	else {
+		fprintf(stderr, "trim: setup failed\n");
+		ft2_instance_destroy(inst);
+	}
+
+	for (int32_t i = 0; i < numFiles && numCases < MAX_TRIM_CASES; i++) {
+		uint32_t fileSize = 0;
+		uint8_t *fileData = ft2_test_read_file(files[i], &fileSize);
+		inst = ft2_instance_create(48000);
+		if (fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize) &&
+		    setupTrimCase(&cases[numCases], inst, ft2_test_base_name(files[i]), reps))
+			numCases++;
+		else {
+			fprintf(stderr, "trim: can't load %s\n", files[i]);
+			ft2_instance_destroy(inst);
+		}
+		free(fileData);
+	}
+
+	/* Every instance estimating at once, each on its own thread */
+	ft2_test_thread_t threads[MAX_TRIM_CASES];
+	bool started[MAX_TRIM_CASES];
+	const double t0 = ft2_test_now();
+	for (int32_t i = 0; i < numCases; i++) {
+		started[i] = ft2_test_thread_start(&threads[i], trimEstimateLoop, &cases[i]);
+		if (!started[i])
+			trimEstimateLoop(&cases[i]);
+	}
+	for (int32_t i = 0; i < numCases; i++) {
+		if (started[i])
+			ft2_test_thread_join(&threads[i]);
+	}
+	const double elapsed = ft2_test_now() - t0;
+
+	beginResult();
+	printf("{\"suite\": \"trim\", \"case\": \"concurrent\", \"instances\": %d, \"estimates\": %d, \"ms\": %.2f}",
+		numCases, numCases * reps, elapsed * 1000.0);
+
+	for (int32_t i = 0; i < numCases; i++) {
+		cases[i].inst->ui = NULL;
+		ft2_ui_destroy(cases[i].ui);
+		ft2_instance_destroy(cases[i].inst);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           Profiling overhead                              */
+/* ------------------------------------------------------------------------- */
+
+#define PROFILE_BLOCK_SIZE 256
+
+enum { PROFILE_NONE, PROFILE_OFF, PROFILE_ON, PROFILE_MODES };
+
+/* One block the way processBlock() profiles it (the lock and MIDI phases
+ * have nothing to do here) */
+static void renderProfiled(ft2_instance_t *inst)
+{
+	ft2_profile_block_t prof;
+	ft2_profile_begin(&prof);
+	ft2_profile_attach(&prof, &inst->profile);
+	ft2_profile_mark(&prof, FT2_PROFILE_MIDI_IN);
+	ft2_profile_mark(&prof, FT2_PROFILE_SYNC);
+	ft2_instance_render(inst, outL, outR, PROFILE_BLOCK_SIZE);
+	ft2_profile_mark(&prof, FT2_PROFILE_RENDER);
+	ft2_profile_mark(&prof, FT2_PROFILE_MIDI_OUT);
+	ft2_instance_profile_end(inst, &prof, PROFILE_BLOCK_SIZE);
+}
+
+static void runProfileBench(const char *path, double seconds)
+{
+	static const char *modeNames[PROFILE_MODES] = { "none", "off", "on" };
+
+	uint32_t fileSize = 0;
+	uint8_t *fileData = ft2_test_read_file(path, &fileSize);
+	if (fileData == NULL) {
+		fprintf(stderr, "profile: can't read %s\n", path);
+		return;
+	}
+
+	ft2_instance_t *insts[PROFILE_MODES];
+	bool ok = true;
+	for (int32_t m = 0; m < PROFILE_MODES; m++) {
+		insts[m] = ft2_instance_create(48000);
+		if (insts[m] == NULL || !ft2_load_module(insts[m], fileData, fileSize))
+			ok = false;
+	}
+	free(fileData);
+
+	if (!ok) {
+		fprintf(stderr, "profile: can't load %s\n", path);
+		for (int32_t m = 0; m < PROFILE_MODES; m++)
+			ft2_instance_destroy(insts[m]);
+		return;
+	}
+
+	ft2_profile_set_enabled(&insts[PROFILE_ON]->profile, true);
+
+	const uint32_t numBlocks = (uint32_t)((seconds * 48000.0) / PROFILE_BLOCK_SIZE) + 1;
+	double elapsed[PROFILE_MODES];
+	for (int32_t m = 0; m < PROFILE_MODES; m++) {
+		ft2_instance_play(insts[m], FT2_PLAYMODE_SONG, 0);
+		elapsed[m] = 0.0;
+	}
+
+	/* Interleaved, so all three see the same machine */
+	for (uint32_t b = 0; b < numBlocks; b++) {
+		for (int32_t m = 0; m < PROFILE_MODES; m++) {
+			const double t0 = ft2_test_now();
+			if (m == PROFILE_NONE)
+				ft2_instance_render(insts[m], outL, outR, PROFILE_BLOCK_SIZE);
+			else
+				renderProfiled(insts[m]);
+			elapsed[m] += ft2_test_now() - t0;
+		}
+	}
+
+	for (int32_t m = 0; m < PROFILE_MODES; m++) {
+		beginResult();
+		printf("{\"suite\": \"profile\", \"file\": \"%s\", \"mode\": \"%s\", \"blockSize\": %d, "
+			"\"blocks\": %u, \"nsPerBlock\": %.1f, \"overheadNsPerBlock\": %.1f}",
+			ft2_test_base_name(path), modeNames[m], PROFILE_BLOCK_SIZE, numBlocks, (elapsed[m] * 1e9) / numBlocks,
+			((elapsed[m] - elapsed[PROFILE_NONE]) * 1e9) / numBlocks);
+	}
+
+	ft2_profile_snapshot_t snap;
+	if (ft2_profile_read(&insts[PROFILE_ON]->profile, &snap)) {
+		const ft2_profile_phase_t *render = &snap.phase[FT2_PROFILE_RENDER];
+		beginResult();
+		printf("{\"suite\": \"profile\", \"file\": \"%s\", \"mode\": \"stats\", \"blocks\": %u, "
+			"\"renderP50Us\": %.2f, \"renderP99Us\": %.2f, \"renderMaxUs\": %.2f, \"blockMaxUs\": %.2f, "
+			"\"budgetUs\": %.1f, \"overruns\": %u, \"maxVoices\": %d}",
+			ft2_test_base_name(path), snap.blocks, render->p50Us, render->p99Us, render->maxUs,
+			snap.phase[FT2_PROFILE_BLOCK].maxUs, snap.budgetUs, snap.overruns, snap.maxVoices);
+	}
+
+	for (int32_t m = 0; m < PROFILE_MODES; m++)
+		ft2_instance_destroy(insts[m]);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           Editor open latency                             */
+/* ------------------------------------------------------------------------- */
+
+static void runEditorBench(int32_t cycles)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (inst == NULL) {
+		fprintf(stderr, "editor: instance setup failed\n");
+		return;
+	}
+
+	/* First open in the process decodes the GUI assets */
+	double t0 = ft2_test_now();
+	ft2_ui_t *ui = ft2_ui_create();
+	const double firstOpen = ft2_test_now() - t0;
+	const bool assetsLoaded = (ui != NULL) && ui->bmpLoaded;
+	ft2_ui_destroy(ui);
+
+	double reopenTotal = 0.0;
+	for (int32_t i = 0; i < cycles; i++) {
+		t0 = ft2_test_now();
+		ui = ft2_ui_create();
+		reopenTotal += ft2_test_now() - t0;
+		ft2_ui_destroy(ui);
+	}
+
+	beginResult();
+	printf("{\"suite\": \"editor\", \"assetsLoaded\": %s, \"firstOpenMs\": %.3f, \"reopenMs\": %.3f, \"cycles\": %d}",
+		assetsLoaded ? "true" : "false", firstOpen * 1000.0, (reopenTotal / cycles) * 1000.0, cycles);
+
+	ft2_instance_destroy(inst);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          Pattern screen redraw                            */
+/* ------------------------------------------------------------------------- */
+
+/* Pattern 0: 32 channels x 64 rows with every column filled */
+static bool setupUiPattern(ft2_instance_t *inst)
+{
+	inst->replayer.song.numChannels = 32;
+	if (!ft2_pattern_set_stride(inst, 32) || !ft2_pattern_alloc(inst, 0))
+		return false;
+
+	uint32_t seed = 0xC0FFEEu;
+	for (int32_t row = 0; row < inst->replayer.patternNumRows[0]; row++) {
+		ft2_note_t *n = ft2_pattern_row(inst, 0, row);
+		for (int32_t ch = 0; ch < 32; ch++, n++) {
+			seed = seed * 1103515245u + 12345u;
+			n->note = (uint8_t)(((seed >> 8) % 98) + 1); /* 1..96 notes, 97 = key off, 98 = empty */
+			if (n->note == 98)
+				n->note = 0;
+			n->instr = (uint8_t)((seed >> 16) % 129);
+			n->vol = (uint8_t)(0x10 + ((seed >> 4) % 0xF0));
+			n->efx = (uint8_t)((seed >> 20) % 36);
+			n->efxData = (uint8_t)(seed >> 24);
+		}
+	}
+
+	return true;
+}
+
+static void runUiBench(int32_t frames)
+{
+	static const uint8_t channelCounts[] = { 4, 8, 12 };
+
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	ft2_ui_t *ui = (inst != NULL) ? ft2_ui_create() : NULL;
+	if (ui == NULL || !ui->bmpLoaded || ui->video.frameBuffer == NULL || !setupUiPattern(inst)) {
+		fprintf(stderr, "ui: setup failed\n");
+		ft2_ui_destroy(ui);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	inst->ui = ui;
+	const size_t frameBytes = (size_t)SCREEN_W * SCREEN_H * sizeof(uint32_t);
+
+	for (int32_t c = 0; c < (int32_t)(sizeof(channelCounts) / sizeof(channelCounts[0])); c++) {
+		for (uint8_t font = 0; font < 4; font++) {
+			const uint8_t shown = channelCounts[c];
+			inst->uiState.maxVisibleChannels = shown;
+			inst->uiState.ptnFont = font;
+			inst->uiState.ptnShowVolColumn = true;
+
+			uint64_t hash = FT2_TEST_HASH_INIT;
+			double elapsed = 0.0;
+			int32_t numDraws = 0;
+
+			for (int32_t f = 0; f < frames; f++) {
+				/* Scroll through all 32 channels */
+				for (int32_t offset = 0; offset < 32; offset += shown) {
+					inst->uiState.channelOffset = (uint8_t)((offset + shown > 32) ? 32 - shown : offset);
+					inst->replayer.song.row = (int16_t)((f * 7 + offset) & 63);
+					inst->uiState.needsFullRedraw = true;
+					ui->needsFullRedraw = true;
+
+					const double t0 = ft2_test_now();
+					ft2_ui_draw(ui, inst);
+					elapsed += ft2_test_now() - t0;
+					numDraws++;
+
+					if (f == 0)
+						hash = ft2_test_hash(hash, ui->video.frameBuffer, frameBytes);
+				}
+			}
+
+			char key[128];
+			snprintf(key, sizeof(key), "ui:%u:%u", shown, font);
+
+			beginResult();
+			printf("{\"suite\": \"ui\", \"channelsShown\": %u, \"font\": %u, \"draws\": %d, "
+				"\"msPerDraw\": %.4f, \"hash\": \"%016llx\", \"golden\": \"%s\"}",
+				shown, font, numDraws, (elapsed / numDraws) * 1000.0,
+				(unsigned long long)hash, checkGolden(key, hash));
+		}
+	}
+
+	inst->ui = NULL;
+	ft2_ui_destroy(ui);
+	ft2_instance_destroy(inst);
+}
+
+int main(int argc, char *argv[])
+{
+	static const uint32_t rates[] = { 44100, 48000, 96000 };
+	static const uint32_t blockSizes[] = { 64, 256, 1024, 4096 };
+
+	bool quick = false;
+	double seconds = 10.0;
+	const char *goldenPath = NULL, *writeGoldenPath = NULL;
+	int32_t firstFile = argc;
+
+	for (int32_t i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			quick = true;
+		} else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+			seconds = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+			goldenPath = argv[++i];
+		} else if (strcmp(argv[i], "--write-golden") == 0 && i + 1 < argc) {
+			writeGoldenPath = argv[++i];
+		} else if (argv[i][0] == '-') {
+			fprintf(stderr, "usage: %s [--quick] [--seconds N] [--golden FILE | --write-golden FILE] [module ...]\n", argv[0]);
+			return 2;
+		} else {
+			firstFile = i;
+			break;
+		}
+	}
+
+	if (seconds <= 0.0)
+		seconds = 10.0;
+
+	/* Without module files, run the corpus and check it against the goldens
+	 * recorded for it (separately for --quick, which renders less) */
+	char **files = &argv[firstFile];
+	int32_t numFiles = argc - firstFile;
+	char corpusPaths[FT2_TEST_CORPUS_FILES][512], defaultGoldenPath[512];
+	char *corpusFiles[FT2_TEST_CORPUS_FILES];
+	if (numFiles == 0) {
+		for (int32_t i = 0; i < FT2_TEST_CORPUS_FILES; i++) {
+			snprintf(corpusPaths[i], sizeof(corpusPaths[i]), "%s/%s", FT2_BENCH_CORPUS_DIR, ft2_test_corpus_name(i));
+			corpusFiles[i] = corpusPaths[i];
+		}
+		files = corpusFiles;
+		numFiles = FT2_TEST_CORPUS_FILES;
+
+		if (goldenPath == NULL && writeGoldenPath == NULL) {
+			snprintf(defaultGoldenPath, sizeof(defaultGoldenPath), "%s/%s", FT2_BENCH_CORPUS_DIR,
+				quick ? "golden_quick.txt" : "golden.txt");
+			goldenPath = defaultGoldenPath;
+		}
+	}
+
+	if (goldenPath != NULL && !loadGolden(goldenPath)) {
+		fprintf(stderr, "can't read golden file %s\n", goldenPath);
+		return 2;
+	}
+
+	if (writeGoldenPath != NULL) {
+		goldenOut = fopen(writeGoldenPath, "w");
+		if (goldenOut == NULL) {
+			fprintf(stderr, "can't write golden file %s\n", writeGoldenPath);
+			return 2;
+		}
+	}
+
+	/* --quick: one rate/block size and shorter runs, for smoke testing */
+	const int32_t numRates = quick ? 1 : (int32_t)(sizeof(rates) / sizeof(rates[0]));
+	const int32_t numBlockSizes = quick ? 1 : (int32_t)(sizeof(blockSizes) / sizeof(blockSizes[0]));
+	const double mixSeconds = quick ? 0.25 : 2.0;
+	if (quick)
+		seconds = (seconds < 2.0) ? seconds : 2.0;
+
+	firstResult = true;
+	printf("{\n  \"results\": [");
+
+	runEditorBench(quick ? 10 : 100);
+	runUiBench(quick ? 5 : 50);
+	runMixBench(48000, mixSeconds);
+	runTileBench(quick ? 0.5 : 5.0);
+	runUndoBench();
+	runEchoBench();
+	runSmpFxBench(quick ? 1000000 : 10000000);
+	runResampleBench();
+	runIdleBench(quick ? 200 : 2000);
+	runOutputBench(quick);
+	runSaveBench(quick, files, numFiles);
+	runStateBench(quick, files, numFiles);
+	runTrimBench(quick, files, numFiles);
+	if (numFiles > 0)
+		runProfileBench(files[0], seconds);
+	for (int32_t i = 0; i < numFiles; i++)
+		runMeterBench(files[i], seconds);
+	for (int32_t i = 0; i < numFiles; i++)
+		runRenderBench(files[i], quick ? &rates[1] : rates, numRates, quick ? &blockSizes[2] : blockSizes, numBlockSizes, seconds);
+
+	printf("\n  ],\n  \"instance\": {\"hotBytes\": %u, \"totalBytes\": %u, \"voiceBytes\": %u},\n",
+		(unsigned)FT2_INSTANCE_HOT_BYTES, (unsigned)sizeof(ft2_instance_t), (unsigned)sizeof(ft2_voice_t));
+	printf("  \"goldenMismatches\": %d\n}\n", numMismatches);
+
+	if (goldenOut != NULL)
+		fclose(goldenOut);
+
+	return (numMismatches > 0) ? 1 : 0;
+}
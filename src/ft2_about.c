@@ -79,6 +79,7 @@ static uint32_t blendPixels(uint32_t pixelA, uint32_t pixelB, uint16_t alpha)
 static void blendPixelsXY(uint32_t x, uint32_t y, uint32_t pixelB_r, uint32_t pixelB_g, uint32_t pixelB_b, uint16_t alpha)
 {
 	uint32_t *p = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(y, 1);
 	const uint32_t pixelA = *p;
 
 	const uint16_t invAlpha = alpha ^ 0xFFFF;
@@ -169,6 +170,7 @@ static void starfield(void)
 
 		// plot center pixel
 		video.frameBuffer[(outY * SCREEN_W) + outX] = RGB32(r, g, b);
+		markFrameRows(outY, 1);
 	}
 }
 
@@ -182,6 +184,7 @@ static void oldStarfield(void)
 		if (screenBufferPos >= 0)
 		{
 			video.frameBuffer[screenBufferPos] = video.palette[PAL_BCKGRND];
+			markFrameRows(screenBufferPos / SCREEN_W, 1);
 			lastStarScreenPos[i] = -1;
 		}
 
@@ -207,6 +210,7 @@ static void oldStarfield(void)
 			if (col < 24)
 			{
 				video.frameBuffer[screenBufferPos] = video.palette[starColConv[col]];
+				markFrameRows(y + 4, 1);
 				lastStarScreenPos[i] = screenBufferPos;
 			}
 		}
@@ -262,6 +266,7 @@ void renderAboutScreenFrame(void)
 		// waving FT2 logo
 	
 		uint32_t *dstPtr = video.frameBuffer + (ABOUT_SCREEN_Y * SCREEN_W) + ABOUT_SCREEN_X;
+		markFrameRows(ABOUT_SCREEN_Y, ABOUT_SCREEN_H);
 		for (int32_t y = 0; y < ABOUT_SCREEN_H; y++, dstPtr += SCREEN_W)
 		{
 			for (int32_t x = 0; x < ABOUT_SCREEN_W; x++)
@@ -15,9 +15,18 @@
 #include "ft2_tables.h"
 #include "ft2_structs.h"
 #include "ft2_audioselector.h"
+#include "ft2_audio_dither.h"
 #include "mixer/ft2_mix.h"
 #include "mixer/ft2_silence_mix.h"
 
+#if defined _WIN32 || defined __amd64__ || (defined __i386__ && defined __SSE2__)
+#define AUDIO_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#define AUDIO_NEON
+#include <arm_neon.h>
+#endif
+
 // hide POSIX warnings
 #ifdef _MSC_VER
 #pragma warning(disable: 4996)
@@ -26,9 +35,10 @@
 #define INITIAL_DITHER_SEED 0x12345000
 
 static int32_t smpShiftValue;
-static uint32_t oldAudioFreq, tickTimeLenInt, randSeed = INITIAL_DITHER_SEED;
+static uint32_t oldAudioFreq, tickTimeLenInt;
 static uint64_t tickTimeLenFrac;
-static float fSqrtPanningTable[256+1], fAudioNormalizeMul, fPrngStateL, fPrngStateR;
+static float fSqrtPanningTable[256+1], fAudioNormalizeMul;
+static dither_t dither = { INITIAL_DITHER_SEED, 0.0f, 0.0f };
 static voice_t voice[MAX_CHANNELS * 2];
 
 // globalized
@@ -37,7 +47,6 @@ pattSyncData_t *pattSyncEntry;
 chSyncData_t *chSyncEntry;
 chSync_t chSync;
 pattSync_t pattSync;
-volatile bool pattQueueClearing, chQueueClearing;
 
 void stopVoice(int32_t i)
 {
@@ -402,56 +411,55 @@ void updateVoices(void)
 
 void resetAudioDither(void)
 {
-	randSeed = INITIAL_DITHER_SEED;
-	fPrngStateL = fPrngStateR = 0.0f;
+	dither.randSeed = INITIAL_DITHER_SEED;
+	dither.fPrngStateL = dither.fPrngStateR = 0.0f;
 }
 
-static inline int32_t random32(void)
+static void sendSamples16BitStereo(void *stream, uint32_t sampleBlockLength)
 {
-	// LCG 32-bit random
-	randSeed *= 134775813;
-	randSeed++;
-
-	return (int32_t)randSeed;
+	ditherStereo16((int16_t *)stream, audio.fMixBufferL, audio.fMixBufferR, sampleBlockLength, fAudioNormalizeMul, &dither);
 }
 
-static void sendSamples16BitStereo(void *stream, uint32_t sampleBlockLength)
+static void sendSamples32BitFloatStereo(void *stream, uint32_t sampleBlockLength)
 {
-	int32_t out32;
-	float fOut, fPrng;
+	float fOut;
+	uint32_t i = 0;
+
+	float *fStreamPtr32 = (float *)stream;
 
-	int16_t *streamPtr16 = (int16_t *)stream;
-	for (uint32_t i = 0; i < sampleBlockLength; i++)
+#if defined AUDIO_SSE2
+	const __m128 fMul = _mm_set1_ps(fAudioNormalizeMul), fLo = _mm_set1_ps(-1.0f), fHi = _mm_set1_ps(1.0f);
+	for (; i + 4 <= sampleBlockLength; i += 4)
 	{
-		// left channel - 1-bit triangular dithering
-		fPrng = (float)random32() * (1.0f / (UINT32_MAX+1.0f)); // -0.5f .. 0.5f
-		fOut = audio.fMixBufferL[i] * fAudioNormalizeMul;
-		fOut = (fOut + fPrng) - fPrngStateL;
-		fPrngStateL = fPrng;
-		out32 = (int32_t)fOut;
-		CLAMP16(out32);
-		*streamPtr16++ = (int16_t)out32;
-
-		// right channel - 1-bit triangular dithering
-		fPrng = (float)random32() * (1.0f / (UINT32_MAX+1.0f)); // -0.5f .. 0.5f
-		fOut = audio.fMixBufferR[i] * fAudioNormalizeMul;
-		fOut = (fOut + fPrng) - fPrngStateR;
-		fPrngStateR = fPrng;
-		out32 = (int32_t)fOut;
-		CLAMP16(out32);
-		*streamPtr16++ = (int16_t)out32;
+		const __m128 fL = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&audio.fMixBufferL[i]), fMul), fLo), fHi);
+		const __m128 fR = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&audio.fMixBufferR[i]), fMul), fLo), fHi);
 
 		// clear what we read from the mixing buffer
-		audio.fMixBufferL[i] = audio.fMixBufferR[i] = 0.0f;
+		_mm_storeu_ps(&audio.fMixBufferL[i], _mm_setzero_ps());
+		_mm_storeu_ps(&audio.fMixBufferR[i], _mm_setzero_ps());
+
+		_mm_storeu_ps(fStreamPtr32, _mm_unpacklo_ps(fL, fR));
+		_mm_storeu_ps(fStreamPtr32 + 4, _mm_unpackhi_ps(fL, fR));
+		fStreamPtr32 += 8;
 	}
-}
+#elif defined AUDIO_NEON
+	const float32x4_t fLo = vdupq_n_f32(-1.0f), fHi = vdupq_n_f32(1.0f);
+	for (; i + 4 <= sampleBlockLength; i += 4)
+	{
+		float32x4x2_t fLR;
+		fLR.val[0] = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(&audio.fMixBufferL[i]), fAudioNormalizeMul), fLo), fHi);
+		fLR.val[1] = vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(&audio.fMixBufferR[i]), fAudioNormalizeMul), fLo), fHi);
 
-static void sendSamples32BitFloatStereo(void *stream, uint32_t sampleBlockLength)
-{
-	float fOut;
+		// clear what we read from the mixing buffer
+		vst1q_f32(&audio.fMixBufferL[i], vdupq_n_f32(0.0f));
+		vst1q_f32(&audio.fMixBufferR[i], vdupq_n_f32(0.0f));
 
-	float *fStreamPtr32 = (float *)stream;
-	for (uint32_t i = 0; i < sampleBlockLength; i++)
+		vst2q_f32(fStreamPtr32, fLR); // interleaved
+		fStreamPtr32 += 8;
+	}
+#endif
+
+	for (; i < sampleBlockLength; i++)
 	{
 		// left channel
 		fOut = audio.fMixBufferL[i] * fAudioNormalizeMul;
@@ -503,51 +511,24 @@ void mixReplayerTickToBuffer(uint32_t samplesToMix, void *stream, uint8_t bitDep
 		sendSamples32BitFloatStereo(stream, samplesToMix);
 }
 
+/* The sync queues are single-producer (audio thread) single-consumer (video
+** thread) rings. The producer publishes an entry with a release barrier
+** before moving writePos, the consumer reads writePos and then issues an
+** acquire barrier before reading the entry. If the queue is full (the video
+** thread isn't reading, e.g. when minimized), new entries are dropped.
+*/
+
 int32_t pattQueueReadSize(void)
 {
-	while (pattQueueClearing);
+	const int32_t size = (pattSync.writePos - pattSync.readPos) & SYNC_QUEUE_LEN;
+	SDL_MemoryBarrierAcquire(); // writePos before the entries it publishes
 
-	if (pattSync.writePos > pattSync.readPos)
-		return pattSync.writePos - pattSync.readPos;
-	else if (pattSync.writePos < pattSync.readPos)
-		return pattSync.writePos - pattSync.readPos + SYNC_QUEUE_LEN + 1;
-	else
-		return 0;
+	return size;
 }
 
 int32_t pattQueueWriteSize(void)
 {
-	int32_t size;
-
-	if (pattSync.writePos > pattSync.readPos)
-	{
-		size = pattSync.readPos - pattSync.writePos + SYNC_QUEUE_LEN;
-	}
-	else if (pattSync.writePos < pattSync.readPos)
-	{
-		pattQueueClearing = true;
-
-		/* Buffer is full, reset the read/write pos. This is actually really nasty since
-		** read/write are two different threads, but because of timestamp validation it
-		** shouldn't be that dangerous.
-		** It will also create a small visual stutter while the buffer is getting filled,
-		** though that is barely noticable on normal buffer sizes, and it takes a minute
-		** or two at max BPM between each time (when queue size is default, 4095)
-		*/
-		pattSync.data[0].timestamp = 0;
-		pattSync.readPos = 0;
-		pattSync.writePos = 0;
-
-		size = SYNC_QUEUE_LEN;
-
-		pattQueueClearing = false;
-	}
-	else
-	{
-		size = SYNC_QUEUE_LEN;
-	}
-
-	return size;
+	return (pattSync.readPos - pattSync.writePos - 1) & SYNC_QUEUE_LEN;
 }
 
 bool pattQueuePush(pattSyncData_t t)
@@ -557,6 +538,7 @@ bool pattQueuePush(pattSyncData_t t)
 
 	assert(pattSync.writePos <= SYNC_QUEUE_LEN);
 	pattSync.data[pattSync.writePos] = t;
+	SDL_MemoryBarrierRelease(); // entry before the new writePos
 	pattSync.writePos = (pattSync.writePos + 1) & SYNC_QUEUE_LEN;
 
 	return true;
@@ -567,6 +549,7 @@ bool pattQueuePop(void)
 	if (!pattQueueReadSize())
 		return false;
 
+	SDL_MemoryBarrierRelease(); // done reading the entry before it can be overwritten
 	pattSync.readPos = (pattSync.readPos + 1) & SYNC_QUEUE_LEN;
 	assert(pattSync.readPos <= SYNC_QUEUE_LEN);
 
@@ -593,49 +576,15 @@ uint64_t getPattQueueTimestamp(void)
 
 int32_t chQueueReadSize(void)
 {
-	while (chQueueClearing);
+	const int32_t size = (chSync.writePos - chSync.readPos) & SYNC_QUEUE_LEN;
+	SDL_MemoryBarrierAcquire(); // writePos before the entries it publishes
 
-	if (chSync.writePos > chSync.readPos)
-		return chSync.writePos - chSync.readPos;
-	else if (chSync.writePos < chSync.readPos)
-		return chSync.writePos - chSync.readPos + SYNC_QUEUE_LEN + 1;
-	else
-		return 0;
+	return size;
 }
 
 int32_t chQueueWriteSize(void)
 {
-	int32_t size;
-
-	if (chSync.writePos > chSync.readPos)
-	{
-		size = chSync.readPos - chSync.writePos + SYNC_QUEUE_LEN;
-	}
-	else if (chSync.writePos < chSync.readPos)
-	{
-		chQueueClearing = true;
-
-		/* Buffer is full, reset the read/write pos. This is actually really nasty since
-		** read/write are two different threads, but because of timestamp validation it
-		** shouldn't be that dangerous.
-		** It will also create a small visual stutter while the buffer is getting filled,
-		** though that is barely noticable on normal buffer sizes, and it takes several
-		** minutes between each time (when queue size is default, 16384)
-		*/
-		chSync.data[0].timestamp = 0;
-		chSync.readPos = 0;
-		chSync.writePos = 0;
-
-		size = SYNC_QUEUE_LEN;
-
-		chQueueClearing = false;
-	}
-	else
-	{
-		size = SYNC_QUEUE_LEN;
-	}
-
-	return size;
+	return (chSync.readPos - chSync.writePos - 1) & SYNC_QUEUE_LEN;
 }
 
 bool chQueuePush(chSyncData_t t)
@@ -645,6 +594,7 @@ bool chQueuePush(chSyncData_t t)
 
 	assert(chSync.writePos <= SYNC_QUEUE_LEN);
 	chSync.data[chSync.writePos] = t;
+	SDL_MemoryBarrierRelease(); // entry before the new writePos
 	chSync.writePos = (chSync.writePos + 1) & SYNC_QUEUE_LEN;
 
 	return true;
@@ -655,6 +605,7 @@ bool chQueuePop(void)
 	if (!chQueueReadSize())
 		return false;
 
+	SDL_MemoryBarrierRelease(); // done reading the entry before it can be overwritten
 	chSync.readPos = (chSync.readPos + 1) & SYNC_QUEUE_LEN;
 	assert(chSync.readPos <= SYNC_QUEUE_LEN);
 
@@ -760,6 +711,19 @@ void resumeAudio(void) // unlock audio
 	audioPaused = false;
 }
 
+#ifdef HAS_MIDI
+static uint8_t midiSyncStatus[MAX_CHANNELS]; // voice triggers between ticks, for the scopes
+
+static void updateVoicesBetweenTicks(void)
+{
+	updateVoices();
+
+	channel_t *ch = channel;
+	for (int32_t i = 0; i < song.numChannels; i++, ch++)
+		midiSyncStatus[i] |= ch->tmpStatus;
+}
+#endif
+
 static void fillVisualsSyncBuffer(void)
 {
 	pattSyncData_t pattSyncData;
@@ -800,6 +764,10 @@ static void fillVisualsSyncBuffer(void)
 		c->instrNum = s->instrNum;
 		c->smpNum = s->smpNum;
 		c->status = s->tmpStatus;
+#ifdef HAS_MIDI
+		c->status |= midiSyncStatus[i];
+		midiSyncStatus[i] = 0;
+#endif
 		c->smpStartPos = s->smpStartPos;
 
 		c->pianoNoteNum = 255; // no piano key
@@ -840,12 +808,25 @@ static void SDLCALL audioCallback(void *userdata, Uint8 *stream, int len)
 
 	int32_t bufferPosition = 0;
 
+#ifdef HAS_MIDI
+	setMidiEventWindow(len);
+#endif
+
 	uint32_t samplesLeft = len;
 	while (samplesLeft > 0)
 	{
+#ifdef HAS_MIDI
+		// MIDI input is played at the sample it came in at (see ft2_midi.c)
+		if (playMidiEvents(bufferPosition, false))
+			updateVoicesBetweenTicks();
+#endif
+
 		if (audio.tickSampleCounter == 0) // new replayer tick
 		{
 			replayerBusy = true;
+#ifdef HAS_MIDI
+			playMidiEvents(bufferPosition, true); // recording, quantized to ticks
+#endif
 			if (!musicPaused) // important, don't remove this check! (also used for safety)
 			{
 				if (audio.volumeRampingFlag)
@@ -871,6 +852,12 @@ static void SDLCALL audioCallback(void *userdata, Uint8 *stream, int len)
 		if (samplesToMix > audio.tickSampleCounter)
 			samplesToMix = audio.tickSampleCounter;
 
+#ifdef HAS_MIDI
+		const int32_t midiEventOffset = getNextMidiEventOffset();
+		if (midiEventOffset > bufferPosition && (uint32_t)(midiEventOffset - bufferPosition) < samplesToMix)
+			samplesToMix = midiEventOffset - bufferPosition;
+#endif
+
 		doChannelMixing(bufferPosition, samplesToMix);
 		bufferPosition += samplesToMix;
 		
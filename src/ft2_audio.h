@@ -155,4 +155,3 @@ extern chSyncData_t *chSyncEntry;
 extern chSync_t chSync;
 extern pattSync_t pattSync;
 
-extern volatile bool pattQueueClearing, chQueueClearing;
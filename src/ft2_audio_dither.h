@@ -0,0 +1,175 @@
+#pragma once
+
+// 16-bit stereo output with 1-bit triangular dithering, for the audio callback.
+// Kept free of SDL and the audio globals so that plugin/bench/ft2_bench.c can
+// check the SSE2/NEON path against the scalar one.
+
+#include <stdint.h>
+
+#if defined _WIN32 || defined __amd64__ || (defined __i386__ && defined __SSE2__)
+#define DITHER_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON || defined __ARM_NEON__
+#define DITHER_NEON
+#include <arm_neon.h>
+#endif
+
+typedef struct dither_t
+{
+	uint32_t randSeed;
+	float fPrngStateL, fPrngStateR; // previous frame's random numbers
+} dither_t;
+
+static inline int32_t ditherRandom32(dither_t *d)
+{
+	// LCG 32-bit random
+	d->randSeed *= 134775813;
+	d->randSeed++;
+
+	return (int32_t)d->randSeed;
+}
+
+// Frames [i, numFrames) one at a time. Clears what it reads from the mixing buffers.
+static inline void ditherStereo16Scalar(int16_t *out, float *fMixL, float *fMixR, uint32_t i, uint32_t numFrames, float fMul, dither_t *d)
+{
+	int32_t out32;
+	float fOut, fPrng;
+
+	out += i * 2;
+	for (; i < numFrames; i++)
+	{
+		// left channel - 1-bit triangular dithering
+		fPrng = (float)ditherRandom32(d) * (1.0f / (UINT32_MAX+1.0f)); // -0.5f .. 0.5f
+		fOut = fMixL[i] * fMul;
+		fOut = (fOut + fPrng) - d->fPrngStateL;
+		d->fPrngStateL = fPrng;
+		out32 = (int32_t)fOut;
+		if ((int16_t)out32 != out32) out32 = 0x7FFF ^ (out32 >> 31); // CLAMP16
+		*out++ = (int16_t)out32;
+
+		// right channel - 1-bit triangular dithering
+		fPrng = (float)ditherRandom32(d) * (1.0f / (UINT32_MAX+1.0f)); // -0.5f .. 0.5f
+		fOut = fMixR[i] * fMul;
+		fOut = (fOut + fPrng) - d->fPrngStateR;
+		d->fPrngStateR = fPrng;
+		out32 = (int32_t)fOut;
+		if ((int16_t)out32 != out32) out32 = 0x7FFF ^ (out32 >> 31); // CLAMP16
+		*out++ = (int16_t)out32;
+
+		// clear what we read from the mixing buffer
+		fMixL[i] = fMixR[i] = 0.0f;
+	}
+}
+
+#ifdef DITHER_SSE2
+static inline __m128i ditherMul32(__m128i a, __m128i b) // low 32 bits of each lane's product (SSE2 has no pmulld)
+{
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+// All frames: four at a time where SSE2 or NEON is available, the rest with
+// ditherStereo16Scalar(). The output, the mixing buffers and the dither state
+// end up bit-identical to the scalar loop's.
+static inline void ditherStereo16(int16_t *out, float *fMixL, float *fMixR, uint32_t numFrames, float fMul, dither_t *d)
+{
+	uint32_t i = 0;
+
+#if defined DITHER_SSE2 || defined DITHER_NEON
+	/* Same random numbers and float math as the scalar loop. The numbers go
+	** L, R, L, R..., so a vector holds those of two frames and each lane jumps
+	** the LCG four steps.
+	*/
+	if (numFrames >= 4)
+	{
+		int16_t *streamPtr16 = out;
+		uint32_t seeds[4], jumpMul = 1, jumpAdd = 0;
+		for (int32_t j = 0; j < 4; j++)
+		{
+			seeds[j] = (uint32_t)ditherRandom32(d);
+			jumpMul *= 134775813;
+			jumpAdd = (jumpAdd * 134775813) + 1;
+		}
+
+		const float fPrngMul = 1.0f / (UINT32_MAX+1.0f);
+		const float fPrngPrev[4] = { 0.0f, 0.0f, d->fPrngStateL, d->fPrngStateR };
+		float fPrngLast[4];
+		uint32_t seedsLast[4];
+
+#ifdef DITHER_SSE2
+		const __m128 vMul = _mm_set1_ps(fMul), fPrngScale = _mm_set1_ps(fPrngMul);
+		const __m128i vJumpMul = _mm_set1_epi32((int32_t)jumpMul), vJumpAdd = _mm_set1_epi32((int32_t)jumpAdd);
+		__m128i vSeed = _mm_loadu_si128((const __m128i *)seeds), vSeedLast = vSeed;
+		__m128 fPrevPrng = _mm_loadu_ps(fPrngPrev);
+
+		for (; i + 4 <= numFrames; i += 4)
+		{
+			const __m128 fL = _mm_mul_ps(_mm_loadu_ps(&fMixL[i]), vMul);
+			const __m128 fR = _mm_mul_ps(_mm_loadu_ps(&fMixR[i]), vMul);
+
+			// clear what we read from the mixing buffer
+			_mm_storeu_ps(&fMixL[i], _mm_setzero_ps());
+			_mm_storeu_ps(&fMixR[i], _mm_setzero_ps());
+
+			const __m128 fPrng0 = _mm_mul_ps(_mm_cvtepi32_ps(vSeed), fPrngScale); // -0.5f .. 0.5f
+			vSeedLast = _mm_add_epi32(ditherMul32(vSeed, vJumpMul), vJumpAdd);
+			const __m128 fPrng1 = _mm_mul_ps(_mm_cvtepi32_ps(vSeedLast), fPrngScale);
+			vSeed = _mm_add_epi32(ditherMul32(vSeedLast, vJumpMul), vJumpAdd);
+
+			// 1-bit triangular dithering (minus the previous frame's number)
+			const __m128 fOut0 = _mm_sub_ps(_mm_add_ps(_mm_unpacklo_ps(fL, fR), fPrng0),
+				_mm_shuffle_ps(fPrevPrng, fPrng0, _MM_SHUFFLE(1, 0, 3, 2)));
+			const __m128 fOut1 = _mm_sub_ps(_mm_add_ps(_mm_unpackhi_ps(fL, fR), fPrng1),
+				_mm_shuffle_ps(fPrng0, fPrng1, _MM_SHUFFLE(1, 0, 3, 2)));
+			fPrevPrng = fPrng1;
+
+			// truncate like the (int32_t) cast, saturate like CLAMP16
+			_mm_storeu_si128((__m128i *)streamPtr16, _mm_packs_epi32(_mm_cvttps_epi32(fOut0), _mm_cvttps_epi32(fOut1)));
+			streamPtr16 += 8;
+		}
+
+		_mm_storeu_si128((__m128i *)seedsLast, vSeedLast);
+		_mm_storeu_ps(fPrngLast, fPrevPrng);
+#else
+		const uint32x4_t vJumpMul = vdupq_n_u32(jumpMul), vJumpAdd = vdupq_n_u32(jumpAdd);
+		uint32x4_t vSeed = vld1q_u32(seeds), vSeedLast = vSeed;
+		float32x4_t fPrevPrng = vld1q_f32(fPrngPrev);
+
+		for (; i + 4 <= numFrames; i += 4)
+		{
+			const float32x4_t fL = vmulq_n_f32(vld1q_f32(&fMixL[i]), fMul);
+			const float32x4_t fR = vmulq_n_f32(vld1q_f32(&fMixR[i]), fMul);
+
+			// clear what we read from the mixing buffer
+			vst1q_f32(&fMixL[i], vdupq_n_f32(0.0f));
+			vst1q_f32(&fMixR[i], vdupq_n_f32(0.0f));
+
+			const float32x4_t fPrng0 = vmulq_n_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(vSeed)), fPrngMul); // -0.5f .. 0.5f
+			vSeedLast = vmlaq_u32(vJumpAdd, vSeed, vJumpMul);
+			const float32x4_t fPrng1 = vmulq_n_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(vSeedLast)), fPrngMul);
+			vSeed = vmlaq_u32(vJumpAdd, vSeedLast, vJumpMul);
+
+			// 1-bit triangular dithering (minus the previous frame's number)
+			const float32x4x2_t fLR = vzipq_f32(fL, fR);
+			const float32x4_t fOut0 = vsubq_f32(vaddq_f32(fLR.val[0], fPrng0), vextq_f32(fPrevPrng, fPrng0, 2));
+			const float32x4_t fOut1 = vsubq_f32(vaddq_f32(fLR.val[1], fPrng1), vextq_f32(fPrng0, fPrng1, 2));
+			fPrevPrng = fPrng1;
+
+			// truncate like the (int32_t) cast, saturate like CLAMP16
+			vst1q_s16(streamPtr16, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(fOut0)), vqmovn_s32(vcvtq_s32_f32(fOut1))));
+			streamPtr16 += 8;
+		}
+
+		vst1q_u32(seedsLast, vSeedLast);
+		vst1q_f32(fPrngLast, fPrevPrng);
+#endif
+		d->randSeed = seedsLast[3];
+		d->fPrngStateL = fPrngLast[2];
+		d->fPrngStateR = fPrngLast[3];
+	}
+#endif
+
+	ditherStereo16Scalar(out, fMixL, fMixR, i, numFrames, fMul, d);
+}
@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include "ft2_header.h"
 #include "ft2_config.h"
+#include "ft2_edit.h"
 #include "ft2_keyboard.h"
 #include "ft2_audio.h"
 #include "ft2_midi.h"
@@ -35,8 +36,6 @@ static note_t trackCopyBuff[MAX_PATT_LEN];
 // for recordNote()
 static const int8_t tickArr[16] = { 16, 8, 0, 4, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1 };
 
-void recordNote(uint8_t note, int8_t vol);
-
 // when the cursor is at the note slot
 static bool testNoteKeys(SDL_Scancode scancode)
 {
@@ -329,12 +328,16 @@ static void evaluateTimeStamp(int16_t *songPos, int16_t *pattNum, int16_t *row,
 	*tick = outTick;
 }
 
-void recordNote(uint8_t noteNum, int8_t vol) // directly ported from the original FT2 code - what a mess, but it works...
+/* Picks the channel for the note and plays it (directly ported from the original
+** FT2 code - what a mess, but it works...). Pattern data isn't touched here, so
+** MIDI input can call this from the audio callback. Returns true if the note
+** should also be written to the pattern, with writeRecordedNote().
+*/
+bool triggerRecordedNote(uint8_t noteNum, int8_t vol, noteRecord_t *r)
 {
 	int8_t i;
 	int16_t pattNum, songPos, row, tick;
 	int32_t time;
-	note_t *p;
 
 	const int16_t oldRow = editor.row;
 
@@ -434,7 +437,7 @@ void recordNote(uint8_t noteNum, int8_t vol) // directly ported from the origina
 	if (vol != 0)
 	{
 		if (c < 0 || (k >= 0 && (config.multiEdit || (recmode || !editmode))))
-			return;
+			return false;
 
 		// play note
 
@@ -449,41 +452,8 @@ void recordNote(uint8_t noteNum, int8_t vol) // directly ported from the origina
 #endif
 		}
 
-		if (editmode || recmode)
-		{
-			if (allocatePattern(pattNum))
-			{
-				const int16_t numRows = patternNumRows[pattNum];
-				p = &pattern[pattNum][(row * MAX_CHANNELS) + c];
-
-				// insert data
-				p->note = noteNum;
-				if (editor.curInstr > 0)
-					p->instr = editor.curInstr;
-
-				if (vol >= 0)
-					p->vol = 0x10 + vol;
-
-				if (!recmode)
-				{
-					// increase row (only in edit mode)
-					if (numRows >= 1)
-						setPos(-1, (editor.row + editor.editRowSkip) % numRows, true);
-				}
-				else
-				{
-					// apply tick delay for note if quantization is disabled
-					if (!config.recQuant && tick > 0)
-					{
-						p->efx = 0x0E;
-						p->efxData = 0xD0 + (tick & 0x0F);
-					}
-				}
-
-				ui.updatePatternEditor = true;
-				setSongModifiedFlag();
-			}
-		}
+		if (!editmode && !recmode)
+			return false;
 	}
 	else
 	{
@@ -493,7 +463,7 @@ void recordNote(uint8_t noteNum, int8_t vol) // directly ported from the origina
 			c = k;
 
 		if (c < 0)
-			return;
+			return false;
 
 		editor.keyOffNr++;
 
@@ -509,57 +479,102 @@ void recordNote(uint8_t noteNum, int8_t vol) // directly ported from the origina
 #endif
 		}
 
-		if (config.recRelease && recmode)
-		{
-			if (allocatePattern(pattNum))
-			{
-				// insert data
+		if (!config.recRelease || !recmode)
+			return false;
+	}
 
-				int16_t numRows = patternNumRows[pattNum];
-				p = &pattern[pattNum][(row * MAX_CHANNELS) + c];
+	r->songPos = songPos;
+	r->pattNum = pattNum;
+	r->row = row;
+	r->tick = tick;
+	r->noteNum = noteNum;
+	r->vol = vol;
+	r->ch = c;
+	r->recMode = recmode;
 
-				if (p->note != 0)
-					row++;
+	return true;
+}
 
-				if (row >= numRows)
-				{
-					row = 0;
+// main thread only, this allocates patterns and moves the edit cursor
+void writeRecordedNote(const noteRecord_t *r)
+{
+	int16_t songPos = r->songPos;
+	int16_t pattNum = r->pattNum;
+	int16_t row = r->row;
 
-					if (songPlaying)
-					{
-						songPos++;
-						if (songPos >= song.songLength)
-							songPos = song.songLoopStart;
+	if (!r->recMode)
+	{
+		// edit mode: at the cursor, as the previous note moved it on
+		pattNum = editor.editPattern;
+		row = editor.row;
+	}
 
-						pattNum = song.orders[songPos];
-						numRows = patternNumRows[pattNum];
-					}
-				}
+	if (!allocatePattern(pattNum))
+		return;
 
-				p = &pattern[pattNum][(row * MAX_CHANNELS) + c];
-				p->note = NOTE_OFF;
+	int16_t numRows = patternNumRows[pattNum];
+	note_t *p = &pattern[pattNum][(row * MAX_CHANNELS) + r->ch];
 
-				if (!recmode)
-				{
-					// increase row (only in edit mode)
-					if (numRows >= 1)
-						setPos(-1, (editor.row + editor.editRowSkip) % numRows, true);
-				}
-				else
-				{
-					// apply tick delay for note if quantization is disabled
-					if (!config.recQuant && tick > 0)
-					{
-						p->efx = 0x0E;
-						p->efxData = 0xD0 + (tick & 0x0F);
-					}
-				}
+	// insert data
 
-				ui.updatePatternEditor = true;
-				setSongModifiedFlag();
+	if (r->vol != 0)
+	{
+		p->note = r->noteNum;
+		if (editor.curInstr > 0)
+			p->instr = editor.curInstr;
+
+		if (r->vol >= 0)
+			p->vol = 0x10 + r->vol;
+	}
+	else
+	{
+		if (p->note != 0)
+			row++;
+
+		if (row >= numRows)
+		{
+			row = 0;
+
+			if (songPlaying)
+			{
+				songPos++;
+				if (songPos >= song.songLength)
+					songPos = song.songLoopStart;
+
+				pattNum = song.orders[songPos];
+				numRows = patternNumRows[pattNum];
 			}
 		}
+
+		p = &pattern[pattNum][(row * MAX_CHANNELS) + r->ch];
+		p->note = NOTE_OFF;
+	}
+
+	if (!r->recMode)
+	{
+		// increase row (only in edit mode)
+		if (numRows >= 1)
+			setPos(-1, (editor.row + editor.editRowSkip) % numRows, true);
+	}
+	else
+	{
+		// apply tick delay for note if quantization is disabled
+		if (!config.recQuant && r->tick > 0)
+		{
+			p->efx = 0x0E;
+			p->efxData = 0xD0 + (r->tick & 0x0F);
+		}
 	}
+
+	ui.updatePatternEditor = true;
+	setSongModifiedFlag();
+}
+
+void recordNote(uint8_t noteNum, int8_t vol)
+{
+	noteRecord_t r;
+	if (triggerRecordedNote(noteNum, vol, &r))
+		writeRecordedNote(&r);
 }
 
 bool handleEditKeys(SDL_Keycode keycode, SDL_Scancode scancode)
@@ -1,9 +1,21 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <SDL2/SDL.h>
 
+// a played note's pattern write, for writeRecordedNote()
+typedef struct noteRecord_t
+{
+	int16_t songPos, pattNum, row, tick;
+	uint8_t noteNum;
+	int8_t vol, ch;
+	bool recMode; // else edit mode, written at the cursor
+} noteRecord_t;
+
 bool handleEditKeys(SDL_Keycode keycode, SDL_Scancode scancode);
+bool triggerRecordedNote(uint8_t noteNum, int8_t vol, noteRecord_t *r);
+void writeRecordedNote(const noteRecord_t *r);
 void recordNote(uint8_t noteNum, int8_t vol);
 void testNoteKeysRelease(SDL_Scancode scancode);
 void writeToMacroSlot(uint8_t slot);
@@ -367,6 +367,8 @@ void handleWaitVblQuirk(SDL_Event *event)
 {
 	if (event->type == SDL_WINDOWEVENT)
 	{
+		video.frameUpload.forceUpload = true; // exposed, resized etc. (the frame may not have changed)
+
 		if (event->window.event == SDL_WINDOWEVENT_HIDDEN)
 			video.windowHidden = true;
 		else if (event->window.event == SDL_WINDOWEVENT_SHOWN)
@@ -523,6 +525,9 @@ static void handleSDLEvents(void)
 	}
 
 #ifdef HAS_MIDI
+	// pattern data for MIDI input played in the audio callback
+	writeMidiRecords();
+
 	// MIDI vibrato
 	const uint8_t vibDepth = (midi.currMIDIVibDepth >> 9) & 0x0F;
 	if (vibDepth > 0)
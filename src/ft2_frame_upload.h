@@ -0,0 +1,92 @@
+#pragma once
+
+// Which part of the frame flipFrame() has to upload. The drawing routines mark
+// the rows they write to (see markFrameRows()), and only those are compared
+// with the last uploaded frame. Kept free of SDL and the video globals so that
+// src/tests/ft2_frame_upload_test.c can drive it with a synthetic frame buffer.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef struct frameUpload_t
+{
+	int32_t dirtyY1, dirtyY2; // rows drawn to since the last frame, none if dirtyY1 > dirtyY2
+	bool forceUpload; // upload the whole frame (window exposed, new texture etc.)
+	uint64_t uploaded, skipped; // frames uploaded and skipped since startup
+} frameUpload_t;
+
+static inline void frameUploadInit(frameUpload_t *f)
+{
+	f->dirtyY1 = INT32_MAX;
+	f->dirtyY2 = -1;
+	f->forceUpload = true; // nothing in the texture yet
+	f->uploaded = f->skipped = 0;
+}
+
+static inline void frameUploadMarkRows(frameUpload_t *f, int32_t y, int32_t h)
+{
+	if (h <= 0)
+		return;
+
+	if (y < f->dirtyY1)
+		f->dirtyY1 = y;
+
+	if (y+h-1 > f->dirtyY2)
+		f->dirtyY2 = y+h-1;
+}
+
+/* Compares the rows drawn to since the last call with lastFrame (w*h pixels),
+** and copies over the ones that changed. Returns false if none did and the
+** frame can be skipped, otherwise the rows to upload in *y1Out..*y2Out.
+** Rows that were only redrawn the same (the playback time, sprites drawn and
+** erased again) don't count as changed.
+*/
+static inline bool frameUploadGetChangedRows(frameUpload_t *f, const uint32_t *frame, uint32_t *lastFrame,
+	int32_t w, int32_t h, int32_t *y1Out, int32_t *y2Out)
+{
+	int32_t y1 = f->dirtyY1;
+	int32_t y2 = f->dirtyY2;
+
+	f->dirtyY1 = INT32_MAX;
+	f->dirtyY2 = -1;
+
+	const size_t rowBytes = w * sizeof (uint32_t);
+
+	if (f->forceUpload)
+	{
+		f->forceUpload = false;
+
+		y1 = 0;
+		y2 = h-1;
+	}
+	else
+	{
+		if (y1 < 0)
+			y1 = 0;
+
+		if (y2 > h-1)
+			y2 = h-1;
+
+		// narrow the rows down to the ones that changed
+		while (y1 <= y2 && memcmp(&frame[y1 * w], &lastFrame[y1 * w], rowBytes) == 0)
+			y1++;
+
+		while (y2 > y1 && memcmp(&frame[y2 * w], &lastFrame[y2 * w], rowBytes) == 0)
+			y2--;
+
+		if (y1 > y2)
+		{
+			f->skipped++;
+			return false;
+		}
+	}
+
+	memcpy(&lastFrame[y1 * w], &frame[y1 * w], (y2-y1+1) * rowBytes);
+	f->uploaded++;
+
+	*y1Out = y1;
+	*y2Out = y2;
+	return true;
+}
@@ -290,6 +290,7 @@ uint16_t textWidth16(const char *textPtr)
 void textOutTiny(int32_t xPos, int32_t yPos, char *str, uint32_t color) // A..Z/a..z and 0..9
 {
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT3_CHAR_H);
 	while (*str != '\0')
 	{
 		char chr = *str++;
@@ -358,6 +359,7 @@ void charOut(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, char chr)
 	const uint32_t pixVal = video.palette[paletteIndex];
 	const uint8_t *srcPtr = &bmp.font1[chr * FONT1_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT1_CHAR_H);
 
 	for (uint32_t y = 0; y < FONT1_CHAR_H; y++)
 	{
@@ -388,6 +390,7 @@ void charOutBg(uint16_t xPos, uint16_t yPos, uint8_t fgPalette, uint8_t bgPalett
 
 	const uint8_t *srcPtr = &bmp.font1[chr * FONT1_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT1_CHAR_H);
 
 	for (int32_t y = 0; y < FONT1_CHAR_H; y++)
 	{
@@ -425,6 +428,7 @@ void charOutShadow(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, uint8_t s
 	const uint8_t *srcPtr = &bmp.font1[chr * FONT1_CHAR_W];
 	uint32_t *dstPtr1 = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
 	uint32_t *dstPtr2 = dstPtr1 + (SCREEN_W+1);
+	markFrameRows(yPos, FONT1_CHAR_H+1);
 
 	for (int32_t y = 0; y < FONT1_CHAR_H; y++)
 	{
@@ -460,6 +464,7 @@ void charOutClipX(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, char chr,
 	const uint32_t pixVal = video.palette[paletteIndex];
 	const uint8_t *srcPtr = &bmp.font1[chr * FONT1_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT1_CHAR_H);
 
 	int32_t width = FONT1_CHAR_W;
 	if (xPos+width > clipX)
@@ -491,6 +496,7 @@ void bigCharOut(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, char chr)
 
 	const uint8_t *srcPtr = &bmp.font2[chr * FONT2_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT2_CHAR_H);
 	const uint32_t pixVal = video.palette[paletteIndex];
 
 	for (int32_t y = 0; y < FONT2_CHAR_H; y++)
@@ -522,6 +528,7 @@ static void bigCharOutShadow(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex,
 	const uint8_t *srcPtr = &bmp.font2[chr * FONT2_CHAR_W];
 	uint32_t *dstPtr1 = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
 	uint32_t *dstPtr2 = dstPtr1 + (SCREEN_W+1);
+	markFrameRows(yPos, FONT2_CHAR_H+1);
 
 	for (int32_t y = 0; y < FONT2_CHAR_H; y++)
 	{
@@ -656,6 +663,7 @@ void hexOut(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, uint32_t val, ui
 
 	const uint32_t pixVal = video.palette[paletteIndex];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT6_CHAR_H);
 
 	for (int32_t i = numDigits-1; i >= 0; i--)
 	{
@@ -685,6 +693,7 @@ void hexOutBg(uint16_t xPos, uint16_t yPos, uint8_t fgPalette, uint8_t bgPalette
 	const uint32_t fg = video.palette[fgPalette];
 	const uint32_t bg = video.palette[bgPalette];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT6_CHAR_H);
 
 	for (int32_t i = numDigits-1; i >= 0; i--)
 	{
@@ -720,6 +729,7 @@ void clearRect(uint16_t xPos, uint16_t yPos, uint16_t w, uint16_t h)
 	const uint32_t pitch = w * sizeof (int32_t);
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 	for (int32_t y = 0; y < h; y++, dstPtr += SCREEN_W)
 		memset(dstPtr, 0, pitch);
 }
@@ -730,6 +740,7 @@ void fillRect(uint16_t xPos, uint16_t yPos, uint16_t w, uint16_t h, uint8_t pale
 
 	const uint32_t pixVal = video.palette[paletteIndex];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 
 	for (int32_t y = 0; y < h; y++)
 	{
@@ -745,6 +756,7 @@ void blit32(uint16_t xPos, uint16_t yPos, const uint32_t *srcPtr, uint16_t w, ui
 	assert(srcPtr != NULL && xPos < SCREEN_W && yPos < SCREEN_H && (xPos + w) <= SCREEN_W && (yPos + h) <= SCREEN_H);
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 	for (int32_t y = 0; y < h; y++)
 	{
 		for (int32_t x = 0; x < w; x++)
@@ -763,6 +775,7 @@ void blit(uint16_t xPos, uint16_t yPos, const uint8_t *srcPtr, uint16_t w, uint1
 	assert(srcPtr != NULL && xPos < SCREEN_W && yPos < SCREEN_H && (xPos + w) <= SCREEN_W && (yPos + h) <= SCREEN_H);
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 	for (int32_t y = 0; y < h; y++)
 	{
 		for (int32_t x = 0; x < w; x++)
@@ -785,6 +798,7 @@ void blitClipX(uint16_t xPos, uint16_t yPos, const uint8_t *srcPtr, uint16_t w,
 	assert(srcPtr != NULL && xPos < SCREEN_W && yPos < SCREEN_H && (xPos + clipX) <= SCREEN_W && (yPos + h) <= SCREEN_H);
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 	for (int32_t y = 0; y < h; y++)
 	{
 		for (int32_t x = 0; x < clipX; x++)
@@ -804,6 +818,7 @@ void blitFast(uint16_t xPos, uint16_t yPos, const uint8_t *srcPtr, uint16_t w, u
 	assert(srcPtr != NULL && xPos < SCREEN_W && yPos < SCREEN_H && (xPos + w) <= SCREEN_W && (yPos + h) <= SCREEN_H);
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 	for (int32_t y = 0; y < h; y++)
 	{
 		for (int32_t x = 0; x < w; x++)
@@ -822,6 +837,7 @@ void blitFastClipX(uint16_t xPos, uint16_t yPos, const uint8_t *srcPtr, uint16_t
 	assert(srcPtr != NULL && xPos < SCREEN_W && yPos < SCREEN_H && (xPos + clipX) <= SCREEN_W && (yPos + h) <= SCREEN_H);
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, h);
 	for (int32_t y = 0; y < h; y++)
 	{
 		for (int32_t x = 0; x < clipX; x++)
@@ -841,6 +857,7 @@ void hLine(uint16_t x, uint16_t y, uint16_t w, uint8_t paletteIndex)
 	const uint32_t pixVal = video.palette[paletteIndex];
 
 	uint32_t *dstPtr = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(y, 1);
 	for (int32_t i = 0; i < w; i++)
 		dstPtr[i] = pixVal;
 }
@@ -852,6 +869,7 @@ void vLine(uint16_t x, uint16_t y, uint16_t h, uint8_t paletteIndex)
 	const uint32_t pixVal = video.palette[paletteIndex];
 
 	uint32_t *dstPtr = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(y, h);
 	for (int32_t i = 0; i < h; i++)
 	{
 		*dstPtr = pixVal;
@@ -885,6 +903,7 @@ void line(int16_t x1, int16_t x2, int16_t y1, int16_t y2, uint8_t paletteIndex)
 	uint32_t pixVal = video.palette[paletteIndex];
 	const int32_t pitch  = sy * SCREEN_W;
 	uint32_t *dst32  = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(MIN(y1, y2), ABS(dy) + 1);
 
 	// draw line
 	if (ax > ay)
@@ -280,6 +280,7 @@ static void bigTextOutHalf(uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, b
 				srcPtr += (FONT2_CHAR_H / 2) * FONT2_WIDTH;
 
 			uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + currX];
+			markFrameRows(yPos, FONT2_CHAR_H/2);
 			const uint32_t pixVal = video.palette[paletteIndex];
 
 			for (uint32_t y = 0; y < FONT2_CHAR_H/2; y++)
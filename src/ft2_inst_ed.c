@@ -1582,6 +1582,7 @@ static void pianoNumberOut(uint16_t xPos, uint16_t yPos, uint8_t fgPalette, uint
 	const uint32_t fg = video.palette[fgPalette];
 	const uint32_t bg = video.palette[bgPalette];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT8_CHAR_H);
 	const uint8_t *srcPtr = &bmp.font8[val * FONT8_CHAR_W];
 
 	for (int32_t y = 0; y < FONT8_CHAR_H; y++)
@@ -1779,6 +1780,7 @@ static void envelopeLine(int32_t envNum, int16_t x1, int16_t y1, int16_t x2, int
 	const int32_t pitch = sy * SCREEN_W;
 
 	uint32_t *dst32 = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(MIN(y1, y2), ABS(dy) + 1);
 
 	// draw line
 	if (ax > ay)
@@ -1843,6 +1845,7 @@ static void envelopePixel(int32_t envNum, int16_t x, int16_t y, uint8_t pal)
 {
 	y += (envNum == 0) ? 189 : 276;
 	video.frameBuffer[(y * SCREEN_W) + x] = video.palette[pal];
+	markFrameRows(y, 1);
 }
 
 static void envelopeDot(int32_t envNum, int16_t x, int16_t y)
@@ -1851,6 +1854,7 @@ static void envelopeDot(int32_t envNum, int16_t x, int16_t y)
 
 	const uint32_t pixVal = video.palette[PAL_BLCKTXT];
 	uint32_t *dstPtr = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(y, 3);
 
 	for (y = 0; y < 3; y++)
 	{
@@ -1870,6 +1874,7 @@ static void envelopeVertLine(int32_t envNum, int16_t x, int16_t y, uint8_t pal)
 	const uint32_t pixVal2 = video.palette[PAL_BLCKTXT];
 
 	uint32_t *dstPtr = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(y, 33*2);
 	for (y = 0; y < 33; y++)
 	{
 		if (*dstPtr != pixVal2)
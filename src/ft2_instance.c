@@ -8,10 +8,20 @@
 #include <math.h>
 #include <stdio.h>
 #include <stddef.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #include "ft2_instance.h"
 #include "ft2_plugin_replayer.h"
 #include "ft2_plugin_loader.h"
 #include "ft2_plugin_interpolation.h"
+#include "ft2_plugin_output.h"
+#include "ft2_plugin_workers.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_bmp.h"
 #include "ft2_plugin_nibbles.h"
 #include "ft2_plugin_config.h"
 
@@ -19,6 +29,12 @@
 #define DEFAULT_SAMPLE_RATE 48000
 #define TICK_TIME_FRAC_SCALE (1ULL << 52)
 
+#ifdef _MSC_VER
+#define atomicInc(p) ((uint32_t)_InterlockedIncrement((volatile long *)(p)))
+#else
+#define atomicInc(p) __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#endif
+
 /* Period lookup tables (from ft2_tables_plugin.c) */
 extern const uint16_t linearPeriodLUT[1936];
 extern const uint16_t amigaPeriodLUT[1936];
@@ -29,10 +45,14 @@ static void calcPanningTableInstance(ft2_instance_t *inst)
 		inst->fSqrtPanningTable[i] = sqrtf((float)i / 256.0f);
 }
 
-static void calcReplayerVarsInstance(ft2_instance_t *inst, uint32_t sampleRate)
+static bool calcReplayerVarsInstance(ft2_instance_t *inst, uint32_t sampleRate)
 {
 	if (sampleRate == 0)
-		return;
+		return false;
+
+	/* Period->delta tables are shared by every instance running at this rate */
+	if (!ft2_rate_tables_set(&inst->rateTables, sampleRate))
+		return false;
 
 	inst->sampleRate = sampleRate;
 	inst->audio.freq = sampleRate;
@@ -62,20 +82,11 @@ static void calcReplayerVarsInstance(ft2_instance_t *inst, uint32_t sampleRate)
 
 	inst->audio.fQuickVolRampSamplesMul = 1.0f / (float)inst->audio.quickVolRampSamples;
 
-	/* Calculate logTab - matches standalone calcMiscReplayerVars() + calcReplayerVars() */
-	const double logTabMul = (UINT32_MAX + 1.0) / dSampleRate;
-	for (int32_t i = 0; i < 4 * 12 * 16; i++)
-	{
-		const double dLogTabVal = (8363.0 * 256.0) * exp2(i / (4.0 * 12.0 * 16.0));
-		inst->replayer.dLogTab[i] = dLogTabVal;
-		inst->replayer.logTab[i] = (uint64_t)round(dLogTabVal * logTabMul);
-	}
-
 	/* Calculate dExp2MulTab - matches standalone calcMiscReplayerVars() */
 	for (int32_t i = 0; i < 32; i++)
 		inst->replayer.dExp2MulTab[i] = 1.0 / exp2(i);
 
-	inst->replayer.amigaPeriodDiv = (uint64_t)round((UINT32_MAX + 1.0) * (1712.0 * 8363.0) / dSampleRate);
+	return true;
 }
 
 static void initReplayerState(ft2_instance_t *inst)
@@ -101,25 +112,7 @@ static void initReplayerState(ft2_instance_t *inst)
 	inst->replayer.song.globalVolume = 64;
 	inst->replayer.song.numChannels = 8;
 	inst->replayer.song.songLength = 1;
-
-	/* Initialize scope delta lookup tables (matching standalone calcMiscReplayerVars) */
-	#define SCOPE_FRAC_SCALE ((int64_t)1 << 32)
-	#define SCOPE_HZ 64
-	#define C4_FREQ 8363.0
-
-	for (int32_t i = 0; i < 4*12*16; i++)
-	{
-		double dLogTab = (8363.0 * 256.0) * exp2(i / (4.0 * 12.0 * 16.0));
-		inst->replayer.scopeLogTab[i] = (uint64_t)round(dLogTab * (SCOPE_FRAC_SCALE / SCOPE_HZ));
-		inst->replayer.scopeDrawLogTab[i] = (uint64_t)round(dLogTab * (SCOPE_FRAC_SCALE / (C4_FREQ / 2.0)));
-	}
-
-	inst->replayer.scopeAmigaPeriodDiv = (uint64_t)round((SCOPE_FRAC_SCALE * (1712.0 * 8363.0)) / SCOPE_HZ);
-	inst->replayer.scopeDrawAmigaPeriodDiv = (uint64_t)round((SCOPE_FRAC_SCALE * (1712.0 * 8363.0)) / (C4_FREQ / 2.0));
-
-	#undef SCOPE_FRAC_SCALE
-	#undef SCOPE_HZ
-	#undef C4_FREQ
+	inst->replayer.patternStride = 8;
 }
 
 static void initAudioState(ft2_instance_t *inst)
@@ -216,15 +209,15 @@ static void initCursor(ft2_instance_t *inst)
 
 static void initDiskopState(ft2_instance_t *inst)
 {
-	memset(&inst->diskop, 0, sizeof(ft2_diskop_state_t));
-	inst->diskop.selectedEntry = -1;
-	inst->diskop.requestOpenEntry = -1;
-	inst->diskop.requestLoadEntry = -1;
-	inst->diskop.itemType = FT2_DISKOP_ITEM_MODULE;
-	inst->diskop.saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_XM;
-	inst->diskop.saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_WAV;
-	inst->diskop.firstOpen = true;
-	inst->diskop.lastClickedEntry = -1;
+	memset(inst->diskop, 0, sizeof(ft2_diskop_state_t));
+	inst->diskop->selectedEntry = -1;
+	inst->diskop->requestOpenEntry = -1;
+	inst->diskop->requestLoadEntry = -1;
+	inst->diskop->itemType = FT2_DISKOP_ITEM_MODULE;
+	inst->diskop->saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_XM;
+	inst->diskop->saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_WAV;
+	inst->diskop->firstOpen = true;
+	inst->diskop->lastClickedEntry = -1;
 }
 
 /* --------------------------------------------------------------------- */
@@ -240,7 +233,10 @@ void ft2_scope_sync_queue_push(ft2_instance_t *inst, const ft2_scope_sync_entry_
 	int32_t nextWritePos = (q->writePos + 1) % FT2_SCOPE_SYNC_QUEUE_LEN;
 	
 	if (nextWritePos == q->readPos)
-		return; /* Queue full, drop entry */
+	{
+		q->dropped++; /* Queue full, drop entry */
+		return;
+	}
 	
 	q->entries[q->writePos] = *entry;
 	q->writePos = nextWritePos;
@@ -270,7 +266,10 @@ void ft2_midi_queue_push(ft2_instance_t *inst, const ft2_midi_event_t *event)
 	int32_t nextWritePos = (q->writePos + 1) % FT2_MIDI_QUEUE_LEN;
 	
 	if (nextWritePos == q->readPos)
-		return; /* Queue full, drop event */
+	{
+		q->dropped++; /* Queue full, drop event */
+		return;
+	}
 	
 	q->events[q->writePos] = *event;
 	q->writePos = nextWritePos;
@@ -300,22 +299,80 @@ void ft2_midi_queue_clear(ft2_instance_t *inst)
 	inst->midiOutQueue.writePos = 0;
 }
 
+/* The instance is cache-line aligned so the hot block starts on a line */
+static ft2_instance_t *allocInstance(void)
+{
+	void *p;
+#ifdef _WIN32
+	p = _aligned_malloc(sizeof(ft2_instance_t), FT2_CACHE_LINE_SIZE);
+#else
+	if (posix_memalign(&p, FT2_CACHE_LINE_SIZE, sizeof(ft2_instance_t)) != 0)
+		p = NULL;
+#endif
+	if (p == NULL)
+		return NULL;
+
+	memset(p, 0, sizeof(ft2_instance_t));
+
+	ft2_instance_t *inst = (ft2_instance_t *)p;
+	inst->diskop = (ft2_diskop_state_t *)calloc(1, sizeof(ft2_diskop_state_t));
+	inst->nibbles = (ft2_nibbles_state_t *)calloc(1, sizeof(ft2_nibbles_state_t));
+	return inst;
+}
+
+static void freeInstance(ft2_instance_t *inst)
+{
+	free(inst->diskop);
+	free(inst->nibbles);
+#ifdef _WIN32
+	_aligned_free(inst);
+#else
+	free(inst);
+#endif
+}
+
 ft2_instance_t *ft2_instance_create(uint32_t sampleRate)
 {
-	ft2_instance_t *inst = (ft2_instance_t *)calloc(1, sizeof(ft2_instance_t));
+	ft2_instance_t *inst = allocInstance();
 	if (inst == NULL)
 		return NULL;
 
+	if (inst->diskop == NULL || inst->nibbles == NULL)
+	{
+		freeInstance(inst);
+		return NULL;
+	}
+
 	if (sampleRate == 0)
 		sampleRate = DEFAULT_SAMPLE_RATE;
 
 	/* Initialize global interpolation tables (ref counted) */
 	if (!ft2_interp_tables_init())
 	{
-		free(inst);
+		freeInstance(inst);
 		return NULL;
 	}
 
+	/* Shared worker pool for parallel sample decoding (ref counted) */
+	if (!ft2_workers_init())
+	{
+		ft2_interp_tables_free();
+		freeInstance(inst);
+		return NULL;
+	}
+
+	/* Shared sample data store (ref counted) */
+	if (!ft2_sample_pool_init())
+	{
+		ft2_workers_free();
+		ft2_interp_tables_free();
+		freeInstance(inst);
+		return NULL;
+	}
+
+	/* Keep the GUI asset cache alive while the instance exists (decoded on first editor open) */
+	ft2_bmp_cache_retain();
+
 	inst->randSeed = INITIAL_DITHER_SEED;
 
 	initAudioState(inst);
@@ -327,9 +384,15 @@ ft2_instance_t *ft2_instance_create(uint32_t sampleRate)
 	initDiskopState(inst);
 	ft2_nibbles_init(inst);  /* Initialize nibbles game state */
 	ft2_config_init(&inst->config);  /* Initialize per-instance config */
+	ft2_meter_init(&inst->meter);
+	ft2_profile_init(&inst->profile);
 	ft2_timemap_init(&inst->timemap);  /* Initialize DAW position sync time map */
 	calcPanningTableInstance(inst);
-	calcReplayerVarsInstance(inst, sampleRate);
+	if (!calcReplayerVarsInstance(inst, sampleRate))
+	{
+		ft2_instance_destroy(inst);
+		return NULL;
+	}
 	ft2_instance_init_bpm_vars(inst);
 	ft2_instance_set_audio_amp(inst, inst->config.boostLevel, inst->config.masterVol);
 	
@@ -341,7 +404,8 @@ ft2_instance_t *ft2_instance_create(uint32_t sampleRate)
 	/* Allocate default instrument (curInstr=1) so sample names can be edited */
 	ft2_instance_alloc_instr(inst, 1);
 
-	const uint32_t maxSamplesPerTick = inst->audio.samplesPerTickIntTab[FT2_MAX_BPM - FT2_MIN_BPM] + 1;
+	/* Longest tick (lowest BPM): ft2_instance_render mixes up to a whole tick at once */
+	const uint32_t maxSamplesPerTick = inst->audio.samplesPerTickIntTab[0] + 1;
 
 	inst->audio.fMixBufferL = (float *)calloc(maxSamplesPerTick * 2, sizeof(float));
 	inst->audio.fMixBufferR = (float *)calloc(maxSamplesPerTick * 2, sizeof(float));
@@ -379,16 +443,31 @@ void ft2_instance_destroy(ft2_instance_t *inst)
 	}
 
 	/* Free diskop file list */
-	if (inst->diskop.entries != NULL)
-		free(inst->diskop.entries);
+	if (inst->diskop != NULL && inst->diskop->entries != NULL)
+		free(inst->diskop->entries);
 
 	/* Free time map */
 	ft2_timemap_free(&inst->timemap);
 
+	/* Release reference to the shared period tables */
+	ft2_rate_tables_clear(&inst->rateTables);
+
 	/* Release reference to global interpolation tables */
 	ft2_interp_tables_free();
 
-	free(inst);
+	/* Release reference to the shared worker pool */
+	ft2_workers_free();
+
+	/* Buffers retired by sample edits */
+	ft2_sample_handoff_free(inst);
+
+	/* Release reference to the shared sample pool (after all samples are freed) */
+	ft2_sample_pool_free();
+
+	/* Release reference to the shared GUI assets */
+	ft2_bmp_cache_release();
+
+	freeInstance(inst);
 }
 
 void ft2_instance_reset(ft2_instance_t *inst)
@@ -432,9 +511,12 @@ void ft2_instance_set_sample_rate(ft2_instance_t *inst, uint32_t sampleRate)
 	if (inst == NULL || sampleRate == 0)
 		return;
 
-	calcReplayerVarsInstance(inst, sampleRate);
+	/* On allocation failure the instance keeps running at its old rate */
+	if (!calcReplayerVarsInstance(inst, sampleRate))
+		return;
 
-	const uint32_t maxSamplesPerTick = inst->audio.samplesPerTickIntTab[FT2_MAX_BPM - FT2_MIN_BPM] + 1;
+	/* Longest tick (lowest BPM): ft2_instance_render mixes up to a whole tick at once */
+	const uint32_t maxSamplesPerTick = inst->audio.samplesPerTickIntTab[0] + 1;
 
 	float *newL = (float *)realloc(inst->audio.fMixBufferL, maxSamplesPerTick * 2 * sizeof(float));
 	float *newR = (float *)realloc(inst->audio.fMixBufferR, maxSamplesPerTick * 2 * sizeof(float));
@@ -505,7 +587,7 @@ void ft2_instance_free_instr(ft2_instance_t *inst, int32_t insNum)
 	{
 		if (s->origDataPtr != NULL)
 		{
-			free(s->origDataPtr);
+			ft2_sample_pool_release(s->origDataPtr);
 			s->origDataPtr = NULL;
 		}
 		s->dataPtr = NULL;
@@ -529,15 +611,175 @@ void ft2_instance_free_all_patterns(ft2_instance_t *inst)
 	if (inst == NULL)
 		return;
 
+	ft2_note_t *oldPatt[FT2_MAX_PATTERNS];
+
+	ft2_pattern_swap_begin(inst);
+	for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
+	{
+		oldPatt[i] = inst->replayer.pattern[i];
+		inst->replayer.pattern[i] = NULL;
+		inst->replayer.patternAllocRows[i] = 0;
+		inst->replayer.patternNumRows[i] = 64;
+	}
+	ft2_pattern_swap_end(inst);
+
+	for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
+		free(oldPatt[i]);
+
+	/* Nothing to repack, so drop any hidden channels from the stride */
+	const int32_t numChannels = inst->replayer.song.numChannels;
+	if (numChannels >= 1 && numChannels <= FT2_MAX_CHANNELS)
+		inst->replayer.patternStride = numChannels;
+}
+
+bool ft2_pattern_alloc(ft2_instance_t *inst, uint16_t pattNum)
+{
+	if (inst == NULL || pattNum >= FT2_MAX_PATTERNS)
+		return false;
+
+	ft2_replayer_state_t *rep = &inst->replayer;
+	if (rep->pattern[pattNum] != NULL)
+		return true;
+
+	int16_t numRows = rep->patternNumRows[pattNum];
+	if (numRows <= 0 || numRows > FT2_MAX_PATT_LEN)
+		numRows = rep->patternNumRows[pattNum] = 64;
+
+	rep->pattern[pattNum] = (ft2_note_t *)calloc((size_t)numRows * rep->patternStride, sizeof(ft2_note_t));
+	if (rep->pattern[pattNum] == NULL)
+		return false;
+
+	rep->patternAllocRows[pattNum] = numRows;
+	return true;
+}
+
+void ft2_pattern_free(ft2_instance_t *inst, uint16_t pattNum)
+{
+	if (inst == NULL || pattNum >= FT2_MAX_PATTERNS)
+		return;
+
+	ft2_replayer_state_t *rep = &inst->replayer;
+	ft2_note_t *oldPatt = rep->pattern[pattNum];
+	if (oldPatt != NULL)
+	{
+		/* The replayer may be reading it */
+		ft2_pattern_swap_begin(inst);
+		rep->pattern[pattNum] = NULL;
+		ft2_pattern_swap_end(inst);
+		free(oldPatt);
+	}
+	rep->patternAllocRows[pattNum] = 0;
+}
+
+bool ft2_pattern_set_num_rows(ft2_instance_t *inst, uint16_t pattNum, int16_t numRows)
+{
+	if (inst == NULL || pattNum >= FT2_MAX_PATTERNS || numRows < 1 || numRows > FT2_MAX_PATT_LEN)
+		return false;
+
+	ft2_replayer_state_t *rep = &inst->replayer;
+	ft2_note_t *oldPatt = rep->pattern[pattNum];
+
+	if (oldPatt != NULL && numRows > rep->patternAllocRows[pattNum])
+	{
+		/* Grow: new rows are empty. The replayer may be reading the old
+		 * buffer, so it is swapped out between blocks before being freed. */
+		const size_t rowBytes = (size_t)rep->patternStride * sizeof(ft2_note_t);
+		ft2_note_t *newPatt = (ft2_note_t *)calloc((size_t)numRows * rep->patternStride, sizeof(ft2_note_t));
+		if (newPatt == NULL)
+			return false;
+
+		ft2_pattern_swap_begin(inst);
+		memcpy(newPatt, oldPatt, rep->patternAllocRows[pattNum] * rowBytes);
+		rep->pattern[pattNum] = newPatt;
+		rep->patternAllocRows[pattNum] = numRows;
+		ft2_pattern_swap_end(inst);
+		free(oldPatt);
+	}
+
+	rep->patternNumRows[pattNum] = numRows;
+	return true;
+}
+
+/* New buffers for ft2_pattern_set_stride(), copied before the swap */
+typedef struct pattern_restride_t
+{
+	int32_t stride;
+	ft2_note_t *newPatt[FT2_MAX_PATTERNS];
+} pattern_restride_t;
+
+static void discardRestride(ft2_instance_t *inst, void *userData)
+{
+	(void)inst;
+	pattern_restride_t *rs = (pattern_restride_t *)userData;
 	for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
 	{
-		if (inst->replayer.pattern[i] != NULL)
+		free(rs->newPatt[i]);
+		rs->newPatt[i] = NULL;
+	}
+}
+
+static bool buildRestride(ft2_instance_t *inst, void *userData)
+{
+	pattern_restride_t *rs = (pattern_restride_t *)userData;
+	const ft2_replayer_state_t *rep = &inst->replayer;
+	const int32_t stride = rs->stride, oldStride = rep->patternStride;
+	const int32_t copyCells = (stride < oldStride) ? stride : oldStride;
+
+	for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
+	{
+		const ft2_note_t *oldPatt = rep->pattern[i];
+		if (oldPatt == NULL)
+			continue;
+
+		ft2_note_t *newPatt = (ft2_note_t *)calloc((size_t)rep->patternAllocRows[i] * stride, sizeof(ft2_note_t));
+		if (newPatt == NULL)
 		{
-			free(inst->replayer.pattern[i]);
-			inst->replayer.pattern[i] = NULL;
+			discardRestride(inst, rs);
+			return false;
 		}
-		inst->replayer.patternNumRows[i] = 64;
+
+		for (int32_t row = 0; row < rep->patternAllocRows[i]; row++)
+			memcpy(&newPatt[row * stride], &oldPatt[row * oldStride], copyCells * sizeof(ft2_note_t));
+		rs->newPatt[i] = newPatt;
 	}
+
+	return true;
+}
+
+bool ft2_pattern_set_stride(ft2_instance_t *inst, int32_t stride)
+{
+	if (inst == NULL || stride < 1 || stride > FT2_MAX_CHANNELS)
+		return false;
+
+	ft2_replayer_state_t *rep = &inst->replayer;
+	if (stride == rep->patternStride)
+		return true;
+
+	/* Everything is allocated and copied while the song keeps playing, so
+	 * a failure leaves all patterns untouched. The replayer must never
+	 * pair a pattern pointer with the other layout's stride, so only the
+	 * pointers and stride are swapped between blocks. */
+	pattern_restride_t rs;
+	memset(&rs, 0, sizeof(rs));
+	rs.stride = stride;
+	if (!ft2_pattern_swap_begin_built(inst, buildRestride, discardRestride, &rs))
+		return false;
+
+	ft2_note_t *oldPatt[FT2_MAX_PATTERNS];
+	for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
+	{
+		oldPatt[i] = rep->pattern[i];
+		if (oldPatt[i] != NULL)
+			rep->pattern[i] = rs.newPatt[i];
+	}
+	rep->patternStride = stride;
+
+	ft2_pattern_swap_end(inst);
+
+	for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
+		free(oldPatt[i]);
+
+	return true;
 }
 
 void ft2_instance_stop(ft2_instance_t *inst)
@@ -688,6 +930,7 @@ void ft2_instance_trigger_note(ft2_instance_t *inst, int8_t note, uint8_t instr,
 	
 	/* Convert period to delta using the same function as pattern playback */
 	v->delta = ft2_period_to_delta(inst, ch->outPeriod);
+	ft2_voice_update_sinc_lut(inst, v); /* Mixed before the next tick updates it */
 	
 	v->active = true;
 	
@@ -821,6 +1064,7 @@ void ft2_instance_play_sample(ft2_instance_t *inst, int8_t note, uint8_t instr,
 	uint16_t period = lut[noteIndex];
 	
 	v->delta = ft2_period_to_delta(inst, period);
+	ft2_voice_update_sinc_lut(inst, v);
 	
 	/* Initialize L/R stereo volumes for the mixer */
 	ft2_voice_update_volumes(inst, channel, FT2_CS_TRIGGER_VOICE);
@@ -945,6 +1189,82 @@ void ft2_instance_set_position(ft2_instance_t *inst, int16_t songPos, int16_t ro
 		s->row = row;
 }
 
+/* True if ft2_mix_voices() would add nothing: no voice it mixes is active */
+static bool voicesInactive(const ft2_instance_t *inst)
+{
+	const int32_t numChannels = inst->replayer.song.numChannels;
+	for (int32_t i = 0; i < numChannels; i++)
+	{
+		if (inst->voice[i].active)
+			return false;
+	}
+
+	for (int32_t i = FT2_MAX_CHANNELS; i < FT2_MAX_CHANNELS * 2; i++)
+	{
+		if (inst->voice[i].active)
+			return false;
+	}
+
+	return true;
+}
+
+int32_t ft2_instance_count_active_voices(const ft2_instance_t *inst)
+{
+	if (inst == NULL)
+		return 0;
+
+	int32_t count = 0;
+	for (int32_t i = 0; i < FT2_MAX_CHANNELS * 2; i++)
+	{
+		if (inst->voice[i].active)
+			count++;
+	}
+
+	return count;
+}
+
+void ft2_instance_profile_end(ft2_instance_t *inst, ft2_profile_block_t *block, uint32_t numSamples)
+{
+	if (inst == NULL || block == NULL || !block->active)
+		return;
+
+	ft2_profile_end(&inst->profile, block, numSamples, inst->sampleRate, ft2_instance_count_active_voices(inst),
+		inst->scopeSyncQueue.dropped, inst->midiOutQueue.dropped);
+}
+
+/*
+ * Mixes samplesToMix samples to the output at outPos. With no voice active
+ * it writes the silence the mix would have given, without clearing, mixing
+ * and scaling. Returns false in that case.
+ */
+static bool mixToOutput(ft2_instance_t *inst, float *outputL, float *outputR, uint32_t outPos, uint32_t samplesToMix)
+{
+	if (voicesInactive(inst))
+	{
+		if (outputL != NULL)
+			memset(&outputL[outPos], 0, samplesToMix * sizeof(float));
+		if (outputR != NULL)
+			memset(&outputR[outPos], 0, samplesToMix * sizeof(float));
+		return false;
+	}
+
+	/* Clear mix buffers */
+	memset(inst->audio.fMixBufferL, 0, samplesToMix * sizeof(float));
+	memset(inst->audio.fMixBufferR, 0, samplesToMix * sizeof(float));
+
+	/* Mix voices */
+	ft2_mix_voices(inst, 0, samplesToMix);
+
+	/* Copy to output with amplitude scaling (matches standalone outputAudio32) */
+	const float mul = inst->fAudioNormalizeMul;
+	if (outputL != NULL)
+		ft2_output_scale_clamp(&outputL[outPos], inst->audio.fMixBufferL, mul, samplesToMix);
+	if (outputR != NULL)
+		ft2_output_scale_clamp(&outputR[outPos], inst->audio.fMixBufferR, mul, samplesToMix);
+
+	return true;
+}
+
 void ft2_instance_render(ft2_instance_t *inst, float *outputL, float *outputR, uint32_t numSamples)
 {
 	if (inst == NULL || numSamples == 0)
@@ -953,8 +1273,11 @@ void ft2_instance_render(ft2_instance_t *inst, float *outputL, float *outputR, u
 	if (outputL == NULL && outputR == NULL)
 		return;
 
+	ft2_sample_handoff_block_begin(inst);
+
 	uint32_t samplesLeft = numSamples;
 	uint32_t outPos = 0;
+	bool silent = true;
 
 	while (samplesLeft > 0)
 	{
@@ -981,37 +1304,17 @@ void ft2_instance_render(ft2_instance_t *inst, float *outputL, float *outputR, u
 		if (samplesToMix > inst->audio.tickSampleCounter)
 			samplesToMix = inst->audio.tickSampleCounter;
 
-		/* Clear mix buffers */
-		memset(inst->audio.fMixBufferL, 0, samplesToMix * sizeof(float));
-		memset(inst->audio.fMixBufferR, 0, samplesToMix * sizeof(float));
-
-		/* Mix voices */
-		ft2_mix_voices(inst, 0, samplesToMix);
-
-		/* Copy to output with amplitude scaling (matches standalone outputAudio32) */
-		const float mul = inst->fAudioNormalizeMul;
-		for (uint32_t i = 0; i < samplesToMix; i++)
-		{
-		if (outputL != NULL)
-			{
-				float out = inst->audio.fMixBufferL[i] * mul;
-				if (out < -1.0f) out = -1.0f;
-				else if (out > 1.0f) out = 1.0f;
-				outputL[outPos + i] = out;
-			}
-		if (outputR != NULL)
-			{
-				float out = inst->audio.fMixBufferR[i] * mul;
-				if (out < -1.0f) out = -1.0f;
-				else if (out > 1.0f) out = 1.0f;
-				outputR[outPos + i] = out;
-			}
-		}
+		if (mixToOutput(inst, outputL, outputR, outPos, samplesToMix))
+			silent = false;
 
 		outPos += samplesToMix;
 		samplesLeft -= samplesToMix;
 		inst->audio.tickSampleCounter -= samplesToMix;
 	}
+
+	inst->audio.outputSilent = silent;
+	ft2_meter_publish(&inst->meter, inst->replayer.song.numChannels, numSamples, inst->fAudioNormalizeMul);
+	ft2_sample_handoff_block_end(inst);
 }
 
 void ft2_mix_voices_only(ft2_instance_t *inst, float *outputL, float *outputR, uint32_t numSamples)
@@ -1019,8 +1322,11 @@ void ft2_mix_voices_only(ft2_instance_t *inst, float *outputL, float *outputR, u
 	if (inst == NULL || numSamples == 0)
 		return;
 
+	ft2_sample_handoff_block_begin(inst);
+
 	uint32_t samplesLeft = numSamples;
 	uint32_t outPos = 0;
+	bool silent = true;
 
 	while (samplesLeft > 0)
 	{
@@ -1055,37 +1361,17 @@ void ft2_mix_voices_only(ft2_instance_t *inst, float *outputL, float *outputR, u
 		if (samplesToMix > maxChunk)
 			samplesToMix = maxChunk;
 
-		/* Clear mix buffers */
-		memset(inst->audio.fMixBufferL, 0, samplesToMix * sizeof(float));
-		memset(inst->audio.fMixBufferR, 0, samplesToMix * sizeof(float));
-
-		/* Mix voices */
-		ft2_mix_voices(inst, 0, samplesToMix);
-
-		/* Copy to output with amplitude scaling (matches standalone outputAudio32) */
-		const float mul = inst->fAudioNormalizeMul;
-		for (uint32_t i = 0; i < samplesToMix; i++)
-		{
-		if (outputL != NULL)
-			{
-				float out = inst->audio.fMixBufferL[i] * mul;
-				if (out < -1.0f) out = -1.0f;
-				else if (out > 1.0f) out = 1.0f;
-				outputL[outPos + i] = out;
-			}
-		if (outputR != NULL)
-			{
-				float out = inst->audio.fMixBufferR[i] * mul;
-				if (out < -1.0f) out = -1.0f;
-				else if (out > 1.0f) out = 1.0f;
-				outputR[outPos + i] = out;
-			}
-		}
+		if (mixToOutput(inst, outputL, outputR, outPos, samplesToMix))
+			silent = false;
 
 		outPos += samplesToMix;
 		samplesLeft -= samplesToMix;
 		inst->audio.tickSampleCounter -= samplesToMix;
 	}
+
+	inst->audio.outputSilent = silent;
+	ft2_meter_publish(&inst->meter, inst->replayer.song.numChannels, numSamples, inst->fAudioNormalizeMul);
+	ft2_sample_handoff_block_end(inst);
 }
 
 bool ft2_instance_set_multiout(ft2_instance_t *inst, bool enabled, uint32_t bufferSize)
@@ -1153,8 +1439,11 @@ void ft2_instance_render_multiout(ft2_instance_t *inst, float *mainOutL, float *
 		return;
 	}
 
+	ft2_sample_handoff_block_begin(inst);
+
 	uint32_t samplesLeft = numSamples;
 	uint32_t outPos = 0;
+	bool silent = true;
 
 	/* Clear only the 16 output buffers (routing maps 32 channels -> 16 outputs) */
 	for (int out = 0; out < FT2_NUM_OUTPUTS; out++)
@@ -1191,18 +1480,38 @@ void ft2_instance_render_multiout(ft2_instance_t *inst, float *mainOutL, float *
 			samplesToMix = maxChunk;
 
 		/* Mix each voice to its channel's buffer */
-		ft2_mix_voices_multiout(inst, outPos, samplesToMix);
+		if (!voicesInactive(inst))
+		{
+			ft2_mix_voices_multiout(inst, outPos, samplesToMix);
+			silent = false;
+		}
 
 		outPos += samplesToMix;
 		samplesLeft -= samplesToMix;
 		inst->audio.tickSampleCounter -= samplesToMix;
 	}
 
+	inst->audio.outputSilent = silent;
+	ft2_meter_publish(&inst->meter, inst->replayer.song.numChannels, numSamples, inst->fAudioNormalizeMul);
+	ft2_sample_handoff_block_end(inst);
+
+	if (silent)
+	{
+		/* The output buffers stay cleared, and scaling them gives nothing else */
+		if (mainOutL != NULL)
+			memset(mainOutL, 0, numSamples * sizeof(float));
+		if (mainOutR != NULL)
+			memset(mainOutR, 0, numSamples * sizeof(float));
+		return;
+	}
+
 	/* Sum output buffers into main output, respecting channelToMain routing */
 	const float mul = inst->fAudioNormalizeMul;
 
 	/* Track which output buses should be included in main mix */
 	bool outputToMain[FT2_NUM_OUTPUTS] = {false};
+	const float *mainSrcL[FT2_NUM_OUTPUTS], *mainSrcR[FT2_NUM_OUTPUTS];
+	int32_t numMainSrcs = 0;
 	for (int32_t ch = 0; ch < inst->replayer.song.numChannels && ch < FT2_MAX_CHANNELS; ch++)
 	{
 		if (inst->config.channelToMain[ch])
@@ -1214,47 +1523,27 @@ void ft2_instance_render_multiout(ft2_instance_t *inst, float *mainOutL, float *
 		}
 	}
 
-	/* Sum selected output buffers to main with amplitude scaling */
-	for (uint32_t i = 0; i < numSamples; i++)
+	/* Sum selected output buffers to main with amplitude scaling (in output order) */
+	for (int out = 0; out < FT2_NUM_OUTPUTS; out++)
 	{
-		float sumL = 0.0f, sumR = 0.0f;
-		for (int out = 0; out < FT2_NUM_OUTPUTS; out++)
-		{
-			if (outputToMain[out])
-			{
-				sumL += inst->audio.fChannelBufferL[out][i];
-				sumR += inst->audio.fChannelBufferR[out][i];
-			}
-		}
-
-		if (mainOutL != NULL)
-		{
-			float out = sumL * mul;
-			if (out < -1.0f) out = -1.0f;
-			else if (out > 1.0f) out = 1.0f;
-			mainOutL[i] = out;
-		}
-		if (mainOutR != NULL)
+		if (outputToMain[out])
 		{
-			float out = sumR * mul;
-			if (out < -1.0f) out = -1.0f;
-			else if (out > 1.0f) out = 1.0f;
-			mainOutR[i] = out;
+			mainSrcL[numMainSrcs] = inst->audio.fChannelBufferL[out];
+			mainSrcR[numMainSrcs] = inst->audio.fChannelBufferR[out];
+			numMainSrcs++;
 		}
 	}
 
+	if (mainOutL != NULL)
+		ft2_output_sum_scale_clamp(mainOutL, mainSrcL, numMainSrcs, mul, numSamples);
+	if (mainOutR != NULL)
+		ft2_output_sum_scale_clamp(mainOutR, mainSrcR, numMainSrcs, mul, numSamples);
+
 	/* Apply amplitude scaling to the 16 output buffers */
 	for (int out = 0; out < FT2_NUM_OUTPUTS; out++)
 	{
-		for (uint32_t i = 0; i < numSamples; i++)
-		{
-			float outL = inst->audio.fChannelBufferL[out][i] * mul;
-			float outR = inst->audio.fChannelBufferR[out][i] * mul;
-			if (outL < -1.0f) outL = -1.0f; else if (outL > 1.0f) outL = 1.0f;
-			if (outR < -1.0f) outR = -1.0f; else if (outR > 1.0f) outR = 1.0f;
-			inst->audio.fChannelBufferL[out][i] = outL;
-			inst->audio.fChannelBufferR[out][i] = outR;
-		}
+		ft2_output_scale_clamp(inst->audio.fChannelBufferL[out], inst->audio.fChannelBufferL[out], mul, numSamples);
+		ft2_output_scale_clamp(inst->audio.fChannelBufferR[out], inst->audio.fChannelBufferR[out], mul, numSamples);
 	}
 }
 
@@ -1373,6 +1662,10 @@ void ft2_sanitize_sample(ft2_sample_t *s)
 	}
 }
 
+/* Sample generations are unique across instances, which fix samples on
+** whichever thread loads or edits them */
+static volatile uint32_t sampleGeneration;
+
 /**
  * @brief Prepares sample for branchless mixer interpolation.
  *
@@ -1386,6 +1679,10 @@ void ft2_fix_sample(ft2_sample_t *s)
 	int32_t pos;
 	bool backwards;
 
+	/* Whatever happened to the sample, it is a new version of it now */
+	if (s != NULL)
+		s->generation = atomicInc(&sampleGeneration);
+
 	if (s == NULL || s->dataPtr == NULL || s->length <= 0)
 	{
 		if (s != NULL)
@@ -1396,6 +1693,10 @@ void ft2_fix_sample(ft2_sample_t *s)
 		return;
 	}
 
+	/* Pooled buffers are stored fixed; only touch a private copy */
+	if (!ft2_sample_pool_unshare(s))
+		return;
+
 	const bool sample16Bit = !!(s->flags & FT2_SAMPLE_16BIT);
 	int16_t *ptr16 = (int16_t *)s->dataPtr;
 	uint8_t loopType = s->flags & (FT2_LOOP_FWD | FT2_LOOP_BIDI);
@@ -1622,13 +1923,23 @@ void ft2_fix_sample(ft2_sample_t *s)
  * @brief Restores sample data that was modified by ft2_fix_sample().
  *
  * Call this before modifying sample data to restore original values.
+ * A buffer shared through the sample pool is copied first, so the caller
+ * always gets data it owns.
  *
  * @param s The sample to unfix.
+ * @return false if a shared buffer couldn't be copied; the data must not
+ *         be modified then.
  */
-void ft2_unfix_sample(ft2_sample_t *s)
+bool ft2_unfix_sample(ft2_sample_t *s)
 {
-	if (s == NULL || s->dataPtr == NULL || !s->isFixed)
-		return;
+	if (s == NULL || s->dataPtr == NULL)
+		return true;
+
+	if (!ft2_sample_pool_unshare(s))
+		return false;
+
+	if (!s->isFixed)
+		return true;
 
 	if (s->flags & FT2_SAMPLE_16BIT)
 	{
@@ -1644,4 +1955,5 @@ void ft2_unfix_sample(ft2_sample_t *s)
 	}
 
 	s->isFixed = false;
+	return true;
 }
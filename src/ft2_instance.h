@@ -12,13 +12,26 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "plugin/ft2_plugin_config.h"
 #include "plugin/ft2_plugin_timemap.h"
+#include "plugin/ft2_plugin_rate_tables.h"
+#include "plugin/ft2_plugin_meter.h"
+#include "plugin/ft2_plugin_profile.h"
+#include "plugin/ft2_plugin_sample_handoff.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Aligns a struct member to a cache line (ft2_instance_t is allocated aligned) */
+#define FT2_CACHE_LINE_SIZE 64
+#if defined(_MSC_VER)
+#define FT2_CACHE_ALIGNED __declspec(align(64))
+#else
+#define FT2_CACHE_ALIGNED __attribute__((aligned(64)))
+#endif
+
 /* Forward declaration for UI struct (defined in ft2_plugin_ui.h) */
 struct ft2_ui_t;
 
@@ -140,6 +153,7 @@ typedef struct ft2_sample_t
 	int16_t leftEdgeTapSamples16[FT2_MAX_TAPS * 2];
 	int16_t fixedSmp[FT2_MAX_TAPS * 2];
 	int32_t fixedPos;
+	uint32_t generation; /* New on every ft2_fix_sample(), unique across instances */
 } ft2_sample_t;
 
 /**
@@ -230,12 +244,6 @@ typedef struct ft2_audio_state_t
 	uint32_t tickSampleCounter, samplesPerTickInt;
 	uint64_t tickSampleCounterFrac, samplesPerTickFrac;
 
-	uint32_t samplesPerTickIntTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
-	uint64_t samplesPerTickFracTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
-
-	uint32_t tickTimeIntTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
-	uint64_t tickTimeFracTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
-
 	uint64_t tickTime64, tickTime64Frac;
 
 	float *fMixBufferL, *fMixBufferR;
@@ -246,6 +254,15 @@ typedef struct ft2_audio_state_t
 	float *fChannelBufferR[FT2_MAX_CHANNELS];
 	bool multiOutEnabled;
 	uint32_t multiOutBufferSize;
+
+	bool outputSilent; /* Last rendered block was silence: no voice was active in it */
+
+	/* BPM lookup tables, kept after the per-block state */
+	uint32_t samplesPerTickIntTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
+	uint64_t samplesPerTickFracTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
+
+	uint32_t tickTimeIntTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
+	uint64_t tickTimeFracTab[(FT2_MAX_BPM - FT2_MIN_BPM) + 1];
 } ft2_audio_state_t;
 
 /**
@@ -253,20 +270,25 @@ typedef struct ft2_audio_state_t
  */
 typedef struct ft2_voice_t
 {
-	const int8_t *base8, *revBase8;
-	const int16_t *base16, *revBase16;
-	bool active, samplingBackwards, isFadeOutVoice, hasLooped;
-	uint8_t scopeVolume, mixFuncOffset, panning, loopType;
+	/* First cache line: everything the per-sample mixing loop reads/writes */
+	const int8_t *base8;
+	const int16_t *base16;
+	uint64_t positionFrac, delta;
 	int32_t position, sampleEnd, loopStart, loopLength;
-	uint32_t volumeRampLength;
-	uint64_t positionFrac, delta, scopeDelta;
+	float fCurrVolumeL, fCurrVolumeR, fVolumeLDelta, fVolumeRDelta;
 
+	/* Second cache line: per-block mixer setup, then tick-rate state */
+	const int8_t *revBase8;
+	const int16_t *revBase16;
 	const int8_t *leftEdgeTaps8;
 	const int16_t *leftEdgeTaps16;
-
 	const float *fSincLUT;
-	float fVolume, fCurrVolumeL, fCurrVolumeR, fVolumeLDelta, fVolumeRDelta;
-	float fTargetVolumeL, fTargetVolumeR;
+	uint32_t volumeRampLength;
+	bool active, samplingBackwards, hasLooped;
+	uint8_t loopType, mixFuncOffset;
+	bool isFadeOutVoice;
+	uint8_t panning;
+	float fVolume, fTargetVolumeL, fTargetVolumeR;
 } ft2_voice_t;
 
 /**
@@ -280,16 +302,13 @@ typedef struct ft2_replayer_state_t
 
 	const uint16_t *note2PeriodLUT;
 	int16_t patternNumRows[FT2_MAX_PATTERNS];
+	int16_t patternAllocRows[FT2_MAX_PATTERNS]; /* Rows allocated in pattern[i] (>= patternNumRows[i]) */
+	int32_t patternStride; /* Cells per pattern row (>= song.numChannels, see ft2_pattern_set_stride) */
 	ft2_channel_t channel[FT2_MAX_CHANNELS];
 	ft2_song_t song;
 	ft2_instr_t *instr[128 + 4];
 	ft2_note_t *pattern[FT2_MAX_PATTERNS];
 
-	uint64_t logTab[4 * 12 * 16];
-	uint64_t scopeLogTab[4 * 12 * 16];
-	uint64_t scopeDrawLogTab[4 * 12 * 16];
-	uint64_t amigaPeriodDiv, scopeAmigaPeriodDiv, scopeDrawAmigaPeriodDiv;
-	double dLogTab[4 * 12 * 16];
 	double dExp2MulTab[32];
 	bool bxxOverflow;
 	ft2_note_t nilPatternLine[FT2_MAX_CHANNELS];
@@ -599,6 +618,7 @@ typedef struct ft2_scope_sync_queue_t
 	ft2_scope_sync_entry_t entries[FT2_SCOPE_SYNC_QUEUE_LEN];
 	volatile int32_t readPos;
 	volatile int32_t writePos;
+	volatile uint32_t dropped; /* Entries lost to a full queue (audio thread) */
 } ft2_scope_sync_queue_t;
 
 /**
@@ -634,26 +654,20 @@ typedef struct ft2_midi_queue_t
 	ft2_midi_event_t events[FT2_MIDI_QUEUE_LEN];
 	volatile int32_t readPos;
 	volatile int32_t writePos;
+	volatile uint32_t dropped; /* Events lost to a full queue (audio thread) */
 } ft2_midi_queue_t;
 
 typedef struct ft2_instance_t
 {
+	/*
+	 * Hot block: everything ft2_instance_render() touches per block, kept
+	 * together at the start of the (cache-line aligned) allocation.
+	 */
+	FT2_CACHE_ALIGNED ft2_voice_t voice[FT2_MAX_CHANNELS * 2];
 	ft2_audio_state_t audio;
-	ft2_replayer_state_t replayer;
-	ft2_voice_t voice[FT2_MAX_CHANNELS * 2];
-	ft2_editor_t editor;
-	ft2_ui_state_t uiState;
-	ft2_cursor_t cursor;
-	ft2_nibbles_state_t nibbles;
-	ft2_diskop_state_t diskop;   /* Disk Op. state */
-	ft2_plugin_config_t config;  /* Per-instance configuration */
-	ft2_scope_sync_queue_t scopeSyncQueue;  /* Audio-to-UI scope sync */
-	ft2_timemap_t timemap;                  /* DAW position sync time map */
-	ft2_midi_queue_t midiOutQueue;          /* MIDI output event queue */
-
-	struct ft2_ui_t *ui;  /* UI state (allocated by ft2_ui_create) */
 
 	uint32_t sampleRate;
+	const ft2_rate_tables_t *rateTables;    /* Shared period tables for sampleRate (see ft2_plugin_rate_tables.h) */
 	float fAudioNormalizeMul;
 	float fSqrtPanningTable[256 + 1];
 
@@ -663,9 +677,31 @@ typedef struct ft2_instance_t
 	uint32_t randSeed;
 	float fPrngStateL, fPrngStateR;
 
-	volatile bool scopesClearRequested;  /* Set by audio thread, cleared by UI after stopping scopes */
+	ft2_replayer_state_t replayer;
+	ft2_plugin_config_t config;             /* Per-instance configuration (read by the replayer) */
+	ft2_scope_sync_queue_t scopeSyncQueue;  /* Audio-to-UI scope sync */
+	ft2_midi_queue_t midiOutQueue;          /* MIDI output event queue */
+	ft2_meter_t meter;                      /* Channel and voice levels, published per block */
+	ft2_sample_handoff_t handoff;           /* Sample edits handed to the audio thread */
+	ft2_timemap_t timemap;                  /* DAW position sync time map */
+	volatile bool scopesClearRequested;     /* Set by audio thread, cleared by UI after stopping scopes */
+
+	/* Cold: editor/UI state, only touched by the UI thread */
+	FT2_CACHE_ALIGNED ft2_editor_t editor;
+	ft2_ui_state_t uiState;
+	ft2_cursor_t cursor;
+	ft2_diskop_state_t *diskop;   /* Disk Op. state (separate allocation) */
+	ft2_nibbles_state_t *nibbles; /* Separate allocation */
+
+	struct ft2_ui_t *ui;  /* UI state (allocated by ft2_ui_create) */
+
+	/* processBlock() timing, written by the audio thread only while enabled */
+	ft2_profile_t profile;
 } ft2_instance_t;
 
+/* Bytes of the render hot block at the start of each instance */
+#define FT2_INSTANCE_HOT_BYTES offsetof(ft2_instance_t, editor)
+
 /**
  * @brief Push scope sync entry from audio thread.
  * @param inst The instance.
@@ -822,6 +858,22 @@ void ft2_mix_voices_only(ft2_instance_t *instance, float *outputL, float *output
  */
 void ft2_instance_render_multiout(ft2_instance_t *instance, float *mainOutL, float *mainOutR, uint32_t numSamples);
 
+/**
+ * @brief Counts the voices that are playing (fadeout voices included).
+ * @param instance The instance.
+ * @return Number of active voices.
+ */
+int32_t ft2_instance_count_active_voices(const ft2_instance_t *instance);
+
+/**
+ * @brief Adds a profiled processBlock() to the instance's stats (audio thread).
+ * @param instance The instance.
+ * @param block Phase times, from ft2_profile_begin()/ft2_profile_attach().
+ * @param numSamples Length of the block.
+ * @note Does nothing if profiling was off when the block was attached.
+ */
+void ft2_instance_profile_end(ft2_instance_t *instance, ft2_profile_block_t *block, uint32_t numSamples);
+
 /**
  * @brief Enable/disable multi-output mode and allocate buffers.
  * @param instance The instance.
@@ -874,6 +926,69 @@ void ft2_instance_free_all_instr(ft2_instance_t *instance);
  */
 void ft2_instance_free_all_patterns(ft2_instance_t *instance);
 
+/**
+ * @brief Allocates an empty pattern (patternNumRows rows, no-op if it exists).
+ * @param instance The instance.
+ * @param pattNum Pattern number (0-255).
+ * @return true on success.
+ */
+bool ft2_pattern_alloc(ft2_instance_t *instance, uint16_t pattNum);
+
+/**
+ * @brief Frees a pattern.
+ * @param instance The instance.
+ * @param pattNum Pattern number (0-255).
+ */
+void ft2_pattern_free(ft2_instance_t *instance, uint16_t pattNum);
+
+/**
+ * @brief Sets a pattern's row count, growing its allocation if needed.
+ *
+ * Rows beyond the new length are kept when shrinking (like FT2), so
+ * growing again restores them.
+ *
+ * @param instance The instance.
+ * @param pattNum Pattern number (0-255).
+ * @param numRows New row count (1-256).
+ * @return false if the allocation failed (row count unchanged).
+ */
+bool ft2_pattern_set_num_rows(ft2_instance_t *instance, uint16_t pattNum, int16_t numRows);
+
+/**
+ * @brief Repacks all patterns to a new row stride (cells per row).
+ *
+ * Patterns are stored compactly with a stride equal to the song's channel
+ * count. Loaders set it to the channel count; adding channels grows it,
+ * removing channels leaves it so notes in hidden channels are preserved.
+ * Like ft2_pattern_set_num_rows() and ft2_pattern_free(), it swaps the
+ * buffers between audio blocks (ft2_pattern_swap_begin()), so it is safe
+ * while the song plays but must not be called from inside a block.
+ *
+ * @param instance The instance.
+ * @param stride New stride (1-32).
+ * @return false if an allocation failed (all patterns unchanged).
+ */
+bool ft2_pattern_set_stride(ft2_instance_t *instance, int32_t stride);
+
+/**
+ * @brief Returns a pointer to the first cell of a pattern row, or NULL if
+ * the pattern is empty. Cells are replayer.patternStride apart per row.
+ */
+static inline ft2_note_t *ft2_pattern_row(ft2_instance_t *instance, uint16_t pattNum, int32_t row)
+{
+	ft2_note_t *p = instance->replayer.pattern[pattNum];
+	return (p == NULL) ? NULL : &p[row * instance->replayer.patternStride];
+}
+
+/**
+ * @brief Returns a pointer to a pattern cell, or NULL if the pattern is empty.
+ */
+static inline ft2_note_t *ft2_pattern_note(ft2_instance_t *instance, uint16_t pattNum, int32_t row, int32_t ch)
+{
+	ft2_note_t *p = instance->replayer.pattern[pattNum];
+	return (p == NULL) ? NULL : &p[(row * instance->replayer.patternStride) + ch];
+}
+
 /**
  * @brief Sets the interpolation type for audio mixing.
  * @param instance The instance.
@@ -915,7 +1030,8 @@ void ft2_sanitize_sample(ft2_sample_t *s);
  * @brief Prepares sample for branchless mixer interpolation.
  *
  * Modifies samples before index 0, and after loop/end for interpolation.
- * This must be called after loading or modifying sample data.
+ * This must be called after loading or modifying sample data. It also
+ * gives the sample a new generation, which the undo journal checks.
  *
  * @param s The sample to fix.
  */
@@ -925,10 +1041,14 @@ void ft2_fix_sample(ft2_sample_t *s);
  * @brief Restores sample data that was modified by ft2_fix_sample().
  *
  * Call this before modifying sample data to restore original values.
+ * A buffer shared through the sample pool is copied first, so the caller
+ * always gets data it owns.
  *
  * @param s The sample to unfix.
+ * @return false if a shared buffer couldn't be copied; the data must not
+ *         be modified then.
  */
-void ft2_unfix_sample(ft2_sample_t *s);
+bool ft2_unfix_sample(ft2_sample_t *s);
 
 /**
  * @brief Sets the audio amplification multiplier.
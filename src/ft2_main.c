@@ -338,8 +338,10 @@ static void cleanUpAndExit(void) // never call this inside the main loop!
 		midi.initMidiThread = NULL;
 	}
 #endif
-	midi.enable = false; // stop MIDI callback from doing things
-	while (midi.callbackBusy) SDL_Delay(1); // wait for MIDI callback to finish
+	// stop the MIDI callback from queueing events, and wait for it to finish
+	SDL_AtomicLock(&midi.callbackLock);
+	midi.enable = false;
+	SDL_AtomicUnlock(&midi.callbackLock);
 
 	closeMidiInDevice();
 	freeMidiIn();
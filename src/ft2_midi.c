@@ -17,6 +17,7 @@
 #include "ft2_audio.h"
 #include "ft2_mouse.h"
 #include "ft2_pattern_ed.h"
+#include "ft2_replayer.h"
 #include "ft2_structs.h"
 #include "rtmidi/rtmidi_c.h"
 
@@ -27,9 +28,47 @@
 
 midi_t midi; // globalized
 
+#define MIDI_RECORD_QUEUE_LEN 255 // must be 2^n-1
+
+// a pattern write for MIDI input played in the audio callback, done on the main thread
+typedef struct midiRecord_t
+{
+	bool isEffect;
+	uint8_t efx, efxData;
+	noteRecord_t note;
+} midiRecord_t;
+
+// written by the audio thread, read by the main thread
+typedef struct midiRecordQueue_t
+{
+	volatile int32_t readPos, writePos;
+	midiRecord_t data[MIDI_RECORD_QUEUE_LEN+1];
+} midiRecordQueue_t;
+
 static volatile bool midiDeviceOpened;
 static bool recMIDIValidChn = true;
 static volatile RtMidiPtr midiInDev;
+static midiEventQueue_t midiEventQueue;
+static midiRecordQueue_t midiRecordQueue;
+static uint64_t lastMidiEventTime; // MIDI thread
+static midiEventWindow_t midiWindow; // audio thread
+
+static void midiRecordQueuePush(const midiRecord_t *r) // audio thread
+{
+	const int32_t writePos = midiRecordQueue.writePos;
+	const int32_t nextWritePos = (writePos + 1) & MIDI_RECORD_QUEUE_LEN;
+	if (nextWritePos == midiRecordQueue.readPos)
+		return; // full, the note was still played but isn't written
+
+	midiRecordQueue.data[writePos] = *r;
+	SDL_MemoryBarrierRelease(); // record before the new write position
+	midiRecordQueue.writePos = nextWritePos;
+}
+
+static bool midiRecording(void)
+{
+	return playMode == PLAYMODE_RECSONG || playMode == PLAYMODE_RECPATT;
+}
 
 static inline void midiInSetChannel(uint8_t status)
 {
@@ -54,7 +93,12 @@ static inline void midiInKeyAction(int8_t m, uint8_t mv)
 		m += (int8_t)config.recMIDITranspVal;
 
 	if ((mv == 0 || vol != 0) && m > 0 && m < 96 && recMIDIValidChn)
-		recordNote(m, (int8_t)vol);
+	{
+		midiRecord_t r;
+		r.isEffect = false;
+		if (triggerRecordedNote(m, (int8_t)vol, &r.note))
+			midiRecordQueuePush(&r);
+	}
 }
 
 static inline void midiInControlChange(uint8_t data1, uint8_t data2)
@@ -75,7 +119,13 @@ static inline void midiInControlChange(uint8_t data1, uint8_t data2)
 
 	const uint8_t vibDepth = (midi.currMIDIVibDepth >> 9) & 0x0F;
 	if (vibDepth > 0 && recMIDIValidChn)
-		recordMIDIEffect(0x04, 0xA0 | vibDepth);
+	{
+		midiRecord_t r;
+		r.isEffect = true;
+		r.efx = 0x04;
+		r.efxData = 0xA0 | vibDepth;
+		midiRecordQueuePush(&r);
+	}
 }
 
 static inline void midiInPitchBendChange(uint8_t data1, uint8_t data2)
@@ -95,37 +145,129 @@ static inline void midiInPitchBendChange(uint8_t data1, uint8_t data2)
 	}
 }
 
-static void midiInCallback(double timeStamp, const unsigned char *message, size_t messageSize, void *userData)
+static void handleMidiEvent(const uint8_t *byte) // audio thread
 {
-	uint8_t byte[3];
+	midiInSetChannel(byte[0]);
+
+	     if (byte[0] >= 128 && byte[0] <= 128+15)       midiInKeyAction(byte[1], 0);
+	else if (byte[0] >= 144 && byte[0] <= 144+15)       midiInKeyAction(byte[1], byte[2]);
+	else if (byte[0] >= 176 && byte[0] <= 176+15)   midiInControlChange(byte[1], byte[2]);
+	else if (byte[0] >= 224 && byte[0] <= 224+15) midiInPitchBendChange(byte[1], byte[2]);
+}
 
-	if (!midi.enable || messageSize < 2)
+/* Only queues the message. The audio callback plays it one audio buffer
+** later, at the sample it was played at (see setMidiEventWindow()), so
+** nothing here touches the replayer or the song.
+*/
+static void queueMidiEvent(double timeStamp, const unsigned char *message, size_t messageSize) // MIDI thread
+{
+	midiEvent_t e;
+
+	e.byte[0] = message[0];
+	if (e.byte[0] <= 127 || e.byte[0] >= 240)
 		return;
 
-	midi.callbackBusy = true;
+	e.byte[1] = message[1] & 0x7F;
 
-	byte[0] = message[0];
-	if (byte[0] > 127 && byte[0] < 240)
+	if (messageSize >= 3)
+		e.byte[2] = message[2] & 0x7F;
+	else
+		e.byte[2] = 0;
+
+	/* timeStamp is the time since the previous message. Messages can come
+	** in bursts, so space them out by it when that still lands in the past.
+	*/
+	const uint64_t timeNow = SDL_GetPerformanceCounter();
+	e.timestamp = timeNow;
+	if (lastMidiEventTime != 0 && timeStamp > 0.0)
 	{
-		byte[1] = message[1] & 0x7F;
+		const uint64_t time64 = lastMidiEventTime + (uint64_t)(timeStamp * editor.dPerfFreq);
+		if (time64 < timeNow && timeNow-time64 < (uint64_t)editor.dPerfFreq) // one second at most
+			e.timestamp = time64;
+	}
+	lastMidiEventTime = e.timestamp;
 
-		if (messageSize >= 3)
-			byte[2] = message[2] & 0x7F;
-		else
-			byte[2] = 0;
+	midiEventQueuePush(&midiEventQueue, &e);
+}
+
+static void midiInCallback(double timeStamp, const unsigned char *message, size_t messageSize, void *userData)
+{
+	// held while queueing, so that cleanUpAndExit() can wait for us to finish
+	SDL_AtomicLock(&midi.callbackLock);
+	if (midi.enable && messageSize >= 2)
+		queueMidiEvent(timeStamp, message, messageSize);
+	SDL_AtomicUnlock(&midi.callbackLock);
 
-		midiInSetChannel(byte[0]);
+	(void)userData;
+}
+
+// called at the start of each audio callback (see midiEventWindowAdvance())
+void setMidiEventWindow(uint32_t numSamples)
+{
+	midiEventWindowAdvance(&midiWindow, SDL_GetPerformanceCounter(), numSamples, audio.freq, editor.dPerfFreq);
+}
+
+// offset of the next queued event in this buffer, -1 if none (or if recording, where events wait for a tick)
+int32_t getNextMidiEventOffset(void)
+{
+	if (midiRecording())
+		return -1;
 
-		     if (byte[0] >= 128 && byte[0] <= 128+15)       midiInKeyAction(byte[1], 0);
-		else if (byte[0] >= 144 && byte[0] <= 144+15)       midiInKeyAction(byte[1], byte[2]);
-		else if (byte[0] >= 176 && byte[0] <= 176+15)   midiInControlChange(byte[1], byte[2]);
-		else if (byte[0] >= 224 && byte[0] <= 224+15) midiInPitchBendChange(byte[1], byte[2]);
+	return midiEventOffset(&midiEventQueue, &midiWindow, audio.freq, editor.dPerfFreq);
+}
+
+/* Plays the events that are due at bufferPosition. When recording they are
+** quantized to replayer ticks instead (call with atReplayerTick before the
+** tick is processed), like keyboard input. Only the voices and channels are
+** touched here; what goes into the pattern is queued for writeMidiRecords().
+** Returns true if any were played, and the voices need an update.
+*/
+bool playMidiEvents(int32_t bufferPosition, bool atReplayerTick)
+{
+	bool played = false;
+
+	if (midiRecording())
+	{
+		if (!atReplayerTick)
+			return false;
+
+		const midiEvent_t *e;
+		while ((e = midiEventQueuePeek(&midiEventQueue)) != NULL && e->timestamp < midiWindow.end)
+		{
+			handleMidiEvent(e->byte);
+			midiEventQueuePop(&midiEventQueue);
+			played = true;
+		}
+
+		return played;
 	}
 
-	midi.callbackBusy = false;
+	int32_t offset;
+	while ((offset = getNextMidiEventOffset()) >= 0 && offset <= bufferPosition)
+	{
+		handleMidiEvent(midiEventQueuePeek(&midiEventQueue)->byte);
+		midiEventQueuePop(&midiEventQueue);
+		played = true;
+	}
 
-	(void)timeStamp;
-	(void)userData;
+	return played;
+}
+
+// the pattern writes for the events playMidiEvents() played, called from the main loop
+void writeMidiRecords(void)
+{
+	while (midiRecordQueue.readPos != midiRecordQueue.writePos)
+	{
+		SDL_MemoryBarrierAcquire(); // write position before the record
+
+		const midiRecord_t *r = &midiRecordQueue.data[midiRecordQueue.readPos];
+		if (r->isEffect)
+			recordMIDIEffect(r->efx, r->efxData);
+		else
+			writeRecordedNote(&r->note);
+
+		midiRecordQueue.readPos = (midiRecordQueue.readPos + 1) & MIDI_RECORD_QUEUE_LEN;
+	}
 }
 
 static uint32_t getNumMidiInDevices(void)
@@ -6,13 +6,18 @@
 #include <stdbool.h>
 #include <SDL2/SDL.h>
 
+#define MIDI_BARRIER_RELEASE() SDL_MemoryBarrierRelease()
+#define MIDI_BARRIER_ACQUIRE() SDL_MemoryBarrierAcquire()
+#include "ft2_midi_events.h"
+
 #define MIDI_INPUT_SELECTOR_BOX_WIDTH 247
 #define MAX_MIDI_DEVICES 99
 
 typedef struct midi_t
 {
 	char *inputDeviceName, *inputDeviceNames[MAX_MIDI_DEVICES];
-	volatile bool initThreadDone, callbackBusy, enable;
+	volatile bool initThreadDone, enable;
+	SDL_SpinLock callbackLock;
 	bool rescanDevicesFlag;
 	uint32_t inputDevice, numInputDevices;
 	int16_t currMIDIVibDepth, currMIDIPitch;
@@ -28,6 +33,7 @@ void freeMidiIn(void);
 bool initMidiIn(void);
 bool openMidiInDevice(uint32_t deviceID);
 void recordMIDIEffect(uint8_t efx, uint8_t efxData);
+void writeMidiRecords(void);
 bool saveMidiInputDeviceToConfig(void);
 bool setMidiInputDeviceFromConfig(void);
 void freeMidiInputDeviceList(void);
@@ -39,4 +45,9 @@ void sbMidiInputSetPos(uint32_t pos);
 bool testMidiInputDeviceListMouseDown(void);
 int32_t initMidiFunc(void *ptr);
 
+// audio thread
+void setMidiEventWindow(uint32_t numSamples);
+int32_t getNextMidiEventOffset(void);
+bool playMidiEvents(int32_t bufferPosition, bool atReplayerTick);
+
 #endif
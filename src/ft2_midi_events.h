@@ -0,0 +1,103 @@
+#pragma once
+
+// The MIDI input queue and the timing that places its events in the audio
+// buffers. Kept free of SDL and the MIDI/audio globals so that
+// plugin/bench/ft2_bench.c can drive it with a synthetic event stream.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define MIDI_EVENT_QUEUE_LEN 255 // must be 2^n-1
+
+// ft2_midi.c uses SDL's barriers
+#ifndef MIDI_BARRIER_RELEASE
+#if defined _MSC_VER
+#include <intrin.h>
+#define MIDI_BARRIER_RELEASE() _ReadWriteBarrier()
+#define MIDI_BARRIER_ACQUIRE() _ReadWriteBarrier()
+#else
+#define MIDI_BARRIER_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define MIDI_BARRIER_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+#endif
+
+typedef struct midiEvent_t
+{
+	uint64_t timestamp; // performance counter time it was played at
+	uint8_t byte[3];
+} midiEvent_t;
+
+// written by the MIDI thread, read by the audio thread
+typedef struct midiEventQueue_t
+{
+	volatile int32_t readPos, writePos;
+	midiEvent_t data[MIDI_EVENT_QUEUE_LEN+1];
+} midiEventQueue_t;
+
+// the span of performance counter time the audio buffer being mixed plays
+typedef struct midiEventWindow_t
+{
+	uint64_t start, end;
+} midiEventWindow_t;
+
+static inline bool midiEventQueuePush(midiEventQueue_t *q, const midiEvent_t *e) // MIDI thread
+{
+	const int32_t writePos = q->writePos;
+	const int32_t nextWritePos = (writePos + 1) & MIDI_EVENT_QUEUE_LEN;
+	if (nextWritePos == q->readPos)
+		return false; // full, drop event
+
+	q->data[writePos] = *e;
+	MIDI_BARRIER_RELEASE(); // event data before the new write position
+	q->writePos = nextWritePos;
+
+	return true;
+}
+
+static inline midiEvent_t *midiEventQueuePeek(midiEventQueue_t *q) // audio thread
+{
+	const int32_t readPos = q->readPos;
+	if (readPos == q->writePos)
+		return NULL; // empty
+
+	MIDI_BARRIER_ACQUIRE(); // write position before the event data
+	return &q->data[readPos];
+}
+
+static inline void midiEventQueuePop(midiEventQueue_t *q) // audio thread
+{
+	q->readPos = (q->readPos + 1) & MIDI_EVENT_QUEUE_LEN;
+}
+
+/* Moves the window on to the buffer about to be mixed (numSamples long).
+** It plays what came in during the last one, so an event lands at its own
+** offset (with one buffer of latency) instead of on a buffer boundary.
+** The windows follow each other without gaps; if the audio clock has drifted
+** more than half a buffer from the performance counter, start over from timeNow.
+*/
+static inline void midiEventWindowAdvance(midiEventWindow_t *w, uint64_t timeNow, uint32_t numSamples, uint32_t audioFreq, double dPerfFreq)
+{
+	const uint64_t windowLen = (uint64_t)((numSamples * dPerfFreq) / audioFreq);
+
+	uint64_t windowStart = w->end;
+	const int64_t drift = (int64_t)(windowStart + windowLen) - (int64_t)timeNow;
+	if (windowStart == 0 || drift > (int64_t)(windowLen / 2) || drift < -(int64_t)(windowLen / 2))
+		windowStart = timeNow - windowLen;
+
+	w->start = windowStart;
+	w->end = windowStart + windowLen;
+}
+
+// offset of the next queued event in the window's buffer, 0 if it is late, -1 if none is due in it
+static inline int32_t midiEventOffset(midiEventQueue_t *q, const midiEventWindow_t *w, uint32_t audioFreq, double dPerfFreq)
+{
+	const midiEvent_t *e = midiEventQueuePeek(q);
+	if (e == NULL || e->timestamp >= w->end)
+		return -1;
+
+	if (e->timestamp <= w->start)
+		return 0; // late
+
+	return (int32_t)(((e->timestamp - w->start) * audioFreq) / dPerfFreq);
+}
@@ -106,6 +106,7 @@ static void drawNibblesFoodNumber(int32_t xOut, int32_t yOut, int32_t number)
 		return;
 
 	uint32_t *dstPtr = &video.frameBuffer[(yOut * SCREEN_W) + xOut];
+	markFrameRows(yOut, FONT8_CHAR_H);
 	uint8_t *srcPtr = &bmp.font8[number * FONT8_CHAR_W];
 
 	for (int32_t y = 0; y < FONT8_CHAR_H; y++, srcPtr += FONT8_WIDTH, dstPtr += SCREEN_W)
@@ -277,6 +278,7 @@ static void nibbleWriteLevelSprite(int16_t xOut, int16_t yOut, int16_t levelNum)
 
 	const uint8_t *src = (const uint8_t *)&bmp.nibblesStages[(readY * 530) + readX];
 	uint32_t *dst = &video.frameBuffer[(yOut * SCREEN_W) + xOut];
+	markFrameRows(yOut, 23+2);
 
 	for (int32_t y = 0; y < 23+2; y++)
 	{
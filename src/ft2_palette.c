@@ -62,6 +62,7 @@ void setPal16(pal16 *p, bool redrawScreen)
 	// update framebuffer pixels with new palette
 	if (redrawScreen && video.frameBuffer != NULL)
 	{
+		markFrameRows(0, SCREEN_H);
 		for (int32_t i = 0; i < SCREEN_W*SCREEN_H; i++)
 			video.frameBuffer[i] = video.palette[(video.frameBuffer[i] >> 24) & 15]; // ARGB alpha channel = palette index
 	}
@@ -149,11 +149,13 @@ void drawPatternBorders(void)
 		{
 			const int32_t clearSize = ui.pattChanScrollShown ? (SCREEN_W * sizeof (int32_t) * 315) : (SCREEN_W * sizeof (int32_t) * 332);
 			memset(&video.frameBuffer[68 * SCREEN_W], 0, clearSize);
+			markFrameRows(68, clearSize / (SCREEN_W * sizeof (int32_t)));
 		}
 		else
 		{
 			const int32_t clearSize = ui.pattChanScrollShown ? (SCREEN_W * sizeof(int32_t) * 210) : (SCREEN_W * sizeof(int32_t) * 227);
 			memset(&video.frameBuffer[173 * SCREEN_W], 0, clearSize);
+			markFrameRows(173, clearSize / (SCREEN_W * sizeof (int32_t)));
 		}
 
 		drawFramework(0, pattCoord->lowerRowsY - 10, SCREEN_W, 11, FRAMEWORK_TYPE1);
@@ -186,6 +188,7 @@ static void writeCursor(void)
 	xPos += ((cursor.ch - ui.channelOffset) * ui.patternChannelWidth);
 
 	uint32_t *dstPtr = &video.frameBuffer[(editor.ptnCursorY * SCREEN_W) + xPos];
+	markFrameRows(editor.ptnCursorY, 9);
 	for (int32_t y = 0; y < 9; y++)
 	{
 		for (int32_t x = 0; x < width; x++)
@@ -288,6 +291,7 @@ static void writePatternBlockMark(int32_t currRow, uint32_t rowHeight, const pat
 	assert(x1+w <= SCREEN_W && y1+h <= SCREEN_H);
 
 	uint32_t *ptr32 = &video.frameBuffer[(y1 * SCREEN_W) + x1];
+	markFrameRows(y1, h);
 	for (int32_t y = 0; y < h; y++)
 	{
 		for (int32_t x = 0; x < w; x++)
@@ -341,6 +345,7 @@ static void drawRowNums(int32_t yPos, uint8_t row, bool selectedRowFlag)
 	const uint8_t *src2Ptr = &font4Ptr[(row & 0x0F) * FONT4_CHAR_W];
 	uint32_t *dst1Ptr = &video.frameBuffer[(yPos * SCREEN_W) + LEFT_ROW_XPOS];
 	uint32_t *dst2Ptr = dst1Ptr + (RIGHT_ROW_XPOS - LEFT_ROW_XPOS);
+	markFrameRows(yPos, FONT4_CHAR_H);
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
 	{
@@ -753,6 +758,7 @@ void pattTwoHexOut(uint32_t xPos, uint32_t yPos, uint8_t val, uint32_t color)
 	const uint8_t *ch1Ptr = &font4Ptr[(val   >> 4) * FONT4_CHAR_W];
 	const uint8_t *ch2Ptr = &font4Ptr[(val & 0x0F) * FONT4_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H);
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
 	{
@@ -774,6 +780,7 @@ static void pattCharOut(uint32_t xPos, uint32_t yPos, uint8_t chr, uint8_t fontT
 	int32_t x, y;
 
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H); // the tallest of the three fonts
 
 	if (fontType == FONT_TYPE3)
 	{
@@ -841,6 +848,7 @@ static void drawEmptyNoteSmall(uint32_t xPos, uint32_t yPos, uint32_t color)
 {
 	const uint8_t *srcPtr = &bmp.font7[18 * FONT7_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT7_CHAR_H);
 
 	for (int32_t y = 0; y < FONT7_CHAR_H; y++)
 	{
@@ -859,6 +867,7 @@ static void drawKeyOffSmall(uint32_t xPos, uint32_t yPos, uint32_t color)
 {
 	const uint8_t *srcPtr = &bmp.font7[21 * FONT7_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + (xPos + 2)];
+	markFrameRows(yPos, FONT7_CHAR_H);
 
 	for (int32_t y = 0; y < FONT7_CHAR_H; y++)
 	{
@@ -897,6 +906,7 @@ static void drawNoteSmall(uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32_
 	const uint8_t *ch2Ptr = &bmp.font7[char2];
 	const uint8_t *ch3Ptr = &bmp.font7[char3];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT7_CHAR_H);
 
 	for (int32_t y = 0; y < FONT7_CHAR_H; y++)
 	{
@@ -917,6 +927,7 @@ static void drawNoteSmall(uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32_
 static void drawEmptyNoteMedium(uint32_t xPos, uint32_t yPos, uint32_t color)
 {
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H);
 	const uint8_t *srcPtr = &font4Ptr[43 * FONT4_CHAR_W];
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
@@ -936,6 +947,7 @@ static void drawKeyOffMedium(uint32_t xPos, uint32_t yPos, uint32_t color)
 {
 	const uint8_t *srcPtr = &font4Ptr[40 * FONT4_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H);
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
 	{
@@ -974,6 +986,7 @@ static void drawNoteMedium(uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32
 	const uint8_t *ch2Ptr = &font4Ptr[char2];
 	const uint8_t *ch3Ptr = &font4Ptr[char3];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H);
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
 	{
@@ -995,6 +1008,7 @@ static void drawEmptyNoteBig(uint32_t xPos, uint32_t yPos, uint32_t color)
 {
 	const uint8_t *srcPtr = &font4Ptr[67 * FONT4_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H);
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
 	{
@@ -1013,6 +1027,7 @@ static void drawKeyOffBig(uint32_t xPos, uint32_t yPos, uint32_t color)
 {
 	const uint8_t *srcPtr = &bmp.font4[61 * FONT4_CHAR_W];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT4_CHAR_H);
 
 	for (int32_t y = 0; y < FONT4_CHAR_H; y++)
 	{
@@ -1051,6 +1066,7 @@ static void drawNoteBig(uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32_t
 	const uint8_t *ch2Ptr = &font5Ptr[char2];
 	const uint8_t *ch3Ptr = &font5Ptr[char3];
 	uint32_t *dstPtr = &video.frameBuffer[(yPos * SCREEN_W) + xPos];
+	markFrameRows(yPos, FONT5_CHAR_H);
 
 	for (int32_t y = 0; y < FONT5_CHAR_H; y++)
 	{
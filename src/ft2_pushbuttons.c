@@ -503,6 +503,7 @@ void drawPushButton(uint16_t pushButtonID)
 			// blit graphics
 
 			uint32_t *dst32 = &video.frameBuffer[(textY * SCREEN_W) + textX];
+			markFrameRows(textY, 8);
 			for (y = 0; y < 8; y++, src8 += BUTTON_GFX_BMP_WIDTH, dst32 += SCREEN_W)
 			{
 				for (x = 0; x < textW; x++)
@@ -2306,7 +2306,17 @@ static void getNextPos(void)
 void pauseMusic(void) // stops reading pattern data
 {
 	musicPaused = true;
-	while (replayerBusy);
+
+	/* The replayer only ticks inside the audio callback, which runs with the
+	** audio device locked. Taking the lock once waits for a tick in progress
+	** to finish (sleeping, not spinning), and the lock's acquire/release makes
+	** musicPaused visible to the next callback.
+	*/
+	if (!audio.locked)
+	{
+		lockAudio();
+		unlockAudio();
+	}
 }
 
 void resumeMusic(void) // starts reading pattern data
@@ -3105,9 +3115,10 @@ void playSample(uint8_t chNum, uint8_t insNum, uint8_t smpNum, uint8_t note, uin
 
 	unlockAudio();
 
-	while (ch->status & CS_TRIGGER_VOICE); // wait for voice to trigger in mixer
-
-	// for sampling playback line in Smp. Ed.
+	/* For sampling playback line in Smp. Ed. No need to wait for the mixer to
+	** trigger the voice: the line isn't drawn until the scopes have seen the
+	** trigger (lastChInstr[] was reset above), and that comes after the mixer.
+	*/
 	editor.curPlayInstr = editor.curInstr;
 	editor.curPlaySmp = editor.curSmp;
 }
@@ -3168,9 +3179,10 @@ void playRange(uint8_t chNum, uint8_t insNum, uint8_t smpNum, uint8_t note, uint
 
 	unlockAudio();
 
-	while (ch->status & CS_TRIGGER_VOICE); // wait for voice to trigger in mixer
-
-	// for sampling playback line in Smp. Ed.
+	/* For sampling playback line in Smp. Ed. No need to wait for the mixer to
+	** trigger the voice: the line isn't drawn until the scopes have seen the
+	** trigger (lastChInstr[] was reset above), and that comes after the mixer.
+	*/
 	editor.curPlayInstr = editor.curInstr;
 	editor.curPlaySmp = editor.curSmp;
 }
@@ -3213,12 +3225,9 @@ void stopVoices(void)
 	editor.curPlayInstr = 255;
 	editor.curPlaySmp = 255;
 
-	stopAllScopes();
+	stopAllScopes(); // also waits for the scope thread, making sure pointers aren't illegal
 	resetAudioDither();
 
-	// wait for scope thread to finish, making sure pointers aren't illegal
-	while (editor.scopeThreadBusy);
-
 	if (audioWasntLocked)
 		unlockAudio();
 }
@@ -3366,7 +3375,6 @@ void setSyncedReplayerVars(void)
 
 	// handle channel sync queue
 
-	while (chQueueClearing);
 	while (chQueueReadSize() > 0)
 	{
 		if (frameTime64 < getChQueueTimestamp())
@@ -3383,15 +3391,12 @@ void setSyncedReplayerVars(void)
 			break;
 	}
 
-	/* Extra validation because of possible issues when the buffer is full
-	** and positions are being reset, which is not entirely thread safe.
-	*/
+	// extra validation, the queues may have been reset (resetSyncQueues())
 	if (chSyncEntry != NULL && chSyncEntry->timestamp == 0)
 		chSyncEntry = NULL;
 
 	// handle pattern sync queue
 
-	while (pattQueueClearing);
 	while (pattQueueReadSize() > 0)
 	{
 		if (frameTime64 < getPattQueueTimestamp())
@@ -3405,9 +3410,7 @@ void setSyncedReplayerVars(void)
 			break;
 	}
 
-	/* Extra validation because of possible issues when the buffer is full
-	** and positions are being reset, which is not entirely thread safe.
-	*/
+	// extra validation, the queues may have been reset (resetSyncQueues())
 	if (pattSyncEntry != NULL && pattSyncEntry->timestamp == 0)
 		pattSyncEntry = NULL;
 
@@ -797,6 +797,7 @@ static void writeRange(void)
 	assert(start+rangeLen <= SCREEN_W);
 
 	uint32_t *ptr32 = &video.frameBuffer[(174 * SCREEN_W) + start];
+	markFrameRows(174, SAMPLE_AREA_HEIGHT);
 	for (int32_t y = 0; y < SAMPLE_AREA_HEIGHT; y++)
 	{
 		for (int32_t x = 0; x < rangeLen; x++)
@@ -856,6 +857,7 @@ void sampleLine(int32_t x1, int32_t x2, int32_t y1, int32_t y2)
 	const uint32_t pixVal = video.palette[PAL_PATTEXT];
 	const int32_t pitch = sy * SCREEN_W;
 	uint32_t *dst32 = &video.frameBuffer[(y * SCREEN_W) + x];
+	markFrameRows(MIN(y1, y2), ABS(dy) + 1);
 
 	// draw line
 	if (ax > ay)
@@ -1245,6 +1247,7 @@ static void writeWaveform(void)
 {
 	// clear sample data area
 	memset(&video.frameBuffer[174 * SCREEN_W], 0, SAMPLE_AREA_WIDTH * SAMPLE_AREA_HEIGHT * sizeof (int32_t));
+	markFrameRows(174, SAMPLE_AREA_HEIGHT);
 
 	// draw center line
 	hLine(0, SAMPLE_AREA_Y_CENTER, SAMPLE_AREA_WIDTH, PAL_DESKTOP);
@@ -3047,6 +3050,7 @@ static void invertSamplePosLine(int32_t x)
 		return;
 
 	uint32_t *ptr32 = &video.frameBuffer[(174 * SCREEN_W) + x];
+	markFrameRows(174, SAMPLE_AREA_HEIGHT);
 	for (int32_t y = 0; y < SAMPLE_AREA_HEIGHT; y++, ptr32 += SCREEN_W)
 		*ptr32 = video.palette[(*ptr32 >> 24) ^ 1]; // ">> 24" to get palette, XOR 1 to switch between normal/inverted mode
 }
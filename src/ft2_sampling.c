@@ -196,6 +196,7 @@ static void drawSamplingPreview(void)
 
 	// clear sample data area
 	memset(&video.frameBuffer[174 * SCREEN_W], 0, SAMPLE_AREA_WIDTH * SAMPLE_AREA_HEIGHT * sizeof (int32_t));
+	markFrameRows(174, SAMPLE_AREA_HEIGHT);
 
 	if (sampleInStereo) // stereo sampling
 	{
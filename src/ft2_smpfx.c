@@ -771,14 +771,15 @@ void sfxPreviewFilter(uint32_t cutoff)
 	ch->efx = 0;
 	ch->smpStartPos = 0;
 	resumeAudio();
+	lockAudio();
 	triggerNote(note, 0, 0, ch);
 	resetVolumes(ch);
 	triggerInstrument(ch);
 	ch->realVol = ch->outVol = ch->oldVol = 64;
 	updateVolPanAutoVib(ch);
+	unlockAudio();
 
-	while (ch->status & CS_TRIGGER_VOICE); // wait for voice to trigger in mixer
-	SDL_Delay(1500); // wait 1.5 seconds
+	SDL_Delay(1500); // wait 1.5 seconds (the voice is triggered on the next replayer tick, well within that)
 
 	// we're done, stop voice and free temporary data
 	pauseAudio();
@@ -49,8 +49,16 @@ static bool songIsModified;
 static char wndTitle[256];
 static sprite_t sprites[SPRITE_NUM];
 
+// for skipping unchanged frames
+#define IDLE_FRAMES (VBLANK_HZ / 2) // unchanged frames before waiting for input instead
+#define IDLE_WAIT_MS 50 // wake up this often while idle, for things that aren't input events
+
+static bool vblankHpcStale;
+static uint32_t framesUnchanged, frameUploadsCounter;
+static uint64_t frameUploadsTime64;
+
 // for FPS counter
-#define FPS_LINES 15
+#define FPS_LINES 16
 #define FPS_SCAN_FRAMES 60
 #define FPS_RENDER_W 285
 #define FPS_RENDER_H (((FONT1_CHAR_H + 1) * FPS_LINES) + 1)
@@ -124,6 +132,7 @@ static void drawFPSCounter(void)
 	             "Render scaling: x=%.4f, y=%.4f\n" \
 	             "DPI zoom factors: x=%.4f, y=%.4f\n" \
 	             "Mouse pixel-space muls: x=%.4f, y=%.4f\n" \
+	             "Frame uploads per second: %u\n" \
 	             "Relative mouse coords: %d,%d\n" \
 	             "Absolute mouse coords: %d,%d\n" \
 	             "Press CTRL+SHIFT+F to close this box.\n",
@@ -139,6 +148,7 @@ static void drawFPSCounter(void)
 	             (double)video.renderW / SCREEN_W, (double)video.renderH / SCREEN_H,
 	             video.dDpiZoomFactorX, video.dDpiZoomFactorY,
 	             video.dMouseXMul, video.dMouseYMul,
+	             video.frameUploadsPerSecond,
 	             mouse.x, mouse.y,
 	             mouse.absX, mouse.absY);
 
@@ -186,6 +196,23 @@ void endFPSCounter(void)
 	}
 }
 
+static void countFrameUpload(void)
+{
+	const uint64_t time64 = SDL_GetPerformanceCounter();
+	if (time64-frameUploadsTime64 >= hpcFreq.freq64)
+	{
+		video.frameUploadsPerSecond = frameUploadsCounter;
+		frameUploadsCounter = 0;
+		frameUploadsTime64 = time64;
+	}
+}
+
+// called by everything that draws into video.frameBuffer, so that flipFrame() knows what to upload
+void markFrameRows(int32_t y, int32_t h)
+{
+	frameUploadMarkRows(&video.frameUpload, y, h);
+}
+
 void flipFrame(void)
 {
 	const uint32_t windowFlags = SDL_GetWindowFlags(video.window);
@@ -196,22 +223,61 @@ void flipFrame(void)
 	if (video.showFPSCounter)
 		drawFPSCounter();
 
-	SDL_UpdateTexture(video.texture, NULL, video.frameBuffer, SCREEN_W * sizeof (int32_t));
+	/* Only upload and present the frame if it's different from the last one.
+	** Just the rows that were drawn to this frame are compared, and only the
+	** ones that changed are uploaded.
+	*/
+	int32_t y1, y2;
+	const bool frameChanged = frameUploadGetChangedRows(&video.frameUpload, video.frameBuffer, video.lastFrameBuffer, SCREEN_W, SCREEN_H, &y1, &y2);
+	if (frameChanged)
+	{
+		const SDL_Rect rect = { 0, y1, SCREEN_W, (y2-y1)+1 };
+		SDL_UpdateTexture(video.texture, &rect, &video.frameBuffer[y1 * SCREEN_W], SCREEN_W * sizeof (int32_t));
+
+		// SDL 2.0.14 bug on Windows (?): This function consumes ever-increasing memory if the program is minimized
+		if (!minimized)
+			SDL_RenderClear(video.renderer);
 
-	// SDL 2.0.14 bug on Windows (?): This function consumes ever-increasing memory if the program is minimized
-	if (!minimized)
-		SDL_RenderClear(video.renderer);
+		if (video.useCustomRenderRect)
+			SDL_RenderCopy(video.renderer, video.texture, NULL, &video.renderRect);
+		else
+			SDL_RenderCopy(video.renderer, video.texture, NULL, NULL);
 
-	if (video.useCustomRenderRect)
-		SDL_RenderCopy(video.renderer, video.texture, NULL, &video.renderRect);
-	else
-		SDL_RenderCopy(video.renderer, video.texture, NULL, NULL);
+		SDL_RenderPresent(video.renderer);
 
-	SDL_RenderPresent(video.renderer);
+		framesUnchanged = 0;
+		frameUploadsCounter++;
+	}
+	else if (framesUnchanged < UINT32_MAX)
+	{
+		framesUnchanged++;
+	}
 
+	countFrameUpload();
 	eraseSprites();
 
-	if (!video.vsync60HzPresent)
+	if (!frameChanged)
+	{
+		/* Nothing was presented, so there is no VSync to wait on. If nothing has changed for
+		** a while and the song isn't playing, sleep until there is input instead (waking up
+		** now and then for disk op. threads, scopes of notes played by MIDI and such).
+		*/
+		if (framesUnchanged >= IDLE_FRAMES && !songPlaying)
+		{
+			SDL_WaitEventTimeout(NULL, IDLE_WAIT_MS); // NULL: leaves the event in the queue
+			hpc_ResetCounters(&video.vblankHpc);
+		}
+		else
+		{
+			if (vblankHpcStale) // the last frames were paced by VSync
+				hpc_ResetCounters(&video.vblankHpc);
+
+			hpc_Wait(&video.vblankHpc);
+		}
+
+		vblankHpcStale = false;
+	}
+	else if (!video.vsync60HzPresent)
 	{
 		// we have no VSync, do crude thread sleeping to sync to ~60Hz
 		hpc_Wait(&video.vblankHpc);
@@ -221,10 +287,14 @@ void flipFrame(void)
 		/* We have VSync, but it can unexpectedly get inactive in certain scenarios.
 		** We have to force thread sleeping (to ~60Hz) if so.
 		*/
+		vblankHpcStale = true;
 #ifdef __APPLE__
 		// macOS: VSync gets disabled if the window is 100% covered by another window. Let's add a (crude) fix:
 		if (minimized || !(windowFlags & SDL_WINDOW_INPUT_FOCUS))
+		{
 			hpc_Wait(&video.vblankHpc);
+			vblankHpcStale = false;
+		}
 #elif __unix__
 		/* *NIX: VSync can get disabled in fullscreen mode in some distros/systems. Let's add a fix.
 		**
@@ -232,10 +302,16 @@ void flipFrame(void)
 		**           in fact work in fullscreen mode...
 		*/
 		if (minimized || video.fullscreen)
+		{
 			hpc_Wait(&video.vblankHpc);
+			vblankHpcStale = false;
+		}
 #else
 		if (minimized)
+		{
 			hpc_Wait(&video.vblankHpc);
+			vblankHpcStale = false;
+		}
 #endif
 	}
 
@@ -505,6 +581,8 @@ void eraseSprites(void)
 		if (sx+sw >= SCREEN_W) sw = SCREEN_W - sx;
 		if (sy+sh >= SCREEN_H) sh = SCREEN_H - sy;
 
+		markFrameRows(sy, sh);
+
 		const int32_t srcPitch = s->w - sw;
 		const int32_t dstPitch = SCREEN_W - sw;
 
@@ -577,6 +655,8 @@ void renderSprites(void)
 		if (sx+sw >= SCREEN_W) sw = SCREEN_W - sx;
 		if (sy+sh >= SCREEN_H) sh = SCREEN_H - sy;
 
+		markFrameRows(sy, sh);
+
 		const int32_t srcPitch = s->w - sw;
 		const int32_t dstPitch = SCREEN_W - sw;
 
@@ -670,6 +750,8 @@ void renderLoopPins(void)
 		// handle x clipping
 		if (sx+sw >= SCREEN_W) sw = SCREEN_W - sx;
 
+		markFrameRows(s->y, sh);
+
 		srcPitch = s->w - sw;
 		dstPitch = SCREEN_W - sw;
 
@@ -729,6 +811,8 @@ void renderLoopPins(void)
 		// handle x clipping
 		if (sx+sw >= SCREEN_W) sw = SCREEN_W - sx;
 
+		markFrameRows(s->y, sh);
+
 		srcPitch = s->w - sw;
 		dstPitch = SCREEN_W - sw;
 
@@ -790,6 +874,12 @@ void closeVideo(void)
 		free(video.frameBuffer);
 		video.frameBuffer = NULL;
 	}
+
+	if (video.lastFrameBuffer != NULL)
+	{
+		free(video.lastFrameBuffer);
+		video.lastFrameBuffer = NULL;
+	}
 }
 
 void setWindowSizeFromConfig(bool updateRenderer)
@@ -896,6 +986,8 @@ bool recreateTexture(void)
 	}
 
 	SDL_SetTextureBlendMode(video.texture, SDL_BLENDMODE_NONE);
+
+	video.frameUpload.forceUpload = true; // new texture, nothing in it yet
 	return true;
 }
 
@@ -988,12 +1080,15 @@ bool setupRenderer(void)
 
 	// framebuffer used by SDL (for texture)
 	video.frameBuffer = (uint32_t *)malloc(SCREEN_W * SCREEN_H * sizeof (uint32_t));
-	if (video.frameBuffer == NULL)
+	video.lastFrameBuffer = (uint32_t *)malloc(SCREEN_W * SCREEN_H * sizeof (uint32_t)); // last uploaded frame
+	if (video.frameBuffer == NULL || video.lastFrameBuffer == NULL)
 	{
 		showErrorMsgBox("Not enough memory!");
 		return false;
 	}
 
+	frameUploadInit(&video.frameUpload);
+
 	if (!setupSprites())
 		return false;
 
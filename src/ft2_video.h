@@ -6,6 +6,7 @@
 #include "ft2_palette.h"
 #include "ft2_audio.h"
 #include "ft2_hpc.h"
+#include "ft2_frame_upload.h"
 
 enum
 {
@@ -21,6 +22,7 @@ typedef struct video_t
 {
 	bool fullscreen, showFPSCounter, useCustomRenderRect, vsync60HzPresent, windowHidden;
 	uint8_t windowModeUpscaleFactor;
+	uint32_t frameUploadsPerSecond, *lastFrameBuffer;
 	int32_t renderX, renderY, renderW, renderH, displayW, displayH, windowW, windowH;
 	uint32_t mouseCursorUpscaleFactor, *frameBuffer, palette[PAL_NUM];
 	double dMonitorRefreshRate, dDpiZoomFactorX, dDpiZoomFactorY, dMouseXMul, dMouseYMul;
@@ -28,6 +30,7 @@ typedef struct video_t
 	HWND hWnd;
 #endif
 	hpc_t vblankHpc;
+	frameUpload_t frameUpload;
 	SDL_Window *window;
 	SDL_Rect renderRect;
 	SDL_Renderer *renderer;
@@ -50,6 +53,7 @@ void resetFPSCounter(void);
 void beginFPSCounter(void);
 void endFPSCounter(void);
 void flipFrame(void);
+void markFrameRows(int32_t y, int32_t h);
 void showErrorMsgBox(const char *fmt, ...);
 void updateWindowTitle(bool forceUpdate);
 void handleScopesFromChQueue(chSyncData_t *chSyncData, uint8_t *scopeUpdateStatus);
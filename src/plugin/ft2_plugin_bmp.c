@@ -24,6 +24,24 @@
 #include "gfxdata/ft2_bmp_mouse.c"
 #include "gfxdata/ft2_bmp_nibbles.c"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+static SRWLOCK g_cacheLock = SRWLOCK_INIT;
+#define cacheLock()   AcquireSRWLockExclusive(&g_cacheLock)
+#define cacheUnlock() ReleaseSRWLockExclusive(&g_cacheLock)
+#else
+#include <pthread.h>
+static pthread_mutex_t g_cacheLock = PTHREAD_MUTEX_INITIALIZER;
+#define cacheLock()   pthread_mutex_lock(&g_cacheLock)
+#define cacheUnlock() pthread_mutex_unlock(&g_cacheLock)
+#endif
+
+/* Shared decoded assets (guarded by g_cacheLock) */
+static ft2_bmp_t g_cachedBmp;
+static bool g_cachedBmpLoaded;
+static int32_t g_cacheRefCount;
+
 /* BMP biCompression field values */
 enum
 {
@@ -286,6 +304,42 @@ static uint8_t *loadBMPTo1Bit(const uint8_t *src)
 	return outData;
 }
 
+/*
+ * Pack a decoded 1-bit mask into 64-bit words per row (see ft2_font_bits_t).
+ * src is the embedded BMP the mask was decoded from (for its dimensions).
+ */
+static bool packFontBits(ft2_font_bits_t *out, const uint8_t *mask, const uint8_t *src)
+{
+	out->bits = NULL;
+	out->wordsPerRow = 0;
+	if (mask == NULL)
+		return false;
+
+	const bmpHeader_t *hdr = (const bmpHeader_t *)&src[2];
+	const int32_t width = hdr->biWidth, height = hdr->biHeight;
+	const uint32_t wordsPerRow = ((width + 63) / 64) + 1; /* + spare word for span reads */
+
+	uint64_t *bits = (uint64_t *)calloc((size_t)wordsPerRow * height, sizeof(uint64_t));
+	if (bits == NULL)
+		return false;
+
+	for (int32_t y = 0; y < height; y++)
+	{
+		const uint8_t *srcRow = &mask[y * width];
+		uint64_t *dstRow = &bits[y * wordsPerRow];
+
+		for (int32_t x = 0; x < width; x++)
+		{
+			if (srcRow[x])
+				dstRow[x >> 6] |= 1ULL << (x & 63);
+		}
+	}
+
+	out->bits = bits;
+	out->wordsPerRow = wordsPerRow;
+	return true;
+}
+
 /*
  * Decode RLE4-compressed BMP to FT2 palette indices.
  * Used for UI graphics that need to respond to theme colors.
@@ -416,7 +470,16 @@ bool ft2_bmp_load(ft2_bmp_t *bmp)
 	bmp->font7 = loadBMPTo1Bit(font7BMP);
 	bmp->font8 = loadBMPTo1Bit(font8BMP);
 
-	if (bmp->ft2OldAboutLogo == NULL || bmp->ft2AboutLogo == NULL ||
+	/* Bit-packed fonts for the span blitter */
+	const bool fontBitsOk =
+		packFontBits(&bmp->font1Bits, bmp->font1, font1BMP) &&
+		packFontBits(&bmp->font2Bits, bmp->font2, font2BMP) &&
+		packFontBits(&bmp->font3Bits, bmp->font3, font3BMP) &&
+		packFontBits(&bmp->font4Bits, bmp->font4, font4BMP) &&
+		packFontBits(&bmp->font6Bits, bmp->font6, font6BMP) &&
+		packFontBits(&bmp->font7Bits, bmp->font7, font7BMP);
+
+	if (!fontBitsOk || bmp->ft2OldAboutLogo == NULL || bmp->ft2AboutLogo == NULL ||
 		bmp->buttonGfx == NULL || bmp->font1 == NULL || bmp->font2 == NULL ||
 		bmp->font3 == NULL || bmp->font4 == NULL || bmp->font6 == NULL ||
 		bmp->font7 == NULL || bmp->font8 == NULL || bmp->ft2LogoBadges == NULL ||
@@ -465,5 +528,67 @@ void ft2_bmp_free(ft2_bmp_t *bmp)
 	if (bmp->scopeMute) { free(bmp->scopeMute); bmp->scopeMute = NULL; }
 	if (bmp->radiobuttonGfx) { free(bmp->radiobuttonGfx); bmp->radiobuttonGfx = NULL; }
 	if (bmp->checkboxGfx) { free(bmp->checkboxGfx); bmp->checkboxGfx = NULL; }
+
+	ft2_font_bits_t *fontBits[] = { &bmp->font1Bits, &bmp->font2Bits, &bmp->font3Bits, &bmp->font4Bits, &bmp->font6Bits, &bmp->font7Bits };
+	for (size_t i = 0; i < sizeof(fontBits) / sizeof(fontBits[0]); i++)
+	{
+		free(fontBits[i]->bits);
+		fontBits[i]->bits = NULL;
+	}
 }
 
+static void cacheReleaseLocked(void)
+{
+	if (g_cacheRefCount > 0 && --g_cacheRefCount == 0 && g_cachedBmpLoaded)
+	{
+		ft2_bmp_free(&g_cachedBmp);
+		g_cachedBmpLoaded = false;
+	}
+}
+
+void ft2_bmp_cache_retain(void)
+{
+	cacheLock();
+	g_cacheRefCount++;
+	cacheUnlock();
+}
+
+void ft2_bmp_cache_release(void)
+{
+	cacheLock();
+	cacheReleaseLocked();
+	cacheUnlock();
+}
+
+bool ft2_bmp_acquire(ft2_bmp_t *bmp)
+{
+	if (bmp == NULL)
+		return false;
+
+	cacheLock();
+	g_cacheRefCount++;
+
+	if (!g_cachedBmpLoaded)
+		g_cachedBmpLoaded = ft2_bmp_load(&g_cachedBmp);
+
+	if (!g_cachedBmpLoaded)
+	{
+		cacheReleaseLocked();
+		cacheUnlock();
+		memset(bmp, 0, sizeof(ft2_bmp_t));
+		return false;
+	}
+
+	*bmp = g_cachedBmp; /* Shallow copy: the pixel data stays shared */
+	cacheUnlock();
+	return true;
+}
+
+void ft2_bmp_release(ft2_bmp_t *bmp)
+{
+	if (bmp == NULL)
+		return;
+
+	memset(bmp, 0, sizeof(ft2_bmp_t));
+	ft2_bmp_cache_release();
+}
@@ -8,6 +8,18 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/**
+ * Bit-packed copy of a 1-bit font, for the glyph span blitter in
+ * ft2_plugin_video.c: pixel (x, y) is bit (x & 63) of
+ * bits[(y * wordsPerRow) + (x >> 6)]. Each row has one spare word, so any
+ * span of up to 32 pixels can be read with two loads.
+ */
+typedef struct ft2_font_bits_t
+{
+	uint64_t *bits;
+	uint32_t wordsPerRow;
+} ft2_font_bits_t;
+
 /**
  * Decoded bitmap assets. Three storage formats:
  *   1-bit: font masks (0=transparent, 1=foreground color)
@@ -26,6 +38,9 @@ typedef struct ft2_bmp_t
 	uint8_t *font7;        /* Small font 6x7 */
 	uint8_t *font8;        /* Smallest font 5x7 */
 
+	/* Bit-packed fonts used by the text/pattern drawing routines */
+	ft2_font_bits_t font1Bits, font2Bits, font3Bits, font4Bits, font6Bits, font7Bits;
+
 	/* 4-bit palette indexed: adapt to user theme */
 	uint8_t *ft2LogoBadges;        /* FT2/FT logo variants */
 	uint8_t *ft2ByBadges;          /* "by" badge variants */
@@ -55,6 +70,25 @@ bool ft2_bmp_load(ft2_bmp_t *bmp);
 /* Free all allocated bitmap data. */
 void ft2_bmp_free(ft2_bmp_t *bmp);
 
+/*
+ * Process-wide asset cache. The assets are decoded on the first
+ * ft2_bmp_acquire() and shared read-only by every UI; they are freed when
+ * the last reference goes away. Plugin instances hold a reference for
+ * their whole lifetime (without decoding anything), so closing and
+ * reopening editors doesn't decode the assets again.
+ */
+
+/* Takes/drops a reference without decoding (instance create/destroy) */
+void ft2_bmp_cache_retain(void);
+void ft2_bmp_cache_release(void);
+
+/* Fills bmp with the shared assets (decoding them on first use) and takes
+ * a reference. Returns false if they couldn't be decoded (bmp cleared). */
+bool ft2_bmp_acquire(ft2_bmp_t *bmp);
+
+/* Drops the reference taken by ft2_bmp_acquire() and clears bmp. */
+void ft2_bmp_release(ft2_bmp_t *bmp);
+
 /*
  * Font dimensions (char width, height, bitmap width).
  * Must match original FT2 bitmaps in gfxdata/.
@@ -34,6 +34,7 @@
 #include "ft2_plugin_instr_ed.h"
 #include "ft2_plugin_nibbles.h"
 #include "ft2_plugin_diskop.h"
+#include "ft2_plugin_sample_pool.h"
 #include "ft2_instance.h"
 
 /* ========== POSITION EDITOR CALLBACKS ========== */
@@ -395,7 +396,8 @@ void pbPattLenUp(ft2_instance_t *inst)
 	if (len >= 256)
 		return;
 	
-	inst->replayer.patternNumRows[inst->editor.editPattern] = len + 1;
+	if (!ft2_pattern_set_num_rows(inst, inst->editor.editPattern, (int16_t)(len + 1)))
+		return;
 	
 	if (inst->replayer.song.pattNum == inst->editor.editPattern)
 		inst->replayer.song.currNumRows = len + 1;
@@ -440,24 +442,21 @@ void pbPattExpand(ft2_instance_t *inst)
 	if (numRows > 128)
 		return;
 	
+	if (!ft2_pattern_set_num_rows(inst, curPattern, (int16_t)(numRows * 2)))
+		return;
+	
 	ft2_note_t *p = inst->replayer.pattern[curPattern];
 	if (p != NULL)
 	{
-		/* Copy pattern to temp and expand */
-		ft2_note_t tmpPattern[256 * FT2_MAX_CHANNELS];
-		memcpy(tmpPattern, p, numRows * FT2_MAX_CHANNELS * sizeof(ft2_note_t));
-		
+		/* Spread rows out in place, last row first */
+		const int32_t stride = inst->replayer.patternStride;
 		for (int32_t i = numRows - 1; i >= 0; i--)
 		{
-			for (int32_t j = 0; j < FT2_MAX_CHANNELS; j++)
-				p[((i * 2) * FT2_MAX_CHANNELS) + j] = tmpPattern[(i * FT2_MAX_CHANNELS) + j];
-			
-			memset(&p[((i * 2) + 1) * FT2_MAX_CHANNELS], 0, FT2_MAX_CHANNELS * sizeof(ft2_note_t));
+			memmove(&p[(i * 2) * stride], &p[i * stride], stride * sizeof(ft2_note_t));
+			memset(&p[((i * 2) + 1) * stride], 0, stride * sizeof(ft2_note_t));
 		}
 	}
 	
-	inst->replayer.patternNumRows[curPattern] = numRows * 2;
-	
 	if (inst->replayer.song.pattNum == curPattern)
 		inst->replayer.song.currNumRows = numRows * 2;
 	
@@ -485,10 +484,11 @@ void pbPattShrink(ft2_instance_t *inst)
 	ft2_note_t *p = inst->replayer.pattern[curPattern];
 	if (p != NULL)
 	{
+		const int32_t stride = inst->replayer.patternStride;
 		for (int32_t i = 0; i < numRows / 2; i++)
 		{
-			for (int32_t j = 0; j < FT2_MAX_CHANNELS; j++)
-				p[(i * FT2_MAX_CHANNELS) + j] = p[((i * 2) * FT2_MAX_CHANNELS) + j];
+			for (int32_t j = 0; j < stride; j++)
+				p[(i * stride) + j] = p[((i * 2) * stride) + j];
 		}
 	}
 	
@@ -555,7 +555,7 @@ void pbDiskOp(ft2_instance_t *inst)
 	else
 	{
 		hideTopScreen(inst); /* Disk op replaces top screen area */
-		inst->diskop.requestReadDir = true;
+		inst->diskop->requestReadDir = true;
 		inst->uiState.diskOpShown = true;
 		inst->uiState.scopesShown = false;
 	}
@@ -851,6 +851,7 @@ static void zapInstrs(ft2_instance_t *inst)
 		ft2_instance_free_instr(inst, i);
 		memset(inst->replayer.song.instrName[i], 0, 22+1);
 	}
+	clearSampleUndo(inst);
 	
 	/* Reset editor instrument pointers */
 	inst->editor.currVolEnvPoint = 0;
@@ -1197,6 +1198,11 @@ void pbAddChannels(ft2_instance_t *inst)
 	if (inst->replayer.song.numChannels > 30)
 		return;
 	
+	/* Widen pattern rows if the new channels aren't already stored (hidden) */
+	if (inst->replayer.song.numChannels + 2 > inst->replayer.patternStride &&
+	    !ft2_pattern_set_stride(inst, inst->replayer.song.numChannels + 2))
+		return;
+	
 	inst->replayer.song.numChannels += 2;
 	updateChanNums(inst);
 	
@@ -1749,10 +1755,10 @@ void rbSampleNoLoop(ft2_instance_t *inst)
 	if (s == NULL || s->dataPtr == NULL || s->length <= 0)
 		return;
 
-	/* Stop voices playing this sample before changing loop type */
-	ft2_stop_sample_voices(inst, s);
+	/* Voices keep playing the old data until the change is published */
+	ft2_sample_edit_begin(inst, s);
 
-	ft2_unfix_sample(s);
+	if (!ft2_unfix_sample(s)) return;
 
 	/* Clear loop flags */
 	s->flags &= ~(LOOP_FWD | LOOP_BIDI);
@@ -1776,10 +1782,10 @@ void rbSampleForwardLoop(ft2_instance_t *inst)
 	if (s == NULL || s->dataPtr == NULL || s->length <= 0)
 		return;
 
-	/* Stop voices playing this sample before changing loop type */
-	ft2_stop_sample_voices(inst, s);
+	/* Voices keep playing the old data until the change is published */
+	ft2_sample_edit_begin(inst, s);
 
-	ft2_unfix_sample(s);
+	if (!ft2_unfix_sample(s)) return;
 
 	/* Set forward loop */
 	s->flags &= ~LOOP_BIDI;
@@ -1811,10 +1817,10 @@ void rbSamplePingpongLoop(ft2_instance_t *inst)
 	if (s == NULL || s->dataPtr == NULL || s->length <= 0)
 		return;
 
-	/* Stop voices playing this sample before changing loop type */
-	ft2_stop_sample_voices(inst, s);
+	/* Voices keep playing the old data until the change is published */
+	ft2_sample_edit_begin(inst, s);
 
-	ft2_unfix_sample(s);
+	if (!ft2_unfix_sample(s)) return;
 
 	/* Set bidi loop */
 	s->flags &= ~LOOP_FWD;
@@ -1857,8 +1863,8 @@ static void onConvert8BitResult(ft2_instance_t *inst, ft2_dialog_result_t result
 	if (!(s->flags & SAMPLE_16BIT))
 		return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	if (result == DIALOG_RESULT_OK)
 	{
@@ -1904,8 +1910,8 @@ static void onConvert16BitResult(ft2_instance_t *inst, ft2_dialog_result_t resul
 	if (s->flags & SAMPLE_16BIT)
 		return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	if (result == DIALOG_RESULT_OK)
 	{
@@ -1929,7 +1935,7 @@ static void onConvert16BitResult(ft2_instance_t *inst, ft2_dialog_result_t resul
 		for (int32_t i = s->length - 1; i >= 0; i--)
 			dst[i] = (int16_t)(src[i] << 8);
 
-		free(s->origDataPtr);
+		ft2_sample_pool_release(s->origDataPtr);
 		s->origDataPtr = newOrigPtr;
 		s->dataPtr = newDataPtr;
 		s->flags |= SAMPLE_16BIT;
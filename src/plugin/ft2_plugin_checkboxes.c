@@ -124,6 +124,12 @@ checkBox_t checkBoxes[NUM_CHECKBOXES] =
 	{ 114,  52, 150, 12, NULL },  /* Sync position */
 	{ 114,  68, 180, 12, NULL },  /* Allow Fxx speed changes */
 
+	/* Audio thread profiling */
+	{ 405,   2,  60, 12, NULL },
+
+	/* Compressed DAW state */
+	{ 432,   2, 122, 12, NULL },
+
 	/* WAV renderer */
 	{ 62, 157, 159, 24, NULL },
 
@@ -176,6 +182,8 @@ void initCheckBoxes(void)
 	checkBoxes[CB_CONF_SYNC_TRANSPORT].callbackFunc = cbSyncTransportFromDAW;
 	checkBoxes[CB_CONF_SYNC_POSITION].callbackFunc = cbSyncPositionFromDAW;
 	checkBoxes[CB_CONF_ALLOW_FXX_SPEED].callbackFunc = cbAllowFxxSpeedChanges;
+	checkBoxes[CB_CONF_PROFILE].callbackFunc = cbConfigProfile;
+	checkBoxes[CB_CONF_COMPRESS_STATE].callbackFunc = cbConfigCompressState;
 
 	/* Config: I/O routing (32 channels) */
 	for (int i = 0; i < 32; i++)
@@ -86,6 +86,12 @@ enum
 	CB_CONF_SYNC_POSITION,
 	CB_CONF_ALLOW_FXX_SPEED,
 
+	/* Audio thread profiling (plugin-specific) */
+	CB_CONF_PROFILE,
+
+	/* Compressed DAW state (plugin-specific) */
+	CB_CONF_COMPRESS_STATE,
+
 	/* WAV renderer */
 	CB_WAV_TRACKS,
 
@@ -25,6 +25,7 @@
 #include "ft2_plugin_pattern_ed.h"
 #include "ft2_plugin_dialog.h"
 #include "ft2_plugin_timemap.h"
+#include "ft2_plugin_sample_undo.h"
 #include "ft2_instance.h"
 
 /* Initialize config with FT2 defaults. Called once per instance at creation. */
@@ -68,6 +69,7 @@ void ft2_config_init(ft2_plugin_config_t *config)
 
 	/* Sample editor defaults */
 	config->smpEdNote = 48;
+	config->smpUndoMemMB = FT2_UNDO_DEFAULT_MEM_MB;
 
 	/* Miscellaneous defaults */
 	config->smpCutToBuffer = true;
@@ -77,6 +79,7 @@ void ft2_config_init(ft2_plugin_config_t *config)
 	/* Disk operation defaults */
 	config->dirSortPriority = 0;    /* 0 = extension first (default) */
 	config->overwriteWarning = true;
+	config->compressState = false; /* Packed (version 3) states don't load in older builds */
 
 	/* DAW sync defaults (all enabled by default) */
 	config->syncBpmFromDAW = true;
@@ -301,6 +304,7 @@ void hideConfigScreen(ft2_instance_t *inst)
 	hideCheckBox(widgets, CB_CONF_SYNC_TRANSPORT);
 	hideCheckBox(widgets, CB_CONF_SYNC_POSITION);
 	hideCheckBox(widgets, CB_CONF_ALLOW_FXX_SPEED);
+	hideCheckBox(widgets, CB_CONF_PROFILE);
 	hidePushButton(widgets, PB_CONFIG_AMP_DOWN);
 	hidePushButton(widgets, PB_CONFIG_AMP_UP);
 	hidePushButton(widgets, PB_CONFIG_MASTVOL_DOWN);
@@ -346,6 +350,7 @@ void hideConfigScreen(ft2_instance_t *inst)
 	hideCheckBox(widgets, CB_CONF_PATTCUTBUF);
 	hideCheckBox(widgets, CB_CONF_KILLNOTES);
 	hideCheckBox(widgets, CB_CONF_OVERWRITE_WARN);
+	hideCheckBox(widgets, CB_CONF_COMPRESS_STATE);
 	hideCheckBox(widgets, CB_CONF_MULTICHAN_REC);
 	hideCheckBox(widgets, CB_CONF_MULTICHAN_KEYJAZZ);
 	hideCheckBox(widgets, CB_CONF_MULTICHAN_EDIT);
@@ -445,6 +450,12 @@ static void showConfigAudio(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 	showCheckBox(widgets, video, bmp, CB_CONF_ALLOW_FXX_SPEED);
 	textOutShadow(video, bmp, 131, 69, PAL_FORGRND, PAL_DSKTOP2, "Allow Fxx speed changes");
 
+	/* processBlock() profiling: times in microseconds */
+	widgets->checkBoxChecked[CB_CONF_PROFILE] = ft2_profile_enabled(&inst->profile);
+	showCheckBox(widgets, video, bmp, CB_CONF_PROFILE);
+	textOutShadow(video, bmp, 422, 4, PAL_FORGRND, PAL_DSKTOP2, "Profile");
+	drawConfigProfile(inst, video, bmp);
+
 	/* Interpolation */
 	setAudioConfigRadioButtonStates(widgets, cfg);
 	showRadioButtonGroup(widgets, video, bmp, RB_GROUP_CONFIG_AUDIO_INTERPOLATION);
@@ -640,6 +651,11 @@ static void showConfigMiscellaneous(ft2_instance_t *inst, ft2_video_t *video, co
 		widgets->radioButtonState[RB_CONFIG_FILESORT_NAME] = RADIOBUTTON_CHECKED;
 	showRadioButtonGroup(widgets, video, bmp, RB_GROUP_CONFIG_FILESORT);
 
+	/* DAW state: pack the module (lossless) when the host saves the project */
+	widgets->checkBoxChecked[CB_CONF_COMPRESS_STATE] = cfg->compressState;
+	showCheckBox(widgets, video, bmp, CB_CONF_COMPRESS_STATE);
+	textOutShadow(video, bmp, 448, 4, PAL_FORGRND, PAL_DSKTOP2, "Compress DAW state");
+
 	/* Record/Edit options */
 	textOutShadow(video, bmp, 114, 59, PAL_FORGRND, PAL_DSKTOP2, "Rec./Edit/Play:");
 
@@ -973,7 +989,7 @@ void rbFileSortExt(ft2_instance_t *inst)
 	inst->config.dirSortPriority = 0;
 	ft2_widgets_t *widgets = (inst->ui != NULL) ? &((ft2_ui_t *)inst->ui)->widgets : NULL;
 	if (widgets != NULL) checkRadioButtonNoRedraw(widgets, RB_CONFIG_FILESORT_EXT);
-	inst->diskop.requestReadDir = true;
+	inst->diskop->requestReadDir = true;
 }
 
 void rbFileSortName(ft2_instance_t *inst)
@@ -982,7 +998,7 @@ void rbFileSortName(ft2_instance_t *inst)
 	inst->config.dirSortPriority = 1;
 	ft2_widgets_t *widgets = (inst->ui != NULL) ? &((ft2_ui_t *)inst->ui)->widgets : NULL;
 	if (widgets != NULL) checkRadioButtonNoRedraw(widgets, RB_CONFIG_FILESORT_NAME);
-	inst->diskop.requestReadDir = true;
+	inst->diskop->requestReadDir = true;
 }
 
 /* ---------- Frequency slides ---------- */
@@ -1312,6 +1328,7 @@ void cbSampCutToBuff(ft2_instance_t *inst) { if (inst) inst->config.smpCutToBuff
 void cbPattCutToBuff(ft2_instance_t *inst) { if (inst) inst->config.ptnCutToBuffer = !inst->config.ptnCutToBuffer; }
 void cbKillNotesAtStop(ft2_instance_t *inst) { if (inst) inst->config.killNotesOnStopPlay = !inst->config.killNotesOnStopPlay; }
 void cbFileOverwriteWarn(ft2_instance_t *inst) { if (inst) inst->config.overwriteWarning = !inst->config.overwriteWarning; }
+void cbConfigCompressState(ft2_instance_t *inst) { if (inst) inst->config.compressState = !inst->config.compressState; }
 void cbMultiChanRec(ft2_instance_t *inst) { if (inst) inst->config.multiRec = !inst->config.multiRec; }
 void cbMultiChanKeyJazz(ft2_instance_t *inst) { if (inst) inst->config.multiKeyJazz = !inst->config.multiKeyJazz; }
 void cbMultiChanEdit(ft2_instance_t *inst) { if (inst) inst->config.multiEdit = !inst->config.multiEdit; }
@@ -1407,6 +1424,67 @@ void cbAllowFxxSpeedChanges(ft2_instance_t *inst)
 	inst->uiState.updatePosSections = true;
 }
 
+/* ---------- Audio thread profiling ---------- */
+
+#define PROFILE_X 405
+#define PROFILE_Y 16
+#define PROFILE_ROW_H 10
+
+void cbConfigProfile(ft2_instance_t *inst)
+{
+	if (inst == NULL) return;
+	ft2_profile_set_enabled(&inst->profile, !ft2_profile_enabled(&inst->profile));
+}
+
+static void profileNumOut(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t rightX, uint16_t y, float us)
+{
+	char str[16];
+	if (us < 10.0f)
+		snprintf(str, sizeof(str), "%.1f", us);
+	else
+		snprintf(str, sizeof(str), "%.0f", (us > 99999.0f) ? 99999.0f : us);
+	textOutShadow(video, bmp, rightX - textWidth(str), y, PAL_FORGRND, PAL_DSKTOP2, str);
+}
+
+/* Phase times so far, redrawn by the UI a few times a second while profiling */
+void drawConfigProfile(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
+{
+	static const int32_t rows[] = {
+		FT2_PROFILE_BLOCK, FT2_PROFILE_RENDER, FT2_PROFILE_LOCK,
+		FT2_PROFILE_SYNC, FT2_PROFILE_MIDI_IN, FT2_PROFILE_MIDI_OUT
+	};
+	const int32_t numRows = (int32_t)(sizeof(rows) / sizeof(rows[0]));
+
+	if (inst == NULL || video == NULL) return;
+
+	fillRect(video, 475, 4, 150, 9, PAL_DESKTOP);
+	fillRect(video, PROFILE_X, PROFILE_Y, 223, (numRows + 1) * PROFILE_ROW_H, PAL_DESKTOP);
+	textOutShadow(video, bmp, 515 - textWidth("p50"), 4, PAL_FORGRND, PAL_DSKTOP2, "p50");
+	textOutShadow(video, bmp, 568 - textWidth("p99"), 4, PAL_FORGRND, PAL_DSKTOP2, "p99");
+	textOutShadow(video, bmp, 624 - textWidth("max"), 4, PAL_FORGRND, PAL_DSKTOP2, "max");
+
+	ft2_profile_snapshot_t snap;
+	const bool haveStats = ft2_profile_read(&inst->profile, &snap);
+
+	for (int32_t i = 0; i < numRows; i++) {
+		const uint16_t y = PROFILE_Y + (uint16_t)(i * PROFILE_ROW_H);
+		textOutShadow(video, bmp, PROFILE_X, y, PAL_FORGRND, PAL_DSKTOP2, ft2_profile_phase_name(rows[i]));
+		if (haveStats) {
+			const ft2_profile_phase_t *ph = &snap.phase[rows[i]];
+			profileNumOut(video, bmp, 515, y, ph->p50Us);
+			profileNumOut(video, bmp, 568, y, ph->p99Us);
+			profileNumOut(video, bmp, 624, y, ph->maxUs);
+		}
+	}
+
+	if (haveStats) {
+		char str[64];
+		snprintf(str, sizeof(str), "Voc %d/%d Late %u Drop %u/%u", snap.voices, snap.maxVoices,
+			snap.overruns, snap.scopeDrops, snap.midiOutDrops);
+		textOutShadow(video, bmp, PROFILE_X, PROFILE_Y + (uint16_t)(numRows * PROFILE_ROW_H), PAL_FORGRND, PAL_DSKTOP2, str);
+	}
+}
+
 /* ---------- Amplification and master volume ---------- */
 
 void configAmpDown(ft2_instance_t *inst)
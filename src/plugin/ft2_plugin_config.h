@@ -88,6 +88,7 @@ typedef struct ft2_plugin_config_t
 
 	/* Sample editor */
 	uint8_t smpEdNote;      /* Preview note (48 = C-4) */
+	uint16_t smpUndoMemMB;  /* Undo history budget, shared by all samples */
 
 	/* Miscellaneous */
 	bool smpCutToBuffer;
@@ -97,6 +98,7 @@ typedef struct ft2_plugin_config_t
 	/* Disk operations */
 	uint8_t dirSortPriority; /* 0=extension, 1=name */
 	bool overwriteWarning;
+	bool compressState;      /* Pack the module in the DAW project state */
 
 	/* DAW sync (plugin-specific) */
 	bool syncBpmFromDAW;        /* DAW controls tempo */
@@ -200,6 +202,10 @@ void cbSyncTransportFromDAW(struct ft2_instance_t *inst);
 void cbSyncPositionFromDAW(struct ft2_instance_t *inst);
 void cbAllowFxxSpeedChanges(struct ft2_instance_t *inst);
 
+/* Audio: processBlock() profiling (plugin-specific) */
+void cbConfigProfile(struct ft2_instance_t *inst);
+void drawConfigProfile(struct ft2_instance_t *inst, struct ft2_video_t *video, const struct ft2_bmp_t *bmp);
+
 /* Layout: channel count */
 void rbConfigPatt4Chans(struct ft2_instance_t *inst);
 void rbConfigPatt6Chans(struct ft2_instance_t *inst);
@@ -231,6 +237,7 @@ void cbSampCutToBuff(struct ft2_instance_t *inst);
 void cbPattCutToBuff(struct ft2_instance_t *inst);
 void cbKillNotesAtStop(struct ft2_instance_t *inst);
 void cbFileOverwriteWarn(struct ft2_instance_t *inst);
+void cbConfigCompressState(struct ft2_instance_t *inst);
 void cbMultiChanRec(struct ft2_instance_t *inst);
 void cbMultiChanKeyJazz(struct ft2_instance_t *inst);
 void cbMultiChanEdit(struct ft2_instance_t *inst);
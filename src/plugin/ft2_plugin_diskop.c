@@ -29,6 +29,10 @@
 #include "ft2_plugin_textbox.h"
 #include "ft2_plugin_ui.h"
 #include "ft2_plugin_pattern_ed.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_workers.h"
+#include "ft2_plugin_simd.h"
+#include "ft2_plugin_smpfx.h"
 
 /* File list layout (matches standalone) */
 #define FILENAME_TEXT_X 170
@@ -104,7 +108,7 @@ static void drawSaveAsElements(ft2_instance_t *inst, ft2_video_t *video, const f
 
 	fillRect(video, 5, 99, 60, 42, PAL_DESKTOP);
 
-	switch (inst->diskop.itemType) {
+	switch (inst->diskop->itemType) {
 		default:
 		case FT2_DISKOP_ITEM_MODULE:
 			textOutShadow(video, bmp, 19, 101, PAL_FORGRND, PAL_DSKTOP2, "MOD");
@@ -147,15 +151,15 @@ static void setDiskOpItemRadioButtons(ft2_instance_t *inst, ft2_video_t *video,
 	hideRadioButtonGroup(widgets, RB_GROUP_DISKOP_TRK_SAVEAS);
 
 	/* Apply saved format selections */
-	widgets->radioButtonState[RB_DISKOP_MOD_MOD + inst->diskop.saveFormat[FT2_DISKOP_ITEM_MODULE]] = RADIOBUTTON_CHECKED;
-	widgets->radioButtonState[RB_DISKOP_SMP_RAW + inst->diskop.saveFormat[FT2_DISKOP_ITEM_SAMPLE]] = RADIOBUTTON_CHECKED;
+	widgets->radioButtonState[RB_DISKOP_MOD_MOD + inst->diskop->saveFormat[FT2_DISKOP_ITEM_MODULE]] = RADIOBUTTON_CHECKED;
+	widgets->radioButtonState[RB_DISKOP_SMP_RAW + inst->diskop->saveFormat[FT2_DISKOP_ITEM_SAMPLE]] = RADIOBUTTON_CHECKED;
 	widgets->radioButtonState[RB_DISKOP_INS_XI] = RADIOBUTTON_CHECKED;
 	widgets->radioButtonState[RB_DISKOP_PAT_XP] = RADIOBUTTON_CHECKED;
 	widgets->radioButtonState[RB_DISKOP_TRK_XT] = RADIOBUTTON_CHECKED;
 
 	/* Show only the relevant group */
 	if (inst->uiState.diskOpShown && video != NULL && bmp != NULL) {
-		switch (inst->diskop.itemType) {
+		switch (inst->diskop->itemType) {
 			default:
 			case FT2_DISKOP_ITEM_MODULE:  showRadioButtonGroup(widgets, video, bmp, RB_GROUP_DISKOP_MOD_SAVEAS); break;
 			case FT2_DISKOP_ITEM_INSTR:   showRadioButtonGroup(widgets, video, bmp, RB_GROUP_DISKOP_INS_SAVEAS); break;
@@ -174,7 +178,7 @@ static void displayCurrPath(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 	fillRect(video, 4, 145, 162, FONT1_CHAR_H, PAL_DESKTOP);
 
 	char pathBuf[256];
-	strncpy(pathBuf, inst->diskop.currentPath, sizeof(pathBuf) - 1);
+	strncpy(pathBuf, inst->diskop->currentPath, sizeof(pathBuf) - 1);
 	pathBuf[sizeof(pathBuf) - 1] = '\0';
 
 	int32_t len = (int32_t)strlen(pathBuf);
@@ -215,20 +219,20 @@ void showDiskOpScreen(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 		showScrollBar(widgets, video, SB_DISKOP_LIST);
 
 		uncheckRadioButtonGroup(widgets, RB_GROUP_DISKOP_ITEM);
-		widgets->radioButtonState[RB_DISKOP_MODULE + inst->diskop.itemType] = RADIOBUTTON_CHECKED;
+		widgets->radioButtonState[RB_DISKOP_MODULE + inst->diskop->itemType] = RADIOBUTTON_CHECKED;
 		showRadioButtonGroup(widgets, video, bmp, RB_GROUP_DISKOP_ITEM);
 		setDiskOpItemRadioButtons(inst, video, bmp);
 	}
 
 	/* First open: navigate to home directory */
-	if (inst->diskop.firstOpen) {
-		inst->diskop.firstOpen = false;
-		inst->diskop.requestGoHome = true;
+	if (inst->diskop->firstOpen) {
+		inst->diskop->firstOpen = false;
+		inst->diskop->requestGoHome = true;
 	}
 
 #ifdef _WIN32
-	inst->diskop.requestEnumerateDrives = true;
-	inst->diskop.requestDriveIndex = -1;
+	inst->diskop->requestEnumerateDrives = true;
+	inst->diskop->requestDriveIndex = -1;
 #endif
 
 	inst->uiState.needsFullRedraw = true;
@@ -295,12 +299,12 @@ void drawDiskOpScreen(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 
 	/* Handle deferred error messages from JUCE operations */
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-	if (inst->diskop.pathSetFailed) {
-		inst->diskop.pathSetFailed = false;
+	if (inst->diskop->pathSetFailed) {
+		inst->diskop->pathSetFailed = false;
 		if (ui != NULL) ft2_dialog_show_message(&ui->dialog, "System message", "Couldn't set directory path!");
 	}
-	if (inst->diskop.makeDirFailed) {
-		inst->diskop.makeDirFailed = false;
+	if (inst->diskop->makeDirFailed) {
+		inst->diskop->makeDirFailed = false;
 		if (ui != NULL) ft2_dialog_show_message(&ui->dialog, "System message",
 			"Couldn't create directory: Access denied, or a dir with the same name already exists!");
 	}
@@ -337,8 +341,8 @@ void drawDiskOpScreen(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 			PB_DISKOP_DRIVE5, PB_DISKOP_DRIVE6, PB_DISKOP_DRIVE7
 		};
 		for (int i = 0; i < FT2_DISKOP_MAX_DRIVES; i++) {
-			if (i < inst->diskop.numDrives && inst->diskop.driveNames[i][0] != '\0') {
-				widgets->pushButtons[driveButtons[i]].caption = inst->diskop.driveNames[i];
+			if (i < inst->diskop->numDrives && inst->diskop->driveNames[i][0] != '\0') {
+				widgets->pushButtons[driveButtons[i]].caption = inst->diskop->driveNames[i];
 				showPushButton(widgets, video, bmp, driveButtons[i]);
 			} else {
 				hidePushButton(widgets, driveButtons[i]);
@@ -355,9 +359,9 @@ void drawDiskOpScreen(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	ft2_textbox_show(inst, TB_DISKOP_FILENAME);
 
 	/* Item type radio buttons */
-	if (inst->diskop.itemType > 4) inst->diskop.itemType = 0;
+	if (inst->diskop->itemType > 4) inst->diskop->itemType = 0;
 	uncheckRadioButtonGroup(widgets, RB_GROUP_DISKOP_ITEM);
-	widgets->radioButtonState[RB_DISKOP_MODULE + inst->diskop.itemType] = RADIOBUTTON_CHECKED;
+	widgets->radioButtonState[RB_DISKOP_MODULE + inst->diskop->itemType] = RADIOBUTTON_CHECKED;
 	showRadioButtonGroup(widgets, video, bmp, RB_GROUP_DISKOP_ITEM);
 
 	/* Labels */
@@ -374,8 +378,8 @@ void drawDiskOpScreen(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	setDiskOpItemRadioButtons(inst, video, bmp);
 	displayCurrPath(inst, video, bmp);
 	diskOpDrawFilelist(inst, video, bmp);
-	setScrollBarEnd(inst, widgets, video, SB_DISKOP_LIST, inst->diskop.fileCount);
-	setScrollBarPos(inst, widgets, video, SB_DISKOP_LIST, inst->diskop.dirPos, false);
+	setScrollBarEnd(inst, widgets, video, SB_DISKOP_LIST, inst->diskop->fileCount);
+	setScrollBarPos(inst, widgets, video, SB_DISKOP_LIST, inst->diskop->dirPos, false);
 	ft2_textbox_draw(video, bmp, TB_DISKOP_FILENAME, inst);
 }
 
@@ -392,19 +396,19 @@ void diskOpDrawFilelist(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_
 	if (inst == NULL || video == NULL || bmp == NULL) return;
 
 	clearRect(video, FILENAME_TEXT_X - 1, DISKOP_LIST_Y, 162, DISKOP_LIST_H);
-	if (inst->diskop.fileCount == 0) return;
+	if (inst->diskop->fileCount == 0) return;
 
 	/* Selection highlight */
-	if (inst->diskop.selectedEntry >= 0 && inst->diskop.selectedEntry < FT2_DISKOP_ENTRY_NUM) {
-		uint16_t y = DISKOP_LIST_Y + (uint16_t)((FONT1_CHAR_H + 1) * inst->diskop.selectedEntry);
+	if (inst->diskop->selectedEntry >= 0 && inst->diskop->selectedEntry < FT2_DISKOP_ENTRY_NUM) {
+		uint16_t y = DISKOP_LIST_Y + (uint16_t)((FONT1_CHAR_H + 1) * inst->diskop->selectedEntry);
 		fillRect(video, FILENAME_TEXT_X - 1, y, 162, FONT1_CHAR_H, PAL_PATTEXT);
 	}
 
 	for (uint16_t i = 0; i < FT2_DISKOP_ENTRY_NUM; i++) {
-		int32_t bufEntry = inst->diskop.dirPos + i;
-		if (bufEntry >= inst->diskop.fileCount || inst->diskop.entries == NULL) break;
+		int32_t bufEntry = inst->diskop->dirPos + i;
+		if (bufEntry >= inst->diskop->fileCount || inst->diskop->entries == NULL) break;
 
-		ft2_diskop_entry_t *entry = &inst->diskop.entries[bufEntry];
+		ft2_diskop_entry_t *entry = &inst->diskop->entries[bufEntry];
 		if (entry->name[0] == '\0') continue;
 
 		uint16_t y = DISKOP_LIST_Y + (i * (FONT1_CHAR_H + 1));
@@ -459,8 +463,8 @@ void diskOpDrawDirectory(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp
 	displayCurrPath(inst, video, bmp);
 	ft2_widgets_t *widgets = (inst->ui != NULL) ? &((ft2_ui_t *)inst->ui)->widgets : NULL;
 	if (widgets != NULL) {
-		setScrollBarEnd(inst, widgets, video, SB_DISKOP_LIST, inst->diskop.fileCount);
-		setScrollBarPos(inst, widgets, video, SB_DISKOP_LIST, inst->diskop.dirPos, false);
+		setScrollBarEnd(inst, widgets, video, SB_DISKOP_LIST, inst->diskop->fileCount);
+		setScrollBarPos(inst, widgets, video, SB_DISKOP_LIST, inst->diskop->dirPos, false);
 	}
 	diskOpDrawFilelist(inst, video, bmp);
 }
@@ -470,39 +474,39 @@ void diskOpDrawDirectory(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp
 void pbDiskOpParent(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	inst->diskop.requestGoParent = true;
+	inst->diskop->requestGoParent = true;
 	inst->uiState.needsFullRedraw = true;
 }
 
 void pbDiskOpRoot(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	inst->diskop.requestGoRoot = true;
+	inst->diskop->requestGoRoot = true;
 	inst->uiState.needsFullRedraw = true;
 }
 
 void pbDiskOpHome(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	inst->diskop.requestGoHome = true;
+	inst->diskop->requestGoHome = true;
 	inst->uiState.needsFullRedraw = true;
 }
 
 #ifdef _WIN32
 /* Drive buttons (Windows only): navigate to enumerated drive root */
-void pbDiskOpDrive1(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 0; inst->uiState.needsFullRedraw = true; } }
-void pbDiskOpDrive2(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 1; inst->uiState.needsFullRedraw = true; } }
-void pbDiskOpDrive3(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 2; inst->uiState.needsFullRedraw = true; } }
-void pbDiskOpDrive4(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 3; inst->uiState.needsFullRedraw = true; } }
-void pbDiskOpDrive5(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 4; inst->uiState.needsFullRedraw = true; } }
-void pbDiskOpDrive6(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 5; inst->uiState.needsFullRedraw = true; } }
-void pbDiskOpDrive7(ft2_instance_t *inst) { if (inst) { inst->diskop.requestDriveIndex = 6; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive1(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 0; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive2(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 1; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive3(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 2; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive4(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 3; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive5(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 4; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive6(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 5; inst->uiState.needsFullRedraw = true; } }
+void pbDiskOpDrive7(ft2_instance_t *inst) { if (inst) { inst->diskop->requestDriveIndex = 6; inst->uiState.needsFullRedraw = true; } }
 #endif
 
 void pbDiskOpRefresh(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	inst->diskop.requestReadDir = true;
+	inst->diskop->requestReadDir = true;
 	inst->uiState.needsFullRedraw = true;
 }
 
@@ -510,8 +514,8 @@ void pbDiskOpRefresh(ft2_instance_t *inst)
 void pbDiskOpShowAll(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	inst->diskop.showAllFiles = !inst->diskop.showAllFiles;
-	inst->diskop.requestReadDir = true;
+	inst->diskop->showAllFiles = !inst->diskop->showAllFiles;
+	inst->diskop->requestReadDir = true;
 	inst->uiState.needsFullRedraw = true;
 }
 
@@ -522,9 +526,9 @@ static void onSetPathCallback(ft2_instance_t *inst, ft2_dialog_result_t result,
 {
 	(void)userData;
 	if (result == DIALOG_RESULT_OK && inputText != NULL && inputText[0] != '\0') {
-		strncpy(inst->diskop.newPath, inputText, FT2_PATH_MAX - 1);
-		inst->diskop.newPath[FT2_PATH_MAX - 1] = '\0';
-		inst->diskop.requestSetPath = true;
+		strncpy(inst->diskop->newPath, inputText, FT2_PATH_MAX - 1);
+		inst->diskop->newPath[FT2_PATH_MAX - 1] = '\0';
+		inst->diskop->requestSetPath = true;
 		inst->uiState.needsFullRedraw = true;
 	}
 }
@@ -547,22 +551,22 @@ void pbDiskOpExit(ft2_instance_t *inst)
 void pbDiskOpSave(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	inst->diskop.requestSave = true;
+	inst->diskop->requestSave = true;
 }
 
 /* Delete/Rename: disabled in plugin (sandboxed environments can't delete files) */
 void pbDiskOpDelete(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	if (inst->diskop.selectedEntry >= 0)
-		inst->diskop.requestDelete = true;
+	if (inst->diskop->selectedEntry >= 0)
+		inst->diskop->requestDelete = true;
 }
 
 void pbDiskOpRename(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	if (inst->diskop.selectedEntry >= 0)
-		inst->diskop.requestRename = true;
+	if (inst->diskop->selectedEntry >= 0)
+		inst->diskop->requestRename = true;
 }
 
 static void onMakeDirCallback(ft2_instance_t *inst, ft2_dialog_result_t result,
@@ -570,9 +574,9 @@ static void onMakeDirCallback(ft2_instance_t *inst, ft2_dialog_result_t result,
 {
 	(void)userData;
 	if (result == DIALOG_RESULT_OK && inputText != NULL && inputText[0] != '\0') {
-		strncpy(inst->diskop.newDirName, inputText, sizeof(inst->diskop.newDirName) - 1);
-		inst->diskop.newDirName[sizeof(inst->diskop.newDirName) - 1] = '\0';
-		inst->diskop.requestMakeDir = true;
+		strncpy(inst->diskop->newDirName, inputText, sizeof(inst->diskop->newDirName) - 1);
+		inst->diskop->newDirName[sizeof(inst->diskop->newDirName) - 1] = '\0';
+		inst->diskop->requestMakeDir = true;
 		inst->uiState.needsFullRedraw = true;
 	}
 }
@@ -590,8 +594,8 @@ void pbDiskOpMakeDir(ft2_instance_t *inst)
 void pbDiskOpListUp(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	if (inst->diskop.dirPos > 0) {
-		inst->diskop.dirPos--;
+	if (inst->diskop->dirPos > 0) {
+		inst->diskop->dirPos--;
 		inst->uiState.needsFullRedraw = true;
 	}
 }
@@ -599,8 +603,8 @@ void pbDiskOpListUp(ft2_instance_t *inst)
 void pbDiskOpListDown(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	if (inst->diskop.dirPos < inst->diskop.fileCount - FT2_DISKOP_ENTRY_NUM) {
-		inst->diskop.dirPos++;
+	if (inst->diskop->dirPos < inst->diskop->fileCount - FT2_DISKOP_ENTRY_NUM) {
+		inst->diskop->dirPos++;
 		inst->uiState.needsFullRedraw = true;
 	}
 }
@@ -608,7 +612,7 @@ void pbDiskOpListDown(ft2_instance_t *inst)
 void sbDiskOpSetPos(ft2_instance_t *inst, uint32_t pos)
 {
 	if (inst == NULL) return;
-	inst->diskop.dirPos = (int32_t)pos;
+	inst->diskop->dirPos = (int32_t)pos;
 	inst->uiState.needsFullRedraw = true;
 }
 
@@ -618,24 +622,26 @@ void sbDiskOpSetPos(ft2_instance_t *inst, uint32_t pos)
 static void setDiskOpItem(ft2_instance_t *inst, uint8_t item)
 {
 	if (inst == NULL || item > 4) return;
-	inst->diskop.itemType = item;
+	inst->diskop->itemType = item;
 
 	char *sourcePath = NULL;
 	switch (item) {
-		case FT2_DISKOP_ITEM_MODULE:  sourcePath = inst->diskop.modulePath; break;
-		case FT2_DISKOP_ITEM_INSTR:   sourcePath = inst->diskop.instrPath; break;
-		case FT2_DISKOP_ITEM_SAMPLE:  sourcePath = inst->diskop.samplePath; break;
-		case FT2_DISKOP_ITEM_PATTERN: sourcePath = inst->diskop.patternPath; break;
-		case FT2_DISKOP_ITEM_TRACK:   sourcePath = inst->diskop.trackPath; break;
+		case FT2_DISKOP_ITEM_MODULE:  sourcePath = inst->diskop->modulePath; break;
+		case FT2_DISKOP_ITEM_INSTR:   sourcePath = inst->diskop->instrPath; break;
+		case FT2_DISKOP_ITEM_SAMPLE:  sourcePath = inst->diskop->samplePath; break;
+		case FT2_DISKOP_ITEM_PATTERN: sourcePath = inst->diskop->patternPath; break;
+		case FT2_DISKOP_ITEM_TRACK:   sourcePath = inst->diskop->trackPath; break;
 		default: return;
 	}
 
 	if (sourcePath[0] != '\0') {
-		strncpy(inst->diskop.currentPath, sourcePath, FT2_PATH_MAX - 1);
-		inst->diskop.currentPath[FT2_PATH_MAX - 1] = '\0';
+		const char *end = (const char *)memchr(sourcePath, '\0', FT2_PATH_MAX - 1);
+		const size_t len = (end != NULL) ? (size_t)(end - sourcePath) : FT2_PATH_MAX - 1;
+		memcpy(inst->diskop->currentPath, sourcePath, len);
+		inst->diskop->currentPath[len] = '\0';
 	}
 
-	inst->diskop.requestReadDir = true;
+	inst->diskop->requestReadDir = true;
 	inst->uiState.needsFullRedraw = true;
 }
 
@@ -647,14 +653,14 @@ void rbDiskOpTrack(ft2_instance_t *inst)   { setDiskOpItem(inst, FT2_DISKOP_ITEM
 
 /* ---------- Save format selection ---------- */
 
-void rbDiskOpModSaveMod(ft2_instance_t *inst) { if (inst) inst->diskop.saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_MOD; }
-void rbDiskOpModSaveXm(ft2_instance_t *inst)  { if (inst) inst->diskop.saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_XM; }
-void rbDiskOpModSaveWav(ft2_instance_t *inst) { if (inst) inst->diskop.saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_WAV; }
-void rbDiskOpSmpSaveRaw(ft2_instance_t *inst) { if (inst) inst->diskop.saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_RAW; }
-void rbDiskOpSmpSaveIff(ft2_instance_t *inst) { if (inst) inst->diskop.saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_IFF; }
-void rbDiskOpSmpSaveWav(ft2_instance_t *inst) { if (inst) inst->diskop.saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_WAV; }
+void rbDiskOpModSaveMod(ft2_instance_t *inst) { if (inst) inst->diskop->saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_MOD; }
+void rbDiskOpModSaveXm(ft2_instance_t *inst)  { if (inst) inst->diskop->saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_XM; }
+void rbDiskOpModSaveWav(ft2_instance_t *inst) { if (inst) inst->diskop->saveFormat[FT2_DISKOP_ITEM_MODULE] = FT2_MOD_SAVE_WAV; }
+void rbDiskOpSmpSaveRaw(ft2_instance_t *inst) { if (inst) inst->diskop->saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_RAW; }
+void rbDiskOpSmpSaveIff(ft2_instance_t *inst) { if (inst) inst->diskop->saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_IFF; }
+void rbDiskOpSmpSaveWav(ft2_instance_t *inst) { if (inst) inst->diskop->saveFormat[FT2_DISKOP_ITEM_SAMPLE] = FT2_SMP_SAVE_WAV; }
 
-/* Stub: directory reading done via JUCE callback (populates inst->diskop.entries) */
+/* Stub: directory reading done via JUCE callback (populates inst->diskop->entries) */
 void diskOpReadDirectory(ft2_instance_t *inst) { (void)inst; }
 
 /* ---------- Mouse handling ---------- */
@@ -668,9 +674,9 @@ bool diskOpTestMouseDown(ft2_instance_t *inst, int32_t mouseX, int32_t mouseY)
 	    mouseY >= DISKOP_LIST_Y && mouseY < DISKOP_LIST_Y + DISKOP_LIST_H) {
 		int32_t entryIndex = (mouseY - DISKOP_LIST_Y) / (FONT1_CHAR_H + 1);
 		if (entryIndex >= 0 && entryIndex < FT2_DISKOP_ENTRY_NUM) {
-			int32_t absIndex = inst->diskop.dirPos + entryIndex;
-			if (absIndex < inst->diskop.fileCount) {
-				inst->diskop.selectedEntry = entryIndex;
+			int32_t absIndex = inst->diskop->dirPos + entryIndex;
+			if (absIndex < inst->diskop->fileCount) {
+				inst->diskop->selectedEntry = entryIndex;
 				diskOpHandleItemClick(inst, absIndex);
 				return true;
 			}
@@ -685,7 +691,7 @@ static void unsavedChangesLoadCallback(ft2_instance_t *inst, ft2_dialog_result_t
 	(void)inputText;
 	int32_t entryIndex = (int32_t)(intptr_t)userData;
 	if (result == DIALOG_RESULT_YES) {
-		inst->diskop.requestLoadEntry = entryIndex;
+		inst->diskop->requestLoadEntry = entryIndex;
 		inst->uiState.needsFullRedraw = true;
 	}
 }
@@ -698,31 +704,31 @@ static void unsavedChangesLoadCallback(ft2_instance_t *inst, ft2_dialog_result_t
  */
 void diskOpHandleItemClick(ft2_instance_t *inst, int32_t entryIndex)
 {
-	if (inst == NULL || inst->diskop.entries == NULL) return;
-	if (entryIndex < 0 || entryIndex >= inst->diskop.fileCount) return;
+	if (inst == NULL || inst->diskop->entries == NULL) return;
+	if (entryIndex < 0 || entryIndex >= inst->diskop->fileCount) return;
 
-	ft2_diskop_entry_t *entry = &inst->diskop.entries[entryIndex];
+	ft2_diskop_entry_t *entry = &inst->diskop->entries[entryIndex];
 	uint32_t currentTime = inst->editor.framesPassed;
-	bool isDoubleClick = (entryIndex == inst->diskop.lastClickedEntry && 
-	                      (currentTime - inst->diskop.lastClickTime) < 30);
-	inst->diskop.lastClickedEntry = entryIndex;
-	inst->diskop.lastClickTime = currentTime;
+	bool isDoubleClick = (entryIndex == inst->diskop->lastClickedEntry && 
+	                      (currentTime - inst->diskop->lastClickTime) < 30);
+	inst->diskop->lastClickedEntry = entryIndex;
+	inst->diskop->lastClickTime = currentTime;
 
 	if (entry->isDir) {
-		inst->diskop.requestOpenEntry = entryIndex;
+		inst->diskop->requestOpenEntry = entryIndex;
 	} else {
-		strncpy(inst->diskop.filename, entry->name, FT2_PATH_MAX - 1);
-		inst->diskop.filename[FT2_PATH_MAX - 1] = '\0';
+		strncpy(inst->diskop->filename, entry->name, FT2_PATH_MAX - 1);
+		inst->diskop->filename[FT2_PATH_MAX - 1] = '\0';
 
 		if (isDoubleClick) {
-			if (inst->diskop.itemType == FT2_DISKOP_ITEM_MODULE && inst->replayer.song.isModified) {
+			if (inst->diskop->itemType == FT2_DISKOP_ITEM_MODULE && inst->replayer.song.isModified) {
 				ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 				if (ui != NULL)
 					ft2_dialog_show_yesno_cb(&ui->dialog, "System request",
 						"You have unsaved changes in your song. Load new song and lose ALL changes?",
 						inst, unsavedChangesLoadCallback, (void *)(intptr_t)entryIndex);
 			} else {
-				inst->diskop.requestLoadEntry = entryIndex;
+				inst->diskop->requestLoadEntry = entryIndex;
 			}
 		}
 	}
@@ -732,11 +738,11 @@ void diskOpHandleItemClick(ft2_instance_t *inst, int32_t entryIndex)
 void freeDiskOp(ft2_instance_t *inst)
 {
 	if (inst == NULL) return;
-	if (inst->diskop.entries != NULL) {
-		free(inst->diskop.entries);
-		inst->diskop.entries = NULL;
+	if (inst->diskop->entries != NULL) {
+		free(inst->diskop->entries);
+		inst->diskop->entries = NULL;
 	}
-	inst->diskop.fileCount = 0;
+	inst->diskop->fileCount = 0;
 }
 
 /* ---------- Format detection ---------- */
@@ -876,56 +882,122 @@ typedef struct xm_ins_hdr_t {
 #pragma pack(pop)
 #endif
 
-/* Delta encoding for XM/XI sample data (saves space) */
-static void sample_to_delta(int8_t *p, int32_t length, uint8_t smpFlags)
+/* Delta runs over plain sample data: dst[i] = src[i] - src[i - 1],
+ * with prev standing in for src[-1]. Output may be unaligned. */
+static void deltaRun16(uint8_t *dst, const int16_t *src, int32_t n, int16_t prev)
 {
-	if (smpFlags & FT2_SAMPLE_16BIT) {
-		int16_t *p16 = (int16_t *)p, prev = 0;
-		for (int32_t i = 0; i < length; i++) {
-			int16_t cur = p16[i];
-			p16[i] -= prev;
-			prev = cur;
-		}
-	} else {
-		int8_t prev = 0;
-		for (int32_t i = 0; i < length; i++) {
-			int8_t cur = p[i];
-			p[i] -= prev;
-			prev = cur;
-		}
+	if (n <= 0) return;
+
+	const int16_t d0 = (int16_t)(src[0] - prev);
+	memcpy(dst, &d0, 2);
+
+	int32_t i = 1;
+#if defined(FT2_SIMD_SSE2)
+	for (; i + 8 <= n; i += 8) {
+		const __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)&src[i]),
+		                                _mm_loadu_si128((const __m128i *)&src[i - 1]));
+		_mm_storeu_si128((__m128i *)&dst[i * 2], d);
+	}
+#elif defined(FT2_SIMD_NEON)
+	for (; i + 8 <= n; i += 8)
+		vst1q_u8(&dst[i * 2], vreinterpretq_u8_s16(vsubq_s16(vld1q_s16(&src[i]), vld1q_s16(&src[i - 1]))));
+#endif
+	for (; i < n; i++) {
+		const int16_t d = (int16_t)(src[i] - src[i - 1]);
+		memcpy(&dst[i * 2], &d, 2);
 	}
 }
 
-/* Decode delta-encoded sample data */
-static void delta_to_sample(int8_t *p, int32_t length, uint8_t smpFlags)
+static void deltaRun8(uint8_t *dst, const int8_t *src, int32_t n, int8_t prev)
 {
-	if (smpFlags & FT2_SAMPLE_16BIT) {
-		int16_t *p16 = (int16_t *)p, acc = 0;
-		for (int32_t i = 0; i < length; i++) {
-			acc += p16[i];
-			p16[i] = acc;
+	if (n <= 0) return;
+
+	dst[0] = (uint8_t)(src[0] - prev);
+
+	int32_t i = 1;
+#if defined(FT2_SIMD_SSE2)
+	for (; i + 16 <= n; i += 16) {
+		const __m128i d = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)&src[i]),
+		                               _mm_loadu_si128((const __m128i *)&src[i - 1]));
+		_mm_storeu_si128((__m128i *)&dst[i], d);
+	}
+#elif defined(FT2_SIMD_NEON)
+	for (; i + 16 <= n; i += 16)
+		vst1q_u8(&dst[i], vreinterpretq_u8_s8(vsubq_s8(vld1q_s8(&src[i]), vld1q_s8(&src[i - 1]))));
+#endif
+	for (; i < n; i++)
+		dst[i] = (uint8_t)(src[i] - src[i - 1]);
+}
+
+/* Sample value as saved: the original samples in place of the loop-fix taps */
+static inline int16_t savedSample(const ft2_sample_t *smp, int32_t i, int32_t fixStart, int32_t fixEnd)
+{
+	if (i >= fixStart && i < fixEnd)
+		return (smp->flags & FT2_SAMPLE_16BIT) ? smp->fixedSmp[i - fixStart] : (int8_t)smp->fixedSmp[i - fixStart];
+	return (smp->flags & FT2_SAMPLE_16BIT) ? ((const int16_t *)smp->dataPtr)[i] : smp->dataPtr[i];
+}
+
+/* Delta encoding for XM/XI sample data (saves space).
+ * Encodes frames first..first+count-1 into dst and reads the original
+ * samples in place of the loop-fix taps, so the (possibly shared) sample
+ * is left untouched. Any range can be encoded on its own. */
+static void deltaEncode(uint8_t *dst, const ft2_sample_t *smp, int32_t first, int32_t count)
+{
+	const int32_t fixStart = smp->isFixed ? smp->fixedPos : smp->length;
+	const int32_t fixEnd = smp->isFixed ? smp->fixedPos + FT2_MAX_RIGHT_TAPS : smp->length;
+	const bool sample16Bit = (smp->flags & FT2_SAMPLE_16BIT) != 0;
+	const int32_t end = first + count;
+
+	int16_t prev = (first > 0) ? savedSample(smp, first - 1, fixStart, fixEnd) : 0;
+	int32_t i = first;
+	while (i < end) {
+		if (i >= fixStart && i < fixEnd) {
+			/* The taps, one at a time */
+			const int16_t cur = savedSample(smp, i, fixStart, fixEnd);
+			if (sample16Bit) {
+				const int16_t delta = (int16_t)(cur - prev);
+				memcpy(&dst[(i - first) * 2], &delta, 2);
+			} else {
+				dst[i - first] = (uint8_t)(cur - prev);
+			}
+			prev = cur;
+			i++;
+			continue;
 		}
-	} else {
-		int8_t acc = 0;
-		for (int32_t i = 0; i < length; i++) {
-			acc += p[i];
-			p[i] = acc;
+
+		/* Plain data up to the taps or the end */
+		const int32_t runEnd = (i < fixStart && fixStart < end) ? fixStart : end;
+		if (sample16Bit) {
+			const int16_t *p16 = (const int16_t *)smp->dataPtr;
+			deltaRun16(&dst[(i - first) * 2], &p16[i], runEnd - i, prev);
+			prev = p16[runEnd - 1];
+		} else {
+			deltaRun8(&dst[i - first], &smp->dataPtr[i], runEnd - i, (int8_t)prev);
+			prev = smp->dataPtr[runEnd - 1];
 		}
+		i = runEnd;
 	}
 }
 
+/* Whole sample, returns the number of bytes written */
+static int32_t write_delta_sample(uint8_t *dst, const ft2_sample_t *smp)
+{
+	deltaEncode(dst, smp, 0, smp->length);
+	return (smp->flags & FT2_SAMPLE_16BIT) ? smp->length * 2 : smp->length;
+}
+
 /*
  * Pack pattern data for XM file.
  * XM uses run-length packing: if a field is 0, omit it and set a bit flag.
  * If all 4 main fields are non-zero, store unpacked (5 bytes).
  * Otherwise, store pack byte (with bit 7 set) + only non-zero fields.
  */
-static uint16_t packPatt(uint8_t *writePtr, uint8_t *pattPtr, uint16_t numRows, uint16_t numChannels)
+static uint16_t packPatt(uint8_t *writePtr, uint8_t *pattPtr, int32_t pattStride, uint16_t numRows, uint16_t numChannels)
 {
 	if (pattPtr == NULL) return 0;
 
 	uint16_t totalPackLen = 0;
-	const int32_t pitch = 5 * (FT2_MAX_CHANNELS - numChannels);
+	const int32_t pitch = 5 * (pattStride - numChannels);
 
 	for (int32_t row = 0; row < numRows; row++) {
 		for (int32_t chn = 0; chn < numChannels; chn++) {
@@ -965,90 +1037,181 @@ static uint16_t packPatt(uint8_t *writePtr, uint8_t *pattPtr, uint16_t numRows,
 	return totalPackLen;
 }
 
-bool ft2_save_module(ft2_instance_t *inst, uint8_t **outData, uint32_t *outSize)
+/* Length packPatt() would return, without writing anything */
+static uint32_t packPattSize(const uint8_t *pattPtr, int32_t pattStride, uint16_t numRows, uint16_t numChannels)
 {
-	if (inst == NULL || outData == NULL || outSize == NULL)
-		return false;
+	if (pattPtr == NULL) return 0;
 
-	ft2_replayer_state_t *rep = &inst->replayer;
+	uint32_t totalPackLen = 0;
+	const int32_t pitch = 5 * (pattStride - numChannels);
 
-	/* Count patterns - same as standalone: find last non-empty pattern */
-	int32_t numPatterns = FT2_MAX_PATTERNS;
-	do
-	{
-		if (patternEmpty(inst, numPatterns - 1))
-			numPatterns--;
-		else
-			break;
+	for (int32_t row = 0; row < numRows; row++) {
+		for (int32_t chn = 0; chn < numChannels; chn++, pattPtr += 5) {
+			const int32_t mainFields = (pattPtr[0] > 0) + (pattPtr[1] > 0) + (pattPtr[2] > 0) + (pattPtr[3] > 0);
+			totalPackLen += (mainFields == 4) ? 5 : 1 + mainFields + (pattPtr[4] > 0);
+		}
+		pattPtr += pitch;
 	}
-	while (numPatterns > 0);
 
-	/* Count instruments - same as standalone: find last with samples or name */
-	int32_t numInstruments = FT2_MAX_INST;
-	while (numInstruments > 0 &&
-	       countUsedSamples(rep->instr[numInstruments]) == 0 &&
-	       rep->song.instrName[numInstruments][0] == '\0')
-	{
-		numInstruments--;
-	}
+	return totalPackLen;
+}
 
-	/* Allocate temporary buffer for packed pattern data */
-	uint8_t *packedPattData = (uint8_t *)malloc(65536);
-	if (packedPattData == NULL)
-		return false;
+/* Patterns and instruments an XM save writes - same as standalone: up to
+ * the last non-empty pattern, and the last instrument with samples or a name */
+static void countSavedItems(ft2_instance_t *inst, int32_t *numPatterns, int32_t *numInstruments)
+{
+	ft2_replayer_state_t *rep = &inst->replayer;
 
-	/* Calculate required size (estimate high, then shrink) */
-	uint32_t headerSize = 336;  /* XM header (60 + 276) */
-	uint32_t patternSize = 0;
-	uint32_t instrumentSize = 0;
+	int32_t p = FT2_MAX_PATTERNS;
+	while (p > 0 && patternEmpty(inst, (uint16_t)(p - 1)))
+		p--;
 
-	/* Pattern sizes: 9-byte header each + worst case packed data */
-	for (int32_t i = 0; i < numPatterns; i++)
-	{
-		int16_t numRows = rep->patternNumRows[i];
-		if (numRows < 1) numRows = 64;
-		patternSize += 9 + numRows * rep->song.numChannels * 5;
+	int32_t i = FT2_MAX_INST;
+	while (i > 0 && countUsedSamples(rep->instr[i]) == 0 && rep->song.instrName[i][0] == '\0')
+		i--;
+
+	*numPatterns = p;
+	*numInstruments = i;
+}
+
+uint32_t ft2_save_module_size(ft2_instance_t *inst)
+{
+	if (inst == NULL)
+		return 0;
+
+	ft2_replayer_state_t *rep = &inst->replayer;
+
+	int32_t numPatterns, numInstruments;
+	countSavedItems(inst, &numPatterns, &numInstruments);
+
+	uint64_t size = 60 + 276; /* XM header */
+
+	/* Empty patterns are saved freed, with no data */
+	for (int32_t i = 0; i < numPatterns; i++) {
+		size += sizeof(xm_patt_hdr_t);
+		if (!patternEmpty(inst, (uint16_t)i))
+			size += packPattSize((const uint8_t *)rep->pattern[i], rep->patternStride,
+				rep->patternNumRows[i], rep->song.numChannels);
 	}
 
-	/* Instrument sizes: header + sample headers + sample data */
-	for (int32_t i = 1; i <= numInstruments; i++)
-	{
+	for (int32_t i = 1; i <= numInstruments; i++) {
 		ft2_instr_t *instr = rep->instr[i];
-		int16_t numSamples = (instr != NULL) ? countUsedSamples(instr) : 0;
+		const int16_t numSamples = countUsedSamples(instr);
+		if (numSamples == 0) {
+			size += 22 + 11; /* Name + minimal header */
+			continue;
+		}
 
-		if (numSamples > 0)
-		{
-			instrumentSize += XM_INSTR_HEADER_SIZE + (numSamples * sizeof(xm_smp_hdr_t));
-			for (int32_t s = 0; s < numSamples; s++)
-			{
-				ft2_sample_t *smp = &instr->smp[s];
-				if (smp->dataPtr != NULL && smp->length > 0)
-				{
-					int32_t smpBytes = smp->length;
-					if (smp->flags & FT2_SAMPLE_16BIT)
-						smpBytes *= 2;
-					instrumentSize += smpBytes;
-				}
-			}
+		size += XM_INSTR_HEADER_SIZE + (numSamples * sizeof(xm_smp_hdr_t));
+		for (int32_t s = 0; s < numSamples; s++) {
+			const ft2_sample_t *smp = &instr->smp[s];
+			if (smp->dataPtr != NULL && smp->length > 0)
+				size += (smp->flags & FT2_SAMPLE_16BIT) ? (uint64_t)smp->length * 2 : (uint64_t)smp->length;
 		}
+	}
+
+	return (size <= UINT32_MAX) ? (uint32_t)size : 0;
+}
+
+/* ---------- Streaming XM writer ---------- */
+
+#define DELTA_PIECE_FRAMES 65536 /* Sample data is encoded in jobs of up to this many frames */
+#define DELTA_MAX_PIECES   512
+#define DELTA_PARALLEL_MIN_BYTES (256 * 1024) /* Less is encoded inline: waking the pool costs more */
+
+typedef struct deltaPiece_t {
+	const ft2_sample_t *smp;
+	int32_t first, count;
+	uint32_t offset; /* In the chunk */
+} deltaPiece_t;
+
+/* The file is built one chunk at a time. Headers and packed patterns are
+ * written straight into the chunk; sample data is queued as pieces and
+ * delta-encoded (in parallel if there's enough) when the chunk is full. */
+typedef struct xmStream_t {
+	ft2_save_write_t write;
+	void *userData;
+	uint8_t *chunk;
+	uint32_t used, written, pieceBytes;
+	int32_t numPieces;
+	bool failed;
+	deltaPiece_t pieces[DELTA_MAX_PIECES];
+} xmStream_t;
+
+static void deltaWorker(void *userData, int32_t jobIndex)
+{
+	xmStream_t *st = (xmStream_t *)userData;
+	const deltaPiece_t *pc = &st->pieces[jobIndex];
+	deltaEncode(&st->chunk[pc->offset], pc->smp, pc->first, pc->count);
+}
+
+static void streamFlush(xmStream_t *st)
+{
+	if (st->numPieces > 1 && st->pieceBytes >= DELTA_PARALLEL_MIN_BYTES) {
+		ft2_workers_run(deltaWorker, st, st->numPieces);
+	} else {
+		for (int32_t i = 0; i < st->numPieces; i++)
+			deltaWorker(st, i);
+	}
+	st->numPieces = 0;
+	st->pieceBytes = 0;
+
+	if (st->used > 0 && !st->failed) {
+		if (st->write(st->userData, st->chunk, st->used))
+			st->written += st->used;
 		else
-		{
-			instrumentSize += 22 + 11;  /* Empty instrument: name (22) + minimal header (11) */
-		}
+			st->failed = true;
 	}
+	st->used = 0;
+}
+
+/* Room for n contiguous bytes in the chunk (n <= FT2_SAVE_CHUNK_SIZE) */
+static uint8_t *streamReserve(xmStream_t *st, uint32_t n)
+{
+	if (st->used + n > FT2_SAVE_CHUNK_SIZE)
+		streamFlush(st);
+	return &st->chunk[st->used];
+}
 
-	uint32_t totalSize = headerSize + patternSize + instrumentSize;
+static void streamBytes(xmStream_t *st, const void *data, uint32_t n)
+{
+	memcpy(streamReserve(st, n), data, n);
+	st->used += n;
+}
 
-	/* Allocate buffer */
-	*outData = (uint8_t *)malloc(totalSize);
-	if (*outData == NULL)
-	{
-		free(packedPattData);
-		return false;
+static void streamSample(xmStream_t *st, const ft2_sample_t *smp)
+{
+	const uint32_t frameBytes = (smp->flags & FT2_SAMPLE_16BIT) ? 2 : 1;
+
+	int32_t first = 0;
+	while (first < smp->length && !st->failed) {
+		const uint32_t room = (FT2_SAVE_CHUNK_SIZE - st->used) / frameBytes;
+		if (room == 0 || st->numPieces == DELTA_MAX_PIECES) {
+			streamFlush(st);
+			continue;
+		}
+
+		int32_t count = smp->length - first;
+		if (count > DELTA_PIECE_FRAMES) count = DELTA_PIECE_FRAMES;
+		if ((uint32_t)count > room) count = (int32_t)room;
+
+		deltaPiece_t *pc = &st->pieces[st->numPieces++];
+		pc->smp = smp;
+		pc->first = first;
+		pc->count = count;
+		pc->offset = st->used;
+
+		st->used += (uint32_t)count * frameBytes;
+		st->pieceBytes += (uint32_t)count * frameBytes;
+		first += count;
 	}
+}
 
-	memset(*outData, 0, totalSize);
-	uint8_t *p = *outData;
+static void streamHeader(xmStream_t *st, ft2_instance_t *inst, int32_t numPatterns, int32_t numInstruments)
+{
+	ft2_replayer_state_t *rep = &inst->replayer;
+	uint8_t *p = streamReserve(st, 60 + 276);
+	uint8_t *const start = p;
 
 	/* ===== XM HEADER (60 bytes) ===== */
 	memcpy(p, "Extended Module: ", 17);
@@ -1088,10 +1251,12 @@ bool ft2_save_module(ft2_instance_t *inst, uint8_t **outData, uint32_t *outSize)
 	memcpy(p, &numCh, 2);
 	p += 2;
 
-	memcpy(p, &numPatterns, 2);
+	uint16_t numPatt = (uint16_t)numPatterns;
+	memcpy(p, &numPatt, 2);
 	p += 2;
 
-	memcpy(p, &numInstruments, 2);
+	uint16_t numIns = (uint16_t)numInstruments;
+	memcpy(p, &numIns, 2);
 	p += 2;
 
 	uint16_t flags = inst->audio.linearPeriodsFlag ? 1 : 0;
@@ -1109,166 +1274,215 @@ bool ft2_save_module(ft2_instance_t *inst, uint8_t **outData, uint32_t *outSize)
 	memcpy(p, rep->song.orders, 256);
 	p += 256;
 
-	/* ===== PATTERNS ===== */
-	for (int32_t i = 0; i < numPatterns; i++)
-	{
-		/* Free empty patterns and reset to 64 rows (matches standalone) */
-		if (patternEmpty(inst, i))
-		{
-			if (rep->pattern[i] != NULL)
-			{
-				free(rep->pattern[i]);
-				rep->pattern[i] = NULL;
-			}
-			rep->patternNumRows[i] = 64;
-		}
+	st->used += (uint32_t)(p - start);
+}
 
-		xm_patt_hdr_t ph;
-		memset(&ph, 0, sizeof(ph));
-		ph.headerSize = sizeof(xm_patt_hdr_t);
-		ph.type = 0;
-		ph.numRows = rep->patternNumRows[i];
+static void streamPattern(xmStream_t *st, ft2_instance_t *inst, int32_t pattNum)
+{
+	ft2_replayer_state_t *rep = &inst->replayer;
 
-		if (rep->pattern[i] == NULL)
-		{
-			ph.dataSize = 0;
-			memcpy(p, &ph, sizeof(ph));
-			p += sizeof(ph);
-		}
-		else
-		{
-			ph.dataSize = packPatt(packedPattData, (uint8_t *)rep->pattern[i],
-			                        ph.numRows, rep->song.numChannels);
+	xm_patt_hdr_t ph;
+	memset(&ph, 0, sizeof(ph));
+	ph.headerSize = sizeof(xm_patt_hdr_t);
+	ph.type = 0;
+	ph.numRows = rep->patternNumRows[pattNum];
 
-			memcpy(p, &ph, sizeof(ph));
-			p += sizeof(ph);
+	if (rep->pattern[pattNum] == NULL) {
+		ph.dataSize = 0;
+		streamBytes(st, &ph, sizeof(ph));
+		return;
+	}
 
-			memcpy(p, packedPattData, ph.dataSize);
-			p += ph.dataSize;
-		}
+	/* Packed straight into the chunk, behind its header */
+	const uint32_t maxPackLen = (uint32_t)ph.numRows * rep->song.numChannels * 5;
+	uint8_t *p = streamReserve(st, sizeof(ph) + maxPackLen);
+	ph.dataSize = packPatt(p + sizeof(ph), (uint8_t *)rep->pattern[pattNum], rep->patternStride,
+	                       ph.numRows, rep->song.numChannels);
+	memcpy(p, &ph, sizeof(ph));
+	st->used += sizeof(ph) + ph.dataSize;
+}
+
+static void streamInstrument(xmStream_t *st, ft2_instance_t *inst, int32_t insNum)
+{
+	ft2_replayer_state_t *rep = &inst->replayer;
+	ft2_instr_t *instr = rep->instr[insNum];
+	int16_t numSamples = countUsedSamples(instr);
+
+	xm_ins_hdr_t ih;
+	memset(&ih, 0, sizeof(ih));
+
+	/* Instrument name */
+	int32_t nameLen = (int32_t)strlen(rep->song.instrName[insNum]);
+	if (nameLen > 22) nameLen = 22;
+	memset(ih.name, 0, 22);
+	if (nameLen > 0) memcpy(ih.name, rep->song.instrName[insNum], nameLen);
+
+	ih.type = 0;
+	ih.numSamples = numSamples;
+	ih.sampleSize = sizeof(xm_smp_hdr_t);
+
+	if (numSamples == 0) {
+		/* Empty instrument: minimal header */
+		ih.instrSize = 22 + 11;
+		streamBytes(st, &ih, ih.instrSize);
+		return;
 	}
 
-	free(packedPattData);
+	/* Copy instrument parameters */
+	memcpy(ih.note2SampleLUT, instr->note2SampleLUT, 96);
+	memcpy(ih.volEnvPoints, instr->volEnvPoints, sizeof(ih.volEnvPoints));
+	memcpy(ih.panEnvPoints, instr->panEnvPoints, sizeof(ih.panEnvPoints));
+	ih.volEnvLength = instr->volEnvLength;
+	ih.panEnvLength = instr->panEnvLength;
+	ih.volEnvSustain = instr->volEnvSustain;
+	ih.volEnvLoopStart = instr->volEnvLoopStart;
+	ih.volEnvLoopEnd = instr->volEnvLoopEnd;
+	ih.panEnvSustain = instr->panEnvSustain;
+	ih.panEnvLoopStart = instr->panEnvLoopStart;
+	ih.panEnvLoopEnd = instr->panEnvLoopEnd;
+	ih.volEnvFlags = instr->volEnvFlags;
+	ih.panEnvFlags = instr->panEnvFlags;
+	ih.vibType = instr->autoVibType;
+	ih.vibSweep = instr->autoVibSweep;
+	ih.vibDepth = instr->autoVibDepth;
+	ih.vibRate = instr->autoVibRate;
+	ih.fadeout = instr->fadeout;
+	ih.midiOn = instr->midiOn ? 1 : 0;
+	ih.midiChannel = instr->midiChannel;
+	ih.midiProgram = instr->midiProgram;
+	ih.midiBend = instr->midiBend;
+	ih.mute = instr->mute ? 1 : 0;
+	ih.instrSize = XM_INSTR_HEADER_SIZE;
+
+	/* Build sample headers */
+	for (int32_t s = 0; s < numSamples; s++) {
+		ft2_sample_t *smp = &instr->smp[s];
+		xm_smp_hdr_t *dst = &ih.smp[s];
 
-	/* ===== INSTRUMENTS ===== */
-	for (int32_t i = 1; i <= numInstruments; i++)
-	{
-		ft2_instr_t *instr = rep->instr[i];
-		int16_t numSamples = (instr != NULL) ? countUsedSamples(instr) : 0;
+		bool sample16Bit = !!(smp->flags & FT2_SAMPLE_16BIT);
+
+		dst->length = smp->length;
+		dst->loopStart = smp->loopStart;
+		dst->loopLength = smp->loopLength;
+
+		if (sample16Bit) {
+			dst->length *= 2;
+			dst->loopStart *= 2;
+			dst->loopLength *= 2;
+		}
 
-		xm_ins_hdr_t ih;
-		memset(&ih, 0, sizeof(ih));
+		dst->volume = smp->volume;
+		dst->finetune = smp->finetune;
+		dst->flags = smp->flags;
+		dst->panning = smp->panning;
+		dst->relativeNote = smp->relativeNote;
 
-		/* Instrument name */
-		nameLen = (int32_t)strlen(rep->song.instrName[i]);
+		nameLen = (int32_t)strlen(smp->name);
 		if (nameLen > 22) nameLen = 22;
-		memset(ih.name, 0, 22);
-		if (nameLen > 0) memcpy(ih.name, rep->song.instrName[i], nameLen);
+		dst->nameLength = (uint8_t)nameLen;
+		memset(dst->name, ' ', 22);
+		if (nameLen > 0) memcpy(dst->name, smp->name, nameLen);
 
-		ih.type = 0;
-		ih.numSamples = numSamples;
-		ih.sampleSize = sizeof(xm_smp_hdr_t);
+		if (smp->dataPtr == NULL)
+			dst->length = 0;
+	}
 
-		if (numSamples > 0)
-		{
-			/* Copy instrument parameters */
-			memcpy(ih.note2SampleLUT, instr->note2SampleLUT, 96);
-			memcpy(ih.volEnvPoints, instr->volEnvPoints, sizeof(ih.volEnvPoints));
-			memcpy(ih.panEnvPoints, instr->panEnvPoints, sizeof(ih.panEnvPoints));
-			ih.volEnvLength = instr->volEnvLength;
-			ih.panEnvLength = instr->panEnvLength;
-			ih.volEnvSustain = instr->volEnvSustain;
-			ih.volEnvLoopStart = instr->volEnvLoopStart;
-			ih.volEnvLoopEnd = instr->volEnvLoopEnd;
-			ih.panEnvSustain = instr->panEnvSustain;
-			ih.panEnvLoopStart = instr->panEnvLoopStart;
-			ih.panEnvLoopEnd = instr->panEnvLoopEnd;
-			ih.volEnvFlags = instr->volEnvFlags;
-			ih.panEnvFlags = instr->panEnvFlags;
-			ih.vibType = instr->autoVibType;
-			ih.vibSweep = instr->autoVibSweep;
-			ih.vibDepth = instr->autoVibDepth;
-			ih.vibRate = instr->autoVibRate;
-			ih.fadeout = instr->fadeout;
-			ih.midiOn = instr->midiOn ? 1 : 0;
-			ih.midiChannel = instr->midiChannel;
-			ih.midiProgram = instr->midiProgram;
-			ih.midiBend = instr->midiBend;
-			ih.mute = instr->mute ? 1 : 0;
-			ih.instrSize = XM_INSTR_HEADER_SIZE;
-
-			/* Build sample headers */
-			for (int32_t s = 0; s < numSamples; s++)
-			{
-				ft2_sample_t *smp = &instr->smp[s];
-				xm_smp_hdr_t *dst = &ih.smp[s];
+	/* Instrument header + sample headers, then the sample data (delta-encoded) */
+	streamBytes(st, &ih, XM_INSTR_HEADER_SIZE + (numSamples * sizeof(xm_smp_hdr_t)));
 
-				bool sample16Bit = !!(smp->flags & FT2_SAMPLE_16BIT);
+	for (int32_t s = 0; s < numSamples; s++) {
+		const ft2_sample_t *smp = &instr->smp[s];
+		if (smp->dataPtr != NULL && smp->length > 0)
+			streamSample(st, smp);
+	}
+}
 
-				dst->length = smp->length;
-				dst->loopStart = smp->loopStart;
-				dst->loopLength = smp->loopLength;
+bool ft2_save_module_stream(ft2_instance_t *inst, ft2_save_write_t write, void *userData, uint32_t *outSize)
+{
+	if (inst == NULL || write == NULL)
+		return false;
 
-				if (sample16Bit)
-				{
-					dst->length *= 2;
-					dst->loopStart *= 2;
-					dst->loopLength *= 2;
-				}
+	ft2_replayer_state_t *rep = &inst->replayer;
 
-				dst->volume = smp->volume;
-				dst->finetune = smp->finetune;
-				dst->flags = smp->flags;
-				dst->panning = smp->panning;
-				dst->relativeNote = smp->relativeNote;
+	int32_t numPatterns, numInstruments;
+	countSavedItems(inst, &numPatterns, &numInstruments);
 
-				nameLen = (int32_t)strlen(smp->name);
-				if (nameLen > 22) nameLen = 22;
-				dst->nameLength = (uint8_t)nameLen;
-				memset(dst->name, ' ', 22);
-				if (nameLen > 0) memcpy(dst->name, smp->name, nameLen);
+	/* Free empty patterns and reset to 64 rows (matches standalone) */
+	for (int32_t i = 0; i < numPatterns; i++) {
+		if (patternEmpty(inst, (uint16_t)i)) {
+			ft2_pattern_free(inst, (uint16_t)i);
+			rep->patternNumRows[i] = 64;
+		}
+	}
 
-				if (smp->dataPtr == NULL)
-					dst->length = 0;
-			}
+	xmStream_t *st = (xmStream_t *)malloc(sizeof(xmStream_t));
+	uint8_t *chunk = (uint8_t *)malloc(FT2_SAVE_CHUNK_SIZE);
+	if (st == NULL || chunk == NULL) {
+		free(st);
+		free(chunk);
+		return false;
+	}
 
-			/* Write instrument header + sample headers */
-			memcpy(p, &ih, XM_INSTR_HEADER_SIZE + (numSamples * sizeof(xm_smp_hdr_t)));
-			p += XM_INSTR_HEADER_SIZE + (numSamples * sizeof(xm_smp_hdr_t));
+	st->write = write;
+	st->userData = userData;
+	st->chunk = chunk;
+	st->used = st->written = st->pieceBytes = 0;
+	st->numPieces = 0;
+	st->failed = false;
+
+	streamHeader(st, inst, numPatterns, numInstruments);
+	for (int32_t i = 0; i < numPatterns && !st->failed; i++)
+		streamPattern(st, inst, i);
+	for (int32_t i = 1; i <= numInstruments && !st->failed; i++)
+		streamInstrument(st, inst, i);
+	streamFlush(st);
+
+	const bool ok = !st->failed;
+	if (outSize != NULL)
+		*outSize = st->written;
+
+	free(chunk);
+	free(st);
+	return ok;
+}
 
-			/* Write sample data (delta-encoded) */
-			for (int32_t s = 0; s < numSamples; s++)
-			{
-				ft2_sample_t *smp = &instr->smp[s];
-				if (smp->dataPtr != NULL && smp->length > 0)
-				{
-					int32_t smpBytes = smp->length;
-					if (smp->flags & FT2_SAMPLE_16BIT)
-						smpBytes *= 2;
+typedef struct memSink_t {
+	uint8_t *data;
+	uint32_t size, pos;
+} memSink_t;
 
-					/* Unfix, delta encode, copy, undo */
-					ft2_unfix_sample(smp);
-					sample_to_delta(smp->dataPtr, smp->length, smp->flags);
+static bool memSinkWrite(void *userData, const uint8_t *data, uint32_t size)
+{
+	memSink_t *sink = (memSink_t *)userData;
+	if (size > sink->size - sink->pos)
+		return false;
 
-					memcpy(p, smp->dataPtr, smpBytes);
-					p += smpBytes;
+	memcpy(sink->data + sink->pos, data, size);
+	sink->pos += size;
+	return true;
+}
 
-					/* Restore sample for playback */
-					delta_to_sample(smp->dataPtr, smp->length, smp->flags);
-					ft2_fix_sample(smp);
-				}
-			}
-		}
-		else
-		{
-			/* Empty instrument: minimal header */
-			ih.instrSize = 22 + 11;
-			memcpy(p, &ih, ih.instrSize);
-			p += ih.instrSize;
-		}
+bool ft2_save_module(ft2_instance_t *inst, uint8_t **outData, uint32_t *outSize)
+{
+	if (inst == NULL || outData == NULL || outSize == NULL)
+		return false;
+
+	const uint32_t size = ft2_save_module_size(inst);
+	if (size == 0)
+		return false;
+
+	memSink_t sink = { (uint8_t *)malloc(size), size, 0 };
+	if (sink.data == NULL)
+		return false;
+
+	uint32_t written = 0;
+	if (!ft2_save_module_stream(inst, memSinkWrite, &sink, &written) || written != size) {
+		free(sink.data);
+		return false;
 	}
 
-	*outSize = (uint32_t)(p - *outData);
+	*outData = sink.data;
+	*outSize = size;
 	return true;
 }
 
@@ -1363,7 +1577,8 @@ bool ft2_load_instrument(ft2_instance_t *inst, int16_t instrNum,
 	if (hdr.numSamples < 0 || hdr.numSamples > 16)
 		return false;
 
-	/* Free existing instrument */
+	/* Free existing instrument (and its undo history) */
+	forgetInstrUndo(inst, instrNum);
 	ft2_instance_free_instr(inst, instrNum);
 
 	/* Copy instrument name */
@@ -1675,22 +1890,7 @@ bool ft2_save_instrument(ft2_instance_t *inst, int16_t instrNum,
 	{
 		ft2_sample_t *smp = &instr->smp[i];
 		if (smp->dataPtr != NULL && smp->length > 0)
-		{
-			int32_t smpBytes = smp->length;
-			if (smp->flags & FT2_SAMPLE_16BIT)
-				smpBytes *= 2;
-
-			/* Unfix, delta encode, copy, restore */
-			ft2_unfix_sample(smp);
-			sample_to_delta(smp->dataPtr, smp->length, smp->flags);
-
-			memcpy(p, smp->dataPtr, smpBytes);
-			p += smpBytes;
-
-			/* Restore sample for playback */
-			delta_to_sample(smp->dataPtr, smp->length, smp->flags);
-			ft2_fix_sample(smp);
-		}
+			p += write_delta_sample(p, smp);
 	}
 
 	*outSize = (uint32_t)(p - *outData);
@@ -1721,13 +1921,14 @@ bool ft2_load_sample(ft2_instance_t *inst, int16_t instrNum, int16_t sampleNum,
 	ft2_instr_t *instr = inst->replayer.instr[instrNum];
 	ft2_sample_t *smp = &instr->smp[sampleNum];
 
-	/* Stop voices playing this sample before modifying */
-	ft2_stop_sample_voices(inst, smp);
+	/* Voices keep playing the old data until the change is published */
+	ft2_sample_edit_begin(inst, smp);
+	forgetSampleUndo(inst, instrNum, sampleNum);
 
 	/* Free existing sample data */
 	if (smp->origDataPtr != NULL)
 	{
-		free(smp->origDataPtr);
+		ft2_sample_pool_release(smp->origDataPtr);
 		smp->origDataPtr = NULL;
 		smp->dataPtr = NULL;
 	}
@@ -1934,23 +2135,25 @@ bool ft2_load_pattern(ft2_instance_t *inst, int16_t pattNum,
 	uint32_t expectedSize = sizeof(xp_header_t) + (hdr.numRows * XP_TRACK_WIDTH);
 	if (dataSize < expectedSize) return false;
 
-	if (inst->replayer.pattern[pattNum] == NULL)
-		if (!allocatePattern(inst, pattNum)) return false;
+	if (!allocatePattern(inst, pattNum)) return false;
+	if (!ft2_pattern_set_num_rows(inst, pattNum, hdr.numRows)) return false;
 
-	ft2_note_t *patt = inst->replayer.pattern[pattNum];
-	memcpy(patt, data + sizeof(xp_header_t), hdr.numRows * XP_TRACK_WIDTH);
+	/* XP rows are always 32 channels wide; keep the ones the pattern stores */
+	const int32_t stride = inst->replayer.patternStride;
+	const uint8_t *src = data + sizeof(xp_header_t);
+	for (int32_t row = 0; row < hdr.numRows; row++, src += XP_TRACK_WIDTH) {
+		ft2_note_t *p = ft2_pattern_row(inst, pattNum, row);
+		memcpy(p, src, stride * sizeof(ft2_note_t));
 
-	/* Sanitize: clamp note/instr/effect values */
-	for (int32_t row = 0; row < hdr.numRows; row++) {
-		for (int32_t ch = 0; ch < FT2_MAX_CHANNELS; ch++) {
-			ft2_note_t *note = &patt[(row * FT2_MAX_CHANNELS) + ch];
+		/* Sanitize: clamp note/instr/effect values */
+		for (int32_t ch = 0; ch < stride; ch++) {
+			ft2_note_t *note = &p[ch];
 			if (note->note > 97) note->note = 0;
 			if (note->instr > 128) note->instr = 128;
 			if (note->efx > 35) { note->efx = 0; note->efxData = 0; }
 		}
 	}
 
-	inst->replayer.patternNumRows[pattNum] = hdr.numRows;
 	if (inst->replayer.song.pattNum == pattNum)
 		inst->replayer.song.currNumRows = hdr.numRows;
 
@@ -1963,19 +2166,22 @@ bool ft2_save_pattern(ft2_instance_t *inst, int16_t pattNum,
 	if (inst == NULL || outData == NULL || outSize == NULL) return false;
 	if (pattNum < 0 || pattNum >= FT2_MAX_PATTERNS) return false;
 
-	ft2_note_t *patt = inst->replayer.pattern[pattNum];
-	if (patt == NULL) return false;
+	if (inst->replayer.pattern[pattNum] == NULL) return false;
 
 	int16_t numRows = inst->replayer.patternNumRows[pattNum];
 	if (numRows < 1) numRows = 64;
 
 	uint32_t totalSize = sizeof(xp_header_t) + (numRows * XP_TRACK_WIDTH);
-	*outData = (uint8_t *)malloc(totalSize);
+	*outData = (uint8_t *)calloc(totalSize, 1);
 	if (*outData == NULL) return false;
 
 	xp_header_t hdr = { .version = 1, .numRows = numRows };
 	memcpy(*outData, &hdr, sizeof(hdr));
-	memcpy(*outData + sizeof(hdr), patt, numRows * XP_TRACK_WIDTH);
+
+	/* XP rows are always 32 channels wide, unstored channels are left empty */
+	uint8_t *dst = *outData + sizeof(hdr);
+	for (int32_t row = 0; row < numRows; row++, dst += XP_TRACK_WIDTH)
+		memcpy(dst, ft2_pattern_row(inst, pattNum, row), inst->replayer.patternStride * sizeof(ft2_note_t));
 	*outSize = totalSize;
 	return true;
 }
@@ -2139,7 +2345,7 @@ static void unsavedChangesDropCallback(ft2_instance_t *inst, ft2_dialog_result_t
 	(void)inputText;
 	(void)userData;
 	if (result == DIALOG_RESULT_YES) {
-		inst->diskop.requestDropLoad = true;
+		inst->diskop->requestDropLoad = true;
 		inst->uiState.needsFullRedraw = true;
 	}
 }
@@ -2149,8 +2355,8 @@ void ft2_diskop_request_drop_load(ft2_instance_t *inst, const char *path)
 {
 	if (inst == NULL || path == NULL) return;
 
-	strncpy(inst->diskop.pendingDropPath, path, FT2_PATH_MAX - 1);
-	inst->diskop.pendingDropPath[FT2_PATH_MAX - 1] = '\0';
+	strncpy(inst->diskop->pendingDropPath, path, FT2_PATH_MAX - 1);
+	inst->diskop->pendingDropPath[FT2_PATH_MAX - 1] = '\0';
 
 	if (inst->replayer.song.isModified) {
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
@@ -2159,6 +2365,6 @@ void ft2_diskop_request_drop_load(ft2_instance_t *inst, const char *path)
 				"You have unsaved changes in your song. Load new song and lose ALL changes?",
 				inst, unsavedChangesDropCallback, NULL);
 	} else {
-		inst->diskop.requestDropLoad = true;
+		inst->diskop->requestDropLoad = true;
 	}
 }
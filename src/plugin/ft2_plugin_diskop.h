@@ -100,6 +100,19 @@ ft2_file_format ft2_detect_format_by_header(const uint8_t *data, uint32_t dataSi
 /* Module save (load in ft2_plugin_loader.h) */
 bool ft2_save_module(ft2_instance_t *inst, uint8_t **outData, uint32_t *outSize);
 
+/* Streaming module save: the XM file is handed to write() in consecutive
+ * pieces of at most FT2_SAVE_CHUNK_SIZE bytes, so only one chunk is held
+ * at a time; returning false aborts the save. Sample data is delta-encoded
+ * on the worker pool. Writes the same bytes as ft2_save_module(). */
+#define FT2_SAVE_CHUNK_SIZE (1024 * 1024)
+
+typedef bool (*ft2_save_write_t)(void *userData, const uint8_t *data, uint32_t size);
+
+bool ft2_save_module_stream(ft2_instance_t *inst, ft2_save_write_t write, void *userData, uint32_t *outSize);
+
+/* Exact size of the file a save would write now (0 if over 4 GiB) */
+uint32_t ft2_save_module_size(ft2_instance_t *inst);
+
 /* Instrument load/save (XI format) */
 bool ft2_load_instrument(ft2_instance_t *inst, int16_t instrNum,
                           const uint8_t *data, uint32_t dataSize);
@@ -20,6 +20,9 @@
 #include "ft2_plugin_sample_ed.h"
 #include "ft2_plugin_replayer.h"
 #include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_sample_job.h"
+#include "ft2_plugin_smpfx.h"
 #include "../ft2_instance.h"
 
 #define MAX_SAMPLE_LEN 0x3FFFFFFF
@@ -186,6 +189,206 @@ static void drawFrame(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	if (state->echoAddMemory) charOut(video, bmp, 178, 270, PAL_FORGRND, 'x');
 }
 
+/* ------------------------------------------------------------------------- */
+/*                              ECHO RENDERING                               */
+/* ------------------------------------------------------------------------- */
+
+/* The echo is a truncated geometric series over taps d apart:
+ *
+ *   y[n] = x[n] + v*x[n-d] + ... + v^(K-1)*x[n-(K-1)d]
+ *        = x[n] + v*y[n-d] - v^K*x[n-Kd]
+ *
+ * so each output costs the same whatever the number of echoes. The
+ * recursion only reaches back d samples, which makes every d-long stretch
+ * a plain element-wise loop. */
+
+#define ECHO_CHUNK_LEN 16384 /* Samples converted per pass (at least d) */
+#define ECHO_TRUNC_SLACK 1e-6 /* Of an LSB: where the sum is a whole number, the recursion may land just short of it */
+
+/* Reads src[pos..pos+count) as doubles, zero outside the sample */
+static void loadEchoBlock(const int8_t *src, int32_t srcLen, bool sample16Bit, int64_t pos, int32_t count, double *dst)
+{
+	int64_t lo = (pos < 0) ? -pos : 0;
+	int64_t hi = (int64_t)srcLen - pos;
+	if (lo > count) lo = count;
+	if (hi > count) hi = count;
+	if (hi < lo) hi = lo;
+
+	for (int32_t i = 0; i < (int32_t)lo; i++) dst[i] = 0.0;
+	if (sample16Bit)
+	{
+		const int16_t *src16 = (const int16_t *)src + pos;
+		for (int32_t i = (int32_t)lo; i < (int32_t)hi; i++) dst[i] = (double)src16[i];
+	}
+	else
+	{
+		const int8_t *src8 = src + pos;
+		for (int32_t i = (int32_t)lo; i < (int32_t)hi; i++) dst[i] = (double)src8[i];
+	}
+	for (int32_t i = (int32_t)hi; i < count; i++) dst[i] = 0.0;
+}
+
+/* Truncates towards zero and clamps, like the original per-sample loop */
+static void storeEchoBlock(const double *src, int32_t count, bool sample16Bit, int8_t *dst)
+{
+	if (sample16Bit)
+	{
+		int16_t *dst16 = (int16_t *)dst;
+		for (int32_t i = 0; i < count; i++)
+		{
+			double dSmp = src[i] + ((src[i] < 0.0) ? -ECHO_TRUNC_SLACK : ECHO_TRUNC_SLACK);
+			if (dSmp < -32768.0) dSmp = -32768.0;
+			if (dSmp > 32767.0) dSmp = 32767.0;
+			dst16[i] = (int16_t)dSmp;
+		}
+	}
+	else
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			double dSmp = src[i] + ((src[i] < 0.0) ? -ECHO_TRUNC_SLACK : ECHO_TRUNC_SLACK);
+			if (dSmp < -128.0) dSmp = -128.0;
+			if (dSmp > 127.0) dSmp = 127.0;
+			dst[i] = (int8_t)dSmp;
+		}
+	}
+}
+
+/* One stretch of at most d samples: out and prev are d apart, so the
+ * iterations are independent */
+static void echoStep(double *out, const double *prev, const double *in, const double *expired,
+	int32_t count, double volChange, double lastGain)
+{
+	for (int32_t i = 0; i < count; i++)
+		out[i] = in[i] + (volChange * prev[i]) - (lastGain * expired[i]);
+}
+
+bool ft2_echo_render(const int8_t *src, int32_t srcLen, int8_t *dst, int32_t dstLen, bool sample16Bit,
+	int32_t distance, double volChange, int32_t numTaps, ft2_sample_job_t *job)
+{
+	if (src == NULL || dst == NULL || srcLen < 0 || dstLen < 1 || numTaps < 1) return false;
+
+	const int32_t bytesPerSample = sample16Bit ? 2 : 1;
+	const int32_t d = (distance > 0) ? distance : 0;
+	const int32_t chunkLen = (d > ECHO_CHUNK_LEN) ? d : ECHO_CHUNK_LEN;
+
+	/* hist holds the last d outputs followed by the chunk being made */
+	double *hist = (double *)calloc((size_t)d + chunkLen, sizeof(double));
+	double *in = (double *)malloc((size_t)chunkLen * sizeof(double));
+	double *expired = (double *)malloc((size_t)chunkLen * sizeof(double));
+	if (hist == NULL || in == NULL || expired == NULL)
+	{
+		free(hist); free(in); free(expired);
+		return false;
+	}
+
+	/* Same products as the taps loop builds up */
+	double gain = 0.0, lastGain = 1.0;
+	for (int32_t k = 0; k < numTaps; k++)
+	{
+		gain += lastGain;
+		lastGain *= volChange;
+	}
+
+	bool completed = true;
+	for (int64_t pos = 0; pos < dstLen; pos += chunkLen)
+	{
+		const int32_t count = (int32_t)((dstLen - pos < chunkLen) ? dstLen - pos : chunkLen);
+		double *out = hist + d;
+
+		loadEchoBlock(src, srcLen, sample16Bit, pos, count, in);
+		if (d == 0)
+		{
+			/* Every tap lands on the same sample */
+			for (int32_t i = 0; i < count; i++) out[i] = in[i] * gain;
+		}
+		else
+		{
+			loadEchoBlock(src, srcLen, sample16Bit, pos - (int64_t)numTaps * d, count, expired);
+			for (int32_t i = 0; i < count; i += d)
+			{
+				const int32_t n = (count - i < d) ? count - i : d;
+				echoStep(out + i, hist + i, in + i, expired + i, n, volChange, lastGain);
+			}
+		}
+
+		storeEchoBlock(out, count, sample16Bit, dst + pos * bytesPerSample);
+
+		/* Keep the last d outputs for the next chunk */
+		if (d > 0) memmove(hist, hist + count, (size_t)d * sizeof(double));
+
+		if (job != NULL && !ft2_sample_job_report(job, (uint64_t)(pos + count), (uint64_t)dstLen))
+		{
+			completed = false;
+			break;
+		}
+	}
+
+	free(hist);
+	free(in);
+	free(expired);
+	return completed;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              BACKGROUND JOB                               */
+/* ------------------------------------------------------------------------- */
+
+typedef struct echo_job_t
+{
+	ft2_sample_job_source_t src;
+	int8_t *newOrigPtr, *newData;
+	int32_t readLen, writeLen, distance, nEchoes;
+	double volChange;
+	bool sample16Bit;
+} echo_job_t;
+
+static void freeEchoJob(echo_job_t *ej)
+{
+	if (!ej) return;
+	ft2_sample_job_free_source(&ej->src);
+	free(ej->newOrigPtr);
+	free(ej);
+}
+
+static bool echoJobRun(ft2_sample_job_t *job, void *userData)
+{
+	echo_job_t *ej = (echo_job_t *)userData;
+	return ft2_echo_render(ej->src.data, ej->readLen, ej->newData, ej->writeLen, ej->sample16Bit,
+		ej->distance, ej->volChange, ej->nEchoes, job);
+}
+
+static void echoJobDone(ft2_instance_t *inst, void *userData, bool completed)
+{
+	echo_job_t *ej = (echo_job_t *)userData;
+
+	/* Only if the sample is still the one the echo was made from */
+	ft2_sample_t *s = (completed && inst && inst->ui) ? getCurrentSample(inst) : NULL;
+	if (!ft2_sample_job_source_is_current(&ej->src, s))
+	{
+		freeEchoJob(ej);
+		return;
+	}
+
+	fillSampleUndo(inst, false);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s))
+	{
+		freeEchoJob(ej);
+		return;
+	}
+
+	if (s->origDataPtr) ft2_sample_pool_release(s->origDataPtr);
+	s->origDataPtr = ej->newOrigPtr;
+	s->dataPtr = ej->newData;
+	s->length = ej->writeLen;
+	ej->newOrigPtr = NULL;
+
+	ft2_fix_sample(s);
+	inst->uiState.updateSampleEditor = true;
+	freeEchoJob(ej);
+}
+
 static void applyEchoToSample(ft2_instance_t *inst)
 {
 	if (!inst || !inst->ui) return;
@@ -196,7 +399,6 @@ static void applyEchoToSample(ft2_instance_t *inst)
 	if (!s || !s->dataPtr || s->length == 0) return;
 
 	int32_t readLen = s->length;
-	int8_t *readPtr = s->dataPtr;
 	bool sample16Bit = (s->flags & FT2_SAMPLE_16BIT) != 0;
 	int32_t distance = state->echoDistance * 16;
 	double dVolChange = state->echoVolChange / 100.0;
@@ -219,68 +421,26 @@ static void applyEchoToSample(ft2_instance_t *inst)
 	int32_t rightPadding = FT2_MAX_TAPS * bytesPerSample;
 	size_t allocSize = (size_t)(leftPadding + writeLen * bytesPerSample + rightPadding);
 
-	int8_t *newOrigPtr = (int8_t *)calloc(allocSize, 1);
-	if (!newOrigPtr) return;
-	int8_t *newData = newOrigPtr + leftPadding;
+	echo_job_t *ej = (echo_job_t *)calloc(1, sizeof(echo_job_t));
+	if (!ej) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
-	
-	int32_t writeIdx = 0;
-	
-	if (sample16Bit)
-	{
-		const int16_t *readPtr16 = (const int16_t *)readPtr;
-		int16_t *writePtr16 = (int16_t *)newData;
-		
-		while (writeIdx < writeLen)
-		{
-			double dSmpOut = 0.0, dSmpMul = 1.0;
-			int32_t echoRead = writeIdx, echoCycle = nEchoes;
-			
-			while (echoCycle > 0) {
-				if (echoRead >= 0 && echoRead < readLen) dSmpOut += (double)readPtr16[echoRead] * dSmpMul;
-				dSmpMul *= dVolChange; echoRead -= distance;
-				if (echoRead < 0) break;
-				echoCycle--;
-			}
-			
-			int32_t smp32 = (int32_t)dSmpOut;
-			if (smp32 < -32768) smp32 = -32768;
-			if (smp32 > 32767) smp32 = 32767;
-			writePtr16[writeIdx++] = (int16_t)smp32;
-		}
-	}
-	else
+	ej->readLen = readLen;
+	ej->writeLen = writeLen;
+	ej->distance = distance;
+	ej->nEchoes = nEchoes;
+	ej->volChange = dVolChange;
+	ej->sample16Bit = sample16Bit;
+
+	ej->newOrigPtr = (int8_t *)calloc(allocSize, 1);
+	if (!ej->newOrigPtr || !ft2_sample_job_copy_source(&ej->src, s))
 	{
-		int8_t *writePtr8 = newData;
-		
-		while (writeIdx < writeLen)
-		{
-			double dSmpOut = 0.0, dSmpMul = 1.0;
-			int32_t echoRead = writeIdx, echoCycle = nEchoes;
-			
-			while (echoCycle > 0) {
-				if (echoRead >= 0 && echoRead < readLen) dSmpOut += (double)readPtr[echoRead] * dSmpMul;
-				dSmpMul *= dVolChange; echoRead -= distance;
-				if (echoRead < 0) break;
-				echoCycle--;
-			}
-			
-			int32_t smp32 = (int32_t)dSmpOut;
-			if (smp32 < -128) smp32 = -128;
-			if (smp32 > 127) smp32 = 127;
-			writePtr8[writeIdx++] = (int8_t)smp32;
-		}
+		freeEchoJob(ej);
+		return;
 	}
-	
-	if (s->origDataPtr) free(s->origDataPtr);
-	s->origDataPtr = newOrigPtr;
-	s->dataPtr = newData;
-	s->length = writeLen;
+	ej->newData = ej->newOrigPtr + leftPadding;
 
-	ft2_fix_sample(s);
-	inst->uiState.updateSampleEditor = true;
+	if (!ft2_sample_job_start(&FT2_UI(inst)->sampleJob, inst, "Creating echo...", echoJobRun, echoJobDone, ej))
+		freeEchoJob(ej);
 }
 
 void ft2_echo_panel_show(ft2_instance_t *inst)
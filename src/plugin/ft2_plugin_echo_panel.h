@@ -17,6 +17,7 @@ extern "C" {
 struct ft2_instance_t;
 struct ft2_video_t;
 struct ft2_bmp_t;
+struct ft2_sample_job_t;
 
 void ft2_echo_panel_show(struct ft2_instance_t *inst);
 void ft2_echo_panel_hide(struct ft2_instance_t *inst);
@@ -25,6 +26,14 @@ void ft2_echo_panel_draw(struct ft2_instance_t *inst, struct ft2_video_t *video,
 void ft2_echo_panel_apply(struct ft2_instance_t *inst);
 bool ft2_echo_panel_mouse_down(struct ft2_instance_t *inst, int32_t x, int32_t y, int button);
 
+/* Echo of src into dst (dstLen samples, src is silent past srcLen):
+ * dst[n] = sum of volChange^k * src[n - k*distance] for k < numTaps,
+ * truncated and clamped. Time is linear in dstLen whatever numTaps is.
+ * Reports progress to job if given; returns false if it was cancelled
+ * (or out of memory). */
+bool ft2_echo_render(const int8_t *src, int32_t srcLen, int8_t *dst, int32_t dstLen, bool sample16Bit,
+	int32_t distance, double volChange, int32_t numTaps, struct ft2_sample_job_t *job);
+
 #ifdef __cplusplus
 }
 #endif
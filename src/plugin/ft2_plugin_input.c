@@ -482,6 +482,15 @@ static bool handleModifiedKeys(ft2_instance_t *inst, int keyCode, int modifiers)
 			case 'v': case 'V': ft2_sample_ed_paste(inst); return true;
 			default: break;
 		}
+
+		/* Undo/redo, on the effects screen where the Undo button is */
+		if (inst->uiState.sampleEditorEffectsShown) {
+			switch (keyCode) {
+				case 'z': case 'Z': pbSfxUndo(inst); return true;
+				case 'y': case 'Y': pbSfxRedo(inst); return true;
+				default: break;
+			}
+		}
 	}
 
 	/* Pattern editor clipboard ops with combined modifiers */
@@ -709,6 +718,7 @@ static void handlePatternInsertDelete(ft2_instance_t *inst, int keyCode, int mod
 
 	uint16_t numRows = inst->replayer.patternNumRows[patt];
 	uint16_t numCh = inst->replayer.song.numChannels;
+	const int32_t stride = inst->replayer.patternStride;
 	ft2_note_t *pattern = inst->replayer.pattern[patt];
 	int16_t curRow = inst->replayer.song.row;
 	if (curRow < 0) curRow = 0;
@@ -720,14 +730,14 @@ static void handlePatternInsertDelete(ft2_instance_t *inst, int keyCode, int mod
 					/* Insert line - all channels */
 					for (int16_t row = numRows - 2; row >= curRow; row--)
 						for (uint8_t ch = 0; ch < numCh; ch++)
-							pattern[(row + 1) * numCh + ch] = pattern[row * numCh + ch];
+							pattern[(row + 1) * stride + ch] = pattern[row * stride + ch];
 					for (uint8_t ch = 0; ch < numCh; ch++)
-						memset(&pattern[curRow * numCh + ch], 0, sizeof(ft2_note_t));
+						memset(&pattern[curRow * stride + ch], 0, sizeof(ft2_note_t));
 				} else {
 					/* Insert note - current channel */
 					for (int16_t row = numRows - 2; row >= curRow; row--)
-						pattern[(row + 1) * numCh + inst->cursor.ch] = pattern[row * numCh + inst->cursor.ch];
-					memset(&pattern[curRow * numCh + inst->cursor.ch], 0, sizeof(ft2_note_t));
+						pattern[(row + 1) * stride + inst->cursor.ch] = pattern[row * stride + inst->cursor.ch];
+					memset(&pattern[curRow * stride + inst->cursor.ch], 0, sizeof(ft2_note_t));
 				}
 				ft2_song_mark_modified(inst);
 				inst->uiState.updatePatternEditor = true;
@@ -743,13 +753,13 @@ static void handlePatternInsertDelete(ft2_instance_t *inst, int keyCode, int mod
 				if (modifiers & FT2_MOD_SHIFT) {
 					for (uint16_t row = curRow; row < numRows - 1; row++)
 						for (uint8_t ch = 0; ch < numCh; ch++)
-							pattern[row * numCh + ch] = pattern[(row + 1) * numCh + ch];
+							pattern[row * stride + ch] = pattern[(row + 1) * stride + ch];
 					for (uint8_t ch = 0; ch < numCh; ch++)
-						memset(&pattern[(numRows - 1) * numCh + ch], 0, sizeof(ft2_note_t));
+						memset(&pattern[(numRows - 1) * stride + ch], 0, sizeof(ft2_note_t));
 				} else {
 					for (uint16_t row = curRow; row < numRows - 1; row++)
-						pattern[row * numCh + inst->cursor.ch] = pattern[(row + 1) * numCh + inst->cursor.ch];
-					memset(&pattern[(numRows - 1) * numCh + inst->cursor.ch], 0, sizeof(ft2_note_t));
+						pattern[row * stride + inst->cursor.ch] = pattern[(row + 1) * stride + inst->cursor.ch];
+					memset(&pattern[(numRows - 1) * stride + inst->cursor.ch], 0, sizeof(ft2_note_t));
 				}
 				ft2_song_mark_modified(inst);
 				inst->uiState.updatePatternEditor = true;
@@ -758,7 +768,7 @@ static void handlePatternInsertDelete(ft2_instance_t *inst, int keyCode, int mod
 
 		case FT2_KEY_DELETE:
 			if (pattern != NULL) {
-				ft2_note_t *n = &pattern[curRow * numCh + inst->cursor.ch];
+				ft2_note_t *n = &pattern[curRow * stride + inst->cursor.ch];
 				if (modifiers & FT2_MOD_SHIFT)
 					memset(n, 0, sizeof(ft2_note_t));
 				else if (modifiers & FT2_MOD_CTRL)
@@ -916,7 +926,7 @@ int8_t ft2_plugin_record_note(ft2_instance_t *inst, ft2_input_state_t *input,
 			int16_t row = inst->replayer.song.row;
 		if (c < (int8_t)numChannels && row >= 0 && row < inst->replayer.patternNumRows[patt])
 			{
-			ft2_note_t *n = &inst->replayer.pattern[patt][row * FT2_MAX_CHANNELS + c];
+			ft2_note_t *n = &inst->replayer.pattern[patt][row * inst->replayer.patternStride + c];
 			n->note = noteNum;
 			if (inst->editor.curInstr > 0)
 				n->instr = inst->editor.curInstr;
@@ -1025,6 +1035,10 @@ int8_t ft2_plugin_record_note(ft2_instance_t *inst, ft2_input_state_t *input,
 				ft2_song_mark_modified(inst);
 				inst->uiState.updatePatternEditor = true;
 		}
+
+		/* MIDI records from inside a block: a copy the UI is making of the
+		 * patterns (ft2_pattern_swap_begin_built()) must be made again */
+		ft2_pattern_mark_written(inst);
 	}
 	
 	return c;
@@ -1052,15 +1066,16 @@ void ft2_plugin_record_note_off(ft2_instance_t *inst, ft2_input_state_t *input,
 		uint16_t numRows = inst->replayer.patternNumRows[patt];
 
 		if (row >= 0 && row < numRows) {
-			ft2_note_t *n = &inst->replayer.pattern[patt][row * FT2_MAX_CHANNELS + channel];
+			ft2_note_t *n = &inst->replayer.pattern[patt][row * inst->replayer.patternStride + channel];
 			if (n->note != 0) {
 				row = (row + 1) % numRows;
-				n = &inst->replayer.pattern[patt][row * FT2_MAX_CHANNELS + channel];
+				n = &inst->replayer.pattern[patt][row * inst->replayer.patternStride + channel];
 			}
 			n->note = FT2_KEY_NOTE_OFF;
 			ft2_song_mark_modified(inst);
 			inst->uiState.updatePatternEditor = true;
 		}
+		ft2_pattern_mark_written(inst);
 	}
 }
 
@@ -1102,7 +1117,7 @@ static void handleNoteInput(ft2_instance_t *inst, ft2_input_state_t *input, int
 
 			int16_t row = inst->replayer.song.row;
 			if (row >= 0 && row < inst->replayer.patternNumRows[patt]) {
-				ft2_note_t *n = &inst->replayer.pattern[patt][row * FT2_MAX_CHANNELS + c];
+				ft2_note_t *n = &inst->replayer.pattern[patt][row * inst->replayer.patternStride + c];
 				n->note = FT2_KEY_NOTE_OFF;
 				n->instr = 0;
 
@@ -1197,7 +1212,7 @@ static void handleEffectInput(ft2_instance_t *inst, ft2_input_state_t *input, in
 	if (ch >= numCh || row < 0 || row >= inst->replayer.patternNumRows[patt])
 		return;
 	
-	ft2_note_t *n = &inst->replayer.pattern[patt][row * FT2_MAX_CHANNELS + ch];
+	ft2_note_t *n = &inst->replayer.pattern[patt][row * inst->replayer.patternStride + ch];
 	
 	switch (inst->cursor.object) {
 		case CURSOR_NOTE: break;
@@ -1245,7 +1260,7 @@ void ft2_input_key_down(ft2_instance_t *inst, ft2_input_state_t *input, int keyC
 	if (inst == NULL) return;
 
 	/* Nibbles consumes all input when playing */
-	if (inst->uiState.nibblesShown && inst->nibbles.playing) {
+	if (inst->uiState.nibblesShown && inst->nibbles->playing) {
 		ft2_nibbles_handle_key(inst, keyCode);
 		return;
 	}
@@ -31,7 +31,7 @@ typedef struct sincKernel_t {
  * Kernel 1: medium quality (ratio <= 1.5x)
  * Kernel 2: low quality (ratio > 1.5x) */
 static const sincKernel_t sincKernelConfig[SINC_KERNELS] = {
-	{ 9.6377, 1.000 },
+	{ SINC_KAISER_BETA_HQ, 1.000 },
 	{ 8.5000, 0.750 },
 	{ 7.3000, 0.425 }
 };
@@ -96,18 +96,16 @@ static bool setupCubicSplineTable(void)
 }
 
 /* Generate windowed sinc kernel with Kaiser-Bessel window */
-static void makeSincKernel(float *fOut, int32_t numPoints, int32_t numPhases, double beta, double cutoff)
+void ft2_make_sinc_kernel(float *fOut, int32_t numPoints, int32_t numPhases, double beta, double cutoff)
 {
 	const int32_t kernelLen = numPhases * numPoints;
-	const int32_t pointBits = (int32_t)log2(numPoints);
-	const int32_t pointMask = numPoints - 1;
 	const int32_t centerPoint = (numPoints / 2) - 1;
 	const double besselI0Beta = 1.0 / besselI0(beta);
 	const double phaseMul = 1.0 / numPhases;
 	const double xMul = 1.0 / (numPoints / 2);
 
 	for (int32_t i = 0; i < kernelLen; i++) {
-		const double x = ((i & pointMask) - centerPoint) - ((i >> pointBits) * phaseMul);
+		const double x = ((i % numPoints) - centerPoint) - ((i / numPoints) * phaseMul);
 		const double n = x * xMul;
 		double windowArg = 1.0 - n * n;
 		if (windowArg < 0.0) windowArg = 0.0;
@@ -124,10 +122,10 @@ static bool setupWindowedSincTables(void)
 		g_interpTables.fSinc16[i] = (float *)malloc(16 * SINC_PHASES * sizeof(float));
 		if (g_interpTables.fSinc8[i] == NULL || g_interpTables.fSinc16[i] == NULL)
 			return false;
-		makeSincKernel(g_interpTables.fSinc8[i], 8, SINC_PHASES,
-		               sincKernelConfig[i].kaiserBeta, sincKernelConfig[i].sincCutoff);
-		makeSincKernel(g_interpTables.fSinc16[i], 16, SINC_PHASES,
-		               sincKernelConfig[i].kaiserBeta, sincKernelConfig[i].sincCutoff);
+		ft2_make_sinc_kernel(g_interpTables.fSinc8[i], 8, SINC_PHASES,
+		                     sincKernelConfig[i].kaiserBeta, sincKernelConfig[i].sincCutoff);
+		ft2_make_sinc_kernel(g_interpTables.fSinc16[i], 16, SINC_PHASES,
+		                     sincKernelConfig[i].kaiserBeta, sincKernelConfig[i].sincCutoff);
 	}
 	g_interpTables.sincRatio1 = (uint64_t)(1.1875 * PLUGIN_MIXER_FRAC_SCALE);
 	g_interpTables.sincRatio2 = (uint64_t)(1.5000 * PLUGIN_MIXER_FRAC_SCALE);
@@ -48,6 +48,7 @@ enum ft2_interpolation_mode {
 #define SINC_KERNELS     3
 #define SINC_PHASES      8192
 #define SINC_PHASES_BITS 13
+#define SINC_KAISER_BETA_HQ 9.6377 /* Kernel 0's window, about 96 dB stopband */
 
 #define SINC8_WIDTH_BITS  3
 #define SINC8_FRACSHIFT   (PLUGIN_MIXER_FRAC_BITS - (SINC_PHASES_BITS + SINC8_WIDTH_BITS))
@@ -74,6 +75,11 @@ bool ft2_interp_tables_init(void);
 void ft2_interp_tables_free(void);
 ft2_interp_tables_t *ft2_interp_tables_get(void);
 
+/* Kaiser-windowed sinc table: numPhases rows of numPoints taps (any even
+ * count). Row p is for a position p/numPhases of a sample past the center
+ * tap (numPoints/2 - 1). cutoff is relative to Nyquist. */
+void ft2_make_sinc_kernel(float *fOut, int32_t numPoints, int32_t numPhases, double beta, double cutoff);
+
 /* Select sinc kernel based on resampling ratio */
 const float *ft2_select_sinc_kernel(uint64_t delta, ft2_interp_tables_t *tables, bool *is16Point);
 
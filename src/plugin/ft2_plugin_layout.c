@@ -462,7 +462,7 @@ void drawTopScreen(struct ft2_instance_t *inst, struct ft2_video_t *video,
 		drawHelpScreen(inst, video, bmp);
 	} else if (inst->uiState.nibblesShown) {
 		ft2_nibbles_show(inst, video, bmp);
-		if (inst->nibbles.playing) ft2_nibbles_redraw(inst, video, bmp);
+		if (inst->nibbles->playing) ft2_nibbles_redraw(inst, video, bmp);
 		else if (inst->uiState.nibblesHelpShown) ft2_nibbles_show_help(inst, video, bmp);
 		else if (inst->uiState.nibblesHighScoresShown) ft2_nibbles_show_highscores(inst, video, bmp);
 	} else if (inst->uiState.diskOpShown) {
@@ -12,6 +12,7 @@
 #include <ctype.h>
 #include "ft2_plugin_load_mod.h"
 #include "ft2_plugin_mem_reader.h"
+#include "ft2_plugin_sample_decode.h"
 #include "ft2_plugin_sample_ed.h"
 #include "../ft2_instance.h"
 
@@ -177,6 +178,7 @@ bool load_mod_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 		if (song->numChannels > FT2_MAX_CHANNELS)
 			song->numChannels = FT2_MAX_CHANNELS;
 	}
+	ft2_pattern_set_stride(inst, song->numChannels); /* No patterns yet, can't fail */
 
 	song->songLength = hdr.numOrders;
 	song->songLoopStart = hdr.songLoopStart;
@@ -206,13 +208,12 @@ bool load_mod_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 	/* Load patterns */
 	if (modFormat != MOD_FORMAT_FLT8) {
 		for (uint16_t a = 0; a < numPatterns; a++) {
-			rep->pattern[a] = (ft2_note_t *)calloc(64 * FT2_MAX_CHANNELS, sizeof(ft2_note_t));
-			if (rep->pattern[a] == NULL) return false;
 			rep->patternNumRows[a] = 64;
+			if (!ft2_pattern_alloc(inst, a)) return false;
 
 			for (int j = 0; j < 64; j++) {
 				for (int k = 0; k < song->numChannels; k++) {
-					ft2_note_t *p = &rep->pattern[a][(j * FT2_MAX_CHANNELS) + k];
+					ft2_note_t *p = ft2_pattern_note(inst, a, j, k);
 					uint8_t bytes[4];
 					if (!mem_read(&reader, bytes, 4)) { memset(p, 0, sizeof(ft2_note_t)); continue; }
 
@@ -232,16 +233,15 @@ bool load_mod_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 	} else {
 		/* FLT8: 8ch patterns stored as pairs of 4ch patterns */
 		for (uint16_t a = 0; a < numPatterns; a++) {
-			rep->pattern[a] = (ft2_note_t *)calloc(64 * FT2_MAX_CHANNELS, sizeof(ft2_note_t));
-			if (rep->pattern[a] == NULL) return false;
 			rep->patternNumRows[a] = 64;
+			if (!ft2_pattern_alloc(inst, a)) return false;
 		}
 		for (uint16_t a = 0; a < numPatterns * 2; a++) {
 			int32_t pattNum = a >> 1;
 			int32_t chnOffset = (a & 1) * 4;
 			for (int j = 0; j < 64; j++) {
 				for (int k = 0; k < 4; k++) {
-					ft2_note_t *p = &rep->pattern[pattNum][(j * FT2_MAX_CHANNELS) + (k + chnOffset)];
+					ft2_note_t *p = ft2_pattern_note(inst, (uint16_t)pattNum, j, k + chnOffset);
 					uint8_t bytes[4];
 					if (!mem_read(&reader, bytes, 4)) { memset(p, 0, sizeof(ft2_note_t)); continue; }
 					uint16_t period = ((bytes[0] & 0x0F) << 8) | bytes[1];
@@ -261,7 +261,7 @@ bool load_mod_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 		if (rep->pattern[a] == NULL) continue;
 		for (int j = 0; j < 64; j++) {
 			for (int k = 0; k < song->numChannels; k++) {
-				ft2_note_t *p = &rep->pattern[a][(j * FT2_MAX_CHANNELS) + k];
+				ft2_note_t *p = ft2_pattern_note(inst, a, j, k);
 				if (p->efx == 0xC && p->efxData > 64) p->efxData = 64;
 				else if (p->efx == 0x1 && p->efxData == 0) p->efx = 0;
 				else if (p->efx == 0x2 && p->efxData == 0) p->efx = 0;
@@ -284,10 +284,14 @@ bool load_mod_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 		}
 	}
 
-	/* Load samples */
+	/* Load samples (decoded in parallel once all headers are parsed) */
+	ft2_decode_list_t decodes;
+	ft2_decode_list_init(&decodes);
+	bool ok = true;
+
 	for (int a = 0; a < 31; a++) {
 		if (hdr.smp[a].length == 0) continue;
-		if (!ft2_instance_alloc_instr(inst, 1 + a)) return false;
+		if (!ft2_instance_alloc_instr(inst, 1 + a)) { ok = false; break; }
 
 		ft2_instr_t *ins = rep->instr[1 + a];
 		ft2_sample_t *s = &ins->smp[0];
@@ -319,17 +323,19 @@ bool load_mod_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 
 		if (s->loopStart + s->loopLength > 2) s->flags |= LOOP_FWD;
 
-		if (!allocateSmpData(inst, 1 + a, 0, s->length, false)) return false;
+		if (GET_LOOPTYPE(s->flags) == LOOP_OFF) { s->loopLength = 0; s->loopStart = 0; }
 
+		/* Queue copy from the module buffer (truncated data is zero-filled) */
 		uint32_t bytesToRead = s->length;
 		if (mem_remaining(&reader) < bytesToRead) bytesToRead = mem_remaining(&reader);
-		if (bytesToRead > 0) { memcpy(s->dataPtr, mem_ptr(&reader), bytesToRead); mem_skip(&reader, bytesToRead); }
-		if (bytesToRead < (uint32_t)s->length) memset(&s->dataPtr[bytesToRead], 0, s->length - bytesToRead);
-
-		if (GET_LOOPTYPE(s->flags) == LOOP_OFF) { s->loopLength = 0; s->loopStart = 0; }
-		ft2_fix_sample(s);
+		if (!ft2_decode_list_add(&decodes, s, FT2_DECODE_RAW, mem_ptr(&reader), bytesToRead, false)) { ok = false; break; }
+		mem_skip(&reader, bytesToRead);
 	}
 
+	ok = ft2_decode_list_run(&decodes) && ok;
+	ft2_decode_list_free(&decodes);
+	if (!ok) return false;
+
 	song->songPos = 0;
 	song->row = 0;
 	inst->uiState.updatePosEdScrollBar = true;
@@ -13,6 +13,7 @@
 #include <math.h>
 #include "ft2_plugin_load_s3m.h"
 #include "ft2_plugin_mem_reader.h"
+#include "ft2_plugin_sample_decode.h"
 #include "ft2_plugin_sample_ed.h"
 #include "../ft2_instance.h"
 
@@ -56,33 +57,7 @@ s3mHdr_t;
 #pragma pack(pop)
 #endif
 
-/* ---------- Sample conversion ---------- */
-
-/* S3M samples are unsigned; convert to signed, downmix stereo to mono */
-static void conv8BitSample(int8_t *p, int32_t length, bool stereo)
-{
-	if (stereo) {
-		length >>= 1;
-		int8_t *p2 = &p[length];
-		for (int32_t i = 0; i < length; i++)
-			p[i] = (int8_t)(((p[i] ^ 0x80) + (p2[i] ^ 0x80)) >> 1);
-	} else {
-		for (int32_t i = 0; i < length; i++) p[i] ^= 0x80;
-	}
-}
-
-static void conv16BitSample(int8_t *p, int32_t length, bool stereo)
-{
-	int16_t *p16_1 = (int16_t *)p;
-	if (stereo) {
-		length >>= 1;
-		int16_t *p16_2 = p16_1 + length;
-		for (int32_t i = 0; i < length; i++)
-			p16_1[i] = (int16_t)(((p16_1[i] ^ 0x8000) + (p16_2[i] ^ 0x8000)) >> 1);
-	} else {
-		for (int32_t i = 0; i < length; i++) p16_1[i] ^= 0x8000;
-	}
-}
+/* ---------- Helpers ---------- */
 
 /* Convert S3M C4 frequency to XM relative note + finetune */
 static void setSampleC4Hz(ft2_sample_t *s, double dC4Hz)
@@ -103,7 +78,7 @@ static int32_t countS3MChannels(ft2_instance_t *inst, uint16_t numPatterns)
 		if (rep->pattern[i] == NULL) continue;
 		ft2_note_t *p = rep->pattern[i];
 		for (int32_t j = 0; j < 64; j++) {
-			for (int32_t k = 0; k < FT2_MAX_CHANNELS; k++, p++) {
+			for (int32_t k = 0; k < rep->patternStride; k++, p++) {
 				if (p->note || p->instr || p->vol || p->efx || p->efxData)
 					if (k > channels) channels = k;
 			}
@@ -183,6 +158,9 @@ bool load_s3m_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 		patternOffsets[i] = offset << 4;
 	}
 
+	/* Channel count is only known after scanning the patterns, so unpack at full width */
+	ft2_pattern_set_stride(inst, FT2_MAX_CHANNELS); /* No patterns yet, can't fail */
+
 	/* Effect memory for S3M->XM conversion */
 	uint8_t alastnfo[32], alastefx[32], alastvibnfo[32], s3mLastGInstr[32];
 
@@ -200,9 +178,8 @@ bool load_s3m_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 		if (!mem_read(&reader, &pattLen, 2)) continue;
 		if (pattLen == 0 || pattLen > 12288) continue;
 
-		rep->pattern[i] = (ft2_note_t *)calloc(64 * FT2_MAX_CHANNELS, sizeof(ft2_note_t));
-		if (rep->pattern[i] == NULL) return false;
 		rep->patternNumRows[i] = 64;
+		if (!ft2_pattern_alloc(inst, i)) return false;
 
 		uint8_t pattBuff[12288];
 		if (!mem_read(&reader, pattBuff, pattLen)) continue;
@@ -331,11 +308,16 @@ bool load_s3m_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 			}
 
 			if (tmpNote.instr != 0 && tmpNote.efx != 3) s3mLastGInstr[chn] = tmpNote.instr;
-			rep->pattern[i][(row * FT2_MAX_CHANNELS) + chn] = tmpNote;
+			*ft2_pattern_note(inst, i, row, chn) = tmpNote;
 		}
 	}
 
-	/* Load samples (type 1 = PCM, type 2 = AdLib which we skip) */
+	/* Load samples (type 1 = PCM, type 2 = AdLib which we skip).
+	 * Data is decoded in parallel once all headers are parsed. */
+	ft2_decode_list_t decodes;
+	ft2_decode_list_init(&decodes);
+	bool ok = true;
+
 	for (int32_t i = 0; i < hdr.numSamples; i++) {
 		if (sampleOffsets[i] == 0) continue;
 		if (!mem_seek(&reader, sampleOffsets[i])) continue;
@@ -349,7 +331,7 @@ bool load_s3m_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 			if ((smpHdr.flags & (255 - 1 - 2 - 4)) != 0 || smpHdr.packFlag != 0) continue;
 
 			if (offsetInFile > 0 && smpHdr.length > 0) {
-				if (!ft2_instance_alloc_instr(inst, 1 + i)) return false;
+				if (!ft2_instance_alloc_instr(inst, 1 + i)) { ok = false; break; }
 
 				ft2_instr_t *ins = rep->instr[1 + i];
 				ft2_sample_t *s = &ins->smp[0];
@@ -374,35 +356,34 @@ bool load_s3m_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 				setSampleC4Hz(s, smpHdr.midCFreq);
 
 				if (sample16Bit) { s->flags |= SAMPLE_16BIT; lengthInFile <<= 1; }
-				if (!allocateSmpData(inst, 1 + i, 0, s->length, sample16Bit)) return false;
+				if (s->length < 0) s->length = 0;
 
 				if (s->loopLength <= 1 || s->loopStart + s->loopLength > s->length) {
 					s->loopStart = 0; s->loopLength = 0; hasLoop = false;
 				}
 				if (hasLoop) s->flags |= LOOP_FWD;
 
-				/* Version 1 samples use different format, not supported */
-				if (hdr.version == 1) {
-					memset(s->dataPtr, 0, s->length * (sample16Bit ? 2 : 1));
-				} else {
-					if (!mem_seek(&reader, offsetInFile)) {
-						memset(s->dataPtr, 0, s->length * (sample16Bit ? 2 : 1));
+				if (s->length > 0) {
+					/* Version 1 samples use different format, not supported */
+					bool queued;
+					if (hdr.version == 1 || !mem_seek(&reader, offsetInFile)) {
+						queued = ft2_decode_list_add(&decodes, s, FT2_DECODE_RAW, NULL, 0, false);
 					} else {
 						uint32_t bytesToRead = s->length * (sample16Bit ? 2 : 1);
 						if (mem_remaining(&reader) < bytesToRead) bytesToRead = mem_remaining(&reader);
-						if (bytesToRead > 0) { memcpy(s->dataPtr, mem_ptr(&reader), bytesToRead); mem_skip(&reader, bytesToRead); }
-
-						if (sample16Bit) conv16BitSample(s->dataPtr, s->length, stereoSample);
-						else conv8BitSample(s->dataPtr, s->length, stereoSample);
-
-						if (stereoSample) s->length >>= 1;
+						queued = ft2_decode_list_add(&decodes, s, FT2_DECODE_S3M, mem_ptr(&reader), bytesToRead, stereoSample);
+						mem_skip(&reader, bytesToRead);
 					}
+					if (!queued) { ok = false; break; }
 				}
-				ft2_fix_sample(s);
 			}
 		}
 	}
 
+	ok = ft2_decode_list_run(&decodes) && ok;
+	ft2_decode_list_free(&decodes);
+	if (!ok) return false;
+
 	/* Determine channel count from pattern data */
 	song->numChannels = countS3MChannels(inst, hdr.numPatterns);
 	if (song->numChannels < 1) song->numChannels = 4;
@@ -412,6 +393,9 @@ bool load_s3m_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t da
 		if (song->numChannels > FT2_MAX_CHANNELS) song->numChannels = FT2_MAX_CHANNELS;
 	}
 
+	/* Patterns were unpacked at full width, compact them to the channel count */
+	if (!ft2_pattern_set_stride(inst, song->numChannels)) return false;
+
 	song->songPos = 0;
 	song->row = 0;
 	inst->uiState.updatePosEdScrollBar = true;
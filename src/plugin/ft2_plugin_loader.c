@@ -17,10 +17,12 @@
 #include "ft2_plugin_loader.h"
 #include "ft2_plugin_replayer.h"
 #include "ft2_plugin_mem_reader.h"
+#include "ft2_plugin_sample_decode.h"
 #include "ft2_plugin_load_mod.h"
 #include "ft2_plugin_load_s3m.h"
 #include "ft2_plugin_timemap.h"
 #include "ft2_plugin_gui.h"
+#include "ft2_plugin_smpfx.h"
 
 #define SAMPLE_16BIT  16
 #define SAMPLE_STEREO 32
@@ -109,22 +111,23 @@ typedef struct xm_loader_state_t {
 	ft2_instance_t *inst;
 	xm_header_t header;
 	bool linearPeriodsFlag;
+	ft2_decode_list_t decodes; /* Sample data, decoded after parsing */
 } xm_loader_state_t;
 
 /* ---------- Pattern unpacking ---------- */
 
-/* Unpack XM pattern data (RLE-like compression).
+/* Unpack XM pattern data (RLE-like compression) into rows of dstStride cells.
  * Byte with bit 7 set = compressed, bits 0-4 indicate which fields follow. */
-static void unpack_pattern(ft2_note_t *dst, const uint8_t *src, uint32_t srcLen, int32_t numChannels, int32_t numRows)
+static void unpack_pattern(ft2_note_t *dst, int32_t dstStride, const uint8_t *src, uint32_t srcLen, int32_t numChannels, int32_t numRows)
 {
 	if (dst == NULL) return;
 
 	const int32_t srcEnd = numRows * (sizeof(ft2_note_t) * numChannels);
 	int32_t srcIdx = 0;
-	int32_t actualChannels = (numChannels > FT2_MAX_CHANNELS) ? FT2_MAX_CHANNELS : numChannels;
+	int32_t actualChannels = (numChannels > dstStride) ? dstStride : numChannels;
 
 	for (int32_t i = 0; i < numRows; i++) {
-		ft2_note_t *p = &dst[i * FT2_MAX_CHANNELS];
+		ft2_note_t *p = &dst[i * dstStride];
 		for (int32_t j = 0; j < actualChannels; j++) {
 			if (srcIdx >= srcEnd) return;
 			const uint8_t note = *src++;
@@ -144,7 +147,7 @@ static void unpack_pattern(ft2_note_t *dst, const uint8_t *src, uint32_t srcLen,
 			srcIdx += sizeof(ft2_note_t);
 			p++;
 		}
-		/* Skip channels beyond FT2_MAX_CHANNELS */
+		/* Skip channels beyond the stored ones */
 		for (int32_t j = actualChannels; j < numChannels; j++) {
 			if (srcIdx >= srcEnd) return;
 			const uint8_t note = *src++;
@@ -162,67 +165,6 @@ static void unpack_pattern(ft2_note_t *dst, const uint8_t *src, uint32_t srcLen,
 	}
 }
 
-/* ---------- Sample decoding ---------- */
-
-/* Delta decode sample data, downmixing stereo to mono if needed.
- * XM samples are stored as deltas from previous sample value. */
-static void delta_to_sample(int8_t *p, int32_t length, uint8_t smpFlags)
-{
-	bool sample16Bit = !!(smpFlags & SAMPLE_16BIT);
-	bool stereo = !!(smpFlags & SAMPLE_STEREO);
-
-	if (stereo) {
-		length >>= 1;
-		if (sample16Bit) {
-			int16_t *p16L = (int16_t *)p, *p16R = (int16_t *)p + length;
-			int16_t olds16L = 0, olds16R = 0;
-			for (int32_t i = 0; i < length; i++) {
-				olds16L = p16L[i] += olds16L;
-				olds16R = p16R[i] += olds16R;
-				p16L[i] = (int16_t)((olds16L + olds16R) >> 1);
-			}
-		} else {
-			int8_t *p8L = p, *p8R = p + length;
-			int8_t olds8L = 0, olds8R = 0;
-			for (int32_t i = 0; i < length; i++) {
-				olds8L = p8L[i] += olds8L;
-				olds8R = p8R[i] += olds8R;
-				p8L[i] = (int8_t)((olds8L + olds8R) >> 1);
-			}
-		}
-	} else {
-		if (sample16Bit) {
-			int16_t *p16 = (int16_t *)p;
-			int16_t olds16 = 0;
-			for (int32_t i = 0; i < length; i++) olds16 = p16[i] += olds16;
-		} else {
-			int8_t olds8 = 0;
-			for (int32_t i = 0; i < length; i++) olds8 = p[i] += olds8;
-		}
-	}
-}
-
-/* ModPlug ADPCM: 4-bit delta with 16-byte LUT per sample */
-static bool load_adpcm_sample(mem_reader_t *r, ft2_sample_t *s)
-{
-	int8_t deltaLUT[16];
-	if (!mem_read(r, deltaLUT, 16)) return false;
-
-	const int32_t dataLength = (s->length + 1) / 2;
-	int8_t *dataPtr = s->dataPtr;
-	int8_t currSample = 0;
-
-	for (int32_t i = 0; i < dataLength; i++) {
-		uint8_t nibbles;
-		if (!mem_read(r, &nibbles, 1)) return false;
-		currSample += deltaLUT[nibbles & 0x0F];
-		*dataPtr++ = currSample;
-		currSample += deltaLUT[nibbles >> 4];
-		*dataPtr++ = currSample;
-	}
-	return true;
-}
-
 /* ---------- Instrument loading ---------- */
 
 /* Load instrument header. Separated from sample loading for v1.02/v1.03 compat. */
@@ -357,29 +299,18 @@ static bool load_instr_sample(xm_loader_state_t *state, uint16_t instrNum)
 		if (sample16Bit) { s->length >>= 1; s->loopStart >>= 1; s->loopLength >>= 1; }
 		if (s->length > FT2_MAX_SAMPLE_LEN) s->length = FT2_MAX_SAMPLE_LEN;
 
-		/* Allocate with padding for interpolation taps */
-		const uint32_t allocLen = (s->length + FT2_MAX_TAPS * 2) * (sample16Bit ? 2 : 1);
-		s->origDataPtr = (int8_t *)malloc(allocLen + FT2_MAX_TAPS * 2);
-		if (s->origDataPtr == NULL) return false;
-		s->dataPtr = s->origDataPtr + FT2_MAX_TAPS * (sample16Bit ? 2 : 1);
-		memset(s->origDataPtr, 0, allocLen + FT2_MAX_TAPS * 2);
+		/* Queue decoding straight from the module buffer (truncated data decodes as silence) */
+		const uint8_t codec = adpcmSample ? FT2_DECODE_XM_ADPCM : FT2_DECODE_XM_DELTA;
+		if (!ft2_decode_list_add(&state->decodes, s, codec, mem_ptr(r), mem_remaining(r), stereoSample)) return false;
 
 		if (adpcmSample) {
-			if (!load_adpcm_sample(r, s)) return false;
+			if (!mem_skip(r, 16 + ((uint32_t)s->length + 1) / 2)) return false;
 		} else {
 			const int32_t sampleLengthInBytes = s->length * (sample16Bit ? 2 : 1);
-			if (!mem_read(r, s->dataPtr, sampleLengthInBytes)) return false;
+			if (!mem_skip(r, sampleLengthInBytes)) return false;
 			if (sampleLengthInBytes < lengthInFile)
 				if (!mem_skip(r, lengthInFile - sampleLengthInBytes)) return false;
-
-			delta_to_sample(s->dataPtr, s->length, s->flags);
-
-			if (stereoSample) { s->length >>= 1; s->loopStart >>= 1; s->loopLength >>= 1; }
 		}
-
-		if (s->flags & SAMPLE_STEREO) s->flags &= ~SAMPLE_STEREO;
-		ft2_sanitize_sample(s);
-		ft2_fix_sample(s);
 	}
 
 	/* Skip extra sample data (>16 samples) */
@@ -428,14 +359,13 @@ static bool load_patterns(xm_loader_state_t *state, uint16_t numPatterns)
 		rep->patternNumRows[i] = numRows;
 
 		if (dataSize > 0) {
-			rep->pattern[i] = (ft2_note_t *)calloc(numRows * FT2_MAX_CHANNELS, sizeof(ft2_note_t));
-			if (rep->pattern[i] == NULL) return false;
+			if (!ft2_pattern_alloc(inst, i)) return false;
 
 			uint8_t *packedData = (uint8_t *)malloc(dataSize);
 			if (packedData == NULL) return false;
 			if (!mem_read(r, packedData, dataSize)) { free(packedData); return false; }
 
-			unpack_pattern(rep->pattern[i], packedData, dataSize, numChannels, numRows);
+			unpack_pattern(rep->pattern[i], rep->patternStride, packedData, dataSize, numChannels, numRows);
 			free(packedData);
 		}
 	}
@@ -444,6 +374,28 @@ static bool load_patterns(xm_loader_state_t *state, uint16_t numPatterns)
 
 /* ---------- XM loader entry point ---------- */
 
+/* v1.02/v1.03: headers, patterns, samples
+ * v1.04: patterns, then instruments with samples interleaved */
+static bool load_song_data(xm_loader_state_t *state)
+{
+	const xm_header_t *h = &state->header;
+
+	if (h->version < 0x0104) {
+		for (uint16_t i = 1; i <= h->numInstr; i++)
+			if (!load_instr_header(state, i)) return false;
+		if (!load_patterns(state, h->numPatterns)) return false;
+		for (uint16_t i = 1; i <= h->numInstr; i++)
+			if (!load_instr_sample(state, i)) return false;
+	} else {
+		if (!load_patterns(state, h->numPatterns)) return false;
+		for (uint16_t i = 1; i <= h->numInstr; i++) {
+			if (!load_instr_header(state, i)) return false;
+			if (!load_instr_sample(state, i)) return false;
+		}
+	}
+	return true;
+}
+
 bool ft2_load_xm_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t dataSize)
 {
 	if (inst == NULL || data == NULL || dataSize < sizeof(xm_header_t)) return false;
@@ -482,6 +434,7 @@ bool ft2_load_xm_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t
 		song->numChannels++;
 		if (song->numChannels > FT2_MAX_CHANNELS) song->numChannels = FT2_MAX_CHANNELS;
 	}
+	ft2_pattern_set_stride(inst, song->numChannels); /* No patterns yet, can't fail */
 
 	song->BPM = h->BPM;
 	song->speed = h->speed;
@@ -499,21 +452,13 @@ bool ft2_load_xm_from_memory(ft2_instance_t *inst, const uint8_t *data, uint32_t
 
 	inst->audio.linearPeriodsFlag = !!(h->flags & 1);
 
-	/* v1.02/v1.03: headers, patterns, samples
-	 * v1.04: patterns, then instruments with samples interleaved */
-	if (h->version < 0x0104) {
-		for (uint16_t i = 1; i <= h->numInstr; i++)
-			if (!load_instr_header(&state, i)) return false;
-		if (!load_patterns(&state, h->numPatterns)) return false;
-		for (uint16_t i = 1; i <= h->numInstr; i++)
-			if (!load_instr_sample(&state, i)) return false;
-	} else {
-		if (!load_patterns(&state, h->numPatterns)) return false;
-		for (uint16_t i = 1; i <= h->numInstr; i++) {
-			if (!load_instr_header(&state, i)) return false;
-			if (!load_instr_sample(&state, i)) return false;
-		}
-	}
+	/* Parse everything, then decode the queued samples (also on failure,
+	 * so partially loaded samples are valid) */
+	ft2_decode_list_init(&state.decodes);
+	bool ok = load_song_data(&state);
+	ok = ft2_decode_list_run(&state.decodes) && ok;
+	ft2_decode_list_free(&state.decodes);
+	if (!ok) return false;
 
 	/* Discard instruments >128 */
 	if (h->numInstr > FT2_MAX_INST) {
@@ -570,6 +515,9 @@ bool ft2_load_module(ft2_instance_t *inst, const uint8_t *data, uint32_t dataSiz
 		default: return false;
 	}
 
+	/* The loader reset the instance, so the old samples are gone either way */
+	clearSampleUndo(inst);
+
 	if (loaded) {
 		inst->uiState.channelOffset = 0;
 		inst->uiState.updateChanScrollPos = true;
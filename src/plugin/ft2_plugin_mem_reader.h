@@ -3,6 +3,8 @@
  * @brief Memory buffer reader for module loaders.
  *
  * File-like API for reading from memory buffers. Used by XM/MOD/S3M loaders.
+ * The buffer is never written, so it may be a read-only file mapping; loaders
+ * can hand mem_ptr() to sample decoding instead of copying.
  */
 
 #ifndef FT2_PLUGIN_MEM_READER_H
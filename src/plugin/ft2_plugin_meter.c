@@ -0,0 +1,162 @@
+/**
+ * @file ft2_plugin_meter.c
+ * @brief Per-channel and per-voice peak/RMS levels, measured by the mixer.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "ft2_plugin_meter.h"
+#include "ft2_plugin_simd.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define exchangeIdx(p, v) InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#else
+#define exchangeIdx(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#endif
+
+#define METER_FRESH 4
+
+void ft2_meter_init(ft2_meter_t *m)
+{
+	if (m == NULL)
+		return;
+
+	memset(m, 0, sizeof(ft2_meter_t));
+	m->writeIdx = 0;
+	m->spareIdx = 1;
+	m->readIdx = 2;
+	m->readFrame = 0u - FT2_METER_IDLE_FRAMES; /* Off until read */
+}
+
+void ft2_meter_mix_tile(ft2_meter_t *m, int32_t voice, float *srcL, float *srcR,
+	float *dstL, float *dstR, int32_t n)
+{
+	ft2_meter_accum_t *a = &m->slot[m->writeIdx].voice[voice];
+	int32_t i = 0;
+
+	/* Each lane keeps its own peak and sum, so nothing is reduced here */
+#if defined(FT2_SIMD_SSE2)
+	const __m128 vAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	__m128 vPeakL = _mm_loadu_ps(a->peakL), vPeakR = _mm_loadu_ps(a->peakR);
+	__m128 vSumL = _mm_loadu_ps(a->sumSqL), vSumR = _mm_loadu_ps(a->sumSqR);
+	for (; i + 4 <= n; i += 4) {
+		const __m128 l = _mm_loadu_ps(&srcL[i]);
+		const __m128 r = _mm_loadu_ps(&srcR[i]);
+		_mm_storeu_ps(&srcL[i], _mm_setzero_ps());
+		_mm_storeu_ps(&srcR[i], _mm_setzero_ps());
+		_mm_storeu_ps(&dstL[i], _mm_add_ps(_mm_loadu_ps(&dstL[i]), l));
+		_mm_storeu_ps(&dstR[i], _mm_add_ps(_mm_loadu_ps(&dstR[i]), r));
+		vPeakL = _mm_max_ps(vPeakL, _mm_and_ps(l, vAbsMask));
+		vPeakR = _mm_max_ps(vPeakR, _mm_and_ps(r, vAbsMask));
+		vSumL = _mm_add_ps(vSumL, _mm_mul_ps(l, l));
+		vSumR = _mm_add_ps(vSumR, _mm_mul_ps(r, r));
+	}
+	_mm_storeu_ps(a->peakL, vPeakL);
+	_mm_storeu_ps(a->peakR, vPeakR);
+	_mm_storeu_ps(a->sumSqL, vSumL);
+	_mm_storeu_ps(a->sumSqR, vSumR);
+#elif defined(FT2_SIMD_NEON)
+	float32x4_t vPeakL = vld1q_f32(a->peakL), vPeakR = vld1q_f32(a->peakR);
+	float32x4_t vSumL = vld1q_f32(a->sumSqL), vSumR = vld1q_f32(a->sumSqR);
+	for (; i + 4 <= n; i += 4) {
+		const float32x4_t l = vld1q_f32(&srcL[i]);
+		const float32x4_t r = vld1q_f32(&srcR[i]);
+		vst1q_f32(&srcL[i], vdupq_n_f32(0.0f));
+		vst1q_f32(&srcR[i], vdupq_n_f32(0.0f));
+		vst1q_f32(&dstL[i], vaddq_f32(vld1q_f32(&dstL[i]), l));
+		vst1q_f32(&dstR[i], vaddq_f32(vld1q_f32(&dstR[i]), r));
+		vPeakL = vmaxq_f32(vPeakL, vabsq_f32(l));
+		vPeakR = vmaxq_f32(vPeakR, vabsq_f32(r));
+		vSumL = vmlaq_f32(vSumL, l, l);
+		vSumR = vmlaq_f32(vSumR, r, r);
+	}
+	vst1q_f32(a->peakL, vPeakL);
+	vst1q_f32(a->peakR, vPeakR);
+	vst1q_f32(a->sumSqL, vSumL);
+	vst1q_f32(a->sumSqR, vSumR);
+#endif
+
+	for (; i < n; i++) {
+		const float l = srcL[i], r = srcR[i];
+		const int32_t lane = i & (FT2_METER_LANES - 1);
+		srcL[i] = srcR[i] = 0.0f;
+		dstL[i] += l;
+		dstR[i] += r;
+		if (fabsf(l) > a->peakL[lane]) a->peakL[lane] = fabsf(l);
+		if (fabsf(r) > a->peakR[lane]) a->peakR[lane] = fabsf(r);
+		a->sumSqL[lane] += l * l;
+		a->sumSqR[lane] += r * r;
+	}
+}
+
+void ft2_meter_publish(ft2_meter_t *m, int32_t numChannels, uint32_t numFrames, float gain)
+{
+	if (m == NULL || numFrames == 0)
+		return;
+
+	ft2_meter_block_t *b = &m->slot[m->writeIdx];
+	b->sequence = ++m->sequence;
+	b->numFrames = numFrames;
+	b->numChannels = (numChannels > FT2_METER_CHANNELS) ? FT2_METER_CHANNELS : numChannels;
+	b->gain = gain;
+	m->frames += numFrames;
+
+	/* Hand the filled slot over and continue in the old spare */
+	m->writeIdx = exchangeIdx(&m->spareIdx, m->writeIdx | METER_FRESH) & 3;
+	memset(m->slot[m->writeIdx].voice, 0, sizeof(m->slot[0].voice));
+}
+
+/* Folds a voice's lanes into l, as a peak and a sum of squares */
+static void foldLanes(const ft2_meter_accum_t *a, ft2_meter_level_t *l)
+{
+	for (int32_t i = 0; i < FT2_METER_LANES; i++) {
+		if (a->peakL[i] > l->peakL) l->peakL = a->peakL[i];
+		if (a->peakR[i] > l->peakR) l->peakR = a->peakR[i];
+		l->rmsL += a->sumSqL[i];
+		l->rmsR += a->sumSqR[i];
+	}
+}
+
+/* Turns what foldLanes() gathered into output levels */
+static void finishLevel(ft2_meter_level_t *l, float gain, float invFrames)
+{
+	l->peakL *= gain;
+	l->peakR *= gain;
+	l->rmsL = sqrtf(l->rmsL * invFrames) * gain;
+	l->rmsR = sqrtf(l->rmsR * invFrames) * gain;
+}
+
+bool ft2_meter_read(ft2_meter_t *m, ft2_meter_snapshot_t *out)
+{
+	if (m == NULL || out == NULL)
+		return false;
+
+	m->readFrame = m->frames;
+
+	const bool fresh = (m->spareIdx & METER_FRESH) != 0;
+	if (fresh)
+		m->readIdx = exchangeIdx(&m->spareIdx, m->readIdx) & 3;
+
+	const ft2_meter_block_t *b = &m->slot[m->readIdx];
+	const float invFrames = (b->numFrames > 0) ? (1.0f / (float)b->numFrames) : 0.0f;
+
+	out->sequence = b->sequence;
+	out->numFrames = b->numFrames;
+	out->numChannels = b->numChannels;
+
+	memset(out->channel, 0, sizeof(out->channel));
+	memset(out->voice, 0, sizeof(out->voice));
+
+	/* A channel is its voice and the one fading out of it */
+	for (int32_t i = 0; i < FT2_METER_VOICES; i++) {
+		foldLanes(&b->voice[i], &out->voice[i]);
+		foldLanes(&b->voice[i], &out->channel[i % FT2_METER_CHANNELS]);
+		finishLevel(&out->voice[i], b->gain, invFrames);
+	}
+	for (int32_t i = 0; i < FT2_METER_CHANNELS; i++)
+		finishLevel(&out->channel[i], b->gain, invFrames);
+
+	return fresh;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file ft2_plugin_meter.h
+ * @brief Per-channel and per-voice peak/RMS levels, measured by the mixer.
+ *
+ * The mixer mixes each voice a tile at a time into a scratch buffer,
+ * then adds the tile to the output and folds it into the voice's
+ * accumulator in the same pass. The levels are those of the samples the
+ * voice actually added to the mix (interpolation, volume ramps and all).
+ * That costs the mixer about a tenth, so it only happens while someone
+ * reads the levels: FT2_METER_IDLE_FRAMES after the last read the mixer
+ * stops measuring, and the first read after that starts it again (that
+ * read gets a block without levels).
+ *
+ * Once per rendered block the levels are published to a triple buffer: the
+ * audio thread never waits, and a reader always gets the most recent
+ * complete block without blocking either.
+ *
+ * Levels are in output units (normalization gain applied, before
+ * clipping). Each voice has its own level, and a channel combines its
+ * voice with the one fading out of it: the larger peak and the power sum.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FT2_METER_CHANNELS 32
+#define FT2_METER_VOICES (FT2_METER_CHANNELS * 2) /* Voice n + 32 fades out of channel n */
+#define FT2_METER_IDLE_FRAMES 65536 /* About 1.4 s at 48 kHz */
+
+typedef struct ft2_meter_level_t {
+	float peakL, peakR;
+	float rmsL, rmsR;
+} ft2_meter_level_t;
+
+typedef struct ft2_meter_snapshot_t {
+	uint32_t sequence;  /* Blocks published so far (0 = nothing yet) */
+	uint32_t numFrames; /* Length of the block the levels cover */
+	int32_t numChannels;
+	ft2_meter_level_t channel[FT2_METER_CHANNELS];
+	ft2_meter_level_t voice[FT2_METER_VOICES];
+} ft2_meter_snapshot_t;
+
+#define FT2_METER_LANES 4
+
+/* A block as the audio thread accumulates it: peaks and sums of squares
+ * per vector lane (frame n goes to lane n % 4), combined and turned into
+ * levels only when read */
+typedef struct ft2_meter_accum_t {
+	float peakL[FT2_METER_LANES], peakR[FT2_METER_LANES];
+	float sumSqL[FT2_METER_LANES], sumSqR[FT2_METER_LANES];
+} ft2_meter_accum_t;
+
+typedef struct ft2_meter_block_t {
+	uint32_t sequence, numFrames;
+	int32_t numChannels;
+	float gain;
+	ft2_meter_accum_t voice[FT2_METER_VOICES];
+} ft2_meter_block_t;
+
+typedef struct ft2_meter_t {
+	/* Triple buffer: the mixer accumulates straight into slot[writeIdx],
+	 * readIdx belongs to the reader, spareIdx is swapped between them
+	 * (FRESH bit = unread block) */
+	ft2_meter_block_t slot[3];
+	int32_t writeIdx, readIdx;
+	volatile int32_t spareIdx;
+	uint32_t sequence;
+
+	volatile uint32_t frames;    /* Published so far (audio thread) */
+	volatile uint32_t readFrame; /* frames as of the last read (reader) */
+} ft2_meter_t;
+
+void ft2_meter_init(ft2_meter_t *m);
+
+/* Mixer: true while the levels are being read, so worth measuring */
+static inline bool ft2_meter_active(const ft2_meter_t *m)
+{
+	return (uint32_t)(m->frames - m->readFrame) < FT2_METER_IDLE_FRAMES;
+}
+
+/* Mixer: adds n frames of one voice, as its kernel mixed them into the
+ * cleared scratch buffers (src), to the output (dst) and folds them into
+ * the voice's levels. Clears src again for the next voice. */
+void ft2_meter_mix_tile(ft2_meter_t *m, int32_t voice, float *srcL, float *srcR,
+	float *dstL, float *dstR, int32_t n);
+
+/* Audio thread, end of block: publishes what was accumulated over
+ * numFrames frames (levels get scaled by gain) and starts a new block */
+void ft2_meter_publish(ft2_meter_t *m, int32_t numChannels, uint32_t numFrames, float gain);
+
+/* Reader (one thread only): fills *out with the levels of the latest
+ * published block. Returns true if it is newer than the previous read. */
+bool ft2_meter_read(ft2_meter_t *m, ft2_meter_snapshot_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -18,6 +18,7 @@
 #include "ft2_plugin_sample_ed.h"
 #include "ft2_plugin_replayer.h"
 #include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_pool.h"
 #include "../ft2_instance.h"
 
 #define MIX_STATE(inst) (&FT2_UI(inst)->modalPanels.mix)
@@ -154,8 +155,12 @@ static void applyMixToSample(ft2_instance_t *inst)
 	if (!newOrigPtr) return;
 	int8_t *newData = newOrigPtr + padding;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) { free(newOrigPtr); return; }
+
+	/* The unfix may have moved a shared buffer to a private copy */
+	if (mixPtr == dstPtr) mixPtr = s->dataPtr;
+	if (dstPtr) dstPtr = s->dataPtr;
 
 	double dMixA = (100 - state->mixBalance) / 100.0;
 	double dMixB = state->mixBalance / 100.0;
@@ -183,7 +188,7 @@ static void applyMixToSample(ft2_instance_t *inst)
 		}
 	}
 
-	free(s->origDataPtr);
+	ft2_sample_pool_release(s->origDataPtr);
 	s->origDataPtr = newOrigPtr;
 	s->dataPtr = newData;
 	s->length = newLen;
@@ -107,13 +107,13 @@ static void drawNibblesFoodNumber(ft2_video_t *video, const ft2_bmp_t *bmp, int3
 static void setNibbleDot(ft2_instance_t *inst, ft2_video_t *video, uint8_t x, uint8_t y, uint8_t c)
 {
 	const uint16_t xs = 152 + (x * 8), ys = 7 + (y * 7);
-	if (inst->nibbles.grid) {
+	if (inst->nibbles->grid) {
 		fillRect(video, xs, ys, 8, 7, PAL_BUTTON2);
 		fillRect(video, xs + 1, ys + 1, 7, 6, c);
 	} else {
 		fillRect(video, xs, ys, 8, 7, c);
 	}
-	inst->nibbles.screen[x][y] = c;
+	inst->nibbles->screen[x][y] = c;
 }
 
 /* ---------- Input buffer ---------- */
@@ -121,19 +121,19 @@ static void setNibbleDot(ft2_instance_t *inst, ft2_video_t *video, uint8_t x, ui
 /* Queue direction input (up to 8 buffered per player) */
 static void nibblesAddBuffer(ft2_instance_t *inst, int16_t bufNum, uint8_t value)
 {
-	ft2_nibbles_buffer_t *n = &inst->nibbles.inputBuffer[bufNum];
+	ft2_nibbles_buffer_t *n = &inst->nibbles->inputBuffer[bufNum];
 	if (n->length < 8) n->data[n->length++] = value;
 }
 
 static bool nibblesBufferFull(ft2_instance_t *inst, int16_t bufNum)
 {
-	return inst->nibbles.inputBuffer[bufNum].length > 0;
+	return inst->nibbles->inputBuffer[bufNum].length > 0;
 }
 
 /* Dequeue direction (FIFO) */
 static int16_t nibblesGetBuffer(ft2_instance_t *inst, int16_t bufNum)
 {
-	ft2_nibbles_buffer_t *n = &inst->nibbles.inputBuffer[bufNum];
+	ft2_nibbles_buffer_t *n = &inst->nibbles->inputBuffer[bufNum];
 	if (n->length == 0) return -1;
 	int16_t dataOut = n->data[0];
 	memmove(&n->data[0], &n->data[1], 7);
@@ -151,7 +151,7 @@ static void nibblesGetLevel(ft2_instance_t *inst, int16_t levelNum, const ft2_bm
 	const uint8_t *stagePtr = &bmp->nibblesStages[(readY * NIBBLES_STAGES_BMP_WIDTH) + readX];
 	for (int32_t y = 0; y < NIBBLES_SCREEN_H; y++, stagePtr += NIBBLES_STAGES_BMP_WIDTH)
 		for (int32_t x = 0; x < NIBBLES_SCREEN_W; x++)
-			inst->nibbles.screen[x][y] = stagePtr[x];
+			inst->nibbles->screen[x][y] = stagePtr[x];
 }
 
 /* Initialize level: load walls, find spawn points, reset snake positions */
@@ -164,26 +164,26 @@ static void nibblesCreateLevel(ft2_instance_t *inst, int16_t levelNum, const ft2
 	int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
 	for (int32_t y = 0; y < NIBBLES_SCREEN_H; y++) {
 		for (int32_t x = 0; x < NIBBLES_SCREEN_W; x++) {
-			uint8_t c = inst->nibbles.screen[x][y];
-			if (c == 3) { x1 = x; y1 = y; inst->nibbles.screen[x][y] = 0; }
-			else if (c == 1) { x2 = x; y2 = y; inst->nibbles.screen[x][y] = 0; }
+			uint8_t c = inst->nibbles->screen[x][y];
+			if (c == 3) { x1 = x; y1 = y; inst->nibbles->screen[x][y] = 0; }
+			else if (c == 1) { x2 = x; y2 = y; inst->nibbles->screen[x][y] = 0; }
 		}
 	}
 
 	/* Read initial directions from stage header */
 	const int32_t readX = (NIBBLES_SCREEN_W + 2) * (levelNum % 10);
 	const int32_t readY = (NIBBLES_SCREEN_H + 2) * (levelNum / 10);
-	inst->nibbles.p1Dir = bmp->nibblesStages[(readY * NIBBLES_STAGES_BMP_WIDTH) + (readX + 1)];
-	inst->nibbles.p2Dir = bmp->nibblesStages[(readY * NIBBLES_STAGES_BMP_WIDTH) + (readX + 0)];
+	inst->nibbles->p1Dir = bmp->nibblesStages[(readY * NIBBLES_STAGES_BMP_WIDTH) + (readX + 1)];
+	inst->nibbles->p2Dir = bmp->nibblesStages[(readY * NIBBLES_STAGES_BMP_WIDTH) + (readX + 0)];
 
-	inst->nibbles.p1Len = inst->nibbles.p2Len = 5;
-	inst->nibbles.p1NoClear = inst->nibbles.p2NoClear = 0;
-	inst->nibbles.number = 0;
-	inst->nibbles.inputBuffer[0].length = inst->nibbles.inputBuffer[1].length = 0;
+	inst->nibbles->p1Len = inst->nibbles->p2Len = 5;
+	inst->nibbles->p1NoClear = inst->nibbles->p2NoClear = 0;
+	inst->nibbles->number = 0;
+	inst->nibbles->inputBuffer[0].length = inst->nibbles->inputBuffer[1].length = 0;
 
 	for (int32_t i = 0; i < 256; i++) {
-		inst->nibbles.p1[i].x = (uint8_t)x1; inst->nibbles.p1[i].y = (uint8_t)y1;
-		inst->nibbles.p2[i].x = (uint8_t)x2; inst->nibbles.p2[i].y = (uint8_t)y2;
+		inst->nibbles->p1[i].x = (uint8_t)x1; inst->nibbles->p1[i].y = (uint8_t)y1;
+		inst->nibbles->p2[i].x = (uint8_t)x2; inst->nibbles->p2[i].y = (uint8_t)y2;
 	}
 }
 
@@ -220,38 +220,38 @@ static void highScoreTextOutClipX(ft2_video_t *video, const ft2_bmp_t *bmp, uint
 static void drawScoresLives(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
 	char livesStr[4];
-	hexOutBg(video, bmp, 89, 27, PAL_FORGRND, PAL_DESKTOP, inst->nibbles.p1Score, 8);
-	snprintf(livesStr, sizeof(livesStr), "%02d", (int)(inst->nibbles.p1Lives > 99 ? 99 : inst->nibbles.p1Lives));
+	hexOutBg(video, bmp, 89, 27, PAL_FORGRND, PAL_DESKTOP, inst->nibbles->p1Score, 8);
+	snprintf(livesStr, sizeof(livesStr), "%02d", (int)(inst->nibbles->p1Lives > 99 ? 99 : inst->nibbles->p1Lives));
 	textOutFixed(video, bmp, 131, 39, PAL_FORGRND, PAL_DESKTOP, livesStr);
 
-	hexOutBg(video, bmp, 89, 75, PAL_FORGRND, PAL_DESKTOP, inst->nibbles.p2Score, 8);
-	snprintf(livesStr, sizeof(livesStr), "%02d", (int)(inst->nibbles.p2Lives > 99 ? 99 : inst->nibbles.p2Lives));
+	hexOutBg(video, bmp, 89, 75, PAL_FORGRND, PAL_DESKTOP, inst->nibbles->p2Score, 8);
+	snprintf(livesStr, sizeof(livesStr), "%02d", (int)(inst->nibbles->p2Lives > 99 ? 99 : inst->nibbles->p2Lives));
 	textOutFixed(video, bmp, 131, 87, PAL_FORGRND, PAL_DESKTOP, livesStr);
 }
 
 /* Redraw entire game grid */
 static void nibblesRedrawScreen(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
-	if (!inst->nibbles.playing) return;
+	if (!inst->nibbles->playing) return;
 
 	for (int16_t x = 0; x < NIBBLES_SCREEN_W; x++) {
 		for (int16_t y = 0; y < NIBBLES_SCREEN_H; y++) {
 			const int16_t xs = 152 + (x * 8), ys = 7 + (y * 7);
-			const uint8_t c = inst->nibbles.screen[x][y];
+			const uint8_t c = inst->nibbles->screen[x][y];
 			if (c < 16) {
-				if (inst->nibbles.grid) {
+				if (inst->nibbles->grid) {
 					fillRect(video, xs, ys, 8, 7, PAL_BUTTON2);
 					fillRect(video, xs + 1, ys + 1, 7, 6, c);
 				} else {
 					fillRect(video, xs, ys, 8, 7, c);
 				}
 			} else {
-				drawNibblesFoodNumber(video, bmp, xs + 2, ys, inst->nibbles.number);
+				drawNibblesFoodNumber(video, bmp, xs + 2, ys, inst->nibbles->number);
 			}
 		}
 	}
 	/* Fix grid border artifacts */
-	uint8_t edgeColor = inst->nibbles.grid ? PAL_BUTTON2 : PAL_BCKGRND;
+	uint8_t edgeColor = inst->nibbles->grid ? PAL_BUTTON2 : PAL_BCKGRND;
 	vLine(video, 560, 7, 161, edgeColor);
 	hLine(video, 152, 168, 409, edgeColor);
 }
@@ -266,18 +266,18 @@ void ft2_nibbles_redraw(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_
 /* Check collision: wall (1-15) or screen edge (if wrap disabled) */
 static bool nibblesInvalid(ft2_instance_t *inst, int16_t x, int16_t y, int16_t d)
 {
-	if (!inst->nibbles.wrap)
+	if (!inst->nibbles->wrap)
 		if ((x == 0 && d == 0) || (x == 50 && d == 2) || (y == 0 && d == 3) || (y == 22 && d == 1))
 			return true;
 	if (x >= 0 && x < NIBBLES_SCREEN_W && y >= 0 && y < NIBBLES_SCREEN_H)
-		return inst->nibbles.screen[x][y] >= 1 && inst->nibbles.screen[x][y] <= 15;
+		return inst->nibbles->screen[x][y] >= 1 && inst->nibbles->screen[x][y] <= 15;
 	return true;
 }
 
 static void nibblesEraseNumber(ft2_instance_t *inst, ft2_video_t *video)
 {
-	if (!inst->nibbles.surround)
-		setNibbleDot(inst, video, (uint8_t)inst->nibbles.numberX, (uint8_t)inst->nibbles.numberY, 0);
+	if (!inst->nibbles->surround)
+		setNibbleDot(inst, video, (uint8_t)inst->nibbles->numberX, (uint8_t)inst->nibbles->numberY, 0);
 }
 
 /* Place next food number (1-9) at random empty position */
@@ -286,20 +286,20 @@ static void nibblesGenNewNumber(ft2_instance_t *inst, ft2_video_t *video, const
 	while (true) {
 		int16_t x = rand() % NIBBLES_SCREEN_W, y = rand() % NIBBLES_SCREEN_H;
 		/* Need empty cell (and cell below for number rendering) */
-		bool ok = inst->nibbles.screen[x][y] == 0;
-		if (y < NIBBLES_SCREEN_H - 1) ok = ok && inst->nibbles.screen[x][y + 1] == 0;
+		bool ok = inst->nibbles->screen[x][y] == 0;
+		if (y < NIBBLES_SCREEN_H - 1) ok = ok && inst->nibbles->screen[x][y + 1] == 0;
 		if (ok) {
-			inst->nibbles.number++;
-			inst->nibbles.screen[x][y] = (uint8_t)(16 + inst->nibbles.number);
-			inst->nibbles.numberX = x; inst->nibbles.numberY = y;
+			inst->nibbles->number++;
+			inst->nibbles->screen[x][y] = (uint8_t)(16 + inst->nibbles->number);
+			inst->nibbles->numberX = x; inst->nibbles->numberY = y;
 			const int16_t xs = 152 + (x * 8), ys = 7 + (y * 7);
-			if (inst->nibbles.grid) {
+			if (inst->nibbles->grid) {
 				fillRect(video, xs, ys, 8, 7, PAL_BUTTON2);
 				fillRect(video, xs + 1, ys + 1, 7, 6, PAL_BCKGRND);
 			} else {
 				fillRect(video, xs, ys, 8, 7, PAL_BCKGRND);
 			}
-			drawNibblesFoodNumber(video, bmp, (x * 8) + 154, (y * 7) + 7, inst->nibbles.number);
+			drawNibblesFoodNumber(video, bmp, (x * 8) + 154, (y * 7) + 7, inst->nibbles->number);
 			break;
 		}
 	}
@@ -307,30 +307,30 @@ static void nibblesGenNewNumber(ft2_instance_t *inst, ft2_video_t *video, const
 
 static void nibblesNewGame(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
-	nibblesCreateLevel(inst, inst->nibbles.level, bmp);
+	nibblesCreateLevel(inst, inst->nibbles->level, bmp);
 	nibblesRedrawScreen(inst, video, bmp);
-	setNibbleDot(inst, video, inst->nibbles.p1[0].x, inst->nibbles.p1[0].y, 6);
-	if (inst->nibbles.numPlayers == 1)
-		setNibbleDot(inst, video, inst->nibbles.p2[0].x, inst->nibbles.p2[0].y, 7);
-	if (!inst->nibbles.surround) nibblesGenNewNumber(inst, video, bmp);
+	setNibbleDot(inst, video, inst->nibbles->p1[0].x, inst->nibbles->p1[0].y, 6);
+	if (inst->nibbles->numPlayers == 1)
+		setNibbleDot(inst, video, inst->nibbles->p2[0].x, inst->nibbles->p2[0].y, 7);
+	if (!inst->nibbles->surround) nibblesGenNewNumber(inst, video, bmp);
 }
 
 static void nibblesNewLevel(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
 	char text[32];
-	snprintf(text, sizeof(text), "Level %d finished!", inst->nibbles.level + 1);
+	snprintf(text, sizeof(text), "Level %d finished!", inst->nibbles->level + 1);
 	nibblesShowMessage(inst, "Nibbles message", text);
 
 	/* Bonus: base + speed bonus. Cast to int16_t replicates original FT2 overflow bug. */
-	inst->nibbles.p1Score += 0x10000 + (int16_t)((12 - inst->nibbles.curSpeed) * 0x2000);
-	if (inst->nibbles.numPlayers == 1) inst->nibbles.p2Score += 0x10000;
+	inst->nibbles->p1Score += 0x10000 + (int16_t)((12 - inst->nibbles->curSpeed) * 0x2000);
+	if (inst->nibbles->numPlayers == 1) inst->nibbles->p2Score += 0x10000;
 
-	inst->nibbles.level++;
-	if (inst->nibbles.p1Lives < 99) inst->nibbles.p1Lives++;
-	if (inst->nibbles.numPlayers == 1 && inst->nibbles.p2Lives < 99) inst->nibbles.p2Lives++;
+	inst->nibbles->level++;
+	if (inst->nibbles->p1Lives < 99) inst->nibbles->p1Lives++;
+	if (inst->nibbles->numPlayers == 1 && inst->nibbles->p2Lives < 99) inst->nibbles->p2Lives++;
 
-	inst->nibbles.number = 0;
-	nibblesCreateLevel(inst, inst->nibbles.level, bmp);
+	inst->nibbles->number = 0;
+	nibblesCreateLevel(inst, inst->nibbles->level, bmp);
 	nibblesRedrawScreen(inst, video, bmp);
 	nibblesGenNewNumber(inst, video, bmp);
 }
@@ -339,10 +339,10 @@ static void nibblesNewLevel(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 
 static void nibblesDecLives(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp, int16_t l1, int16_t l2)
 {
-	if (!inst->nibbles.eternalLives)
+	if (!inst->nibbles->eternalLives)
 	{
-		inst->nibbles.p1Lives -= l1;
-		inst->nibbles.p2Lives -= l2;
+		inst->nibbles->p1Lives -= l1;
+		inst->nibbles->p2Lives -= l2;
 	}
 
 	drawScoresLives(inst, video, bmp);
@@ -354,46 +354,46 @@ static void nibblesDecLives(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 	else
 		nibblesShowMessage(inst, "Nibbles message", "Player 2 died!");
 
-	if (inst->nibbles.p1Lives == 0 || inst->nibbles.p2Lives == 0)
+	if (inst->nibbles->p1Lives == 0 || inst->nibbles->p2Lives == 0)
 	{
-		inst->nibbles.playing = false;
+		inst->nibbles->playing = false;
 		nibblesShowMessage(inst, "Nibbles message", "GAME OVER");
 
 		/* Prevent highscore table from showing overflowing level graphics */
-		if (inst->nibbles.level >= NIBBLES_MAX_LEVEL)
-			inst->nibbles.level = NIBBLES_MAX_LEVEL - 1;
+		if (inst->nibbles->level >= NIBBLES_MAX_LEVEL)
+			inst->nibbles->level = NIBBLES_MAX_LEVEL - 1;
 
 		/* Reset pending high score state */
-		inst->nibbles.pendingP1HighScore = false;
-		inst->nibbles.pendingP2HighScore = false;
-		inst->nibbles.pendingP1Slot = -1;
-		inst->nibbles.pendingP2Slot = -1;
+		inst->nibbles->pendingP1HighScore = false;
+		inst->nibbles->pendingP2HighScore = false;
+		inst->nibbles->pendingP1Slot = -1;
+		inst->nibbles->pendingP2Slot = -1;
 
 		/* Check if Player 1 has a high score */
-		if (inst->nibbles.p1Score > inst->nibbles.highScores[9].score)
+		if (inst->nibbles->p1Score > inst->nibbles->highScores[9].score)
 		{
 			int16_t i = 0;
-			while (inst->nibbles.p1Score <= inst->nibbles.highScores[i].score)
+			while (inst->nibbles->p1Score <= inst->nibbles->highScores[i].score)
 				i++;
 
 			/* Shift scores down to make room */
 			for (int16_t k = 8; k >= i; k--)
-				memcpy(&inst->nibbles.highScores[k + 1], &inst->nibbles.highScores[k], sizeof(ft2_nibbles_highscore_t));
+				memcpy(&inst->nibbles->highScores[k + 1], &inst->nibbles->highScores[k], sizeof(ft2_nibbles_highscore_t));
 
 			if (i == 0)
 				nibblesShowMessage(inst, "Nibbles message", "You've probably cheated!");
 
 			/* Store the slot for later, prefill with default name */
-			ft2_nibbles_highscore_t *h = &inst->nibbles.highScores[i];
+			ft2_nibbles_highscore_t *h = &inst->nibbles->highScores[i];
 			memset(h->name, 0, sizeof(h->name));
 			strcpy(h->name, "Unknown");
 			h->nameLen = 7;
-			h->score = inst->nibbles.p1Score;
-			h->level = inst->nibbles.level;
+			h->score = inst->nibbles->p1Score;
+			h->level = inst->nibbles->level;
 
 			/* Mark pending and show input dialog */
-			inst->nibbles.pendingP1HighScore = true;
-			inst->nibbles.pendingP1Slot = i;
+			inst->nibbles->pendingP1HighScore = true;
+			inst->nibbles->pendingP1Slot = i;
 
 			ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 			if (ui != NULL)
@@ -406,27 +406,27 @@ static void nibblesDecLives(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 		}
 
 		/* Check if Player 2 has a high score (only if P1 didn't) */
-		if (inst->nibbles.p2Score > inst->nibbles.highScores[9].score)
+		if (inst->nibbles->p2Score > inst->nibbles->highScores[9].score)
 		{
 			int16_t i = 0;
-			while (inst->nibbles.p2Score <= inst->nibbles.highScores[i].score)
+			while (inst->nibbles->p2Score <= inst->nibbles->highScores[i].score)
 				i++;
 
 			for (int16_t k = 8; k >= i; k--)
-				memcpy(&inst->nibbles.highScores[k + 1], &inst->nibbles.highScores[k], sizeof(ft2_nibbles_highscore_t));
+				memcpy(&inst->nibbles->highScores[k + 1], &inst->nibbles->highScores[k], sizeof(ft2_nibbles_highscore_t));
 
 			if (i == 0)
 				nibblesShowMessage(inst, "Nibbles message", "You've probably cheated!");
 
-			ft2_nibbles_highscore_t *h = &inst->nibbles.highScores[i];
+			ft2_nibbles_highscore_t *h = &inst->nibbles->highScores[i];
 			memset(h->name, 0, sizeof(h->name));
 			strcpy(h->name, "Unknown");
 			h->nameLen = 7;
-			h->score = inst->nibbles.p2Score;
-			h->level = inst->nibbles.level;
+			h->score = inst->nibbles->p2Score;
+			h->level = inst->nibbles->level;
 
-			inst->nibbles.pendingP2HighScore = true;
-			inst->nibbles.pendingP2Slot = i;
+			inst->nibbles->pendingP2HighScore = true;
+			inst->nibbles->pendingP2Slot = i;
 
 			ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 			if (ui != NULL)
@@ -443,7 +443,7 @@ static void nibblesDecLives(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 	}
 	else
 	{
-		inst->nibbles.playing = true;
+		inst->nibbles->playing = true;
 		nibblesNewGame(inst, video, bmp);
 	}
 }
@@ -452,29 +452,29 @@ static void nibblesDecLives(ft2_instance_t *inst, ft2_video_t *video, const ft2_
 static void onP1HighScoreNameEntered(ft2_instance_t *inst, ft2_dialog_result_t result, const char *inputText, void *userData)
 {
 	(void)userData;
-	if (inst->nibbles.pendingP1HighScore && inst->nibbles.pendingP1Slot >= 0) {
-		ft2_nibbles_highscore_t *h = &inst->nibbles.highScores[inst->nibbles.pendingP1Slot];
+	if (inst->nibbles->pendingP1HighScore && inst->nibbles->pendingP1Slot >= 0) {
+		ft2_nibbles_highscore_t *h = &inst->nibbles->highScores[inst->nibbles->pendingP1Slot];
 		if (result == DIALOG_RESULT_OK && inputText && inputText[0]) {
 			size_t len = strlen(inputText); if (len > 21) len = 21;
 			memset(h->name, 0, sizeof(h->name));
 			memcpy(h->name, inputText, len);
 			h->nameLen = (uint8_t)len;
 		}
-		inst->nibbles.pendingP1HighScore = false;
-		inst->nibbles.pendingP1Slot = -1;
+		inst->nibbles->pendingP1HighScore = false;
+		inst->nibbles->pendingP1Slot = -1;
 	}
 
 	/* Check P2 high score */
-	if (inst->nibbles.p2Score > inst->nibbles.highScores[9].score) {
+	if (inst->nibbles->p2Score > inst->nibbles->highScores[9].score) {
 		int16_t i = 0;
-		while (inst->nibbles.p2Score <= inst->nibbles.highScores[i].score) i++;
+		while (inst->nibbles->p2Score <= inst->nibbles->highScores[i].score) i++;
 		for (int16_t k = 8; k >= i; k--)
-			memcpy(&inst->nibbles.highScores[k + 1], &inst->nibbles.highScores[k], sizeof(ft2_nibbles_highscore_t));
+			memcpy(&inst->nibbles->highScores[k + 1], &inst->nibbles->highScores[k], sizeof(ft2_nibbles_highscore_t));
 		if (i == 0) nibblesShowMessage(inst, "Nibbles message", "You've probably cheated!");
-		ft2_nibbles_highscore_t *h = &inst->nibbles.highScores[i];
+		ft2_nibbles_highscore_t *h = &inst->nibbles->highScores[i];
 		memset(h->name, 0, sizeof(h->name)); strcpy(h->name, "Unknown"); h->nameLen = 7;
-		h->score = inst->nibbles.p2Score; h->level = inst->nibbles.level;
-		inst->nibbles.pendingP2HighScore = true; inst->nibbles.pendingP2Slot = i;
+		h->score = inst->nibbles->p2Score; h->level = inst->nibbles->level;
+		inst->nibbles->pendingP2HighScore = true; inst->nibbles->pendingP2Slot = i;
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 		if (ui) ft2_dialog_show_input_cb(&ui->dialog, "Player 2 - Enter your name:", "", "Unknown", 21, inst, onP2HighScoreNameEntered, NULL);
 		return;
@@ -486,16 +486,16 @@ static void onP1HighScoreNameEntered(ft2_instance_t *inst, ft2_dialog_result_t r
 static void onP2HighScoreNameEntered(ft2_instance_t *inst, ft2_dialog_result_t result, const char *inputText, void *userData)
 {
 	(void)userData;
-	if (inst->nibbles.pendingP2HighScore && inst->nibbles.pendingP2Slot >= 0) {
-		ft2_nibbles_highscore_t *h = &inst->nibbles.highScores[inst->nibbles.pendingP2Slot];
+	if (inst->nibbles->pendingP2HighScore && inst->nibbles->pendingP2Slot >= 0) {
+		ft2_nibbles_highscore_t *h = &inst->nibbles->highScores[inst->nibbles->pendingP2Slot];
 		if (result == DIALOG_RESULT_OK && inputText && inputText[0]) {
 			size_t len = strlen(inputText); if (len > 21) len = 21;
 			memset(h->name, 0, sizeof(h->name));
 			memcpy(h->name, inputText, len);
 			h->nameLen = (uint8_t)len;
 		}
-		inst->nibbles.pendingP2HighScore = false;
-		inst->nibbles.pendingP2Slot = -1;
+		inst->nibbles->pendingP2HighScore = false;
+		inst->nibbles->pendingP2Slot = -1;
 	}
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 	if (ui) ft2_nibbles_show_highscores(inst, &ui->video, ui->bmpLoaded ? &ui->bmp : NULL);
@@ -505,7 +505,7 @@ static void onRestartGameConfirm(ft2_instance_t *inst, ft2_dialog_result_t resul
 {
 	(void)inputText; (void)userData;
 	if (result == DIALOG_RESULT_YES) {
-		inst->nibbles.playing = false;
+		inst->nibbles->playing = false;
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 		if (ui) ft2_nibbles_play(inst, &ui->video, ui->bmpLoaded ? &ui->bmp : NULL);
 	}
@@ -515,7 +515,7 @@ static void onQuitGameConfirm(ft2_instance_t *inst, ft2_dialog_result_t result,
 {
 	(void)inputText; (void)userData;
 	if (result == DIALOG_RESULT_YES) {
-		inst->nibbles.playing = false;
+		inst->nibbles->playing = false;
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 		if (ui) ft2_nibbles_exit(inst, &ui->video, ui->bmpLoaded ? &ui->bmp : NULL);
 	}
@@ -528,16 +528,16 @@ static void onQuitGameConfirm(ft2_instance_t *inst, ft2_dialog_result_t result,
 
 void ft2_nibbles_init(ft2_instance_t *inst)
 {
-	memset(&inst->nibbles, 0, sizeof(ft2_nibbles_state_t));
-	inst->nibbles.speed = 0;
-	inst->nibbles.numPlayers = 0;
-	inst->nibbles.grid = true;
+	memset(inst->nibbles, 0, sizeof(ft2_nibbles_state_t));
+	inst->nibbles->speed = 0;
+	inst->nibbles->numPlayers = 0;
+	inst->nibbles->grid = true;
 	ft2_nibbles_load_default_highscores(inst);
 }
 
 void ft2_nibbles_load_default_highscores(ft2_instance_t *inst)
 {
-	memcpy(inst->nibbles.highScores, defaultHighScores, sizeof(defaultHighScores));
+	memcpy(inst->nibbles->highScores, defaultHighScores, sizeof(defaultHighScores));
 }
 
 void ft2_nibbles_show(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
@@ -590,19 +590,19 @@ void ft2_nibbles_show(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	showPushButton(widgets, video, bmp, PB_NIBBLES_HIGHS);
 	showPushButton(widgets, video, bmp, PB_NIBBLES_EXIT);
 
-	widgets->checkBoxChecked[CB_NIBBLES_SURROUND] = inst->nibbles.surround;
-	widgets->checkBoxChecked[CB_NIBBLES_GRID] = inst->nibbles.grid;
-	widgets->checkBoxChecked[CB_NIBBLES_WRAP] = inst->nibbles.wrap;
+	widgets->checkBoxChecked[CB_NIBBLES_SURROUND] = inst->nibbles->surround;
+	widgets->checkBoxChecked[CB_NIBBLES_GRID] = inst->nibbles->grid;
+	widgets->checkBoxChecked[CB_NIBBLES_WRAP] = inst->nibbles->wrap;
 	showCheckBox(widgets, video, bmp, CB_NIBBLES_SURROUND);
 	showCheckBox(widgets, video, bmp, CB_NIBBLES_GRID);
 	showCheckBox(widgets, video, bmp, CB_NIBBLES_WRAP);
 
 	uncheckRadioButtonGroup(widgets, RB_GROUP_NIBBLES_PLAYERS);
-	widgets->radioButtonState[inst->nibbles.numPlayers == 0 ? RB_NIBBLES_1PLAYER : RB_NIBBLES_2PLAYER] = RADIOBUTTON_CHECKED;
+	widgets->radioButtonState[inst->nibbles->numPlayers == 0 ? RB_NIBBLES_1PLAYER : RB_NIBBLES_2PLAYER] = RADIOBUTTON_CHECKED;
 	showRadioButtonGroup(widgets, video, bmp, RB_GROUP_NIBBLES_PLAYERS);
 
 	uncheckRadioButtonGroup(widgets, RB_GROUP_NIBBLES_DIFFICULTY);
-	int rb = RB_NIBBLES_NOVICE + inst->nibbles.speed;
+	int rb = RB_NIBBLES_NOVICE + inst->nibbles->speed;
 	if (rb > RB_NIBBLES_TRITON) rb = RB_NIBBLES_NOVICE;
 	widgets->radioButtonState[rb] = RADIOBUTTON_CHECKED;
 	showRadioButtonGroup(widgets, video, bmp, RB_GROUP_NIBBLES_DIFFICULTY);
@@ -633,7 +633,7 @@ void ft2_nibbles_hide(ft2_instance_t *inst)
 void ft2_nibbles_exit(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
 	(void)video; (void)bmp;
-	if (inst->nibbles.playing) {
+	if (inst->nibbles->playing) {
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 		if (ui) ft2_dialog_show_yesno_cb(&ui->dialog, "System request", "Quit current game of Nibbles?", inst, onQuitGameConfirm, NULL);
 		return;
@@ -648,34 +648,34 @@ void ft2_nibbles_exit(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 
 void ft2_nibbles_play(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
-	if (inst->nibbles.playing) {
+	if (inst->nibbles->playing) {
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 		if (ui) ft2_dialog_show_yesno_cb(&ui->dialog, "Nibbles request", "Restart current game of Nibbles?", inst, onRestartGameConfirm, NULL);
 		return;
 	}
-	if (inst->nibbles.surround && inst->nibbles.numPlayers == 0) {
+	if (inst->nibbles->surround && inst->nibbles->numPlayers == 0) {
 		nibblesShowMessage(inst, "Nibbles message", "Surround mode is not appropriate in one-player mode.");
 		return;
 	}
 	if (wallColorsAreCloseToBlack(video))
 		nibblesShowMessage(inst, "Nibbles warning", "The Desktop/Button colors are set to values that make the walls hard to see!");
 
-	inst->nibbles.curSpeed = nibblesSpeedTable[inst->nibbles.speed];
-	inst->nibbles.curSpeed60Hz = (uint8_t)SCALE_VBLANK_DELTA_REV(inst->nibbles.curSpeed);
-	inst->nibbles.curTick60Hz = (uint8_t)SCALE_VBLANK_DELTA_REV(nibblesSpeedTable[2]);
+	inst->nibbles->curSpeed = nibblesSpeedTable[inst->nibbles->speed];
+	inst->nibbles->curSpeed60Hz = (uint8_t)SCALE_VBLANK_DELTA_REV(inst->nibbles->curSpeed);
+	inst->nibbles->curTick60Hz = (uint8_t)SCALE_VBLANK_DELTA_REV(nibblesSpeedTable[2]);
 	inst->uiState.nibblesHelpShown = false;
 	inst->uiState.nibblesHighScoresShown = false;
 
-	inst->nibbles.playing = true;
-	inst->nibbles.p1Score = inst->nibbles.p2Score = 0;
-	inst->nibbles.p1Lives = inst->nibbles.p2Lives = 5;
-	inst->nibbles.level = 0;
+	inst->nibbles->playing = true;
+	inst->nibbles->p1Score = inst->nibbles->p2Score = 0;
+	inst->nibbles->p1Lives = inst->nibbles->p2Lives = 5;
+	inst->nibbles->level = 0;
 	nibblesNewGame(inst, video, bmp);
 }
 
 void ft2_nibbles_show_highscores(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
-	if (inst->nibbles.playing) {
+	if (inst->nibbles->playing) {
 		nibblesShowMessage(inst, "Nibbles message", "The highscore table is not available during play.");
 		return;
 	}
@@ -685,18 +685,18 @@ void ft2_nibbles_show_highscores(ft2_instance_t *inst, ft2_video_t *video, const
 	clearRect(video, 152, 7, 409, 162);
 	bigTextOut(video, bmp, 160, 10, PAL_FORGRND, "Fasttracker Nibbles Highscore");
 	for (int16_t i = 0; i < 5; i++) {
-		highScoreTextOutClipX(video, bmp, 160, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles.highScores[i].name, 230);
-		hexOutShadow(video, bmp, 236, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles.highScores[i].score, 8);
-		nibbleWriteLevelSprite(video, bmp, 296, 33 + (26 * i), inst->nibbles.highScores[i].level);
-		highScoreTextOutClipX(video, bmp, 360, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles.highScores[i + 5].name, 430);
-		hexOutShadow(video, bmp, 436, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles.highScores[i + 5].score, 8);
-		nibbleWriteLevelSprite(video, bmp, 496, 33 + (26 * i), inst->nibbles.highScores[i + 5].level);
+		highScoreTextOutClipX(video, bmp, 160, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles->highScores[i].name, 230);
+		hexOutShadow(video, bmp, 236, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles->highScores[i].score, 8);
+		nibbleWriteLevelSprite(video, bmp, 296, 33 + (26 * i), inst->nibbles->highScores[i].level);
+		highScoreTextOutClipX(video, bmp, 360, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles->highScores[i + 5].name, 430);
+		hexOutShadow(video, bmp, 436, 42 + (26 * i), PAL_FORGRND, PAL_DSKTOP2, inst->nibbles->highScores[i + 5].score, 8);
+		nibbleWriteLevelSprite(video, bmp, 496, 33 + (26 * i), inst->nibbles->highScores[i + 5].level);
 	}
 }
 
 void ft2_nibbles_show_help(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
-	if (inst->nibbles.playing) {
+	if (inst->nibbles->playing) {
 		nibblesShowMessage(inst, "System message", "Help is not available during play.");
 		return;
 	}
@@ -713,71 +713,71 @@ void ft2_nibbles_show_help(ft2_instance_t *inst, ft2_video_t *video, const ft2_b
 
 void ft2_nibbles_tick(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t *bmp)
 {
-	if (!inst->nibbles.playing || inst->uiState.sysReqShown) return;
+	if (!inst->nibbles->playing || inst->uiState.sysReqShown) return;
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
 	if (ui && ft2_dialog_is_active(&ui->dialog)) return;
-	if (--inst->nibbles.curTick60Hz != 0) return;
+	if (--inst->nibbles->curTick60Hz != 0) return;
 
 	/* Process queued direction changes (can't reverse into self) */
 	if (nibblesBufferFull(inst, 0)) {
 		int16_t d = nibblesGetBuffer(inst, 0);
-		if (d >= 0 && d != ((inst->nibbles.p1Dir + 2) & 3)) inst->nibbles.p1Dir = (uint8_t)d;
+		if (d >= 0 && d != ((inst->nibbles->p1Dir + 2) & 3)) inst->nibbles->p1Dir = (uint8_t)d;
 	}
 	if (nibblesBufferFull(inst, 1)) {
 		int16_t d = nibblesGetBuffer(inst, 1);
-		if (d >= 0 && d != ((inst->nibbles.p2Dir + 2) & 3)) inst->nibbles.p2Dir = (uint8_t)d;
+		if (d >= 0 && d != ((inst->nibbles->p2Dir + 2) & 3)) inst->nibbles->p2Dir = (uint8_t)d;
 	}
 
 	/* Shift snake body, move head */
-	memmove(&inst->nibbles.p1[1], &inst->nibbles.p1[0], 255 * sizeof(ft2_nibbles_coord_t));
-	if (inst->nibbles.numPlayers == 1)
-		memmove(&inst->nibbles.p2[1], &inst->nibbles.p2[0], 255 * sizeof(ft2_nibbles_coord_t));
-
-	switch (inst->nibbles.p1Dir) {
-		case 0: inst->nibbles.p1[0].x++; break;
-		case 1: inst->nibbles.p1[0].y--; break;
-		case 2: inst->nibbles.p1[0].x--; break;
-		case 3: inst->nibbles.p1[0].y++; break;
-	}
-	if (inst->nibbles.numPlayers == 1) {
-		switch (inst->nibbles.p2Dir) {
-			case 0: inst->nibbles.p2[0].x++; break;
-			case 1: inst->nibbles.p2[0].y--; break;
-			case 2: inst->nibbles.p2[0].x--; break;
-			case 3: inst->nibbles.p2[0].y++; break;
+	memmove(&inst->nibbles->p1[1], &inst->nibbles->p1[0], 255 * sizeof(ft2_nibbles_coord_t));
+	if (inst->nibbles->numPlayers == 1)
+		memmove(&inst->nibbles->p2[1], &inst->nibbles->p2[0], 255 * sizeof(ft2_nibbles_coord_t));
+
+	switch (inst->nibbles->p1Dir) {
+		case 0: inst->nibbles->p1[0].x++; break;
+		case 1: inst->nibbles->p1[0].y--; break;
+		case 2: inst->nibbles->p1[0].x--; break;
+		case 3: inst->nibbles->p1[0].y++; break;
+	}
+	if (inst->nibbles->numPlayers == 1) {
+		switch (inst->nibbles->p2Dir) {
+			case 0: inst->nibbles->p2[0].x++; break;
+			case 1: inst->nibbles->p2[0].y--; break;
+			case 2: inst->nibbles->p2[0].x--; break;
+			case 3: inst->nibbles->p2[0].y++; break;
 		}
 	}
 
 	/* Wrap at edges (uint8_t underflow handled) */
-	if (inst->nibbles.p1[0].x == 255) inst->nibbles.p1[0].x = 50;
-	if (inst->nibbles.p2[0].x == 255) inst->nibbles.p2[0].x = 50;
-	if (inst->nibbles.p1[0].y == 255) inst->nibbles.p1[0].y = 22;
-	if (inst->nibbles.p2[0].y == 255) inst->nibbles.p2[0].y = 22;
-	inst->nibbles.p1[0].x %= NIBBLES_SCREEN_W;
-	inst->nibbles.p1[0].y %= NIBBLES_SCREEN_H;
-	inst->nibbles.p2[0].x %= NIBBLES_SCREEN_W;
-	inst->nibbles.p2[0].y %= NIBBLES_SCREEN_H;
+	if (inst->nibbles->p1[0].x == 255) inst->nibbles->p1[0].x = 50;
+	if (inst->nibbles->p2[0].x == 255) inst->nibbles->p2[0].x = 50;
+	if (inst->nibbles->p1[0].y == 255) inst->nibbles->p1[0].y = 22;
+	if (inst->nibbles->p2[0].y == 255) inst->nibbles->p2[0].y = 22;
+	inst->nibbles->p1[0].x %= NIBBLES_SCREEN_W;
+	inst->nibbles->p1[0].y %= NIBBLES_SCREEN_H;
+	inst->nibbles->p2[0].x %= NIBBLES_SCREEN_W;
+	inst->nibbles->p2[0].y %= NIBBLES_SCREEN_H;
 
 	/* Check collisions */
-	if (inst->nibbles.numPlayers == 1)
+	if (inst->nibbles->numPlayers == 1)
 	{
-		if (nibblesInvalid(inst, inst->nibbles.p1[0].x, inst->nibbles.p1[0].y, inst->nibbles.p1Dir) &&
-		    nibblesInvalid(inst, inst->nibbles.p2[0].x, inst->nibbles.p2[0].y, inst->nibbles.p2Dir))
+		if (nibblesInvalid(inst, inst->nibbles->p1[0].x, inst->nibbles->p1[0].y, inst->nibbles->p1Dir) &&
+		    nibblesInvalid(inst, inst->nibbles->p2[0].x, inst->nibbles->p2[0].y, inst->nibbles->p2Dir))
 		{
 			nibblesDecLives(inst, video, bmp, 1, 1);
 			goto NoMove;
 		}
-		else if (nibblesInvalid(inst, inst->nibbles.p1[0].x, inst->nibbles.p1[0].y, inst->nibbles.p1Dir))
+		else if (nibblesInvalid(inst, inst->nibbles->p1[0].x, inst->nibbles->p1[0].y, inst->nibbles->p1Dir))
 		{
 			nibblesDecLives(inst, video, bmp, 1, 0);
 			goto NoMove;
 		}
-		else if (nibblesInvalid(inst, inst->nibbles.p2[0].x, inst->nibbles.p2[0].y, inst->nibbles.p2Dir))
+		else if (nibblesInvalid(inst, inst->nibbles->p2[0].x, inst->nibbles->p2[0].y, inst->nibbles->p2Dir))
 		{
 			nibblesDecLives(inst, video, bmp, 0, 1);
 			goto NoMove;
 		}
-		else if (inst->nibbles.p1[0].x == inst->nibbles.p2[0].x && inst->nibbles.p1[0].y == inst->nibbles.p2[0].y)
+		else if (inst->nibbles->p1[0].x == inst->nibbles->p2[0].x && inst->nibbles->p1[0].y == inst->nibbles->p2[0].y)
 		{
 			nibblesDecLives(inst, video, bmp, 1, 1);
 			goto NoMove;
@@ -785,7 +785,7 @@ void ft2_nibbles_tick(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	}
 	else
 	{
-		if (nibblesInvalid(inst, inst->nibbles.p1[0].x, inst->nibbles.p1[0].y, inst->nibbles.p1Dir))
+		if (nibblesInvalid(inst, inst->nibbles->p1[0].x, inst->nibbles->p1[0].y, inst->nibbles->p1Dir))
 		{
 			nibblesDecLives(inst, video, bmp, 1, 0);
 			goto NoMove;
@@ -794,74 +794,74 @@ void ft2_nibbles_tick(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 
 	/* Check for food pickup */
 	int16_t j = 0;
-	int16_t i = inst->nibbles.screen[inst->nibbles.p1[0].x][inst->nibbles.p1[0].y];
+	int16_t i = inst->nibbles->screen[inst->nibbles->p1[0].x][inst->nibbles->p1[0].y];
 	if (i >= 16)
 	{
-		inst->nibbles.p1Score += (i & 15) * 999 * (inst->nibbles.level + 1);
+		inst->nibbles->p1Score += (i & 15) * 999 * (inst->nibbles->level + 1);
 		nibblesEraseNumber(inst, video);
 		j = 1;
-		inst->nibbles.p1NoClear = inst->nibbles.p1Len >> 1;
+		inst->nibbles->p1NoClear = inst->nibbles->p1Len >> 1;
 	}
 
-	if (inst->nibbles.numPlayers == 1)
+	if (inst->nibbles->numPlayers == 1)
 	{
-		i = inst->nibbles.screen[inst->nibbles.p2[0].x][inst->nibbles.p2[0].y];
+		i = inst->nibbles->screen[inst->nibbles->p2[0].x][inst->nibbles->p2[0].y];
 		if (i >= 16)
 		{
-			inst->nibbles.p2Score += (i & 15) * 999 * (inst->nibbles.level + 1);
+			inst->nibbles->p2Score += (i & 15) * 999 * (inst->nibbles->level + 1);
 			nibblesEraseNumber(inst, video);
 			j = 1;
-			inst->nibbles.p2NoClear = inst->nibbles.p2Len >> 1;
+			inst->nibbles->p2NoClear = inst->nibbles->p2Len >> 1;
 		}
 	}
 
 	/* Score decay */
-	inst->nibbles.p1Score -= 17;
-	if (inst->nibbles.numPlayers == 1)
-		inst->nibbles.p2Score -= 17;
+	inst->nibbles->p1Score -= 17;
+	if (inst->nibbles->numPlayers == 1)
+		inst->nibbles->p2Score -= 17;
 
-	if (inst->nibbles.p1Score < 0) inst->nibbles.p1Score = 0;
-	if (inst->nibbles.p2Score < 0) inst->nibbles.p2Score = 0;
+	if (inst->nibbles->p1Score < 0) inst->nibbles->p1Score = 0;
+	if (inst->nibbles->p2Score < 0) inst->nibbles->p2Score = 0;
 
 	/* Clear tail */
-	if (!inst->nibbles.surround)
+	if (!inst->nibbles->surround)
 	{
-		if (inst->nibbles.p1NoClear > 0 && inst->nibbles.p1Len < 255)
+		if (inst->nibbles->p1NoClear > 0 && inst->nibbles->p1Len < 255)
 		{
-			inst->nibbles.p1NoClear--;
-			inst->nibbles.p1Len++;
+			inst->nibbles->p1NoClear--;
+			inst->nibbles->p1Len++;
 		}
 		else
 		{
-			setNibbleDot(inst, video, inst->nibbles.p1[inst->nibbles.p1Len].x, inst->nibbles.p1[inst->nibbles.p1Len].y, 0);
+			setNibbleDot(inst, video, inst->nibbles->p1[inst->nibbles->p1Len].x, inst->nibbles->p1[inst->nibbles->p1Len].y, 0);
 		}
 
-		if (inst->nibbles.numPlayers == 1)
+		if (inst->nibbles->numPlayers == 1)
 		{
-			if (inst->nibbles.p2NoClear > 0 && inst->nibbles.p2Len < 255)
+			if (inst->nibbles->p2NoClear > 0 && inst->nibbles->p2Len < 255)
 			{
-				inst->nibbles.p2NoClear--;
-				inst->nibbles.p2Len++;
+				inst->nibbles->p2NoClear--;
+				inst->nibbles->p2Len++;
 			}
 			else
 			{
-				setNibbleDot(inst, video, inst->nibbles.p2[inst->nibbles.p2Len].x, inst->nibbles.p2[inst->nibbles.p2Len].y, 0);
+				setNibbleDot(inst, video, inst->nibbles->p2[inst->nibbles->p2Len].x, inst->nibbles->p2[inst->nibbles->p2Len].y, 0);
 			}
 		}
 	}
 
 	/* Draw heads */
-	setNibbleDot(inst, video, inst->nibbles.p1[0].x, inst->nibbles.p1[0].y, 6);
-	if (inst->nibbles.numPlayers == 1)
-		setNibbleDot(inst, video, inst->nibbles.p2[0].x, inst->nibbles.p2[0].y, 5);
+	setNibbleDot(inst, video, inst->nibbles->p1[0].x, inst->nibbles->p1[0].y, 6);
+	if (inst->nibbles->numPlayers == 1)
+		setNibbleDot(inst, video, inst->nibbles->p2[0].x, inst->nibbles->p2[0].y, 5);
 
 	/* Check for level complete */
-	if (j == 1 && !inst->nibbles.surround)
+	if (j == 1 && !inst->nibbles->surround)
 	{
-		if (inst->nibbles.number == 9)
+		if (inst->nibbles->number == 9)
 		{
 			nibblesNewLevel(inst, video, bmp);
-			inst->nibbles.curTick60Hz = inst->nibbles.curSpeed60Hz;
+			inst->nibbles->curTick60Hz = inst->nibbles->curSpeed60Hz;
 			return;
 		}
 
@@ -869,7 +869,7 @@ void ft2_nibbles_tick(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	}
 
 NoMove:
-	inst->nibbles.curTick60Hz = inst->nibbles.curSpeed60Hz;
+	inst->nibbles->curTick60Hz = inst->nibbles->curSpeed60Hz;
 	drawScoresLives(inst, video, bmp);
 }
 
@@ -882,7 +882,7 @@ void ft2_nibbles_add_input(ft2_instance_t *inst, int16_t playerNum, uint8_t dire
 
 bool ft2_nibbles_handle_key(ft2_instance_t *inst, int32_t keyCode)
 {
-	if (!inst->nibbles.playing) return false;
+	if (!inst->nibbles->playing) return false;
 
 	if (keyCode == 27) {
 		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
@@ -913,23 +913,23 @@ bool ft2_nibbles_test_cheat(ft2_instance_t *inst, int32_t keyCode,
 {
 	if (!shiftPressed || !ctrlPressed || !altPressed) return false;
 
-	const char *code = inst->nibbles.playing ? nibblesCheatCode1 : nibblesCheatCode2;
-	uint8_t codeLen = inst->nibbles.playing ? sizeof(nibblesCheatCode1) - 1 : sizeof(nibblesCheatCode2) - 1;
+	const char *code = inst->nibbles->playing ? nibblesCheatCode1 : nibblesCheatCode2;
+	uint8_t codeLen = inst->nibbles->playing ? sizeof(nibblesCheatCode1) - 1 : sizeof(nibblesCheatCode2) - 1;
 
-	inst->nibbles.cheatBuffer[inst->nibbles.cheatIndex] = (char)keyCode;
-	if (inst->nibbles.cheatBuffer[inst->nibbles.cheatIndex] != code[inst->nibbles.cheatIndex]) {
-		inst->nibbles.cheatIndex = 0;
+	inst->nibbles->cheatBuffer[inst->nibbles->cheatIndex] = (char)keyCode;
+	if (inst->nibbles->cheatBuffer[inst->nibbles->cheatIndex] != code[inst->nibbles->cheatIndex]) {
+		inst->nibbles->cheatIndex = 0;
 		return true;
 	}
 
-	if (++inst->nibbles.cheatIndex == codeLen) {
-		inst->nibbles.cheatIndex = 0;
-		if (inst->nibbles.playing) {
+	if (++inst->nibbles->cheatIndex == codeLen) {
+		inst->nibbles->cheatIndex = 0;
+		if (inst->nibbles->playing) {
 			nibblesNewLevel(inst, video, bmp);
 		} else {
-			inst->nibbles.eternalLives = !inst->nibbles.eternalLives;
+			inst->nibbles->eternalLives = !inst->nibbles->eternalLives;
 			nibblesShowMessage(inst, "Triton productions declares:",
-				inst->nibbles.eternalLives ? "Eternal lives activated!" : "Eternal lives deactivated!");
+				inst->nibbles->eternalLives ? "Eternal lives activated!" : "Eternal lives deactivated!");
 		}
 	}
 	return true;
@@ -946,7 +946,7 @@ void rbNibbles1Player(ft2_instance_t *inst)
 {
 	if (!inst) return;
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-	inst->nibbles.numPlayers = 0;
+	inst->nibbles->numPlayers = 0;
 	if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_1PLAYER);
 }
 
@@ -954,37 +954,37 @@ void rbNibbles2Players(ft2_instance_t *inst)
 {
 	if (!inst) return;
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-	inst->nibbles.numPlayers = 1;
+	inst->nibbles->numPlayers = 1;
 	if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_2PLAYER);
 }
 
-void rbNibblesNovice(ft2_instance_t *inst)  { if (!inst) return; inst->nibbles.speed = 0; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_NOVICE); }
-void rbNibblesAverage(ft2_instance_t *inst) { if (!inst) return; inst->nibbles.speed = 1; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_AVERAGE); }
-void rbNibblesPro(ft2_instance_t *inst)     { if (!inst) return; inst->nibbles.speed = 2; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_PRO); }
-void rbNibblesTriton(ft2_instance_t *inst)  { if (!inst) return; inst->nibbles.speed = 3; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_TRITON); }
+void rbNibblesNovice(ft2_instance_t *inst)  { if (!inst) return; inst->nibbles->speed = 0; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_NOVICE); }
+void rbNibblesAverage(ft2_instance_t *inst) { if (!inst) return; inst->nibbles->speed = 1; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_AVERAGE); }
+void rbNibblesPro(ft2_instance_t *inst)     { if (!inst) return; inst->nibbles->speed = 2; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_PRO); }
+void rbNibblesTriton(ft2_instance_t *inst)  { if (!inst) return; inst->nibbles->speed = 3; ft2_ui_t *ui = (ft2_ui_t*)inst->ui; if (ui) checkRadioButtonNoRedraw(&ui->widgets, RB_NIBBLES_TRITON); }
 
 void cbNibblesSurround(ft2_instance_t *inst)
 {
 	if (!inst) return;
-	inst->nibbles.surround = !inst->nibbles.surround;
+	inst->nibbles->surround = !inst->nibbles->surround;
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-	if (ui) ui->widgets.checkBoxChecked[CB_NIBBLES_SURROUND] = inst->nibbles.surround;
+	if (ui) ui->widgets.checkBoxChecked[CB_NIBBLES_SURROUND] = inst->nibbles->surround;
 }
 
 void cbNibblesGrid(ft2_instance_t *inst)
 {
 	if (!inst) return;
-	inst->nibbles.grid = !inst->nibbles.grid;
+	inst->nibbles->grid = !inst->nibbles->grid;
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-	if (ui) ui->widgets.checkBoxChecked[CB_NIBBLES_GRID] = inst->nibbles.grid;
-	inst->uiState.nibblesRedrawRequested = inst->nibbles.playing;
+	if (ui) ui->widgets.checkBoxChecked[CB_NIBBLES_GRID] = inst->nibbles->grid;
+	inst->uiState.nibblesRedrawRequested = inst->nibbles->playing;
 }
 
 void cbNibblesWrap(ft2_instance_t *inst)
 {
 	if (!inst) return;
-	inst->nibbles.wrap = !inst->nibbles.wrap;
+	inst->nibbles->wrap = !inst->nibbles->wrap;
 	ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-	if (ui) ui->widgets.checkBoxChecked[CB_NIBBLES_WRAP] = inst->nibbles.wrap;
+	if (ui) ui->widgets.checkBoxChecked[CB_NIBBLES_WRAP] = inst->nibbles->wrap;
 }
 
@@ -0,0 +1,79 @@
+/**
+ * @file ft2_plugin_output.c
+ * @brief Output stages: gain and clamp of the mixed buffers, and the sum
+ * of the multi-out buffers into the main output.
+ */
+
+#include "ft2_plugin_output.h"
+#include "ft2_plugin_simd.h"
+
+/* Same result as min(max(x, -1), 1) for everything but NaN, which the
+ * mixer doesn't make */
+static inline float clampSample(float x)
+{
+	if (x < -1.0f) return -1.0f;
+	if (x > 1.0f) return 1.0f;
+	return x;
+}
+
+void ft2_output_scale_clamp(float *dst, const float *src, float mul, uint32_t n)
+{
+	uint32_t i = 0;
+
+#if defined(FT2_SIMD_SSE2)
+	const __m128 vMul = _mm_set1_ps(mul), vLo = _mm_set1_ps(-1.0f), vHi = _mm_set1_ps(1.0f);
+	for (; i + 8 <= n; i += 8) {
+		const __m128 a = _mm_mul_ps(_mm_loadu_ps(&src[i]), vMul);
+		const __m128 b = _mm_mul_ps(_mm_loadu_ps(&src[i + 4]), vMul);
+		_mm_storeu_ps(&dst[i], _mm_min_ps(_mm_max_ps(a, vLo), vHi));
+		_mm_storeu_ps(&dst[i + 4], _mm_min_ps(_mm_max_ps(b, vLo), vHi));
+	}
+#elif defined(FT2_SIMD_NEON)
+	const float32x4_t vLo = vdupq_n_f32(-1.0f), vHi = vdupq_n_f32(1.0f);
+	for (; i + 8 <= n; i += 8) {
+		const float32x4_t a = vmulq_n_f32(vld1q_f32(&src[i]), mul);
+		const float32x4_t b = vmulq_n_f32(vld1q_f32(&src[i + 4]), mul);
+		vst1q_f32(&dst[i], vminq_f32(vmaxq_f32(a, vLo), vHi));
+		vst1q_f32(&dst[i + 4], vminq_f32(vmaxq_f32(b, vLo), vHi));
+	}
+#endif
+
+	for (; i < n; i++)
+		dst[i] = clampSample(src[i] * mul);
+}
+
+void ft2_output_sum_scale_clamp(float *dst, const float *const *srcs, int32_t numSrcs, float mul, uint32_t n)
+{
+	uint32_t i = 0;
+
+#if defined(FT2_SIMD_SSE2)
+	const __m128 vMul = _mm_set1_ps(mul), vLo = _mm_set1_ps(-1.0f), vHi = _mm_set1_ps(1.0f);
+	for (; i + 8 <= n; i += 8) {
+		__m128 a = _mm_setzero_ps(), b = _mm_setzero_ps();
+		for (int32_t s = 0; s < numSrcs; s++) {
+			a = _mm_add_ps(a, _mm_loadu_ps(&srcs[s][i]));
+			b = _mm_add_ps(b, _mm_loadu_ps(&srcs[s][i + 4]));
+		}
+		_mm_storeu_ps(&dst[i], _mm_min_ps(_mm_max_ps(_mm_mul_ps(a, vMul), vLo), vHi));
+		_mm_storeu_ps(&dst[i + 4], _mm_min_ps(_mm_max_ps(_mm_mul_ps(b, vMul), vLo), vHi));
+	}
+#elif defined(FT2_SIMD_NEON)
+	const float32x4_t vLo = vdupq_n_f32(-1.0f), vHi = vdupq_n_f32(1.0f);
+	for (; i + 8 <= n; i += 8) {
+		float32x4_t a = vdupq_n_f32(0.0f), b = vdupq_n_f32(0.0f);
+		for (int32_t s = 0; s < numSrcs; s++) {
+			a = vaddq_f32(a, vld1q_f32(&srcs[s][i]));
+			b = vaddq_f32(b, vld1q_f32(&srcs[s][i + 4]));
+		}
+		vst1q_f32(&dst[i], vminq_f32(vmaxq_f32(vmulq_n_f32(a, mul), vLo), vHi));
+		vst1q_f32(&dst[i + 4], vminq_f32(vmaxq_f32(vmulq_n_f32(b, mul), vLo), vHi));
+	}
+#endif
+
+	for (; i < n; i++) {
+		float sum = 0.0f;
+		for (int32_t s = 0; s < numSrcs; s++)
+			sum += srcs[s][i];
+		dst[i] = clampSample(sum * mul);
+	}
+}
@@ -0,0 +1,28 @@
+/**
+ * @file ft2_plugin_output.h
+ * @brief Output stages: gain and clamp of the mixed buffers, and the sum
+ * of the multi-out buffers into the main output.
+ *
+ * Vector loops (ft2_plugin_simd.h) with a scalar tail that computes the
+ * same thing, so the output does not depend on the instruction set: each
+ * sample gets the same float multiply and clamp, and sums add the buffers
+ * in the order given, starting from zero.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* dst[i] = clamp(src[i] * mul, -1, 1). dst may be src. */
+void ft2_output_scale_clamp(float *dst, const float *src, float mul, uint32_t n);
+
+/* dst[i] = clamp((0 + srcs[0][i] + srcs[1][i] + ...) * mul, -1, 1) */
+void ft2_output_sum_scale_clamp(float *dst, const float *const *srcs, int32_t numSrcs, float mul, uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
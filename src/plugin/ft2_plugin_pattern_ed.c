@@ -173,37 +173,25 @@ static void pattCharOut(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos,
                         uint8_t chr, uint8_t fontType, uint32_t color, const ft2_bmp_t *bmp)
 {
 	if (!ed || !ed->video || !bmp) return;
-	
-	const uint8_t *srcPtr;
-	int32_t charW, charH, width;
 
 	switch (fontType) {
 		case FONT_TYPE3:
 			if (!bmp->font3) return;
-			srcPtr = &bmp->font3[chr * FONT3_CHAR_W];
-			charW = FONT3_CHAR_W; charH = FONT3_CHAR_H; width = FONT3_WIDTH;
+			glyphOut(ed->video, &bmp->font3Bits, chr * FONT3_CHAR_W, 0, FONT3_CHAR_W, FONT3_CHAR_H, xPos, yPos, color);
 			break;
 		case FONT_TYPE4:
 			if (!ed->font4Ptr) return;
-			srcPtr = &ed->font4Ptr[chr * FONT4_CHAR_W];
-			charW = FONT4_CHAR_W; charH = FONT4_CHAR_H; width = FONT4_WIDTH;
+			glyphOut(ed->video, &bmp->font4Bits, chr * FONT4_CHAR_W, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, xPos, yPos, color);
 			break;
 		case FONT_TYPE5:
 			if (!ed->font5Ptr) return;
-			srcPtr = &ed->font5Ptr[chr * FONT5_CHAR_W];
-			charW = FONT5_CHAR_W; charH = FONT5_CHAR_H; width = FONT5_WIDTH;
+			glyphOut(ed->video, &bmp->font4Bits, chr * FONT5_CHAR_W, ed->font5Y, FONT5_CHAR_W, FONT5_CHAR_H, xPos, yPos, color);
 			break;
 		default:
 			if (!bmp->font7) return;
-			srcPtr = &bmp->font7[chr * FONT7_CHAR_W];
-			charW = FONT7_CHAR_W; charH = FONT7_CHAR_H; width = FONT7_WIDTH;
+			glyphOut(ed->video, &bmp->font7Bits, chr * FONT7_CHAR_W, 0, FONT7_CHAR_W, FONT7_CHAR_H, xPos, yPos, color);
 			break;
 	}
-
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < charH; y++, srcPtr += width, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < charW; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
 }
 
 /* ============ NOTE DRAWING (size variants) ============ */
@@ -212,21 +200,13 @@ static void pattCharOut(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos,
 static void drawEmptyNoteSmall(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, uint32_t color, const ft2_bmp_t *bmp)
 {
 	if (!ed || !ed->video || !bmp || !bmp->font7) return;
-	const uint8_t *srcPtr = &bmp->font7[18 * FONT7_CHAR_W];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT7_CHAR_H; y++, srcPtr += FONT7_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT7_CHAR_W * 3; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
+	glyphOut(ed->video, &bmp->font7Bits, 18 * FONT7_CHAR_W, 0, FONT7_CHAR_W * 3, FONT7_CHAR_H, xPos, yPos, color);
 }
 
 static void drawKeyOffSmall(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, uint32_t color, const ft2_bmp_t *bmp)
 {
 	if (!ed || !ed->video || !bmp || !bmp->font7) return;
-	const uint8_t *srcPtr = &bmp->font7[21 * FONT7_CHAR_W];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + (xPos + 2)];
-	for (int32_t y = 0; y < FONT7_CHAR_H; y++, srcPtr += FONT7_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT7_CHAR_W * 2; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
+	glyphOut(ed->video, &bmp->font7Bits, 21 * FONT7_CHAR_W, 0, FONT7_CHAR_W * 2, FONT7_CHAR_H, xPos + 2, yPos, color);
 }
 
 static void drawNoteSmall(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32_t color, const ft2_bmp_t *bmp)
@@ -238,102 +218,66 @@ static void drawNoteSmall(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos
 	uint32_t char2 = ed->ptnAcc ? flatNote2Char_small[note] : sharpNote2Char_small[note];
 	uint32_t char3 = noteTab2[noteNum] * FONT7_CHAR_W;
 
-	const uint8_t *ch1Ptr = &bmp->font7[char1], *ch2Ptr = &bmp->font7[char2], *ch3Ptr = &bmp->font7[char3];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT7_CHAR_H; y++, ch1Ptr += FONT7_WIDTH, ch2Ptr += FONT7_WIDTH, ch3Ptr += FONT7_WIDTH, dstPtr += SCREEN_W) {
-		for (int32_t x = 0; x < FONT7_CHAR_W; x++) {
-			if (ch1Ptr[x]) dstPtr[x] = color;
-			if (ch2Ptr[x]) dstPtr[FONT7_CHAR_W + x] = color;
-			if (ch3Ptr[x]) dstPtr[((FONT7_CHAR_W * 2) - 2) + x] = color;
-		}
-	}
+	const ft2_font_bits_t *font = &bmp->font7Bits;
+	glyphOut(ed->video, font, char1, 0, FONT7_CHAR_W, FONT7_CHAR_H, xPos, yPos, color);
+	glyphOut(ed->video, font, char2, 0, FONT7_CHAR_W, FONT7_CHAR_H, xPos + FONT7_CHAR_W, yPos, color);
+	glyphOut(ed->video, font, char3, 0, FONT7_CHAR_W, FONT7_CHAR_H, xPos + ((FONT7_CHAR_W * 2) - 2), yPos, color);
 }
 
 /* Medium: 6-8 channel mode (font4) */
 static void drawEmptyNoteMedium(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, uint32_t color, const ft2_bmp_t *bmp)
 {
-	(void)bmp;
-	if (!ed || !ed->video || !ed->font4Ptr) return;
-	const uint8_t *srcPtr = &ed->font4Ptr[43 * FONT4_CHAR_W];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, srcPtr += FONT4_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT4_CHAR_W * 3; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
+	if (!ed || !ed->video || !ed->font4Ptr || !bmp) return;
+	glyphOut(ed->video, &bmp->font4Bits, 43 * FONT4_CHAR_W, ed->font4Y, FONT4_CHAR_W * 3, FONT4_CHAR_H, xPos, yPos, color);
 }
 
 static void drawKeyOffMedium(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, uint32_t color, const ft2_bmp_t *bmp)
 {
-	(void)bmp;
-	if (!ed || !ed->video || !ed->font4Ptr) return;
-	const uint8_t *srcPtr = &ed->font4Ptr[40 * FONT4_CHAR_W];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, srcPtr += FONT4_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT4_CHAR_W * 3; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
+	if (!ed || !ed->video || !ed->font4Ptr || !bmp) return;
+	glyphOut(ed->video, &bmp->font4Bits, 40 * FONT4_CHAR_W, ed->font4Y, FONT4_CHAR_W * 3, FONT4_CHAR_H, xPos, yPos, color);
 }
 
 static void drawNoteMedium(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32_t color, const ft2_bmp_t *bmp)
 {
-	(void)bmp;
-	if (!ed || !ed->video || !ed->font4Ptr) return;
+	if (!ed || !ed->video || !ed->font4Ptr || !bmp) return;
 	noteNum--;
 	const uint8_t note = noteTab1[noteNum];
 	uint32_t char1 = ed->ptnAcc ? flatNote1Char_med[note] : sharpNote1Char_med[note];
 	uint32_t char2 = ed->ptnAcc ? flatNote2Char_med[note] : sharpNote2Char_med[note];
 	uint32_t char3 = noteTab2[noteNum] * FONT4_CHAR_W;
 
-	const uint8_t *ch1Ptr = &ed->font4Ptr[char1], *ch2Ptr = &ed->font4Ptr[char2], *ch3Ptr = &ed->font4Ptr[char3];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, ch1Ptr += FONT4_WIDTH, ch2Ptr += FONT4_WIDTH, ch3Ptr += FONT4_WIDTH, dstPtr += SCREEN_W) {
-		for (int32_t x = 0; x < FONT4_CHAR_W; x++) {
-			if (ch1Ptr[x]) dstPtr[x] = color;
-			if (ch2Ptr[x]) dstPtr[FONT4_CHAR_W + x] = color;
-			if (ch3Ptr[x]) dstPtr[(FONT4_CHAR_W * 2) + x] = color;
-		}
-	}
+	const ft2_font_bits_t *font = &bmp->font4Bits;
+	glyphOut(ed->video, font, char1, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, xPos, yPos, color);
+	glyphOut(ed->video, font, char2, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, xPos + FONT4_CHAR_W, yPos, color);
+	glyphOut(ed->video, font, char3, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, xPos + (FONT4_CHAR_W * 2), yPos, color);
 }
 
 /* Big: 4-6 channel mode (font5 for notes, font4 for empty/keyoff) */
 static void drawEmptyNoteBig(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, uint32_t color, const ft2_bmp_t *bmp)
 {
-	(void)bmp;
-	if (!ed || !ed->video || !ed->font4Ptr) return;
-	const uint8_t *srcPtr = &ed->font4Ptr[67 * FONT4_CHAR_W];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, srcPtr += FONT4_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT4_CHAR_W * 6; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
+	if (!ed || !ed->video || !ed->font4Ptr || !bmp) return;
+	glyphOut(ed->video, &bmp->font4Bits, 67 * FONT4_CHAR_W, ed->font4Y, FONT4_CHAR_W * 6, FONT4_CHAR_H, xPos, yPos, color);
 }
 
 static void drawKeyOffBig(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, uint32_t color, const ft2_bmp_t *bmp)
 {
 	if (!ed || !ed->video || !bmp || !bmp->font4) return;
-	const uint8_t *srcPtr = &bmp->font4[61 * FONT4_CHAR_W];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, srcPtr += FONT4_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT4_CHAR_W * 6; x++)
-			if (srcPtr[x]) dstPtr[x] = color;
+	glyphOut(ed->video, &bmp->font4Bits, 61 * FONT4_CHAR_W, 0, FONT4_CHAR_W * 6, FONT4_CHAR_H, xPos, yPos, color);
 }
 
 static void drawNoteBig(ft2_pattern_editor_t *ed, uint32_t xPos, uint32_t yPos, int32_t noteNum, uint32_t color, const ft2_bmp_t *bmp)
 {
-	(void)bmp;
-	if (!ed || !ed->video || !ed->font5Ptr) return;
+	if (!ed || !ed->video || !ed->font5Ptr || !bmp) return;
 	noteNum--;
 	const uint8_t note = noteTab1[noteNum];
 	uint32_t char1 = ed->ptnAcc ? flatNote1Char_big[note] : sharpNote1Char_big[note];
 	uint32_t char2 = ed->ptnAcc ? flatNote2Char_big[note] : sharpNote2Char_big[note];
 	uint32_t char3 = noteTab2[noteNum] * FONT5_CHAR_W;
 
-	const uint8_t *ch1Ptr = &ed->font5Ptr[char1], *ch2Ptr = &ed->font5Ptr[char2], *ch3Ptr = &ed->font5Ptr[char3];
-	uint32_t *dstPtr = &ed->video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	for (int32_t y = 0; y < FONT5_CHAR_H; y++, ch1Ptr += FONT5_WIDTH, ch2Ptr += FONT5_WIDTH, ch3Ptr += FONT5_WIDTH, dstPtr += SCREEN_W) {
-		for (int32_t x = 0; x < FONT5_CHAR_W; x++) {
-			if (ch1Ptr[x]) dstPtr[x] = color;
-			if (ch2Ptr[x]) dstPtr[FONT5_CHAR_W + x] = color;
-			if (ch3Ptr[x]) dstPtr[(FONT5_CHAR_W * 2) + x] = color;
-		}
-	}
+	const ft2_font_bits_t *font = &bmp->font4Bits;
+	glyphOut(ed->video, font, char1, ed->font5Y, FONT5_CHAR_W, FONT5_CHAR_H, xPos, yPos, color);
+	glyphOut(ed->video, font, char2, ed->font5Y, FONT5_CHAR_W, FONT5_CHAR_H, xPos + FONT5_CHAR_W, yPos, color);
+	glyphOut(ed->video, font, char3, ed->font5Y, FONT5_CHAR_W, FONT5_CHAR_H, xPos + (FONT5_CHAR_W * 2), yPos, color);
 }
 
 /* Draw row numbers (left and right columns) */
@@ -341,8 +285,7 @@ static void drawRowNums(ft2_pattern_editor_t *ed, int32_t yPos, uint8_t row, boo
 {
 #define LEFT_ROW_XPOS 8
 #define RIGHT_ROW_XPOS 608
-	(void)bmp;
-	if (!ed || !ed->video || !ed->font4Ptr) return;
+	if (!ed || !ed->video || !ed->font4Ptr || !bmp) return;
 
 	uint32_t pixVal = selectedRowFlag ? ed->video->palette[PAL_FORGRND] :
 	                  (ed->ptnLineLight && !(row & 3)) ? ed->video->palette[PAL_BLCKTXT] :
@@ -350,17 +293,13 @@ static void drawRowNums(ft2_pattern_editor_t *ed, int32_t yPos, uint8_t row, boo
 
 	if (!ed->ptnHex) row = hex2Dec[row];
 
-	const uint8_t *src1Ptr = &ed->font4Ptr[(row >> 4) * FONT4_CHAR_W];
-	const uint8_t *src2Ptr = &ed->font4Ptr[(row & 0x0F) * FONT4_CHAR_W];
-	uint32_t *dst1Ptr = &ed->video->frameBuffer[(yPos * SCREEN_W) + LEFT_ROW_XPOS];
-	uint32_t *dst2Ptr = dst1Ptr + (RIGHT_ROW_XPOS - LEFT_ROW_XPOS);
+	const ft2_font_bits_t *font = &bmp->font4Bits;
+	const uint32_t src1X = (row >> 4) * FONT4_CHAR_W, src2X = (row & 0x0F) * FONT4_CHAR_W;
 
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, src1Ptr += FONT4_WIDTH, src2Ptr += FONT4_WIDTH, dst1Ptr += SCREEN_W, dst2Ptr += SCREEN_W) {
-		for (int32_t x = 0; x < FONT4_CHAR_W; x++) {
-			if (src1Ptr[x]) { dst1Ptr[x] = pixVal; dst2Ptr[x] = pixVal; }
-			if (src2Ptr[x]) { dst1Ptr[FONT4_CHAR_W + x] = pixVal; dst2Ptr[FONT4_CHAR_W + x] = pixVal; }
-		}
-	}
+	glyphOut(ed->video, font, src1X, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, LEFT_ROW_XPOS, yPos, pixVal);
+	glyphOut(ed->video, font, src2X, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, LEFT_ROW_XPOS + FONT4_CHAR_W, yPos, pixVal);
+	glyphOut(ed->video, font, src1X, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, RIGHT_ROW_XPOS, yPos, pixVal);
+	glyphOut(ed->video, font, src2X, ed->font4Y, FONT4_CHAR_W, FONT4_CHAR_H, RIGHT_ROW_XPOS + FONT4_CHAR_W, yPos, pixVal);
 }
 
 /* Draw channel numbers above pattern */
@@ -527,6 +466,17 @@ void ft2_pattern_ed_init(ft2_pattern_editor_t *editor, ft2_video_t *video)
 	editor->clipboard.lastMarkY2 = -1;
 }
 
+void ft2_pattern_ed_free(ft2_pattern_editor_t *editor)
+{
+	if (!editor) return;
+	free(editor->clipboard.blkCopyBuff);
+	free(editor->clipboard.trackCopyBuff);
+	free(editor->clipboard.ptnCopyBuff);
+	editor->clipboard.blkCopyBuff = NULL;
+	editor->clipboard.trackCopyBuff = NULL;
+	editor->clipboard.ptnCopyBuff = NULL;
+}
+
 /* Set font pointers based on selected font style (0-3) */
 void ft2_pattern_ed_update_font_ptrs(ft2_pattern_editor_t *editor, const ft2_bmp_t *bmp)
 {
@@ -534,6 +484,8 @@ void ft2_pattern_ed_update_font_ptrs(ft2_pattern_editor_t *editor, const ft2_bmp
 	uint8_t fontIdx = (editor->ptnFont > 3) ? 0 : editor->ptnFont;
 	editor->font4Ptr = &bmp->font4[fontIdx * (FONT4_WIDTH * FONT4_CHAR_H)];
 	editor->font5Ptr = &bmp->font4[(4 + fontIdx) * (FONT4_WIDTH * FONT4_CHAR_H)];
+	editor->font4Y = fontIdx * FONT4_CHAR_H;
+	editor->font5Y = (4 + fontIdx) * FONT4_CHAR_H;
 }
 
 /* ============ FRAMEWORK DRAWING ============ */
@@ -672,7 +624,7 @@ void ft2_pattern_ed_write_pattern(ft2_pattern_editor_t *ed, const ft2_bmp_t *bmp
 
 			drawRowNums(ed, textY, (uint8_t)row, selectedRowFlag, bmp);
 
-			const ft2_note_t *p = (pattPtr == NULL) ? &inst->replayer.nilPatternLine[0] : &pattPtr[(uint32_t)row * FT2_MAX_CHANNELS];
+			const ft2_note_t *p = (pattPtr == NULL) ? &inst->replayer.nilPatternLine[0] : &pattPtr[(uint32_t)row * inst->replayer.patternStride];
 			const int32_t xWidth = ed->patternChannelWidth;
 			const uint32_t color = noteTextColors[selectedRowFlag];
 
@@ -1056,8 +1008,7 @@ bool allocatePattern(ft2_instance_t *inst, uint16_t pattNum)
 	if (!inst || pattNum >= FT2_MAX_PATTERNS) return false;
 	if (inst->replayer.pattern[pattNum]) return true;
 
-	inst->replayer.pattern[pattNum] = (ft2_note_t *)calloc((MAX_PATT_LEN * MAX_CHANNELS) + 16, sizeof(ft2_note_t));
-	if (!inst->replayer.pattern[pattNum]) return false;
+	if (!ft2_pattern_alloc(inst, pattNum)) return false;
 	inst->replayer.song.currNumRows = inst->replayer.patternNumRows[pattNum];
 	return true;
 }
@@ -1072,7 +1023,7 @@ bool patternEmpty(ft2_instance_t *inst, uint16_t pattNum)
 	uint16_t numRows = inst->replayer.patternNumRows[pattNum];
 	for (int32_t row = 0; row < numRows; row++) {
 		for (int32_t ch = 0; ch < inst->replayer.song.numChannels; ch++) {
-			ft2_note_t *n = &p[(row * MAX_CHANNELS) + ch];
+			ft2_note_t *n = &p[(row * inst->replayer.patternStride) + ch];
 			if (n->note || n->instr || n->vol || n->efx || n->efxData) return false;
 		}
 	}
@@ -1083,10 +1034,8 @@ bool patternEmpty(ft2_instance_t *inst, uint16_t pattNum)
 void killPatternIfUnused(ft2_instance_t *inst, uint16_t pattNum)
 {
 	if (!inst || pattNum >= FT2_MAX_PATTERNS) return;
-	if (patternEmpty(inst, pattNum) && inst->replayer.pattern[pattNum]) {
-		free(inst->replayer.pattern[pattNum]);
-		inst->replayer.pattern[pattNum] = NULL;
-	}
+	if (patternEmpty(inst, pattNum) && inst->replayer.pattern[pattNum])
+		ft2_pattern_free(inst, pattNum);
 }
 
 /* Max visible channels based on config and volume column visibility */
@@ -1404,7 +1353,7 @@ void cutBlock(ft2_instance_t *inst)
 	patt_clipboard_t *clip = &FT2_PATTERN_ED(inst)->clipboard;
 	for (int32_t x = markX1; x <= markX2; x++) {
 		for (int32_t y = markY1; y < markY2; y++) {
-			ft2_note_t *n = &p[(y * FT2_MAX_CHANNELS) + x];
+			ft2_note_t *n = &p[(y * inst->replayer.patternStride) + x];
 			if (inst->config.ptnCutToBuffer && clip->blkCopyBuff)
 				copyNoteWithMask(inst, n, &clip->blkCopyBuff[((y - markY1) * MAX_CHANNELS) + (x - markX1)]);
 			memset(n, 0, sizeof(ft2_note_t));
@@ -1444,7 +1393,7 @@ void copyBlock(ft2_instance_t *inst)
 	
 	for (int32_t x = markX1; x <= markX2; x++)
 		for (int32_t y = markY1; y < markY2; y++)
-			copyNoteWithMask(inst, &p[(y * FT2_MAX_CHANNELS) + x], &clip->blkCopyBuff[((y - markY1) * MAX_CHANNELS) + (x - markX1)]);
+			copyNoteWithMask(inst, &p[(y * inst->replayer.patternStride) + x], &clip->blkCopyBuff[((y - markY1) * MAX_CHANNELS) + (x - markX1)]);
 
 	clip->markXSize = markX2 - markX1;
 	clip->markYSize = markY2 - markY1;
@@ -1474,7 +1423,7 @@ void pasteBlock(ft2_instance_t *inst)
 		ft2_note_t *p = inst->replayer.pattern[curPattern];
 		for (int32_t x = chStart; x < chStart + markedChannels; x++)
 			for (int32_t y = rowStart; y < rowStart + markedRows; y++)
-				pasteNoteWithMask(inst, &clip->blkCopyBuff[((y - rowStart) * MAX_CHANNELS) + (x - chStart)], &p[(y * FT2_MAX_CHANNELS) + x]);
+				pasteNoteWithMask(inst, &clip->blkCopyBuff[((y - rowStart) * MAX_CHANNELS) + (x - chStart)], &p[(y * inst->replayer.patternStride) + x]);
 	}
 	killPatternIfUnused(inst, curPattern);
 	inst->uiState.updatePatternEditor = true;
@@ -1497,12 +1446,12 @@ void cutTrack(ft2_instance_t *inst)
 	if (inst->config.ptnCutToBuffer && clip->trackCopyBuff) {
 		memset(clip->trackCopyBuff, 0, MAX_PATT_LEN * sizeof(ft2_note_t));
 		for (int16_t i = 0; i < numRows; i++)
-			copyNoteWithMask(inst, &p[(i * FT2_MAX_CHANNELS) + ch], &clip->trackCopyBuff[i]);
+			copyNoteWithMask(inst, &p[(i * inst->replayer.patternStride) + ch], &clip->trackCopyBuff[i]);
 		clip->trkBufLen = numRows;
 	}
 
 	for (int16_t i = 0; i < numRows; i++)
-		memset(&p[(i * FT2_MAX_CHANNELS) + ch], 0, sizeof(ft2_note_t));
+		memset(&p[(i * inst->replayer.patternStride) + ch], 0, sizeof(ft2_note_t));
 
 	killPatternIfUnused(inst, curPattern);
 	ft2_song_mark_modified(inst);
@@ -1525,7 +1474,7 @@ void copyTrack(ft2_instance_t *inst)
 
 	memset(clip->trackCopyBuff, 0, MAX_PATT_LEN * sizeof(ft2_note_t));
 	for (int16_t i = 0; i < numRows; i++)
-		copyNoteWithMask(inst, &p[(i * FT2_MAX_CHANNELS) + ch], &clip->trackCopyBuff[i]);
+		copyNoteWithMask(inst, &p[(i * inst->replayer.patternStride) + ch], &clip->trackCopyBuff[i]);
 	clip->trkBufLen = numRows;
 }
 
@@ -1544,7 +1493,7 @@ void pasteTrack(ft2_instance_t *inst)
 	const uint8_t ch = inst->cursor.ch;
 
 	for (int16_t i = 0; i < numRows; i++)
-		pasteNoteWithMask(inst, &clip->trackCopyBuff[i], &p[(i * FT2_MAX_CHANNELS) + ch]);
+		pasteNoteWithMask(inst, &clip->trackCopyBuff[i], &p[(i * inst->replayer.patternStride) + ch]);
 
 	killPatternIfUnused(inst, curPattern);
 	ft2_song_mark_modified(inst);
@@ -1569,14 +1518,14 @@ void cutPattern(ft2_instance_t *inst)
 		memset(clip->ptnCopyBuff, 0, (MAX_PATT_LEN * MAX_CHANNELS) * sizeof(ft2_note_t));
 		for (int16_t x = 0; x < numCh; x++) {
 			for (int16_t i = 0; i < numRows; i++)
-				copyNoteWithMask(inst, &p[(i * FT2_MAX_CHANNELS) + x], &clip->ptnCopyBuff[(i * MAX_CHANNELS) + x]);
+				copyNoteWithMask(inst, &p[(i * inst->replayer.patternStride) + x], &clip->ptnCopyBuff[(i * MAX_CHANNELS) + x]);
 		}
 		clip->ptnBufLen = numRows;
 	}
 
 	for (int16_t x = 0; x < numCh; x++) {
 		for (int16_t i = 0; i < numRows; i++)
-			memset(&p[(i * FT2_MAX_CHANNELS) + x], 0, sizeof(ft2_note_t));
+			memset(&p[(i * inst->replayer.patternStride) + x], 0, sizeof(ft2_note_t));
 	}
 
 	killPatternIfUnused(inst, curPattern);
@@ -1601,7 +1550,7 @@ void copyPattern(ft2_instance_t *inst)
 	memset(clip->ptnCopyBuff, 0, (MAX_PATT_LEN * MAX_CHANNELS) * sizeof(ft2_note_t));
 	for (int16_t x = 0; x < numCh; x++) {
 		for (int16_t i = 0; i < numRows; i++)
-			copyNoteWithMask(inst, &p[(i * FT2_MAX_CHANNELS) + x], &clip->ptnCopyBuff[(i * MAX_CHANNELS) + x]);
+			copyNoteWithMask(inst, &p[(i * inst->replayer.patternStride) + x], &clip->ptnCopyBuff[(i * MAX_CHANNELS) + x]);
 	}
 	clip->ptnBufLen = numRows;
 }
@@ -1622,7 +1571,7 @@ void pastePattern(ft2_instance_t *inst)
 
 	for (int16_t x = 0; x < numCh; x++) {
 		for (int16_t i = 0; i < numRows; i++)
-			pasteNoteWithMask(inst, &clip->ptnCopyBuff[(i * MAX_CHANNELS) + x], &p[(i * FT2_MAX_CHANNELS) + x]);
+			pasteNoteWithMask(inst, &clip->ptnCopyBuff[(i * MAX_CHANNELS) + x], &p[(i * inst->replayer.patternStride) + x]);
 	}
 
 	killPatternIfUnused(inst, curPattern);
@@ -2183,8 +2132,8 @@ static void remapInstrXY(ft2_instance_t *inst, uint16_t pattNum, int32_t x1, int
 	if (y1 >= numRows) y1 = numRows - 1;
 	if (y2 > numRows) y2 = numRows - y1;
 
-	ft2_note_t *p = &pattPtr[(y1 * MAX_CHANNELS) + x1];
-	const int32_t pitch = MAX_CHANNELS - ((x2 + 1) - x1);
+	ft2_note_t *p = &pattPtr[(y1 * inst->replayer.patternStride) + x1];
+	const int32_t pitch = inst->replayer.patternStride - ((x2 + 1) - x1);
 	for (int32_t y = y1; y <= y2; y++, p += pitch)
 		for (int32_t x = x1; x <= x2; x++, p++)
 			if (p->instr == src) p->instr = dst;
@@ -2365,6 +2314,7 @@ static uint32_t countOverflowingNotes(ft2_instance_t *inst, uint8_t mode, int8_t
 	ft2_note_t **pattern = inst->replayer.pattern;
 	int16_t *patternNumRows = inst->replayer.patternNumRows;
 	int32_t numChannels = inst->replayer.song.numChannels;
+	int32_t pattStride = inst->replayer.patternStride;
 	uint8_t cursorCh = inst->cursor.ch;
 	uint8_t curInstr = inst->editor.curInstr;
 
@@ -2378,7 +2328,7 @@ static uint32_t countOverflowingNotes(ft2_instance_t *inst, uint8_t mode, int8_t
 
 			p += cursorCh;
 
-			for (int32_t row = 0; row < numRows; row++, p += MAX_CHANNELS)
+			for (int32_t row = 0; row < numRows; row++, p += pattStride)
 			{
 				if ((p->note >= 1 && p->note <= 96) && (allInstrumentsFlag || p->instr == curInstr))
 				{
@@ -2395,7 +2345,7 @@ static uint32_t countOverflowingNotes(ft2_instance_t *inst, uint8_t mode, int8_t
 			if (p == NULL)
 				return 0;
 
-			const int32_t pitch = MAX_CHANNELS - numChannels;
+			const int32_t pitch = pattStride - numChannels;
 			for (int32_t row = 0; row < numRows; row++, p += pitch)
 			{
 				for (int32_t ch = 0; ch < numChannels; ch++, p++)
@@ -2412,7 +2362,7 @@ static uint32_t countOverflowingNotes(ft2_instance_t *inst, uint8_t mode, int8_t
 
 		case TRANSP_SONG:
 		{
-			const int32_t pitch = MAX_CHANNELS - numChannels;
+			const int32_t pitch = pattStride - numChannels;
 			for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
 			{
 				ft2_note_t *p = pattern[i];
@@ -2458,9 +2408,9 @@ static uint32_t countOverflowingNotes(ft2_instance_t *inst, uint8_t mode, int8_t
 			if (p == NULL || markX1 < 0 || markY1 < 0 || markX2 < 0 || markY2 < 0)
 				return 0;
 
-			p += (markY1 * MAX_CHANNELS) + markX1;
+			p += (markY1 * pattStride) + markX1;
 
-			const int32_t pitch = MAX_CHANNELS - ((markX2 + 1) - markX1);
+			const int32_t pitch = pattStride - ((markX2 + 1) - markX1);
 			for (int32_t row = markY1; row < markY2; row++, p += pitch)
 			{
 				for (int32_t ch = markX1; ch <= markX2; ch++, p++)
@@ -2496,6 +2446,7 @@ void doTranspose(ft2_instance_t *inst, uint8_t mode, int8_t addValue, bool allIn
 	ft2_note_t **pattern = inst->replayer.pattern;
 	int16_t *patternNumRows = inst->replayer.patternNumRows;
 	int32_t numChannels = inst->replayer.song.numChannels;
+	int32_t pattStride = inst->replayer.patternStride;
 	uint8_t cursorCh = inst->cursor.ch;
 	uint8_t curInstr = inst->editor.curInstr;
 
@@ -2511,7 +2462,7 @@ void doTranspose(ft2_instance_t *inst, uint8_t mode, int8_t addValue, bool allIn
 
 			p += cursorCh;
 
-			for (int32_t row = 0; row < numRows; row++, p += MAX_CHANNELS)
+			for (int32_t row = 0; row < numRows; row++, p += pattStride)
 			{
 				uint8_t note = p->note;
 				if ((note >= 1 && note <= 96) && (allInstrumentsFlag || p->instr == curInstr))
@@ -2532,7 +2483,7 @@ void doTranspose(ft2_instance_t *inst, uint8_t mode, int8_t addValue, bool allIn
 			if (p == NULL)
 				return;
 
-			const int32_t pitch = MAX_CHANNELS - numChannels;
+			const int32_t pitch = pattStride - numChannels;
 			for (int32_t row = 0; row < numRows; row++, p += pitch)
 			{
 				for (int32_t ch = 0; ch < numChannels; ch++, p++)
@@ -2553,7 +2504,7 @@ void doTranspose(ft2_instance_t *inst, uint8_t mode, int8_t addValue, bool allIn
 
 		case TRANSP_SONG:
 		{
-			const int32_t pitch = MAX_CHANNELS - numChannels;
+			const int32_t pitch = pattStride - numChannels;
 			for (int32_t i = 0; i < FT2_MAX_PATTERNS; i++)
 			{
 				ft2_note_t *p = pattern[i];
@@ -2603,9 +2554,9 @@ void doTranspose(ft2_instance_t *inst, uint8_t mode, int8_t addValue, bool allIn
 			if (p == NULL || markX1 < 0 || markY1 < 0 || markX2 < 0 || markY2 < 0)
 				return;
 
-			p += (markY1 * MAX_CHANNELS) + markX1;
+			p += (markY1 * pattStride) + markX1;
 
-			const int32_t pitch = MAX_CHANNELS - ((markX2 + 1) - markX1);
+			const int32_t pitch = pattStride - ((markX2 + 1) - markX1);
 			for (int32_t row = markY1; row < markY2; row++, p += pitch)
 			{
 				for (int32_t ch = markX1; ch <= markX2; ch++, p++)
@@ -2695,7 +2646,7 @@ static void scaleNote(ft2_instance_t *inst, uint16_t pattNum, int32_t ch, int32_
 	if (row < 0 || row >= numRows || ch < 0 || ch >= inst->replayer.song.numChannels)
 		return;
 
-	ft2_note_t *p = &inst->replayer.pattern[pattNum][(row * FT2_MAX_CHANNELS) + ch];
+	ft2_note_t *p = &inst->replayer.pattern[pattNum][(row * inst->replayer.patternStride) + ch];
 
 	int32_t vol = getNoteVolume(inst, p);
 	if (vol >= 0) {
@@ -110,6 +110,7 @@ typedef struct ft2_pattern_editor_t {
 
 	pattMark_t pattMark;
 	const uint8_t *font4Ptr, *font5Ptr;
+	uint16_t font4Y, font5Y;    /* Same glyph sets as source rows in bmp->font4Bits */
 	
 	/* Block clipboard (per-instance) */
 	patt_clipboard_t clipboard;
@@ -123,6 +124,7 @@ enum {
 
 /* Init/drawing */
 void ft2_pattern_ed_init(ft2_pattern_editor_t *editor, struct ft2_video_t *video);
+void ft2_pattern_ed_free(ft2_pattern_editor_t *editor);
 void ft2_pattern_ed_update_font_ptrs(ft2_pattern_editor_t *editor, const struct ft2_bmp_t *bmp);
 void ft2_pattern_ed_draw_borders(ft2_pattern_editor_t *editor, const struct ft2_bmp_t *bmp);
 void ft2_pattern_ed_write_pattern(ft2_pattern_editor_t *editor, const struct ft2_bmp_t *bmp, struct ft2_instance_t *inst);
@@ -0,0 +1,224 @@
+/**
+ * @file ft2_plugin_profile.c
+ * @brief Per-block timing of the plugin's audio callback.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L /* clock_gettime() under -std=c11 */
+#endif
+
+#include <string.h>
+#include "ft2_plugin_profile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define atomicLoad(p)     ((int32_t)InterlockedOr((volatile LONG *)(p), 0))
+#define atomicStore(p, v) InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#else
+#include <time.h>
+#define atomicLoad(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define atomicStore(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+#define CALIBRATION_NS 2000000 /* The TSC rate is measured over this long, once */
+
+static const char *phaseNames[FT2_PROFILE_PHASES] = {
+	"Lock", "MIDI in", "DAW sync", "Render", "MIDI out", "Block"
+};
+
+static double tickRate;
+
+uint64_t ft2_profile_clock(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64_t)((double)now.QuadPart * (1e9 / (double)freq.QuadPart));
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#if FT2_PROFILING
+static double measureTickRate(void)
+{
+#ifdef FT2_PROFILE_TSC
+	const uint64_t ns0 = ft2_profile_clock();
+	const uint64_t t0 = ft2_profile_now();
+	uint64_t ns1;
+	do {
+		ns1 = ft2_profile_clock();
+	} while (ns1 - ns0 < CALIBRATION_NS);
+	const uint64_t t1 = ft2_profile_now();
+
+	return (double)(t1 - t0) * 1e9 / (double)(ns1 - ns0);
+#else
+	return 1e9;
+#endif
+}
+#endif
+
+void ft2_profile_init(ft2_profile_t *p)
+{
+	if (p == NULL)
+		return;
+
+	memset(p, 0, sizeof(ft2_profile_t));
+#if FT2_PROFILING
+	if (tickRate == 0.0)
+		tickRate = measureTickRate();
+#endif
+	p->ticksPerSecond = (tickRate > 0.0) ? tickRate : 1e9;
+}
+
+void ft2_profile_set_enabled(ft2_profile_t *p, bool enabled)
+{
+	if (p == NULL)
+		return;
+
+	/* Every run starts from empty stats */
+	if (enabled)
+		atomicStore(&p->resetRequested, 1);
+	atomicStore(&p->enabled, enabled ? 1 : 0);
+}
+
+void ft2_profile_reset(ft2_profile_t *p)
+{
+	if (p != NULL)
+		atomicStore(&p->resetRequested, 1);
+}
+
+static int32_t bucketOf(uint32_t ticks)
+{
+	if (ticks < (1u << FT2_PROFILE_SUB_BITS))
+		return (int32_t)ticks;
+
+	int32_t msb = 31;
+	while (!(ticks & (1u << msb)))
+		msb--;
+
+	const int32_t shift = msb - FT2_PROFILE_SUB_BITS;
+	const int32_t sub = (int32_t)((ticks >> shift) & ((1u << FT2_PROFILE_SUB_BITS) - 1));
+	return ((shift + 1) << FT2_PROFILE_SUB_BITS) + sub;
+}
+
+/* First tick count past the bucket, so percentiles err on the slow side */
+static uint64_t bucketEnd(int32_t bucket)
+{
+	if (bucket < (1 << FT2_PROFILE_SUB_BITS))
+		return (uint64_t)bucket + 1;
+
+	const int32_t shift = (bucket >> FT2_PROFILE_SUB_BITS) - 1;
+	const uint64_t sub = (uint64_t)(bucket & ((1 << FT2_PROFILE_SUB_BITS) - 1));
+	return ((1ull << FT2_PROFILE_SUB_BITS) + sub + 1) << shift;
+}
+
+void ft2_profile_end(ft2_profile_t *p, ft2_profile_block_t *b, uint32_t numFrames, uint32_t sampleRate,
+	int32_t voices, uint32_t scopeDrops, uint32_t midiOutDrops)
+{
+	if (p == NULL || b == NULL || !b->active)
+		return;
+
+	ft2_profile_stats_t *s = &p->stats;
+	if (atomicLoad(&p->resetRequested)) {
+		memset((void *)s, 0, sizeof(ft2_profile_stats_t));
+		p->scopeDropBase = scopeDrops;
+		p->midiOutDropBase = midiOutDrops;
+		atomicStore(&p->resetRequested, 0);
+	}
+
+	const uint64_t now = ft2_profile_now();
+	b->ticks[FT2_PROFILE_BLOCK] = (uint32_t)(now - b->start);
+
+	for (int32_t i = 0; i < FT2_PROFILE_PHASES; i++) {
+		const uint32_t t = b->ticks[i];
+		s->hist[i][bucketOf(t)]++;
+		if (t > s->maxTicks[i])
+			s->maxTicks[i] = t;
+	}
+
+	const uint32_t budget = (sampleRate > 0) ? (uint32_t)((p->ticksPerSecond * numFrames) / sampleRate) : 0;
+	if (budget > 0 && b->ticks[FT2_PROFILE_BLOCK] > budget)
+		s->overruns++;
+	s->budgetTicks = budget;
+
+	s->voices = voices;
+	if (voices > s->maxVoices)
+		s->maxVoices = voices;
+
+	s->scopeDrops = scopeDrops - p->scopeDropBase;
+	s->midiOutDrops = midiOutDrops - p->midiOutDropBase;
+
+	/* Readers take blocks as the count of what the histograms hold */
+#ifdef _WIN32
+	MemoryBarrier();
+#else
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+	s->blocks++;
+}
+
+static float percentile(const volatile uint32_t *hist, uint32_t total, double q, uint32_t maxTicks, double usPerTick)
+{
+	const uint64_t target = (uint64_t)((double)total * q + 0.999999);
+	uint64_t count = 0;
+
+	for (int32_t i = 0; i < FT2_PROFILE_BUCKETS; i++) {
+		count += hist[i];
+		if (count >= target) {
+			uint64_t ticks = bucketEnd(i);
+			if (ticks > maxTicks)
+				ticks = maxTicks;
+			return (float)((double)ticks * usPerTick);
+		}
+	}
+
+	return (float)((double)maxTicks * usPerTick);
+}
+
+bool ft2_profile_read(const ft2_profile_t *p, ft2_profile_snapshot_t *out)
+{
+	if (p == NULL || out == NULL)
+		return false;
+
+	memset(out, 0, sizeof(ft2_profile_snapshot_t));
+
+	const ft2_profile_stats_t *s = &p->stats;
+	const uint32_t blocks = s->blocks;
+#ifdef _WIN32
+	MemoryBarrier();
+#else
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+	if (blocks == 0)
+		return false;
+
+	const double usPerTick = 1e6 / p->ticksPerSecond;
+	out->blocks = blocks;
+	out->overruns = s->overruns;
+	out->budgetUs = (float)((double)s->budgetTicks * usPerTick);
+	out->voices = s->voices;
+	out->maxVoices = s->maxVoices;
+	out->scopeDrops = s->scopeDrops;
+	out->midiOutDrops = s->midiOutDrops;
+
+	for (int32_t i = 0; i < FT2_PROFILE_PHASES; i++) {
+		const uint32_t maxTicks = s->maxTicks[i];
+		out->phase[i].p50Us = percentile(s->hist[i], blocks, 0.50, maxTicks, usPerTick);
+		out->phase[i].p99Us = percentile(s->hist[i], blocks, 0.99, maxTicks, usPerTick);
+		out->phase[i].maxUs = (float)((double)maxTicks * usPerTick);
+	}
+
+	return true;
+}
+
+const char *ft2_profile_phase_name(int32_t phase)
+{
+	return (phase >= 0 && phase < FT2_PROFILE_PHASES) ? phaseNames[phase] : "";
+}
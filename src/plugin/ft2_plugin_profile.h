@@ -0,0 +1,170 @@
+/**
+ * @file ft2_plugin_profile.h
+ * @brief Per-block timing of the plugin's audio callback.
+ *
+ * processBlock() is cut into phases (waiting for the process lock, MIDI
+ * input, DAW sync, rendering, MIDI output) and each block adds its phase
+ * times to a histogram per phase, along with the number of active voices
+ * and how many scope/MIDI-out entries were dropped because a queue was
+ * full. Times are in ticks of ft2_profile_now(): the TSC on x86, a
+ * monotonic clock in nanoseconds elsewhere.
+ *
+ * The audio thread is the only writer and never waits. Every field it
+ * writes is a 32-bit counter, so a reader (UI or headless) sees each one
+ * whole; a snapshot taken while a block is being added may be one block
+ * out between phases, which the percentiles don't notice. Resetting is a
+ * request the audio thread carries out at its next block.
+ *
+ * Profiling is off until ft2_profile_set_enabled(); while off a block
+ * costs one timestamp and a flag test. Built with FT2_PROFILING=0 the
+ * inline functions are empty and nothing is recorded.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#ifndef FT2_PROFILING
+#define FT2_PROFILING 1
+#endif
+
+#if FT2_PROFILING
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define FT2_PROFILE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define FT2_PROFILE_TSC 1
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+	FT2_PROFILE_LOCK = 0, /* Waiting for the process lock */
+	FT2_PROFILE_MIDI_IN,
+	FT2_PROFILE_SYNC,     /* DAW BPM/transport sync and time map lookup */
+	FT2_PROFILE_RENDER,   /* Replayer and mixer, multi-out copies */
+	FT2_PROFILE_MIDI_OUT,
+	FT2_PROFILE_BLOCK,    /* The whole callback */
+	FT2_PROFILE_PHASES
+};
+
+/* Log-linear buckets: 8 per octave (12% wide), the first 8 exact */
+#define FT2_PROFILE_SUB_BITS 3
+#define FT2_PROFILE_BUCKETS  ((32 - FT2_PROFILE_SUB_BITS + 1) << FT2_PROFILE_SUB_BITS)
+
+typedef struct ft2_profile_stats_t {
+	volatile uint32_t blocks;
+	volatile uint32_t overruns;   /* Blocks that took longer than they play */
+	volatile uint32_t maxTicks[FT2_PROFILE_PHASES];
+	volatile uint32_t hist[FT2_PROFILE_PHASES][FT2_PROFILE_BUCKETS];
+	volatile int32_t voices, maxVoices;
+	volatile uint32_t scopeDrops, midiOutDrops;
+	volatile uint32_t budgetTicks; /* Length of the last block */
+} ft2_profile_stats_t;
+
+typedef struct ft2_profile_t {
+	volatile int32_t enabled;
+	volatile int32_t resetRequested;
+	uint32_t scopeDropBase, midiOutDropBase; /* Queue counts at the last reset */
+	double ticksPerSecond;
+	ft2_profile_stats_t stats;
+} ft2_profile_t;
+
+/* One block's phase times, kept on the audio thread's stack */
+typedef struct ft2_profile_block_t {
+	uint64_t start, last;
+	uint32_t ticks[FT2_PROFILE_PHASES];
+	bool active;
+} ft2_profile_block_t;
+
+typedef struct ft2_profile_phase_t {
+	float p50Us, p99Us, maxUs;
+} ft2_profile_phase_t;
+
+typedef struct ft2_profile_snapshot_t {
+	uint32_t blocks, overruns;
+	float budgetUs;
+	ft2_profile_phase_t phase[FT2_PROFILE_PHASES];
+	int32_t voices, maxVoices;
+	uint32_t scopeDrops, midiOutDrops;
+} ft2_profile_snapshot_t;
+
+#if FT2_PROFILING
+uint64_t ft2_profile_clock(void); /* Non-TSC fallback, nanoseconds */
+
+static inline uint64_t ft2_profile_now(void)
+{
+#ifdef FT2_PROFILE_TSC
+	return __rdtsc();
+#else
+	return ft2_profile_clock();
+#endif
+}
+
+static inline bool ft2_profile_enabled(const ft2_profile_t *p)
+{
+	return p->enabled != 0;
+}
+
+/* Audio thread: start of the callback, before anything can wait */
+static inline void ft2_profile_begin(ft2_profile_block_t *b)
+{
+	b->start = b->last = ft2_profile_now();
+	b->active = false;
+}
+
+/* Audio thread: once the profile can be read (the instance is locked).
+ * The time so far goes to the lock phase. */
+static inline void ft2_profile_attach(ft2_profile_block_t *b, const ft2_profile_t *p)
+{
+	b->active = ft2_profile_enabled(p);
+	if (b->active) {
+		memset(b->ticks, 0, sizeof(b->ticks));
+		b->last = ft2_profile_now();
+		b->ticks[FT2_PROFILE_LOCK] = (uint32_t)(b->last - b->start);
+	}
+}
+
+/* Audio thread: the time since the previous mark belongs to phase */
+static inline void ft2_profile_mark(ft2_profile_block_t *b, int32_t phase)
+{
+	if (b->active) {
+		const uint64_t t = ft2_profile_now();
+		b->ticks[phase] += (uint32_t)(t - b->last);
+		b->last = t;
+	}
+}
+#else
+static inline uint64_t ft2_profile_now(void) { return 0; }
+static inline bool ft2_profile_enabled(const ft2_profile_t *p) { (void)p; return false; }
+static inline void ft2_profile_begin(ft2_profile_block_t *b) { b->active = false; }
+static inline void ft2_profile_attach(ft2_profile_block_t *b, const ft2_profile_t *p) { (void)b; (void)p; }
+static inline void ft2_profile_mark(ft2_profile_block_t *b, int32_t phase) { (void)b; (void)phase; }
+#endif
+
+void ft2_profile_init(ft2_profile_t *p);
+void ft2_profile_set_enabled(ft2_profile_t *p, bool enabled);
+
+/* Audio thread, end of an active block: adds it to the stats. The drop
+ * counts are the queues' running totals. */
+void ft2_profile_end(ft2_profile_t *p, ft2_profile_block_t *b, uint32_t numFrames, uint32_t sampleRate,
+	int32_t voices, uint32_t scopeDrops, uint32_t midiOutDrops);
+
+/* Any thread: clears the stats at the audio thread's next block */
+void ft2_profile_reset(ft2_profile_t *p);
+
+/* Any thread: percentiles and maxima so far, in microseconds. Returns
+ * false if nothing has been recorded since the last reset. */
+bool ft2_profile_read(const ft2_profile_t *p, ft2_profile_snapshot_t *out);
+
+const char *ft2_profile_phase_name(int32_t phase);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file ft2_plugin_rate_tables.c
+ * @brief Period->delta lookup tables, shared across instances.
+ *
+ * Rate tables live in a small list keyed by sample rate (a session rarely
+ * uses more than one or two rates). Entries are freed when their last
+ * instance releases them.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ft2_plugin_rate_tables.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+static SRWLOCK g_registryLock = SRWLOCK_INIT;
+#define registryLock()   AcquireSRWLockExclusive(&g_registryLock)
+#define registryUnlock() ReleaseSRWLockExclusive(&g_registryLock)
+#define exchangePtr(slot, p) InterlockedExchangePointer((PVOID volatile *)(slot), (PVOID)(p))
+#else
+#include <pthread.h>
+static pthread_mutex_t g_registryLock = PTHREAD_MUTEX_INITIALIZER;
+#define registryLock()   pthread_mutex_lock(&g_registryLock)
+#define registryUnlock() pthread_mutex_unlock(&g_registryLock)
+#define exchangePtr(slot, p) __atomic_exchange_n((slot), (p), __ATOMIC_ACQ_REL)
+#endif
+
+#define SCOPE_FRAC_SCALE ((int64_t)1 << 32)
+#define SCOPE_HZ 64
+#define C4_FREQ 8363.0
+
+static ft2_rate_tables_t *g_rateTables; /* Guarded by the registry lock */
+static ft2_scope_tables_t g_scopeTables;
+static bool g_scopeTablesReady;
+
+static inline double logTabValue(int32_t i)
+{
+	return (8363.0 * 256.0) * exp2(i / (4.0 * 12.0 * 16.0));
+}
+
+/* Matches standalone calcMiscReplayerVars() + calcReplayerVars() */
+static void calcRateTables(ft2_rate_tables_t *t, uint32_t sampleRate)
+{
+	const double dSampleRate = (double)sampleRate;
+	const double logTabMul = (UINT32_MAX + 1.0) / dSampleRate;
+
+	for (int32_t i = 0; i < FT2_LOG_TAB_LEN; i++) {
+		const double dLogTabVal = logTabValue(i);
+		t->dLogTab[i] = dLogTabVal;
+		t->logTab[i] = (uint64_t)round(dLogTabVal * logTabMul);
+	}
+
+	t->amigaPeriodDiv = (uint64_t)round((UINT32_MAX + 1.0) * (1712.0 * 8363.0) / dSampleRate);
+}
+
+/* Matches standalone calcMiscReplayerVars() (scope part) */
+static void calcScopeTables(ft2_scope_tables_t *t)
+{
+	for (int32_t i = 0; i < FT2_LOG_TAB_LEN; i++) {
+		const double dLogTab = logTabValue(i);
+		t->scopeLogTab[i] = (uint64_t)round(dLogTab * (SCOPE_FRAC_SCALE / SCOPE_HZ));
+		t->scopeDrawLogTab[i] = (uint64_t)round(dLogTab * (SCOPE_FRAC_SCALE / (C4_FREQ / 2.0)));
+	}
+
+	t->scopeAmigaPeriodDiv = (uint64_t)round((SCOPE_FRAC_SCALE * (1712.0 * 8363.0)) / SCOPE_HZ);
+	t->scopeDrawAmigaPeriodDiv = (uint64_t)round((SCOPE_FRAC_SCALE * (1712.0 * 8363.0)) / (C4_FREQ / 2.0));
+}
+
+static const ft2_rate_tables_t *acquire(uint32_t sampleRate)
+{
+	registryLock();
+
+	if (!g_scopeTablesReady) {
+		calcScopeTables(&g_scopeTables);
+		g_scopeTablesReady = true;
+	}
+
+	for (ft2_rate_tables_t *t = g_rateTables; t != NULL; t = t->next) {
+		if (t->sampleRate == sampleRate) {
+			t->refCount++;
+			registryUnlock();
+			return t;
+		}
+	}
+
+	/* Built under the lock: it only takes a few microseconds */
+	ft2_rate_tables_t *t = (ft2_rate_tables_t *)malloc(sizeof(ft2_rate_tables_t));
+	if (t != NULL) {
+		calcRateTables(t, sampleRate);
+		t->sampleRate = sampleRate;
+		t->refCount = 1;
+		t->next = g_rateTables;
+		g_rateTables = t;
+	}
+
+	registryUnlock();
+	return t;
+}
+
+static void release(const ft2_rate_tables_t *tables)
+{
+	if (tables == NULL)
+		return;
+
+	registryLock();
+
+	ft2_rate_tables_t **pp = &g_rateTables;
+	while (*pp != NULL && *pp != tables)
+		pp = &(*pp)->next;
+
+	ft2_rate_tables_t *t = *pp;
+	if (t != NULL && --t->refCount <= 0) {
+		*pp = t->next;
+		free(t);
+	}
+
+	registryUnlock();
+}
+
+bool ft2_rate_tables_set(const ft2_rate_tables_t **slot, uint32_t sampleRate)
+{
+	if (slot == NULL || sampleRate == 0)
+		return false;
+
+	if (*slot != NULL && (*slot)->sampleRate == sampleRate)
+		return true;
+
+	const ft2_rate_tables_t *tables = acquire(sampleRate);
+	if (tables == NULL)
+		return false;
+
+	release(exchangePtr(slot, tables));
+	return true;
+}
+
+void ft2_rate_tables_clear(const ft2_rate_tables_t **slot)
+{
+	if (slot == NULL)
+		return;
+
+	release(exchangePtr(slot, (const ft2_rate_tables_t *)NULL));
+}
+
+const ft2_scope_tables_t *ft2_scope_tables_get(void)
+{
+	return &g_scopeTables;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file ft2_plugin_rate_tables.h
+ * @brief Period->delta lookup tables, shared across instances.
+ *
+ * The mixer tables (logTab, dLogTab, amigaPeriodDiv) depend only on the
+ * output rate, so they are built once per distinct rate and handed out as
+ * reference counted, read-only handles. Each instance holds one handle and
+ * swaps it on a sample rate change.
+ *
+ * The scope tables don't depend on the output rate at all (fixed 64 Hz
+ * update rate and C4 draw rate); one copy is built for the whole process.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FT2_LOG_TAB_LEN (4 * 12 * 16)
+
+typedef struct ft2_rate_tables_t {
+	uint64_t logTab[FT2_LOG_TAB_LEN];
+	uint64_t amigaPeriodDiv;
+	double dLogTab[FT2_LOG_TAB_LEN];
+
+	/* Registry bookkeeping (guarded by the registry lock) */
+	uint32_t sampleRate;
+	int32_t refCount;
+	struct ft2_rate_tables_t *next;
+} ft2_rate_tables_t;
+
+typedef struct ft2_scope_tables_t {
+	uint64_t scopeLogTab[FT2_LOG_TAB_LEN];
+	uint64_t scopeDrawLogTab[FT2_LOG_TAB_LEN];
+	uint64_t scopeAmigaPeriodDiv, scopeDrawAmigaPeriodDiv;
+} ft2_scope_tables_t;
+
+/* Points *slot at the tables for sampleRate: takes a reference to them
+ * (building them if no instance uses that rate yet), swaps the pointer
+ * atomically and releases the previous tables. Returns false and leaves
+ * *slot unchanged if the tables could not be allocated. */
+bool ft2_rate_tables_set(const ft2_rate_tables_t **slot, uint32_t sampleRate);
+
+/* Releases *slot and sets it to NULL (NULL slot contents are ignored) */
+void ft2_rate_tables_clear(const ft2_rate_tables_t **slot);
+
+/* Process-wide scope tables (valid once any rate tables have been set) */
+const ft2_scope_tables_t *ft2_scope_tables_get(void);
+
+#ifdef __cplusplus
+}
+#endif
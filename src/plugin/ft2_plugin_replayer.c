@@ -117,6 +117,83 @@ void ft2_stop_sample_voices(ft2_instance_t *inst, ft2_sample_t *smp)
 	}
 }
 
+/* Moves voices playing r->oldData over to the edited sample, keeping their
+** position (see ft2_plugin_sample_handoff.h). Called at block start. */
+void ft2_rebase_sample_voices(ft2_instance_t *inst, const ft2_sample_rebase_t *r)
+{
+	for (int32_t i = 0; i < FT2_MAX_CHANNELS * 2; i++)
+	{
+		ft2_voice_t *v = &inst->voice[i];
+		if (!v->active)
+			continue;
+
+		const int8_t *base = (v->base16 != NULL) ? (const int8_t *)v->base16 : v->base8;
+		if (base != r->oldData)
+			continue;
+
+		if (r->data == NULL || r->length < 1)
+		{
+			/* Sample was cleared, nothing left to play */
+			memset(v, 0, sizeof(ft2_voice_t));
+			v->panning = 128;
+			continue;
+		}
+
+		const bool sample16Bit = !!(r->flags & FT2_SAMPLE_16BIT);
+		const int32_t loopEnd = r->loopStart + r->loopLength;
+		uint8_t loopType = r->flags & (FT2_LOOP_FWD | FT2_LOOP_BIDI);
+		if (r->loopLength < 1)
+			loopType = 0;
+
+		const int32_t sampleEnd = (loopType == 0) ? r->length : loopEnd;
+		int32_t position = v->position;
+		bool hasLooped = v->hasLooped && (loopType != 0);
+
+		/* Only keep heading backwards inside a bidi loop */
+		bool backwards = v->samplingBackwards && (loopType == FT2_LOOP_BIDI) && (position >= r->loopStart);
+
+		if (position >= sampleEnd)
+		{
+			if (loopType == 0)
+			{
+				/* Already past the new end */
+				memset(v, 0, sizeof(ft2_voice_t));
+				v->panning = 128;
+				continue;
+			}
+
+			position = r->loopStart + (position - r->loopStart) % r->loopLength;
+			hasLooped = true;
+		}
+
+		if (sample16Bit)
+		{
+			v->base16 = (const int16_t *)r->data;
+			v->base8 = NULL;
+			v->revBase16 = &v->base16[r->loopStart + loopEnd];
+			v->leftEdgeTaps16 = r->leftEdgeTaps16;
+		}
+		else
+		{
+			v->base8 = r->data;
+			v->base16 = NULL;
+			v->revBase8 = &v->base8[r->loopStart + loopEnd];
+			v->leftEdgeTaps8 = r->leftEdgeTaps8;
+		}
+
+		v->hasLooped = hasLooped;
+		v->samplingBackwards = backwards;
+		v->loopType = loopType;
+		v->sampleEnd = sampleEnd;
+		v->loopStart = r->loopStart;
+		v->loopLength = r->loopLength;
+		v->position = position;
+
+		/* Same interpolation, new bit depth/loop type */
+		v->mixFuncOffset = (uint8_t)(((v->mixFuncOffset / 6) * 6) + ((int32_t)sample16Bit * 3) + loopType);
+	}
+}
+
 /* Converts period to 32.32 fixed-point delta for the mixer */
 uint64_t ft2_period_to_delta(ft2_instance_t *inst, uint32_t period)
 {
@@ -130,12 +207,12 @@ uint64_t ft2_period_to_delta(ft2_instance_t *inst, uint32_t period)
 		const uint32_t invPeriod = ((12 * 192 * 4) - period) & 0xFFFF;
 		const uint32_t quotient  = invPeriod / (12 * 16 * 4);
 		const uint32_t remainder = invPeriod % (12 * 16 * 4);
-		return inst->replayer.logTab[remainder] >> ((14 - quotient) & 31);
+		return inst->rateTables->logTab[remainder] >> ((14 - quotient) & 31);
 	}
 	else
 	{
 		/* Amiga: simple division (period = clock / freq) */
-		return inst->replayer.amigaPeriodDiv / period;
+		return inst->rateTables->amigaPeriodDiv / period;
 	}
 }
 
@@ -292,17 +369,8 @@ void ft2_set_bpm(ft2_instance_t *inst, int32_t bpm)
 	ft2_instance_init_bpm_vars(inst);
 }
 
-void ft2_set_interpolation(ft2_instance_t *inst, uint8_t type)
-{
-	if (!inst)
-		return;
-	if (type >= FT2_NUM_INTERP_MODES)
-		type = FT2_INTERP_LINEAR;
-	inst->audio.interpolationType = type;
-}
-
 /* Selects appropriate sinc kernel based on playback rate (delta) */
-static void updateVoiceSincLUT(ft2_instance_t *inst, ft2_voice_t *v)
+void ft2_voice_update_sinc_lut(ft2_instance_t *inst, ft2_voice_t *v)
 {
 	if (inst->audio.interpolationType != FT2_INTERP_SINC8 &&
 	    inst->audio.interpolationType != FT2_INTERP_SINC16)
@@ -316,6 +384,19 @@ static void updateVoiceSincLUT(ft2_instance_t *inst, ft2_voice_t *v)
 	v->fSincLUT = ft2_select_sinc_kernel(v->delta, tables, &is16Point);
 }
 
+void ft2_set_interpolation(ft2_instance_t *inst, uint8_t type)
+{
+	if (!inst)
+		return;
+	if (type >= FT2_NUM_INTERP_MODES)
+		type = FT2_INTERP_LINEAR;
+	inst->audio.interpolationType = type;
+
+	/* Voices (incl. fade-out voices) started in another mode have no sinc kernel yet */
+	for (int32_t i = 0; i < FT2_MAX_CHANNELS * 2; i++)
+		ft2_voice_update_sinc_lut(inst, &inst->voice[i]);
+}
+
 /* ------------------------------------------------------------------------- */
 /*                       KEY OFF / TRIGGER HELPERS                           */
 /* ------------------------------------------------------------------------- */
@@ -2127,9 +2208,9 @@ void ft2_replayer_tick(ft2_instance_t *inst)
 		s->curReplayerPattNum = (uint8_t)s->pattNum;
 		s->curReplayerSongPos = (uint8_t)s->songPos;
 
-		ft2_note_t *patternPtr = rep->nilPatternLine;
-		if (rep->pattern[s->pattNum] != NULL)
-			patternPtr = &rep->pattern[s->pattNum][s->row * FT2_MAX_CHANNELS];
+		ft2_note_t *patternPtr = ft2_pattern_row(inst, s->pattNum, s->row);
+		if (patternPtr == NULL)
+			patternPtr = rep->nilPatternLine;
 
 		for (int32_t i = 0; i < s->numChannels; i++)
 		{
@@ -2195,7 +2276,7 @@ void ft2_update_voices(ft2_instance_t *inst)
 		if (status & FT2_CF_UPDATE_PERIOD)
 		{
 			v->delta = ft2_period_to_delta(inst, ch->finalPeriod);
-			updateVoiceSincLUT(inst, v);
+			ft2_voice_update_sinc_lut(inst, v);
 		}
 
 		if (status & FT2_CS_TRIGGER_VOICE)
@@ -2748,92 +2829,146 @@ static void silenceMixRoutine(ft2_voice_t *v, int32_t numSamples)
 	v->position = position;
 }
 
-/* Main mixing entry point - mixes all active voices to stereo buffer */
-void ft2_mix_voices(ft2_instance_t *inst, int32_t bufferPos, int32_t samplesToMix)
+/* Mixes a voice with the kernel for its sample format and loop type */
+static void mixVoice(ft2_instance_t *inst, ft2_voice_t *v, uint32_t numSamples)
 {
-	if (!inst || samplesToMix <= 0)
-		return;
+	const bool is16Bit = (v->base16 != NULL && v->base8 == NULL);
 
-	for (int32_t i = 0; i < inst->replayer.song.numChannels; i++)
+	switch (v->loopType)
 	{
-		ft2_voice_t *v = &inst->voice[i];
-		if (!v->active)
-			continue;
+		case FT2_LOOP_OFF:
+			if (is16Bit)
+				mixVoice16BitNoLoop(inst, v, numSamples);
+			else
+				mixVoice8BitNoLoop(inst, v, numSamples);
+			break;
 
-		const bool volRampFlag = (v->volumeRampLength > 0);
-		if (!volRampFlag && v->fCurrVolumeL == 0.0f && v->fCurrVolumeR == 0.0f)
-		{
-			/* Voice is silent - advance position but don't mix */
-			silenceMixRoutine(v, samplesToMix);
-			continue;
-		}
+		case FT2_LOOP_FWD:
+			if (is16Bit)
+				mixVoice16BitLoop(inst, v, numSamples);
+			else
+				mixVoice8BitLoop(inst, v, numSamples);
+			break;
+
+		case FT2_LOOP_BIDI:
+			if (is16Bit)
+				mixVoice16BitBidi(inst, v, numSamples);
+			else
+				mixVoice8BitBidi(inst, v, numSamples);
+			break;
+	}
+}
+
+/* Frames every voice adds to before the mix moves on: 2 KiB per buffer */
+#define MIX_TILE_FRAMES 256
 
-		const bool is16Bit = (v->base16 != NULL && v->base8 == NULL);
+/* A voice to mix and the buffers it adds to */
+typedef struct mixEntry_t
+{
+	ft2_voice_t *v;
+	float *fBufferL, *fBufferR;
+} mixEntry_t;
+
+/* Mixes the voices a tile at a time, so each tile of the buffers stays in
+** cache while all voices add to it. The kernels carry their state from one
+** tile to the next and every buffer gets the voices in list order, so the
+** sums are the same as mixing each voice over the whole span in turn.
+** While the levels are read, a voice's tile goes to cleared scratch buffers
+** first, and the meter measures exactly what it adds as it adds it. */
+static void mixVoiceList(ft2_instance_t *inst, mixEntry_t *list, int32_t numVoices, int32_t samplesToMix)
+{
+	FT2_CACHE_ALIGNED float fTileL[MIX_TILE_FRAMES];
+	FT2_CACHE_ALIGNED float fTileR[MIX_TILE_FRAMES];
+	float *origMixL = inst->audio.fMixBufferL;
+	float *origMixR = inst->audio.fMixBufferR;
+	const bool metered = ft2_meter_active(&inst->meter);
+
+	if (metered)
+	{
+		memset(fTileL, 0, sizeof(fTileL));
+		memset(fTileR, 0, sizeof(fTileR));
+		inst->audio.fMixBufferL = fTileL;
+		inst->audio.fMixBufferR = fTileR;
+	}
+
+	for (int32_t pos = 0; pos < samplesToMix; pos += MIX_TILE_FRAMES)
+	{
+		const int32_t tileLen = (samplesToMix - pos < MIX_TILE_FRAMES) ? samplesToMix - pos : MIX_TILE_FRAMES;
 
-		switch (v->loopType)
+		for (int32_t i = 0; i < numVoices; i++)
 		{
-			case FT2_LOOP_OFF:
-				if (is16Bit)
-					mixVoice16BitNoLoop(inst, v, samplesToMix);
-				else
-					mixVoice8BitNoLoop(inst, v, samplesToMix);
-				break;
+			ft2_voice_t *v = list[i].v;
 
-			case FT2_LOOP_FWD:
-				if (is16Bit)
-					mixVoice16BitLoop(inst, v, samplesToMix);
-				else
-					mixVoice8BitLoop(inst, v, samplesToMix);
-				break;
+			/* A non-looping voice stops for good at its sample end */
+			if (!v->active)
+				continue;
 
-			case FT2_LOOP_BIDI:
-				if (is16Bit)
-					mixVoice16BitBidi(inst, v, samplesToMix);
-				else
-					mixVoice8BitBidi(inst, v, samplesToMix);
-				break;
+			if (metered)
+			{
+				mixVoice(inst, v, (uint32_t)tileLen);
+				ft2_meter_mix_tile(&inst->meter, (int32_t)(v - inst->voice), fTileL, fTileR,
+					list[i].fBufferL + pos, list[i].fBufferR + pos, tileLen);
+			}
+			else
+			{
+				inst->audio.fMixBufferL = list[i].fBufferL + pos;
+				inst->audio.fMixBufferR = list[i].fBufferR + pos;
+				mixVoice(inst, v, (uint32_t)tileLen);
+			}
 		}
 	}
 
-	/* Process fadeout voices */
-	for (int32_t i = FT2_MAX_CHANNELS; i < FT2_MAX_CHANNELS * 2; i++)
-	{
-		ft2_voice_t *v = &inst->voice[i];
-		if (!v->active)
-			continue;
+	inst->audio.fMixBufferL = origMixL;
+	inst->audio.fMixBufferR = origMixR;
+}
 
+/* Queues a voice for mixVoiceList(). Silent voices are only advanced and
+** finished fadeout voices stopped, decided once for the whole span. */
+static void addToMixList(mixEntry_t *list, int32_t *numVoices, ft2_voice_t *v, bool fadeout,
+	float *fBufferL, float *fBufferR, int32_t samplesToMix)
+{
+	if (!v->active)
+		return;
+
+	if (fadeout)
+	{
 		if (v->volumeRampLength == 0)
 		{
 			v->active = false;
-			continue;
+			return;
 		}
+	}
+	else if (v->volumeRampLength == 0 && v->fCurrVolumeL == 0.0f && v->fCurrVolumeR == 0.0f)
+	{
+		/* Voice is silent - advance position but don't mix */
+		silenceMixRoutine(v, samplesToMix);
+		return;
+	}
 
-		const bool is16Bit = (v->base16 != NULL && v->base8 == NULL);
+	mixEntry_t *e = &list[(*numVoices)++];
+	e->v = v;
+	e->fBufferL = fBufferL;
+	e->fBufferR = fBufferR;
+}
 
-		switch (v->loopType)
-		{
-			case FT2_LOOP_OFF:
-				if (is16Bit)
-					mixVoice16BitNoLoop(inst, v, samplesToMix);
-				else
-					mixVoice8BitNoLoop(inst, v, samplesToMix);
-				break;
+/* Main mixing entry point - mixes all active voices to stereo buffer */
+void ft2_mix_voices(ft2_instance_t *inst, int32_t bufferPos, int32_t samplesToMix)
+{
+	if (!inst || samplesToMix <= 0)
+		return;
 
-			case FT2_LOOP_FWD:
-				if (is16Bit)
-					mixVoice16BitLoop(inst, v, samplesToMix);
-				else
-					mixVoice8BitLoop(inst, v, samplesToMix);
-				break;
+	mixEntry_t list[FT2_MAX_CHANNELS * 2];
+	int32_t numVoices = 0;
+	float *fMixL = inst->audio.fMixBufferL, *fMixR = inst->audio.fMixBufferR;
 
-			case FT2_LOOP_BIDI:
-				if (is16Bit)
-					mixVoice16BitBidi(inst, v, samplesToMix);
-				else
-					mixVoice8BitBidi(inst, v, samplesToMix);
-				break;
-		}
-	}
+	for (int32_t i = 0; i < inst->replayer.song.numChannels; i++)
+		addToMixList(list, &numVoices, &inst->voice[i], false, fMixL, fMixR, samplesToMix);
+
+	/* Process fadeout voices */
+	for (int32_t i = FT2_MAX_CHANNELS; i < FT2_MAX_CHANNELS * 2; i++)
+		addToMixList(list, &numVoices, &inst->voice[i], true, fMixL, fMixR, samplesToMix);
+
+	mixVoiceList(inst, list, numVoices, samplesToMix);
 }
 
 /* Multi-output mixing - routes each channel to its configured output pair */
@@ -2842,8 +2977,8 @@ void ft2_mix_voices_multiout(ft2_instance_t *inst, int32_t bufferPos, int32_t sa
 	if (!inst || samplesToMix <= 0 || !inst->audio.multiOutEnabled)
 		return;
 
-	float *origMixL = inst->audio.fMixBufferL;
-	float *origMixR = inst->audio.fMixBufferR;
+	mixEntry_t list[FT2_MAX_CHANNELS * 2];
+	int32_t numVoices = 0;
 
 	for (int32_t ch = 0; ch < inst->replayer.song.numChannels && ch < FT2_MAX_CHANNELS; ch++)
 	{
@@ -2852,91 +2987,14 @@ void ft2_mix_voices_multiout(ft2_instance_t *inst, int32_t bufferPos, int32_t sa
 		if (outIdx >= FT2_NUM_OUTPUTS)
 			outIdx = ch % FT2_NUM_OUTPUTS; /* Fallback for invalid config */
 
-		/* Point mix buffers to routed output buffer at the correct offset */
-		inst->audio.fMixBufferL = inst->audio.fChannelBufferL[outIdx] + bufferPos;
-		inst->audio.fMixBufferR = inst->audio.fChannelBufferR[outIdx] + bufferPos;
-
-		/* Mix main voice for this channel */
-		ft2_voice_t *v = &inst->voice[ch];
-		if (v->active)
-		{
-			const bool volRampFlag = (v->volumeRampLength > 0);
-			if (volRampFlag || v->fCurrVolumeL != 0.0f || v->fCurrVolumeR != 0.0f)
-			{
-				const bool is16Bit = (v->base16 != NULL && v->base8 == NULL);
-
-				switch (v->loopType)
-				{
-					case FT2_LOOP_OFF:
-						if (is16Bit)
-							mixVoice16BitNoLoop(inst, v, samplesToMix);
-						else
-							mixVoice8BitNoLoop(inst, v, samplesToMix);
-						break;
-
-					case FT2_LOOP_FWD:
-						if (is16Bit)
-							mixVoice16BitLoop(inst, v, samplesToMix);
-						else
-							mixVoice8BitLoop(inst, v, samplesToMix);
-						break;
-
-					case FT2_LOOP_BIDI:
-						if (is16Bit)
-							mixVoice16BitBidi(inst, v, samplesToMix);
-						else
-							mixVoice8BitBidi(inst, v, samplesToMix);
-						break;
-				}
-			}
-			else
-			{
-				silenceMixRoutine(v, samplesToMix);
-			}
-		}
-
-		/* Mix fadeout voice for this channel */
-		ft2_voice_t *fadeV = &inst->voice[FT2_MAX_CHANNELS + ch];
-		if (fadeV->active)
-		{
-			if (fadeV->volumeRampLength == 0)
-			{
-				fadeV->active = false;
-			}
-			else
-			{
-				const bool is16Bit = (fadeV->base16 != NULL && fadeV->base8 == NULL);
-
-				switch (fadeV->loopType)
-				{
-					case FT2_LOOP_OFF:
-						if (is16Bit)
-							mixVoice16BitNoLoop(inst, fadeV, samplesToMix);
-						else
-							mixVoice8BitNoLoop(inst, fadeV, samplesToMix);
-						break;
-
-					case FT2_LOOP_FWD:
-						if (is16Bit)
-							mixVoice16BitLoop(inst, fadeV, samplesToMix);
-						else
-							mixVoice8BitLoop(inst, fadeV, samplesToMix);
-						break;
-
-					case FT2_LOOP_BIDI:
-						if (is16Bit)
-							mixVoice16BitBidi(inst, fadeV, samplesToMix);
-						else
-							mixVoice8BitBidi(inst, fadeV, samplesToMix);
-						break;
-				}
-			}
-		}
+		/* Main voice, then fadeout voice, to the routed output buffer at the correct offset */
+		float *fOutL = inst->audio.fChannelBufferL[outIdx] + bufferPos;
+		float *fOutR = inst->audio.fChannelBufferR[outIdx] + bufferPos;
+		addToMixList(list, &numVoices, &inst->voice[ch], false, fOutL, fOutR, samplesToMix);
+		addToMixList(list, &numVoices, &inst->voice[FT2_MAX_CHANNELS + ch], true, fOutL, fOutR, samplesToMix);
 	}
 
-	/* Restore original mix buffer pointers */
-	inst->audio.fMixBufferL = origMixL;
-	inst->audio.fMixBufferR = origMixR;
+	mixVoiceList(inst, list, numVoices, samplesToMix);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -28,7 +28,9 @@ void ft2_stop_voice(ft2_instance_t *inst, int32_t voiceNum);
 void ft2_stop_all_voices(ft2_instance_t *inst);
 void ft2_fadeout_all_voices(ft2_instance_t *inst);
 void ft2_stop_sample_voices(ft2_instance_t *inst, struct ft2_sample_t *smp);
+void ft2_rebase_sample_voices(ft2_instance_t *inst, const ft2_sample_rebase_t *r);
 void ft2_voice_update_volumes(ft2_instance_t *inst, int32_t voiceNum, uint8_t status);
+void ft2_voice_update_sinc_lut(ft2_instance_t *inst, ft2_voice_t *v);
 void ft2_reset_ramp_volumes(ft2_instance_t *inst);
 
 /* Channel helpers (for keyjazz/preview) */
@@ -2,6 +2,8 @@
 ** FT2 Plugin - Resample Modal Panel
 ** Resamples current sample by relative halftones (-36 to +36).
 ** Adjusts sample length and relative note to maintain pitch.
+** The conversion is band-limited (ft2_plugin_resampler.c) and runs as a
+** background sample job.
 */
 
 #include <string.h>
@@ -16,6 +18,10 @@
 #include "ft2_plugin_sample_ed.h"
 #include "ft2_plugin_replayer.h"
 #include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_sample_job.h"
+#include "ft2_plugin_resampler.h"
+#include "ft2_plugin_smpfx.h"
 #include "../ft2_instance.h"
 
 #define MAX_SAMPLE_LEN 0x3FFFFFFF
@@ -142,12 +148,79 @@ static void drawFrame(ft2_instance_t *inst, ft2_video_t *video, const ft2_bmp_t
 	}
 }
 
+typedef struct resample_job_t
+{
+	ft2_sample_job_source_t src;
+	int8_t *newOrigPtr, *newData;
+	uint32_t newLen;
+	double dRatio;
+	int8_t relReSmp;
+} resample_job_t;
+
+static void freeResampleJob(resample_job_t *rj)
+{
+	if (!rj) return;
+	ft2_sample_job_free_source(&rj->src);
+	free(rj->newOrigPtr);
+	free(rj);
+}
+
+static bool resampleJobRun(ft2_sample_job_t *job, void *userData)
+{
+	resample_job_t *rj = (resample_job_t *)userData;
+
+	ft2_resampler_t rs;
+	if (!ft2_resampler_init(&rs, rj->dRatio)) return false;
+
+	const ft2_resample_source_t src = { rj->src.data, rj->src.length, rj->src.loopStart, rj->src.loopLength, rj->src.flags };
+	bool completed = ft2_resampler_run(&rs, &src, rj->newData, (int32_t)rj->newLen, job);
+
+	ft2_resampler_free(&rs);
+	return completed;
+}
+
+static void resampleJobDone(ft2_instance_t *inst, void *userData, bool completed)
+{
+	resample_job_t *rj = (resample_job_t *)userData;
+
+	/* Only if the sample is still the one that was resampled */
+	ft2_sample_t *s = (completed && inst && inst->ui) ? getCurrentSample(inst) : NULL;
+	if (!ft2_sample_job_source_is_current(&rj->src, s))
+	{
+		freeResampleJob(rj);
+		return;
+	}
+
+	fillSampleUndo(inst, false);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s))
+	{
+		freeResampleJob(rj);
+		return;
+	}
+
+	if (s->origDataPtr) ft2_sample_pool_release(s->origDataPtr);
+	s->origDataPtr = rj->newOrigPtr;
+	s->dataPtr = rj->newData;
+	s->relativeNote += rj->relReSmp;
+	s->length = rj->newLen;
+	s->loopStart = (int32_t)(s->loopStart * rj->dRatio);
+	s->loopLength = (int32_t)(s->loopLength * rj->dRatio);
+	rj->newOrigPtr = NULL;
+
+	ft2_sanitize_sample(s);
+	ft2_fix_sample(s);
+	inst->uiState.updateSampleEditor = true;
+	freeResampleJob(rj);
+}
+
 static void applyResampleToSample(ft2_instance_t *inst)
 {
 	if (!inst || !inst->ui) return;
 	resample_panel_state_t *state = RES_STATE(inst);
 	ft2_sample_t *s = getCurrentSample(inst);
 	if (!s || !s->dataPtr || s->length == 0) return;
+	if (state->relReSmp == 0) return;
 
 	bool sample16Bit = (s->flags & FT2_SAMPLE_16BIT) != 0;
 	const double dRatio = pow(2.0, (int32_t)state->relReSmp * (1.0 / 12.0));
@@ -161,52 +234,22 @@ static void applyResampleToSample(ft2_instance_t *inst)
 	int32_t padding = FT2_MAX_TAPS * bytesPerSample;
 	size_t allocSize = (size_t)(padding + newLen * bytesPerSample + padding);
 
-	int8_t *newOrigPtr = (int8_t *)calloc(allocSize, 1);
-	if (!newOrigPtr) return;
-	int8_t *newData = newOrigPtr + padding;
+	resample_job_t *rj = (resample_job_t *)calloc(1, sizeof(resample_job_t));
+	if (!rj) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
-
-	const uint64_t delta64 = (uint64_t)round(4294967296.0 / dRatio);
-	uint64_t posFrac64 = 0;
-
-	if (sample16Bit)
-	{
-		const int16_t *src16 = (const int16_t *)s->dataPtr;
-		int16_t *dst16 = (int16_t *)newData;
-		for (uint32_t i = 0; i < newLen; i++)
-		{
-			uint32_t srcIdx = (uint32_t)(posFrac64 >> 32);
-			if (srcIdx >= (uint32_t)s->length) srcIdx = s->length - 1;
-			dst16[i] = src16[srcIdx];
-			posFrac64 += delta64;
-		}
-	}
-	else
+	rj->newLen = newLen;
+	rj->dRatio = dRatio;
+	rj->relReSmp = state->relReSmp;
+	rj->newOrigPtr = (int8_t *)calloc(allocSize, 1);
+	if (!rj->newOrigPtr || !ft2_sample_job_copy_source(&rj->src, s))
 	{
-		const int8_t *src8 = s->dataPtr;
-		int8_t *dst8 = newData;
-		for (uint32_t i = 0; i < newLen; i++)
-		{
-			uint32_t srcIdx = (uint32_t)(posFrac64 >> 32);
-			if (srcIdx >= (uint32_t)s->length) srcIdx = s->length - 1;
-			dst8[i] = src8[srcIdx];
-			posFrac64 += delta64;
-		}
+		freeResampleJob(rj);
+		return;
 	}
+	rj->newData = rj->newOrigPtr + padding;
 
-	if (s->origDataPtr) free(s->origDataPtr);
-	s->origDataPtr = newOrigPtr;
-	s->dataPtr = newData;
-	s->relativeNote += state->relReSmp;
-	s->length = newLen;
-	s->loopStart = (int32_t)(s->loopStart * dRatio);
-	s->loopLength = (int32_t)(s->loopLength * dRatio);
-
-	ft2_sanitize_sample(s);
-	ft2_fix_sample(s);
-	inst->uiState.updateSampleEditor = true;
+	if (!ft2_sample_job_start(&FT2_UI(inst)->sampleJob, inst, "Resampling...", resampleJobRun, resampleJobDone, rj))
+		freeResampleJob(rj);
 }
 
 void ft2_resample_panel_show(ft2_instance_t *inst)
@@ -0,0 +1,205 @@
+/**
+ * @file ft2_plugin_resampler.c
+ * @brief Band-limited sample rate conversion for the resample panel.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ft2_plugin_resampler.h"
+#include "ft2_plugin_interpolation.h"
+#include "ft2_plugin_workers.h"
+#include "ft2_plugin_sample_job.h"
+#include "../ft2_instance.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MAX_TAPS 1024 /* Shrinking by more than 16x gets a shorter kernel */
+#define PHASE_SHIFT (32 - FT2_RESAMPLE_PHASES_BITS)
+#define PHASE_FRAC_MUL (1.0f / (float)(1u << PHASE_SHIFT))
+#define CHUNKS_PER_THREAD 2 /* Per batch: the pool lock is let go in between */
+
+bool ft2_resampler_init(ft2_resampler_t *rs, double ratio)
+{
+	memset(rs, 0, sizeof(ft2_resampler_t));
+	if (!(ratio > 0.0))
+		return false;
+
+	/* Kaiser's estimate of the transition width (as a fraction of Nyquist)
+	 * for this window and length, placed just below the lower Nyquist */
+	const double stopbandDb = (SINC_KAISER_BETA_HQ / 0.1102) + 8.7;
+	const double transition = (stopbandDb - 7.95) / (2.285 * (FT2_RESAMPLE_WIDTH - 1) * M_PI);
+	const double band = (ratio < 1.0) ? ratio : 1.0;
+	const double cutoff = band * (1.0 - (transition * 0.5));
+
+	int32_t numTaps = (int32_t)ceil(FT2_RESAMPLE_WIDTH / band);
+	numTaps = (numTaps + 1) & ~1;
+	if (numTaps > MAX_TAPS)
+		numTaps = MAX_TAPS;
+
+	float *kernel = (float *)malloc((size_t)(FT2_RESAMPLE_PHASES + 1) * numTaps * sizeof(float));
+	if (kernel == NULL)
+		return false;
+
+	ft2_make_sinc_kernel(kernel, numTaps, FT2_RESAMPLE_PHASES, SINC_KAISER_BETA_HQ, cutoff);
+
+	/* Unity gain at DC for every phase */
+	for (int32_t p = 0; p < FT2_RESAMPLE_PHASES; p++) {
+		float *row = &kernel[p * numTaps];
+		double sum = 0.0;
+		for (int32_t j = 0; j < numTaps; j++)
+			sum += row[j];
+		for (int32_t j = 0; j < numTaps; j++)
+			row[j] = (float)(row[j] / sum);
+	}
+
+	/* One row past the last phase is phase 0 a tap later, so every
+	 * position has a row on each side */
+	float *lastRow = &kernel[FT2_RESAMPLE_PHASES * numTaps];
+	lastRow[0] = 0.0f;
+	memcpy(&lastRow[1], kernel, (size_t)(numTaps - 1) * sizeof(float));
+
+	rs->kernel = kernel;
+	rs->numTaps = numTaps;
+	rs->delta = (uint64_t)round(4294967296.0 / ratio);
+	return true;
+}
+
+void ft2_resampler_free(ft2_resampler_t *rs)
+{
+	if (rs == NULL)
+		return;
+
+	free(rs->kernel);
+	rs->kernel = NULL;
+}
+
+/* Where the mixer would read source position k */
+static int64_t sourceIndex(const ft2_resample_source_t *src, int64_t k)
+{
+	if (k < 0)
+		return 0;
+	if (k < src->length)
+		return k;
+
+	const uint8_t loopType = src->flags & (FT2_LOOP_FWD | FT2_LOOP_BIDI);
+	const int64_t loopLength = src->loopLength;
+	if (loopType == 0 || loopLength < 1 || src->loopStart + loopLength != src->length)
+		return src->length - 1;
+
+	if (loopType == FT2_LOOP_FWD)
+		return src->loopStart + ((k - src->loopStart) % loopLength);
+
+	const int64_t pos = (k - src->loopStart) % (loopLength * 2);
+	return src->loopStart + ((pos < loopLength) ? pos : (loopLength * 2) - 1 - pos);
+}
+
+/* The taps are interpolated between the two rows around the position */
+static float dot8(const int8_t *x, const float *k0, const float *k1, float w, int32_t n)
+{
+	float acc = 0.0f;
+	for (int32_t j = 0; j < n; j++)
+		acc += (float)x[j] * (k0[j] + ((k1[j] - k0[j]) * w));
+	return acc;
+}
+
+static float dot16(const int16_t *x, const float *k0, const float *k1, float w, int32_t n)
+{
+	float acc = 0.0f;
+	for (int32_t j = 0; j < n; j++)
+		acc += (float)x[j] * (k0[j] + ((k1[j] - k0[j]) * w));
+	return acc;
+}
+
+static float dotFloat(const float *x, const float *k0, const float *k1, float w, int32_t n)
+{
+	float acc = 0.0f;
+	for (int32_t j = 0; j < n; j++)
+		acc += x[j] * (k0[j] + ((k1[j] - k0[j]) * w));
+	return acc;
+}
+
+static int32_t roundAndClamp(float f, int32_t lo, int32_t hi)
+{
+	if (f <= (float)lo) return lo;
+	if (f >= (float)hi) return hi;
+	return (int32_t)floorf(f + 0.5f);
+}
+
+void ft2_resampler_render(const ft2_resampler_t *rs, const ft2_resample_source_t *src, int8_t *dst,
+	int32_t first, int32_t count)
+{
+	const bool sample16Bit = (src->flags & FT2_SAMPLE_16BIT) != 0;
+	const int32_t numTaps = rs->numTaps;
+	const int32_t center = (numTaps / 2) - 1;
+	const int16_t *src16 = (const int16_t *)src->data;
+	float edgeTaps[MAX_TAPS];
+
+	for (int32_t i = first; i < first + count; i++) {
+		const uint64_t pos = (uint64_t)i * rs->delta;
+		const uint32_t frac = (uint32_t)pos;
+		const int64_t start = (int64_t)(pos >> 32) - center;
+
+		const float *k0 = &rs->kernel[(frac >> PHASE_SHIFT) * numTaps];
+		const float *k1 = k0 + numTaps;
+		const float w = (float)(frac & ((1u << PHASE_SHIFT) - 1)) * PHASE_FRAC_MUL;
+
+		float f;
+		if (start >= 0 && start + numTaps <= src->length) {
+			if (sample16Bit)
+				f = dot16(&src16[start], k0, k1, w, numTaps);
+			else
+				f = dot8(&src->data[start], k0, k1, w, numTaps);
+		} else {
+			for (int32_t j = 0; j < numTaps; j++) {
+				const int64_t k = sourceIndex(src, start + j);
+				edgeTaps[j] = sample16Bit ? (float)src16[k] : (float)src->data[k];
+			}
+			f = dotFloat(edgeTaps, k0, k1, w, numTaps);
+		}
+
+		if (sample16Bit)
+			((int16_t *)dst)[i] = (int16_t)roundAndClamp(f, -32768, 32767);
+		else
+			dst[i] = (int8_t)roundAndClamp(f, -128, 127);
+	}
+}
+
+typedef struct resampleBatch_t {
+	const ft2_resampler_t *rs;
+	const ft2_resample_source_t *src;
+	int8_t *dst;
+	int32_t dstLen, firstChunk;
+} resampleBatch_t;
+
+static void resampleWorker(void *userData, int32_t jobIndex)
+{
+	const resampleBatch_t *b = (const resampleBatch_t *)userData;
+	const int64_t first = (int64_t)(b->firstChunk + jobIndex) * FT2_RESAMPLE_CHUNK_LEN;
+	if (first >= b->dstLen)
+		return;
+
+	const int64_t count = (b->dstLen - first < FT2_RESAMPLE_CHUNK_LEN) ? b->dstLen - first : FT2_RESAMPLE_CHUNK_LEN;
+	ft2_resampler_render(b->rs, b->src, b->dst, (int32_t)first, (int32_t)count);
+}
+
+bool ft2_resampler_run(const ft2_resampler_t *rs, const ft2_resample_source_t *src, int8_t *dst,
+	int32_t dstLen, ft2_sample_job_t *job)
+{
+	const int32_t numChunks = (int32_t)(((int64_t)dstLen + FT2_RESAMPLE_CHUNK_LEN - 1) / FT2_RESAMPLE_CHUNK_LEN);
+	const int32_t chunksPerBatch = ft2_workers_get_concurrency() * CHUNKS_PER_THREAD;
+
+	resampleBatch_t batch = { rs, src, dst, dstLen, 0 };
+	for (int32_t c = 0; c < numChunks; c += chunksPerBatch) {
+		const int32_t n = (numChunks - c < chunksPerBatch) ? numChunks - c : chunksPerBatch;
+		batch.firstChunk = c;
+		ft2_workers_run(resampleWorker, &batch, n);
+
+		if (job != NULL && !ft2_sample_job_report(job, (uint64_t)(c + n), (uint64_t)numChunks))
+			return false;
+	}
+
+	return true;
+}
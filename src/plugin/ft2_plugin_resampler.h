@@ -0,0 +1,63 @@
+/**
+ * @file ft2_plugin_resampler.h
+ * @brief Band-limited sample rate conversion for the resample panel.
+ *
+ * A polyphase FIR made with the mixer's Kaiser-windowed sinc generator.
+ * It is FT2_RESAMPLE_WIDTH taps long at the lower of the two rates, so a
+ * sample that shrinks gets a kernel stretched over more source taps. The
+ * transition band ends at the lower Nyquist frequency: nothing above it
+ * aliases (shrinking) or images (stretching). Positions between two table
+ * rows interpolate the rows.
+ *
+ * Each output sample depends only on its index, so long samples are cut
+ * into chunks for the worker pool and the result does not depend on the
+ * number of threads.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ft2_sample_job_t;
+
+#define FT2_RESAMPLE_WIDTH       64
+#define FT2_RESAMPLE_PHASES_BITS 9
+#define FT2_RESAMPLE_PHASES      (1 << FT2_RESAMPLE_PHASES_BITS)
+#define FT2_RESAMPLE_CHUNK_LEN   65536 /* Output samples per worker job */
+
+typedef struct ft2_resampler_t {
+	float *kernel;   /* FT2_RESAMPLE_PHASES + 1 rows of numTaps */
+	int32_t numTaps;
+	uint64_t delta;  /* Source step per output sample, 32.32 fixed point */
+} ft2_resampler_t;
+
+/* What is read past the ends: the first sample before the start, and
+ * after the end the loop continues (if it ends there) or the last sample
+ * repeats, as the mixer sees a fixed sample */
+typedef struct ft2_resample_source_t {
+	const int8_t *data; /* Unfixed */
+	int32_t length, loopStart, loopLength;
+	uint8_t flags;
+} ft2_resample_source_t;
+
+/* ratio is the new length over the old one. Returns false if out of memory. */
+bool ft2_resampler_init(ft2_resampler_t *rs, double ratio);
+void ft2_resampler_free(ft2_resampler_t *rs);
+
+/* Output samples [first, first+count) of dst (same bit depth as src) */
+void ft2_resampler_render(const ft2_resampler_t *rs, const ft2_resample_source_t *src, int8_t *dst,
+	int32_t first, int32_t count);
+
+/* All dstLen samples on the worker pool. Reports progress to job if given;
+ * returns false if it was cancelled (dst is then incomplete). */
+bool ft2_resampler_run(const ft2_resampler_t *rs, const ft2_resample_source_t *src, int8_t *dst,
+	int32_t dstLen, struct ft2_sample_job_t *job);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file ft2_plugin_sample_decode.h
+ * @brief Batched sample decoding for module loaders.
+ *
+ * Loaders parse headers serially and queue one decode job per sample,
+ * pointing straight into the module buffer. Running the list allocates,
+ * decodes and fixes all samples in parallel on the shared worker pool,
+ * then interns them in the sample pool so identical data is shared.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../ft2_instance.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sample codecs */
+enum {
+	FT2_DECODE_RAW = 0,  /* Signed PCM, zero-filled if source is short (MOD) */
+	FT2_DECODE_XM_DELTA, /* XM delta PCM, stereo downmixed to mono */
+	FT2_DECODE_XM_ADPCM, /* ModPlug 4-bit ADPCM (16-byte LUT + nibbles) */
+	FT2_DECODE_S3M       /* Unsigned PCM, stereo downmixed to mono */
+};
+
+typedef struct ft2_decode_job_t {
+	ft2_sample_t *s;
+	const uint8_t *src;  /* Source data inside the module buffer (may be NULL) */
+	uint32_t srcBytes;   /* Bytes available at src */
+	uint8_t codec;
+	bool stereo;
+	bool failed;         /* Allocation failed (set by the job, read after the join) */
+	uint64_t poolHash;   /* Content hash of the decoded buffer (set by the job) */
+} ft2_decode_job_t;
+
+typedef struct ft2_decode_list_t {
+	ft2_decode_job_t *jobs;
+	int32_t numJobs, capacity;
+	uint64_t totalBytes;
+} ft2_decode_list_t;
+
+void ft2_decode_list_init(ft2_decode_list_t *list);
+void ft2_decode_list_free(ft2_decode_list_t *list);
+
+/* Queue a sample. s->length/flags must be final (stereo length not yet halved).
+ * The sample's data is allocated by the job; src must outlive the run. */
+bool ft2_decode_list_add(ft2_decode_list_t *list, ft2_sample_t *s, uint8_t codec,
+	const uint8_t *src, uint32_t srcBytes, bool stereo);
+
+/* Decode all queued samples (largest first), intern them in the sample
+ * pool and clear the list. Returns false if any sample allocation failed. */
+bool ft2_decode_list_run(ft2_decode_list_t *list);
+
+#ifdef __cplusplus
+}
+#endif
@@ -25,6 +25,7 @@
 #include "ft2_plugin_pattern_ed.h"
 #include "ft2_plugin_gui.h"
 #include "ft2_plugin_instr_ed.h"
+#include "ft2_plugin_sample_pool.h"
 #include "ft2_instance.h"
 
 static ft2_sample_t *getCurrentSampleWithInst(ft2_sample_editor_t *editor, ft2_instance_t *inst);
@@ -236,6 +237,8 @@ void ft2_sample_ed_init(ft2_sample_editor_t *editor, ft2_video_t *video)
 	editor->smpfx.smpCycles = 1;
 	editor->smpfx.lastWaveLength = 64;
 	editor->smpfx.lastAmp = 75;
+
+	ft2_undo_init(&editor->undo);
 }
 
 /*
@@ -1003,7 +1006,7 @@ static void setLeftLoopPinPos(ft2_sample_editor_t *editor, int32_t x, ft2_instan
 	if (newLoopStart >= loopEnd) newLoopStart = loopEnd - 1;
 	if (newLoopStart < 0) newLoopStart = 0;
 
-	ft2_stop_sample_voices(inst, s);
+	ft2_sample_edit_begin(inst, s);
 	s->loopStart = newLoopStart;
 	s->loopLength = loopEnd - newLoopStart;
 	if (s->loopLength < 0) s->loopLength = 0;
@@ -1019,7 +1022,7 @@ static void setRightLoopPinPos(ft2_sample_editor_t *editor, int32_t x, ft2_insta
 	if (loopEnd < s->loopStart) loopEnd = s->loopStart;
 	if (loopEnd > s->length) loopEnd = s->length;
 
-	ft2_stop_sample_voices(inst, s);
+	ft2_sample_edit_begin(inst, s);
 	s->loopLength = loopEnd - s->loopStart;
 	if (s->loopLength < 0) s->loopLength = 0;
 	inst->uiState.updateSampleEditor = true;
@@ -1045,7 +1048,8 @@ static void editSampleData(ft2_sample_editor_t *editor, int32_t mx, int32_t my,
 
 	if (!mouseButtonHeld)
 	{
-		ft2_unfix_sample(s);
+		ft2_sample_edit_in_place(inst, s);
+		if (!ft2_unfix_sample(s)) return;
 		inst->editor.editSampleFlag = true;
 
 		editor->lastDrawX = ft2_sample_scr2SmpPos(inst, mx);
@@ -1054,9 +1058,9 @@ static void editSampleData(ft2_sample_editor_t *editor, int32_t mx, int32_t my,
 		editor->lastMouseX = mx;
 		editor->lastMouseY = my;
 	}
-	else if (mx == editor->lastMouseX && my == editor->lastMouseY)
+	else if (!inst->editor.editSampleFlag || (mx == editor->lastMouseX && my == editor->lastMouseY))
 	{
-		return;
+		return; /* Nothing new, or the buffer couldn't be made writable on press */
 	}
 
 	if (mx != editor->lastMouseX)
@@ -1440,10 +1444,13 @@ static void pasteOverwrite(ft2_sample_editor_t *editor, ft2_sample_t *s, ft2_ins
 	smp_clipboard_t *clip = &editor->clipboard;
 	int32_t bytesPerSample = clip->is16Bit ? 2 : 1;
 	
-	/* Free old sample data */
+	fillSampleUndo(inst, false);
+
+	/* Free old sample data (voices play it until the handoff) */
+	ft2_sample_edit_begin(inst, s);
 	if (s->origDataPtr != NULL)
 	{
-		free(s->origDataPtr);
+		ft2_sample_pool_release(s->origDataPtr);
 		s->dataPtr = NULL;
 		s->origDataPtr = NULL;
 	}
@@ -1544,7 +1551,14 @@ void ft2_sample_ed_paste(ft2_instance_t *inst)
 	memset(newOrigPtr, 0, allocSize);
 	int8_t *newDataPtr = newOrigPtr + 128;
 	
-	ft2_unfix_sample(s);
+	/* Only the replaced range is kept for undo */
+	fillSampleUndoRange(inst, rx1, rx2, false);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s))
+	{
+		free(newOrigPtr);
+		return;
+	}
 	
 	/* Copy left part of original sample (before selection) */
 	if (rx1 > 0)
@@ -1562,7 +1576,7 @@ void ft2_sample_ed_paste(ft2_instance_t *inst)
 	}
 	
 	/* Free old sample data and assign new */
-	free(s->origDataPtr);
+	ft2_sample_pool_release(s->origDataPtr);
 	s->origDataPtr = newOrigPtr;
 	s->dataPtr = newDataPtr;
 	
@@ -1641,7 +1655,9 @@ void ft2_sample_ed_delete(ft2_instance_t *inst)
 	int32_t bytesPerSample = (s->flags & SAMPLE_16BIT) ? 2 : 1;
 	int32_t newLen = s->length - delLen;
 	
-	ft2_unfix_sample(s);
+	fillSampleUndoRange(inst, start, end, false);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 	
 	/* Move data after selection to fill the gap */
 	memmove(s->dataPtr + (start * bytesPerSample),
@@ -1691,6 +1707,9 @@ void ft2_sample_ed_reverse(ft2_instance_t *inst)
 	int32_t end = editor->hasRange ? editor->rangeEnd : s->length;
 	if (start > end) { int32_t tmp = start; start = end; end = tmp; }
 	
+	ft2_sample_edit_in_place(inst, s);
+	if (!ft2_unfix_sample(s)) return;
+
 	if (s->flags & SAMPLE_16BIT)
 	{
 		int16_t *ptr = (int16_t *)s->dataPtr;
@@ -1712,6 +1731,8 @@ void ft2_sample_ed_reverse(ft2_instance_t *inst)
 		}
 	}
 	
+	ft2_fix_sample(s);
+
 	if (inst != NULL)
 		inst->replayer.song.isModified = true;
 }
@@ -1729,6 +1750,9 @@ void ft2_sample_ed_normalize(ft2_instance_t *inst)
 
 	int32_t peak = 0;
 	
+	ft2_sample_edit_in_place(inst, s);
+	if (!ft2_unfix_sample(s)) return;
+
 	if (s->flags & SAMPLE_16BIT)
 	{
 		int16_t *ptr = (int16_t *)s->dataPtr;
@@ -1774,6 +1798,8 @@ void ft2_sample_ed_normalize(ft2_instance_t *inst)
 		}
 	}
 	
+	ft2_fix_sample(s);
+
 	if (inst != NULL)
 		inst->replayer.song.isModified = true;
 }
@@ -1789,6 +1815,9 @@ void ft2_sample_ed_fade_in(ft2_instance_t *inst)
 	int32_t len = end - start;
 	if (len <= 0) return;
 	
+	ft2_sample_edit_in_place(inst, s);
+	if (!ft2_unfix_sample(s)) return;
+
 	if (s->flags & SAMPLE_16BIT)
 	{
 		int16_t *ptr = (int16_t *)s->dataPtr;
@@ -1808,6 +1837,8 @@ void ft2_sample_ed_fade_in(ft2_instance_t *inst)
 		}
 	}
 	
+	ft2_fix_sample(s);
+
 	if (inst != NULL)
 		inst->replayer.song.isModified = true;
 }
@@ -1823,6 +1854,9 @@ void ft2_sample_ed_fade_out(ft2_instance_t *inst)
 	int32_t len = end - start;
 	if (len <= 0) return;
 	
+	ft2_sample_edit_in_place(inst, s);
+	if (!ft2_unfix_sample(s)) return;
+
 	if (s->flags & SAMPLE_16BIT)
 	{
 		int16_t *ptr = (int16_t *)s->dataPtr;
@@ -1842,6 +1876,8 @@ void ft2_sample_ed_fade_out(ft2_instance_t *inst)
 		}
 	}
 	
+	ft2_fix_sample(s);
+
 	if (inst != NULL)
 		inst->replayer.song.isModified = true;
 }
@@ -1923,7 +1959,8 @@ void ft2_sample_ed_crossfade_loop(ft2_instance_t *inst)
 		double dD2Mul = 1.0 / d2;
 		double dD3Mul = 1.0 / d3;
 
-		ft2_unfix_sample(s);
+		ft2_sample_edit_in_place(inst, s);
+		if (!ft2_unfix_sample(s)) return;
 
 		for (int32_t i = 0; i < length; i++)
 		{
@@ -2242,7 +2279,7 @@ bool allocateSmpData(ft2_instance_t *inst, int instrNum, int smpNum, int32_t len
 
 	if (s->origDataPtr)
 	{
-		free(s->origDataPtr);
+		ft2_sample_pool_release(s->origDataPtr);
 		s->origDataPtr = s->dataPtr = NULL;
 	}
 
@@ -2268,7 +2305,7 @@ void freeSmpData(ft2_instance_t *inst, int instrNum, int smpNum)
 	if (!instr) return;
 
 	ft2_sample_t *s = &instr->smp[smpNum];
-	if (s->origDataPtr) { free(s->origDataPtr); s->origDataPtr = NULL; }
+	if (s->origDataPtr) { ft2_sample_pool_release(s->origDataPtr); s->origDataPtr = NULL; }
 	s->dataPtr = NULL;
 	s->length = s->loopStart = s->loopLength = 0;
 	s->isFixed = false;
@@ -2285,14 +2322,15 @@ static void onClearSampleResult(ft2_instance_t *inst, ft2_dialog_result_t result
 
 	ft2_instr_t *instr = inst->replayer.instr[curInstr];
 
-	/* Stop voices playing this sample before clearing */
+	/* Voices playing this sample stop once the clear is published */
 	if (instr != NULL)
 	{
 		ft2_sample_t *s = &instr->smp[curSmp];
-		ft2_stop_sample_voices(inst, s);
+		ft2_sample_edit_begin(inst, s);
 	}
 
 	freeSmpData(inst, curInstr, curSmp);
+	forgetSampleUndo(inst, curInstr, curSmp);
 
 	if (instr != NULL)
 	{
@@ -2336,6 +2374,7 @@ static void onClearInstrResult(ft2_instance_t *inst, ft2_dialog_result_t result,
 	ft2_stop_all_voices(inst);
 
 	ft2_instance_free_instr(inst, curInstr);
+	forgetInstrUndo(inst, curInstr);
 	memset(inst->replayer.song.instrName[curInstr], 0, 23);
 
 	inst->editor.currVolEnvPoint = 0;
@@ -2376,7 +2415,7 @@ bool cloneSample(ft2_sample_t *src, ft2_sample_t *dst)
 {
 	if (!dst) return false;
 
-	if (dst->origDataPtr) { free(dst->origDataPtr); dst->origDataPtr = dst->dataPtr = NULL; }
+	if (dst->origDataPtr) { ft2_sample_pool_release(dst->origDataPtr); dst->origDataPtr = dst->dataPtr = NULL; }
 	if (!src) { memset(dst, 0, sizeof(ft2_sample_t)); return true; }
 
 	memcpy(dst, src, sizeof(ft2_sample_t));
@@ -2442,7 +2481,7 @@ void copyInstr(ft2_instance_t *inst)
 	ft2_instr_t *dstIns = inst->replayer.instr[curInstr];
 
 	for (int i = 0; i < 16; i++)
-		if (dstIns->smp[i].dataPtr) { free(dstIns->smp[i].dataPtr); dstIns->smp[i].dataPtr = NULL; }
+		freeSmpData(inst, curInstr, i);
 
 	if (!srcIns)
 	{
@@ -2513,8 +2552,8 @@ void sampleBackwards(ft2_instance_t *inst)
 	if (start > end) { int32_t tmp = start; start = end; end = tmp; }
 	if (start >= end) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	if (s->flags & SAMPLE_16BIT)
 	{
@@ -2552,8 +2591,8 @@ void sampleChangeSign(ft2_instance_t *inst)
 	ft2_sample_t *s = &instr->smp[inst->editor.curSmp];
 	if (!s->dataPtr || s->length == 0) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	if (s->flags & SAMPLE_16BIT)
 	{
@@ -2588,8 +2627,8 @@ void fixDC(ft2_instance_t *inst)
 	if (start > ed->rangeEnd && sampleDataMarked) { start = ed->rangeEnd; length = ed->rangeStart - ed->rangeEnd; }
 	if (length <= 0 || length > s->length) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	bool is16Bit = (s->flags & SAMPLE_16BIT) != 0;
 	int64_t sum = 0;
@@ -2654,8 +2693,8 @@ void sampleByteSwap(ft2_instance_t *inst)
 	ft2_sample_t *s = &instr->smp[inst->editor.curSmp];
 	if (!s->dataPtr || s->length == 0) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	int32_t len = (s->flags & SAMPLE_16BIT) ? s->length : (s->length >> 1);
 	int8_t *ptr = s->dataPtr;
@@ -2685,6 +2724,9 @@ static bool reallocateSmpData(ft2_sample_t *s, int32_t newLength, bool is16Bit)
 		return true;
 	}
 
+	/* Never realloc a buffer other instances are sharing */
+	if (!ft2_sample_pool_unshare(s)) return false;
+
 	int8_t *newPtr = (int8_t *)realloc(s->origDataPtr, allocSize);
 	if (!newPtr) return false;
 	s->origDataPtr = newPtr;
@@ -2730,10 +2772,10 @@ void sampCrop(ft2_instance_t *inst)
 	if (newLength <= 0)
 		return;
 
-	/* Stop voices playing this sample before modifying */
-	ft2_stop_sample_voices(inst, s);
+	/* Voices keep playing the old data until the change is published */
+	ft2_sample_edit_begin(inst, s);
 
-	ft2_unfix_sample(s);
+	if (!ft2_unfix_sample(s)) return;
 
 	/* Move the cropped portion to the beginning */
 	if (r1 > 0)
@@ -2804,8 +2846,8 @@ static void onMinimizeSampleResult(ft2_instance_t *inst, ft2_dialog_result_t res
 	if (!s || !s->dataPtr || s->length <= 0) return;
 	if (GET_LOOPTYPE(s->flags) == LOOP_OFF || s->loopStart + s->loopLength >= s->length) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 	s->length = s->loopStart + s->loopLength;
 	reallocateSmpData(s, s->length, (s->flags & SAMPLE_16BIT) != 0);
 	ft2_fix_sample(s);
@@ -2855,7 +2897,7 @@ void sampRepeatUp(ft2_instance_t *inst)
 
 	if (s->loopStart < s->length - s->loopLength)
 	{
-		ft2_stop_sample_voices(inst, s);
+		ft2_sample_edit_begin(inst, s);
 		s->loopStart++;
 		ft2_song_mark_modified(inst);
 	}
@@ -2871,7 +2913,7 @@ void sampRepeatDown(ft2_instance_t *inst)
 
 	if (s->loopStart > 0)
 	{
-		ft2_stop_sample_voices(inst, s);
+		ft2_sample_edit_begin(inst, s);
 		s->loopStart--;
 		ft2_song_mark_modified(inst);
 	}
@@ -2887,7 +2929,7 @@ void sampReplenUp(ft2_instance_t *inst)
 
 	if (s->loopStart + s->loopLength < s->length)
 	{
-		ft2_stop_sample_voices(inst, s);
+		ft2_sample_edit_begin(inst, s);
 		s->loopLength++;
 		ft2_song_mark_modified(inst);
 	}
@@ -2903,7 +2945,7 @@ void sampReplenDown(ft2_instance_t *inst)
 
 	if (s->loopLength > 0)
 	{
-		ft2_stop_sample_voices(inst, s);
+		ft2_sample_edit_begin(inst, s);
 		s->loopLength--;
 		ft2_song_mark_modified(inst);
 	}
@@ -2955,7 +2997,9 @@ void sampApplyVolume(ft2_instance_t *inst, double startVol, double endVol)
 	double dVolDelta = ((endVol - startVol) / 100.0) / len;
 	double dVol = startVol / 100.0;
 
-	ft2_unfix_sample(s);
+	fillSampleUndoRange(inst, x1, x2, true);
+	ft2_sample_edit_in_place(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	bool is16Bit = (s->flags & SAMPLE_16BIT) != 0;
 	if (is16Bit)
@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "ft2_plugin_smpfx.h"
+#include "ft2_plugin_sample_undo.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,15 +30,6 @@ typedef struct smp_clipboard_t {
 	ft2_sample_t sampleInfo;   /* Embedded sample metadata for whole-sample copies */
 } smp_clipboard_t;
 
-/* Sample undo buffer (per-instance, single-level) */
-typedef struct smp_undo_t {
-	bool filled, keepSampleMark;
-	uint8_t flags, undoInstr, undoSmp;
-	uint32_t length, loopStart, loopLength;
-	int8_t *smpData8;
-	int16_t *smpData16;
-} smp_undo_t;
-
 /* Display area constants (match original FT2) */
 #define SAMPLE_AREA_HEIGHT 154
 #define SAMPLE_AREA_WIDTH 632
@@ -86,8 +78,8 @@ typedef struct ft2_sample_editor_t
 	/* Clipboard (per-instance) */
 	smp_clipboard_t clipboard;
 	
-	/* Undo buffer (per-instance) */
-	smp_undo_t undo;
+	/* Undo history (per-instance) */
+	ft2_undo_journal_t undo;
 
 	/* Sample effects state (per-instance) */
 	smpfx_state_t smpfx;
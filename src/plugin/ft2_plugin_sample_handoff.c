@@ -0,0 +1,328 @@
+/**
+ * @file ft2_plugin_sample_handoff.c
+ * @brief Editing sample data while voices play it.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_plugin_sample_handoff.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_scopes.h"
+#include "ft2_plugin_ui.h"
+#include "../ft2_instance.h"
+
+/* The epoch and queue positions pair up across threads (a store on one
+ * side, then a load of the other's), so these need full ordering */
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define atomicLoad(p)     ((uint32_t)InterlockedOr((volatile LONG *)(p), 0))
+#define atomicStore(p, v) InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#define atomicInc(p)      InterlockedIncrement((volatile LONG *)(p))
+#define yieldThread()     Sleep(0)
+#else
+#include <sched.h>
+#define atomicLoad(p)     __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define atomicStore(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#define atomicInc(p)      __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define yieldThread()     sched_yield()
+#endif
+
+/* ------------------------------------------------------------------------- */
+/*                               UI thread                                   */
+/* ------------------------------------------------------------------------- */
+
+static bool findSampleSlot(ft2_instance_t *inst, const ft2_sample_t *s, int16_t *instrNum, int8_t *smpNum)
+{
+	for (int32_t i = 0; i <= FT2_MAX_INST + 4; i++) {
+		const ft2_instr_t *ins = inst->replayer.instr[i];
+		if (ins != NULL && s >= ins->smp && s < &ins->smp[FT2_MAX_SMP_PER_INST]) {
+			*instrNum = (int16_t)i;
+			*smpNum = (int8_t)(s - ins->smp);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ft2_sample_edit_begin(ft2_instance_t *inst, ft2_sample_t *s)
+{
+	if (inst == NULL || s == NULL || s->origDataPtr == NULL || s->dataPtr == NULL)
+		return;
+
+	/* The audio thread may have started a voice on this buffer at any
+	 * point, so it is retired whether or not anything plays it right now.
+	 * The extra reference makes the edit's unfix copy it, and keeps it
+	 * alive if the edit releases it. */
+	ft2_retired_sample_t *r = (ft2_retired_sample_t *)calloc(1, sizeof(ft2_retired_sample_t));
+	if (r == NULL || !findSampleSlot(inst, s, &r->instrNum, &r->smpNum) || !ft2_sample_pool_retain(s)) {
+		/* Out of memory (or not an instrument's sample): the old way */
+		free(r);
+		ft2_stop_sample_voices(inst, s);
+		return;
+	}
+
+	r->origDataPtr = s->origDataPtr;
+	r->rebase.oldData = s->dataPtr;
+
+	ft2_sample_handoff_t *h = &inst->handoff;
+	if (h->retiredTail != NULL)
+		h->retiredTail->next = r;
+	else
+		h->retired = r;
+	h->retiredTail = r;
+	h->numRetired++;
+}
+
+void ft2_sample_edit_in_place(ft2_instance_t *inst, ft2_sample_t *s)
+{
+	if (ft2_sample_pool_is_shared(s))
+		ft2_sample_edit_begin(inst, s);
+}
+
+/* Captures the sample as the edit left it */
+static void fillRebase(ft2_instance_t *inst, ft2_retired_sample_t *r)
+{
+	ft2_sample_rebase_t *rb = &r->rebase;
+	const ft2_instr_t *ins = inst->replayer.instr[r->instrNum];
+	const ft2_sample_t *s = (ins != NULL) ? &ins->smp[r->smpNum] : NULL;
+
+	if (s == NULL || s->dataPtr == NULL || s->length < 1) {
+		rb->data = NULL;
+		return;
+	}
+
+	rb->data = s->dataPtr;
+	rb->leftEdgeTaps8 = s->leftEdgeTapSamples8 + FT2_MAX_LEFT_TAPS;
+	rb->leftEdgeTaps16 = s->leftEdgeTapSamples16 + FT2_MAX_LEFT_TAPS;
+	rb->length = s->length;
+	rb->loopStart = s->loopStart;
+	rb->loopLength = s->loopLength;
+	rb->flags = s->flags;
+}
+
+void ft2_sample_handoff_capture(ft2_instance_t *inst)
+{
+	if (inst == NULL)
+		return;
+
+	for (ft2_retired_sample_t *r = inst->handoff.retired; r != NULL; r = r->next) {
+		if (!r->posted && !r->captured) {
+			fillRebase(inst, r);
+			r->captured = true;
+		}
+	}
+}
+
+static void reclaim(ft2_instance_t *inst, ft2_retired_sample_t *r)
+{
+	/* Scopes are emulated on this thread and may still show the old data */
+	if (inst->ui != NULL)
+		ft2_scopes_rebase_sample(&inst->ui->scopes, &r->rebase);
+
+	ft2_sample_pool_release(r->origDataPtr);
+	free(r);
+	inst->handoff.numReclaimed++;
+}
+
+void ft2_sample_handoff_sync(ft2_instance_t *inst)
+{
+	if (inst == NULL)
+		return;
+
+	ft2_sample_handoff_t *h = &inst->handoff;
+
+	/* Reclaim against the epoch seen last time: every scope sync entry
+	 * pushed by blocks that had ended by then has been drained since */
+	while (h->retired != NULL && h->retired->posted && (int32_t)(h->lastEpoch - h->retired->reclaimEpoch) >= 0) {
+		ft2_retired_sample_t *r = h->retired;
+		h->retired = r->next;
+		if (h->retired == NULL)
+			h->retiredTail = NULL;
+		reclaim(inst, r);
+	}
+
+	/* Publish in retire order, so chained edits of one sample are applied in sequence */
+	for (ft2_retired_sample_t *r = h->retired; r != NULL; r = r->next) {
+		if (r->posted)
+			continue;
+
+		const int32_t writePos = h->writePos;
+		const int32_t nextWritePos = (writePos + 1) % FT2_HANDOFF_QUEUE_LEN;
+		if (nextWritePos == (int32_t)atomicLoad(&h->readPos))
+			break; /* Full, the rest goes next frame */
+
+		if (!r->captured)
+			fillRebase(inst, r);
+		h->queue[writePos] = r->rebase;
+		atomicStore(&h->writePos, nextWritePos);
+
+		/* Between blocks (even) the next block picks it up before mixing, so
+		 * the buffer is free now; inside a block it is free once that ends */
+		r->reclaimEpoch = (atomicLoad(&h->epoch) + 1) & ~1u;
+		r->posted = true;
+	}
+
+	h->lastEpoch = atomicLoad(&h->epoch);
+}
+
+void ft2_pattern_swap_begin(ft2_instance_t *inst)
+{
+	ft2_sample_handoff_t *h = &inst->handoff;
+	if (h->swapDepth++ > 0)
+		return;
+
+	/* Blocks that start after this store see it and wait. One already
+	 * running (odd epoch) may not have, so wait for it to end. */
+	atomicStore(&h->patternSwap, 1);
+	const uint32_t epoch = atomicLoad(&h->epoch);
+	if (epoch & 1) {
+		while (atomicLoad(&h->epoch) == epoch)
+			yieldThread();
+	}
+}
+
+void ft2_pattern_swap_end(ft2_instance_t *inst)
+{
+	if (--inst->handoff.swapDepth > 0)
+		return;
+
+	atomicStore(&inst->handoff.patternSwap, 0);
+}
+
+/* Copies made while MIDI keeps recording are retried this often before
+ * the last one is made between blocks */
+#define SWAP_BUILD_TRIES 3
+
+bool ft2_pattern_swap_begin_built(ft2_instance_t *inst,
+	bool (*build)(ft2_instance_t *inst, void *userData),
+	void (*discard)(ft2_instance_t *inst, void *userData), void *userData)
+{
+	ft2_sample_handoff_t *h = &inst->handoff;
+	for (int32_t i = 0; i < SWAP_BUILD_TRIES - 1 && h->swapDepth == 0; i++) {
+		const uint32_t writes = atomicLoad(&h->patternWrites);
+		if (!build(inst, userData))
+			return false;
+
+		ft2_pattern_swap_begin(inst);
+		if (atomicLoad(&h->patternWrites) == writes)
+			return true;
+
+		ft2_pattern_swap_end(inst);
+		discard(inst, userData);
+	}
+
+	ft2_pattern_swap_begin(inst);
+	if (build(inst, userData))
+		return true;
+
+	ft2_pattern_swap_end(inst);
+	return false;
+}
+
+/* Repoints p if it points into from. Sets *hit if it did. */
+static const void *followSample(const void *p, const ft2_sample_t *from, const ft2_sample_t *to, bool *hit)
+{
+	const uint8_t *q = (const uint8_t *)p, *f = (const uint8_t *)from;
+	if (q < f || q >= f + sizeof(ft2_sample_t))
+		return p;
+
+	*hit = true;
+	return (to != NULL) ? (const uint8_t *)to + (q - f) : p;
+}
+
+static void followRebase(ft2_sample_rebase_t *rb, const ft2_sample_t *from, const ft2_sample_t *to)
+{
+	bool hit = false;
+	rb->leftEdgeTaps8 = (const int8_t *)followSample(rb->leftEdgeTaps8, from, to, &hit);
+	rb->leftEdgeTaps16 = (const int16_t *)followSample(rb->leftEdgeTaps16, from, to, &hit);
+	if (hit && to == NULL)
+		rb->data = NULL;
+}
+
+void ft2_sample_handoff_move(ft2_instance_t *inst, const ft2_sample_t *from, const ft2_sample_t *to)
+{
+	if (inst == NULL || from == NULL || from == to)
+		return;
+
+	for (int32_t i = 0; i < FT2_MAX_CHANNELS * 2; i++) {
+		ft2_voice_t *v = &inst->voice[i];
+		if (!v->active)
+			continue;
+
+		bool hit = false;
+		v->leftEdgeTaps8 = (const int8_t *)followSample(v->leftEdgeTaps8, from, to, &hit);
+		v->leftEdgeTaps16 = (const int16_t *)followSample(v->leftEdgeTaps16, from, to, &hit);
+		if (hit && to == NULL) {
+			memset(v, 0, sizeof(ft2_voice_t));
+			v->panning = 128;
+		}
+	}
+
+	/* The audio thread is outside a block, so the queue holds still too */
+	ft2_sample_handoff_t *h = &inst->handoff;
+	for (ft2_retired_sample_t *r = h->retired; r != NULL; r = r->next) {
+		if (r->captured && !r->posted)
+			followRebase(&r->rebase, from, to);
+	}
+	for (int32_t i = h->readPos; i != h->writePos; i = (i + 1) % FT2_HANDOFF_QUEUE_LEN)
+		followRebase(&h->queue[i], from, to);
+}
+
+void ft2_sample_handoff_free(ft2_instance_t *inst)
+{
+	if (inst == NULL)
+		return;
+
+	ft2_sample_handoff_t *h = &inst->handoff;
+	while (h->retired != NULL) {
+		ft2_retired_sample_t *r = h->retired;
+		h->retired = r->next;
+		ft2_sample_pool_release(r->origDataPtr);
+		free(r);
+	}
+	h->retiredTail = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Audio thread                                 */
+/* ------------------------------------------------------------------------- */
+
+void ft2_sample_handoff_block_begin(ft2_instance_t *inst)
+{
+	ft2_sample_handoff_t *h = &inst->handoff;
+	if (h->blockDepth++ > 0)
+		return;
+
+	atomicInc(&h->epoch);
+
+	/* The UI is swapping pattern buffers: step back out of the block
+	 * (even epoch) so it can finish, then come back in */
+	while (atomicLoad(&h->patternSwap) != 0) {
+		atomicInc(&h->epoch);
+		while (atomicLoad(&h->patternSwap) != 0)
+			yieldThread();
+		atomicInc(&h->epoch);
+	}
+
+	int32_t readPos = h->readPos;
+	while (readPos != (int32_t)atomicLoad(&h->writePos)) {
+		ft2_rebase_sample_voices(inst, &h->queue[readPos]);
+		readPos = (readPos + 1) % FT2_HANDOFF_QUEUE_LEN;
+		atomicStore(&h->readPos, readPos);
+	}
+}
+
+void ft2_pattern_mark_written(ft2_instance_t *inst)
+{
+	atomicInc(&inst->handoff.patternWrites);
+}
+
+void ft2_sample_handoff_block_end(ft2_instance_t *inst)
+{
+	if (--inst->handoff.blockDepth > 0)
+		return;
+
+	atomicInc(&inst->handoff.epoch);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file ft2_plugin_sample_handoff.h
+ * @brief Editing sample data while voices play it.
+ *
+ * Sample edits run on the UI thread while the audio thread may be mixing
+ * the very buffer being edited. Instead of stopping those voices, an edit
+ * first retires the sample's buffer: it takes a pool reference to it, so
+ * the edit's unfix works on a copy and a release doesn't free it, and
+ * whatever the mixer is reading stays intact. Once per UI frame
+ * the finished edits are published: the audio thread picks them up at the
+ * start of its next block and moves the affected voices over to the new
+ * data at the same position. A retired buffer is freed only after the
+ * audio thread has been seen outside a block since the publish (an epoch
+ * counter, odd while a block renders) and the scopes have drained every
+ * sync entry that could still point into it.
+ *
+ * Patterns are reallocated in place rather than handed over (a length or
+ * stride change moves every cell, and the pointers and stride must change
+ * together), so the same epoch also gates them: the UI waits until the
+ * audio thread is outside a block, and a block that starts meanwhile
+ * waits for the swap before reading any pattern. The new buffers are
+ * built before the swap, so it only exchanges pointers; MIDI recording
+ * writes cells from inside a block, so a write counter tells the UI when
+ * a copy it made meanwhile has gone stale.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ft2_instance_t;
+struct ft2_sample_t;
+
+#define FT2_HANDOFF_QUEUE_LEN 32
+
+/* What a voice playing oldData switches to */
+typedef struct ft2_sample_rebase_t {
+	const int8_t *oldData;
+	const int8_t *data; /* NULL if the sample is empty now */
+	const int8_t *leftEdgeTaps8;
+	const int16_t *leftEdgeTaps16;
+	int32_t length, loopStart, loopLength;
+	uint8_t flags;
+} ft2_sample_rebase_t;
+
+typedef struct ft2_retired_sample_t {
+	struct ft2_retired_sample_t *next;
+	int8_t *origDataPtr; /* Reference held until reclaimed */
+	ft2_sample_rebase_t rebase;
+	int16_t instrNum;
+	int8_t smpNum;
+	bool captured, posted;
+	uint32_t reclaimEpoch;
+} ft2_retired_sample_t;
+
+typedef struct ft2_sample_handoff_t {
+	/* Audio thread: epoch is bumped at block start and end, queue is
+	 * drained at block start (single producer/single consumer) */
+	volatile uint32_t epoch;
+	volatile uint32_t patternSwap; /* Set by the UI while it swaps pattern buffers */
+	volatile uint32_t patternWrites; /* Bumped after each pattern write in a block */
+	int32_t blockDepth; /* Nested block_begin calls (audio thread only) */
+	volatile int32_t readPos, writePos;
+	ft2_sample_rebase_t queue[FT2_HANDOFF_QUEUE_LEN];
+
+	/* UI thread only */
+	int32_t swapDepth; /* Nested ft2_pattern_swap_begin calls */
+	ft2_retired_sample_t *retired, *retiredTail;
+	uint32_t lastEpoch; /* Epoch seen by the previous sync */
+	uint32_t numRetired, numReclaimed;
+} ft2_sample_handoff_t;
+
+/* UI thread, before modifying a sample's data, length, loop or flags.
+ * Replaces ft2_stop_sample_voices() for edits: voices keep playing the
+ * old data until the edit is published. */
+void ft2_sample_edit_begin(struct ft2_instance_t *inst, struct ft2_sample_t *s);
+
+/* UI thread, before an in-place edit that keeps the length, loop and
+ * flags (drawing, fades, reverse...). Voices read a private buffer as it
+ * changes, as they always have, so nothing is retired. A buffer shared
+ * with another instance is copied by the unfix, though, and then goes
+ * through ft2_sample_edit_begin() so the voices move to the copy before
+ * this instance's reference to the shared one is dropped. */
+void ft2_sample_edit_in_place(struct ft2_instance_t *inst, struct ft2_sample_t *s);
+
+/* UI thread: takes every edit begun so far as it stands now, instead of
+ * at the next sync. For edits that then move samples or instruments to
+ * other slots (trim), where the slot would no longer hold the sample. */
+void ft2_sample_handoff_capture(struct ft2_instance_t *inst);
+
+/* UI thread, once per frame (after ft2_scopes_update()): publishes
+ * finished edits and frees buffers that nothing can read any more */
+void ft2_sample_handoff_sync(struct ft2_instance_t *inst);
+
+/* Audio thread, around each rendered block and anything else that reads
+ * patterns (MIDI recording, the timemap). Calls may nest. */
+void ft2_sample_handoff_block_begin(struct ft2_instance_t *inst);
+void ft2_sample_handoff_block_end(struct ft2_instance_t *inst);
+
+/* UI thread, around replacing pattern buffers or the pattern stride. On
+ * return from begin the audio thread isn't reading any pattern, and won't
+ * until end. Keep it short: a block that starts in between waits, so
+ * allocate and copy before begin (ft2_pattern_swap_begin_built()) and
+ * free the old buffers after end. Calls may nest; never call from inside
+ * a block. */
+void ft2_pattern_swap_begin(struct ft2_instance_t *inst);
+void ft2_pattern_swap_end(struct ft2_instance_t *inst);
+
+/* UI thread: ft2_pattern_swap_begin() for a swap whose new buffers are
+ * copied from the current patterns. build() runs first, while blocks
+ * keep rendering; if one of them recorded into a pattern meanwhile, the
+ * copy may have missed it, so discard() drops it and it is built again
+ * (the last try, or any try inside another swap, between blocks). On
+ * true the swap is held; false means build() failed and it is not. */
+bool ft2_pattern_swap_begin_built(struct ft2_instance_t *inst,
+	bool (*build)(struct ft2_instance_t *inst, void *userData),
+	void (*discard)(struct ft2_instance_t *inst, void *userData), void *userData);
+
+/* Audio thread, inside a block, after writing pattern cells or allocating
+ * a pattern (MIDI recording) */
+void ft2_pattern_mark_written(struct ft2_instance_t *inst);
+
+/* UI thread, between ft2_pattern_swap_begin() and _end(), after a sample
+ * was moved to another slot (to), or dropped (to == NULL). Voices read
+ * the edge taps from the sample itself, so they follow it, and so do
+ * captured edits the audio thread hasn't picked up yet. Voices on a
+ * dropped sample stop. */
+void ft2_sample_handoff_move(struct ft2_instance_t *inst, const struct ft2_sample_t *from, const struct ft2_sample_t *to);
+
+/* Instance destroy: frees every retired buffer (audio must be stopped) */
+void ft2_sample_handoff_free(struct ft2_instance_t *inst);
+
+#ifdef __cplusplus
+}
+#endif
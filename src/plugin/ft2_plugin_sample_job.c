@@ -0,0 +1,252 @@
+/**
+ * @file ft2_plugin_sample_job.c
+ * @brief Long sample operations off the UI thread.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_plugin_sample_job.h"
+#include "ft2_plugin_video.h"
+#include "ft2_plugin_bmp.h"
+#include "../ft2_instance.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define atomicLoad(p)     ((int32_t)InterlockedOr((volatile LONG *)(p), 0))
+#define atomicStore(p, v) InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+typedef struct ft2_job_thread_t { HANDLE handle; } ft2_job_thread_t;
+#else
+#include <pthread.h>
+#define atomicLoad(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define atomicStore(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+typedef struct ft2_job_thread_t { pthread_t handle; } ft2_job_thread_t;
+#endif
+
+enum {
+	JOB_IDLE = 0,
+	JOB_RUNNING,
+	JOB_RETURNED
+};
+
+#define BOX_W 300
+#define BOX_H 58
+#define BOX_X ((SCREEN_W - BOX_W) / 2)
+#define BOX_Y 200
+
+static void runJob(ft2_sample_job_t *job)
+{
+	job->completed = job->func(job, job->userData);
+	atomicStore(&job->state, JOB_RETURNED); /* Publishes completed and the job's results */
+}
+
+#ifdef _WIN32
+static DWORD WINAPI jobMain(LPVOID arg)
+#else
+static void *jobMain(void *arg)
+#endif
+{
+	runJob((ft2_sample_job_t *)arg);
+	return 0;
+}
+
+static bool startThread(ft2_sample_job_t *job)
+{
+	ft2_job_thread_t *t = (ft2_job_thread_t *)malloc(sizeof(ft2_job_thread_t));
+	if (t == NULL)
+		return false;
+
+#ifdef _WIN32
+	t->handle = CreateThread(NULL, 0, jobMain, job, 0, NULL);
+	if (t->handle == NULL) {
+		free(t);
+		return false;
+	}
+#else
+	if (pthread_create(&t->handle, NULL, jobMain, job) != 0) {
+		free(t);
+		return false;
+	}
+#endif
+
+	job->thread = t;
+	return true;
+}
+
+static void joinThread(ft2_sample_job_t *job)
+{
+	ft2_job_thread_t *t = job->thread;
+	if (t == NULL)
+		return;
+
+#ifdef _WIN32
+	WaitForSingleObject(t->handle, INFINITE);
+	CloseHandle(t->handle);
+#else
+	pthread_join(t->handle, NULL);
+#endif
+
+	free(t);
+	job->thread = NULL;
+}
+
+/* Joins a returned job and hands its data to the done function */
+static void finishJob(ft2_sample_job_t *job, bool completed)
+{
+	joinThread(job);
+
+	ft2_sample_job_done_t done = job->done;
+	ft2_instance_t *inst = job->inst;
+	void *userData = job->userData;
+
+	job->func = NULL;
+	job->done = NULL;
+	job->userData = NULL;
+	job->inst = NULL;
+	atomicStore(&job->state, JOB_IDLE);
+
+	done(inst, userData, completed);
+}
+
+bool ft2_sample_job_start(ft2_sample_job_t *job, ft2_instance_t *inst, const char *title,
+	ft2_sample_job_func_t func, ft2_sample_job_done_t done, void *userData)
+{
+	if (job == NULL || func == NULL || done == NULL || ft2_sample_job_is_busy(job))
+		return false;
+
+	job->title = title;
+	job->func = func;
+	job->done = done;
+	job->userData = userData;
+	job->inst = inst;
+	job->completed = false;
+	job->cancel = 0;
+	job->progress = 0;
+	atomicStore(&job->state, JOB_RUNNING);
+
+	if (!startThread(job)) {
+		/* Blocks the editor like it used to, but still gets done */
+		runJob(job);
+		ft2_sample_job_poll(job);
+	}
+
+	return true;
+}
+
+bool ft2_sample_job_report(ft2_sample_job_t *job, uint64_t done, uint64_t total)
+{
+	int32_t progress = FT2_SAMPLE_JOB_PROGRESS_MAX;
+	if (total > 0 && done < total)
+		progress = (int32_t)((done * FT2_SAMPLE_JOB_PROGRESS_MAX) / total);
+
+	atomicStore(&job->progress, progress);
+	return atomicLoad(&job->cancel) == 0;
+}
+
+bool ft2_sample_job_is_busy(const ft2_sample_job_t *job)
+{
+	return job != NULL && atomicLoad(&job->state) != JOB_IDLE;
+}
+
+void ft2_sample_job_cancel(ft2_sample_job_t *job)
+{
+	if (job != NULL)
+		atomicStore(&job->cancel, 1);
+}
+
+void ft2_sample_job_poll(ft2_sample_job_t *job)
+{
+	if (job == NULL || atomicLoad(&job->state) != JOB_RETURNED)
+		return;
+
+	ft2_instance_t *inst = job->inst;
+	finishJob(job, job->completed && atomicLoad(&job->cancel) == 0);
+
+	/* The progress box covered part of the screen */
+	if (inst != NULL)
+		inst->uiState.needsFullRedraw = true;
+}
+
+void ft2_sample_job_abort(ft2_sample_job_t *job)
+{
+	if (job == NULL || atomicLoad(&job->state) == JOB_IDLE)
+		return;
+
+	ft2_sample_job_cancel(job);
+	joinThread(job);
+	finishJob(job, false);
+}
+
+bool ft2_sample_job_copy_source(ft2_sample_job_source_t *src, const ft2_sample_t *s)
+{
+	memset(src, 0, sizeof(ft2_sample_job_source_t));
+	if (s == NULL || s->dataPtr == NULL || s->length < 1)
+		return false;
+
+	const bool sample16Bit = (s->flags & FT2_SAMPLE_16BIT) != 0;
+	const size_t bytes = (size_t)s->length * (sample16Bit ? 2 : 1);
+	src->data = (int8_t *)malloc(bytes);
+	if (src->data == NULL)
+		return false;
+
+	memcpy(src->data, s->dataPtr, bytes);
+	if (s->isFixed) {
+		for (int32_t i = 0; i < FT2_MAX_RIGHT_TAPS && s->fixedPos + i < s->length; i++) {
+			if (sample16Bit)
+				((int16_t *)src->data)[s->fixedPos + i] = s->fixedSmp[i];
+			else
+				src->data[s->fixedPos + i] = (int8_t)s->fixedSmp[i];
+		}
+	}
+
+	src->smp = s;
+	src->smpData = s->dataPtr;
+	src->length = s->length;
+	src->loopStart = s->loopStart;
+	src->loopLength = s->loopLength;
+	src->flags = s->flags;
+	return true;
+}
+
+void ft2_sample_job_free_source(ft2_sample_job_source_t *src)
+{
+	if (src == NULL)
+		return;
+
+	free(src->data);
+	src->data = NULL;
+}
+
+bool ft2_sample_job_source_is_current(const ft2_sample_job_source_t *src, const ft2_sample_t *s)
+{
+	/* Any edit goes through a new buffer (copy-on-write), so the data
+	 * pointer tells whether the sample has been touched since */
+	return s != NULL && s == src->smp && s->dataPtr == src->smpData && s->length == src->length &&
+		((s->flags ^ src->flags) & FT2_SAMPLE_16BIT) == 0;
+}
+
+void ft2_sample_job_draw(const ft2_sample_job_t *job, ft2_video_t *video, const ft2_bmp_t *bmp)
+{
+	if (job == NULL || video == NULL || atomicLoad(&job->state) == JOB_IDLE)
+		return;
+
+	drawFramework(video, BOX_X, BOX_Y, BOX_W, BOX_H, FRAMEWORK_TYPE1);
+
+	const char *title = (job->title != NULL) ? job->title : "Working...";
+	textOutShadow(video, bmp, BOX_X + ((BOX_W - textWidth(title)) / 2), BOX_Y + 6, PAL_FORGRND, PAL_BUTTON2, title);
+
+	/* Bar */
+	const uint16_t barX = BOX_X + 10, barY = BOX_Y + 20, barW = BOX_W - 20, barH = 12;
+	drawFramework(video, barX, barY, barW, barH, FRAMEWORK_TYPE2);
+
+	int32_t progress = atomicLoad(&job->progress);
+	if (progress > FT2_SAMPLE_JOB_PROGRESS_MAX)
+		progress = FT2_SAMPLE_JOB_PROGRESS_MAX;
+
+	const uint16_t fillW = (uint16_t)(((barW - 4) * progress) / FT2_SAMPLE_JOB_PROGRESS_MAX);
+	if (fillW > 0)
+		fillRect(video, barX + 2, barY + 2, fillW, barH - 4, PAL_FORGRND);
+
+	const char *hint = atomicLoad(&job->cancel) ? "Stopping..." : "Click or press ESC to stop";
+	textOutShadow(video, bmp, BOX_X + ((BOX_W - textWidth(hint)) / 2), BOX_Y + 39, PAL_FORGRND, PAL_BUTTON2, hint);
+}
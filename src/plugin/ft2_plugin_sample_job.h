@@ -0,0 +1,99 @@
+/**
+ * @file ft2_plugin_sample_job.h
+ * @brief Long sample operations off the UI thread.
+ *
+ * One job at a time per editor. The job function runs on its own thread
+ * and must not touch the instance: it works on private copies and reports
+ * progress, which also tells it whether it has been cancelled. Once it has
+ * returned, the UI thread calls the done function from
+ * ft2_sample_job_poll(), which commits the result (after checking the
+ * sample is still the one the job started from) and frees the job data.
+ *
+ * While a job runs the editor shows a progress box and takes no input;
+ * a mouse click or ESC cancels it.
+ *
+ * ft2_sample_job_source_t is the usual input: the sample's data copied
+ * (with the loop-end taps put back) before the job starts, and enough of
+ * the sample to tell later whether it is still the same one.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ft2_instance_t;
+struct ft2_sample_t;
+struct ft2_video_t;
+struct ft2_bmp_t;
+struct ft2_job_thread_t;
+struct ft2_sample_job_t;
+
+#define FT2_SAMPLE_JOB_PROGRESS_MAX 1024
+
+/* Job thread: returns true if it ran to completion */
+typedef bool (*ft2_sample_job_func_t)(struct ft2_sample_job_t *job, void *userData);
+
+/* UI thread: commits the result if completed, and frees userData either
+ * way. On editor close it is called with completed = false while the
+ * instance may already be detached from the UI, so then it only frees. */
+typedef void (*ft2_sample_job_done_t)(struct ft2_instance_t *inst, void *userData, bool completed);
+
+/* A sample as it was when a job started */
+typedef struct ft2_sample_job_source_t {
+	const struct ft2_sample_t *smp; /* Compared, never read by the job */
+	const int8_t *smpData;
+	int8_t *data; /* Private copy, unfixed */
+	int32_t length, loopStart, loopLength;
+	uint8_t flags;
+} ft2_sample_job_source_t;
+
+typedef struct ft2_sample_job_t {
+	volatile int32_t state;    /* Idle, running, or returned and waiting for poll */
+	volatile int32_t cancel;
+	volatile int32_t progress; /* 0..FT2_SAMPLE_JOB_PROGRESS_MAX */
+	bool completed;
+
+	const char *title;
+	ft2_sample_job_func_t func;
+	ft2_sample_job_done_t done;
+	void *userData;
+	struct ft2_instance_t *inst;
+	struct ft2_job_thread_t *thread;
+} ft2_sample_job_t;
+
+/* Starts func on a job thread. If no thread can be started the job runs
+ * to completion right here. Returns false (leaving userData to the
+ * caller) only if another job is still running. */
+bool ft2_sample_job_start(ft2_sample_job_t *job, struct ft2_instance_t *inst, const char *title,
+	ft2_sample_job_func_t func, ft2_sample_job_done_t done, void *userData);
+
+/* Job thread: sets the progress to done/total. Returns false once the job
+ * is cancelled, and the function should then return false soon. */
+bool ft2_sample_job_report(ft2_sample_job_t *job, uint64_t done, uint64_t total);
+
+bool ft2_sample_job_is_busy(const ft2_sample_job_t *job);
+void ft2_sample_job_cancel(ft2_sample_job_t *job);
+
+/* UI thread, once per frame: finishes a job whose function has returned */
+void ft2_sample_job_poll(ft2_sample_job_t *job);
+
+/* Editor close: cancels a running job and waits for it */
+void ft2_sample_job_abort(ft2_sample_job_t *job);
+
+/* UI thread: copies a sample for a job. Returns false if out of memory. */
+bool ft2_sample_job_copy_source(ft2_sample_job_source_t *src, const struct ft2_sample_t *s);
+void ft2_sample_job_free_source(ft2_sample_job_source_t *src);
+
+/* UI thread, when committing: is s still the sample the copy was taken from? */
+bool ft2_sample_job_source_is_current(const ft2_sample_job_source_t *src, const struct ft2_sample_t *s);
+
+void ft2_sample_job_draw(const ft2_sample_job_t *job, struct ft2_video_t *video, const struct ft2_bmp_t *bmp);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,321 @@
+/**
+ * @file ft2_plugin_sample_pool.c
+ * @brief Process-wide content-addressed store for loaded sample data.
+ *
+ * Entries are kept in two chained hash tables: by content hash (to find
+ * duplicates when interning) and by buffer address (to recognize pooled
+ * buffers on release/unshare). A hash match is always confirmed with a
+ * full compare, so collisions can't merge different samples. Buffers that
+ * only gained a second reference through ft2_sample_pool_retain() are in
+ * the address table alone.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_plugin_sample_pool.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+typedef CRITICAL_SECTION poolMutex_t;
+#define mutexInit(m)    InitializeCriticalSection(m)
+#define mutexDestroy(m) DeleteCriticalSection(m)
+#define mutexLock(m)    EnterCriticalSection(m)
+#define mutexUnlock(m)  LeaveCriticalSection(m)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t poolMutex_t;
+#define mutexInit(m)    pthread_mutex_init(m, NULL)
+#define mutexDestroy(m) pthread_mutex_destroy(m)
+#define mutexLock(m)    pthread_mutex_lock(m)
+#define mutexUnlock(m)  pthread_mutex_unlock(m)
+#endif
+
+#define POOL_BUCKETS 1024 /* Power of two */
+
+typedef struct poolEntry_t {
+	int8_t *data;
+	size_t size;
+	uint64_t hash;
+	int32_t refCount;
+	bool hashed; /* Interned (also in byHash) */
+	struct poolEntry_t *nextByHash, *nextByAddr;
+} poolEntry_t;
+
+typedef struct samplePool_t {
+	bool initialized;
+	int32_t refCount;
+	poolMutex_t lock;
+	poolEntry_t *byHash[POOL_BUCKETS];
+	poolEntry_t *byAddr[POOL_BUCKETS];
+} samplePool_t;
+
+static samplePool_t g_samplePool;
+
+static inline uint64_t rotl64(uint64_t x, int32_t r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint32_t addrBucket(const void *p)
+{
+	uint64_t x = (uint64_t)(uintptr_t)p;
+	x ^= x >> 33;
+	x *= 0xFF51AFD7ED558CCDULL;
+	x ^= x >> 33;
+	return (uint32_t)x & (POOL_BUCKETS - 1);
+}
+
+static inline uint32_t hashBucket(uint64_t hash)
+{
+	return (uint32_t)hash & (POOL_BUCKETS - 1);
+}
+
+static poolEntry_t *findByAddr(const int8_t *data)
+{
+	for (poolEntry_t *e = g_samplePool.byAddr[addrBucket(data)]; e != NULL; e = e->nextByAddr) {
+		if (e->data == data)
+			return e;
+	}
+	return NULL;
+}
+
+static void unlinkEntry(poolEntry_t *entry)
+{
+	poolEntry_t **pp;
+	if (entry->hashed) {
+		pp = &g_samplePool.byHash[hashBucket(entry->hash)];
+		while (*pp != entry) pp = &(*pp)->nextByHash;
+		*pp = entry->nextByHash;
+	}
+
+	pp = &g_samplePool.byAddr[addrBucket(entry->data)];
+	while (*pp != entry) pp = &(*pp)->nextByAddr;
+	*pp = entry->nextByAddr;
+}
+
+bool ft2_sample_pool_init(void)
+{
+	if (g_samplePool.initialized) {
+		g_samplePool.refCount++;
+		return true;
+	}
+
+	memset(&g_samplePool, 0, sizeof(g_samplePool));
+	mutexInit(&g_samplePool.lock);
+	g_samplePool.initialized = true;
+	g_samplePool.refCount = 1;
+	return true;
+}
+
+void ft2_sample_pool_free(void)
+{
+	if (!g_samplePool.initialized) return;
+	g_samplePool.refCount--;
+	if (g_samplePool.refCount > 0) return;
+
+	/* Every instance has released its samples by now; drop anything left */
+	for (int32_t i = 0; i < POOL_BUCKETS; i++) {
+		poolEntry_t *e = g_samplePool.byAddr[i];
+		while (e != NULL) {
+			poolEntry_t *next = e->nextByAddr;
+			free(e->data);
+			free(e);
+			e = next;
+		}
+	}
+
+	mutexDestroy(&g_samplePool.lock);
+	memset(&g_samplePool, 0, sizeof(g_samplePool));
+}
+
+uint64_t ft2_sample_pool_hash(const void *data, size_t size)
+{
+	const uint64_t k1 = 0x87C37B91114253D5ULL, k2 = 0x4CF5AD432745937FULL;
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)size;
+
+	for (; size >= 8; size -= 8, p += 8) {
+		uint64_t w;
+		memcpy(&w, p, 8);
+		h ^= rotl64(w * k1, 31) * k2;
+		h = rotl64(h, 27) * 5 + 0x52DCE729;
+	}
+
+	uint64_t tail = 0;
+	for (size_t i = 0; i < size; i++)
+		tail |= (uint64_t)p[i] << (i * 8);
+	h ^= rotl64(tail * k1, 31) * k2;
+
+	/* Final avalanche so the low bits pick good buckets */
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+size_t ft2_sample_pool_data_size(const ft2_sample_t *s)
+{
+	if (s == NULL || s->origDataPtr == NULL || s->dataPtr == NULL || s->length <= 0)
+		return 0;
+
+	const size_t padding = (size_t)(s->dataPtr - s->origDataPtr);
+	const size_t dataBytes = (size_t)s->length * ((s->flags & FT2_SAMPLE_16BIT) ? 2 : 1);
+	return padding + dataBytes + padding;
+}
+
+void ft2_sample_pool_intern(ft2_sample_t *s, uint64_t hash)
+{
+	if (!g_samplePool.initialized || s == NULL)
+		return;
+
+	const size_t size = ft2_sample_pool_data_size(s);
+	if (size == 0)
+		return;
+
+	mutexLock(&g_samplePool.lock);
+
+	if (findByAddr(s->origDataPtr) != NULL) { /* Already pooled */
+		mutexUnlock(&g_samplePool.lock);
+		return;
+	}
+
+	for (poolEntry_t *e = g_samplePool.byHash[hashBucket(hash)]; e != NULL; e = e->nextByHash) {
+		if (e->hash == hash && e->size == size && memcmp(e->data, s->origDataPtr, size) == 0) {
+			e->refCount++;
+			mutexUnlock(&g_samplePool.lock);
+
+			const ptrdiff_t padding = s->dataPtr - s->origDataPtr;
+			free(s->origDataPtr);
+			s->origDataPtr = e->data;
+			s->dataPtr = e->data + padding;
+			return;
+		}
+	}
+
+	poolEntry_t *entry = (poolEntry_t *)malloc(sizeof(poolEntry_t));
+	if (entry != NULL) { /* On failure the sample just stays private */
+		entry->data = s->origDataPtr;
+		entry->size = size;
+		entry->hash = hash;
+		entry->refCount = 1;
+		entry->hashed = true;
+
+		const uint32_t hb = hashBucket(hash), ab = addrBucket(entry->data);
+		entry->nextByHash = g_samplePool.byHash[hb];
+		entry->nextByAddr = g_samplePool.byAddr[ab];
+		g_samplePool.byHash[hb] = entry;
+		g_samplePool.byAddr[ab] = entry;
+	}
+
+	mutexUnlock(&g_samplePool.lock);
+}
+
+bool ft2_sample_pool_retain(const ft2_sample_t *s)
+{
+	if (!g_samplePool.initialized || s == NULL || s->origDataPtr == NULL)
+		return false;
+
+	mutexLock(&g_samplePool.lock);
+
+	poolEntry_t *entry = findByAddr(s->origDataPtr);
+	if (entry == NULL) {
+		const size_t size = ft2_sample_pool_data_size(s);
+		entry = (size > 0) ? (poolEntry_t *)malloc(sizeof(poolEntry_t)) : NULL;
+		if (entry == NULL) {
+			mutexUnlock(&g_samplePool.lock);
+			return false;
+		}
+
+		entry->data = s->origDataPtr;
+		entry->size = size;
+		entry->hash = 0;
+		entry->refCount = 1;
+		entry->hashed = false;
+		entry->nextByHash = NULL;
+
+		const uint32_t ab = addrBucket(entry->data);
+		entry->nextByAddr = g_samplePool.byAddr[ab];
+		g_samplePool.byAddr[ab] = entry;
+	}
+
+	entry->refCount++;
+	mutexUnlock(&g_samplePool.lock);
+	return true;
+}
+
+bool ft2_sample_pool_is_shared(const ft2_sample_t *s)
+{
+	if (!g_samplePool.initialized || s == NULL || s->origDataPtr == NULL)
+		return false;
+
+	mutexLock(&g_samplePool.lock);
+	const poolEntry_t *entry = findByAddr(s->origDataPtr);
+	const bool shared = (entry != NULL && entry->refCount > 1);
+	mutexUnlock(&g_samplePool.lock);
+
+	return shared;
+}
+
+bool ft2_sample_pool_unshare(ft2_sample_t *s)
+{
+	if (!g_samplePool.initialized || s == NULL || s->origDataPtr == NULL)
+		return true;
+
+	mutexLock(&g_samplePool.lock);
+
+	poolEntry_t *entry = findByAddr(s->origDataPtr);
+	if (entry == NULL) {
+		mutexUnlock(&g_samplePool.lock);
+		return true;
+	}
+
+	if (entry->refCount == 1) {
+		/* Sole owner: take the buffer out of the pool, no copy needed */
+		unlinkEntry(entry);
+		mutexUnlock(&g_samplePool.lock);
+		free(entry);
+		return true;
+	}
+
+	int8_t *copy = (int8_t *)malloc(entry->size);
+	if (copy == NULL) {
+		mutexUnlock(&g_samplePool.lock);
+		return false;
+	}
+
+	memcpy(copy, entry->data, entry->size);
+	entry->refCount--;
+	mutexUnlock(&g_samplePool.lock);
+
+	const ptrdiff_t padding = s->dataPtr - s->origDataPtr;
+	s->origDataPtr = copy;
+	s->dataPtr = copy + padding;
+	return true;
+}
+
+void ft2_sample_pool_release(int8_t *origDataPtr)
+{
+	if (origDataPtr == NULL)
+		return;
+
+	if (g_samplePool.initialized) {
+		mutexLock(&g_samplePool.lock);
+
+		poolEntry_t *entry = findByAddr(origDataPtr);
+		if (entry != NULL) {
+			if (--entry->refCount > 0) {
+				mutexUnlock(&g_samplePool.lock);
+				return;
+			}
+			unlinkEntry(entry);
+			free(entry);
+		}
+
+		mutexUnlock(&g_samplePool.lock);
+	}
+
+	free(origDataPtr);
+}
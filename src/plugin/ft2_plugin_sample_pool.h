@@ -0,0 +1,63 @@
+/**
+ * @file ft2_plugin_sample_pool.h
+ * @brief Process-wide content-addressed store for loaded sample data.
+ *
+ * Module loaders intern each decoded sample buffer by content hash, so
+ * instances that load the same module (or the same drum kit) share one
+ * buffer. Pooled buffers are immutable: ft2_unfix_sample()/ft2_fix_sample()
+ * detach a shared buffer (copy-on-write) before it is modified, and every
+ * buffer must be freed with ft2_sample_pool_release() instead of free().
+ *
+ * One pool is shared by all plugin instances (reference counted, like the
+ * worker pool). Buffers that were never interned are ordinary malloc blocks.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../ft2_instance.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Init/free (reference counted, call from instance create/destroy) */
+bool ft2_sample_pool_init(void);
+void ft2_sample_pool_free(void);
+
+/* Hashes a sample buffer (thread-safe, used by the parallel decode jobs) */
+uint64_t ft2_sample_pool_hash(const void *data, size_t size);
+
+/* Number of bytes of s->origDataPtr that make up the sample:
+ * left taps + data + right taps. */
+size_t ft2_sample_pool_data_size(const ft2_sample_t *s);
+
+/* Adds a fixed sample's buffer to the pool. If an identical buffer is
+ * already pooled, the sample's own buffer is freed and it takes a
+ * reference to the shared one instead. hash must be
+ * ft2_sample_pool_hash(s->origDataPtr, ft2_sample_pool_data_size(s)). */
+void ft2_sample_pool_intern(ft2_sample_t *s, uint64_t hash);
+
+/* Takes another reference to the sample's buffer (pooling it if it was
+ * private), so the sample's next unshare copies it and the buffer outlives
+ * the sample's own release. Drop it with ft2_sample_pool_release().
+ * Returns false if the pool entry could not be allocated. */
+bool ft2_sample_pool_retain(const ft2_sample_t *s);
+
+/* True if the sample's buffer has more than one reference (another
+ * instance's sample, or a buffer kept for voices still playing it) */
+bool ft2_sample_pool_is_shared(const ft2_sample_t *s);
+
+/* Gives the sample a private, writable buffer if it is shared.
+ * Returns false if the copy could not be allocated (sample unchanged). */
+bool ft2_sample_pool_unshare(ft2_sample_t *s);
+
+/* Drops a reference to a pooled buffer, or frees an unpooled one.
+ * Replaces free(s->origDataPtr); NULL is ignored. */
+void ft2_sample_pool_release(int8_t *origDataPtr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,451 @@
+/**
+ * @file ft2_plugin_sample_undo.c
+ * @brief Multi-level undo/redo for sample edits.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_plugin_sample_undo.h"
+#include "ft2_plugin_sample_handoff.h"
+#include "ft2_plugin_sample_pool.h"
+#include "../ft2_instance.h"
+
+typedef struct ft2_undo_chunk_t {
+	struct ft2_undo_chunk_t *next;
+	int32_t pos, count; /* Samples, relative to the entry's offset */
+} ft2_undo_chunk_t;
+
+#define CHUNK_DATA(c) ((int8_t *)((c) + 1))
+
+static int32_t sampleBytes(uint8_t flags)
+{
+	return (flags & FT2_SAMPLE_16BIT) ? 2 : 1;
+}
+
+static bool hasData(const ft2_sample_t *s)
+{
+	return s != NULL && s->dataPtr != NULL && s->length > 0;
+}
+
+static ft2_sample_t *getSlot(ft2_instance_t *inst, int16_t instrNum, int8_t smpNum)
+{
+	if (instrNum < 1 || instrNum > FT2_MAX_INST || smpNum < 0 || smpNum >= FT2_MAX_SMP_PER_INST)
+		return NULL;
+
+	ft2_instr_t *ins = inst->replayer.instr[instrNum];
+	return (ins != NULL) ? &ins->smp[smpNum] : NULL;
+}
+
+static bool isSlot(const ft2_undo_entry_t *e, int16_t instrNum, int8_t smpNum)
+{
+	return e->instrNum == instrNum && e->smpNum == smpNum;
+}
+
+/* Copies samples out as they really are: a fixed sample has a few of
+ * them overwritten past its loop end, the originals are in fixedSmp */
+static void readSamples(const ft2_sample_t *s, int32_t pos, int32_t count, int8_t *dst)
+{
+	const int32_t bps = sampleBytes(s->flags);
+	memcpy(dst, s->dataPtr + (size_t)pos * bps, (size_t)count * bps);
+
+	if (!s->isFixed)
+		return;
+
+	const int32_t from = (pos > s->fixedPos) ? pos : s->fixedPos;
+	const int32_t fixedEnd = s->fixedPos + FT2_MAX_RIGHT_TAPS;
+	const int32_t to = (pos + count < fixedEnd) ? pos + count : fixedEnd;
+	for (int32_t i = from; i < to; i++) {
+		if (bps == 2)
+			((int16_t *)dst)[i - pos] = s->fixedSmp[i - s->fixedPos];
+		else
+			dst[i - pos] = (int8_t)s->fixedSmp[i - s->fixedPos];
+	}
+}
+
+static size_t chunkBytes(const ft2_undo_chunk_t *c, int32_t bps)
+{
+	return sizeof(ft2_undo_chunk_t) + (size_t)c->count * bps;
+}
+
+static size_t listBytes(const ft2_undo_chunk_t *c, uint8_t flags)
+{
+	size_t bytes = 0;
+	for (; c != NULL; c = c->next)
+		bytes += chunkBytes(c, sampleBytes(flags));
+	return bytes;
+}
+
+static void freeChunks(ft2_undo_chunk_t *c)
+{
+	while (c != NULL) {
+		ft2_undo_chunk_t *next = c->next;
+		free(c);
+		c = next;
+	}
+}
+
+static ft2_undo_chunk_t *newChunk(int32_t pos, int32_t count, int32_t bps)
+{
+	ft2_undo_chunk_t *c = (ft2_undo_chunk_t *)malloc(sizeof(ft2_undo_chunk_t) + (size_t)count * bps);
+	if (c != NULL) {
+		c->next = NULL;
+		c->pos = pos;
+		c->count = count;
+	}
+	return c;
+}
+
+/* Samples [offset, offset+count) of s, cut into chunks */
+static bool captureChunks(const ft2_sample_t *s, int32_t offset, int32_t count, ft2_undo_chunk_t **out)
+{
+	const int32_t bps = sampleBytes(s->flags);
+	const int32_t perChunk = FT2_UNDO_CHUNK_BYTES / bps;
+	ft2_undo_chunk_t **tail = out;
+
+	for (int32_t pos = 0; pos < count; pos += perChunk) {
+		const int32_t n = (count - pos < perChunk) ? count - pos : perChunk;
+		ft2_undo_chunk_t *c = newChunk(pos, n, bps);
+		if (c == NULL) {
+			freeChunks(*out);
+			*out = NULL;
+			return false;
+		}
+
+		readSamples(s, offset + pos, n, CHUNK_DATA(c));
+		*tail = c;
+		tail = &c->next;
+	}
+
+	return true;
+}
+
+/* In-place edit: drops the before chunks it didn't change, and stores the
+ * new contents of the ones it did */
+static bool keepChanged(ft2_undo_entry_t *e, const ft2_sample_t *s)
+{
+	int16_t tmp[FT2_UNDO_CHUNK_BYTES / 2];
+	const int32_t bps = sampleBytes(s->flags);
+	ft2_undo_chunk_t **before = &e->before.chunks, **after = &e->after.chunks;
+
+	while (*before != NULL) {
+		ft2_undo_chunk_t *c = *before;
+		readSamples(s, e->offset + c->pos, c->count, (int8_t *)tmp);
+
+		if (memcmp(CHUNK_DATA(c), tmp, (size_t)c->count * bps) == 0) {
+			*before = c->next;
+			free(c);
+			continue;
+		}
+
+		ft2_undo_chunk_t *a = newChunk(c->pos, c->count, bps);
+		if (a == NULL)
+			return false;
+
+		memcpy(CHUNK_DATA(a), tmp, (size_t)c->count * bps);
+		*after = a;
+		after = &a->next;
+		before = &c->next;
+	}
+
+	return true;
+}
+
+static void takeImage(ft2_undo_image_t *img, const ft2_sample_t *s)
+{
+	const bool data = hasData(s);
+	img->chunks = NULL;
+	img->length = data ? s->length : 0;
+	img->loopStart = data ? s->loopStart : 0;
+	img->loopLength = data ? s->loopLength : 0;
+	img->flags = (s != NULL) ? s->flags : 0;
+	img->generation = (s != NULL) ? s->generation : 0;
+	img->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                               Journal                                     */
+/* ------------------------------------------------------------------------- */
+
+static void removeEntry(ft2_undo_journal_t *j, ft2_undo_entry_t *e)
+{
+	if (e->prev != NULL)
+		e->prev->next = e->next;
+	else
+		j->oldest = e->next;
+
+	if (e->next != NULL)
+		e->next->prev = e->prev;
+	else
+		j->newest = e->prev;
+
+	if (j->pending == e)
+		j->pending = NULL;
+
+	j->bytesUsed -= e->bytes;
+	j->numEntries--;
+	freeChunks(e->before.chunks);
+	freeChunks(e->after.chunks);
+	free(e);
+}
+
+static void updateBytes(ft2_undo_journal_t *j, ft2_undo_entry_t *e)
+{
+	const size_t bytes = sizeof(ft2_undo_entry_t) + listBytes(e->before.chunks, e->before.flags) +
+		listBytes(e->after.chunks, e->after.flags);
+	j->bytesUsed = j->bytesUsed - e->bytes + bytes;
+	e->bytes = bytes;
+}
+
+/* Undone entries of a slot, which a new edit makes unreachable */
+static void dropUndone(ft2_undo_journal_t *j, int16_t instrNum, int8_t smpNum)
+{
+	for (ft2_undo_entry_t *e = j->oldest, *next; e != NULL; e = next) {
+		next = e->next;
+		if (isSlot(e, instrNum, smpNum) && !e->applied)
+			removeEntry(j, e);
+	}
+}
+
+/* Oldest first, but never the newest entry. Redo entries only make sense
+ * as a whole, so once the first of a slot goes the others go with it. */
+static void trim(ft2_undo_journal_t *j)
+{
+	while (j->bytesUsed > j->memCap && j->oldest != j->newest) {
+		ft2_undo_entry_t *e = j->oldest;
+		if (e->applied)
+			removeEntry(j, e);
+		else
+			dropUndone(j, e->instrNum, e->smpNum);
+	}
+}
+
+void ft2_undo_init(ft2_undo_journal_t *j)
+{
+	if (j == NULL)
+		return;
+
+	memset(j, 0, sizeof(ft2_undo_journal_t));
+	j->memCap = (size_t)FT2_UNDO_DEFAULT_MEM_MB << 20;
+}
+
+void ft2_undo_free(ft2_undo_journal_t *j)
+{
+	if (j == NULL)
+		return;
+
+	while (j->oldest != NULL)
+		removeEntry(j, j->oldest);
+}
+
+void ft2_undo_set_mem_cap(ft2_undo_journal_t *j, size_t bytes)
+{
+	if (j == NULL)
+		return;
+
+	j->memCap = bytes;
+	trim(j);
+}
+
+void ft2_undo_forget_slot(ft2_undo_journal_t *j, int16_t instrNum, int8_t smpNum)
+{
+	if (j == NULL)
+		return;
+
+	for (ft2_undo_entry_t *e = j->oldest, *next; e != NULL; e = next) {
+		next = e->next;
+		if (isSlot(e, instrNum, smpNum))
+			removeEntry(j, e);
+	}
+}
+
+bool ft2_undo_begin(ft2_undo_journal_t *j, ft2_instance_t *inst, int16_t instrNum, int8_t smpNum,
+	int32_t offset, int32_t count, bool keepSampleMark)
+{
+	if (j == NULL || inst == NULL)
+		return false;
+
+	ft2_undo_end(j, inst);
+
+	const ft2_sample_t *s = getSlot(inst, instrNum, smpNum);
+	const int32_t length = hasData(s) ? s->length : 0;
+	if (offset < 0) offset = 0;
+	if (offset > length) offset = length;
+	if (count < 0 || count > length - offset) count = length - offset;
+
+	dropUndone(j, instrNum, smpNum);
+
+	ft2_undo_entry_t *e = (ft2_undo_entry_t *)calloc(1, sizeof(ft2_undo_entry_t));
+	if (e == NULL)
+		return false;
+
+	e->instrNum = instrNum;
+	e->smpNum = smpNum;
+	e->offset = offset;
+	e->applied = true;
+	e->keepSampleMark = keepSampleMark;
+	takeImage(&e->before, s);
+	e->before.count = count;
+
+	if (count > 0 && !captureChunks(s, offset, count, &e->before.chunks)) {
+		free(e);
+		return false;
+	}
+
+	e->prev = j->newest;
+	if (j->newest != NULL)
+		j->newest->next = e;
+	else
+		j->oldest = e;
+	j->newest = e;
+	j->pending = e;
+	j->numEntries++;
+
+	updateBytes(j, e);
+	trim(j);
+	return true;
+}
+
+void ft2_undo_end(ft2_undo_journal_t *j, ft2_instance_t *inst)
+{
+	if (j == NULL || inst == NULL || j->pending == NULL)
+		return;
+
+	ft2_undo_entry_t *e = j->pending;
+	j->pending = NULL;
+
+	const ft2_sample_t *s = getSlot(inst, e->instrNum, e->smpNum);
+	ft2_undo_image_t *b = &e->before, *a = &e->after;
+	takeImage(a, s);
+
+	/* Whatever followed the region moved by the change in length */
+	const int32_t count = b->count + (a->length - b->length);
+	const bool sameDepth = (a->length == 0 || b->length == 0 || sampleBytes(a->flags) == sampleBytes(b->flags));
+	const bool wholeSample = (e->offset == 0 && b->count == b->length && count == a->length);
+
+	if (count < 0 || e->offset + count > a->length || (!sameDepth && !wholeSample)) {
+		/* The sample changed beyond the region it was edited in, so
+		 * neither this nor anything older fits onto it any more */
+		ft2_undo_forget_slot(j, e->instrNum, e->smpNum);
+		return;
+	}
+
+	a->count = count;
+	e->sparse = (count == b->count && sameDepth);
+
+	const bool ok = e->sparse ? keepChanged(e, s) : (count == 0 || captureChunks(s, e->offset, count, &a->chunks));
+	if (!ok) {
+		removeEntry(j, e);
+		return;
+	}
+
+	/* Nothing changed at all */
+	if (e->sparse && b->chunks == NULL && a->length == b->length && a->loopStart == b->loopStart &&
+		a->loopLength == b->loopLength && a->flags == b->flags) {
+		removeEntry(j, e);
+		return;
+	}
+
+	updateBytes(j, e);
+	trim(j);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Undo / redo                                  */
+/* ------------------------------------------------------------------------- */
+
+static bool writeInPlace(ft2_sample_t *s, const ft2_undo_entry_t *e, const ft2_undo_image_t *to)
+{
+	if (to->chunks == NULL)
+		return true;
+
+	if (!ft2_unfix_sample(s))
+		return false;
+
+	const int32_t bps = sampleBytes(s->flags);
+	for (const ft2_undo_chunk_t *c = to->chunks; c != NULL; c = c->next)
+		memcpy(s->dataPtr + (size_t)(e->offset + c->pos) * bps, CHUNK_DATA(c), (size_t)c->count * bps);
+
+	return true;
+}
+
+/* New buffer: what precedes the region, the region as it was/will be, and what follows it */
+static bool rebuild(ft2_sample_t *s, const ft2_undo_entry_t *e, const ft2_undo_image_t *from, const ft2_undo_image_t *to)
+{
+	int8_t *origDataPtr = NULL, *dataPtr = NULL;
+
+	if (to->length > 0) {
+		const int32_t bps = sampleBytes(to->flags);
+		const int32_t padding = FT2_MAX_TAPS * bps;
+
+		origDataPtr = (int8_t *)calloc((size_t)to->length * bps + padding * 2, 1);
+		if (origDataPtr == NULL)
+			return false;
+		dataPtr = origDataPtr + padding;
+
+		if (e->offset > 0)
+			readSamples(s, 0, e->offset, dataPtr);
+
+		for (const ft2_undo_chunk_t *c = to->chunks; c != NULL; c = c->next)
+			memcpy(dataPtr + (size_t)(e->offset + c->pos) * bps, CHUNK_DATA(c), (size_t)c->count * bps);
+
+		const int32_t tail = from->length - e->offset - from->count;
+		if (tail > 0)
+			readSamples(s, e->offset + from->count, tail, dataPtr + (size_t)(e->offset + to->count) * bps);
+	}
+
+	if (s->origDataPtr != NULL)
+		ft2_sample_pool_release(s->origDataPtr);
+
+	s->origDataPtr = origDataPtr;
+	s->dataPtr = dataPtr;
+	s->isFixed = false;
+	return true;
+}
+
+bool ft2_undo_step(ft2_undo_journal_t *j, ft2_instance_t *inst, int16_t instrNum, int8_t smpNum,
+	bool redo, bool *keepSampleMark)
+{
+	if (j == NULL || inst == NULL)
+		return false;
+
+	ft2_undo_end(j, inst);
+
+	/* Undo the newest applied edit of the slot, redo the oldest undone one */
+	ft2_undo_entry_t *e;
+	if (redo) {
+		for (e = j->oldest; e != NULL && !(isSlot(e, instrNum, smpNum) && !e->applied); e = e->next);
+	} else {
+		for (e = j->newest; e != NULL && !(isSlot(e, instrNum, smpNum) && e->applied); e = e->prev);
+	}
+
+	if (e == NULL)
+		return false;
+
+	const ft2_undo_image_t *from = redo ? &e->before : &e->after;
+	const ft2_undo_image_t *to = redo ? &e->after : &e->before;
+
+	/* Anything that bypassed the journal (a loop change, a reload...) gave
+	 * the sample a generation of its own */
+	ft2_sample_t *s = getSlot(inst, instrNum, smpNum);
+	if (s == NULL || s->generation != from->generation) {
+		ft2_undo_forget_slot(j, instrNum, smpNum);
+		return false;
+	}
+
+	ft2_sample_edit_begin(inst, s);
+	if (!(e->sparse ? writeInPlace(s, e, to) : rebuild(s, e, from, to)))
+		return false;
+
+	s->flags = to->flags;
+	s->length = to->length;
+	s->loopStart = to->loopStart;
+	s->loopLength = to->loopLength;
+	ft2_fix_sample(s);
+	s->generation = to->generation; /* Back to that version, so the next step matches */
+
+	e->applied = redo;
+	if (keepSampleMark != NULL)
+		*keepSampleMark = e->keepSampleMark;
+
+	return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file ft2_plugin_sample_undo.h
+ * @brief Multi-level undo/redo for sample edits.
+ *
+ * Every edit is recorded as a splice: at some offset, count samples were
+ * replaced by others (the same number for in-place effects, a different
+ * one for cut, paste and anything else that changes the length). Only
+ * that region is kept, in fixed-size chunks. For an in-place edit the
+ * chunks it left unchanged are dropped once it is finished, so a filter on
+ * a selection costs the selection at most, and undo/redo only rewrite the
+ * chunks that differ.
+ *
+ * Each sample slot has its own history (undo and redo act on the slot
+ * being edited), and all of them share one memory budget: when it is
+ * exceeded the oldest entries go first. The newest entry is always kept,
+ * so there is at least one level as long as it fits in memory at all.
+ * Loading or clearing a sample, instrument or module drops the affected
+ * history; any other change made outside the journal is caught by the
+ * sample's generation, which applying an entry restores.
+ *
+ * UI thread only. Applying an entry goes through ft2_sample_edit_begin(),
+ * so voices playing the sample carry on.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ft2_instance_t;
+struct ft2_undo_chunk_t;
+
+#define FT2_UNDO_CHUNK_BYTES 8192
+#define FT2_UNDO_DEFAULT_MEM_MB 64
+#define FT2_UNDO_MIN_MEM_MB 1
+#define FT2_UNDO_MAX_MEM_MB 2048
+
+/* The sample on one side of an edit */
+typedef struct ft2_undo_image_t {
+	struct ft2_undo_chunk_t *chunks;
+	int32_t length, loopStart, loopLength;
+	int32_t count; /* Samples in the edited region */
+	uint32_t generation; /* The sample's, see ft2_fix_sample() */
+	uint8_t flags;
+} ft2_undo_image_t;
+
+typedef struct ft2_undo_entry_t {
+	struct ft2_undo_entry_t *prev, *next; /* Oldest first */
+	ft2_undo_image_t before, after;
+	int32_t offset;
+	size_t bytes;
+	int16_t instrNum;
+	int8_t smpNum;
+	bool sparse;  /* In place: only the chunks that changed are stored */
+	bool applied; /* false while undone */
+	bool keepSampleMark;
+} ft2_undo_entry_t;
+
+typedef struct ft2_undo_journal_t {
+	ft2_undo_entry_t *oldest, *newest;
+	ft2_undo_entry_t *pending; /* Begun, after image not taken yet */
+	size_t bytesUsed, memCap;
+	uint32_t numEntries;
+} ft2_undo_journal_t;
+
+void ft2_undo_init(ft2_undo_journal_t *j);
+void ft2_undo_free(ft2_undo_journal_t *j);
+void ft2_undo_set_mem_cap(ft2_undo_journal_t *j, size_t bytes);
+
+/* Before an edit that replaces samples [offset, offset+count) of a slot
+ * (anything after them may shift). The edit is finished by the next call
+ * into the journal, or explicitly with ft2_undo_end(). Returns false if
+ * out of memory: the edit then can't be undone. */
+bool ft2_undo_begin(ft2_undo_journal_t *j, struct ft2_instance_t *inst, int16_t instrNum, int8_t smpNum,
+	int32_t offset, int32_t count, bool keepSampleMark);
+void ft2_undo_end(ft2_undo_journal_t *j, struct ft2_instance_t *inst);
+
+/* Undoes the slot's newest edit, or redoes the last one undone. Returns
+ * false if there is none, or the sample has been changed or replaced
+ * since outside the journal (then the slot's history is dropped): the
+ * sample's generation must still be the one the edit left. */
+bool ft2_undo_step(ft2_undo_journal_t *j, struct ft2_instance_t *inst, int16_t instrNum, int8_t smpNum,
+	bool redo, bool *keepSampleMark);
+
+/* Drops every entry of a slot */
+void ft2_undo_forget_slot(ft2_undo_journal_t *j, int16_t instrNum, int8_t smpNum);
+
+#ifdef __cplusplus
+}
+#endif
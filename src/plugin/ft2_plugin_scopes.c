@@ -173,9 +173,9 @@ uint64_t ft2_period_to_scope_delta(ft2_instance_t *inst, uint32_t period)
 	if (inst->audio.linearPeriodsFlag)
 	{
 		const uint32_t invPeriod = ((12 * 192 * 4) - period) & 0xFFFF;
-		return inst->replayer.scopeLogTab[invPeriod % (12 * 16 * 4)] >> ((14 - invPeriod / (12 * 16 * 4)) & 31);
+		return ft2_scope_tables_get()->scopeLogTab[invPeriod % (12 * 16 * 4)] >> ((14 - invPeriod / (12 * 16 * 4)) & 31);
 	}
-	return inst->replayer.scopeAmigaPeriodDiv / period;
+	return ft2_scope_tables_get()->scopeAmigaPeriodDiv / period;
 }
 
 /* Converts period to scope draw delta (for display rate) */
@@ -187,9 +187,9 @@ uint64_t ft2_period_to_scope_draw_delta(ft2_instance_t *inst, uint32_t period)
 	if (inst->audio.linearPeriodsFlag)
 	{
 		const uint32_t invPeriod = ((12 * 192 * 4) - period) & 0xFFFF;
-		return inst->replayer.scopeDrawLogTab[invPeriod % (12 * 16 * 4)] >> ((14 - invPeriod / (12 * 16 * 4)) & 31);
+		return ft2_scope_tables_get()->scopeDrawLogTab[invPeriod % (12 * 16 * 4)] >> ((14 - invPeriod / (12 * 16 * 4)) & 31);
 	}
-	return inst->replayer.scopeDrawAmigaPeriodDiv / period;
+	return ft2_scope_tables_get()->scopeDrawAmigaPeriodDiv / period;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1019,6 +1019,50 @@ void ft2_scopes_update(ft2_scopes_t *scopes, struct ft2_instance_t *inst)
 	}
 }
 
+/* Moves scopes showing r->oldData over to the edited sample (see ft2_plugin_sample_handoff.h) */
+void ft2_scopes_rebase_sample(ft2_scopes_t *scopes, const ft2_sample_rebase_t *r)
+{
+	if (!scopes || !r) return;
+
+	for (int32_t i = 0; i < MAX_CHANNELS; i++)
+	{
+		scope_t *s = &scopes->scopes[i];
+		if (s->base8 != r->oldData) continue;
+
+		if (!r->data || r->length < 1)
+		{
+			s->active = false;
+			s->base8 = NULL;
+			s->base16 = NULL;
+			continue;
+		}
+
+		const bool sample16Bit = !!(r->flags & FT2_SAMPLE_16BIT);
+		uint8_t loopType = (r->loopLength < 1) ? LOOP_OFF : (r->flags & (FT2_LOOP_FWD | FT2_LOOP_BIDI));
+
+		s->base8 = r->data;
+		s->base16 = sample16Bit ? (const int16_t *)r->data : NULL;
+		s->sample16Bit = sample16Bit;
+		s->loopType = loopType;
+		s->loopStart = r->loopStart;
+		s->loopLength = r->loopLength;
+		s->loopEnd = r->loopStart + r->loopLength;
+		s->sampleEnd = (loopType == LOOP_OFF) ? r->length : s->loopEnd;
+		if (loopType != LOOP_BIDI) s->samplingBackwards = false;
+
+		if (s->position >= s->sampleEnd)
+		{
+			if (loopType == LOOP_OFF)
+				s->active = false;
+			else
+			{
+				s->position = s->loopStart + (s->position - s->loopStart) % s->loopLength;
+				s->hasLooped = true;
+			}
+		}
+	}
+}
+
 void ft2_scope_stop(ft2_scopes_t *scopes, int channel)
 {
 	if (!scopes || channel < 0 || channel >= MAX_CHANNELS) return;
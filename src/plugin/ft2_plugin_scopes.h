@@ -15,6 +15,7 @@ extern "C" {
 struct ft2_video_t;
 struct ft2_bmp_t;
 struct ft2_instance_t;
+struct ft2_sample_rebase_t;
 
 /* Limits and dimensions */
 #define MAX_CHANNELS 32
@@ -97,6 +98,7 @@ uint64_t ft2_period_to_scope_draw_delta(struct ft2_instance_t *inst, uint32_t pe
 /* Scope control */
 void ft2_scope_stop(ft2_scopes_t *scopes, int channel);
 void ft2_scopes_stop_all(ft2_scopes_t *scopes);
+void ft2_scopes_rebase_sample(ft2_scopes_t *scopes, const struct ft2_sample_rebase_t *r);
 
 /* Drawing */
 void ft2_scopes_draw(ft2_scopes_t *scopes, struct ft2_video_t *video, const struct ft2_bmp_t *bmp);
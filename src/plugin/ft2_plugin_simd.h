@@ -0,0 +1,18 @@
+/**
+ * @file ft2_plugin_simd.h
+ * @brief Compile-time SIMD selection for vectorized kernels.
+ *
+ * Defines FT2_SIMD_SSE2 on x86/x64 and FT2_SIMD_NEON on ARM targets that
+ * guarantee the instruction set, and includes the matching intrinsics header.
+ * Kernels must always provide a scalar fallback for other targets.
+ */
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FT2_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define FT2_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
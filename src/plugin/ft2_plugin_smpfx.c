@@ -19,6 +19,7 @@
 #include "ft2_plugin_wave_panel.h"
 #include "ft2_plugin_filter_panel.h"
 #include "ft2_plugin_replayer.h"
+#include "ft2_plugin_sample_job.h"
 #include "../ft2_instance.h"
 
 #ifndef M_PI
@@ -30,12 +31,6 @@
 
 enum { REMOVE_SAMPLE_MARK = 0, KEEP_SAMPLE_MARK = 1 };
 
-/* 2nd-order IIR biquad filter state */
-typedef struct {
-	double a1, a2, a3, b1, b2;  /* Coefficients */
-	double inTmp[2], outTmp[2]; /* Delay line */
-} resoFilter_t;
-
 #define UNDO_STATE(inst) (&FT2_SAMPLE_ED(inst)->undo)
 #define SMPFX_STATE(inst) (&FT2_SAMPLE_ED(inst)->smpfx)
 
@@ -76,48 +71,42 @@ static void getSmpFxRange(ft2_instance_t *inst, ft2_sample_t *s, int32_t *x1, in
 void clearSampleUndo(ft2_instance_t *inst)
 {
 	if (!inst || !inst->ui) return;
-	smp_undo_t *undo = UNDO_STATE(inst);
-	if (undo->smpData8) { free(undo->smpData8); undo->smpData8 = NULL; }
-	if (undo->smpData16) { free(undo->smpData16); undo->smpData16 = NULL; }
-	undo->filled = false;
-	undo->keepSampleMark = false;
+	ft2_undo_free(UNDO_STATE(inst));
 }
 
-void fillSampleUndo(ft2_instance_t *inst, bool keepSampleMark)
+/* The slot's sample was replaced or cleared */
+void forgetSampleUndo(ft2_instance_t *inst, int16_t instrNum, int16_t smpNum)
 {
 	if (!inst || !inst->ui) return;
-	smp_undo_t *undo = UNDO_STATE(inst);
-	undo->filled = false;
-
-	ft2_sample_t *s = getSmpFxCurSample(inst);
-	if (!s || s->length == 0 || !s->dataPtr) return;
+	ft2_undo_forget_slot(UNDO_STATE(inst), instrNum, (int8_t)smpNum);
+}
 
-	ft2_unfix_sample(s);
-	clearSampleUndo(inst);
+/* The instrument was replaced or cleared, with all its samples */
+void forgetInstrUndo(ft2_instance_t *inst, int16_t instrNum)
+{
+	if (!inst || !inst->ui) return;
+	for (int8_t i = 0; i < FT2_MAX_SMP_PER_INST; i++)
+		ft2_undo_forget_slot(UNDO_STATE(inst), instrNum, i);
+}
 
-	undo->undoInstr = inst->editor.curInstr;
-	undo->undoSmp = inst->editor.curSmp;
-	undo->flags = s->flags;
-	undo->length = s->length;
-	undo->loopStart = s->loopStart;
-	undo->loopLength = s->loopLength;
-	undo->keepSampleMark = keepSampleMark;
+/* Records samples [x1, x2) of the current sample before an edit rewrites
+ * them (or replaces them with a different number of samples) */
+void fillSampleUndoRange(ft2_instance_t *inst, int32_t x1, int32_t x2, bool keepSampleMark)
+{
+	if (!inst || !inst->ui || inst->editor.curInstr == 0) return;
 
-	if (s->flags & SAMPLE_16BIT)
-	{
-		undo->smpData16 = (int16_t *)malloc(s->length * sizeof(int16_t));
-		if (undo->smpData16) { memcpy(undo->smpData16, s->dataPtr, s->length * sizeof(int16_t)); undo->filled = true; }
-	}
-	else
-	{
-		undo->smpData8 = (int8_t *)malloc(s->length * sizeof(int8_t));
-		if (undo->smpData8) { memcpy(undo->smpData8, s->dataPtr, s->length * sizeof(int8_t)); undo->filled = true; }
-	}
+	ft2_undo_journal_t *undo = UNDO_STATE(inst);
+	ft2_undo_set_mem_cap(undo, (size_t)inst->config.smpUndoMemMB << 20);
+	ft2_undo_begin(undo, inst, inst->editor.curInstr, inst->editor.curSmp, x1, x2 - x1, keepSampleMark);
+}
 
-	ft2_fix_sample(s);
+/* Records the whole current sample */
+void fillSampleUndo(ft2_instance_t *inst, bool keepSampleMark)
+{
+	fillSampleUndoRange(inst, 0, INT32_MAX, keepSampleMark);
 }
 
-/* Allocates new 16-bit sample, stopping any playing voices */
+/* Allocates new 16-bit sample (playing voices move over once it is published) */
 static ft2_sample_t *setupNewSample(ft2_instance_t *inst, uint32_t length)
 {
 	ft2_instr_t *instr = inst->replayer.instr[inst->editor.curInstr];
@@ -129,7 +118,7 @@ static ft2_sample_t *setupNewSample(ft2_instance_t *inst, uint32_t length)
 	}
 
 	ft2_sample_t *s = &instr->smp[inst->editor.curSmp];
-	ft2_stop_sample_voices(inst, s);
+	ft2_sample_edit_begin(inst, s);
 
 	if (!allocateSmpData(inst, inst->editor.curInstr, inst->editor.curSmp, length, true))
 		return NULL;
@@ -281,21 +270,6 @@ void pbSfxSaw(ft2_instance_t *inst) { ft2_wave_panel_show(inst, WAVE_TYPE_SAW);
 void pbSfxSine(ft2_instance_t *inst) { ft2_wave_panel_show(inst, WAVE_TYPE_SINE); }
 void pbSfxSquare(ft2_instance_t *inst) { ft2_wave_panel_show(inst, WAVE_TYPE_SQUARE); }
 
-/* ------------------------------------------------------------------------- */
-/*                           FILTERS                                         */
-/* ------------------------------------------------------------------------- */
-
-void pbSfxResoUp(ft2_instance_t *inst) {
-	if (!inst || !inst->ui) return;
-	smpfx_state_t *fx = SMPFX_STATE(inst);
-	if (fx->filterResonance < RESONANCE_RANGE) { fx->filterResonance++; inst->uiState.updateSampleEditor = true; }
-}
-void pbSfxResoDown(ft2_instance_t *inst) {
-	if (!inst || !inst->ui) return;
-	smpfx_state_t *fx = SMPFX_STATE(inst);
-	if (fx->filterResonance > 0) { fx->filterResonance--; inst->uiState.updateSampleEditor = true; }
-}
-
 /* Calculates sample rate at C-4 from relativeNote and finetune */
 static double getSampleC4Rate(ft2_sample_t *s)
 {
@@ -305,123 +279,365 @@ static double getSampleC4Rate(ft2_sample_t *s)
 
 #define CUTOFF_EPSILON (1E-4)
 
-/* 2nd-order Butterworth lowpass with resonance (Q controlled by resonance param) */
-static void setupResoLpFilter(ft2_sample_t *s, resoFilter_t *f, double cutoff, uint32_t resonance, bool absoluteCutoff)
+/* Cutoff in Hz as a fraction of the sample's C-4 rate, below Nyquist */
+static double getRelativeCutoff(ft2_sample_t *s, double cutoff)
 {
-	if (!absoluteCutoff)
-	{
-		const double sampleFreq = getSampleC4Rate(s);
-		if (cutoff >= sampleFreq / 2.0) cutoff = (sampleFreq / 2.0) - CUTOFF_EPSILON;
-		cutoff /= sampleFreq;
-	}
+	const double sampleFreq = getSampleC4Rate(s);
+	if (cutoff >= sampleFreq / 2.0) cutoff = (sampleFreq / 2.0) - CUTOFF_EPSILON;
+	return cutoff / sampleFreq;
+}
 
+static double getResonanceDamping(uint32_t resonance)
+{
 	double r = (resonance > 0) ? pow(10.0, (resonance * -24.0) / (RESONANCE_RANGE * 20.0)) : sqrt(2.0);
 	if (r < RESONANCE_MIN) r = RESONANCE_MIN;
+	return r;
+}
 
+/* 2nd-order Butterworth lowpass with resonance (Q controlled by resonance param) */
+void smpfx_setup_lowpass(smpfx_params_t *p, double cutoff, uint32_t resonance)
+{
+	const double r = getResonanceDamping(resonance);
 	const double c = 1.0 / tan(M_PI * cutoff);
-	f->a1 = 1.0 / (1.0 + r * c + c * c);
-	f->a2 = 2.0 * f->a1;
-	f->a3 = f->a1;
-	f->b1 = 2.0 * (1.0 - c * c) * f->a1;
-	f->b2 = (1.0 - r * c + c * c) * f->a1;
-	f->inTmp[0] = f->inTmp[1] = f->outTmp[0] = f->outTmp[1] = 0.0;
+	p->a1 = 1.0 / (1.0 + r * c + c * c);
+	p->a2 = 2.0 * p->a1;
+	p->a3 = p->a1;
+	p->b1 = 2.0 * (1.0 - c * c) * p->a1;
+	p->b2 = (1.0 - r * c + c * c) * p->a1;
 }
 
 /* 2nd-order Butterworth highpass with resonance */
-static void setupResoHpFilter(ft2_sample_t *s, resoFilter_t *f, double cutoff, uint32_t resonance, bool absoluteCutoff)
+void smpfx_setup_highpass(smpfx_params_t *p, double cutoff, uint32_t resonance)
 {
-	if (!absoluteCutoff)
+	const double r = getResonanceDamping(resonance);
+	const double c = tan(M_PI * cutoff);
+	p->a1 = 1.0 / (1.0 + r * c + c * c);
+	p->a2 = -2.0 * p->a1;
+	p->a3 = p->a1;
+	p->b1 = 2.0 * (c * c - 1.0) * p->a1;
+	p->b2 = (1.0 - r * c + c * c) * p->a1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                         BLOCK KERNELS                                     */
+/* ------------------------------------------------------------------------- */
+
+#define SMPFX_BLOCK_LEN 4096 /* Samples per pass, and per progress report */
+
+static void loadBlock(const int8_t *src, int32_t count, bool sample16Bit, double *x)
+{
+	if (sample16Bit)
 	{
-		const double sampleFreq = getSampleC4Rate(s);
-		if (cutoff >= sampleFreq / 2.0) cutoff = (sampleFreq / 2.0) - CUTOFF_EPSILON;
-		cutoff /= sampleFreq;
+		const int16_t *src16 = (const int16_t *)src;
+		for (int32_t i = 0; i < count; i++) x[i] = src16[i];
 	}
+	else
+	{
+		for (int32_t i = 0; i < count; i++) x[i] = src[i];
+	}
+}
 
-	double r = (resonance > 0) ? pow(10.0, (resonance * -24.0) / (RESONANCE_RANGE * 20.0)) : sqrt(2.0);
-	if (r < RESONANCE_MIN) r = RESONANCE_MIN;
+/* Clamps, then truncates toward zero */
+static void storeBlock(const double *y, int32_t count, bool sample16Bit, int8_t *dst)
+{
+	if (sample16Bit)
+	{
+		int16_t *dst16 = (int16_t *)dst;
+		for (int32_t i = 0; i < count; i++)
+		{
+			double out = y[i];
+			out = (out < INT16_MIN) ? INT16_MIN : out;
+			out = (out > INT16_MAX) ? INT16_MAX : out;
+			dst16[i] = (int16_t)out;
+		}
+	}
+	else
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			double out = y[i];
+			out = (out < INT8_MIN) ? INT8_MIN : out;
+			out = (out > INT8_MAX) ? INT8_MAX : out;
+			dst[i] = (int8_t)out;
+		}
+	}
+}
 
-	const double c = tan(M_PI * cutoff);
-	f->a1 = 1.0 / (1.0 + r * c + c * c);
-	f->a2 = -2.0 * f->a1;
-	f->a3 = f->a1;
-	f->b1 = 2.0 * (c * c - 1.0) * f->a1;
-	f->b2 = (1.0 - r * c + c * c) * f->a1;
-	f->inTmp[0] = f->inTmp[1] = f->outTmp[0] = f->outTmp[1] = 0.0;
+/* x and y start with the two samples before the block. The feed-forward
+ * half has no dependency between samples. The feedback half makes two
+ * outputs per step, the second with the first substituted in, so the
+ * serial chain is half as long (rounding can differ by 1 LSB). */
+static void biquadBlock(const smpfx_params_t *p, const double *x, double *y, double *v, int32_t count)
+{
+	const double a1 = p->a1, a2 = p->a2, a3 = p->a3, b1 = p->b1, b2 = p->b2;
+
+	for (int32_t i = 0; i < count; i++)
+		v[i] = ((a1 * x[i + 2]) + (a2 * x[i + 1])) + (a3 * x[i]);
+
+	const double c1 = (b1 * b1) - b2, c2 = b1 * b2;
+	double y1 = y[1], y2 = y[0];
+	int32_t i = 0;
+	for (; i + 1 < count; i += 2)
+	{
+		const double w = v[i + 1] - (b1 * v[i]);
+		const double out0 = (v[i] - (b2 * y2)) - (b1 * y1);
+		const double out1 = (w + (c2 * y2)) + (c1 * y1);
+		y[i + 2] = out0;
+		y[i + 3] = out1;
+		y2 = out0;
+		y1 = out1;
+	}
+	for (; i < count; i++)
+	{
+		const double out = (v[i] - (b1 * y1)) - (b2 * y2);
+		y[i + 2] = out;
+		y2 = y1;
+		y1 = out;
+	}
 }
 
-/* Applies biquad filter to sample range; optionally normalizes output */
-static bool applyResoFilter(ft2_instance_t *inst, ft2_sample_t *s, resoFilter_t *f, int32_t x1, int32_t x2)
+/* Amplify in 10.22 fixed point. x * mul is exact in a double, and so is
+ * the scaled value; offsetting it makes truncation a floor, as >> was. */
+static void ampBlock(const int8_t *src, int8_t *dst, int32_t count, bool sample16Bit, int32_t mul)
 {
-	if (x1 < 0) x1 = 0;
-	if (x2 > s->length) x2 = s->length;
-	if (x2 <= x1) return true;
+	const double dMul = mul * (1.0 / (1 << 22));
+	if (sample16Bit)
+	{
+		const int16_t *src16 = (const int16_t *)src;
+		int16_t *dst16 = (int16_t *)dst;
+		for (int32_t i = 0; i < count; i++)
+		{
+			double out = src16[i] * dMul;
+			out = (out < INT16_MIN) ? INT16_MIN : out;
+			out = (out > INT16_MAX) ? INT16_MAX : out;
+			dst16[i] = (int16_t)((int32_t)(out + 65536.0) - 65536);
+		}
+	}
+	else
+	{
+		for (int32_t i = 0; i < count; i++)
+		{
+			double out = src[i] * dMul;
+			out = (out < INT8_MIN) ? INT8_MIN : out;
+			out = (out > INT8_MAX) ? INT8_MAX : out;
+			dst[i] = (int8_t)((int32_t)(out + 65536.0) - 65536);
+		}
+	}
+}
+
+bool smpfx_render(const smpfx_params_t *p, const int8_t *src, int8_t *dst, int32_t len, bool sample16Bit,
+	ft2_sample_job_t *job)
+{
+	if (!p || !src || !dst || len < 1) return false;
+
+	const int32_t bytesPerSample = sample16Bit ? 2 : 1;
+	if (p->op == SMPFX_OP_AMP)
+	{
+		for (int32_t pos = 0; pos < len; pos += SMPFX_BLOCK_LEN)
+		{
+			const int32_t count = (len - pos < SMPFX_BLOCK_LEN) ? len - pos : SMPFX_BLOCK_LEN;
+			ampBlock(src + (size_t)pos * bytesPerSample, dst + (size_t)pos * bytesPerSample, count, sample16Bit, p->ampMul);
+			if (job && !ft2_sample_job_report(job, (uint64_t)pos + count, (uint64_t)len)) return false;
+		}
+		return true;
+	}
 
-	const int32_t len = x2 - x1;
-	ft2_stop_sample_voices(inst, s);
+	/* Normalizing needs the peak of the whole range before anything is stored */
+	const bool normalize = (p->op == SMPFX_OP_FILTER) && p->normalize;
+	double *x = (double *)malloc((2 + SMPFX_BLOCK_LEN) * sizeof(double));
+	double *y = (double *)malloc((2 + SMPFX_BLOCK_LEN) * sizeof(double));
+	double *v = (double *)malloc(SMPFX_BLOCK_LEN * sizeof(double));
+	double *dSmp = normalize ? (double *)malloc((size_t)len * sizeof(double)) : NULL;
+	if (!x || !y || !v || (normalize && !dSmp))
+	{
+		free(x); free(y); free(v); free(dSmp);
+		return false;
+	}
 
-	bool doNormalize = (inst && inst->ui) ? SMPFX_STATE(inst)->normalization : false;
-	if (!doNormalize)
+	x[0] = x[1] = y[0] = y[1] = 0.0;
+	double peak = 0.0;
+	bool completed = true;
+	for (int32_t pos = 0; pos < len; pos += SMPFX_BLOCK_LEN)
 	{
-		ft2_unfix_sample(s);
-		if (s->flags & SAMPLE_16BIT)
+		const int32_t count = (len - pos < SMPFX_BLOCK_LEN) ? len - pos : SMPFX_BLOCK_LEN;
+		loadBlock(src + (size_t)pos * bytesPerSample, count, sample16Bit, x + 2);
+		biquadBlock(p, x, y, v, count);
+
+		double *out = y + 2;
+		if (normalize)
 		{
-			int16_t *ptr16 = (int16_t *)s->dataPtr + x1;
-			for (int32_t i = 0; i < len; i++)
+			for (int32_t i = 0; i < count; i++)
 			{
-				double out = f->a1 * ptr16[i] + f->a2 * f->inTmp[0] + f->a3 * f->inTmp[1] - f->b1 * f->outTmp[0] - f->b2 * f->outTmp[1];
-				f->inTmp[1] = f->inTmp[0]; f->inTmp[0] = ptr16[i];
-				f->outTmp[1] = f->outTmp[0]; f->outTmp[0] = out;
-				ptr16[i] = (out < INT16_MIN) ? INT16_MIN : (out > INT16_MAX) ? INT16_MAX : (int16_t)out;
+				if (fabs(out[i]) > peak) peak = fabs(out[i]);
+				dSmp[pos + i] = out[i];
 			}
 		}
 		else
 		{
-			int8_t *ptr8 = (int8_t *)s->dataPtr + x1;
-			for (int32_t i = 0; i < len; i++)
+			if (p->op == SMPFX_OP_MIX_FILTERED)
 			{
-				double out = f->a1 * ptr8[i] + f->a2 * f->inTmp[0] + f->a3 * f->inTmp[1] - f->b1 * f->outTmp[0] - f->b2 * f->outTmp[1];
-				f->inTmp[1] = f->inTmp[0]; f->inTmp[0] = ptr8[i];
-				f->outTmp[1] = f->outTmp[0]; f->outTmp[0] = out;
-				ptr8[i] = (out < INT8_MIN) ? INT8_MIN : (out > INT8_MAX) ? INT8_MAX : (int8_t)out;
+				/* Into v: out[] is the next block's filter history */
+				for (int32_t i = 0; i < count; i++) v[i] = x[i + 2] + (out[i] * p->mix);
+				storeBlock(v, count, sample16Bit, dst + (size_t)pos * bytesPerSample);
+			}
+			else
+			{
+				storeBlock(out, count, sample16Bit, dst + (size_t)pos * bytesPerSample);
 			}
 		}
-		ft2_fix_sample(s);
-	}
-	else
-	{
-		double *dSmp = (double *)malloc(len * sizeof(double));
-		if (!dSmp) return false;
 
-		ft2_unfix_sample(s);
+		/* Last two samples in and out lead into the next block */
+		x[0] = x[count]; x[1] = x[count + 1];
+		y[0] = y[count]; y[1] = y[count + 1];
 
-		if (s->flags & SAMPLE_16BIT)
-			for (int32_t i = 0; i < len; i++) dSmp[i] = (double)((int16_t *)s->dataPtr + x1)[i];
-		else
-			for (int32_t i = 0; i < len; i++) dSmp[i] = (double)((int8_t *)s->dataPtr + x1)[i];
-
-		double peak = 0.0;
-		for (int32_t i = 0; i < len; i++)
+		if (job && !ft2_sample_job_report(job, (uint64_t)pos + count, (uint64_t)len))
 		{
-			double out = f->a1 * dSmp[i] + f->a2 * f->inTmp[0] + f->a3 * f->inTmp[1] - f->b1 * f->outTmp[0] - f->b2 * f->outTmp[1];
-			f->inTmp[1] = f->inTmp[0]; f->inTmp[0] = dSmp[i];
-			f->outTmp[1] = f->outTmp[0]; f->outTmp[0] = out;
-			dSmp[i] = out;
-			if (fabs(out) > peak) peak = fabs(out);
+			completed = false;
+			break;
 		}
+	}
 
+	if (completed && normalize)
+	{
 		if (peak > 0.0)
 		{
-			double scale = (s->flags & SAMPLE_16BIT) ? INT16_MAX / peak : INT8_MAX / peak;
-			if (s->flags & SAMPLE_16BIT)
-				for (int32_t i = 0; i < len; i++) ((int16_t *)s->dataPtr + x1)[i] = (int16_t)(dSmp[i] * scale);
+			/* Never above full scale, so no clamping */
+			if (sample16Bit)
+			{
+				const double scale = INT16_MAX / peak;
+				int16_t *dst16 = (int16_t *)dst;
+				for (int32_t i = 0; i < len; i++) dst16[i] = (int16_t)(dSmp[i] * scale);
+			}
 			else
-				for (int32_t i = 0; i < len; i++) ((int8_t *)s->dataPtr + x1)[i] = (int8_t)(dSmp[i] * scale);
+			{
+				const double scale = INT8_MAX / peak;
+				for (int32_t i = 0; i < len; i++) dst[i] = (int8_t)(dSmp[i] * scale);
+			}
+		}
+		else
+		{
+			/* Silence in, left as it was */
+			memcpy(dst, src, (size_t)len * bytesPerSample);
 		}
+	}
+
+	free(x);
+	free(y);
+	free(v);
+	free(dSmp);
+	return completed;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                          EFFECT JOBS                                      */
+/* ------------------------------------------------------------------------- */
+
+typedef struct smpfx_job_t
+{
+	ft2_sample_job_source_t src;
+	smpfx_params_t params;
+	int32_t x1, x2;
+	int8_t *result;
+} smpfx_job_t;
+
+static void freeSmpFxJob(smpfx_job_t *fj)
+{
+	if (!fj) return;
+	ft2_sample_job_free_source(&fj->src);
+	free(fj->result);
+	free(fj);
+}
+
+static bool smpFxJobRun(ft2_sample_job_t *job, void *userData)
+{
+	smpfx_job_t *fj = (smpfx_job_t *)userData;
+	const bool sample16Bit = (fj->src.flags & SAMPLE_16BIT) != 0;
+	const int8_t *src = fj->src.data + (size_t)fj->x1 * (sample16Bit ? 2 : 1);
+	return smpfx_render(&fj->params, src, fj->result, fj->x2 - fj->x1, sample16Bit, job);
+}
+
+/* Writes the result over the range it was made from */
+static void commitSmpFx(ft2_instance_t *inst, ft2_sample_t *s, smpfx_job_t *fj)
+{
+	const int32_t bytesPerSample = (s->flags & SAMPLE_16BIT) ? 2 : 1;
+
+	fillSampleUndoRange(inst, fj->x1, fj->x2, KEEP_SAMPLE_MARK);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
+
+	memcpy(s->dataPtr + (size_t)fj->x1 * bytesPerSample, fj->result, (size_t)(fj->x2 - fj->x1) * bytesPerSample);
+	ft2_fix_sample(s);
+	inst->uiState.updateSampleEditor = true;
+}
+
+static void smpFxJobDone(ft2_instance_t *inst, void *userData, bool completed)
+{
+	smpfx_job_t *fj = (smpfx_job_t *)userData;
+
+	/* Only if the sample is still the one that was processed */
+	ft2_sample_t *s = (completed && inst && inst->ui) ? getSmpFxCurSample(inst) : NULL;
+	if (ft2_sample_job_source_is_current(&fj->src, s))
+		commitSmpFx(inst, s, fj);
+
+	freeSmpFxJob(fj);
+}
+
+/* Runs p over [x1, x2) of s: as a job with a progress box when the editor
+ * is open, or right away when it isn't */
+static void startSmpFx(ft2_instance_t *inst, ft2_sample_t *s, const smpfx_params_t *p, int32_t x1, int32_t x2, const char *title)
+{
+	if (x1 < 0) x1 = 0;
+	if (x2 > s->length) x2 = s->length;
+	if (x2 <= x1) return;
+
+	smpfx_job_t *fj = (smpfx_job_t *)calloc(1, sizeof(smpfx_job_t));
+	if (!fj) return;
+
+	fj->params = *p;
+	fj->x1 = x1;
+	fj->x2 = x2;
+	fj->result = (int8_t *)malloc((size_t)(x2 - x1) * ((s->flags & SAMPLE_16BIT) ? 2 : 1));
+	if (!fj->result || !ft2_sample_job_copy_source(&fj->src, s))
+	{
+		freeSmpFxJob(fj);
+		return;
+	}
 
-		free(dSmp);
-		ft2_fix_sample(s);
+	if (!inst->ui)
+	{
+		if (smpFxJobRun(NULL, fj)) commitSmpFx(inst, s, fj);
+		freeSmpFxJob(fj);
+		return;
 	}
-	return true;
+
+	if (!ft2_sample_job_start(&FT2_UI(inst)->sampleJob, inst, title, smpFxJobRun, smpFxJobDone, fj))
+		freeSmpFxJob(fj);
+}
+
+/* Plain filter over the selection (or the whole sample) */
+static void startFilter(ft2_instance_t *inst, ft2_sample_t *s, smpfx_params_t *p)
+{
+	int32_t x1, x2;
+	getSmpFxRange(inst, s, &x1, &x2);
+
+	p->op = SMPFX_OP_FILTER;
+	p->normalize = getSfxNormalization(inst);
+	startSmpFx(inst, s, p, x1, x2, "Filtering...");
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           FILTERS                                         */
+/* ------------------------------------------------------------------------- */
+
+void pbSfxResoUp(ft2_instance_t *inst) {
+	if (!inst || !inst->ui) return;
+	smpfx_state_t *fx = SMPFX_STATE(inst);
+	if (fx->filterResonance < RESONANCE_RANGE) { fx->filterResonance++; inst->uiState.updateSampleEditor = true; }
+}
+void pbSfxResoDown(ft2_instance_t *inst) {
+	if (!inst || !inst->ui) return;
+	smpfx_state_t *fx = SMPFX_STATE(inst);
+	if (fx->filterResonance > 0) { fx->filterResonance--; inst->uiState.updateSampleEditor = true; }
 }
 
 static void applyLowPassFilter(ft2_instance_t *inst, int32_t cutoff)
@@ -433,14 +649,9 @@ static void applyLowPassFilter(ft2_instance_t *inst, int32_t cutoff)
 	fx->lastFilterType = FILTER_LOWPASS;
 	fx->lastLpCutoff = cutoff;
 
-	int32_t x1, x2;
-	getSmpFxRange(inst, s, &x1, &x2);
-
-	resoFilter_t f;
-	setupResoLpFilter(s, &f, cutoff, fx->filterResonance, false);
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	applyResoFilter(inst, s, &f, x1, x2);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	smpfx_setup_lowpass(&p, getRelativeCutoff(s, cutoff), fx->filterResonance);
+	startFilter(inst, s, &p);
 }
 
 static void applyHighPassFilter(ft2_instance_t *inst, int32_t cutoff)
@@ -452,14 +663,9 @@ static void applyHighPassFilter(ft2_instance_t *inst, int32_t cutoff)
 	fx->lastFilterType = FILTER_HIGHPASS;
 	fx->lastHpCutoff = cutoff;
 
-	int32_t x1, x2;
-	getSmpFxRange(inst, s, &x1, &x2);
-
-	resoFilter_t f;
-	setupResoHpFilter(s, &f, cutoff, fx->filterResonance, false);
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	applyResoFilter(inst, s, &f, x1, x2);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	smpfx_setup_highpass(&p, getRelativeCutoff(s, cutoff), fx->filterResonance);
+	startFilter(inst, s, &p);
 }
 
 void pbSfxLowPass(ft2_instance_t *inst) { ft2_filter_panel_show(inst, FILTER_TYPE_LOWPASS); }
@@ -474,20 +680,26 @@ void smpfx_apply_filter(ft2_instance_t *inst, int filterType, int32_t cutoff)
 /*                             EQ                                            */
 /* ------------------------------------------------------------------------- */
 
+/* Mixes the filtered signal back into the selection (or the whole sample) */
+static void startMixFiltered(ft2_instance_t *inst, ft2_sample_t *s, smpfx_params_t *p, double mix)
+{
+	int32_t x1, x2;
+	getSmpFxRange(inst, s, &x1, &x2);
+
+	p->op = SMPFX_OP_MIX_FILTERED;
+	p->mix = mix;
+	startSmpFx(inst, s, p, x1, x2, "Filtering...");
+}
+
 /* Removes sub-bass via HP at normalized 0.001 */
 void pbSfxSubBass(ft2_instance_t *inst)
 {
 	ft2_sample_t *s = getSmpFxCurSample(inst);
 	if (!s || !s->dataPtr) return;
 
-	int32_t x1, x2;
-	getSmpFxRange(inst, s, &x1, &x2);
-
-	resoFilter_t f;
-	setupResoHpFilter(s, &f, 0.001, 0, true);
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	applyResoFilter(inst, s, &f, x1, x2);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	smpfx_setup_highpass(&p, 0.001, 0);
+	startFilter(inst, s, &p);
 }
 
 /* Adds bass by mixing in LP-filtered signal at 25% */
@@ -496,55 +708,9 @@ void pbSfxAddBass(ft2_instance_t *inst)
 	ft2_sample_t *s = getSmpFxCurSample(inst);
 	if (!s || !s->dataPtr) return;
 
-	int32_t x1, x2;
-	getSmpFxRange(inst, s, &x1, &x2);
-	const int32_t len = x2 - x1;
-	if (len <= 0) return;
-
-	double *dSmp = (double *)malloc(len * sizeof(double));
-	if (!dSmp) return;
-
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
-
-	if (s->flags & SAMPLE_16BIT)
-		for (int32_t i = 0; i < len; i++) dSmp[i] = ((int16_t *)s->dataPtr + x1)[i];
-	else
-		for (int32_t i = 0; i < len; i++) dSmp[i] = ((int8_t *)s->dataPtr + x1)[i];
-
-	resoFilter_t f;
-	setupResoLpFilter(s, &f, 0.015, 0, true);
-	for (int32_t i = 0; i < len; i++)
-	{
-		double out = f.a1 * dSmp[i] + f.a2 * f.inTmp[0] + f.a3 * f.inTmp[1] - f.b1 * f.outTmp[0] - f.b2 * f.outTmp[1];
-		f.inTmp[1] = f.inTmp[0]; f.inTmp[0] = dSmp[i];
-		f.outTmp[1] = f.outTmp[0]; f.outTmp[0] = out;
-		dSmp[i] = out;
-	}
-
-	if (s->flags & SAMPLE_16BIT)
-	{
-		int16_t *ptr16 = (int16_t *)s->dataPtr + x1;
-		for (int32_t i = 0; i < len; i++)
-		{
-			double out = ptr16[i] + dSmp[i] * 0.25;
-			ptr16[i] = (out < INT16_MIN) ? INT16_MIN : (out > INT16_MAX) ? INT16_MAX : (int16_t)out;
-		}
-	}
-	else
-	{
-		int8_t *ptr8 = (int8_t *)s->dataPtr + x1;
-		for (int32_t i = 0; i < len; i++)
-		{
-			double out = ptr8[i] + dSmp[i] * 0.25;
-			ptr8[i] = (out < INT8_MIN) ? INT8_MIN : (out > INT8_MAX) ? INT8_MAX : (int8_t)out;
-		}
-	}
-
-	free(dSmp);
-	ft2_fix_sample(s);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	smpfx_setup_lowpass(&p, 0.015, 0);
+	startMixFiltered(inst, s, &p, 0.25);
 }
 
 /* Removes treble via LP at normalized 0.33 */
@@ -553,14 +719,9 @@ void pbSfxSubTreble(ft2_instance_t *inst)
 	ft2_sample_t *s = getSmpFxCurSample(inst);
 	if (!s || !s->dataPtr) return;
 
-	int32_t x1, x2;
-	getSmpFxRange(inst, s, &x1, &x2);
-
-	resoFilter_t f;
-	setupResoLpFilter(s, &f, 0.33, 0, true);
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	applyResoFilter(inst, s, &f, x1, x2);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	smpfx_setup_lowpass(&p, 0.33, 0);
+	startFilter(inst, s, &p);
 }
 
 /* Adds treble by subtracting HP-filtered signal at 25% (shelf boost) */
@@ -569,55 +730,9 @@ void pbSfxAddTreble(ft2_instance_t *inst)
 	ft2_sample_t *s = getSmpFxCurSample(inst);
 	if (!s || !s->dataPtr) return;
 
-	int32_t x1, x2;
-	getSmpFxRange(inst, s, &x1, &x2);
-	const int32_t len = x2 - x1;
-	if (len <= 0) return;
-
-	double *dSmp = (double *)malloc(len * sizeof(double));
-	if (!dSmp) return;
-
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
-
-	if (s->flags & SAMPLE_16BIT)
-		for (int32_t i = 0; i < len; i++) dSmp[i] = ((int16_t *)s->dataPtr + x1)[i];
-	else
-		for (int32_t i = 0; i < len; i++) dSmp[i] = ((int8_t *)s->dataPtr + x1)[i];
-
-	resoFilter_t f;
-	setupResoHpFilter(s, &f, 0.27, 0, true);
-	for (int32_t i = 0; i < len; i++)
-	{
-		double out = f.a1 * dSmp[i] + f.a2 * f.inTmp[0] + f.a3 * f.inTmp[1] - f.b1 * f.outTmp[0] - f.b2 * f.outTmp[1];
-		f.inTmp[1] = f.inTmp[0]; f.inTmp[0] = dSmp[i];
-		f.outTmp[1] = f.outTmp[0]; f.outTmp[0] = out;
-		dSmp[i] = out;
-	}
-
-	if (s->flags & SAMPLE_16BIT)
-	{
-		int16_t *ptr16 = (int16_t *)s->dataPtr + x1;
-		for (int32_t i = 0; i < len; i++)
-		{
-			double out = ptr16[i] - dSmp[i] * 0.25;
-			ptr16[i] = (out < INT16_MIN) ? INT16_MIN : (out > INT16_MAX) ? INT16_MAX : (int16_t)out;
-		}
-	}
-	else
-	{
-		int8_t *ptr8 = (int8_t *)s->dataPtr + x1;
-		for (int32_t i = 0; i < len; i++)
-		{
-			double out = ptr8[i] - dSmp[i] * 0.25;
-			ptr8[i] = (out < INT8_MIN) ? INT8_MIN : (out > INT8_MAX) ? INT8_MAX : (int8_t)out;
-		}
-	}
-
-	free(dSmp);
-	ft2_fix_sample(s);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	smpfx_setup_highpass(&p, 0.27, 0);
+	startMixFiltered(inst, s, &p, -0.25);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -631,68 +746,30 @@ void pbSfxSetAmp(ft2_instance_t *inst)
 
 	int32_t x1, x2;
 	getSmpFxRange(inst, s, &x1, &x2);
-	const int32_t len = x2 - x1;
-	if (len <= 0) return;
 
-	fillSampleUndo(inst, KEEP_SAMPLE_MARK);
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
-
-	const int32_t mul = (int32_t)round((1 << 22UL) * (SMPFX_STATE(inst)->lastAmp / 100.0));
-
-	if (s->flags & SAMPLE_16BIT)
-	{
-		int16_t *ptr16 = (int16_t *)s->dataPtr + x1;
-		for (int32_t i = 0; i < len; i++)
-		{
-			int32_t sample = ((int64_t)ptr16[i] * mul) >> 22;
-			ptr16[i] = (sample < INT16_MIN) ? INT16_MIN : (sample > INT16_MAX) ? INT16_MAX : (int16_t)sample;
-		}
-	}
-	else
-	{
-		int8_t *ptr8 = (int8_t *)s->dataPtr + x1;
-		for (int32_t i = 0; i < len; i++)
-		{
-			int32_t sample = ((int64_t)ptr8[i] * mul) >> 22;
-			ptr8[i] = (sample < INT8_MIN) ? INT8_MIN : (sample > INT8_MAX) ? INT8_MAX : (int8_t)sample;
-		}
-	}
-
-	ft2_fix_sample(s);
-	inst->uiState.updateSampleEditor = true;
+	smpfx_params_t p = { 0 };
+	p.op = SMPFX_OP_AMP;
+	p.ampMul = (int32_t)round((1 << 22UL) * (SMPFX_STATE(inst)->lastAmp / 100.0));
+	startSmpFx(inst, s, &p, x1, x2, "Amplifying...");
 }
 
-void pbSfxUndo(ft2_instance_t *inst)
+static void undoStep(ft2_instance_t *inst, bool redo)
 {
-	if (!inst || !inst->ui) return;
-	smp_undo_t *undo = UNDO_STATE(inst);
-	if (!undo->filled || undo->undoInstr != inst->editor.curInstr || undo->undoSmp != inst->editor.curSmp)
-		return;
+	if (!inst || !inst->ui || inst->editor.curInstr == 0) return;
 
-	ft2_sample_t *s = getSmpFxCurSample(inst);
-	if (!s) return;
-
-	ft2_stop_sample_voices(inst, s);
-	freeSmpData(inst, inst->editor.curInstr, inst->editor.curSmp);
-
-	s->flags = undo->flags;
-	s->length = undo->length;
-	s->loopStart = undo->loopStart;
-	s->loopLength = undo->loopLength;
+	bool keepSampleMark = false;
+	if (!ft2_undo_step(UNDO_STATE(inst), inst, inst->editor.curInstr, inst->editor.curSmp, redo, &keepSampleMark))
+		return;
 
-	if (allocateSmpData(inst, inst->editor.curInstr, inst->editor.curSmp, s->length, !!(s->flags & SAMPLE_16BIT)))
-	{
-		memcpy(s->dataPtr, (s->flags & SAMPLE_16BIT) ? (void *)undo->smpData16 : (void *)undo->smpData8,
-		       s->length * ((s->flags & SAMPLE_16BIT) ? sizeof(int16_t) : sizeof(int8_t)));
-		ft2_fix_sample(s);
-	}
+	if (!keepSampleMark)
+		ft2_sample_ed_clear_selection(inst);
 
-	undo->keepSampleMark = false;
-	undo->filled = false;
 	inst->uiState.updateSampleEditor = true;
 }
 
+void pbSfxUndo(ft2_instance_t *inst) { undoStep(inst, false); }
+void pbSfxRedo(ft2_instance_t *inst) { undoStep(inst, true); }
+
 /* ------------------------------------------------------------------------- */
 /*                        SCREEN VISIBILITY                                  */
 /* ------------------------------------------------------------------------- */
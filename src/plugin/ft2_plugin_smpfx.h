@@ -11,6 +11,7 @@
 struct ft2_instance_t;
 struct ft2_video_t;
 struct ft2_bmp_t;
+struct ft2_sample_job_t;
 
 /* Filter types */
 #define FILTER_LOWPASS  0
@@ -24,10 +25,43 @@ typedef struct smpfx_state_t {
 	int32_t smpCycles, lastWaveLength, lastAmp;
 } smpfx_state_t;
 
-/* Undo */
+/* What a filter, EQ or amplify button does to a range of samples. Runs
+ * as a sample job, in blocks that keep the per-sample work independent
+ * where it can be. Amplify matches the old one-sample-at-a-time loop
+ * exactly; the filters may differ by 1 LSB on the odd sample (checked by
+ * the bench's "smpfx" suite). */
+enum
+{
+	SMPFX_OP_FILTER = 0,   /* Biquad, optionally normalized to full scale */
+	SMPFX_OP_MIX_FILTERED, /* Input plus mix times the biquad's output */
+	SMPFX_OP_AMP           /* Scale by ampMul, 10.22 fixed point */
+};
+
+typedef struct smpfx_params_t {
+	uint8_t op;
+	bool normalize;
+	double a1, a2, a3, b1, b2;
+	double mix;
+	int32_t ampMul;
+} smpfx_params_t;
+
+/* cutoff is a fraction of the sample rate */
+void smpfx_setup_lowpass(smpfx_params_t *p, double cutoff, uint32_t resonance);
+void smpfx_setup_highpass(smpfx_params_t *p, double cutoff, uint32_t resonance);
+
+/* len samples from src (unfixed) into dst. Reports progress to job if given;
+ * returns false if cancelled or out of memory. */
+bool smpfx_render(const smpfx_params_t *p, const int8_t *src, int8_t *dst, int32_t len, bool sample16Bit,
+	struct ft2_sample_job_t *job);
+
+/* Undo (multi-level, see ft2_plugin_sample_undo.h) */
 void clearSampleUndo(struct ft2_instance_t *inst);
+void forgetSampleUndo(struct ft2_instance_t *inst, int16_t instrNum, int16_t smpNum);
+void forgetInstrUndo(struct ft2_instance_t *inst, int16_t instrNum);
 void fillSampleUndo(struct ft2_instance_t *inst, bool keepSampleMark);
+void fillSampleUndoRange(struct ft2_instance_t *inst, int32_t x1, int32_t x2, bool keepSampleMark);
 void pbSfxUndo(struct ft2_instance_t *inst);
+void pbSfxRedo(struct ft2_instance_t *inst);
 
 /* State accessors */
 void cbSfxNormalization(struct ft2_instance_t *inst);
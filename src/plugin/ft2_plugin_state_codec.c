@@ -0,0 +1,780 @@
+/**
+ * @file ft2_plugin_state_codec.c
+ * @brief Lossless packing of the XM file stored in the plugin state.
+ *
+ * The packer parses the XM as it streams past: the song header gives the
+ * pattern and instrument counts, pattern headers the packed data length,
+ * instrument and sample headers the length and bit depth of each sample's
+ * data. Sample data (XM delta PCM) is turned back into PCM to pick a
+ * predictor, and the decoder turns it back into the same delta bytes.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_plugin_state_codec.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define STATE_MAGIC "XMZ1"
+
+enum { BLOCK_END = 0, BLOCK_RAW, BLOCK_SMP8, BLOCK_SMP16 };
+
+#define VERBATIM   0xFF
+#define MAX_ORDER  3
+#define MAX_RICE_K 19
+#define ESC_Q      24 /* Quotients this large are escaped and the value stored in full... */
+#define ESC_BITS   20 /* ...which fits any order-3 residual of 16-bit data */
+
+#define RAW_MAX    (64 * 1024)
+#define OUT_MAX    (64 * 1024)
+#define BLOCK_MAX_BYTES (FT2_STATE_BLOCK_FRAMES * 2 + 8)
+
+/* XM layout as ft2_save_module_stream() writes it */
+#define XM_HEADER_FIXED  64 /* Up to and including the header size field */
+#define XM_PATT_HDR_SIZE 9
+#define XM_INSTR_HDR_MIN 33 /* Up to and including the sample header size */
+#define XM_INSTR_HDR_MAX 263
+#define XM_SMP_HDR_SIZE  40
+#define HDR_MAX (XM_INSTR_HDR_MAX + (16 * XM_SMP_HDR_SIZE))
+
+enum {
+	P_HEADER,     /* Song header */
+	P_PATT_HDR,
+	P_INSTR_SIZE, /* First field of an instrument header */
+	P_INSTR_HDR,
+	P_SMP_HDRS,
+	P_SMP_DATA,
+	P_PASS        /* Past the instruments, or lost: everything is stored as is */
+};
+
+struct ft2_state_packer_t {
+	ft2_save_write_t write;
+	void *userData;
+	uint32_t packedSize, checksum;
+	bool failed;
+
+	/* Where we are in the XM file */
+	int32_t phase;
+	uint8_t hdr[HDR_MAX];
+	uint32_t hdrHave, hdrNeed;
+	uint32_t passLeft; /* Bytes to store as is before carrying on */
+	int32_t pattsLeft, instrLeft;
+	uint32_t instrSize;
+	int32_t numSmps, smpIndex;
+	uint32_t smpBytes[16];
+	bool smp16[16];
+
+	/* The sample being coded */
+	bool inSample, sample16Bit;
+	uint32_t framesLeft;
+	uint32_t blockHave, blockNeed;
+	int32_t hist[3]; /* Last three PCM values, oldest first */
+	uint8_t blockIn[FT2_STATE_BLOCK_FRAMES * 2];
+	int32_t pcm[FT2_STATE_BLOCK_FRAMES + 3];
+	uint32_t resid[FT2_STATE_BLOCK_FRAMES];
+
+	uint8_t raw[RAW_MAX];
+	uint32_t rawLen;
+	uint8_t out[OUT_MAX + BLOCK_MAX_BYTES];
+	uint32_t outLen;
+};
+
+static inline uint32_t rd32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline uint16_t rd16u(const uint8_t *p)
+{
+	uint16_t v;
+	memcpy(&v, p, 2);
+	return v;
+}
+
+/* Adler-32, with the sums reduced every 5552 bytes as in zlib */
+static uint32_t adler32(uint32_t adler, const uint8_t *p, uint32_t n)
+{
+	uint32_t a = adler & 0xFFFF, b = adler >> 16;
+	while (n > 0) {
+		const uint32_t len = (n < 5552) ? n : 5552;
+		for (uint32_t i = 0; i < len; i++) {
+			a += p[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		p += len;
+		n -= len;
+	}
+	return (b << 16) | a;
+}
+
+static inline uint32_t ctz64(uint64_t x)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward64(&i, x);
+	return (uint32_t)i;
+#else
+	return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+static inline int32_t predict(int32_t order, const int32_t *x)
+{
+	/* x[-1] is the previous value */
+	switch (order) {
+		default:
+		case 0: return 0;
+		case 1: return x[-1];
+		case 2: return (2 * x[-1]) - x[-2];
+		case 3: return (3 * x[-1]) - (3 * x[-2]) + x[-3];
+	}
+}
+
+/* ---------- Output ---------- */
+
+static void flushOut(ft2_state_packer_t *pk)
+{
+	if (pk->outLen > 0 && !pk->failed) {
+		if (pk->write(pk->userData, pk->out, pk->outLen))
+			pk->packedSize += pk->outLen;
+		else
+			pk->failed = true;
+	}
+	pk->outLen = 0;
+}
+
+/* Room for n contiguous bytes (n <= BLOCK_MAX_BYTES) */
+static uint8_t *reserveOut(ft2_state_packer_t *pk, uint32_t n)
+{
+	if (pk->outLen + n > OUT_MAX)
+		flushOut(pk);
+	return &pk->out[pk->outLen];
+}
+
+static void putOut(ft2_state_packer_t *pk, const void *data, uint32_t n)
+{
+	const uint8_t *src = (const uint8_t *)data;
+	while (n > 0) {
+		if (pk->outLen == OUT_MAX)
+			flushOut(pk);
+		uint32_t take = OUT_MAX - pk->outLen;
+		if (take > n) take = n;
+		memcpy(&pk->out[pk->outLen], src, take);
+		pk->outLen += take;
+		src += take;
+		n -= take;
+	}
+}
+
+static void putBlockHeader(ft2_state_packer_t *pk, uint8_t type, uint32_t length)
+{
+	uint8_t *p = reserveOut(pk, 5);
+	p[0] = type;
+	memcpy(&p[1], &length, 4);
+	pk->outLen += 5;
+}
+
+static void flushRaw(ft2_state_packer_t *pk)
+{
+	if (pk->rawLen == 0)
+		return;
+
+	putBlockHeader(pk, BLOCK_RAW, pk->rawLen);
+	putOut(pk, pk->raw, pk->rawLen);
+	pk->rawLen = 0;
+}
+
+static void rawBytes(ft2_state_packer_t *pk, const uint8_t *data, uint32_t n)
+{
+	while (n > 0) {
+		if (pk->rawLen == RAW_MAX)
+			flushRaw(pk);
+		uint32_t take = RAW_MAX - pk->rawLen;
+		if (take > n) take = n;
+		memcpy(&pk->raw[pk->rawLen], data, take);
+		pk->rawLen += take;
+		data += take;
+		n -= take;
+	}
+}
+
+/* ---------- Sample blocks ---------- */
+
+typedef struct bitWriter_t {
+	uint8_t *p;
+	uint64_t acc;
+	uint32_t n;
+} bitWriter_t;
+
+/* numBits <= 32 */
+static inline void putBits(bitWriter_t *bw, uint32_t v, uint32_t numBits)
+{
+	if (bw->n >= 32) {
+		const uint32_t lo = (uint32_t)bw->acc;
+		memcpy(bw->p, &lo, 4);
+		bw->p += 4;
+		bw->acc >>= 32;
+		bw->n -= 32;
+	}
+	bw->acc |= (uint64_t)v << bw->n;
+	bw->n += numBits;
+}
+
+static uint32_t riceBits(const uint32_t *u, int32_t n, uint32_t k)
+{
+	/* Quotients plus what escapes cost on top, then the fixed part */
+	uint32_t bits = 0;
+	for (int32_t i = 0; i < n; i++) {
+		const uint32_t q = u[i] >> k;
+		bits += (q < ESC_Q) ? q : ESC_Q + ESC_BITS - k;
+	}
+	return bits + ((uint32_t)n * (1 + k));
+}
+
+static void encodeBlock(ft2_state_packer_t *pk)
+{
+	const int32_t n = (int32_t)(pk->blockNeed >> (pk->sample16Bit ? 1 : 0));
+	int32_t *x = &pk->pcm[3];
+
+	/* Back to PCM, after the previous block's last three values */
+	pk->pcm[0] = pk->hist[0];
+	pk->pcm[1] = pk->hist[1];
+	pk->pcm[2] = pk->hist[2];
+	int32_t prev = pk->hist[2];
+	if (pk->sample16Bit) {
+		for (int32_t i = 0; i < n; i++) {
+			prev = (int16_t)(prev + (int16_t)rd16u(&pk->blockIn[i * 2]));
+			x[i] = prev;
+		}
+	} else {
+		for (int32_t i = 0; i < n; i++) {
+			prev = (int8_t)(prev + (int8_t)pk->blockIn[i]);
+			x[i] = prev;
+		}
+	}
+
+	/* The predictor with the smallest residuals */
+	uint32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0; /* At most 4096 * 2^18 */
+	for (int32_t i = 0; i < n; i++) {
+		const int32_t e0 = x[i];
+		const int32_t e1 = e0 - x[i - 1];
+		const int32_t e2 = e1 - (x[i - 1] - x[i - 2]);
+		const int32_t e3 = e2 - ((x[i - 1] - x[i - 2]) - (x[i - 2] - x[i - 3]));
+		sum0 += (uint32_t)((e0 < 0) ? -e0 : e0);
+		sum1 += (uint32_t)((e1 < 0) ? -e1 : e1);
+		sum2 += (uint32_t)((e2 < 0) ? -e2 : e2);
+		sum3 += (uint32_t)((e3 < 0) ? -e3 : e3);
+	}
+	const uint32_t sum[MAX_ORDER + 1] = { sum0, sum1, sum2, sum3 };
+
+	int32_t order = 0;
+	for (int32_t o = 1; o <= MAX_ORDER; o++) {
+		if (sum[o] < sum[order])
+			order = o;
+	}
+
+	uint32_t *u = pk->resid;
+	switch (order) {
+		case 0: for (int32_t i = 0; i < n; i++) u[i] = (uint32_t)x[i]; break;
+		case 1: for (int32_t i = 0; i < n; i++) u[i] = (uint32_t)(x[i] - predict(1, &x[i])); break;
+		case 2: for (int32_t i = 0; i < n; i++) u[i] = (uint32_t)(x[i] - predict(2, &x[i])); break;
+		default: for (int32_t i = 0; i < n; i++) u[i] = (uint32_t)(x[i] - predict(3, &x[i])); break;
+	}
+	for (int32_t i = 0; i < n; i++)
+		u[i] = (u[i] << 1) ^ (uint32_t)((int32_t)u[i] >> 31); /* Zigzag */
+
+	/* Rice parameter near log2 of the mean (2 * sum, near enough), the cheapest of three */
+	const uint32_t mean = (uint32_t)(((uint64_t)sum[order] * 2) / (uint32_t)n);
+	uint32_t k0 = 0;
+	while (k0 < MAX_RICE_K && (2u << k0) <= mean)
+		k0++;
+
+	uint32_t bestK = k0;
+	uint32_t bestBits = riceBits(u, n, k0);
+	for (uint32_t k = (k0 > 0) ? k0 - 1 : 0; k <= k0 + 1 && k <= MAX_RICE_K; k++) {
+		if (k == k0)
+			continue;
+		const uint32_t bits = riceBits(u, n, k);
+		if (bits < bestBits) {
+			bestBits = bits;
+			bestK = k;
+		}
+	}
+
+	const uint32_t riceBytes = (uint32_t)((bestBits + 7) / 8);
+	uint8_t *p = reserveOut(pk, BLOCK_MAX_BYTES);
+	if (6 + riceBytes >= 1 + pk->blockNeed) {
+		p[0] = VERBATIM;
+		memcpy(&p[1], pk->blockIn, pk->blockNeed);
+		pk->outLen += 1 + pk->blockNeed;
+	} else {
+		p[0] = (uint8_t)order;
+		p[1] = (uint8_t)bestK;
+		memcpy(&p[2], &riceBytes, 4);
+
+		bitWriter_t bw = { &p[6], 0, 0 };
+		const uint32_t kMask = (1u << bestK) - 1;
+		for (int32_t i = 0; i < n; i++) {
+			const uint32_t q = u[i] >> bestK;
+			if (q < ESC_Q && q + 1 + bestK <= 32) {
+				putBits(&bw, (1u << q) | ((u[i] & kMask) << (q + 1)), q + 1 + bestK);
+			} else if (q < ESC_Q) {
+				putBits(&bw, 1u << q, q + 1);
+				putBits(&bw, u[i] & kMask, bestK);
+			} else {
+				putBits(&bw, 1u << ESC_Q, ESC_Q + 1);
+				putBits(&bw, u[i], ESC_BITS);
+			}
+		}
+		while (bw.n > 0) {
+			*bw.p++ = (uint8_t)bw.acc;
+			bw.acc >>= 8;
+			bw.n = (bw.n > 8) ? bw.n - 8 : 0;
+		}
+
+		pk->outLen += 6 + riceBytes;
+	}
+
+	pk->hist[0] = pk->pcm[n];
+	pk->hist[1] = pk->pcm[n + 1];
+	pk->hist[2] = pk->pcm[n + 2];
+}
+
+static void beginBlock(ft2_state_packer_t *pk)
+{
+	const uint32_t frames = (pk->framesLeft < FT2_STATE_BLOCK_FRAMES) ? pk->framesLeft : FT2_STATE_BLOCK_FRAMES;
+	pk->blockNeed = pk->sample16Bit ? frames * 2 : frames;
+	pk->blockHave = 0;
+}
+
+/* ---------- XM parsing ---------- */
+
+static void nextItem(ft2_state_packer_t *pk)
+{
+	pk->hdrHave = 0;
+	if (pk->pattsLeft > 0) {
+		pk->phase = P_PATT_HDR;
+		pk->hdrNeed = XM_PATT_HDR_SIZE;
+	} else if (pk->instrLeft > 0) {
+		pk->phase = P_INSTR_SIZE;
+		pk->hdrNeed = 4;
+	} else {
+		pk->phase = P_PASS;
+	}
+}
+
+static void nextSample(ft2_state_packer_t *pk)
+{
+	while (pk->smpIndex < pk->numSmps && pk->smpBytes[pk->smpIndex] == 0)
+		pk->smpIndex++;
+
+	if (pk->smpIndex == pk->numSmps) {
+		pk->instrLeft--;
+		nextItem(pk);
+		return;
+	}
+
+	const uint32_t bytes = pk->smpBytes[pk->smpIndex];
+	const bool sample16Bit = pk->smp16[pk->smpIndex];
+	pk->smpIndex++;
+
+	if (sample16Bit && (bytes & 1)) {
+		pk->passLeft = bytes; /* Not whole frames, kept as is */
+		return;
+	}
+
+	flushRaw(pk);
+	pk->sample16Bit = sample16Bit;
+	pk->framesLeft = sample16Bit ? bytes / 2 : bytes;
+	putBlockHeader(pk, sample16Bit ? BLOCK_SMP16 : BLOCK_SMP8, pk->framesLeft);
+
+	pk->hist[0] = pk->hist[1] = pk->hist[2] = 0;
+	pk->inSample = true;
+	beginBlock(pk);
+}
+
+static void headerDone(ft2_state_packer_t *pk)
+{
+	const uint8_t *h = pk->hdr;
+
+	switch (pk->phase) {
+		case P_HEADER:
+			if (pk->hdrNeed == XM_HEADER_FIXED) {
+				const uint32_t size = 60 + rd32(&h[60]);
+				if (memcmp(h, "Extended Module: ", 17) != 0 || size < 60 + 20 || size > HDR_MAX) {
+					pk->phase = P_PASS;
+					return;
+				}
+				pk->hdrNeed = size;
+				if (pk->hdrHave < pk->hdrNeed)
+					return;
+			}
+			pk->pattsLeft = rd16u(&h[70]);
+			pk->instrLeft = rd16u(&h[72]);
+			nextItem(pk);
+			break;
+
+		case P_PATT_HDR:
+			if (rd32(h) != XM_PATT_HDR_SIZE) {
+				pk->phase = P_PASS;
+				return;
+			}
+			pk->pattsLeft--;
+			pk->passLeft = rd16u(&h[7]);
+			nextItem(pk);
+			break;
+
+		case P_INSTR_SIZE:
+			pk->instrSize = rd32(h);
+			if (pk->instrSize < XM_INSTR_HDR_MIN || pk->instrSize > XM_INSTR_HDR_MAX) {
+				pk->phase = P_PASS;
+				return;
+			}
+			pk->phase = P_INSTR_HDR;
+			pk->hdrNeed = pk->instrSize;
+			break;
+
+		case P_INSTR_HDR: {
+			int16_t numSmps;
+			memcpy(&numSmps, &h[27], 2);
+			if (numSmps == 0) {
+				pk->instrLeft--;
+				nextItem(pk);
+				return;
+			}
+			if (numSmps < 0 || numSmps > 16 || rd32(&h[29]) != XM_SMP_HDR_SIZE) {
+				pk->phase = P_PASS;
+				return;
+			}
+			pk->numSmps = numSmps;
+			pk->phase = P_SMP_HDRS;
+			pk->hdrNeed = pk->instrSize + (numSmps * XM_SMP_HDR_SIZE);
+		}
+		break;
+
+		case P_SMP_HDRS:
+			for (int32_t s = 0; s < pk->numSmps; s++) {
+				const uint8_t *sh = &h[pk->instrSize + (s * XM_SMP_HDR_SIZE)];
+				pk->smpBytes[s] = rd32(sh);
+				pk->smp16[s] = (sh[14] & 16) != 0;
+			}
+			pk->smpIndex = 0;
+			pk->inSample = false;
+			pk->phase = P_SMP_DATA;
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool ft2_state_packer_write(void *packer, const uint8_t *data, uint32_t size)
+{
+	ft2_state_packer_t *pk = (ft2_state_packer_t *)packer;
+	pk->checksum = adler32(pk->checksum, data, size);
+
+	while (size > 0 && !pk->failed) {
+		uint32_t take;
+
+		if (pk->passLeft > 0 || pk->phase == P_PASS) {
+			take = (pk->phase == P_PASS || pk->passLeft > size) ? size : pk->passLeft;
+			rawBytes(pk, data, take);
+			if (pk->phase != P_PASS)
+				pk->passLeft -= take;
+		} else if (pk->phase == P_SMP_DATA) {
+			if (!pk->inSample) {
+				nextSample(pk);
+				continue;
+			}
+
+			take = pk->blockNeed - pk->blockHave;
+			if (take > size) take = size;
+			memcpy(&pk->blockIn[pk->blockHave], data, take);
+			pk->blockHave += take;
+
+			if (pk->blockHave == pk->blockNeed) {
+				encodeBlock(pk);
+				pk->framesLeft -= pk->sample16Bit ? pk->blockNeed / 2 : pk->blockNeed;
+				if (pk->framesLeft > 0)
+					beginBlock(pk);
+				else
+					pk->inSample = false;
+			}
+		} else {
+			take = pk->hdrNeed - pk->hdrHave;
+			if (take > size) take = size;
+			memcpy(&pk->hdr[pk->hdrHave], data, take);
+			pk->hdrHave += take;
+			rawBytes(pk, data, take);
+
+			if (pk->hdrHave == pk->hdrNeed)
+				headerDone(pk);
+		}
+
+		data += take;
+		size -= take;
+	}
+
+	return !pk->failed;
+}
+
+ft2_state_packer_t *ft2_state_packer_create(ft2_save_write_t write, void *userData)
+{
+	if (write == NULL)
+		return NULL;
+
+	ft2_state_packer_t *pk = (ft2_state_packer_t *)calloc(1, sizeof(ft2_state_packer_t));
+	if (pk == NULL)
+		return NULL;
+
+	pk->write = write;
+	pk->userData = userData;
+	pk->checksum = 1;
+	pk->phase = P_HEADER;
+	pk->hdrNeed = XM_HEADER_FIXED;
+
+	putOut(pk, STATE_MAGIC, 4);
+	return pk;
+}
+
+void ft2_state_packer_free(ft2_state_packer_t *pk)
+{
+	free(pk);
+}
+
+bool ft2_state_packer_finish(ft2_state_packer_t *pk, uint32_t *outPackedSize)
+{
+	if (pk == NULL)
+		return false;
+
+	/* A sample cut short can't be finished: its length is already out */
+	if (pk->inSample)
+		pk->failed = true;
+
+	flushRaw(pk);
+	uint8_t *p = reserveOut(pk, 5);
+	p[0] = BLOCK_END;
+	memcpy(&p[1], &pk->checksum, 4);
+	pk->outLen += 5;
+	flushOut(pk);
+
+	if (outPackedSize != NULL)
+		*outPackedSize = pk->packedSize;
+	return !pk->failed;
+}
+
+bool ft2_state_pack_module(ft2_instance_t *inst, ft2_save_write_t write, void *userData,
+	uint32_t *outModuleSize, uint32_t *outPackedSize)
+{
+	ft2_state_packer_t *pk = ft2_state_packer_create(write, userData);
+	if (pk == NULL)
+		return false;
+
+	uint32_t moduleSize = 0;
+	bool ok = ft2_save_module_stream(inst, ft2_state_packer_write, pk, &moduleSize);
+	ok = ft2_state_packer_finish(pk, outPackedSize) && ok;
+	ft2_state_packer_free(pk);
+
+	if (outModuleSize != NULL)
+		*outModuleSize = moduleSize;
+	return ok;
+}
+
+/* ---------- Unpacking ---------- */
+
+typedef struct bitReader_t {
+	const uint8_t *p, *end;
+	uint64_t acc;
+	uint32_t n, over;
+} bitReader_t;
+
+/* At least 56 bits in acc. Bits above n are the next bytes of the stream
+ * (or zero), so OR-ing the same bytes in again later changes nothing. */
+static inline void refill(bitReader_t *br)
+{
+	if (br->end - br->p >= 8) {
+		uint64_t v;
+		memcpy(&v, br->p, 8);
+		br->acc |= v << br->n;
+		const uint32_t bytes = (63 - br->n) >> 3;
+		br->p += bytes;
+		br->n += bytes * 8;
+	} else {
+		while (br->n <= 56) {
+			if (br->p < br->end) {
+				br->acc |= (uint64_t)*br->p++ << br->n;
+			} else {
+				br->over++;
+			}
+			br->n += 8;
+		}
+	}
+}
+
+static inline bool decodeRiceOrder(const uint8_t *src, uint32_t srcBytes, uint8_t *dst, int32_t n, uint32_t k,
+	int32_t order, int32_t *x, bool sample16Bit)
+{
+	bitReader_t br = { src, src + srcBytes, 0, 0, 0 };
+	const uint32_t kMask = (1u << k) - 1;
+	const uint64_t escMask = (2ull << ESC_Q) - 1;
+
+	for (int32_t i = 0; i < n; i++) {
+		if (br.n < ESC_Q + 1 + ESC_BITS)
+			refill(&br);
+		if ((br.acc & escMask) == 0)
+			return false;
+
+		const uint32_t q = ctz64(br.acc);
+		br.acc >>= q + 1;
+		br.n -= q + 1;
+
+		uint32_t u;
+		if (q < ESC_Q) {
+			u = (q << k) | ((uint32_t)br.acc & kMask);
+			br.acc >>= k;
+			br.n -= k;
+		} else {
+			u = (uint32_t)br.acc & ((1u << ESC_BITS) - 1);
+			br.acc >>= ESC_BITS;
+			br.n -= ESC_BITS;
+		}
+
+		const int32_t e = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+		const int32_t prev = x[i - 1];
+		int32_t cur = predict(order, &x[i]) + e;
+		if (sample16Bit) {
+			cur = (int16_t)cur; /* Only a damaged stream leaves the range */
+			const int16_t d = (int16_t)(cur - prev);
+			memcpy(&dst[i * 2], &d, 2);
+		} else {
+			cur = (int8_t)cur;
+			dst[i] = (uint8_t)(cur - prev);
+		}
+		x[i] = cur;
+	}
+
+	const uint64_t consumed = ((uint64_t)(br.p - src) + br.over) * 8 - br.n;
+	return consumed <= (uint64_t)srcBytes * 8;
+}
+
+/* One copy of the loop per predictor */
+static bool decodeRice(const uint8_t *src, uint32_t srcBytes, uint8_t *dst, int32_t n, uint32_t k,
+	int32_t order, int32_t *x, bool sample16Bit)
+{
+	switch (order) {
+		case 0: return decodeRiceOrder(src, srcBytes, dst, n, k, 0, x, sample16Bit);
+		case 1: return decodeRiceOrder(src, srcBytes, dst, n, k, 1, x, sample16Bit);
+		case 2: return decodeRiceOrder(src, srcBytes, dst, n, k, 2, x, sample16Bit);
+		default: return decodeRiceOrder(src, srcBytes, dst, n, k, 3, x, sample16Bit);
+	}
+}
+
+bool ft2_state_unpack(const uint8_t *src, uint32_t srcSize, uint8_t *dst, uint32_t dstSize)
+{
+	if (src == NULL || dst == NULL || srcSize < 5 || memcmp(src, STATE_MAGIC, 4) != 0)
+		return false;
+	if ((uint64_t)dstSize > (uint64_t)srcSize * FT2_STATE_MAX_RATIO)
+		return false;
+
+	int32_t *pcm = (int32_t *)malloc((FT2_STATE_BLOCK_FRAMES + 3) * sizeof(int32_t));
+	if (pcm == NULL)
+		return false;
+
+	uint32_t pos = 4, outPos = 0;
+	bool ok = false;
+
+	while (pos < srcSize) {
+		const uint8_t type = src[pos++];
+		if (type == BLOCK_END) {
+			ok = (outPos == dstSize && srcSize - pos >= 4 && rd32(&src[pos]) == adler32(1, dst, dstSize));
+			break;
+		}
+
+		if (srcSize - pos < 4)
+			break;
+		const uint32_t length = rd32(&src[pos]);
+		pos += 4;
+
+		if (type == BLOCK_RAW) {
+			if (length > srcSize - pos || length > dstSize - outPos)
+				break;
+			memcpy(&dst[outPos], &src[pos], length);
+			pos += length;
+			outPos += length;
+			continue;
+		}
+
+		if (type != BLOCK_SMP8 && type != BLOCK_SMP16)
+			break;
+
+		const bool sample16Bit = (type == BLOCK_SMP16);
+		const uint32_t frameBytes = sample16Bit ? 2 : 1;
+		if ((uint64_t)length * frameBytes > dstSize - outPos)
+			break;
+
+		pcm[0] = pcm[1] = pcm[2] = 0;
+		int32_t *x = &pcm[3];
+		uint32_t framesLeft = length;
+		bool blockOk = true;
+
+		while (framesLeft > 0 && blockOk) {
+			const int32_t n = (int32_t)((framesLeft < FT2_STATE_BLOCK_FRAMES) ? framesLeft : FT2_STATE_BLOCK_FRAMES);
+			const uint32_t bytes = (uint32_t)n * frameBytes;
+			uint8_t *out = &dst[outPos];
+
+			if (pos >= srcSize) {
+				blockOk = false;
+				break;
+			}
+
+			const uint8_t mode = src[pos++];
+			if (mode == VERBATIM) {
+				if (bytes > srcSize - pos) {
+					blockOk = false;
+					break;
+				}
+				memcpy(out, &src[pos], bytes);
+				pos += bytes;
+
+				int32_t prev = x[-1];
+				for (int32_t i = 0; i < n; i++) {
+					prev = sample16Bit ? (int16_t)(prev + (int16_t)rd16u(&out[i * 2])) : (int8_t)(prev + (int8_t)out[i]);
+					x[i] = prev;
+				}
+			} else {
+				if (mode > MAX_ORDER || srcSize - pos < 5 || src[pos] > MAX_RICE_K) {
+					blockOk = false;
+					break;
+				}
+				const uint32_t k = src[pos];
+				const uint32_t riceBytes = rd32(&src[pos + 1]);
+				pos += 5;
+				if (riceBytes > srcSize - pos) {
+					blockOk = false;
+					break;
+				}
+				blockOk = decodeRice(&src[pos], riceBytes, out, n, k, mode, x, sample16Bit);
+				pos += riceBytes;
+			}
+
+			/* The last three values lead into the next block */
+			pcm[0] = x[n - 3];
+			pcm[1] = x[n - 2];
+			pcm[2] = x[n - 1];
+			outPos += bytes;
+			framesLeft -= (uint32_t)n;
+		}
+
+		if (!blockOk)
+			break;
+	}
+
+	free(pcm);
+	return ok;
+}
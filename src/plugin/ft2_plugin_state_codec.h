@@ -0,0 +1,60 @@
+/**
+ * @file ft2_plugin_state_codec.h
+ * @brief Lossless packing of the XM file stored in the plugin state.
+ *
+ * The packer is fed the XM file as ft2_save_module_stream() writes it and
+ * follows its layout: headers and patterns are stored as they are, sample
+ * data is coded in blocks of FT2_STATE_BLOCK_FRAMES frames with the best of
+ * four fixed predictors (orders 0-3, as in FLAC) and Rice-coded residuals,
+ * or verbatim when that is smaller. Whatever it can't follow is stored as
+ * is, so unpacking always gives back the exact bytes that went in.
+ *
+ * Packed stream (little-endian): "XMZ1", then blocks, each a type byte:
+ *  - RAW:   u32 length, the bytes.
+ *  - SMP8/SMP16: u32 frames, then per block of up to FT2_STATE_BLOCK_FRAMES:
+ *           u8 predictor order (0-3) + u8 Rice parameter + u32 byte count
+ *           + the bit stream, or u8 VERBATIM + the XM delta bytes.
+ *  - END:   u32 Adler-32 of the XM file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ft2_plugin_diskop.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FT2_STATE_BLOCK_FRAMES 4096
+
+/* Every coded frame takes at least one bit and gives back at most two
+ * bytes, so no valid stream unpacks to more than this many times its
+ * size. Check a stored XM size against it before allocating for it. */
+#define FT2_STATE_MAX_RATIO 16
+
+typedef struct ft2_state_packer_t ft2_state_packer_t;
+
+/* The packed stream goes to write() in pieces of up to 64 KiB */
+ft2_state_packer_t *ft2_state_packer_create(ft2_save_write_t write, void *userData);
+void ft2_state_packer_free(ft2_state_packer_t *pk);
+
+/* An ft2_save_write_t: pass the packer as userData */
+bool ft2_state_packer_write(void *packer, const uint8_t *data, uint32_t size);
+
+/* Ends the stream. Returns false if any write failed. */
+bool ft2_state_packer_finish(ft2_state_packer_t *pk, uint32_t *outPackedSize);
+
+/* Packs the instance's module through ft2_save_module_stream() */
+bool ft2_state_pack_module(ft2_instance_t *inst, ft2_save_write_t write, void *userData,
+	uint32_t *outModuleSize, uint32_t *outPackedSize);
+
+/* Unpacks into dst, which must be exactly the size of the packed XM file.
+ * Returns false on a damaged stream (checked against the stored checksum)
+ * or a dstSize over FT2_STATE_MAX_RATIO times srcSize. */
+bool ft2_state_unpack(const uint8_t *src, uint32_t srcSize, uint8_t *dst, uint32_t dstSize);
+
+#ifdef __cplusplus
+}
+#endif
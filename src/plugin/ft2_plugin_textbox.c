@@ -178,7 +178,7 @@ void ft2_textbox_update_pointers(ft2_instance_t *inst)
 	}
 
 	state->textBoxes[TB_SONG_NAME].textPtr = inst->replayer.song.name;
-	state->textBoxes[TB_DISKOP_FILENAME].textPtr = inst->diskop.filename;
+	state->textBoxes[TB_DISKOP_FILENAME].textPtr = inst->diskop->filename;
 }
 
 /* ------------------------------------------------------------------------- */
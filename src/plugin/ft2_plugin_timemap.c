@@ -132,13 +132,13 @@ void ft2_timemap_build(ft2_instance_t *inst)
 				goto done;
 
 			bool patternDelayProcessed = false;
-			ft2_note_t *patternPtr = rep->pattern[patternNum];
+			ft2_note_t *patternPtr = ft2_pattern_row(inst, patternNum, row);
 
 			if (patternPtr)
 			{
 				for (int32_t ch = 0; ch < song->numChannels; ch++)
 				{
-					ft2_note_t *note = &patternPtr[(row * FT2_MAX_CHANNELS) + ch];
+					ft2_note_t *note = &patternPtr[ch];
 					uint8_t efx = note->efx, efxData = note->efxData;
 
 					switch (efx)
@@ -21,24 +21,15 @@
 #include "ft2_plugin_scopes.h"
 #include "ft2_plugin_pattern_ed.h"
 #include "ft2_plugin_sample_ed.h"
+#include "ft2_plugin_smpfx.h"
 #include "ft2_plugin_dialog.h"
 #include "ft2_plugin_replayer.h"
+#include "ft2_plugin_sample_pool.h"
 #include "../ft2_instance.h"
 
 #define TRIM_STATE(inst) (&FT2_UI(inst)->trimState)
 
-/* Static temp storage - trim operations are modal/atomic */
-static char tmpInstrName[129][23], tmpInstName[128][23];
-static uint8_t instrUsed[128], instrOrder[128], pattUsed[256], pattOrder[256];
-static int16_t oldPattLens[256], tmpPattLens[256];
-static ft2_note_t *oldPatts[256], *tmpPatt[256];
-static ft2_instr_t *tmpInstr[129], *tmpInst[128];
-
-static int64_t calculateXMSize(ft2_instance_t *inst);
-static int64_t calculateTrimSize(ft2_instance_t *inst);
 static const char *formatBytes(ft2_instance_t *inst, uint64_t bytes, bool roundUp);
-static void freeTmpInstruments(void);
-static bool setTmpInstruments(ft2_instance_t *inst);
 
 /* ------------------------------------------------------------------------- */
 /*                        BYTE FORMATTING                                    */
@@ -224,34 +215,10 @@ void cbTrimSmpsTo8Bit(ft2_instance_t *inst) { if (inst && inst->ui) TRIM_STATE(i
 /*                            HELPERS                                        */
 /* ------------------------------------------------------------------------- */
 
-/* Frees temp instrument copies (sample pointers shared with originals) */
-static void freeTmpInstruments(void)
-{
-	for (int32_t i = 0; i <= 128; i++)
-		if (tmpInstr[i]) { free(tmpInstr[i]); tmpInstr[i] = NULL; }
-}
-
-/* Creates shallow copies of all instruments for size calculations */
-static bool setTmpInstruments(ft2_instance_t *inst)
-{
-	freeTmpInstruments();
-	for (int32_t i = 0; i <= 128; i++)
-	{
-		if (inst->replayer.instr[i])
-		{
-			tmpInstr[i] = (ft2_instr_t *)malloc(sizeof(ft2_instr_t));
-			if (!tmpInstr[i]) { freeTmpInstruments(); return false; }
-			*tmpInstr[i] = *inst->replayer.instr[i];
-		}
-	}
-	return true;
-}
-
 /* Returns highest sample slot used by instrument (considering note2SampleLUT) */
-static int16_t getUsedSamples(ft2_instance_t *inst, uint16_t insNum)
+static int16_t getInstrUsedSamples(const ft2_instr_t *ins)
 {
-	if (!inst->replayer.instr[insNum]) return 0;
-	ft2_instr_t *ins = inst->replayer.instr[insNum];
+	if (!ins) return 0;
 
 	int16_t i = 15;
 	while (i >= 0 && !ins->smp[i].dataPtr && !ins->smp[i].name[0]) i--;
@@ -259,232 +226,231 @@ static int16_t getUsedSamples(ft2_instance_t *inst, uint16_t insNum)
 	return i + 1;
 }
 
-static int16_t getUsedTempSamples(uint16_t insNum)
+static int16_t getUsedSamples(ft2_instance_t *inst, uint16_t insNum)
 {
-	if (!tmpInstr[insNum]) return 0;
-	ft2_instr_t *ins = tmpInstr[insNum];
-
-	int16_t i = 15;
-	while (i >= 0 && !ins->smp[i].dataPtr && !ins->smp[i].name[0]) i--;
-	for (int16_t j = 0; j < 96; j++) if (ins->note2SampleLUT[j] > i) i = ins->note2SampleLUT[j];
-	return i + 1;
+	return getInstrUsedSamples(inst->replayer.instr[insNum]);
 }
 
-static bool tmpPatternEmpty(uint16_t pattNum, int32_t numChannels)
+/* Returns highest instrument with samples or a name */
+static int16_t getLastUsedInstr(ft2_instance_t *inst)
 {
-	if (!tmpPatt[pattNum]) return true;
-
-	uint8_t *scanPtr = (uint8_t *)tmpPatt[pattNum];
-	int32_t scanLen = numChannels * sizeof(ft2_note_t);
-	int32_t numRows = tmpPattLens[pattNum];
-
-	for (int32_t i = 0; i < numRows; i++, scanPtr += (FT2_MAX_CHANNELS * sizeof(ft2_note_t)))
-		for (int32_t j = 0; j < scanLen; j++)
-			if (scanPtr[j]) return false;
-	return true;
+	int16_t ai = 128;
+	while (ai > 0 && !inst->replayer.instr[ai] && !inst->replayer.song.instrName[ai][0]) ai--;
+	return ai;
 }
 
 /* ------------------------------------------------------------------------- */
 /*                      XM SIZE CALCULATION                                  */
 /* ------------------------------------------------------------------------- */
 
+/* Both sizes are worked out from the song as it is: one pass over the
+** patterns records what each one uses (trim state scratch), and the
+** instruments and samples are only read. Nothing is copied. */
+
 #define XM_HEADER_SIZE        336
 #define XM_INSTR_HEADER_SIZE  263
 #define XM_SAMPLE_HEADER_SIZE 40
 #define XM_PATT_HEADER_SIZE   9
 
-/* Calculates packed pattern data size (XM RLE-like compression) */
-static uint16_t getPackedPattSize(ft2_note_t *p, int32_t numRows, int32_t antChn)
+/* Fills the per-pattern scratch: packed size (XM RLE-like compression) over
+** the song's channels, channels in use and instruments referenced. Returns
+** the number of patterns up to the last one with data. */
+static int16_t scanPatterns(ft2_instance_t *inst)
 {
-	uint8_t bytes[5];
-	uint16_t totalPackLen = 0;
-	uint8_t *pattPtr = (uint8_t *)p, *writePtr = pattPtr;
+	ft2_trim_state_t *trim = TRIM_STATE(inst);
+	const int32_t numChannels = inst->replayer.song.numChannels;
+	const int32_t pattStride = inst->replayer.patternStride;
+	int16_t ap = 0;
 
-	for (int32_t row = 0; row < numRows; row++)
+	memset(trim->pattInstrs, 0, sizeof(trim->pattInstrs));
+	for (int32_t i = 0; i < 256; i++)
 	{
-		for (int32_t chn = 0; chn < antChn; chn++)
+		const ft2_note_t *p = inst->replayer.pattern[i];
+		const int32_t numRows = p ? inst->replayer.patternNumRows[i] : 0;
+		uint8_t *instrs = trim->pattInstrs[i];
+		uint32_t packLen = 0;
+		int32_t usedChans = 0;
+
+		for (int32_t row = 0; row < numRows; row++, p += pattStride)
 		{
-			bytes[0] = *pattPtr++; bytes[1] = *pattPtr++; bytes[2] = *pattPtr++;
-			bytes[3] = *pattPtr++; bytes[4] = *pattPtr++;
-
-			uint8_t *firstBytePtr = writePtr++;
-			uint8_t packBits = 0;
-			if (bytes[0]) { packBits |= 1; writePtr++; }
-			if (bytes[1]) { packBits |= 2; writePtr++; }
-			if (bytes[2]) { packBits |= 4; writePtr++; }
-			if (bytes[3]) { packBits |= 8; writePtr++; }
-
-			if (packBits == 15) { totalPackLen += 5; writePtr += 5; continue; }
-			if (bytes[4]) writePtr++;
-			totalPackLen += (uint16_t)(writePtr - firstBytePtr);
+			for (int32_t chn = 0; chn < numChannels; chn++)
+			{
+				const ft2_note_t *n = &p[chn];
+				const int32_t numBytes = (n->note != 0) + (n->instr != 0) + (n->vol != 0) + (n->efx != 0);
+				if (numBytes == 0 && !n->efxData) { packLen++; continue; }
+
+				packLen += (numBytes == 4) ? 5 : 1 + numBytes + (n->efxData != 0);
+				if (chn >= usedChans) usedChans = chn + 1;
+				if (n->instr > 0 && n->instr <= 128) instrs[(n->instr - 1) >> 3] |= 1 << ((n->instr - 1) & 7);
+			}
 		}
-		pattPtr += sizeof(ft2_note_t) * (FT2_MAX_CHANNELS - antChn);
+
+		trim->pattPackLen[i] = usedChans ? packLen : 0;
+		trim->pattUsedChans[i] = (uint8_t)usedChans;
+		if (usedChans) ap = (int16_t)(i + 1);
 	}
-	return totalPackLen;
+	return ap;
 }
 
-static int64_t getTempInsAndSmpSize(ft2_instance_t *inst)
+/* Sample data bytes, as the enabled trim options would leave them if 'trimmed' */
+static int64_t getSmpDataSize(const ft2_sample_t *s, const ft2_trim_state_t *trim, bool trimmed)
 {
-	(void)inst;
-	int16_t ai = 128;
-	while (ai > 0 && getUsedTempSamples(ai) == 0 && !tmpInstrName[ai][0]) ai--;
+	if (!s->dataPtr || s->length <= 0) return 0;
 
-	int64_t currSize64 = 0;
-	for (int16_t i = 1; i <= ai; i++)
+	int32_t length = s->length;
+	if (trimmed && trim->removeSmpDataAfterLoop && (s->flags & 3) != FT2_LOOP_OFF && length > s->loopStart + s->loopLength)
+		length = s->loopStart + s->loopLength;
+	if (length <= 0) return 0;
+
+	const bool sample16Bit = (s->flags & FT2_SAMPLE_16BIT) && !(trimmed && trim->convSmpsTo8Bit);
+	return sample16Bit ? (int64_t)length << 1 : length;
+}
+
+/* Instrument + sample data size, as the enabled trim options would leave it if 'trimmed' */
+static int64_t getInstrSize(const ft2_instr_t *ins, const ft2_trim_state_t *trim, bool trimmed)
+{
+	if (!ins) return 22 + 11;
+
+	/* Removing unused samples keeps exactly the ones note2SampleLUT references
+	** (moved down, which doesn't change the size) */
+	uint32_t smpMask = 0;
+	if (trimmed && trim->removeSamp)
+	{
+		for (int16_t j = 0; j < 96; j++)
+			if (ins->note2SampleLUT[j] < 16) smpMask |= 1 << ins->note2SampleLUT[j];
+	}
+	else
 	{
-		int16_t j = tmpInstr[i] ? i : 0;
-		const int16_t a = getUsedTempSamples(i);
-		currSize64 += (a > 0) ? XM_INSTR_HEADER_SIZE + (a * XM_SAMPLE_HEADER_SIZE) : 22 + 11;
+		int16_t a = getInstrUsedSamples(ins);
+		if (a > 16) a = 16;
+		smpMask = (1 << a) - 1;
+	}
 
-		ft2_instr_t *ins = tmpInstr[j];
-		for (int16_t k = 0; k < a; k++)
-		{
-			ft2_sample_t *s = &ins->smp[k];
-			if (s->dataPtr && s->length > 0)
-				currSize64 += (s->flags & FT2_SAMPLE_16BIT) ? s->length << 1 : s->length;
-		}
+	int64_t currSize64 = XM_INSTR_HEADER_SIZE;
+	for (int16_t k = 0; k < 16; k++)
+	{
+		if (smpMask & (1 << k))
+			currSize64 += XM_SAMPLE_HEADER_SIZE + getSmpDataSize(&ins->smp[k], trim, trimmed);
 	}
 	return currSize64;
 }
 
-static int64_t calculateXMSize(ft2_instance_t *inst)
+/* Current .xm size. 'ap' is from scanPatterns(). */
+static int64_t calculateXMSize(ft2_instance_t *inst, int16_t ap)
 {
-	if (!inst) return 0;
-
+	const ft2_trim_state_t *trim = TRIM_STATE(inst);
 	int64_t currSize64 = XM_HEADER_SIZE;
 
-	/* Count non-empty patterns */
-	int16_t ap = 256;
-	while (ap > 0 && patternEmpty(inst, ap - 1)) ap--;
-
-	/* Count instruments with data or names */
-	int16_t ai = 128;
-	while (ai > 0 && getUsedSamples(inst, ai) == 0 && !inst->replayer.song.instrName[ai][0]) ai--;
-
-	/* Pattern data */
 	for (int16_t i = 0; i < ap; i++)
-	{
-		currSize64 += XM_PATT_HEADER_SIZE;
-		if (!patternEmpty(inst, i))
-			currSize64 += getPackedPattSize(inst->replayer.pattern[i], inst->replayer.patternNumRows[i], inst->replayer.song.numChannels);
-	}
+		currSize64 += XM_PATT_HEADER_SIZE + trim->pattPackLen[i];
 
-	/* Instrument + sample data */
+	const int16_t ai = getLastUsedInstr(inst);
 	for (int16_t i = 1; i <= ai; i++)
-	{
-		int16_t j = inst->replayer.instr[i] ? i : 0;
-		const int16_t a = getUsedSamples(inst, i);
-		currSize64 += (a > 0) ? XM_INSTR_HEADER_SIZE + (a * XM_SAMPLE_HEADER_SIZE) : 22 + 11;
+		currSize64 += getInstrSize(inst->replayer.instr[i], trim, false);
 
-		ft2_instr_t *ins = inst->replayer.instr[j];
-		for (int16_t k = 0; k < a; k++)
-		{
-			ft2_sample_t *s = &ins->smp[k];
-			if (s->dataPtr && s->length > 0)
-				currSize64 += (s->flags & FT2_SAMPLE_16BIT) ? s->length << 1 : s->length;
-		}
-	}
 	return currSize64;
 }
 
-static void wipePattsUnused(ft2_instance_t *inst, bool testWipeSize, int16_t *ap);
-static void wipeInstrUnused(ft2_instance_t *inst, bool testWipeSize, int16_t *ai, int32_t ap, int32_t antChn);
-static void wipeSamplesUnused(ft2_instance_t *inst, bool testWipeSize, int16_t ai);
-static void wipeSmpDataAfterLoop(ft2_instance_t *inst, bool testWipeSize, int16_t ai);
-static void convertSamplesTo8bit(ft2_instance_t *inst, bool testWipeSize, int16_t ai);
-
-/* Calculates bytes saved by applying all enabled trim options */
-static int64_t calculateTrimSize(ft2_instance_t *inst)
+/* Calculates bytes saved by applying all enabled trim options. 'ap' is from scanPatterns(). */
+static int64_t calculateTrimSize(ft2_instance_t *inst, int16_t ap)
 {
-	if (!inst || !inst->ui) return 0;
-	ft2_trim_state_t *trim = TRIM_STATE(inst);
-
-	int32_t numChannels = inst->replayer.song.numChannels;
-	int32_t pattDataLen = 0, newPattDataLen = 0;
-	int64_t bytes64 = 0, oldInstrSize64 = 0;
+	const ft2_trim_state_t *trim = TRIM_STATE(inst);
+	const int32_t numChannels = inst->replayer.song.numChannels;
+	int64_t bytes64 = 0;
 
-	memcpy(tmpPatt, inst->replayer.pattern, sizeof(tmpPatt));
-	memcpy(tmpPattLens, inst->replayer.patternNumRows, sizeof(tmpPattLens));
-	memcpy(tmpInstrName, inst->replayer.song.instrName, sizeof(tmpInstrName));
+	/* Patterns kept: the ones the order list plays, unless that is none or all of them */
+	uint8_t pattList[256];
+	int16_t numPatts = 0;
 
-	if (!setTmpInstruments(inst))
+	if (trim->removePatt)
 	{
-		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-		if (ui) ft2_dialog_show_message(&ui->dialog, "System request", "Not enough memory!");
-		return 0;
-	}
-
-	if (trim->removeInst || trim->removeSamp || trim->removeSmpDataAfterLoop || trim->convSmpsTo8Bit)
-		oldInstrSize64 = getTempInsAndSmpSize(inst);
-
-	int16_t ap = 256;
-	while (ap > 0 && tmpPatternEmpty(ap - 1, numChannels)) ap--;
+		bool pattUsed[256] = { false };
+		for (int16_t i = 0; i < inst->replayer.song.songLength; i++)
+		{
+			const uint8_t patt = inst->replayer.song.orders[i];
+			if (patt < ap) pattUsed[patt] = true;
+		}
 
-	int16_t ai = 128;
-	while (ai > 0 && getUsedTempSamples(ai) == 0 && !tmpInstrName[ai][0]) ai--;
+		for (int16_t i = 0; i < ap; i++)
+			if (pattUsed[i]) pattList[numPatts++] = (uint8_t)i;
+	}
 
-	if (trim->removeSamp) wipeSamplesUnused(inst, true, ai);
-	if (trim->removeSmpDataAfterLoop) wipeSmpDataAfterLoop(inst, true, ai);
-	if (trim->convSmpsTo8Bit) convertSamplesTo8bit(inst, true, ai);
+	if (numPatts == 0 || numPatts == ap)
+	{
+		for (int16_t i = 0; i < ap; i++) pattList[i] = (uint8_t)i;
+		numPatts = ap;
+	}
 
 	if (trim->removeChans || trim->removePatt)
 	{
-		for (int16_t i = 0; i < ap; i++)
+		int32_t newNumChannels = numChannels;
+		if (trim->removeChans)
 		{
-			pattDataLen += XM_PATT_HEADER_SIZE;
-			if (!tmpPatternEmpty(i, numChannels))
-				pattDataLen += getPackedPattSize(tmpPatt[i], tmpPattLens[i], numChannels);
+			int32_t highestChan = 0;
+			for (int16_t i = 0; i < ap; i++)
+				if (trim->pattUsedChans[i] > highestChan) highestChan = trim->pattUsedChans[i];
+
+			if (highestChan > 0)
+			{
+				if (highestChan & 1) highestChan++;
+				if (highestChan < 2) highestChan = 2;
+				if (highestChan > numChannels) highestChan = numChannels;
+				newNumChannels = highestChan;
+			}
 		}
-	}
 
-	if (trim->removeChans)
-	{
-		int16_t highestChan = -1;
+		int64_t pattDataLen64 = 0, newPattDataLen64 = 0;
 		for (int16_t i = 0; i < ap; i++)
+			pattDataLen64 += XM_PATT_HEADER_SIZE + trim->pattPackLen[i];
+
+		/* The channels removed are empty, and an empty channel packs to one byte per row */
+		for (int16_t i = 0; i < numPatts; i++)
 		{
-			ft2_note_t *pattPtr = tmpPatt[i];
-			if (!pattPtr) continue;
-			const int16_t numRows = tmpPattLens[i];
-			for (int32_t j = 0; j < numRows; j++)
-				for (int32_t k = 0; k < numChannels; k++)
-				{
-					ft2_note_t *p = &pattPtr[(j * FT2_MAX_CHANNELS) + k];
-					if (p->note || p->instr || p->vol || p->efx || p->efxData)
-						if (k > highestChan) highestChan = k;
-				}
-		}
-		if (highestChan >= 0)
-		{
-			highestChan++;
-			if (highestChan & 1) highestChan++;
-			if (highestChan < 2) highestChan = 2;
-			if (highestChan > numChannels) highestChan = numChannels;
-			numChannels = highestChan;
+			const uint8_t patt = pattList[i];
+			newPattDataLen64 += XM_PATT_HEADER_SIZE;
+			if (trim->pattUsedChans[patt] > 0)
+				newPattDataLen64 += trim->pattPackLen[patt] - (inst->replayer.patternNumRows[patt] * (numChannels - newNumChannels));
 		}
-	}
 
-	if (trim->removePatt) wipePattsUnused(inst, true, &ap);
+		if (pattDataLen64 > newPattDataLen64) bytes64 += pattDataLen64 - newPattDataLen64;
+	}
 
-	if (trim->removeChans || trim->removePatt)
+	if (trim->removeInst || trim->removeSamp || trim->removeSmpDataAfterLoop || trim->convSmpsTo8Bit)
 	{
-		for (int16_t i = 0; i < ap; i++)
+		const int16_t ai = getLastUsedInstr(inst);
+
+		/* Instruments kept, in their new order: the ones the kept patterns use */
+		uint8_t instrList[128];
+		int16_t numInstrs = 0;
+
+		if (trim->removeInst)
+		{
+			uint8_t instrUsed[16] = { 0 };
+			for (int16_t i = 0; i < numPatts; i++)
+				for (int32_t j = 0; j < 16; j++) instrUsed[j] |= trim->pattInstrs[pattList[i]][j];
+
+			for (int16_t i = 1; i <= ai; i++)
+				if (instrUsed[(i - 1) >> 3] & (1 << ((i - 1) & 7))) instrList[numInstrs++] = (uint8_t)i;
+		}
+		else
 		{
-			newPattDataLen += XM_PATT_HEADER_SIZE;
-			if (!tmpPatternEmpty(i, numChannels))
-				newPattDataLen += getPackedPattSize(tmpPatt[i], tmpPattLens[i], numChannels);
+			for (int16_t i = 1; i <= ai; i++) instrList[numInstrs++] = (uint8_t)i;
 		}
-		if (pattDataLen > newPattDataLen) bytes64 += (pattDataLen - newPattDataLen);
-	}
 
-	if (trim->removeInst) wipeInstrUnused(inst, true, &ai, ap, numChannels);
+		/* Empty slots at the end aren't saved */
+		while (numInstrs > 0 && !inst->replayer.instr[instrList[numInstrs - 1]] &&
+		       !inst->replayer.song.instrName[instrList[numInstrs - 1]][0])
+			numInstrs--;
 
-	if (trim->removeInst || trim->removeSamp || trim->removeSmpDataAfterLoop || trim->convSmpsTo8Bit)
-	{
-		int64_t newInstrSize64 = getTempInsAndSmpSize(inst);
-		if (oldInstrSize64 > newInstrSize64) bytes64 += (oldInstrSize64 - newInstrSize64);
+		int64_t oldInstrSize64 = 0, newInstrSize64 = 0;
+		for (int16_t i = 1; i <= ai; i++)
+			oldInstrSize64 += getInstrSize(inst->replayer.instr[i], trim, false);
+		for (int16_t i = 0; i < numInstrs; i++)
+			newInstrSize64 += getInstrSize(inst->replayer.instr[instrList[i]], trim, true);
+
+		if (oldInstrSize64 > newInstrSize64) bytes64 += oldInstrSize64 - newInstrSize64;
 	}
 
-	freeTmpInstruments();
 	return bytes64;
 }
 
@@ -492,23 +458,80 @@ static int64_t calculateTrimSize(ft2_instance_t *inst)
 /*                       TRIM OPERATIONS                                     */
 /* ------------------------------------------------------------------------- */
 
-/* Removes patterns not referenced in order list, remaps remaining */
-static void wipePattsUnused(ft2_instance_t *inst, bool testWipeSize, int16_t *ap)
+/* The pattern side of a trim: worked out and copied from the patterns as
+** they are while the song keeps playing (buildTrim), then put in place
+** between two audio blocks, which only moves pointers (putPatterns,
+** putInstruments). Pattern slots are by their number before the trim. */
+typedef struct trim_build_t
+{
+	const ft2_trim_state_t *trim;
+	int16_t ai; /* Last used instrument */
+
+	int16_t ap, newAp; /* Used patterns before and after */
+	int32_t numChannels, stride; /* Song channels and pattern stride after */
+	bool pattsRemoved;
+	uint8_t pattUsed[256], pattOrder[256];
+
+	bool instrsRemoved, instrsRenumbered;
+	uint8_t instrUsed[128], instrOrder[128];
+	uint8_t instrMap[256]; /* Instrument in a cell -> after the renumbering */
+
+	ft2_note_t *newPatt[256]; /* Rebuilt with the new stride and instruments (NULL: kept) */
+	bool inPlace; /* Out of memory: no new buffers, cells are changed in place */
+} trim_build_t;
+
+static void discardTrimBuild(ft2_instance_t *inst, void *userData)
 {
-	uint8_t newPatt;
-	int16_t i, *pLens;
-	ft2_note_t **p;
+	(void)inst;
+	trim_build_t *tb = (trim_build_t *)userData;
+	for (int32_t i = 0; i < 256; i++)
+	{
+		free(tb->newPatt[i]);
+		tb->newPatt[i] = NULL;
+	}
+}
+
+/* Highest channel with notes in the used patterns, rounded up like FT2 */
+static int32_t getTrimmedNumChannels(ft2_instance_t *inst, int16_t ap)
+{
+	const int32_t numChannels = inst->replayer.song.numChannels;
+	const int32_t stride = inst->replayer.patternStride;
+
+	int16_t highestChan = -1;
+	for (int32_t i = 0; i < ap; i++)
+	{
+		const ft2_note_t *pattPtr = inst->replayer.pattern[i];
+		if (!pattPtr) continue;
+		const int16_t numRows = inst->replayer.patternNumRows[i];
+		for (int32_t j = 0; j < numRows; j++)
+			for (int32_t k = 0; k < numChannels; k++)
+			{
+				const ft2_note_t *p = &pattPtr[(j * stride) + k];
+				if (p->note || p->vol || p->instr || p->efx || p->efxData)
+					if (k > highestChan) highestChan = k;
+			}
+	}
 
-	int16_t usedPatts = *ap;
-	memset(pattUsed, 0, usedPatts);
+	if (highestChan < 0) return numChannels;
+
+	highestChan++;
+	if (highestChan & 1) highestChan++;
+	if (highestChan < 2) highestChan = 2;
+	if (highestChan > numChannels) highestChan = numChannels;
+	return highestChan;
+}
 
+/* Patterns not referenced in the order list go, the rest move down */
+static void findUsedPatts(ft2_instance_t *inst, trim_build_t *tb)
+{
+	const int16_t usedPatts = tb->ap;
 	int16_t newUsedPatts = 0;
-	for (i = 0; i < inst->replayer.song.songLength; i++)
+	for (int16_t i = 0; i < inst->replayer.song.songLength; i++)
 	{
-		newPatt = inst->replayer.song.orders[i];
-		if (newPatt < usedPatts && !pattUsed[newPatt])
+		const uint8_t patt = inst->replayer.song.orders[i];
+		if (patt < usedPatts && !tb->pattUsed[patt])
 		{
-			pattUsed[newPatt] = true;
+			tb->pattUsed[patt] = true;
 			newUsedPatts++;
 		}
 	}
@@ -516,224 +539,366 @@ static void wipePattsUnused(ft2_instance_t *inst, bool testWipeSize, int16_t *ap
 	if (newUsedPatts == 0 || newUsedPatts == usedPatts)
 		return;
 
-	newPatt = 0;
-	memset(pattOrder, 0, usedPatts);
-	for (i = 0; i < usedPatts; i++)
+	uint8_t newPatt = 0;
+	for (int16_t i = 0; i < usedPatts; i++)
 	{
-		if (pattUsed[i])
-			pattOrder[i] = newPatt++;
+		if (tb->pattUsed[i])
+			tb->pattOrder[i] = newPatt++;
 	}
 
-	if (testWipeSize)
+	tb->pattsRemoved = true;
+	tb->newAp = newUsedPatts;
+}
+
+static bool pattKept(const trim_build_t *tb, int32_t pattNum)
+{
+	return !tb->pattsRemoved || pattNum >= tb->ap || tb->pattUsed[pattNum];
+}
+
+/* Instruments not used in the kept patterns go, the rest move down */
+static void findUsedInstrs(ft2_instance_t *inst, trim_build_t *tb)
+{
+	const int32_t stride = inst->replayer.patternStride;
+	for (int32_t i = 0; i < tb->ap; i++)
 	{
-		p = tmpPatt;
-		pLens = tmpPattLens;
+		const ft2_note_t *p = inst->replayer.pattern[i];
+		if (!p || !pattKept(tb, i)) continue;
+
+		const int16_t numRows = inst->replayer.patternNumRows[i];
+		for (int32_t j = 0; j < numRows; j++)
+			for (int32_t k = 0; k < tb->numChannels; k++)
+			{
+				const uint8_t ins = p[(j * stride) + k].instr;
+				if (ins > 0 && ins <= 128) tb->instrUsed[ins - 1] = true;
+			}
 	}
-	else
+
+	uint8_t newInst = 0;
+	for (int32_t i = 0; i < 256; i++)
+		tb->instrMap[i] = (uint8_t)i;
+
+	for (int32_t i = 0; i < tb->ai; i++)
 	{
-		p = inst->replayer.pattern;
-		pLens = inst->replayer.patternNumRows;
+		if (!tb->instrUsed[i])
+		{
+			tb->instrsRemoved = true;
+			continue;
+		}
+
+		tb->instrOrder[i] = newInst++;
+		tb->instrMap[1 + i] = 1 + tb->instrOrder[i];
+		if (tb->instrOrder[i] != i) tb->instrsRenumbered = true;
 	}
+}
+
+static void remapInstrs(const trim_build_t *tb, ft2_note_t *p, int32_t numCells)
+{
+	for (int32_t j = 0; j < numCells; j++)
+		p[j].instr = tb->instrMap[p[j].instr];
+}
+
+static bool buildTrim(ft2_instance_t *inst, void *userData)
+{
+	trim_build_t *tb = (trim_build_t *)userData;
+	const ft2_trim_state_t *trim = tb->trim;
+	const int16_t ai = tb->ai;
+	memset(tb, 0, sizeof(trim_build_t));
+	tb->trim = trim;
+	tb->ai = ai;
 
-	memcpy(oldPatts, p, usedPatts * sizeof(ft2_note_t *));
-	memcpy(oldPattLens, pLens, usedPatts * sizeof(int16_t));
-	memset(p, 0, usedPatts * sizeof(ft2_note_t *));
-	memset(pLens, 0, usedPatts * sizeof(int16_t));
+	const ft2_replayer_state_t *rep = &inst->replayer;
+	const int32_t oldStride = rep->patternStride;
 
-	/* Relocate patterns */
-	for (i = 0; i < usedPatts; i++)
+	int16_t ap = 256;
+	while (ap > 0 && patternEmpty(inst, ap - 1)) ap--;
+	tb->ap = tb->newAp = ap;
+
+	/* Dropping removed (and any hidden) channels compacts the rows */
+	tb->numChannels = trim->removeChans ? getTrimmedNumChannels(inst, ap) : rep->song.numChannels;
+	tb->stride = (trim->removeChans && tb->numChannels < oldStride) ? tb->numChannels : oldStride;
+
+	if (trim->removePatt) findUsedPatts(inst, tb);
+	if (trim->removeInst) findUsedInstrs(inst, tb);
+
+	for (int32_t i = 0; i < 256; i++)
 	{
-		p[i] = NULL;
+		const ft2_note_t *oldPatt = rep->pattern[i];
+		const bool renumber = tb->instrsRenumbered && i < ap;
+		if (!oldPatt || !pattKept(tb, i) || (tb->stride == oldStride && !renumber)) continue;
 
-		if (!pattUsed[i])
-		{
-			if (!testWipeSize && oldPatts[i] != NULL)
-			{
-				free(oldPatts[i]);
-				oldPatts[i] = NULL;
-			}
-		}
-		else
+		const int32_t stride = tb->stride, allocRows = rep->patternAllocRows[i];
+		ft2_note_t *newPatt = (ft2_note_t *)calloc((size_t)allocRows * stride, sizeof(ft2_note_t));
+		if (!newPatt)
 		{
-			newPatt = pattOrder[i];
-			p[newPatt] = oldPatts[i];
-			pLens[newPatt] = oldPattLens[i];
+			/* Out of memory: the old way, in place */
+			discardTrimBuild(inst, tb);
+			tb->stride = oldStride;
+			tb->inPlace = true;
+			return true;
 		}
+
+		const int32_t copyCells = (stride < oldStride) ? stride : oldStride;
+		for (int32_t row = 0; row < allocRows; row++)
+			memcpy(&newPatt[row * stride], &oldPatt[row * oldStride], copyCells * sizeof(ft2_note_t));
+		if (renumber) remapInstrs(tb, newPatt, rep->patternNumRows[i] * stride);
+		tb->newPatt[i] = newPatt;
 	}
 
-	if (!testWipeSize)
+	return true;
+}
+
+/* Between blocks: swaps in the rebuilt patterns and renumbers them. The
+** buffers left over go to oldPatts, to be freed after the swap. */
+static void putPatterns(ft2_instance_t *inst, const trim_build_t *tb, ft2_note_t **oldPatts)
+{
+	ft2_replayer_state_t *rep = &inst->replayer;
+	ft2_note_t *patts[256];
+	int16_t pattLens[256], pattAllocRows[256];
+	int32_t i;
+
+	if (tb->inPlace)
 	{
+		const int32_t stride = rep->patternStride;
 		for (i = 0; i < 256; i++)
 		{
-			if (inst->replayer.pattern[i] == NULL)
-				inst->replayer.patternNumRows[i] = 64;
+			ft2_note_t *p = rep->pattern[i];
+			if (!p) continue;
+			if (tb->trim->removeChans && tb->numChannels < stride)
+				for (int32_t j = 0; j < rep->patternAllocRows[i]; j++)
+					memset(&p[(j * stride) + tb->numChannels], 0, sizeof(ft2_note_t) * (stride - tb->numChannels));
+			if (tb->instrsRenumbered && i < tb->ap && pattKept(tb, i))
+				remapInstrs(tb, p, rep->patternNumRows[i] * stride);
 		}
+	}
 
-		/* Reorder order list */
-		for (i = 0; i < 256; i++)
+	for (i = 0; i < 256; i++)
+	{
+		oldPatts[i] = NULL;
+		patts[i] = rep->pattern[i];
+		if (tb->newPatt[i])
 		{
-			if (i < inst->replayer.song.songLength)
-				inst->replayer.song.orders[i] = pattOrder[inst->replayer.song.orders[i]];
-			else
-				inst->replayer.song.orders[i] = 0;
+			oldPatts[i] = patts[i];
+			patts[i] = tb->newPatt[i];
 		}
 	}
 
-	*ap = newUsedPatts;
-}
+	rep->patternStride = tb->stride;
+	rep->song.numChannels = (uint8_t)tb->numChannels;
 
-/* Remaps instrument number in all pattern data */
-static void remapInstrInSong(ft2_instance_t *inst, uint8_t src, uint8_t dst, int32_t ap)
-{
-	for (int32_t i = 0; i < ap; i++)
+	if (!tb->pattsRemoved)
 	{
-		ft2_note_t *pattPtr = inst->replayer.pattern[i];
-		if (!pattPtr) continue;
-		const int32_t readLen = inst->replayer.patternNumRows[i] * FT2_MAX_CHANNELS;
-		for (int32_t j = 0; j < readLen; j++)
-			if (pattPtr[j].instr == src) pattPtr[j].instr = dst;
+		memcpy(rep->pattern, patts, sizeof(patts));
+		return;
 	}
-}
 
-/* Removes instruments not used in any pattern, remaps remaining */
-static void wipeInstrUnused(ft2_instance_t *inst, bool testWipeSize, int16_t *ai, int32_t ap, int32_t antChn)
-{
-	int32_t numInsts = *ai;
+	const int16_t usedPatts = tb->ap;
+	memcpy(pattLens, rep->patternNumRows, usedPatts * sizeof(int16_t));
+	memcpy(pattAllocRows, rep->patternAllocRows, usedPatts * sizeof(int16_t));
+	memset(rep->pattern, 0, usedPatts * sizeof(ft2_note_t *));
+	memset(rep->patternNumRows, 0, usedPatts * sizeof(int16_t));
+	memset(rep->patternAllocRows, 0, usedPatts * sizeof(int16_t));
 
-	memset(instrUsed, 0, numInsts);
-	for (int32_t i = 0; i < ap; i++)
+	/* Relocate patterns */
+	for (i = 0; i < 256; i++)
 	{
-		ft2_note_t *p = testWipeSize ? tmpPatt[i] : inst->replayer.pattern[i];
-		int16_t numRows = testWipeSize ? tmpPattLens[i] : inst->replayer.patternNumRows[i];
-		if (!p) continue;
-
-		for (int32_t j = 0; j < numRows; j++)
-			for (int32_t k = 0; k < antChn; k++)
-			{
-				uint8_t ins = p[(j * FT2_MAX_CHANNELS) + k].instr;
-				if (ins > 0 && ins <= 128) instrUsed[ins - 1] = true;
-			}
+		if (i >= usedPatts)
+		{
+			rep->pattern[i] = patts[i];
+		}
+		else if (!tb->pattUsed[i])
+		{
+			oldPatts[i] = patts[i];
+		}
+		else
+		{
+			const uint8_t newPatt = tb->pattOrder[i];
+			rep->pattern[newPatt] = patts[i];
+			rep->patternNumRows[newPatt] = pattLens[i];
+			rep->patternAllocRows[newPatt] = pattAllocRows[i];
+		}
 	}
 
-	int16_t instToDel = 0;
-	uint8_t newInst = 0;
-	int16_t newNumInsts = 0;
-	int32_t i;
+	for (i = 0; i < 256; i++)
+	{
+		if (rep->pattern[i] == NULL)
+			rep->patternNumRows[i] = 64;
+	}
 
-	memset(instrOrder, 0, numInsts);
-	for (i = 0; i < numInsts; i++)
+	/* Reorder order list */
+	for (i = 0; i < 256; i++)
 	{
-		if (instrUsed[i]) { newNumInsts++; instrOrder[i] = newInst++; }
-		else instToDel++;
+		if (i < rep->song.songLength)
+			rep->song.orders[i] = tb->pattOrder[rep->song.orders[i]];
+		else
+			rep->song.orders[i] = 0;
 	}
 
-	if (instToDel == 0) return;
+	uint16_t *editPatt = &inst->editor.editPattern;
+	if (*editPatt < usedPatts)
+		*editPatt = tb->pattUsed[*editPatt] ? tb->pattOrder[*editPatt] : rep->song.orders[rep->song.songPos];
+}
 
-	if (testWipeSize)
+/* Between blocks: detaches the unused instruments (they go to removed,
+** to be freed after the swap) and moves the rest down. Returns how many
+** were detached. */
+static int32_t putInstruments(ft2_instance_t *inst, const trim_build_t *tb, ft2_instr_t **removed)
+{
+	const int32_t numInsts = tb->ai;
+	int32_t numRemoved = 0, i;
+
+	/* Voices playing a removed instrument's samples stop, and channels left
+	** on it go back to the placeholder instrument */
+	ft2_instr_t *placeholder = inst->replayer.instr[0];
+	for (i = 0; i < numInsts; i++)
 	{
-		for (i = 0; i < numInsts; i++)
-			if (!instrUsed[i] && tmpInstr[1 + i]) { free(tmpInstr[1 + i]); tmpInstr[1 + i] = NULL; }
+		ft2_instr_t *ins = inst->replayer.instr[1 + i];
+		if (tb->instrUsed[i] || !ins) continue;
 
-		memcpy(tmpInstName, &tmpInstrName[1], 128 * sizeof(tmpInstrName[0]));
-		memcpy(tmpInst, &tmpInstr[1], 128 * sizeof(tmpInstr[0]));
-		memset(&tmpInstr[1], 0, numInsts * sizeof(tmpInstr[0]));
-		memset(&tmpInstrName[1], 0, numInsts * sizeof(tmpInstrName[0]));
+		for (int32_t j = 0; j < FT2_MAX_SMP_PER_INST; j++)
+		{
+			if (ins->smp[j].dataPtr) ft2_sample_edit_begin(inst, &ins->smp[j]);
+			ft2_sample_handoff_move(inst, &ins->smp[j], NULL);
+		}
 
-		for (i = 0; i < numInsts; i++)
-			if (instrUsed[i])
-			{
-				newInst = instrOrder[i];
-				memcpy(&tmpInstr[1 + newInst], &tmpInst[i], sizeof(tmpInst[0]));
-				strcpy(tmpInstrName[1 + newInst], tmpInstName[i]);
-			}
+		for (int32_t c = 0; c < FT2_MAX_CHANNELS; c++)
+		{
+			ft2_channel_t *ch = &inst->replayer.channel[c];
+			if (ch->instrPtr != ins) continue;
+			ch->instrPtr = placeholder;
+			ch->smpPtr = (placeholder != NULL) ? &placeholder->smp[0] : NULL;
+			ch->instrNum = ch->smpNum = 0;
+		}
 
-		*ai = newNumInsts;
-		return;
+		removed[numRemoved++] = ins;
+		inst->replayer.instr[1 + i] = NULL;
 	}
+	ft2_sample_handoff_capture(inst);
 
-	for (i = 0; i < numInsts; i++)
-		if (!instrUsed[i]) ft2_instance_free_instr(inst, 1 + i);
-
-	static char localInstName[128][23];
-	static ft2_instr_t *localInst[128];
+	char oldInstName[128][23];
+	ft2_instr_t *oldInst[128];
 
-	memcpy(localInstName, &inst->replayer.song.instrName[1], 128 * sizeof(inst->replayer.song.instrName[0]));
-	memcpy(localInst, &inst->replayer.instr[1], 128 * sizeof(inst->replayer.instr[0]));
+	memcpy(oldInstName, &inst->replayer.song.instrName[1], 128 * sizeof(inst->replayer.song.instrName[0]));
+	memcpy(oldInst, &inst->replayer.instr[1], 128 * sizeof(inst->replayer.instr[0]));
 	memset(&inst->replayer.instr[1], 0, numInsts * sizeof(inst->replayer.instr[0]));
 	memset(&inst->replayer.song.instrName[1], 0, numInsts * sizeof(inst->replayer.song.instrName[0]));
 
 	for (i = 0; i < numInsts; i++)
-		if (instrUsed[i])
+		if (tb->instrUsed[i])
 		{
-			newInst = instrOrder[i];
-			remapInstrInSong(inst, 1 + (uint8_t)i, 1 + newInst, ap);
-			memcpy(&inst->replayer.instr[1 + newInst], &localInst[i], sizeof(localInst[0]));
-			strcpy(inst->replayer.song.instrName[1 + newInst], localInstName[i]);
-		}
+			const uint8_t newInst = tb->instrOrder[i];
+			memcpy(&inst->replayer.instr[1 + newInst], &oldInst[i], sizeof(oldInst[0]));
+			strcpy(inst->replayer.song.instrName[1 + newInst], oldInstName[i]);
 
-	*ai = newNumInsts;
+			for (int32_t c = 0; c < FT2_MAX_CHANNELS; c++)
+				if (oldInst[i] && inst->replayer.channel[c].instrPtr == oldInst[i])
+					inst->replayer.channel[c].instrNum = 1 + newInst;
+		}
 
-	setTmpInstruments(inst);
+	return numRemoved;
 }
 
-/* Removes samples not referenced by note2SampleLUT, remaps remaining */
-static void wipeSamplesUnused(ft2_instance_t *inst, bool testWipeSize, int16_t ai)
+/* After the swap: what ft2_instance_free_instr() does for a slot */
+static void freeRemovedInstr(ft2_instr_t *ins)
 {
-	uint8_t smpUsed[16], smpOrder[16];
-	ft2_sample_t tempSamples[16];
+	for (int32_t i = 0; i < FT2_MAX_SMP_PER_INST; i++)
+	{
+		if (ins->smp[i].origDataPtr != NULL)
+			ft2_sample_pool_release(ins->smp[i].origDataPtr);
+	}
+	free(ins);
+}
 
+/* Frees samples not referenced by note2SampleLUT. The slots are compacted
+** by compactSamples(). */
+static void freeSamplesUnused(ft2_instance_t *inst, int16_t ai, int16_t *numSmps, uint8_t (*smpUsed)[16])
+{
 	for (int16_t i = 1; i <= ai; i++)
 	{
-		int16_t l;
-		ft2_instr_t *ins;
-		if (!testWipeSize)
-			{ l = inst->replayer.instr[i] ? i : 0; ins = inst->replayer.instr[l]; l = getUsedSamples(inst, i); }
-		else
-			{ l = tmpInstr[i] ? i : 0; ins = tmpInstr[l]; l = getUsedTempSamples(i); }
+		ft2_instr_t *ins = inst->replayer.instr[i];
+		const int16_t l = numSmps[i] = getUsedSamples(inst, i);
 
-		memset(smpUsed, 0, l);
+		memset(smpUsed[i], 0, 16);
 		if (l > 0)
 		{
 			ft2_sample_t *s = ins->smp;
 			for (int16_t j = 0; j < l; j++, s++)
 			{
 				int16_t k;
-				for (k = 0; k < 96; k++) if (ins->note2SampleLUT[k] == j) { smpUsed[j] = true; break; }
-				if (k == 96)
+				for (k = 0; k < 96; k++) if (ins->note2SampleLUT[k] == j) { smpUsed[i][j] = true; break; }
+				if (k == 96 && s->dataPtr)
 				{
-					if (s->dataPtr && !testWipeSize) freeSmpData(inst, i, j);
-					memset(s, 0, sizeof(ft2_sample_t));
+					ft2_sample_edit_begin(inst, s);
+					freeSmpData(inst, i, j);
 				}
 			}
+		}
+	}
+}
+
+/* Moves the samples freeSamplesUnused() kept down over the freed slots and
+** remaps note2SampleLUT and the channels to match */
+static void compactSamples(ft2_instance_t *inst, int16_t ai, const int16_t *numSmps, uint8_t (*smpUsed)[16])
+{
+	uint8_t smpOrder[16];
+	ft2_sample_t tempSamples[16];
+	ft2_instr_t *placeholder = inst->replayer.instr[0];
+
+	for (int16_t i = 1; i <= ai; i++)
+	{
+		ft2_instr_t *ins = inst->replayer.instr[i];
+		const int16_t l = numSmps[i];
+		if (l <= 0) continue;
+
+		for (int16_t j = 0; j < l; j++)
+			if (!smpUsed[i][j]) memset(&ins->smp[j], 0, sizeof(ft2_sample_t));
+
+		uint8_t newSamp = 0;
+		memset(smpOrder, 0, sizeof(smpOrder));
+		for (int16_t j = 0; j < l; j++) if (smpUsed[i][j]) smpOrder[j] = newSamp++;
+
+		/* In slot order: a sample only ever moves down */
+		for (int16_t j = 0; j < l; j++)
+			ft2_sample_handoff_move(inst, &ins->smp[j], smpUsed[i][j] ? &ins->smp[smpOrder[j]] : NULL);
 
-			uint8_t newSamp = 0;
-			memset(smpOrder, 0, l);
-			for (int16_t j = 0; j < l; j++) if (smpUsed[j]) smpOrder[j] = newSamp++;
+		memcpy(tempSamples, ins->smp, l * sizeof(ft2_sample_t));
+		memset(ins->smp, 0, l * sizeof(ft2_sample_t));
+		for (int16_t j = 0; j < l; j++) if (smpUsed[i][j]) ins->smp[smpOrder[j]] = tempSamples[j];
 
-			memcpy(tempSamples, ins->smp, l * sizeof(ft2_sample_t));
-			memset(ins->smp, 0, l * sizeof(ft2_sample_t));
-			for (int16_t j = 0; j < l; j++) if (smpUsed[j]) ins->smp[smpOrder[j]] = tempSamples[j];
+		for (int16_t j = 0; j < 96; j++)
+		{
+			newSamp = ins->note2SampleLUT[j];
+			ins->note2SampleLUT[j] = smpUsed[i][newSamp] ? smpOrder[newSamp] : 0;
+		}
+
+		/* Channels point at sample slots, so follow the moves */
+		for (int32_t c = 0; c < FT2_MAX_CHANNELS; c++)
+		{
+			ft2_channel_t *ch = &inst->replayer.channel[c];
+			if (ch->smpPtr < ins->smp || ch->smpPtr >= &ins->smp[l]) continue;
 
-			for (int16_t j = 0; j < 96; j++)
+			const int32_t j = (int32_t)(ch->smpPtr - ins->smp);
+			if (smpUsed[i][j])
 			{
-				newSamp = ins->note2SampleLUT[j];
-				ins->note2SampleLUT[j] = smpUsed[newSamp] ? smpOrder[newSamp] : 0;
+				ch->smpPtr = &ins->smp[smpOrder[j]];
+				ch->smpNum = smpOrder[j];
+			}
+			else
+			{
+				ch->smpPtr = (placeholder != NULL) ? &placeholder->smp[0] : NULL;
+				ch->smpNum = 0;
 			}
 		}
 	}
 }
 
 /* Truncates sample data past loop end */
-static void wipeSmpDataAfterLoop(ft2_instance_t *inst, bool testWipeSize, int16_t ai)
+static void wipeSmpDataAfterLoop(ft2_instance_t *inst, int16_t ai)
 {
 	for (int16_t i = 1; i <= ai; i++)
 	{
-		int16_t l;
-		ft2_instr_t *ins;
-		if (!testWipeSize)
-			{ l = inst->replayer.instr[i] ? i : 0; ins = inst->replayer.instr[l]; l = getUsedSamples(inst, i); }
-		else
-			{ l = tmpInstr[i] ? i : 0; ins = tmpInstr[l]; l = getUsedTempSamples(i); }
+		ft2_instr_t *ins = inst->replayer.instr[i];
+		const int16_t l = getUsedSamples(inst, i);
+		if (l == 0) continue;
 
 		ft2_sample_t *s = ins->smp;
 		for (int16_t j = 0; j < l; j++, s++)
@@ -741,37 +906,37 @@ static void wipeSmpDataAfterLoop(ft2_instance_t *inst, bool testWipeSize, int16_
 			uint8_t loopType = s->flags & 3;
 			if (s->dataPtr && loopType != FT2_LOOP_OFF && s->length > 0 && s->length > s->loopStart + s->loopLength)
 			{
+				ft2_sample_edit_begin(inst, s);
 				s->length = s->loopStart + s->loopLength;
-				if (!testWipeSize && s->length <= 0) { s->length = 0; freeSmpData(inst, i, j); }
+				if (s->length <= 0) { s->length = 0; freeSmpData(inst, i, j); }
 			}
 		}
 	}
 }
 
-/* Converts 16-bit samples to 8-bit in-place */
-static void convertSamplesTo8bit(ft2_instance_t *inst, bool testWipeSize, int16_t ai)
+/* Converts 16-bit samples to 8-bit (on a private copy, voices move over to it) */
+static void convertSamplesTo8bit(ft2_instance_t *inst, int16_t ai)
 {
 	for (int16_t i = 1; i <= ai; i++)
 	{
-		int16_t k;
-		ft2_instr_t *ins;
-		if (!testWipeSize)
-			{ k = inst->replayer.instr[i] ? i : 0; ins = inst->replayer.instr[k]; k = getUsedSamples(inst, i); }
-		else
-			{ k = tmpInstr[i] ? i : 0; ins = tmpInstr[k]; k = getUsedTempSamples(i); }
+		ft2_instr_t *ins = inst->replayer.instr[i];
+		const int16_t k = getUsedSamples(inst, i);
+		if (k == 0) continue;
 
 		ft2_sample_t *s = ins->smp;
 		for (int16_t j = 0; j < k; j++, s++)
 		{
 			if (s->dataPtr && s->length > 0 && (s->flags & FT2_SAMPLE_16BIT))
 			{
-				if (!testWipeSize)
-				{
-					const int16_t *src16 = (const int16_t *)s->dataPtr;
-					int8_t *dst8 = s->dataPtr;
-					for (int32_t a = 0; a < s->length; a++) dst8[a] = src16[a] >> 8;
-				}
+				ft2_sample_edit_begin(inst, s);
+				if (!ft2_unfix_sample(s)) continue;
+
+				const int16_t *src16 = (const int16_t *)s->dataPtr;
+				int8_t *dst8 = s->dataPtr;
+				for (int32_t a = 0; a < s->length; a++) dst8[a] = src16[a] >> 8;
 				s->flags &= ~FT2_SAMPLE_16BIT;
+
+				ft2_fix_sample(s);
 			}
 		}
 	}
@@ -786,8 +951,9 @@ void pbTrimCalc(ft2_instance_t *inst)
 	if (!inst || !inst->ui) return;
 	ft2_trim_state_t *trim = TRIM_STATE(inst);
 
-	trim->xmSize64 = calculateXMSize(inst);
-	trim->spaceSaved64 = calculateTrimSize(inst);
+	const int16_t ap = scanPatterns(inst);
+	trim->xmSize64 = calculateXMSize(inst, ap);
+	trim->spaceSaved64 = calculateTrimSize(inst, ap);
 	trim->xmAfterTrimSize64 = trim->xmSize64 - trim->spaceSaved64;
 	if (trim->xmAfterTrimSize64 < 0) trim->xmAfterTrimSize64 = 0;
 
@@ -805,69 +971,57 @@ static void doTrimConfirmed(ft2_instance_t *inst, ft2_dialog_result_t result,
 	if (!inst || !inst->ui || result != DIALOG_RESULT_YES) return;
 	ft2_trim_state_t *trim = TRIM_STATE(inst);
 
-	int16_t ap = 256;
-	while (ap > 0 && patternEmpty(inst, ap - 1)) ap--;
-
 	int16_t ai = 128;
 	while (ai > 0 && getUsedSamples(inst, ai) == 0 && !inst->replayer.song.instrName[ai][0]) ai--;
 
-	if (!setTmpInstruments(inst))
+	/* Sample data first, while the song keeps playing: each touched sample
+	** goes through the handoff, so its voices carry on from the new data
+	** (or stop if it was removed). The edits are captured before any
+	** sample or instrument changes slot below. */
+	int16_t numSmps[129];
+	uint8_t smpUsed[129][16];
+	if (trim->removeSamp) freeSamplesUnused(inst, ai, numSmps, smpUsed);
+	if (trim->removeSmpDataAfterLoop) wipeSmpDataAfterLoop(inst, ai);
+	if (trim->convSmpsTo8Bit) convertSamplesTo8bit(inst, ai);
+	ft2_sample_handoff_capture(inst);
+
+	/* Then the patterns are copied with the new stride and instrument
+	** numbers, still while the song plays, and only the renumbering of
+	** samples, instruments, channels and patterns, which moves pointers,
+	** happens between two audio blocks. buildTrim() can't fail: out of
+	** memory, it leaves the cells to be changed in place. */
+	trim_build_t tb;
+	memset(&tb, 0, sizeof(tb));
+	tb.trim = trim;
+	tb.ai = ai;
+	ft2_pattern_swap_begin_built(inst, buildTrim, discardTrimBuild, &tb);
+
+	if (trim->removeSamp) compactSamples(inst, ai, numSmps, smpUsed);
+
+	ft2_note_t *oldPatts[256];
+	putPatterns(inst, &tb, oldPatts);
+
+	if (trim->removePatt)
 	{
-		ft2_ui_t *ui = (ft2_ui_t*)inst->ui;
-		if (ui) ft2_dialog_show_message(&ui->dialog, "System request", "Not enough memory!");
-		return;
+		/* Patterns were renumbered: follow the playing position */
+		ft2_song_t *song = &inst->replayer.song;
+		song->pattNum = song->orders[song->songPos];
+		song->currNumRows = inst->replayer.patternNumRows[song->pattNum];
+		if (song->row >= song->currNumRows) song->row = song->currNumRows - 1;
 	}
 
-	ft2_stop_all_voices(inst);
-
-	if (trim->removeSamp) wipeSamplesUnused(inst, false, ai);
-	if (trim->removeSmpDataAfterLoop) wipeSmpDataAfterLoop(inst, false, ai);
-	if (trim->convSmpsTo8Bit) convertSamplesTo8bit(inst, false, ai);
-
-	if (trim->removeChans)
-	{
-		int16_t highestChan = -1;
-		for (int32_t i = 0; i < ap; i++)
-		{
-			ft2_note_t *pattPtr = inst->replayer.pattern[i];
-			if (!pattPtr) continue;
-			const int16_t numRows = inst->replayer.patternNumRows[i];
-			for (int32_t j = 0; j < numRows; j++)
-				for (int32_t k = 0; k < inst->replayer.song.numChannels; k++)
-				{
-					ft2_note_t *p = &pattPtr[(j * FT2_MAX_CHANNELS) + k];
-					if (p->note || p->vol || p->instr || p->efx || p->efxData)
-						if (k > highestChan) highestChan = k;
-				}
-		}
+	ft2_instr_t *removedInstrs[128];
+	const int32_t numRemovedInstrs = tb.instrsRemoved ? putInstruments(inst, &tb, removedInstrs) : 0;
 
-		if (highestChan >= 0)
-		{
-			highestChan++;
-			if (highestChan & 1) highestChan++;
-			if (highestChan < 2) highestChan = 2;
-			if (highestChan > inst->replayer.song.numChannels) highestChan = inst->replayer.song.numChannels;
-			inst->replayer.song.numChannels = (uint8_t)highestChan;
-		}
+	ft2_pattern_swap_end(inst);
 
-		if (inst->replayer.song.numChannels < FT2_MAX_CHANNELS)
-		{
-			for (int32_t i = 0; i < 256; i++)
-			{
-				ft2_note_t *p = inst->replayer.pattern[i];
-				if (!p) continue;
-				const int16_t numRows = inst->replayer.patternNumRows[i];
-				for (int32_t j = 0; j < numRows; j++)
-					memset(&p[(j * FT2_MAX_CHANNELS) + inst->replayer.song.numChannels], 0,
-					       sizeof(ft2_note_t) * (FT2_MAX_CHANNELS - inst->replayer.song.numChannels));
-			}
-		}
-	}
+	for (int32_t i = 0; i < 256; i++) free(oldPatts[i]);
+	for (int32_t i = 0; i < numRemovedInstrs; i++) freeRemovedInstr(removedInstrs[i]);
 
-	if (trim->removePatt) wipePattsUnused(inst, false, &ap);
-	if (trim->removeInst) wipeInstrUnused(inst, false, &ai, ap, inst->replayer.song.numChannels);
+	/* Samples and instruments moved to other slots */
+	if (trim->removeInst || trim->removeSamp)
+		clearSampleUndo(inst);
 
-	freeTmpInstruments();
 	ft2_song_mark_modified(inst);
 	pbTrimCalc(inst);
 
@@ -22,6 +22,13 @@ typedef struct ft2_trim_state_t {
 	bool removeChans, removeSmpDataAfterLoop, convSmpsTo8Bit;
 	int64_t xmSize64, xmAfterTrimSize64, spaceSaved64;
 	char byteFormatBuffer[64];
+
+	/* Size estimate scratch, filled by one pass over the patterns: packed
+	** size (0 if empty), channels in use and the instruments referenced
+	** (bit n = instrument n+1) of each pattern */
+	uint32_t pattPackLen[256];
+	uint8_t pattUsedChans[256];
+	uint8_t pattInstrs[256][16];
 } ft2_trim_state_t;
 
 /* Screen visibility */
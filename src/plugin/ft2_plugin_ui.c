@@ -25,6 +25,7 @@
 #include "ft2_plugin_wave_panel.h"
 #include "ft2_plugin_filter_panel.h"
 #include "ft2_plugin_smpfx.h"
+#include "ft2_plugin_sample_job.h"
 #include "ft2_plugin_instr_ed.h"
 #include "ft2_plugin_about.h"
 #include "ft2_plugin_input.h"
@@ -64,7 +65,7 @@ void ft2_ui_init(ft2_ui_t *ui)
 	memset(ui, 0, sizeof(ft2_ui_t));
 
 	ft2_video_init(&ui->video);
-	ui->bmpLoaded = ft2_bmp_load(&ui->bmp);
+	ui->bmpLoaded = ft2_bmp_acquire(&ui->bmp); /* Shared, decoded once per process */
 	ft2_input_init(&ui->input);
 
 	ft2_pattern_ed_init(&ui->patternEditor, &ui->video);
@@ -88,7 +89,11 @@ void ft2_ui_init(ft2_ui_t *ui)
 void ft2_ui_shutdown(ft2_ui_t *ui)
 {
 	if (!ui) return;
-	if (ui->bmpLoaded) { ft2_bmp_free(&ui->bmp); ui->bmpLoaded = false; }
+	ft2_sample_job_abort(&ui->sampleJob);
+	if (ui->bmpLoaded) { ft2_bmp_release(&ui->bmp); ui->bmpLoaded = false; }
+	ft2_pattern_ed_free(&ui->patternEditor);
+	ft2_undo_free(&ui->sampleEditor.undo);
+	ft2_scopes_free(&ui->scopes);
 	ft2_video_free(&ui->video);
 	ft2_textbox_free(&ui->textbox);
 }
@@ -176,6 +181,8 @@ void ft2_ui_draw(ft2_ui_t *ui, void *inst)
 	else if (ft2_dialog_is_active(&ui->dialog))
 		ft2_dialog_draw(&ui->dialog, video, bmp);
 
+	ft2_sample_job_draw(&ui->sampleJob, video, bmp);
+
 	ui->needsFullRedraw = false;
 	ft2_video_swap_buffers(video);
 }
@@ -208,7 +215,7 @@ static void handleRedrawing(ft2_ui_t *ui, ft2_instance_t *inst)
 			if (inst->uiState.nibblesHelpRequested)      { inst->uiState.nibblesHelpRequested = false; ft2_nibbles_show_help(inst, video, bmp); }
 			if (inst->uiState.nibblesHighScoreRequested) { inst->uiState.nibblesHighScoreRequested = false; ft2_nibbles_show_highscores(inst, video, bmp); }
 			if (inst->uiState.nibblesExitRequested)      { inst->uiState.nibblesExitRequested = false; ft2_nibbles_exit(inst, video, bmp); }
-			if (inst->uiState.nibblesRedrawRequested)    { inst->uiState.nibblesRedrawRequested = false; if (inst->nibbles.playing) ft2_nibbles_redraw(inst, video, bmp); }
+			if (inst->uiState.nibblesRedrawRequested)    { inst->uiState.nibblesRedrawRequested = false; if (inst->nibbles->playing) ft2_nibbles_redraw(inst, video, bmp); }
 			ft2_nibbles_tick(inst, video, bmp);
 		}
 		else
@@ -321,6 +328,18 @@ static void handleRedrawing(ft2_ui_t *ui, ft2_instance_t *inst)
 		if (inst->editor.textCursorBlinkCounter >= 16) inst->editor.textCursorBlinkCounter = 0;
 	}
 
+	/* Profile readout on the audio config tab, about four times a second */
+	if (inst->uiState.configScreenShown && inst->config.currConfigScreen == CONFIG_SCREEN_AUDIO &&
+	    ft2_profile_enabled(&inst->profile))
+	{
+		static uint32_t profileFrameCounter = 0;
+		if (++profileFrameCounter >= 15)
+		{
+			profileFrameCounter = 0;
+			drawConfigProfile(inst, video, bmp);
+		}
+	}
+
 	/* Play mode indicator */
 	if (bmp && !inst->uiState.diskOpShown && !inst->uiState.aboutScreenShown &&
 	    !inst->uiState.configScreenShown && !inst->uiState.helpScreenShown && !inst->uiState.nibblesShown)
@@ -347,10 +366,13 @@ void ft2_ui_update(ft2_ui_t *ui, void *inst)
 {
 	if (!ui) return;
 
+	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
+
 	ft2_input_update(&ui->input);
 	ft2_scopes_update(&ui->scopes, inst);
+	ft2_sample_job_poll(&ui->sampleJob);
+	ft2_sample_handoff_sync(ft2inst);
 
-	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
 	const ft2_bmp_t *bmp = ui->bmpLoaded ? &ui->bmp : NULL;
 	ft2_widgets_handle_held_down(&ui->widgets, ft2inst, &ui->video, bmp);
 
@@ -373,6 +395,13 @@ void ft2_ui_mouse_press(ft2_ui_t *ui, void *inst, int x, int y, bool leftButton,
 	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
 	int button = leftButton ? MOUSE_BUTTON_LEFT : (rightButton ? MOUSE_BUTTON_RIGHT : 0);
 
+	/* Any click stops a running sample job (like the echo tool panic) */
+	if (ft2_sample_job_is_busy(&ui->sampleJob))
+	{
+		ft2_sample_job_cancel(&ui->sampleJob);
+		return;
+	}
+
 	/* Modal panels */
 	if (ft2_modal_panel_is_any_active(ft2inst))
 	{
@@ -467,6 +496,8 @@ void ft2_ui_mouse_release(ft2_ui_t *ui, void *inst, int x, int y, int button)
 {
 	if (!ui) return;
 
+	if (ft2_sample_job_is_busy(&ui->sampleJob)) return;
+
 	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
 	const ft2_bmp_t *bmp = ui->bmpLoaded ? &ui->bmp : NULL;
 
@@ -519,6 +550,8 @@ void ft2_ui_mouse_wheel(ft2_ui_t *ui, void *inst, int x, int y, int delta, int m
 {
 	if (!ui) return;
 
+	if (ft2_sample_job_is_busy(&ui->sampleJob)) return;
+
 	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
 	ft2_input_mouse_wheel(&ui->input, delta);
 	if (!ft2inst) return;
@@ -658,6 +691,12 @@ void ft2_ui_key_press(ft2_ui_t *ui, void *inst, int key, int modifiers)
 	if (!ui) return;
 	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
 
+	if (ft2_sample_job_is_busy(&ui->sampleJob))
+	{
+		if (key == FT2_KEY_ESCAPE) ft2_sample_job_cancel(&ui->sampleJob);
+		return;
+	}
+
 	/* Modal panels with text input */
 	if (ft2_wave_panel_is_active(ft2inst)) { ft2_wave_panel_key_down(ft2inst, key); return; }
 	if (ft2_filter_panel_is_active(ft2inst)) { ft2_filter_panel_key_down(ft2inst, key); return; }
@@ -678,6 +717,7 @@ void ft2_ui_text_input(ft2_ui_t *ui, void *inst, char c)
 {
 	if (!ui) return;
 	ft2_instance_t *ft2inst = (ft2_instance_t *)inst;
+	if (ft2_sample_job_is_busy(&ui->sampleJob)) return;
 
 	if (ft2_wave_panel_is_active(ft2inst)) { ft2_wave_panel_char_input(ft2inst, c); return; }
 	if (ft2_filter_panel_is_active(ft2inst)) { ft2_filter_panel_char_input(ft2inst, c); return; }
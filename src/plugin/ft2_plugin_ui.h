@@ -22,6 +22,7 @@
 #include "ft2_plugin_palette.h"
 #include "ft2_plugin_help.h"
 #include "ft2_plugin_about.h"
+#include "ft2_plugin_sample_job.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,6 +67,7 @@ typedef struct ft2_ui_t {
 	int16_t currSample;
 	int16_t currOctave;
 	ft2_dialog_t dialog;
+	ft2_sample_job_t sampleJob;
 	bool needsFullRedraw;
 	bool paletteInitialized;
 } ft2_ui_t;
@@ -8,6 +8,7 @@
 #include <assert.h>
 #include "ft2_plugin_video.h"
 #include "ft2_plugin_bmp.h"
+#include "ft2_plugin_simd.h"
 
 /* Bounds checking macros (assert disabled in Release, explicit checks prevent heap corruption) */
 #define VIDEO_CHECK(v) do { if (!(v) || !(v)->frameBuffer) return; } while(0)
@@ -288,6 +289,118 @@ uint16_t textWidth16(const char *textPtr)
 	return w > 0 ? w - 1 : 0;
 }
 
+/* ------------------------------------------------------------------------- */
+/*                      GLYPH SPAN BLITTER                                   */
+/* ------------------------------------------------------------------------- */
+
+/* Pixels [x, x+w) of a packed font row as a bitmask (bit i = pixel x+i), w <= 32 */
+static inline uint32_t fontSpan(const uint64_t *row, uint32_t x, uint32_t w)
+{
+	const uint64_t *p = &row[x >> 6];
+	const uint32_t shift = x & 63;
+
+	uint64_t bits = p[0] >> shift;
+	if (shift != 0)
+		bits |= p[1] << (64 - shift);
+
+	return (uint32_t)bits & (uint32_t)((1ULL << w) - 1);
+}
+
+/* Writes color to dst[i] for every set bit i of mask (bits >= w must be clear) */
+static inline void spanOut(uint32_t *dst, uint32_t mask, uint32_t w, uint32_t color)
+{
+	uint32_t i = 0;
+
+#if defined(FT2_SIMD_SSE2)
+	const __m128i bitSel = _mm_setr_epi32(1, 2, 4, 8);
+	const __m128i c = _mm_set1_epi32((int32_t)color);
+	for (; i + 4 <= w && mask != 0; i += 4, mask >>= 4)
+	{
+		if ((mask & 15) == 0) continue;
+		const __m128i m = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int32_t)mask), bitSel), bitSel);
+		__m128i *p = (__m128i *)&dst[i];
+		_mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(m, c), _mm_andnot_si128(m, _mm_loadu_si128(p))));
+	}
+#elif defined(FT2_SIMD_NEON)
+	static const uint32_t bitSelTab[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bitSel = vld1q_u32(bitSelTab);
+	const uint32x4_t c = vdupq_n_u32(color);
+	for (; i + 4 <= w && mask != 0; i += 4, mask >>= 4)
+	{
+		if ((mask & 15) == 0) continue;
+		const uint32x4_t m = vtstq_u32(vdupq_n_u32(mask), bitSel);
+		vst1q_u32(&dst[i], vbslq_u32(m, c, vld1q_u32(&dst[i])));
+	}
+#else
+	(void)w;
+#endif
+
+	for (; mask != 0; i++, mask >>= 1)
+		if (mask & 1) dst[i] = color;
+}
+
+/* Writes fg/bg to dst[0..w) depending on the bits of mask */
+static inline void spanOutBg(uint32_t *dst, uint32_t mask, uint32_t w, uint32_t fg, uint32_t bg)
+{
+	uint32_t i = 0;
+
+#if defined(FT2_SIMD_SSE2)
+	const __m128i bitSel = _mm_setr_epi32(1, 2, 4, 8);
+	const __m128i f = _mm_set1_epi32((int32_t)fg), b = _mm_set1_epi32((int32_t)bg);
+	for (; i + 4 <= w; i += 4, mask >>= 4)
+	{
+		const __m128i m = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int32_t)mask), bitSel), bitSel);
+		_mm_storeu_si128((__m128i *)&dst[i], _mm_or_si128(_mm_and_si128(m, f), _mm_andnot_si128(m, b)));
+	}
+#elif defined(FT2_SIMD_NEON)
+	static const uint32_t bitSelTab[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bitSel = vld1q_u32(bitSelTab);
+	const uint32x4_t f = vdupq_n_u32(fg), b = vdupq_n_u32(bg);
+	for (; i + 4 <= w; i += 4, mask >>= 4)
+		vst1q_u32(&dst[i], vbslq_u32(vtstq_u32(vdupq_n_u32(mask), bitSel), f, b));
+#endif
+
+	for (; i < w; i++, mask >>= 1)
+		dst[i] = (mask & 1) ? fg : bg;
+}
+
+/* Draws a w*h block of a packed font (any width, e.g. several glyphs at once) */
+void glyphOut(ft2_video_t *video, const ft2_font_bits_t *font, uint32_t srcX, uint32_t srcY,
+	uint32_t w, uint32_t h, uint32_t xPos, uint32_t yPos, uint32_t color)
+{
+	if (font->bits == NULL) return;
+
+	const uint64_t *row = &font->bits[srcY * font->wordsPerRow];
+	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
+
+	for (uint32_t y = 0; y < h; y++, row += font->wordsPerRow, dstPtr += SCREEN_W)
+	{
+		for (uint32_t x = 0; x < w; x += 32)
+		{
+			const uint32_t n = MIN(w - x, 32);
+			spanOut(&dstPtr[x], fontSpan(row, srcX + x, n), n, color);
+		}
+	}
+}
+
+void glyphOutBg(ft2_video_t *video, const ft2_font_bits_t *font, uint32_t srcX, uint32_t srcY,
+	uint32_t w, uint32_t h, uint32_t xPos, uint32_t yPos, uint32_t fg, uint32_t bg)
+{
+	if (font->bits == NULL) return;
+
+	const uint64_t *row = &font->bits[srcY * font->wordsPerRow];
+	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
+
+	for (uint32_t y = 0; y < h; y++, row += font->wordsPerRow, dstPtr += SCREEN_W)
+	{
+		for (uint32_t x = 0; x < w; x += 32)
+		{
+			const uint32_t n = MIN(w - x, 32);
+			spanOutBg(&dstPtr[x], fontSpan(row, srcX + x, n), n, fg, bg);
+		}
+	}
+}
+
 /* ------------------------------------------------------------------------- */
 /*                      CHARACTER OUTPUT                                     */
 /* ------------------------------------------------------------------------- */
@@ -303,13 +416,7 @@ void charOut(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t y
 	SANITIZE_CHAR(chr);
 	if (chr == ' ') return;
 
-	const uint32_t pixVal = video->palette[paletteIndex];
-	const uint8_t *srcPtr = &bmp->font1[chr * FONT1_CHAR_W];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-
-	for (uint32_t y = 0; y < FONT1_CHAR_H; y++, srcPtr += FONT1_WIDTH, dstPtr += SCREEN_W)
-		for (uint32_t x = 0; x < FONT1_CHAR_W; x++)
-			if (srcPtr[x]) dstPtr[x] = pixVal;
+	glyphOut(video, &bmp->font1Bits, chr * FONT1_CHAR_W, 0, FONT1_CHAR_W, FONT1_CHAR_H, xPos, yPos, video->palette[paletteIndex]);
 }
 
 void charOutBg(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yPos, uint8_t fgPalette, uint8_t bgPalette, char chr)
@@ -320,12 +427,8 @@ void charOutBg(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t
 	SANITIZE_CHAR(chr);
 	if (chr == ' ') return;
 
-	const uint32_t fg = video->palette[fgPalette], bg = video->palette[bgPalette];
-	const uint8_t *srcPtr = &bmp->font1[chr * FONT1_CHAR_W];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-
-	for (int32_t y = 0; y < FONT1_CHAR_H; y++, srcPtr += FONT1_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT1_CHAR_W-1; x++) dstPtr[x] = srcPtr[x] ? fg : bg;
+	glyphOutBg(video, &bmp->font1Bits, chr * FONT1_CHAR_W, 0, FONT1_CHAR_W-1, FONT1_CHAR_H, xPos, yPos,
+		video->palette[fgPalette], video->palette[bgPalette]);
 }
 
 void charOutOutlined(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t x, uint16_t y, uint8_t paletteIndex, char chr)
@@ -345,14 +448,9 @@ void charOutShadow(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint
 	SANITIZE_CHAR(chr);
 	if (chr == ' ') return;
 
-	const uint32_t pixVal1 = video->palette[paletteIndex], pixVal2 = video->palette[shadowPaletteIndex];
-	const uint8_t *srcPtr = &bmp->font1[chr * FONT1_CHAR_W];
-	uint32_t *dstPtr1 = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	uint32_t *dstPtr2 = dstPtr1 + (SCREEN_W+1);
-
-	for (int32_t y = 0; y < FONT1_CHAR_H; y++, srcPtr += FONT1_WIDTH, dstPtr1 += SCREEN_W, dstPtr2 += SCREEN_W)
-		for (int32_t x = 0; x < FONT1_CHAR_W; x++)
-			if (srcPtr[x]) { dstPtr2[x] = pixVal2; dstPtr1[x] = pixVal1; }
+	/* Shadow first: a glyph pixel always wins over the shadow of the pixel above-left */
+	glyphOut(video, &bmp->font1Bits, chr * FONT1_CHAR_W, 0, FONT1_CHAR_W, FONT1_CHAR_H, xPos + 1, yPos + 1, video->palette[shadowPaletteIndex]);
+	glyphOut(video, &bmp->font1Bits, chr * FONT1_CHAR_W, 0, FONT1_CHAR_W, FONT1_CHAR_H, xPos, yPos, video->palette[paletteIndex]);
 }
 
 void charOutClipX(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, char chr, uint16_t clipX)
@@ -365,14 +463,8 @@ void charOutClipX(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint1
 	SANITIZE_CHAR(chr);
 	if (chr == ' ') return;
 
-	const uint32_t pixVal = video->palette[paletteIndex];
-	const uint8_t *srcPtr = &bmp->font1[chr * FONT1_CHAR_W];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	int32_t width = (xPos + FONT1_CHAR_W > clipX) ? FONT1_CHAR_W - ((xPos + FONT1_CHAR_W) - clipX) : FONT1_CHAR_W;
-
-	for (int32_t y = 0; y < FONT1_CHAR_H; y++, srcPtr += FONT1_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < width; x++)
-			if (srcPtr[x]) dstPtr[x] = pixVal;
+	const int32_t width = (xPos + FONT1_CHAR_W > clipX) ? FONT1_CHAR_W - ((xPos + FONT1_CHAR_W) - clipX) : FONT1_CHAR_W;
+	glyphOut(video, &bmp->font1Bits, chr * FONT1_CHAR_W, 0, width, FONT1_CHAR_H, xPos, yPos, video->palette[paletteIndex]);
 }
 
 void bigCharOut(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, char chr)
@@ -383,13 +475,7 @@ void bigCharOut(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_
 	SANITIZE_CHAR(chr);
 	if (chr == ' ') return;
 
-	const uint8_t *srcPtr = &bmp->font2[chr * FONT2_CHAR_W];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	const uint32_t pixVal = video->palette[paletteIndex];
-
-	for (int32_t y = 0; y < FONT2_CHAR_H; y++, srcPtr += FONT2_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT2_CHAR_W; x++)
-			if (srcPtr[x]) dstPtr[x] = pixVal;
+	glyphOut(video, &bmp->font2Bits, chr * FONT2_CHAR_W, 0, FONT2_CHAR_W, FONT2_CHAR_H, xPos, yPos, video->palette[paletteIndex]);
 }
 
 static void bigCharOutShadow(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, uint8_t shadowPaletteIndex, char chr)
@@ -400,14 +486,8 @@ static void bigCharOutShadow(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t
 	SANITIZE_CHAR(chr);
 	if (chr == ' ') return;
 
-	const uint32_t pixVal1 = video->palette[paletteIndex], pixVal2 = video->palette[shadowPaletteIndex];
-	const uint8_t *srcPtr = &bmp->font2[chr * FONT2_CHAR_W];
-	uint32_t *dstPtr1 = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	uint32_t *dstPtr2 = dstPtr1 + (SCREEN_W+1);
-
-	for (int32_t y = 0; y < FONT2_CHAR_H; y++, srcPtr += FONT2_WIDTH, dstPtr1 += SCREEN_W, dstPtr2 += SCREEN_W)
-		for (int32_t x = 0; x < FONT2_CHAR_W; x++)
-			if (srcPtr[x]) { dstPtr2[x] = pixVal2; dstPtr1[x] = pixVal1; }
+	glyphOut(video, &bmp->font2Bits, chr * FONT2_CHAR_W, 0, FONT2_CHAR_W, FONT2_CHAR_H, xPos + 1, yPos + 1, video->palette[shadowPaletteIndex]);
+	glyphOut(video, &bmp->font2Bits, chr * FONT2_CHAR_W, 0, FONT2_CHAR_W, FONT2_CHAR_H, xPos, yPos, video->palette[paletteIndex]);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -470,20 +550,15 @@ void textOutTiny(ft2_video_t *video, const ft2_bmp_t *bmp, int32_t xPos, int32_t
 	if (!bmp || !bmp->font3 || !str || xPos < 0 || yPos < 0) return;
 	if (xPos + (int32_t)(strlen(str) * FONT3_CHAR_W) > SCREEN_W || yPos + FONT3_CHAR_H > SCREEN_H) return;
 
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-	while (*str)
+	for (; *str; xPos += FONT3_CHAR_W)
 	{
 		char chr = *str++;
 		if (chr >= '0' && chr <= '9') chr -= '0';
 		else if (chr >= 'a' && chr <= 'z') chr = chr - 'a' + 10;
 		else if (chr >= 'A' && chr <= 'Z') chr = chr - 'A' + 10;
-		else { dstPtr += FONT3_CHAR_W; continue; }
+		else continue;
 
-		const uint8_t *srcPtr = &bmp->font3[chr * FONT3_CHAR_W];
-		for (int32_t y = 0; y < FONT3_CHAR_H; y++, srcPtr += FONT3_WIDTH, dstPtr += SCREEN_W)
-			for (int32_t x = 0; x < FONT3_CHAR_W; x++)
-				if (srcPtr[x]) dstPtr[x] = color;
-		dstPtr -= (SCREEN_W * FONT3_CHAR_H) - FONT3_CHAR_W;
+		glyphOut(video, &bmp->font3Bits, chr * FONT3_CHAR_W, 0, FONT3_CHAR_W, FONT3_CHAR_H, xPos, yPos, color);
 	}
 }
 
@@ -508,16 +583,8 @@ void hexOut(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yP
 	if (!bmp || !bmp->font6) return;
 
 	const uint32_t pixVal = video->palette[paletteIndex];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-
-	for (int32_t i = numDigits-1; i >= 0; i--)
-	{
-		const uint8_t *srcPtr = &bmp->font6[((val >> (i * 4)) & 15) * FONT6_CHAR_W];
-		for (int32_t y = 0; y < FONT6_CHAR_H; y++, srcPtr += FONT6_WIDTH, dstPtr += SCREEN_W)
-			for (int32_t x = 0; x < FONT6_CHAR_W; x++)
-				if (srcPtr[x]) dstPtr[x] = pixVal;
-		dstPtr -= (SCREEN_W * FONT6_CHAR_H) - FONT6_CHAR_W;
-	}
+	for (int32_t i = numDigits-1; i >= 0; i--, xPos += FONT6_CHAR_W)
+		glyphOut(video, &bmp->font6Bits, ((val >> (i * 4)) & 15) * FONT6_CHAR_W, 0, FONT6_CHAR_W, FONT6_CHAR_H, xPos, yPos, pixVal);
 }
 
 void hexOutBg(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yPos, uint8_t fgPalette, uint8_t bgPalette, uint32_t val, uint8_t numDigits)
@@ -527,15 +594,8 @@ void hexOutBg(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t
 	if (!bmp || !bmp->font6) return;
 
 	const uint32_t fg = video->palette[fgPalette], bg = video->palette[bgPalette];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-
-	for (int32_t i = numDigits-1; i >= 0; i--)
-	{
-		const uint8_t *srcPtr = &bmp->font6[((val >> (i * 4)) & 15) * FONT6_CHAR_W];
-		for (int32_t y = 0; y < FONT6_CHAR_H; y++, srcPtr += FONT6_WIDTH, dstPtr += SCREEN_W)
-			for (int32_t x = 0; x < FONT6_CHAR_W; x++) dstPtr[x] = srcPtr[x] ? fg : bg;
-		dstPtr -= (SCREEN_W * FONT6_CHAR_H) - FONT6_CHAR_W;
-	}
+	for (int32_t i = numDigits-1; i >= 0; i--, xPos += FONT6_CHAR_W)
+		glyphOutBg(video, &bmp->font6Bits, ((val >> (i * 4)) & 15) * FONT6_CHAR_W, 0, FONT6_CHAR_W, FONT6_CHAR_H, xPos, yPos, fg, bg);
 }
 
 void hexOutShadow(ft2_video_t *video, const ft2_bmp_t *bmp, uint16_t xPos, uint16_t yPos, uint8_t paletteIndex, uint8_t shadowPaletteIndex, uint32_t val, uint8_t numDigits)
@@ -550,14 +610,6 @@ void pattTwoHexOut(ft2_video_t *video, const ft2_bmp_t *bmp, uint32_t xPos, uint
 	if (!video || !video->frameBuffer || !bmp || !bmp->font4) return;
 	if (xPos + (FONT4_CHAR_W * 2) > SCREEN_W || yPos + FONT4_CHAR_H > SCREEN_H) return;
 
-	const uint8_t *ch1Ptr = &bmp->font4[(val >> 4) * FONT4_CHAR_W];
-	const uint8_t *ch2Ptr = &bmp->font4[(val & 0x0F) * FONT4_CHAR_W];
-	uint32_t *dstPtr = &video->frameBuffer[(yPos * SCREEN_W) + xPos];
-
-	for (int32_t y = 0; y < FONT4_CHAR_H; y++, ch1Ptr += FONT4_WIDTH, ch2Ptr += FONT4_WIDTH, dstPtr += SCREEN_W)
-		for (int32_t x = 0; x < FONT4_CHAR_W; x++)
-		{
-			if (ch1Ptr[x]) dstPtr[x] = color;
-			if (ch2Ptr[x]) dstPtr[FONT4_CHAR_W + x] = color;
-		}
+	glyphOut(video, &bmp->font4Bits, (val >> 4) * FONT4_CHAR_W, 0, FONT4_CHAR_W, FONT4_CHAR_H, xPos, yPos, color);
+	glyphOut(video, &bmp->font4Bits, (val & 0x0F) * FONT4_CHAR_W, 0, FONT4_CHAR_W, FONT4_CHAR_H, xPos + FONT4_CHAR_W, yPos, color);
 }
@@ -100,6 +100,14 @@ void blitClipX(ft2_video_t *video, uint16_t xPos, uint16_t yPos, const uint8_t *
 void blitFast(ft2_video_t *video, uint16_t xPos, uint16_t yPos, const uint8_t *srcPtr, uint16_t w, uint16_t h);
 void blitFastClipX(ft2_video_t *video, uint16_t xPos, uint16_t yPos, const uint8_t *srcPtr, uint16_t w, uint16_t h, uint16_t clipX);
 
+/* Glyph blitter: draws a w*h block of a bit-packed font at (srcX, srcY)
+ * (transparent / opaque background). No clipping, callers check bounds. */
+struct ft2_font_bits_t;
+void glyphOut(ft2_video_t *video, const struct ft2_font_bits_t *font, uint32_t srcX, uint32_t srcY,
+	uint32_t w, uint32_t h, uint32_t xPos, uint32_t yPos, uint32_t color);
+void glyphOutBg(ft2_video_t *video, const struct ft2_font_bits_t *font, uint32_t srcX, uint32_t srcY,
+	uint32_t w, uint32_t h, uint32_t xPos, uint32_t yPos, uint32_t fg, uint32_t bg);
+
 /* Text width */
 uint8_t charWidth(char ch);
 uint8_t charWidth16(char ch);
@@ -253,8 +253,8 @@ static void applyVolumeToSample(ft2_instance_t *inst)
 	const int32_t len = x2 - x1;
 	if (state->startVol == 100.0 && state->endVol == 100.0) return;
 
-	ft2_stop_sample_voices(inst, s);
-	ft2_unfix_sample(s);
+	ft2_sample_edit_begin(inst, s);
+	if (!ft2_unfix_sample(s)) return;
 
 	const bool ramp = (state->startVol != state->endVol);
 	const double dVolDelta = ramp ? ((state->endVol - state->startVol) / 100.0) / len : 0.0;
@@ -283,22 +283,14 @@ static void applyVolumeToSample(ft2_instance_t *inst)
 	inst->uiState.updateSampleEditor = true;
 }
 
-static double calculateMaxScale(ft2_instance_t *inst)
+/* Largest magnitude in data[x1, x2) as stored */
+static int32_t peakOfData(const ft2_sample_t *s, int32_t x1, int32_t x2)
 {
-	ft2_sample_t *s = getCurrentSample(inst);
-	if (!s || !s->dataPtr || !s->length) return 100.0;
-
-	int32_t x1, x2;
-	if (!getRange(inst, s, &x1, &x2)) return 100.0;
-	uint32_t len = x2 - x1;
-
-	ft2_unfix_sample(s);
-
 	int32_t maxAmp = 0;
 	if (s->flags & FT2_SAMPLE_16BIT)
 	{
-		const int16_t *ptr = (const int16_t *)s->dataPtr + x1;
-		for (uint32_t i = 0; i < len; i++)
+		const int16_t *ptr = (const int16_t *)s->dataPtr;
+		for (int32_t i = x1; i < x2; i++)
 		{
 			int32_t a = (ptr[i] < 0) ? -ptr[i] : ptr[i];
 			if (a > maxAmp) maxAmp = a;
@@ -306,15 +298,48 @@ static double calculateMaxScale(ft2_instance_t *inst)
 	}
 	else
 	{
-		const int8_t *ptr = s->dataPtr + x1;
-		for (uint32_t i = 0; i < len; i++)
+		const int8_t *ptr = s->dataPtr;
+		for (int32_t i = x1; i < x2; i++)
 		{
 			int32_t a = (ptr[i] < 0) ? -ptr[i] : ptr[i];
 			if (a > maxAmp) maxAmp = a;
 		}
 	}
+	return maxAmp;
+}
 
-	ft2_fix_sample(s);
+/* Only reads the sample, so a buffer shared with another instance isn't
+ * copied just to find its peak. Where ft2_fix_sample() wrote loop taps
+ * after the loop end, the sample's own values are in fixedSmp. */
+static double calculateMaxScale(ft2_instance_t *inst)
+{
+	ft2_sample_t *s = getCurrentSample(inst);
+	if (!s || !s->dataPtr || !s->length) return 100.0;
+
+	int32_t x1, x2;
+	if (!getRange(inst, s, &x1, &x2)) return 100.0;
+
+	int32_t maxAmp;
+	const int32_t fixStart = s->fixedPos, fixEnd = s->fixedPos + FT2_MAX_RIGHT_TAPS;
+	if (s->isFixed && fixStart < x2 && fixEnd > x1)
+	{
+		const int32_t a = peakOfData(s, x1, fixStart);
+		const int32_t b = peakOfData(s, fixEnd, x2);
+		maxAmp = (a > b) ? a : b;
+
+		const int32_t from = (x1 > fixStart) ? x1 : fixStart;
+		const int32_t to = (x2 < fixEnd) ? x2 : fixEnd;
+		for (int32_t i = from; i < to; i++)
+		{
+			int32_t v = s->fixedSmp[i - fixStart];
+			if (v < 0) v = -v;
+			if (v > maxAmp) maxAmp = v;
+		}
+	}
+	else
+	{
+		maxAmp = peakOfData(s, x1, x2);
+	}
 
 	double scale = 100.0;
 	if (maxAmp > 0)
@@ -17,6 +17,7 @@
 #include "ft2_plugin_input.h"
 #include "ft2_plugin_replayer.h"
 #include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_pool.h"
 #include "../ft2_instance.h"
 
 #ifndef M_PI
@@ -41,9 +42,9 @@ static ft2_sample_t *setupNewSample(ft2_instance_t *inst, int32_t length)
 	}
 
 	ft2_sample_t *s = &instr->smp[inst->editor.curSmp];
-	ft2_stop_sample_voices(inst, s);
+	ft2_sample_edit_begin(inst, s);
 
-	if (s->origDataPtr) { free(s->origDataPtr); s->origDataPtr = NULL; s->dataPtr = NULL; }
+	if (s->origDataPtr) { ft2_sample_pool_release(s->origDataPtr); s->origDataPtr = NULL; s->dataPtr = NULL; }
 
 	int32_t allocLen = (length * 2) + 64;
 	s->origDataPtr = (int8_t *)malloc(allocLen);
@@ -0,0 +1,234 @@
+/**
+ * @file ft2_plugin_workers.c
+ * @brief Process-wide worker thread pool for parallel batch jobs.
+ *
+ * Jobs are handed out one index at a time under the pool lock, so callers
+ * should order expensive jobs first for good load balancing.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_plugin_workers.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+typedef HANDLE workerThread_t;
+typedef CRITICAL_SECTION workerMutex_t;
+typedef CONDITION_VARIABLE workerCond_t;
+#define mutexInit(m)      InitializeCriticalSection(m)
+#define mutexDestroy(m)   DeleteCriticalSection(m)
+#define mutexLock(m)      EnterCriticalSection(m)
+#define mutexUnlock(m)    LeaveCriticalSection(m)
+#define condInit(c)       InitializeConditionVariable(c)
+#define condDestroy(c)    ((void)(c))
+#define condWait(c, m)    SleepConditionVariableCS(c, m, INFINITE)
+#define condSignal(c)     WakeConditionVariable(c)
+#define condBroadcast(c)  WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t workerThread_t;
+typedef pthread_mutex_t workerMutex_t;
+typedef pthread_cond_t workerCond_t;
+#define mutexInit(m)      pthread_mutex_init(m, NULL)
+#define mutexDestroy(m)   pthread_mutex_destroy(m)
+#define mutexLock(m)      pthread_mutex_lock(m)
+#define mutexUnlock(m)    pthread_mutex_unlock(m)
+#define condInit(c)       pthread_cond_init(c, NULL)
+#define condDestroy(c)    pthread_cond_destroy(c)
+#define condWait(c, m)    pthread_cond_wait(c, m)
+#define condSignal(c)     pthread_cond_signal(c)
+#define condBroadcast(c)  pthread_cond_broadcast(c)
+#endif
+
+typedef struct workerPool_t {
+	bool initialized, started, quit;
+	int32_t refCount, numThreads;
+	workerThread_t threads[FT2_WORKERS_MAX_THREADS - 1];
+
+	workerMutex_t runLock; /* Serializes batches */
+	workerMutex_t lock;    /* Guards the batch state below */
+	workerCond_t wake, done;
+
+	ft2_worker_func_t func;
+	void *userData;
+	int32_t numJobs, nextJob, jobsDone;
+} workerPool_t;
+
+static workerPool_t g_pool;
+
+static int32_t getNumCPUs(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int32_t)info.dwNumberOfProcessors;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n < 1) ? 1 : (int32_t)n;
+#endif
+}
+
+/* Takes and runs jobs until the batch is exhausted. Called with lock held. */
+static void drainJobs(void)
+{
+	while (g_pool.nextJob < g_pool.numJobs) {
+		const int32_t jobIndex = g_pool.nextJob++;
+		ft2_worker_func_t func = g_pool.func;
+		void *userData = g_pool.userData;
+
+		mutexUnlock(&g_pool.lock);
+		func(userData, jobIndex);
+		mutexLock(&g_pool.lock);
+
+		if (++g_pool.jobsDone == g_pool.numJobs)
+			condBroadcast(&g_pool.done);
+	}
+}
+
+#ifdef _WIN32
+static DWORD WINAPI workerMain(LPVOID arg)
+#else
+static void *workerMain(void *arg)
+#endif
+{
+	(void)arg;
+
+	mutexLock(&g_pool.lock);
+	for (;;) {
+		while (!g_pool.quit && g_pool.nextJob >= g_pool.numJobs)
+			condWait(&g_pool.wake, &g_pool.lock);
+
+		if (g_pool.quit)
+			break;
+
+		drainJobs();
+	}
+	mutexUnlock(&g_pool.lock);
+	return 0;
+}
+
+/* Starts worker threads on first batch. Called with runLock held. */
+static void startThreads(void)
+{
+	g_pool.started = true;
+
+	int32_t numThreads = getNumCPUs() - 1;
+	if (numThreads > FT2_WORKERS_MAX_THREADS - 1)
+		numThreads = FT2_WORKERS_MAX_THREADS - 1;
+
+	g_pool.numThreads = 0;
+	for (int32_t i = 0; i < numThreads; i++) {
+#ifdef _WIN32
+		g_pool.threads[i] = CreateThread(NULL, 0, workerMain, NULL, 0, NULL);
+		if (g_pool.threads[i] == NULL)
+			break;
+#else
+		if (pthread_create(&g_pool.threads[i], NULL, workerMain, NULL) != 0)
+			break;
+#endif
+		g_pool.numThreads++;
+	}
+}
+
+static void stopThreads(void)
+{
+	mutexLock(&g_pool.lock);
+	g_pool.quit = true;
+	condBroadcast(&g_pool.wake);
+	mutexUnlock(&g_pool.lock);
+
+	for (int32_t i = 0; i < g_pool.numThreads; i++) {
+#ifdef _WIN32
+		WaitForSingleObject(g_pool.threads[i], INFINITE);
+		CloseHandle(g_pool.threads[i]);
+#else
+		pthread_join(g_pool.threads[i], NULL);
+#endif
+	}
+
+	g_pool.numThreads = 0;
+	g_pool.started = false;
+	g_pool.quit = false;
+}
+
+bool ft2_workers_init(void)
+{
+	if (g_pool.initialized) {
+		g_pool.refCount++;
+		return true;
+	}
+
+	memset(&g_pool, 0, sizeof(g_pool));
+	mutexInit(&g_pool.runLock);
+	mutexInit(&g_pool.lock);
+	condInit(&g_pool.wake);
+	condInit(&g_pool.done);
+	g_pool.initialized = true;
+	g_pool.refCount = 1;
+	return true;
+}
+
+void ft2_workers_free(void)
+{
+	if (!g_pool.initialized) return;
+	g_pool.refCount--;
+	if (g_pool.refCount > 0) return;
+
+	if (g_pool.started)
+		stopThreads();
+
+	condDestroy(&g_pool.done);
+	condDestroy(&g_pool.wake);
+	mutexDestroy(&g_pool.lock);
+	mutexDestroy(&g_pool.runLock);
+	g_pool.initialized = false;
+}
+
+int32_t ft2_workers_get_concurrency(void)
+{
+	if (!g_pool.initialized)
+		return 1;
+
+	if (!g_pool.started) {
+		int32_t n = getNumCPUs();
+		return (n > FT2_WORKERS_MAX_THREADS) ? FT2_WORKERS_MAX_THREADS : n;
+	}
+
+	return g_pool.numThreads + 1;
+}
+
+void ft2_workers_run(ft2_worker_func_t func, void *userData, int32_t numJobs)
+{
+	if (func == NULL || numJobs <= 0)
+		return;
+
+	if (!g_pool.initialized || numJobs == 1) {
+		for (int32_t i = 0; i < numJobs; i++)
+			func(userData, i);
+		return;
+	}
+
+	mutexLock(&g_pool.runLock);
+	if (!g_pool.started)
+		startThreads();
+
+	mutexLock(&g_pool.lock);
+	g_pool.func = func;
+	g_pool.userData = userData;
+	g_pool.numJobs = numJobs;
+	g_pool.nextJob = 0;
+	g_pool.jobsDone = 0;
+	condBroadcast(&g_pool.wake);
+
+	drainJobs();
+	while (g_pool.jobsDone < g_pool.numJobs)
+		condWait(&g_pool.done, &g_pool.lock);
+
+	g_pool.func = NULL;
+	g_pool.userData = NULL;
+	g_pool.numJobs = g_pool.nextJob = g_pool.jobsDone = 0;
+	mutexUnlock(&g_pool.lock);
+	mutexUnlock(&g_pool.runLock);
+}
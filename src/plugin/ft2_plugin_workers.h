@@ -0,0 +1,38 @@
+/**
+ * @file ft2_plugin_workers.h
+ * @brief Process-wide worker thread pool for parallel batch jobs.
+ *
+ * One pool is shared by all plugin instances (reference counted, like the
+ * interpolation tables). Threads are started on first use and sleep on a
+ * condition variable while idle. A batch runs a job function over an index
+ * range; the calling thread participates and returns when all jobs are done.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FT2_WORKERS_MAX_THREADS 8
+
+typedef void (*ft2_worker_func_t)(void *userData, int32_t jobIndex);
+
+/* Init/free (reference counted, call from instance create/destroy) */
+bool ft2_workers_init(void);
+void ft2_workers_free(void);
+
+/* Number of threads that execute a batch, including the caller */
+int32_t ft2_workers_get_concurrency(void);
+
+/* Runs func(userData, 0..numJobs-1) across the pool and blocks until all
+ * jobs have finished. Batches from different threads are serialized.
+ * Falls back to running inline if the pool is unavailable. */
+void ft2_workers_run(ft2_worker_func_t func, void *userData, int32_t numJobs);
+
+#ifdef __cplusplus
+}
+#endif
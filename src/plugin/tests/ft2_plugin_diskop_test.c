@@ -0,0 +1,173 @@
+/**
+ * @file ft2_plugin_diskop_test.c
+ * @brief Module saving: the streaming writer against ft2_save_module().
+ *
+ * A synthetic module with every sample type and each corpus module, saved
+ * to one buffer and through the stream. The stream must carry the same
+ * bytes, in chunks of at most FT2_SAVE_CHUNK_SIZE, and
+ * ft2_save_module_size() must know the size up front. A decoded ADPCM
+ * sample must save as plain 8-bit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_test.h"
+#include "ft2_plugin_diskop.h"
+#include "ft2_plugin_loader.h"
+#include "ft2_plugin_replayer.h"
+
+#define SAVE_SMP_LEN (1 << 20)
+#define ADPCM_SMP_LEN 1001
+
+typedef struct saveSink_t {
+	uint64_t hash;
+	uint32_t bytes, maxChunk;
+} saveSink_t;
+
+static bool saveSinkWrite(void *userData, const uint8_t *data, uint32_t size)
+{
+	saveSink_t *sink = (saveSink_t *)userData;
+	sink->hash = ft2_test_hash(sink->hash, data, size);
+	sink->bytes += size;
+	if (size > sink->maxChunk)
+		sink->maxChunk = size;
+	return true;
+}
+
+static void testSave(ft2_instance_t *inst, const char *name)
+{
+	uint8_t *data = NULL;
+	uint32_t size = 0, written = 0;
+	if (!FT2_TEST_CHECK(ft2_save_module(inst, &data, &size), "%s: save failed", name))
+		return;
+	const uint64_t bufferHash = ft2_test_hash(FT2_TEST_HASH_INIT, data, size);
+	free(data);
+
+	saveSink_t sink;
+	memset(&sink, 0, sizeof(sink));
+	sink.hash = FT2_TEST_HASH_INIT;
+	if (FT2_TEST_CHECK(ft2_save_module_stream(inst, saveSinkWrite, &sink, &written), "%s: stream failed", name)) {
+		FT2_TEST_CHECK(written == size && sink.bytes == size && sink.hash == bufferHash,
+			"%s: the stream differs from the buffer (%u/%u of %u bytes)", name, written, sink.bytes, size);
+		FT2_TEST_CHECK(sink.maxChunk <= FT2_SAVE_CHUNK_SIZE, "%s: %u-byte chunk", name, sink.maxChunk);
+	}
+	FT2_TEST_CHECK(ft2_save_module_size(inst) == size, "%s: size is %u, not %u", name, ft2_save_module_size(inst), size);
+
+	char key[128];
+	snprintf(key, sizeof(key), "save:%s", name);
+	ft2_test_check_hash(key, bufferHash);
+}
+
+static bool sameSample(const ft2_sample_t *a, const ft2_sample_t *b)
+{
+	return a->length == b->length && a->flags == b->flags && a->dataPtr != NULL && b->dataPtr != NULL
+		&& memcmp(a->dataPtr, b->dataPtr, (size_t)a->length) == 0;
+}
+
+/* A ModPlug ADPCM sample (name length 0xAD, a 16-byte delta table, then
+ * two 4-bit deltas per byte) is decoded to plain 8-bit on load. The
+ * loader's ADPCM flag must go with it, or the module saves with flag 64
+ * set and loads back as ADPCM again. */
+static void testAdpcm(void)
+{
+	uint8_t *xm = NULL, *resaved = NULL, *resavedAgain = NULL;
+	uint32_t xmSize = 0, resavedSize = 0, resavedAgainSize = 0;
+
+	/* The sample is the last thing in an XM with one instrument and one
+	 * sample, so the saved data can be swapped for ADPCM data */
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	bool ok = inst != NULL && ft2_instance_alloc_instr(inst, 1) && ft2_pattern_alloc(inst, 0);
+	if (ok) {
+		ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+		s->origDataPtr = (int8_t *)calloc(1, ADPCM_SMP_LEN + FT2_MAX_TAPS * 2);
+		ok = s->origDataPtr != NULL;
+		if (ok) {
+			s->dataPtr = s->origDataPtr + FT2_MAX_TAPS;
+			s->length = ADPCM_SMP_LEN;
+			ft2_fix_sample(s);
+			ok = ft2_save_module(inst, &xm, &xmSize);
+		}
+	}
+	ft2_instance_destroy(inst);
+
+	const uint32_t headerPos = xmSize - ADPCM_SMP_LEN - 40;
+	ok = ok && xmSize > ADPCM_SMP_LEN + 40 && xm[headerPos] == (ADPCM_SMP_LEN & 0xFF)
+		&& xm[headerPos + 1] == (ADPCM_SMP_LEN >> 8);
+
+	const uint32_t adpcmBytes = 16 + (ADPCM_SMP_LEN + 1) / 2;
+	const uint32_t fileSize = xmSize - ADPCM_SMP_LEN + adpcmBytes;
+	uint8_t *file = ok ? (uint8_t *)malloc(fileSize) : NULL;
+	int8_t expected[ADPCM_SMP_LEN + 1];
+	if (!FT2_TEST_CHECK(file != NULL, "adpcm: can't set up")) {
+		free(xm);
+		return;
+	}
+
+	memcpy(file, xm, headerPos + 40);
+	file[headerPos + 17] = 0xAD;
+
+	uint8_t *lut = &file[headerPos + 40], *nibbles = lut + 16;
+	for (int32_t i = 0; i < 16; i++)
+		lut[i] = (uint8_t)(int8_t)((i - 8) * 5);
+
+	uint32_t seed = 0x2468ACEu;
+	int8_t cur = 0;
+	for (int32_t i = 0; i < (ADPCM_SMP_LEN + 1) / 2; i++) {
+		seed = seed * 1103515245u + 12345u;
+		nibbles[i] = (uint8_t)(seed >> 24);
+		cur += (int8_t)lut[nibbles[i] & 0x0F];
+		expected[i * 2] = cur;
+		cur += (int8_t)lut[nibbles[i] >> 4];
+		expected[i * 2 + 1] = cur;
+	}
+
+	ft2_instance_t *loaded = ft2_instance_create(48000);
+	ft2_instance_t *reloaded = ft2_instance_create(48000);
+	if (FT2_TEST_CHECK(loaded != NULL && reloaded != NULL && ft2_load_module(loaded, file, fileSize)
+		&& loaded->replayer.instr[1] != NULL, "adpcm: load failed")) {
+		const ft2_sample_t *s = &loaded->replayer.instr[1]->smp[0];
+		FT2_TEST_CHECK((s->flags & 64) == 0, "adpcm: ADPCM flag kept after decoding");
+		FT2_TEST_CHECK(s->length == ADPCM_SMP_LEN && s->dataPtr != NULL
+			&& memcmp(s->dataPtr, expected, ADPCM_SMP_LEN) == 0, "adpcm: decoded wrong");
+
+		/* Saved as plain 8-bit, it must load back the same and save the same again */
+		FT2_TEST_CHECK(ft2_save_module(loaded, &resaved, &resavedSize)
+			&& ft2_load_module(reloaded, resaved, resavedSize) && reloaded->replayer.instr[1] != NULL
+			&& sameSample(s, &reloaded->replayer.instr[1]->smp[0])
+			&& ft2_save_module(reloaded, &resavedAgain, &resavedAgainSize)
+			&& resavedAgainSize == resavedSize && memcmp(resaved, resavedAgain, resavedSize) == 0,
+			"adpcm: doesn't survive a save and reload");
+	}
+	ft2_instance_destroy(loaded);
+	ft2_instance_destroy(reloaded);
+
+	free(file);
+	free(xm);
+	free(resaved);
+	free(resavedAgain);
+}
+
+int main(void)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (FT2_TEST_CHECK(inst != NULL && ft2_test_setup_save_module(inst, SAVE_SMP_LEN), "synthetic: can't set up"))
+		testSave(inst, "synthetic");
+	ft2_instance_destroy(inst);
+
+	testAdpcm();
+
+	for (int32_t i = 0; i < FT2_TEST_CORPUS_FILES; i++) {
+		const char *name = ft2_test_corpus_name(i);
+		uint32_t fileSize = 0;
+		uint8_t *fileData = ft2_test_read_corpus(i, &fileSize);
+		inst = ft2_instance_create(48000);
+		if (FT2_TEST_CHECK(fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize),
+			"%s: can't load", name))
+			testSave(inst, name);
+		ft2_instance_destroy(inst);
+		free(fileData);
+	}
+
+	return ft2_test_finish("diskop");
+}
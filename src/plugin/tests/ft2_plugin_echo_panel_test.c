@@ -0,0 +1,119 @@
+/**
+ * @file ft2_plugin_echo_panel_test.c
+ * @brief The sample editor's echo against the direct sum over every tap.
+ *
+ * 8- and 16-bit, at 1..64 echoes: the output must match the sum to 1 LSB.
+ * Then through a background job, run to the end (same output as run
+ * directly) and cancelled.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ft2_test.h"
+#include "ft2_plugin_sample_job.h"
+#include "ft2_plugin_echo_panel.h"
+
+#define ECHO_SMP_LEN (1 << 20)
+#define ECHO_DISTANCE (64 * 16)
+#define ECHO_VOL_CHANGE 0.9 /* Keeps all 64 echoes above 1 LSB at 16 bits */
+
+typedef struct echoJob_t {
+	const int8_t *src;
+	int8_t *dst;
+	int32_t srcLen, dstLen, distance, numTaps;
+	double volChange;
+	bool returned, completed;
+} echoJob_t;
+
+static bool echoJobRun(ft2_sample_job_t *job, void *userData)
+{
+	echoJob_t *ej = (echoJob_t *)userData;
+	return ft2_echo_render(ej->src, ej->srcLen, ej->dst, ej->dstLen, true, ej->distance, ej->volChange, ej->numTaps, job);
+}
+
+static void echoJobDone(ft2_instance_t *inst, void *userData, bool completed)
+{
+	(void)inst;
+	echoJob_t *ej = (echoJob_t *)userData;
+	ej->returned = true;
+	ej->completed = completed;
+}
+
+/* Runs one echo job the way the editor does, polling once per "frame" */
+static void runEchoJob(echoJob_t *ej, bool cancel)
+{
+	ft2_sample_job_t job;
+	memset(&job, 0, sizeof(job));
+	ej->returned = ej->completed = false;
+
+	if (!ft2_sample_job_start(&job, NULL, "Creating echo...", echoJobRun, echoJobDone, ej))
+		return;
+	if (cancel)
+		ft2_sample_job_cancel(&job);
+
+	while (!ej->returned) {
+		ft2_test_sleep_ms(1);
+		ft2_sample_job_poll(&job);
+	}
+}
+
+int main(void)
+{
+	static const int32_t echoCounts[] = { 1, 8, 64 };
+	const int32_t maxDstLen = ECHO_SMP_LEN + ECHO_DISTANCE * 64;
+
+	int16_t *src = (int16_t *)malloc((size_t)ECHO_SMP_LEN * sizeof(int16_t));
+	int8_t *ref = (int8_t *)malloc((size_t)maxDstLen * sizeof(int16_t));
+	int8_t *out = (int8_t *)malloc((size_t)maxDstLen * sizeof(int16_t));
+	if (!FT2_TEST_CHECK(src != NULL && ref != NULL && out != NULL, "out of memory")) {
+		free(src); free(ref); free(out);
+		return ft2_test_finish("echo_panel");
+	}
+
+	uint32_t seed = 0x2468ACEu;
+	for (int32_t i = 0; i < ECHO_SMP_LEN; i++) {
+		seed = seed * 1103515245u + 12345u;
+		src[i] = (int16_t)((int32_t)(sin(i * 0.013) * 12000.0) + (int32_t)((seed >> 16) & 0x1FFF) - 0x1000);
+	}
+
+	for (int32_t b = 0; b < 2; b++) {
+		const bool sample16Bit = (b == 0);
+		for (int32_t c = 0; c < (int32_t)(sizeof(echoCounts) / sizeof(echoCounts[0])); c++) {
+			const int32_t numTaps = echoCounts[c] + 1;
+			const int32_t dstLen = ECHO_SMP_LEN + ECHO_DISTANCE * (numTaps - 1);
+
+			ft2_test_echo_by_taps((const int8_t *)src, ECHO_SMP_LEN, ref, dstLen, sample16Bit, ECHO_DISTANCE,
+				ECHO_VOL_CHANGE, numTaps);
+			const bool rendered = ft2_echo_render((const int8_t *)src, ECHO_SMP_LEN, out, dstLen, sample16Bit,
+				ECHO_DISTANCE, ECHO_VOL_CHANGE, numTaps, NULL);
+
+			int32_t maxDiff = 0;
+			for (int32_t i = 0; i < dstLen; i++) {
+				const int32_t a = sample16Bit ? ((int16_t *)ref)[i] : ref[i];
+				const int32_t o = sample16Bit ? ((int16_t *)out)[i] : out[i];
+				if (abs(a - o) > maxDiff)
+					maxDiff = abs(a - o);
+			}
+
+			FT2_TEST_CHECK(rendered && maxDiff <= 1, "%s, %d echoes: off by up to %d",
+				sample16Bit ? "16-bit" : "8-bit", echoCounts[c], maxDiff);
+		}
+	}
+
+	/* In the background: to the end (same output as run directly), then cancelled */
+	ft2_echo_render((const int8_t *)src, ECHO_SMP_LEN, out, maxDstLen, true, ECHO_DISTANCE, ECHO_VOL_CHANGE, 65, NULL);
+	echoJob_t ej = { (const int8_t *)src, ref, ECHO_SMP_LEN, maxDstLen, ECHO_DISTANCE, 65, ECHO_VOL_CHANGE, false, false };
+
+	runEchoJob(&ej, false);
+	FT2_TEST_CHECK(ej.returned && ej.completed, "job: didn't complete");
+	FT2_TEST_CHECK(memcmp(ref, out, (size_t)maxDstLen * sizeof(int16_t)) == 0, "job: output differs from a direct run");
+
+	runEchoJob(&ej, true);
+	FT2_TEST_CHECK(ej.returned && !ej.completed, "job_cancel: not cancelled");
+
+	free(src);
+	free(ref);
+	free(out);
+	return ft2_test_finish("echo_panel");
+}
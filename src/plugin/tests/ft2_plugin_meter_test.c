@@ -0,0 +1,135 @@
+/**
+ * @file ft2_plugin_meter_test.c
+ * @brief Voice levels against the multi-out buffers they were mixed into.
+ *
+ * Each corpus module through the multi-out render in 64-frame blocks.
+ * Where one voice fed an output, its levels must match the output's;
+ * where several did, the output can't be louder than their sum; where
+ * none did, the output must be silent.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "ft2_test.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_loader.h"
+
+#define METER_BLOCK_SIZE 64
+#define METER_SECONDS 2.0
+
+static float outL[METER_BLOCK_SIZE], outR[METER_BLOCK_SIZE];
+
+static void bufferLevel(const float *p, uint32_t n, float *peak, double *rms)
+{
+	double sumSq = 0.0;
+	*peak = 0.0f;
+	for (uint32_t i = 0; i < n; i++) {
+		if (fabsf(p[i]) > *peak)
+			*peak = fabsf(p[i]);
+		sumSq += (double)p[i] * p[i];
+	}
+	*rms = sqrt(sumSq / n);
+}
+
+static double relErr(double a, double b)
+{
+	const double d = fabs(a - b), m = (fabs(a) > fabs(b)) ? fabs(a) : fabs(b);
+	return (m > 0.0) ? d / m : 0.0;
+}
+
+static void testModule(int32_t file)
+{
+	const char *name = ft2_test_corpus_name(file);
+	uint32_t fileSize = 0;
+	uint8_t *fileData = ft2_test_read_corpus(file, &fileSize);
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (!FT2_TEST_CHECK(fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize) &&
+		ft2_instance_set_multiout(inst, true, METER_BLOCK_SIZE), "%s: can't set up", name)) {
+		ft2_instance_destroy(inst);
+		free(fileData);
+		return;
+	}
+
+	const uint32_t numBlocks = (uint32_t)((METER_SECONDS * 48000) / METER_BLOCK_SIZE) + 1;
+	uint32_t exactChecks = 0, failures = 0, missedReads = 0;
+	double maxPeakErr = 0.0, maxRmsErr = 0.0;
+
+	/* The mixer only measures once someone reads */
+	ft2_meter_snapshot_t meter;
+	ft2_meter_read(&inst->meter, &meter);
+
+	ft2_instance_play(inst, FT2_PLAYMODE_SONG, 0);
+	for (uint32_t b = 0; b < numBlocks; b++) {
+		ft2_instance_render_multiout(inst, outL, outR, METER_BLOCK_SIZE);
+
+		if (!ft2_meter_read(&inst->meter, &meter) || meter.numFrames != METER_BLOCK_SIZE) {
+			missedReads++;
+			continue;
+		}
+
+		for (int32_t out = 0; out < FT2_NUM_OUTPUTS; out++) {
+			for (int32_t side = 0; side < 2; side++) {
+				const float *buf = side ? inst->audio.fChannelBufferR[out] : inst->audio.fChannelBufferL[out];
+				float bufPeak;
+				double bufRms;
+				bufferLevel(buf, METER_BLOCK_SIZE, &bufPeak, &bufRms);
+
+				/* The voices of the channels routed here */
+				int32_t numSounding = 0, lastVoice = -1;
+				double sumPeak = 0.0, sumRms = 0.0;
+				for (int32_t ch = 0; ch < inst->replayer.song.numChannels; ch++) {
+					int32_t routed = inst->config.channelRouting[ch];
+					if (routed >= FT2_NUM_OUTPUTS)
+						routed = ch % FT2_NUM_OUTPUTS;
+					if (routed != out)
+						continue;
+
+					for (int32_t v = ch; v < FT2_METER_VOICES; v += FT2_METER_CHANNELS) {
+						const ft2_meter_level_t *l = &meter.voice[v];
+						const float peak = side ? l->peakR : l->peakL;
+						if (peak > 0.0f) {
+							numSounding++;
+							lastVoice = v;
+							sumPeak += peak;
+							sumRms += side ? l->rmsR : l->rmsL;
+						}
+					}
+				}
+
+				if (numSounding == 0) {
+					if (bufPeak != 0.0f)
+						failures++;
+				} else if (numSounding == 1) {
+					/* The buffers are clamped, the levels aren't */
+					const ft2_meter_level_t *l = &meter.voice[lastVoice];
+					const float peak = side ? l->peakR : l->peakL;
+					const double peakErr = relErr(bufPeak, (peak > 1.0f) ? 1.0f : peak);
+					const double rmsErr = (peak < 1.0f) ? relErr(bufRms, side ? l->rmsR : l->rmsL) : 0.0;
+					if (peakErr > maxPeakErr) maxPeakErr = peakErr;
+					if (rmsErr > maxRmsErr) maxRmsErr = rmsErr;
+					if (peakErr > 1e-6 || rmsErr > 1e-4)
+						failures++;
+					exactChecks++;
+				} else {
+					if (bufPeak > sumPeak * (1.0 + 1e-6) || bufRms > sumRms * (1.0 + 1e-4))
+						failures++;
+				}
+			}
+		}
+	}
+
+	FT2_TEST_CHECK(missedReads == 0, "%s: no levels for %u of %u blocks", name, missedReads, numBlocks);
+	FT2_TEST_CHECK(exactChecks > 0, "%s: no output fed by a single voice", name);
+	FT2_TEST_CHECK(failures == 0, "%s: %u outputs off their levels (peak error %.2e, RMS error %.2e)",
+		name, failures, maxPeakErr, maxRmsErr);
+
+	ft2_instance_destroy(inst);
+	free(fileData);
+}
+
+int main(void)
+{
+	for (int32_t i = 0; i < FT2_TEST_CORPUS_FILES; i++)
+		testModule(i);
+	return ft2_test_finish("meter");
+}
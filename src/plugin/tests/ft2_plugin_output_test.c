@@ -0,0 +1,67 @@
+/**
+ * @file ft2_plugin_output_test.c
+ * @brief The output stages against the scalar loops they replaced.
+ *
+ * Gain + clamp (also in place, as the multi-out buffers are scaled) and
+ * the sum of 8 multi-out buffers, on an odd-length block (so the scalar
+ * tail runs too) and on a long stream. The output must be bit-identical,
+ * including out-of-range samples and -0.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_test.h"
+#include "ft2_plugin_output.h"
+
+#define OUTPUT_SOURCES 8
+
+static void testOutput(const char *name, uint32_t n)
+{
+	const float mul = 0.37f; /* 1/0.37 = 2.7027..., one of the specials */
+	float *srcs[OUTPUT_SOURCES];
+	bool allocated = true;
+
+	for (int32_t s = 0; s < OUTPUT_SOURCES; s++) {
+		srcs[s] = (float *)malloc(n * sizeof(float));
+		if (srcs[s] == NULL)
+			allocated = false;
+		else
+			ft2_test_fill_output(srcs[s], n, 0x1234u + (uint32_t)s);
+	}
+	float *ref = (float *)malloc(n * sizeof(float));
+	float *dst = (float *)malloc(n * sizeof(float));
+
+	if (FT2_TEST_CHECK(allocated && ref != NULL && dst != NULL, "%s: out of memory", name)) {
+		char key[64];
+
+		ft2_test_scale_clamp(ref, srcs[0], mul, n);
+		ft2_output_scale_clamp(dst, srcs[0], mul, n);
+		FT2_TEST_CHECK(memcmp(ref, dst, n * sizeof(float)) == 0, "%s: scale + clamp differs", name);
+		snprintf(key, sizeof(key), "output:%s:scale", name);
+		ft2_test_check_hash(key, ft2_test_hash_floats(FT2_TEST_HASH_INIT, dst, n));
+
+		ft2_test_sum_scale_clamp(ref, srcs, OUTPUT_SOURCES, mul, n);
+		ft2_output_sum_scale_clamp(dst, (const float *const *)srcs, OUTPUT_SOURCES, mul, n);
+		FT2_TEST_CHECK(memcmp(ref, dst, n * sizeof(float)) == 0, "%s: sum + scale + clamp differs", name);
+		snprintf(key, sizeof(key), "output:%s:sum", name);
+		ft2_test_check_hash(key, ft2_test_hash_floats(FT2_TEST_HASH_INIT, dst, n));
+
+		memcpy(dst, srcs[1], n * sizeof(float));
+		ft2_output_scale_clamp(dst, dst, mul, n);
+		ft2_test_scale_clamp(ref, srcs[1], mul, n);
+		FT2_TEST_CHECK(memcmp(ref, dst, n * sizeof(float)) == 0, "%s: in-place scale + clamp differs", name);
+	}
+
+	for (int32_t s = 0; s < OUTPUT_SOURCES; s++)
+		free(srcs[s]);
+	free(ref);
+	free(dst);
+}
+
+int main(void)
+{
+	testOutput("block", 1021);
+	testOutput("stream", 1 << 21);
+	return ft2_test_finish("output");
+}
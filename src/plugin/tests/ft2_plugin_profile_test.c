@@ -0,0 +1,96 @@
+/**
+ * @file ft2_plugin_profile_test.c
+ * @brief The per-block profiler (ft2_plugin_profile.h).
+ *
+ * xm8ch.xm rendered three ways in 256-frame blocks: unprofiled, profiled
+ * with the profiler off, and with it on. All three must put out the same
+ * audio; only the last may record anything, and its stats must add up
+ * (one entry per block, p50 <= p99 <= max, render within the block).
+ */
+
+#include <stdlib.h>
+#include "ft2_test.h"
+#include "ft2_plugin_loader.h"
+
+#define PROFILE_BLOCK_SIZE 256
+#define PROFILE_SECONDS 2.0
+#define PROFILE_FILE 0 /* xm8ch.xm */
+
+enum { PROFILE_NONE, PROFILE_OFF, PROFILE_ON, PROFILE_MODES };
+
+static float outL[PROFILE_BLOCK_SIZE], outR[PROFILE_BLOCK_SIZE];
+
+/* One block the way processBlock() profiles it (the lock and MIDI phases
+ * have nothing to do here) */
+static void renderProfiled(ft2_instance_t *inst)
+{
+	ft2_profile_block_t prof;
+	ft2_profile_begin(&prof);
+	ft2_profile_attach(&prof, &inst->profile);
+	ft2_profile_mark(&prof, FT2_PROFILE_MIDI_IN);
+	ft2_profile_mark(&prof, FT2_PROFILE_SYNC);
+	ft2_instance_render(inst, outL, outR, PROFILE_BLOCK_SIZE);
+	ft2_profile_mark(&prof, FT2_PROFILE_RENDER);
+	ft2_profile_mark(&prof, FT2_PROFILE_MIDI_OUT);
+	ft2_instance_profile_end(inst, &prof, PROFILE_BLOCK_SIZE);
+}
+
+int main(void)
+{
+	const char *name = ft2_test_corpus_name(PROFILE_FILE);
+	uint32_t fileSize = 0;
+	uint8_t *fileData = ft2_test_read_corpus(PROFILE_FILE, &fileSize);
+	ft2_instance_t *insts[PROFILE_MODES];
+	bool loaded = fileData != NULL;
+	for (int32_t m = 0; m < PROFILE_MODES; m++) {
+		insts[m] = ft2_instance_create(48000);
+		if (insts[m] == NULL || !loaded || !ft2_load_module(insts[m], fileData, fileSize))
+			loaded = false;
+	}
+	free(fileData);
+
+	if (FT2_TEST_CHECK(loaded, "%s: can't load", name)) {
+		ft2_profile_set_enabled(&insts[PROFILE_ON]->profile, true);
+
+		const uint32_t numBlocks = (uint32_t)((PROFILE_SECONDS * 48000.0) / PROFILE_BLOCK_SIZE) + 1;
+		uint64_t hash[PROFILE_MODES];
+		for (int32_t m = 0; m < PROFILE_MODES; m++) {
+			ft2_instance_play(insts[m], FT2_PLAYMODE_SONG, 0);
+			hash[m] = FT2_TEST_HASH_INIT;
+		}
+
+		for (uint32_t b = 0; b < numBlocks; b++) {
+			for (int32_t m = 0; m < PROFILE_MODES; m++) {
+				if (m == PROFILE_NONE)
+					ft2_instance_render(insts[m], outL, outR, PROFILE_BLOCK_SIZE);
+				else
+					renderProfiled(insts[m]);
+
+				hash[m] = ft2_test_hash_floats(hash[m], outL, PROFILE_BLOCK_SIZE);
+				hash[m] = ft2_test_hash_floats(hash[m], outR, PROFILE_BLOCK_SIZE);
+			}
+		}
+
+		ft2_profile_snapshot_t snap, offSnap;
+		const bool haveStats = ft2_profile_read(&insts[PROFILE_ON]->profile, &snap);
+		const ft2_profile_phase_t *render = &snap.phase[FT2_PROFILE_RENDER];
+		const ft2_profile_phase_t *block = &snap.phase[FT2_PROFILE_BLOCK];
+
+		FT2_TEST_CHECK(hash[PROFILE_OFF] == hash[PROFILE_NONE], "profiled with the profiler off, the audio differs");
+		FT2_TEST_CHECK(hash[PROFILE_ON] == hash[PROFILE_NONE], "profiled, the audio differs");
+		FT2_TEST_CHECK(!ft2_profile_read(&insts[PROFILE_OFF]->profile, &offSnap), "recorded with the profiler off");
+		if (FT2_TEST_CHECK(haveStats, "no stats recorded")) {
+			FT2_TEST_CHECK(snap.blocks == numBlocks, "%u of %u blocks recorded", snap.blocks, numBlocks);
+			FT2_TEST_CHECK(render->p50Us > 0.0f && render->p50Us <= render->p99Us && render->p99Us <= render->maxUs,
+				"render p50 %.2f, p99 %.2f, max %.2f us", render->p50Us, render->p99Us, render->maxUs);
+			FT2_TEST_CHECK(render->maxUs <= block->maxUs, "render max %.2f us over the block's %.2f us",
+				render->maxUs, block->maxUs);
+			FT2_TEST_CHECK(snap.maxVoices >= snap.voices, "%d voices, at most %d", snap.voices, snap.maxVoices);
+		}
+		ft2_test_check_hash("profile:xm8ch.xm", hash[PROFILE_NONE]);
+	}
+
+	for (int32_t m = 0; m < PROFILE_MODES; m++)
+		ft2_instance_destroy(insts[m]);
+	return ft2_test_finish("profile");
+}
@@ -0,0 +1,158 @@
+/**
+ * @file ft2_plugin_resampler_test.c
+ * @brief The resample panel's converter at several pitch shifts.
+ *
+ * Quality: gain and residual (noise, distortion, images) for a tone in the
+ * passband, and what is left of a tone above the new Nyquist frequency.
+ * Then a long looped sample on one thread and on the worker pool, whose
+ * output must be identical (and match its golden hash).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ft2_test.h"
+#include "ft2_plugin_resampler.h"
+#include "ft2_plugin_workers.h"
+
+#define RESAMPLE_TONE_LEN 65536
+#define RESAMPLE_POOL_LEN (1 << 22)
+
+/* Least-squares fit of a tone (cycles per sample) to x; returns its
+ * amplitude and the RMS of what is left */
+static void fitTone(const int16_t *x, int32_t n, double freq, double *amplitude, double *residualRms)
+{
+	double cc = 0.0, ss = 0.0, cs = 0.0, xc = 0.0, xs = 0.0;
+	for (int32_t i = 0; i < n; i++) {
+		const double c = cos(2.0 * M_PI * freq * i), s = sin(2.0 * M_PI * freq * i);
+		cc += c * c; ss += s * s; cs += c * s;
+		xc += x[i] * c; xs += x[i] * s;
+	}
+
+	const double det = (cc * ss) - (cs * cs);
+	const double a = ((xc * ss) - (xs * cs)) / det;
+	const double b = ((xs * cc) - (xc * cs)) / det;
+
+	double sum = 0.0;
+	for (int32_t i = 0; i < n; i++) {
+		const double e = x[i] - (a * cos(2.0 * M_PI * freq * i)) - (b * sin(2.0 * M_PI * freq * i));
+		sum += e * e;
+	}
+
+	*amplitude = sqrt((a * a) + (b * b));
+	*residualRms = sqrt(sum / n);
+}
+
+static double rmsOf(const int16_t *x, int32_t n)
+{
+	double sum = 0.0;
+	for (int32_t i = 0; i < n; i++)
+		sum += (double)x[i] * x[i];
+	return sqrt(sum / n);
+}
+
+static double toDb(double x)
+{
+	return 20.0 * log10((x > 1e-12) ? x : 1e-12);
+}
+
+/* Passband tone and (shrinking only) a tone above the new Nyquist
+ * frequency: within 0.05 dB in the passband, images and aliases 80 dB down */
+static void testQuality(int32_t semitones, int16_t *src, int16_t *dst)
+{
+	const double ratio = pow(2.0, semitones / 12.0);
+	const double band = (ratio < 1.0) ? ratio : 1.0; /* Of the source Nyquist */
+	const double amp = 16000.0;
+
+	ft2_resampler_t rs;
+	if (!FT2_TEST_CHECK(ft2_resampler_init(&rs, ratio), "quality %+d: init failed", semitones))
+		return;
+
+	const ft2_resample_source_t source = { (const int8_t *)src, RESAMPLE_TONE_LEN, 0, 0, FT2_SAMPLE_16BIT };
+	const int32_t dstLen = (int32_t)floor(RESAMPLE_TONE_LEN * ratio);
+	const int32_t margin = (int32_t)ceil(rs.numTaps * ((ratio > 1.0) ? ratio : 1.0)) + 16; /* Leave out the edges */
+	const int16_t *x = dst + margin;
+	const int32_t n = dstLen - (2 * margin);
+
+	/* Cycles per source sample: 60% of the way to the lower Nyquist */
+	double freq = 0.3 * band;
+	for (int32_t i = 0; i < RESAMPLE_TONE_LEN; i++)
+		src[i] = (int16_t)lrint(amp * sin(2.0 * M_PI * freq * i));
+	ft2_resampler_render(&rs, &source, (int8_t *)dst, 0, dstLen);
+
+	double a, r;
+	fitTone(x, n, freq / ratio, &a, &r);
+	FT2_TEST_CHECK(fabs(toDb(a / amp)) < 0.05, "quality %+d: gain %.3f dB", semitones, toDb(a / amp));
+	FT2_TEST_CHECK(toDb(r / (amp / sqrt(2.0))) < -80.0, "quality %+d: residual %.1f dB", semitones,
+		toDb(r / (amp / sqrt(2.0))));
+
+	/* Stretching has nothing to alias; shrinking, halfway between the new
+	 * Nyquist frequency and the old one */
+	if (ratio < 1.0) {
+		freq = 0.25 * (band + 1.0);
+		for (int32_t i = 0; i < RESAMPLE_TONE_LEN; i++)
+			src[i] = (int16_t)lrint(amp * sin(2.0 * M_PI * freq * i));
+		ft2_resampler_render(&rs, &source, (int8_t *)dst, 0, dstLen);
+
+		const double aliasDb = toDb(rmsOf(x, n) / (amp / sqrt(2.0)));
+		FT2_TEST_CHECK(aliasDb < -80.0, "quality %+d: alias %.1f dB", semitones, aliasDb);
+	}
+
+	ft2_resampler_free(&rs);
+}
+
+static void testPool(int32_t semitones, const int16_t *src, int16_t *dst1, int16_t *dstN)
+{
+	const double ratio = pow(2.0, semitones / 12.0);
+	ft2_resampler_t rs;
+	if (!FT2_TEST_CHECK(ft2_resampler_init(&rs, ratio), "pool %+d: init failed", semitones))
+		return;
+
+	const ft2_resample_source_t source = { (const int8_t *)src, RESAMPLE_POOL_LEN, 0, RESAMPLE_POOL_LEN,
+		FT2_SAMPLE_16BIT | FT2_LOOP_FWD };
+	const int32_t dstLen = (int32_t)floor(RESAMPLE_POOL_LEN * ratio);
+
+	ft2_resampler_render(&rs, &source, (int8_t *)dst1, 0, dstLen);
+	ft2_resampler_run(&rs, &source, (int8_t *)dstN, dstLen, NULL);
+
+	FT2_TEST_CHECK(memcmp(dst1, dstN, (size_t)dstLen * sizeof(int16_t)) == 0,
+		"pool %+d: differs from one thread (%d workers)", semitones, ft2_workers_get_concurrency());
+
+	char key[64];
+	snprintf(key, sizeof(key), "resample:pool_%+d", semitones);
+	ft2_test_check_hash(key, ft2_test_hash(FT2_TEST_HASH_INIT, dstN, (size_t)dstLen * sizeof(int16_t)));
+
+	ft2_resampler_free(&rs);
+}
+
+int main(void)
+{
+	static const int32_t qualityShifts[] = { -36, -12, -5, 7, 12, 36 };
+	static const int32_t poolShifts[] = { -12, 12 };
+
+	const size_t maxDst = (size_t)RESAMPLE_POOL_LEN * 2 + 1;
+	int16_t *src = (int16_t *)malloc((size_t)RESAMPLE_POOL_LEN * sizeof(int16_t));
+	int16_t *dst1 = (int16_t *)malloc(maxDst * sizeof(int16_t));
+	int16_t *dstN = (int16_t *)malloc(maxDst * sizeof(int16_t));
+	int16_t *tone = (int16_t *)malloc((size_t)RESAMPLE_TONE_LEN * sizeof(int16_t));
+	int16_t *toneOut = (int16_t *)malloc((size_t)RESAMPLE_TONE_LEN * 8 * sizeof(int16_t));
+	if (FT2_TEST_CHECK(src != NULL && dst1 != NULL && dstN != NULL && tone != NULL && toneOut != NULL &&
+		ft2_workers_init(), "setup failed")) {
+		for (int32_t i = 0; i < (int32_t)(sizeof(qualityShifts) / sizeof(qualityShifts[0])); i++)
+			testQuality(qualityShifts[i], tone, toneOut);
+
+		uint32_t seed = 0x5EED1234u;
+		for (int32_t i = 0; i < RESAMPLE_POOL_LEN; i++) {
+			seed = seed * 1103515245u + 12345u;
+			src[i] = (int16_t)(seed >> 16);
+		}
+		for (int32_t i = 0; i < (int32_t)(sizeof(poolShifts) / sizeof(poolShifts[0])); i++)
+			testPool(poolShifts[i], src, dst1, dstN);
+
+		ft2_workers_free();
+	}
+
+	free(src); free(dst1); free(dstN); free(tone); free(toneOut);
+	return ft2_test_finish("resampler");
+}
@@ -0,0 +1,339 @@
+/**
+ * @file ft2_plugin_sample_handoff_test.c
+ * @brief Sample and pattern edits while the audio thread plays them.
+ *
+ * Sample edits on the calling thread (as the editor makes them) while a
+ * second thread keeps rendering looped voices that play the edited
+ * samples: no voice may be cut, and every retired buffer must be
+ * reclaimed. Then pattern edits that reallocate pattern buffers while the
+ * song plays from them, MIDI notes recorded from inside blocks while the
+ * pattern is restrided (none may be lost), and an in-place edit of a
+ * sample another instance shares. Run it under ASan/TSan to check the
+ * buffer handoff.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ft2_test.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_ed.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_input.h"
+
+typedef struct editAudio_t {
+	ft2_instance_t *inst;
+	volatile int32_t stop;
+	uint32_t blocks, voicesCut;
+	bool playSong; /* Run the replayer too (pattern edits) */
+} editAudio_t;
+
+static float editOutL[256], editOutR[256];
+
+static void editAudioLoop(void *arg)
+{
+	editAudio_t *a = (editAudio_t *)arg;
+	while (!ft2_test_flag_get(&a->stop)) {
+		bool wasActive[FT2_MAX_CHANNELS];
+		for (int32_t i = 0; i < FT2_MAX_CHANNELS; i++)
+			wasActive[i] = a->inst->voice[i].active;
+
+		if (a->playSong)
+			ft2_instance_render(a->inst, editOutL, editOutR, 256);
+		else
+			ft2_mix_voices_only(a->inst, editOutL, editOutR, 256);
+		a->blocks++;
+
+		/* The samples all loop, so a voice only stops if something cut it */
+		for (int32_t i = 0; i < FT2_MAX_CHANNELS; i++) {
+			if (wasActive[i] && !a->inst->voice[i].active)
+				a->voicesCut++;
+		}
+	}
+}
+
+static void testSampleEdits(double seconds)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (!FT2_TEST_CHECK(inst != NULL && ft2_test_setup_mix_instruments(inst), "edit: instance setup failed")) {
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	/* Looped 8/16-bit samples (instruments 2, 3, 5, 6), four voices each */
+	static const uint8_t looped[4] = { 2, 3, 5, 6 };
+	inst->replayer.song.numChannels = 16;
+	for (int32_t ch = 0; ch < 16; ch++)
+		ft2_instance_trigger_note(inst, (int8_t)(37 + ch * 3), looped[ch & 3], (uint8_t)ch, 48, 0, 0);
+
+	/* Start the voices here, so the audio thread only has to keep them going */
+	ft2_mix_voices_only(inst, editOutL, editOutR, 256);
+
+	editAudio_t audio = { inst, 0, 0, 0, false };
+	ft2_test_thread_t thread;
+	if (!FT2_TEST_CHECK(ft2_test_thread_start(&thread, editAudioLoop, &audio), "edit: can't start the audio thread")) {
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	/* One edit per UI frame, in-place and loop edits alternating */
+	uint32_t edits = 0;
+	const double t0 = ft2_test_now();
+	while (ft2_test_now() - t0 < seconds) {
+		inst->editor.curInstr = looped[edits & 3];
+		inst->editor.curSmp = 0;
+
+		switch ((edits >> 2) % 6) {
+			case 0: sampleChangeSign(inst); break;
+			case 1: sampReplenDown(inst); break;
+			case 2: rbSamplePingpongLoop(inst); break;
+			case 3: sampRepeatUp(inst); break;
+			case 4: rbSampleForwardLoop(inst); break;
+			default: sampleBackwards(inst); break;
+		}
+		edits++;
+
+		ft2_sample_handoff_sync(inst);
+		ft2_test_sleep_ms(1);
+	}
+
+	ft2_test_flag_set(&audio.stop);
+	ft2_test_thread_join(&thread);
+
+	/* With the audio thread stopped, everything is reclaimed within two syncs */
+	ft2_sample_handoff_sync(inst);
+	ft2_sample_handoff_sync(inst);
+	const uint32_t leftOver = inst->handoff.numRetired - inst->handoff.numReclaimed;
+
+	/* Every voice must still play, and from the sample's current data */
+	int32_t voicesPlaying = 0;
+	for (int32_t ch = 0; ch < 16; ch++) {
+		const ft2_voice_t *v = &inst->voice[ch];
+		const int8_t *base = (v->base16 != NULL) ? (const int8_t *)v->base16 : v->base8;
+		if (v->active && base == inst->replayer.instr[looped[ch & 3]]->smp[0].dataPtr)
+			voicesPlaying++;
+	}
+
+	FT2_TEST_CHECK(audio.voicesCut == 0, "edit: %u voices cut in %u edits", audio.voicesCut, edits);
+	FT2_TEST_CHECK(voicesPlaying == 16, "edit: %d of 16 voices play the current data", voicesPlaying);
+	FT2_TEST_CHECK(leftOver == 0, "edit: %u retired buffers not reclaimed", leftOver);
+
+	ft2_instance_destroy(inst);
+}
+
+/* An in-place edit (volume) of a sample whose buffer another instance
+ * shares, while a voice plays it, then the other instance goes away. The
+ * voice must end up on this instance's copy, not on the freed buffer. */
+static void testSharedEdit(void)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	ft2_instance_t *other = ft2_instance_create(48000);
+	ft2_ui_t *ui = ft2_ui_create();
+	if (!FT2_TEST_CHECK(inst != NULL && other != NULL && ui != NULL && ft2_test_setup_mix_instruments(inst) &&
+		ft2_test_setup_mix_instruments(other), "shared edit: instance setup failed")) {
+		ft2_ui_destroy(ui);
+		ft2_instance_destroy(other);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	/* Same content in both, so interning leaves one buffer */
+	ft2_sample_t *s = &inst->replayer.instr[2]->smp[0];
+	ft2_sample_t *otherSmp = &other->replayer.instr[2]->smp[0];
+	ft2_sample_pool_intern(s, ft2_sample_pool_hash(s->origDataPtr, ft2_sample_pool_data_size(s)));
+	ft2_sample_pool_intern(otherSmp, ft2_sample_pool_hash(otherSmp->origDataPtr, ft2_sample_pool_data_size(otherSmp)));
+	FT2_TEST_CHECK(s->origDataPtr == otherSmp->origDataPtr, "shared edit: samples not pooled");
+
+	inst->ui = ui;
+	inst->replayer.song.numChannels = 1;
+	ft2_instance_trigger_note(inst, 49, 2, 0, 48, 0, 0);
+	ft2_mix_voices_only(inst, editOutL, editOutR, 256);
+
+	inst->editor.curInstr = 2;
+	inst->editor.curSmp = 0;
+	sampApplyVolume(inst, 50.0, 50.0);
+	ft2_sample_handoff_sync(inst);
+
+	ft2_instance_destroy(other);
+
+	for (int32_t i = 0; i < 4; i++) {
+		ft2_mix_voices_only(inst, editOutL, editOutR, 256);
+		ft2_sample_handoff_sync(inst);
+	}
+
+	const ft2_voice_t *v = &inst->voice[0];
+	FT2_TEST_CHECK(v->active && v->base8 == s->dataPtr, "shared edit: voice not on the edited copy");
+
+	inst->ui = NULL;
+	ft2_ui_destroy(ui);
+	ft2_instance_destroy(inst);
+}
+
+static void fillEditPattern(ft2_instance_t *inst, uint16_t pattNum)
+{
+	for (int32_t row = 0; row < inst->replayer.patternNumRows[pattNum]; row++) {
+		for (int32_t ch = 0; ch < inst->replayer.song.numChannels; ch++) {
+			ft2_note_t *n = ft2_pattern_note(inst, pattNum, row, ch);
+			n->note = (uint8_t)(25 + ((row * 5 + ch * 7 + pattNum) % 48));
+			n->instr = (uint8_t)(1 + ((row + ch) % 6));
+		}
+	}
+}
+
+/* Pattern length, stride and delete edits (which reallocate pattern
+ * buffers) while the audio thread plays the song through them */
+static void testPatternEdits(double seconds)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (!FT2_TEST_CHECK(inst != NULL && ft2_test_setup_mix_instruments(inst), "patterns: instance setup failed")) {
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	inst->replayer.song.numChannels = 8;
+	inst->replayer.song.songLength = 4;
+	for (int32_t p = 0; p < 4; p++) {
+		inst->replayer.song.orders[p] = (uint8_t)p;
+		inst->replayer.patternNumRows[p] = 16;
+		if (!FT2_TEST_CHECK(ft2_pattern_alloc(inst, (uint16_t)p), "patterns: pattern setup failed")) {
+			ft2_instance_destroy(inst);
+			return;
+		}
+		fillEditPattern(inst, (uint16_t)p);
+	}
+	inst->replayer.song.initialSpeed = inst->replayer.song.speed = 1;
+	ft2_instance_play(inst, FT2_PLAYMODE_SONG, 0);
+	ft2_set_bpm(inst, 255);
+
+	editAudio_t audio = { inst, 0, 0, 0, true };
+	ft2_test_thread_t thread;
+	if (!FT2_TEST_CHECK(ft2_test_thread_start(&thread, editAudioLoop, &audio), "patterns: can't start the audio thread")) {
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	/* Each round: widen or narrow the stride (every pattern moves), delete
+	 * a pattern and recreate it short, then grow it past its allocation */
+	uint32_t edits = 0;
+	bool allOk = true;
+	const double t0 = ft2_test_now();
+	while (ft2_test_now() - t0 < seconds) {
+		const uint16_t p = (uint16_t)(edits & 3);
+
+		allOk = allOk && ft2_pattern_set_stride(inst, (edits & 1) ? 12 : 8);
+		ft2_pattern_free(inst, p);
+		inst->replayer.patternNumRows[p] = 16;
+		allOk = allOk && ft2_pattern_alloc(inst, p);
+		if (allOk)
+			fillEditPattern(inst, p);
+		allOk = allOk && ft2_pattern_set_num_rows(inst, p, (int16_t)(32 + (edits % 4) * 32));
+		edits++;
+
+		ft2_test_sleep_ms(1);
+	}
+
+	ft2_test_flag_set(&audio.stop);
+	ft2_test_thread_join(&thread);
+
+	FT2_TEST_CHECK(allOk, "patterns: an edit failed");
+	FT2_TEST_CHECK(audio.blocks > 0 && inst->replayer.songPlaying, "patterns: the song stopped");
+
+	ft2_instance_destroy(inst);
+}
+
+/* MIDI recording from inside audio blocks, as the plugin records, while
+ * the UI keeps restriding the pattern. The stride copy is made outside
+ * the pattern swap, so a note recorded meanwhile must make it start over
+ * rather than get lost. */
+#define RECORD_ROWS 64
+#define RECORD_CHANNELS 8
+
+typedef struct recordAudio_t {
+	ft2_instance_t *inst;
+	ft2_input_state_t input;
+	volatile int32_t stop; /* Also set by the thread once every note is in */
+	int32_t notes;
+} recordAudio_t;
+
+static void recordAudioLoop(void *arg)
+{
+	recordAudio_t *a = (recordAudio_t *)arg;
+	while (!ft2_test_flag_get(&a->stop)) {
+		ft2_sample_handoff_block_begin(a->inst);
+		a->inst->replayer.song.row = (int16_t)(a->notes / RECORD_CHANNELS);
+		a->inst->cursor.ch = (int8_t)(a->notes % RECORD_CHANNELS);
+		const int8_t ch = ft2_plugin_record_note(a->inst, &a->input, (uint8_t)(1 + a->notes % 96), -1, 0, 0);
+		if (ch >= 0)
+			ft2_plugin_record_note_off(a->inst, &a->input, ch);
+		ft2_sample_handoff_block_end(a->inst);
+
+		if (++a->notes == RECORD_ROWS * RECORD_CHANNELS)
+			ft2_test_flag_set(&a->stop);
+		ft2_test_sleep_ms(0);
+	}
+}
+
+static void testPatternRecording(void)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	recordAudio_t *audio = (recordAudio_t *)calloc(1, sizeof(recordAudio_t));
+	if (!FT2_TEST_CHECK(inst != NULL && audio != NULL && ft2_test_setup_mix_instruments(inst),
+		"recording: instance setup failed")) {
+		free(audio);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	inst->replayer.song.numChannels = RECORD_CHANNELS;
+	inst->replayer.patternNumRows[0] = RECORD_ROWS;
+	inst->replayer.playMode = FT2_PLAYMODE_RECPATT;
+	inst->editor.editPattern = 0;
+	inst->editor.curInstr = 1;
+	inst->config.multiRec = false;
+	inst->config.recRelease = false;
+	audio->inst = inst;
+
+	ft2_test_thread_t thread;
+	if (!FT2_TEST_CHECK(ft2_test_thread_start(&thread, recordAudioLoop, audio), "recording: can't start the audio thread")) {
+		free(audio);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	/* Restride until every note is in (or ten seconds have gone by),
+	 * letting the recording thread in between */
+	uint32_t restrides = 0;
+	bool allOk = true;
+	const double t0 = ft2_test_now();
+	while (ft2_test_now() - t0 < 10.0 && !ft2_test_flag_get(&audio->stop)) {
+		allOk = allOk && ft2_pattern_set_stride(inst, (restrides & 1) ? RECORD_CHANNELS : FT2_MAX_CHANNELS);
+		restrides++;
+		ft2_test_sleep_ms(0);
+	}
+
+	ft2_test_flag_set(&audio->stop);
+	ft2_test_thread_join(&thread);
+
+	int32_t lost = 0;
+	for (int32_t i = 0; i < audio->notes; i++) {
+		const ft2_note_t *n = ft2_pattern_note(inst, 0, i / RECORD_CHANNELS, i % RECORD_CHANNELS);
+		if (n == NULL || n->note != 1 + i % 96)
+			lost++;
+	}
+
+	FT2_TEST_CHECK(allOk && restrides > 0, "recording: restriding failed");
+	FT2_TEST_CHECK(audio->notes == RECORD_ROWS * RECORD_CHANNELS, "recording: only %d notes in 10 s", audio->notes);
+	FT2_TEST_CHECK(lost == 0, "recording: %d of %d notes lost over %u restrides", lost, audio->notes, restrides);
+
+	free(audio);
+	ft2_instance_destroy(inst);
+}
+
+int main(void)
+{
+	testSampleEdits(0.5);
+	testSharedEdit();
+	testPatternEdits(0.5);
+	testPatternRecording();
+	return ft2_test_finish("sample_handoff");
+}
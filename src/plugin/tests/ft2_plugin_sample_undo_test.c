@@ -0,0 +1,191 @@
+/**
+ * @file ft2_plugin_sample_undo_test.c
+ * @brief The sample undo journal on a 4 MiB sample.
+ *
+ * One edit of a 1% selection and of the whole sample, then a 32-level
+ * history of in-place and length-changing edits undone and redone, every
+ * step checked against the state it should restore. The memory cap must
+ * keep the newest levels, an edit that bypassed the journal must not be
+ * undone over, and loading a module must drop the editor's history.
+ */
+
+#include <stdlib.h>
+#include "ft2_test.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_loader.h"
+#include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_ed.h"
+#include "ft2_plugin_sample_undo.h"
+#include "ft2_plugin_diskop.h"
+
+#define UNDO_SMP_LEN (1 << 21)
+#define UNDO_LEVELS 32
+
+static uint64_t hashSample(const ft2_sample_t *s)
+{
+	uint64_t hash = FT2_TEST_HASH_INIT;
+	hash = ft2_test_hash(hash, &s->length, sizeof(s->length));
+	hash = ft2_test_hash(hash, &s->loopStart, sizeof(s->loopStart));
+	hash = ft2_test_hash(hash, &s->loopLength, sizeof(s->loopLength));
+	hash = ft2_test_hash(hash, &s->flags, sizeof(s->flags));
+	if (s->dataPtr != NULL)
+		hash = ft2_test_hash(hash, s->dataPtr, (size_t)s->length * 2);
+	return hash;
+}
+
+/* No audio thread: two syncs free every buffer an undo step retired */
+static void settleHandoff(ft2_instance_t *inst)
+{
+	ft2_sample_handoff_sync(inst);
+	ft2_sample_handoff_sync(inst);
+}
+
+static void testSingleEdit(ft2_undo_journal_t *journal, ft2_instance_t *inst, bool whole)
+{
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+	const int32_t x1 = whole ? 0 : UNDO_SMP_LEN / 2;
+	const int32_t count = whole ? UNDO_SMP_LEN : UNDO_SMP_LEN / 100;
+	const char *name = whole ? "whole" : "range";
+	const uint64_t hashBefore = hashSample(s);
+
+	ft2_undo_begin(journal, inst, 1, 0, x1, count, true);
+	ft2_test_negate_range(s, x1, x1 + count);
+	ft2_undo_end(journal, inst);
+	const uint64_t hashAfter = hashSample(s);
+
+	/* The region before and after, not the sample */
+	if (!whole) {
+		FT2_TEST_CHECK(journal->bytesUsed < (size_t)count * 4 + 4096, "%s: %zu journal bytes for a %d-byte region",
+			name, journal->bytesUsed, count * 2);
+	}
+
+	FT2_TEST_CHECK(ft2_undo_step(journal, inst, 1, 0, false, NULL), "%s: undo failed", name);
+	settleHandoff(inst);
+	FT2_TEST_CHECK(hashSample(s) == hashBefore, "%s: undo didn't restore the sample", name);
+
+	FT2_TEST_CHECK(ft2_undo_step(journal, inst, 1, 0, true, NULL), "%s: redo failed", name);
+	settleHandoff(inst);
+	FT2_TEST_CHECK(hashSample(s) == hashAfter, "%s: redo didn't restore the edit", name);
+
+	ft2_undo_free(journal);
+}
+
+/* In-place and length-changing edits mixed, all undone and then redone,
+ * every level checked against the state it came from */
+static void testHistory(ft2_undo_journal_t *journal, ft2_instance_t *inst)
+{
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+	uint64_t hashes[UNDO_LEVELS + 1];
+	hashes[0] = hashSample(s);
+
+	uint32_t seed = 0x13579BDu;
+	for (int32_t i = 0; i < UNDO_LEVELS; i++) {
+		seed = seed * 1103515245u + 12345u;
+		const int32_t count = ((i & 3) == 3) ? 1000 : s->length / 100;
+		const int32_t x1 = (int32_t)((seed >> 8) % (uint32_t)(s->length - count));
+
+		ft2_undo_begin(journal, inst, 1, 0, x1, count, true);
+		if ((i & 3) == 3)
+			ft2_test_delete_range(s, x1, x1 + count);
+		else
+			ft2_test_negate_range(s, x1, x1 + count);
+		hashes[i + 1] = hashSample(s);
+	}
+	ft2_undo_end(journal, inst);
+
+	const size_t historyBytes = journal->bytesUsed;
+	bool ok = FT2_TEST_CHECK(journal->numEntries == UNDO_LEVELS, "history: %u levels recorded", journal->numEntries);
+
+	for (int32_t i = UNDO_LEVELS - 1; i >= 0 && ok; i--) {
+		ok = ft2_undo_step(journal, inst, 1, 0, false, NULL);
+		settleHandoff(inst);
+		ok = FT2_TEST_CHECK(ok && hashSample(s) == hashes[i], "history: undo to level %d", i);
+	}
+	FT2_TEST_CHECK(!ft2_undo_step(journal, inst, 1, 0, false, NULL), "history: undo past the first level");
+
+	for (int32_t i = 1; i <= UNDO_LEVELS && ok; i++) {
+		ok = ft2_undo_step(journal, inst, 1, 0, true, NULL);
+		settleHandoff(inst);
+		ok = FT2_TEST_CHECK(ok && hashSample(s) == hashes[i], "history: redo to level %d", i);
+	}
+
+	/* A quarter of the budget keeps the newest levels, and they still undo */
+	ft2_undo_set_mem_cap(journal, historyBytes / 4);
+	const uint32_t levelsKept = journal->numEntries;
+	FT2_TEST_CHECK(levelsKept > 1 && levelsKept < UNDO_LEVELS && journal->bytesUsed <= historyBytes / 4,
+		"history: %u levels in a quarter of the budget", levelsKept);
+	for (uint32_t i = 0; i < levelsKept && ok; i++) {
+		ok = ft2_undo_step(journal, inst, 1, 0, false, NULL);
+		settleHandoff(inst);
+		ok = FT2_TEST_CHECK(ok && hashSample(s) == hashes[UNDO_LEVELS - 1 - i], "history: capped undo %u", i);
+	}
+
+	ft2_undo_free(journal);
+}
+
+/* An edit that bypasses the journal, with the same length and depth:
+ * undo must refuse rather than write the old region over it */
+static void testBypassed(ft2_undo_journal_t *journal, ft2_instance_t *inst)
+{
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+
+	ft2_undo_begin(journal, inst, 1, 0, 0, 1000, true);
+	ft2_test_negate_range(s, 0, 1000);
+	ft2_undo_end(journal, inst);
+	ft2_test_negate_range(s, 500, 1500);
+
+	const uint64_t hashBypassed = hashSample(s);
+	FT2_TEST_CHECK(!ft2_undo_step(journal, inst, 1, 0, false, NULL) && journal->numEntries == 0 &&
+		hashSample(s) == hashBypassed, "bypassed: undone over an edit it didn't record");
+
+	ft2_undo_free(journal);
+}
+
+/* Loading a module drops the editor's history */
+static void testLoadDropsHistory(ft2_instance_t *inst)
+{
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+	ft2_ui_t *ui = ft2_ui_create();
+	uint8_t *moduleData = NULL;
+	uint32_t moduleSize = 0;
+
+	if (FT2_TEST_CHECK(ui != NULL && ft2_save_module(inst, &moduleData, &moduleSize), "load: setup failed")) {
+		inst->ui = ui;
+		inst->editor.curInstr = 1;
+		inst->editor.curSmp = 0;
+		fillSampleUndoRange(inst, 0, 1000, true);
+		ft2_test_negate_range(s, 0, 1000);
+		fillSampleUndoRange(inst, 0, 1000, true);
+		FT2_TEST_CHECK(ui->sampleEditor.undo.numEntries == 2, "load: %u entries before loading",
+			ui->sampleEditor.undo.numEntries);
+
+		FT2_TEST_CHECK(ft2_load_module(inst, moduleData, moduleSize), "load: module didn't load");
+		FT2_TEST_CHECK(ui->sampleEditor.undo.numEntries == 0 && ui->sampleEditor.undo.bytesUsed == 0,
+			"load: history kept");
+		inst->ui = NULL;
+	}
+
+	free(moduleData);
+	ft2_ui_destroy(ui);
+}
+
+int main(void)
+{
+	ft2_undo_journal_t journal;
+	ft2_undo_init(&journal);
+
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (FT2_TEST_CHECK(inst != NULL && ft2_test_setup_undo_sample(inst, UNDO_SMP_LEN), "instance setup failed")) {
+		testSingleEdit(&journal, inst, false);
+		testSingleEdit(&journal, inst, true);
+		testHistory(&journal, inst);
+		testBypassed(&journal, inst);
+		testLoadDropsHistory(inst);
+	}
+
+	ft2_undo_free(&journal);
+	if (inst != NULL)
+		settleHandoff(inst);
+	ft2_instance_destroy(inst);
+	return ft2_test_finish("sample_undo");
+}
@@ -0,0 +1,96 @@
+/**
+ * @file ft2_plugin_smpfx_test.c
+ * @brief The sample effects against the one-sample-at-a-time loops they
+ * replaced.
+ *
+ * Filters with and without normalization, bass/treble and amplify, at 8
+ * and 16 bits on a 1M-frame sample: at most 1 LSB off.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ft2_test.h"
+
+#define SMPFX_LEN 1000000
+
+typedef struct smpFxCase_t {
+	const char *name;
+	uint8_t op, filter; /* filter: 0 none, 1 lowpass, 2 highpass */
+	double cutoff, mix;
+	uint32_t resonance;
+	bool normalize, sample16Bit;
+	int32_t amp; /* Percent */
+} smpFxCase_t;
+
+int main(void)
+{
+	/* The editor's buttons: bass/treble use these cutoffs, the filter
+	 * panel a cutoff in Hz (here already divided by the sample rate) */
+	static const smpFxCase_t cases[] = {
+		{ "lowpass",       SMPFX_OP_FILTER,       1, 0.05,  0.0,   0,  false, true,  0 },
+		{ "lowpass_reso",  SMPFX_OP_FILTER,       1, 0.02,  0.0,   80, false, true,  0 },
+		{ "lowpass_norm",  SMPFX_OP_FILTER,       1, 0.05,  0.0,   0,  true,  true,  0 },
+		{ "highpass_norm", SMPFX_OP_FILTER,       2, 0.1,   0.0,   40, true,  true,  0 },
+		{ "sub_bass",      SMPFX_OP_FILTER,       2, 0.001, 0.0,   0,  false, true,  0 },
+		{ "add_bass",      SMPFX_OP_MIX_FILTERED, 1, 0.015, 0.25,  0,  false, true,  0 },
+		{ "add_treble",    SMPFX_OP_MIX_FILTERED, 2, 0.27,  -0.25, 0,  false, true,  0 },
+		{ "amp_75",        SMPFX_OP_AMP,          0, 0.0,   0.0,   0,  false, true,  75 },
+		{ "amp_250",       SMPFX_OP_AMP,          0, 0.0,   0.0,   0,  false, true,  250 },
+		{ "lowpass_8bit",  SMPFX_OP_FILTER,       1, 0.05,  0.0,   0,  false, false, 0 },
+		{ "add_treble_8bit", SMPFX_OP_MIX_FILTERED, 2, 0.27, -0.25, 0, false, false, 0 },
+		{ "amp_250_8bit",  SMPFX_OP_AMP,          0, 0.0,   0.0,   0,  false, false, 250 }
+	};
+
+	int16_t *src = (int16_t *)malloc((size_t)SMPFX_LEN * sizeof(int16_t));
+	int8_t *ref = (int8_t *)malloc((size_t)SMPFX_LEN * sizeof(int16_t));
+	int8_t *out = (int8_t *)malloc((size_t)SMPFX_LEN * sizeof(int16_t));
+	if (!FT2_TEST_CHECK(src != NULL && ref != NULL && out != NULL, "out of memory")) {
+		free(src); free(ref); free(out);
+		return ft2_test_finish("smpfx");
+	}
+
+	for (int32_t c = 0; c < (int32_t)(sizeof(cases) / sizeof(cases[0])); c++) {
+		const smpFxCase_t *tc = &cases[c];
+
+		/* A tone plus noise, at the bit depth of the case */
+		uint32_t seed = 0x13579BDu;
+		for (int32_t i = 0; i < SMPFX_LEN; i++) {
+			seed = seed * 1103515245u + 12345u;
+			const int32_t x = (int32_t)(sin(i * 0.021) * 14000.0) + (int32_t)((seed >> 16) & 0x3FFF) - 0x2000;
+			if (tc->sample16Bit)
+				src[i] = (int16_t)x;
+			else
+				((int8_t *)src)[i] = (int8_t)(x >> 8);
+		}
+
+		smpfx_params_t p;
+		memset(&p, 0, sizeof(p));
+		if (tc->filter == 1)
+			smpfx_setup_lowpass(&p, tc->cutoff, tc->resonance);
+		else if (tc->filter == 2)
+			smpfx_setup_highpass(&p, tc->cutoff, tc->resonance);
+		p.op = tc->op;
+		p.normalize = tc->normalize;
+		p.mix = tc->mix;
+		p.ampMul = (int32_t)round((1 << 22UL) * (tc->amp / 100.0));
+
+		ft2_test_smpfx_by_loop(&p, (const int8_t *)src, ref, SMPFX_LEN, tc->sample16Bit);
+		const bool rendered = smpfx_render(&p, (const int8_t *)src, out, SMPFX_LEN, tc->sample16Bit, NULL);
+
+		int32_t maxDiff = 0;
+		for (int32_t i = 0; i < SMPFX_LEN; i++) {
+			const int32_t a = tc->sample16Bit ? ((int16_t *)ref)[i] : ref[i];
+			const int32_t o = tc->sample16Bit ? ((int16_t *)out)[i] : out[i];
+			if (abs(a - o) > maxDiff)
+				maxDiff = abs(a - o);
+		}
+
+		FT2_TEST_CHECK(rendered && maxDiff <= 1, "%s: off by up to %d", tc->name, maxDiff);
+	}
+
+	free(src);
+	free(ref);
+	free(out);
+	return ft2_test_finish("smpfx");
+}
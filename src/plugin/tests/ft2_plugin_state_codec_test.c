@@ -0,0 +1,112 @@
+/**
+ * @file ft2_plugin_state_codec_test.c
+ * @brief Packing of the plugin state's XM file (ft2_plugin_state_codec.h).
+ *
+ * A synthetic module with every sample type, a silent one (which packs
+ * closest to FT2_STATE_MAX_RATIO) and each corpus module. The packed
+ * stream must unpack to the exact XM file, stay within the ratio, and be
+ * turned down when truncated or unpacked to more than the ratio allows;
+ * the unpacked file must load.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_test.h"
+#include "ft2_plugin_state_codec.h"
+#include "ft2_plugin_loader.h"
+
+#define STATE_SMP_LEN (1 << 20)
+
+typedef struct stateBuf_t {
+	uint8_t *data;
+	uint32_t size, cap;
+} stateBuf_t;
+
+static bool stateBufWrite(void *userData, const uint8_t *data, uint32_t size)
+{
+	stateBuf_t *buf = (stateBuf_t *)userData;
+	if (buf->size + size > buf->cap) {
+		const uint32_t cap = (buf->size + size) + (buf->size + size) / 2;
+		uint8_t *p = (uint8_t *)realloc(buf->data, cap);
+		if (p == NULL)
+			return false;
+		buf->data = p;
+		buf->cap = cap;
+	}
+	memcpy(&buf->data[buf->size], data, size);
+	buf->size += size;
+	return true;
+}
+
+static void testState(ft2_instance_t *inst, const char *name)
+{
+	uint8_t *xm = NULL, *unpacked = NULL;
+	uint32_t xmSize = 0, moduleSize = 0, packedSize = 0;
+	stateBuf_t packed = { NULL, 0, 0 };
+
+	if (!FT2_TEST_CHECK(ft2_save_module(inst, &xm, &xmSize) &&
+		ft2_state_pack_module(inst, stateBufWrite, &packed, &moduleSize, &packedSize), "%s: pack failed", name))
+		goto done;
+	FT2_TEST_CHECK(moduleSize == xmSize && packedSize == packed.size, "%s: packed %u into %u bytes, wrote %u of %u",
+		name, moduleSize, packedSize, packed.size, xmSize);
+
+	unpacked = (uint8_t *)calloc(1, xmSize);
+	if (!FT2_TEST_CHECK(unpacked != NULL, "%s: out of memory", name))
+		goto done;
+
+	if (!FT2_TEST_CHECK(ft2_state_unpack(packed.data, packed.size, unpacked, xmSize) &&
+		memcmp(unpacked, xm, xmSize) == 0, "%s: doesn't unpack to the XM file", name))
+		goto done;
+
+	FT2_TEST_CHECK(!ft2_state_unpack(packed.data, packed.size - 1, unpacked, xmSize),
+		"%s: truncated stream unpacked", name);
+
+	/* A valid state stays within the bound the plugin checks before
+	 * allocating, and a stored size past it is turned down */
+	FT2_TEST_CHECK((uint64_t)xmSize <= (uint64_t)packed.size * FT2_STATE_MAX_RATIO,
+		"%s: %u bytes packed into %u, past the ratio", name, xmSize, packed.size);
+	FT2_TEST_CHECK(!ft2_state_unpack(packed.data, packed.size, unpacked, packed.size * FT2_STATE_MAX_RATIO + 1),
+		"%s: unpacked past the ratio", name);
+
+	ft2_state_unpack(packed.data, packed.size, unpacked, xmSize);
+	ft2_instance_t *loaded = ft2_instance_create(48000);
+	FT2_TEST_CHECK(loaded != NULL && ft2_load_module(loaded, unpacked, xmSize), "%s: unpacked file doesn't load", name);
+	ft2_instance_destroy(loaded);
+
+	char key[128];
+	snprintf(key, sizeof(key), "state:%s", name);
+	ft2_test_check_hash(key, ft2_test_hash(FT2_TEST_HASH_INIT, packed.data, packed.size));
+
+done:
+	free(unpacked);
+	free(packed.data);
+	free(xm);
+}
+
+int main(void)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (FT2_TEST_CHECK(inst != NULL && ft2_test_setup_save_module(inst, STATE_SMP_LEN), "synthetic: can't set up"))
+		testState(inst, "synthetic");
+	ft2_instance_destroy(inst);
+
+	inst = ft2_instance_create(48000);
+	if (FT2_TEST_CHECK(inst != NULL && ft2_test_setup_silent_module(inst, STATE_SMP_LEN), "silent: can't set up"))
+		testState(inst, "silent");
+	ft2_instance_destroy(inst);
+
+	for (int32_t i = 0; i < FT2_TEST_CORPUS_FILES; i++) {
+		const char *name = ft2_test_corpus_name(i);
+		uint32_t fileSize = 0;
+		uint8_t *fileData = ft2_test_read_corpus(i, &fileSize);
+		inst = ft2_instance_create(48000);
+		if (FT2_TEST_CHECK(fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize),
+			"%s: can't load", name))
+			testState(inst, name);
+		ft2_instance_destroy(inst);
+		free(fileData);
+	}
+
+	return ft2_test_finish("state_codec");
+}
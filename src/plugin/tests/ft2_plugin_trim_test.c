@@ -0,0 +1,319 @@
+/**
+ * @file ft2_plugin_trim_test.c
+ * @brief The Trim screen: size estimates and the trim itself.
+ *
+ * The estimate for a synthetic module and each corpus module against the
+ * golden hashes, then all of them estimating at once, each on its own
+ * thread, where every result must be the one it got alone. Trim's 8-bit
+ * conversion must leave the samples another instance shares alone, and
+ * trimming with every option while the audio thread plays must not cut a
+ * voice.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ft2_test.h"
+#include "ft2_plugin_loader.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_ui.h"
+#include "ft2_plugin_sample_pool.h"
+#include "ft2_plugin_trim.h"
+#include "ft2_plugin_input.h"
+
+#define TRIM_REPS 5
+#define MAX_TRIM_CASES 8
+
+typedef struct trimCase_t {
+	char name[128];
+	ft2_instance_t *inst;
+	ft2_ui_t *ui;
+	int64_t xmSize64, afterTrimSize64;
+	uint32_t mismatches;
+} trimCase_t;
+
+/* Estimates over and over; every result must be the one it got alone */
+static void trimEstimateLoop(void *arg)
+{
+	trimCase_t *c = (trimCase_t *)arg;
+	ft2_trim_state_t *trim = &c->ui->trimState;
+	for (int32_t r = 0; r < TRIM_REPS; r++) {
+		pbTrimCalc(c->inst);
+		if (trim->xmSize64 != c->xmSize64 || trim->xmAfterTrimSize64 != c->afterTrimSize64)
+			c->mismatches++;
+	}
+}
+
+/* The Trim screen's "Calculate" with every option but 8-bit conversion on */
+static bool setupTrimCase(trimCase_t *c, ft2_instance_t *inst, const char *name)
+{
+	snprintf(c->name, sizeof(c->name), "%s", name);
+	c->inst = inst;
+	c->ui = ft2_ui_create();
+	c->mismatches = 0;
+	if (c->ui == NULL)
+		return false;
+
+	inst->ui = c->ui;
+	setInitialTrimFlags(inst);
+	pbTrimCalc(inst);
+
+	c->xmSize64 = c->ui->trimState.xmSize64;
+	c->afterTrimSize64 = c->ui->trimState.xmAfterTrimSize64;
+
+	const int64_t sizes[2] = { c->xmSize64, c->afterTrimSize64 };
+	char key[160];
+	snprintf(key, sizeof(key), "trim:%s", name);
+	ft2_test_check_hash(key, ft2_test_hash(FT2_TEST_HASH_INIT, sizes, sizeof(sizes)));
+	return true;
+}
+
+static void testEstimates(void)
+{
+	trimCase_t cases[MAX_TRIM_CASES];
+	int32_t numCases = 0;
+
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (FT2_TEST_CHECK(inst != NULL && ft2_test_setup_trim_module(inst) &&
+		setupTrimCase(&cases[numCases], inst, "synthetic"), "synthetic: can't set up"))
+		numCases++;
+	else
+		ft2_instance_destroy(inst);
+
+	for (int32_t i = 0; i < FT2_TEST_CORPUS_FILES && numCases < MAX_TRIM_CASES; i++) {
+		const char *name = ft2_test_corpus_name(i);
+		uint32_t fileSize = 0;
+		uint8_t *fileData = ft2_test_read_corpus(i, &fileSize);
+		inst = ft2_instance_create(48000);
+		if (FT2_TEST_CHECK(fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize) &&
+			setupTrimCase(&cases[numCases], inst, name), "%s: can't load", name))
+			numCases++;
+		else
+			ft2_instance_destroy(inst);
+		free(fileData);
+	}
+
+	/* Every instance estimating at once, each on its own thread */
+	ft2_test_thread_t threads[MAX_TRIM_CASES];
+	bool started[MAX_TRIM_CASES];
+	for (int32_t i = 0; i < numCases; i++) {
+		started[i] = ft2_test_thread_start(&threads[i], trimEstimateLoop, &cases[i]);
+		if (!started[i])
+			trimEstimateLoop(&cases[i]);
+	}
+
+	for (int32_t i = 0; i < numCases; i++) {
+		if (started[i])
+			ft2_test_thread_join(&threads[i]);
+		FT2_TEST_CHECK(cases[i].mismatches == 0, "%s: %u of %d concurrent estimates differ",
+			cases[i].name, cases[i].mismatches, TRIM_REPS);
+
+		cases[i].inst->ui = NULL;
+		ft2_ui_destroy(cases[i].ui);
+		ft2_instance_destroy(cases[i].inst);
+	}
+}
+
+static uint64_t hashSampleData(const ft2_sample_t *s)
+{
+	const size_t bytes = (size_t)s->length * ((s->flags & FT2_SAMPLE_16BIT) ? 2 : 1);
+	return (s->dataPtr != NULL) ? ft2_test_hash(FT2_TEST_HASH_INIT, s->dataPtr, bytes) : 0;
+}
+
+/* Trim's 8-bit conversion on one instance, whose samples are pooled with
+ * another instance's: the other instance's samples must not change */
+static void testShared(void)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	ft2_instance_t *other = ft2_instance_create(48000);
+	ft2_ui_t *ui = ft2_ui_create();
+	if (!FT2_TEST_CHECK(inst != NULL && other != NULL && ui != NULL && ft2_test_setup_mix_instruments(inst) &&
+		ft2_test_setup_mix_instruments(other), "shared: can't set up")) {
+		ft2_ui_destroy(ui);
+		ft2_instance_destroy(other);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	uint64_t otherHash[6];
+	int32_t numShared = 0;
+	for (int32_t i = 1; i <= 6; i++) {
+		ft2_sample_t *s = &inst->replayer.instr[i]->smp[0];
+		ft2_sample_t *o = &other->replayer.instr[i]->smp[0];
+		ft2_sample_pool_intern(s, ft2_sample_pool_hash(s->origDataPtr, ft2_sample_pool_data_size(s)));
+		ft2_sample_pool_intern(o, ft2_sample_pool_hash(o->origDataPtr, ft2_sample_pool_data_size(o)));
+		if (s->origDataPtr == o->origDataPtr)
+			numShared++;
+		otherHash[i - 1] = hashSampleData(o);
+	}
+
+	inst->ui = ui;
+	ft2_trim_state_t *trim = &ui->trimState;
+	trim->removePatt = trim->removeInst = trim->removeSamp = false;
+	trim->removeChans = trim->removeSmpDataAfterLoop = false;
+	trim->convSmpsTo8Bit = true;
+	pbTrimDoTrim(inst);
+	ft2_dialog_key_down(&ui->dialog, FT2_KEY_RETURN);
+
+	int32_t converted = 0, otherChanged = 0;
+	for (int32_t i = 1; i <= 6; i++) {
+		const ft2_sample_t *o = &other->replayer.instr[i]->smp[0];
+		if (!(inst->replayer.instr[i]->smp[0].flags & FT2_SAMPLE_16BIT) && (o->flags & FT2_SAMPLE_16BIT))
+			converted++;
+		if (hashSampleData(o) != otherHash[i - 1])
+			otherChanged++;
+	}
+
+	FT2_TEST_CHECK(numShared == 6, "shared: %d of 6 samples pooled", numShared);
+	FT2_TEST_CHECK(converted == 3, "shared: %d of 3 samples converted", converted);
+	FT2_TEST_CHECK(otherChanged == 0, "shared: %d of the other instance's samples changed", otherChanged);
+
+	inst->ui = NULL;
+	ft2_ui_destroy(ui);
+	ft2_instance_destroy(other);
+	ft2_instance_destroy(inst);
+}
+
+typedef struct trimAudio_t {
+	ft2_instance_t *inst;
+	volatile int32_t stop;
+	uint32_t voicesCut;
+} trimAudio_t;
+
+static float audioOutL[256], audioOutR[256];
+
+static void trimAudioLoop(void *arg)
+{
+	trimAudio_t *a = (trimAudio_t *)arg;
+	while (!ft2_test_flag_get(&a->stop)) {
+		bool wasActive[FT2_MAX_CHANNELS];
+		for (int32_t i = 0; i < FT2_MAX_CHANNELS; i++)
+			wasActive[i] = a->inst->voice[i].active;
+
+		ft2_mix_voices_only(a->inst, audioOutL, audioOutR, 256);
+
+		/* The samples all loop, so a voice only stops if something cut it */
+		for (int32_t i = 0; i < FT2_MAX_CHANNELS; i++) {
+			if (wasActive[i] && !a->inst->voice[i].active)
+				a->voicesCut++;
+		}
+	}
+}
+
+/* Every trim option at once while an audio thread keeps 16 voices going.
+ * The looped instruments (2, 3, 5, 6) are the used ones and each plays
+ * its second sample, so instruments, samples, patterns and channels all
+ * get renumbered under the voices; none of them may be cut. */
+static void testPlaying(void)
+{
+	static const uint8_t looped[4] = { 2, 3, 5, 6 };
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	ft2_ui_t *ui = ft2_ui_create();
+	bool setupOk = (inst != NULL && ui != NULL && ft2_test_setup_mix_instruments(inst) &&
+		ft2_pattern_set_stride(inst, 32) && ft2_pattern_alloc(inst, 0) && ft2_pattern_alloc(inst, 1));
+
+	/* An unused sample in front of each played one */
+	for (int32_t i = 0; setupOk && i < 4; i++) {
+		ft2_instr_t *ins = inst->replayer.instr[looped[i]];
+		ins->smp[1] = ins->smp[0];
+		memset(&ins->smp[0], 0, sizeof(ft2_sample_t));
+
+		ft2_sample_t *s = &ins->smp[0];
+		s->origDataPtr = (int8_t *)calloc(1, 64 + FT2_MAX_TAPS * 2);
+		setupOk = (s->origDataPtr != NULL);
+		if (setupOk) {
+			s->dataPtr = s->origDataPtr + FT2_MAX_TAPS;
+			s->length = 64;
+			ft2_fix_sample(s);
+		}
+		memset(ins->note2SampleLUT, 1, sizeof(ins->note2SampleLUT));
+	}
+
+	if (!FT2_TEST_CHECK(setupOk, "playing: can't set up")) {
+		ft2_ui_destroy(ui);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	/* Pattern 1 isn't in the order list, channels 16-31 are empty */
+	inst->replayer.song.numChannels = 32;
+	inst->replayer.song.songLength = 1;
+	ft2_pattern_note(inst, 1, 0, 0)->note = 49;
+	for (int32_t ch = 0; ch < 16; ch++) {
+		ft2_note_t *n = ft2_pattern_note(inst, 0, 0, ch);
+		n->note = (uint8_t)(37 + ch * 3);
+		n->instr = looped[ch & 3];
+		ft2_instance_trigger_note(inst, (int8_t)(37 + ch * 3), looped[ch & 3], (uint8_t)ch, 48, 0, 0);
+	}
+	ft2_mix_voices_only(inst, audioOutL, audioOutR, 256);
+
+	trimAudio_t audio = { inst, 0, 0 };
+	ft2_test_thread_t thread;
+	if (!FT2_TEST_CHECK(ft2_test_thread_start(&thread, trimAudioLoop, &audio), "playing: can't start the audio thread")) {
+		ft2_ui_destroy(ui);
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	inst->ui = ui;
+	ft2_trim_state_t *trim = &ui->trimState;
+	trim->removePatt = trim->removeInst = trim->removeSamp = true;
+	trim->removeChans = trim->removeSmpDataAfterLoop = true;
+	trim->convSmpsTo8Bit = true;
+	ft2_test_sleep_ms(2);
+	pbTrimDoTrim(inst);
+	ft2_dialog_key_down(&ui->dialog, FT2_KEY_RETURN);
+
+	for (int32_t i = 0; i < 10; i++) {
+		ft2_sample_handoff_sync(inst);
+		ft2_test_sleep_ms(1);
+	}
+
+	ft2_test_flag_set(&audio.stop);
+	ft2_test_thread_join(&thread);
+
+	ft2_sample_handoff_sync(inst);
+	ft2_sample_handoff_sync(inst);
+	const uint32_t leftOver = inst->handoff.numRetired - inst->handoff.numReclaimed;
+
+	/* Instruments 2, 3, 5, 6 are 1-4 now, each with its sample first */
+	int32_t voicesPlaying = 0, channelsFollowed = 0;
+	for (int32_t ch = 0; ch < 16; ch++) {
+		const uint8_t newInstr = (uint8_t)(1 + (ch & 3));
+		const ft2_instr_t *ins = inst->replayer.instr[newInstr];
+		const ft2_voice_t *v = &inst->voice[ch];
+		const ft2_channel_t *c = &inst->replayer.channel[ch];
+		const int8_t *base = (v->base16 != NULL) ? (const int8_t *)v->base16 : v->base8;
+
+		/* ...with the edge taps of the sample's new slot */
+		const void *taps = (v->base16 != NULL) ? (const void *)v->leftEdgeTaps16 : (const void *)v->leftEdgeTaps8;
+		const void *slotTaps = (ins == NULL) ? NULL : (v->base16 != NULL) ?
+			(const void *)(ins->smp[0].leftEdgeTapSamples16 + FT2_MAX_LEFT_TAPS) :
+			(const void *)(ins->smp[0].leftEdgeTapSamples8 + FT2_MAX_LEFT_TAPS);
+
+		if (ins != NULL && v->active && base == ins->smp[0].dataPtr && taps == slotTaps)
+			voicesPlaying++;
+		if (ins != NULL && c->instrNum == newInstr && c->instrPtr == ins && c->smpNum == 0 && c->smpPtr == &ins->smp[0])
+			channelsFollowed++;
+	}
+
+	FT2_TEST_CHECK(audio.voicesCut == 0, "playing: %u voices cut", audio.voicesCut);
+	FT2_TEST_CHECK(voicesPlaying == 16, "playing: %d of 16 voices play the renumbered samples", voicesPlaying);
+	FT2_TEST_CHECK(channelsFollowed == 16, "playing: %d of 16 channels follow them", channelsFollowed);
+	FT2_TEST_CHECK(leftOver == 0, "playing: %u retired buffers not reclaimed", leftOver);
+	FT2_TEST_CHECK(inst->replayer.song.numChannels == 16 && inst->replayer.pattern[1] == NULL,
+		"playing: %d channels left, pattern 1 %s", inst->replayer.song.numChannels,
+		(inst->replayer.pattern[1] == NULL) ? "removed" : "kept");
+
+	inst->ui = NULL;
+	ft2_ui_destroy(ui);
+	ft2_instance_destroy(inst);
+}
+
+int main(void)
+{
+	testEstimates();
+	testShared();
+	testPlaying();
+	return ft2_test_finish("trim");
+}
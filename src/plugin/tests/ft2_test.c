@@ -0,0 +1,233 @@
+/**
+ * @file ft2_test.c
+ * @brief Checks, timing, threads, hashing and corpus access for the tests
+ * and the benchmark.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L /* clock_gettime(), nanosleep() under -std=c11 */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#ifndef _WIN32
+#include <time.h>
+#endif
+#include "ft2_test.h"
+
+#define MAX_GOLDEN 1024
+
+typedef struct goldenEntry_t {
+	char key[256];
+	uint64_t hash;
+} goldenEntry_t;
+
+static goldenEntry_t golden[MAX_GOLDEN];
+static int32_t numGolden = -1; /* -1 until loaded */
+static int32_t numChecks, numFailed;
+
+static const char *corpusNames[FT2_TEST_CORPUS_FILES] = {
+	"xm8ch.xm", "xm32ch.xm", "xm4ch.xm", "mod4ch.mod", "s3m.s3m", "s3m_truncated.s3m", "adpcm.xm"
+};
+
+/* ------------------------------------------------------------------------- */
+/*                                 Checks                                    */
+/* ------------------------------------------------------------------------- */
+
+bool ft2_test_check(bool ok, const char *file, int line, const char *fmt, ...)
+{
+	numChecks++;
+	if (ok)
+		return true;
+
+	numFailed++;
+	fprintf(stderr, "%s:%d: FAILED: ", ft2_test_base_name(file), line);
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	fputc('\n', stderr);
+	return false;
+}
+
+static void loadGolden(void)
+{
+	numGolden = 0;
+
+	FILE *f = fopen(FT2_TEST_GOLDEN_FILE, "r");
+	if (f == NULL) {
+		fprintf(stderr, "can't read %s\n", FT2_TEST_GOLDEN_FILE);
+		return;
+	}
+
+	char line[512];
+	while (numGolden < MAX_GOLDEN && fgets(line, sizeof(line), f) != NULL) {
+		goldenEntry_t *g = &golden[numGolden];
+		unsigned long long hash;
+		if (sscanf(line, "%255s %llx", g->key, &hash) == 2) {
+			g->hash = hash;
+			numGolden++;
+		}
+	}
+
+	fclose(f);
+}
+
+bool ft2_test_check_hash(const char *key, uint64_t hash)
+{
+	if (numGolden < 0)
+		loadGolden();
+
+	for (int32_t i = 0; i < numGolden; i++) {
+		if (strcmp(golden[i].key, key) == 0) {
+			return FT2_TEST_CHECK(golden[i].hash == hash, "golden mismatch: %s (expected %016llx)\n%s %016llx",
+				key, (unsigned long long)golden[i].hash, key, (unsigned long long)hash);
+		}
+	}
+
+	return FT2_TEST_CHECK(false, "no golden hash:\n%s %016llx", key, (unsigned long long)hash);
+}
+
+int ft2_test_finish(const char *name)
+{
+	printf("%s: %d checks, %d failed\n", name, numChecks, numFailed);
+	return (numFailed > 0 || numChecks == 0) ? 1 : 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                        Timing, threads, hashing                           */
+/* ------------------------------------------------------------------------- */
+
+double ft2_test_now(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, t;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&t);
+	return (double)t.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (ts.tv_nsec / 1e9);
+#endif
+}
+
+void ft2_test_sleep_ms(int32_t ms)
+{
+#ifdef _WIN32
+	Sleep((DWORD)ms);
+#else
+	const struct timespec ts = { 0, ms * 1000000L };
+	nanosleep(&ts, NULL);
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI threadMain(LPVOID arg)
+{
+	ft2_test_thread_t *t = (ft2_test_thread_t *)arg;
+	t->run(t->arg);
+	return 0;
+}
+#else
+static void *threadMain(void *arg)
+{
+	ft2_test_thread_t *t = (ft2_test_thread_t *)arg;
+	t->run(t->arg);
+	return NULL;
+}
+#endif
+
+bool ft2_test_thread_start(ft2_test_thread_t *t, void (*run)(void *arg), void *arg)
+{
+	t->run = run;
+	t->arg = arg;
+#ifdef _WIN32
+	t->handle = CreateThread(NULL, 0, threadMain, t, 0, NULL);
+	return t->handle != NULL;
+#else
+	return pthread_create(&t->handle, NULL, threadMain, t) == 0;
+#endif
+}
+
+void ft2_test_thread_join(ft2_test_thread_t *t)
+{
+#ifdef _WIN32
+	WaitForSingleObject(t->handle, INFINITE);
+	CloseHandle(t->handle);
+#else
+	pthread_join(t->handle, NULL);
+#endif
+}
+
+uint64_t ft2_test_hash(uint64_t h, const void *p, size_t n)
+{
+	const uint8_t *b = (const uint8_t *)p;
+	for (size_t i = 0; i < n; i++) {
+		h ^= b[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+uint64_t ft2_test_hash_floats(uint64_t h, const float *p, uint32_t n)
+{
+	return ft2_test_hash(h, p, (size_t)n * sizeof(float));
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                 Corpus                                    */
+/* ------------------------------------------------------------------------- */
+
+const char *ft2_test_corpus_name(int32_t i)
+{
+	return (i >= 0 && i < FT2_TEST_CORPUS_FILES) ? corpusNames[i] : NULL;
+}
+
+uint8_t *ft2_test_read_corpus(int32_t i, uint32_t *outSize)
+{
+	char path[512];
+	if (ft2_test_corpus_name(i) == NULL)
+		return NULL;
+
+	snprintf(path, sizeof(path), "%s/%s", FT2_TEST_CORPUS_DIR, corpusNames[i]);
+	return ft2_test_read_file(path, outSize);
+}
+
+uint8_t *ft2_test_read_file(const char *path, uint32_t *outSize)
+{
+	FILE *f = fopen(path, "rb");
+	if (f == NULL)
+		return NULL;
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size <= 0) {
+		fclose(f);
+		return NULL;
+	}
+
+	uint8_t *data = (uint8_t *)malloc((size_t)size);
+	if (data != NULL && fread(data, 1, (size_t)size, f) != (size_t)size) {
+		free(data);
+		data = NULL;
+	}
+
+	fclose(f);
+	*outSize = (uint32_t)size;
+	return data;
+}
+
+const char *ft2_test_base_name(const char *path)
+{
+	const char *p = strrchr(path, '/');
+#ifdef _WIN32
+	const char *q = strrchr(path, '\\');
+	if (q != NULL && (p == NULL || q > p))
+		p = q;
+#endif
+	return (p != NULL) ? p + 1 : path;
+}
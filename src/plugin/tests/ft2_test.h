@@ -0,0 +1,140 @@
+/**
+ * @file ft2_test.h
+ * @brief Helpers shared by the ft2_core tests and the benchmark.
+ *
+ * Every test is its own executable, registered with CTest in
+ * plugin/CMakeLists.txt. Failed checks are reported on stderr and make
+ * ft2_test_finish() return 1.
+ *
+ * Tests that hash their output compare it against golden.txt next to this
+ * file (one "key hash" line per case). A missing or different hash fails
+ * the test and prints the line to put there; after a deliberate change to
+ * the output, replace the lines it prints.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "ft2_instance.h"
+#include "ft2_plugin_smpfx.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Set by CMake; otherwise the tests are run from the repository root */
+#ifndef FT2_TEST_CORPUS_DIR
+#define FT2_TEST_CORPUS_DIR "plugin/bench/corpus"
+#endif
+#ifndef FT2_TEST_GOLDEN_FILE
+#define FT2_TEST_GOLDEN_FILE "src/plugin/tests/golden.txt"
+#endif
+
+#define FT2_TEST_HASH_INIT 1469598103934665603ULL /* Seed for ft2_test_hash() (FNV-1a) */
+#define FT2_TEST_MIX_SMP_LEN (1 << 18)
+
+/* ------------------------------------------------------------------------- */
+/*                                 Checks                                    */
+/* ------------------------------------------------------------------------- */
+
+/* Counts a check; when it failed, prints the message (printf format) */
+#define FT2_TEST_CHECK(cond, ...) ft2_test_check((cond), __FILE__, __LINE__, __VA_ARGS__)
+bool ft2_test_check(bool ok, const char *file, int line, const char *fmt, ...);
+
+/* Checks hash against the key's line in FT2_TEST_GOLDEN_FILE */
+bool ft2_test_check_hash(const char *key, uint64_t hash);
+
+/* Prints the totals; returns the exit code (0 if every check passed) */
+int ft2_test_finish(const char *name);
+
+/* ------------------------------------------------------------------------- */
+/*                        Timing, threads, hashing                           */
+/* ------------------------------------------------------------------------- */
+
+double ft2_test_now(void); /* Seconds, monotonic */
+void ft2_test_sleep_ms(int32_t ms); /* 0 just yields */
+
+typedef struct ft2_test_thread_t {
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+	void (*run)(void *arg);
+	void *arg;
+} ft2_test_thread_t;
+
+bool ft2_test_thread_start(ft2_test_thread_t *t, void (*run)(void *arg), void *arg);
+void ft2_test_thread_join(ft2_test_thread_t *t);
+
+/* A stop flag (volatile int32_t) one thread sets and another polls */
+#ifdef _WIN32
+#define ft2_test_flag_set(p) InterlockedExchange((volatile LONG *)(p), 1)
+#define ft2_test_flag_get(p) (InterlockedOr((volatile LONG *)(p), 0) != 0)
+#else
+#define ft2_test_flag_set(p) __atomic_store_n((p), 1, __ATOMIC_RELEASE)
+#define ft2_test_flag_get(p) (__atomic_load_n((p), __ATOMIC_ACQUIRE) != 0)
+#endif
+
+uint64_t ft2_test_hash(uint64_t h, const void *p, size_t n);
+uint64_t ft2_test_hash_floats(uint64_t h, const float *p, uint32_t n);
+
+/* ------------------------------------------------------------------------- */
+/*                                 Corpus                                    */
+/* ------------------------------------------------------------------------- */
+
+/* The small synthetic modules in FT2_TEST_CORPUS_DIR, one or more per
+ * loader path */
+#define FT2_TEST_CORPUS_FILES 7
+
+const char *ft2_test_corpus_name(int32_t i);
+uint8_t *ft2_test_read_corpus(int32_t i, uint32_t *outSize); /* malloc'd */
+uint8_t *ft2_test_read_file(const char *path, uint32_t *outSize); /* malloc'd */
+const char *ft2_test_base_name(const char *path);
+
+/* ------------------------------------------------------------------------- */
+/*                         Fixtures (ft2_test_fixtures.c)                    */
+/* ------------------------------------------------------------------------- */
+
+/* Instrument 1..6: {8-bit, 16-bit} x {no loop, loop, bidi}, each one
+ * sample of FT2_TEST_MIX_SMP_LEN frames */
+bool ft2_test_setup_mix_instruments(ft2_instance_t *inst);
+
+/* Instruments 1..8, an 8-bit and a 16-bit sample each (odd lengths around
+ * len, all loop types), and one pattern */
+bool ft2_test_setup_save_module(ft2_instance_t *inst, int32_t len);
+
+/* One silent 16-bit sample of len frames */
+bool ft2_test_setup_silent_module(ft2_instance_t *inst, int32_t len);
+
+/* 256 patterns of 256 rows, 22 of 32 channels used and only the even
+ * patterns in the order list; 128 instruments, 1..96 played, four samples
+ * each of which the third is past its loop end and the fourth unused */
+bool ft2_test_setup_trim_module(ft2_instance_t *inst);
+
+/* Instrument 1: one looped 16-bit sample of len frames */
+bool ft2_test_setup_undo_sample(ft2_instance_t *inst, int32_t len);
+
+/* The edits the undo journal records: in place on [x1, x2), and cutting
+ * [x1, x2) out of the sample */
+void ft2_test_negate_range(ft2_sample_t *s, int32_t x1, int32_t x2);
+bool ft2_test_delete_range(ft2_sample_t *s, int32_t x1, int32_t x2);
+
+/* Mostly within +-3 (so some clip after a gain of 0.37), with -0 and the
+ * values right at the clip points mixed in */
+void ft2_test_fill_output(float *p, uint32_t n, uint32_t seed);
+
+/* The loops the optimized paths replaced, as references */
+void ft2_test_scale_clamp(float *dst, const float *src, float mul, uint32_t n);
+void ft2_test_sum_scale_clamp(float *dst, float *const *srcs, int32_t numSrcs, float mul, uint32_t n);
+void ft2_test_echo_by_taps(const int8_t *src, int32_t srcLen, int8_t *dst, int32_t dstLen, bool sample16Bit,
+	int32_t distance, double volChange, int32_t numTaps);
+void ft2_test_smpfx_by_loop(const smpfx_params_t *p, const int8_t *src, int8_t *dst, int32_t len, bool sample16Bit);
@@ -0,0 +1,362 @@
+/**
+ * @file ft2_test_fixtures.c
+ * @brief Synthetic modules and samples for the tests and the benchmark,
+ * and the plain loops the optimized paths replaced, as references.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ft2_test.h"
+#include "ft2_plugin_replayer.h"
+#include "ft2_plugin_sample_pool.h"
+
+/* ------------------------------------------------------------------------- */
+/*                                Fixtures                                   */
+/* ------------------------------------------------------------------------- */
+
+bool ft2_test_setup_mix_instruments(ft2_instance_t *inst)
+{
+	for (int32_t i = 0; i < 6; i++) {
+		const bool is16 = (i >= 3);
+		const int32_t loopType = i % 3;
+		const int32_t bps = is16 ? 2 : 1;
+
+		if (!ft2_instance_alloc_instr(inst, (int16_t)(i + 1)))
+			return false;
+
+		ft2_sample_t *s = &inst->replayer.instr[i + 1]->smp[0];
+		s->origDataPtr = (int8_t *)calloc(1, (size_t)FT2_TEST_MIX_SMP_LEN * bps + FT2_MAX_TAPS * bps * 2);
+		if (s->origDataPtr == NULL)
+			return false;
+
+		s->dataPtr = s->origDataPtr + FT2_MAX_TAPS * bps;
+		s->length = FT2_TEST_MIX_SMP_LEN;
+		s->flags = (uint8_t)(loopType | (is16 ? FT2_SAMPLE_16BIT : 0));
+		s->loopStart = (loopType != 0) ? FT2_TEST_MIX_SMP_LEN / 4 : 0;
+		s->loopLength = (loopType != 0) ? FT2_TEST_MIX_SMP_LEN / 2 : 0;
+
+		/* Deterministic noise-ish waveform so interpolation has work to do */
+		uint32_t seed = 0x1234567u + (uint32_t)i;
+		for (int32_t j = 0; j < FT2_TEST_MIX_SMP_LEN; j++) {
+			seed = seed * 1103515245u + 12345u;
+			const double dSmp = sin(j * 0.01) * 0.6 + ((int32_t)(seed >> 16) - 32768) / 65536.0 * 0.3;
+			if (is16)
+				((int16_t *)s->dataPtr)[j] = (int16_t)(dSmp * 32767.0);
+			else
+				s->dataPtr[j] = (int8_t)(dSmp * 127.0);
+		}
+
+		ft2_fix_sample(s);
+	}
+
+	return true;
+}
+
+#define SAVE_INSTRUMENTS 8
+
+bool ft2_test_setup_save_module(ft2_instance_t *inst, int32_t len)
+{
+	uint32_t seed = 0x13579BDu;
+
+	for (int32_t i = 1; i <= SAVE_INSTRUMENTS; i++) {
+		if (!ft2_instance_alloc_instr(inst, (int16_t)i))
+			return false;
+
+		for (int32_t j = 0; j < 2; j++) {
+			const bool is16 = (j == 1);
+			const int32_t bps = is16 ? 2 : 1;
+			const int32_t smpLen = len + (i * 777) + j;
+
+			ft2_sample_t *s = &inst->replayer.instr[i]->smp[j];
+			s->origDataPtr = (int8_t *)calloc(1, (size_t)smpLen * bps + FT2_MAX_TAPS * bps * 2);
+			if (s->origDataPtr == NULL)
+				return false;
+
+			s->dataPtr = s->origDataPtr + FT2_MAX_TAPS * bps;
+			s->length = smpLen;
+			s->flags = (uint8_t)((i % 3) | (is16 ? FT2_SAMPLE_16BIT : 0));
+			s->loopStart = (i % 3) ? smpLen / 3 : 0;
+			s->loopLength = (i % 3) ? smpLen / 2 : 0;
+
+			for (int32_t k = 0; k < smpLen; k++) {
+				seed = seed * 1103515245u + 12345u;
+				const int32_t v = (int32_t)(sin(k * 0.002) * 16000.0) + (int32_t)(seed >> 22) - 512;
+				if (is16)
+					((int16_t *)s->dataPtr)[k] = (int16_t)v;
+				else
+					s->dataPtr[k] = (int8_t)(v >> 8);
+			}
+
+			ft2_fix_sample(s);
+		}
+	}
+
+	if (!ft2_pattern_alloc(inst, 0))
+		return false;
+	for (int32_t row = 0; row < inst->replayer.patternNumRows[0]; row++) {
+		for (int32_t ch = 0; ch < inst->replayer.song.numChannels; ch += 2) {
+			ft2_note_t *n = ft2_pattern_note(inst, 0, row, ch);
+			n->note = (uint8_t)(1 + ((row + ch) % 96));
+			n->instr = (uint8_t)(1 + (row % SAVE_INSTRUMENTS));
+			n->vol = (row & 1) ? 0x30 : 0;
+		}
+	}
+
+	return true;
+}
+
+bool ft2_test_setup_silent_module(ft2_instance_t *inst, int32_t len)
+{
+	if (!ft2_instance_alloc_instr(inst, 1) || !ft2_pattern_alloc(inst, 0))
+		return false;
+
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+	s->origDataPtr = (int8_t *)calloc(1, (size_t)len * 2 + FT2_MAX_TAPS * 2 * 2);
+	if (s->origDataPtr == NULL)
+		return false;
+
+	s->dataPtr = s->origDataPtr + FT2_MAX_TAPS * 2;
+	s->length = len;
+	s->flags = FT2_SAMPLE_16BIT;
+	ft2_fix_sample(s);
+	return true;
+}
+
+#define TRIM_SMP_LEN 2000
+
+bool ft2_test_setup_trim_module(ft2_instance_t *inst)
+{
+	inst->replayer.song.numChannels = 32;
+	if (!ft2_pattern_set_stride(inst, 32))
+		return false;
+
+	inst->replayer.song.songLength = 128;
+	for (int32_t i = 0; i < 128; i++)
+		inst->replayer.song.orders[i] = (uint8_t)(i * 2);
+
+	for (int32_t i = 1; i <= 128; i++) {
+		if (!ft2_instance_alloc_instr(inst, (int16_t)i))
+			return false;
+
+		ft2_instr_t *ins = inst->replayer.instr[i];
+		for (int32_t j = 0; j < 4; j++) {
+			const int32_t bps = (j & 1) ? 2 : 1;
+			ft2_sample_t *s = &ins->smp[j];
+			s->origDataPtr = (int8_t *)calloc(1, (size_t)TRIM_SMP_LEN * bps + FT2_MAX_TAPS * bps * 2);
+			if (s->origDataPtr == NULL)
+				return false;
+
+			s->dataPtr = s->origDataPtr + FT2_MAX_TAPS * bps;
+			s->length = TRIM_SMP_LEN;
+			s->flags = (uint8_t)(((j == 2) ? FT2_LOOP_FWD : FT2_LOOP_OFF) | ((j & 1) ? FT2_SAMPLE_16BIT : 0));
+			s->loopStart = (j == 2) ? TRIM_SMP_LEN / 4 : 0;
+			s->loopLength = (j == 2) ? TRIM_SMP_LEN / 4 : 0;
+			ft2_fix_sample(s);
+		}
+		for (int32_t j = 0; j < 96; j++)
+			ins->note2SampleLUT[j] = (uint8_t)(j % 3);
+	}
+
+	for (int32_t p = 0; p < 256; p++) {
+		inst->replayer.patternNumRows[p] = 256;
+		if (!ft2_pattern_alloc(inst, (uint16_t)p))
+			return false;
+
+		for (int32_t row = 0; row < 256; row++) {
+			for (int32_t ch = 0; ch < 22; ch++) {
+				ft2_note_t *n = ft2_pattern_note(inst, (uint16_t)p, row, ch);
+				if ((row + ch) & 1)
+					continue;
+				n->note = (uint8_t)(1 + ((row + ch + p) % 96));
+				n->instr = (uint8_t)(1 + ((row * 7 + ch + p) % 96));
+				n->vol = (row & 2) ? 0x30 : 0;
+				n->efx = (uint8_t)((ch == 3) ? 0x0A : 0);
+				n->efxData = (uint8_t)((ch == 3) ? 0x0F : 0);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool ft2_test_setup_undo_sample(ft2_instance_t *inst, int32_t len)
+{
+	if (!ft2_instance_alloc_instr(inst, 1))
+		return false;
+
+	ft2_sample_t *s = &inst->replayer.instr[1]->smp[0];
+	s->origDataPtr = (int8_t *)calloc(1, (size_t)len * 2 + FT2_MAX_TAPS * 2 * 2);
+	if (s->origDataPtr == NULL)
+		return false;
+
+	s->dataPtr = s->origDataPtr + FT2_MAX_TAPS * 2;
+	s->length = len;
+	s->flags = FT2_SAMPLE_16BIT | 1;
+	s->loopStart = len / 4;
+	s->loopLength = len / 2;
+
+	uint32_t seed = 0x2468ACEu;
+	for (int32_t i = 0; i < len; i++) {
+		seed = seed * 1103515245u + 12345u;
+		((int16_t *)s->dataPtr)[i] = (int16_t)(sin(i * 0.003) * 20000.0 + (int32_t)(seed >> 20) - 2048);
+	}
+
+	ft2_fix_sample(s);
+	return true;
+}
+
+void ft2_test_negate_range(ft2_sample_t *s, int32_t x1, int32_t x2)
+{
+	ft2_unfix_sample(s);
+	int16_t *ptr16 = (int16_t *)s->dataPtr;
+	for (int32_t i = x1; i < x2; i++)
+		ptr16[i] = (ptr16[i] == INT16_MIN) ? INT16_MAX : (int16_t)-ptr16[i];
+	ft2_fix_sample(s);
+}
+
+bool ft2_test_delete_range(ft2_sample_t *s, int32_t x1, int32_t x2)
+{
+	const int32_t newLength = s->length - (x2 - x1);
+	int8_t *origDataPtr = (int8_t *)calloc(1, (size_t)newLength * 2 + FT2_MAX_TAPS * 2 * 2);
+	if (origDataPtr == NULL)
+		return false;
+
+	ft2_unfix_sample(s);
+	int16_t *dst = (int16_t *)(origDataPtr + FT2_MAX_TAPS * 2);
+	const int16_t *src = (const int16_t *)s->dataPtr;
+	memcpy(dst, src, (size_t)x1 * 2);
+	memcpy(dst + x1, src + x2, (size_t)(s->length - x2) * 2);
+
+	ft2_sample_pool_release(s->origDataPtr);
+	s->origDataPtr = origDataPtr;
+	s->dataPtr = (int8_t *)dst;
+	s->length = newLength;
+	s->loopStart = 0;
+	s->loopLength = newLength;
+	ft2_fix_sample(s);
+	return true;
+}
+
+void ft2_test_fill_output(float *p, uint32_t n, uint32_t seed)
+{
+	static const float specials[] = { -0.0f, 0.0f, 1.0f, -1.0f, 1.0000001f, -1.0000001f, 2.7027028f, -2.7027028f };
+	for (uint32_t i = 0; i < n; i++) {
+		seed = (seed * 134775813) + 1;
+		if ((seed >> 28) == 0)
+			p[i] = specials[(seed >> 8) & 7];
+		else
+			p[i] = (float)(int32_t)seed * (3.0f / 2147483648.0f);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                               References                                  */
+/* ------------------------------------------------------------------------- */
+
+void ft2_test_scale_clamp(float *dst, const float *src, float mul, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		float out = src[i] * mul;
+		if (out < -1.0f) out = -1.0f;
+		else if (out > 1.0f) out = 1.0f;
+		dst[i] = out;
+	}
+}
+
+void ft2_test_sum_scale_clamp(float *dst, float *const *srcs, int32_t numSrcs, float mul, uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		float sum = 0.0f;
+		for (int32_t s = 0; s < numSrcs; s++)
+			sum += srcs[s][i];
+
+		float out = sum * mul;
+		if (out < -1.0f) out = -1.0f;
+		else if (out > 1.0f) out = 1.0f;
+		dst[i] = out;
+	}
+}
+
+/* The echo as the editor used to make it: every tap summed per sample */
+void ft2_test_echo_by_taps(const int8_t *src, int32_t srcLen, int8_t *dst, int32_t dstLen, bool sample16Bit,
+	int32_t distance, double volChange, int32_t numTaps)
+{
+	for (int32_t n = 0; n < dstLen; n++) {
+		double dSmpOut = 0.0, dSmpMul = 1.0;
+		int32_t echoRead = n, echoCycle = numTaps;
+
+		while (echoCycle > 0) {
+			if (echoRead >= 0 && echoRead < srcLen)
+				dSmpOut += (sample16Bit ? ((const int16_t *)src)[echoRead] : src[echoRead]) * dSmpMul;
+			dSmpMul *= volChange;
+			echoRead -= distance;
+			if (echoRead < 0)
+				break;
+			echoCycle--;
+		}
+
+		int32_t smp32 = (int32_t)dSmpOut;
+		if (sample16Bit) {
+			smp32 = (smp32 < -32768) ? -32768 : ((smp32 > 32767) ? 32767 : smp32);
+			((int16_t *)dst)[n] = (int16_t)smp32;
+		} else {
+			smp32 = (smp32 < -128) ? -128 : ((smp32 > 127) ? 127 : smp32);
+			dst[n] = (int8_t)smp32;
+		}
+	}
+}
+
+/* The filters and EQ as the editor used to run them, one sample at a time */
+void ft2_test_smpfx_by_loop(const smpfx_params_t *p, const int8_t *src, int8_t *dst, int32_t len, bool sample16Bit)
+{
+	const int32_t lo = sample16Bit ? -32768 : -128, hi = sample16Bit ? 32767 : 127;
+	double inTmp[2] = { 0.0, 0.0 }, outTmp[2] = { 0.0, 0.0 };
+
+	if (p->op == SMPFX_OP_AMP) {
+		for (int32_t i = 0; i < len; i++) {
+			const int32_t x = sample16Bit ? ((const int16_t *)src)[i] : src[i];
+			int32_t sample = ((int64_t)x * p->ampMul) >> 22;
+			sample = (sample < lo) ? lo : ((sample > hi) ? hi : sample);
+			if (sample16Bit)
+				((int16_t *)dst)[i] = (int16_t)sample;
+			else
+				dst[i] = (int8_t)sample;
+		}
+		return;
+	}
+
+	double *dSmp = (double *)malloc((size_t)len * sizeof(double));
+	if (dSmp == NULL)
+		return;
+
+	double peak = 0.0;
+	for (int32_t i = 0; i < len; i++) {
+		const double x = sample16Bit ? ((const int16_t *)src)[i] : src[i];
+		double out = p->a1 * x + p->a2 * inTmp[0] + p->a3 * inTmp[1] - p->b1 * outTmp[0] - p->b2 * outTmp[1];
+		inTmp[1] = inTmp[0]; inTmp[0] = x;
+		outTmp[1] = outTmp[0]; outTmp[0] = out;
+		if (fabs(out) > peak)
+			peak = fabs(out);
+
+		if (p->op == SMPFX_OP_MIX_FILTERED)
+			out = x + out * p->mix;
+		dSmp[i] = out;
+	}
+
+	const bool normalize = p->op == SMPFX_OP_FILTER && p->normalize;
+	const double scale = (normalize && peak > 0.0) ? hi / peak : 1.0;
+	for (int32_t i = 0; i < len; i++) {
+		double out = dSmp[i] * scale;
+		if (normalize && peak == 0.0)
+			out = sample16Bit ? ((const int16_t *)src)[i] : src[i];
+
+		const int32_t sample = (out < lo) ? lo : ((out > hi) ? hi : (int32_t)out);
+		if (sample16Bit)
+			((int16_t *)dst)[i] = (int16_t)sample;
+		else
+			dst[i] = (int8_t)sample;
+	}
+
+	free(dSmp);
+}
@@ -24,8 +24,8 @@
 #include "ft2_scopes.h"
 #include "ft2_scopedraw.h"
 
-static volatile bool scopesUpdatingFlag, scopesDisplayingFlag;
 static hpc_t scopeHpc;
+static SDL_mutex *scopeMutex; // held while the scopes are updated or drawn (never freed, the scope thread is detached)
 static volatile scope_t scope[MAX_CHANNELS];
 static SDL_Thread *scopeThread;
 
@@ -54,15 +54,14 @@ int32_t getSamplePositionFromScopes(uint8_t ch)
 
 void stopAllScopes(void)
 {
-	// wait for scopes to finish updating
-	while (scopesUpdatingFlag);
-	
+	// waits (sleeping) for the scopes to finish updating or drawing, so no sample pointers are in use after this
+	SDL_LockMutex(scopeMutex);
+
 	volatile scope_t *sc = scope;
 	for (int32_t i = 0; i < MAX_CHANNELS; i++, sc++)
 		sc->active = false;
 
-	// wait for scope displaying to be done (safety)
-	while (scopesDisplayingFlag);
+	SDL_UnlockMutex(scopeMutex);
 }
 
 // toggle mute
@@ -343,7 +342,7 @@ static void scopeTrigger(int32_t ch, const sample_t *s, int32_t playOffset)
 
 static void updateScopes(void)
 {
-	scopesUpdatingFlag = true;
+	SDL_LockMutex(scopeMutex);
 
 	volatile scope_t *sc = scope;
 	for (int32_t i = 0; i < song.numChannels; i++, sc++)
@@ -397,12 +396,12 @@ static void updateScopes(void)
 
 		*sc = s; // set new scope state
 	}
-	scopesUpdatingFlag = false;
+	SDL_UnlockMutex(scopeMutex);
 }
 
 void drawScopes(void)
 {
-	scopesDisplayingFlag = true;
+	SDL_LockMutex(scopeMutex);
 	int32_t chansPerRow = (uint32_t)song.numChannels >> 1;
 
 	const uint16_t *scopeLens = scopeLenTab[chansPerRow-1];
@@ -436,7 +435,7 @@ void drawScopes(void)
 			// clear scope background
 			clearRect(scopeXOffs, scopeYOffs, scopeDrawLen, SCOPE_HEIGHT);
 
-			// draw scope
+			// draw scope (stays within the rows clearRect() marked for upload)
 			bool linedScopesFlag = !!(config.specialFlags & LINED_SCOPES);
 			scopeDrawRoutineTable[(linedScopesFlag * 6) + (s.sample16Bit * 3) + s.loopType]((const scope_t *)&s, scopeXOffs, scopeLineY, scopeDrawLen);
 		}
@@ -467,7 +466,7 @@ void drawScopes(void)
 		scopeXOffs += scopeDrawLen+3; // align x to next scope
 	}
 
-	scopesDisplayingFlag = false;
+	SDL_UnlockMutex(scopeMutex);
 }
 
 void drawScopeFramework(void)
@@ -529,10 +528,7 @@ static int32_t SDLCALL scopeThreadFunc(void *ptr)
 
 	while (editor.programRunning)
 	{
-		editor.scopeThreadBusy = true;
 		updateScopes();
-		editor.scopeThreadBusy = false;
-
 		hpc_Wait(&scopeHpc);
 	}
 
@@ -542,6 +538,13 @@ static int32_t SDLCALL scopeThreadFunc(void *ptr)
 
 bool initScopes(void)
 {
+	scopeMutex = SDL_CreateMutex();
+	if (scopeMutex == NULL)
+	{
+		showErrorMsgBox("Couldn't create channel scope mutex!");
+		return false;
+	}
+
 	scopeThread = SDL_CreateThread(scopeThreadFunc, NULL, NULL);
 	if (scopeThread == NULL)
 	{
@@ -0,0 +1,55 @@
+/**
+ * @file ft2_audio_dither_test.c
+ * @brief The standalone's 16-bit output (ft2_audio_dither.h): the
+ * SSE2/NEON path against the scalar loop.
+ *
+ * Blocks of every length up to 67, then odd-length ones, with the dither
+ * state carried from block to block. The samples and the dither state must
+ * come out the same, and the mixing buffers must be cleared.
+ */
+
+#include <string.h>
+#include "ft2_test.h"
+#include "ft2_audio_dither.h"
+
+#define DITHER_BLOCK 1021
+#define DITHER_BLOCKS 2000
+
+int main(void)
+{
+	const float mul = 0.37f * 32768.0f; /* Some clip at either end */
+	static float mixL[2][DITHER_BLOCK], mixR[2][DITHER_BLOCK];
+	static int16_t out[2][DITHER_BLOCK * 2];
+	dither_t dither[2] = { { 0x12345000, 0.0f, 0.0f }, { 0x12345000, 0.0f, 0.0f } };
+	uint64_t hash = FT2_TEST_HASH_INIT;
+	int32_t firstDiff = -1, firstStateDiff = -1, firstUncleared = -1;
+
+	for (int32_t b = 0; b < DITHER_BLOCKS; b++) {
+		const uint32_t n = (b < 68) ? (uint32_t)b : DITHER_BLOCK;
+		ft2_test_fill_output(mixL[0], n, 0x5678u + (uint32_t)b);
+		ft2_test_fill_output(mixR[0], n, 0x9ABCu + (uint32_t)b);
+		memcpy(mixL[1], mixL[0], n * sizeof(float));
+		memcpy(mixR[1], mixR[0], n * sizeof(float));
+
+		ditherStereo16Scalar(out[0], mixL[0], mixR[0], 0, n, mul, &dither[0]);
+		ditherStereo16(out[1], mixL[1], mixR[1], n, mul, &dither[1]);
+
+		if (firstDiff < 0 && memcmp(out[0], out[1], n * 2 * sizeof(int16_t)) != 0)
+			firstDiff = b;
+		if (firstStateDiff < 0 && memcmp(&dither[0], &dither[1], sizeof(dither_t)) != 0)
+			firstStateDiff = b;
+		for (uint32_t i = 0; i < n && firstUncleared < 0; i++) {
+			if (mixL[1][i] != 0.0f || mixR[1][i] != 0.0f)
+				firstUncleared = b;
+		}
+
+		hash = ft2_test_hash(hash, out[1], n * 2 * sizeof(int16_t));
+	}
+
+	FT2_TEST_CHECK(firstDiff < 0, "samples differ from the scalar loop from block %d", firstDiff);
+	FT2_TEST_CHECK(firstStateDiff < 0, "dither state differs from block %d", firstStateDiff);
+	FT2_TEST_CHECK(firstUncleared < 0, "mixing buffers not cleared in block %d", firstUncleared);
+	ft2_test_check_hash("output:dither16", hash);
+
+	return ft2_test_finish("audio_dither");
+}
@@ -0,0 +1,112 @@
+/**
+ * @file ft2_frame_upload_test.c
+ * @brief The standalone's frame upload tracking (ft2_frame_upload.h).
+ *
+ * A synthetic frame buffer drawn to the way the GUI draws (every write marks
+ * its rows) and handed to flipFrame()'s change check frame by frame. The
+ * first frame and forced frames upload whole, frames with no drawing or with
+ * the same pixels redrawn (the playback time, a sprite drawn and erased) are
+ * skipped without touching the last frame, and a change uploads just the
+ * rows it is in. The uploaded/skipped counters must add up to the frames.
+ */
+
+#include "ft2_test.h"
+#include "ft2_frame_upload.h"
+
+#define FRAME_W 632
+#define FRAME_H 400
+#define FRAME_COUNT 600
+
+static uint32_t frame[FRAME_W * FRAME_H], lastFrame[FRAME_W * FRAME_H];
+static frameUpload_t upload;
+
+/* A filled rectangle, marked the way clearRect()/fillRect() mark */
+static void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+	frameUploadMarkRows(&upload, y, h);
+	for (int32_t i = 0; i < h; i++) {
+		for (int32_t j = 0; j < w; j++)
+			frame[((y + i) * FRAME_W) + x + j] = color;
+	}
+}
+
+static bool flip(int32_t *y1, int32_t *y2)
+{
+	return frameUploadGetChangedRows(&upload, frame, lastFrame, FRAME_W, FRAME_H, y1, y2);
+}
+
+static void testSingleFrames(void)
+{
+	int32_t y1 = -1, y2 = -1;
+
+	frameUploadInit(&upload);
+	drawRect(0, 0, FRAME_W, FRAME_H, 0x000000);
+	FT2_TEST_CHECK(flip(&y1, &y2) && y1 == 0 && y2 == FRAME_H - 1, "first frame: rows %d..%d uploaded", y1, y2);
+
+	/* Nothing drawn: skipped, and the last frame left alone */
+	lastFrame[0] = 0x123456;
+	FT2_TEST_CHECK(!flip(&y1, &y2), "no drawing: uploaded");
+	FT2_TEST_CHECK(lastFrame[0] == 0x123456, "no drawing: last frame written to");
+	lastFrame[0] = frame[0];
+
+	/* The same pixels redrawn */
+	drawRect(10, 20, 100, 8, 0x000000);
+	FT2_TEST_CHECK(!flip(&y1, &y2), "same pixels redrawn: uploaded");
+
+	/* One pixel changed in a larger marked area */
+	frameUploadMarkRows(&upload, 50, 100);
+	frame[(97 * FRAME_W) + 300] = 0xFFFFFF;
+	FT2_TEST_CHECK(flip(&y1, &y2) && y1 == 97 && y2 == 97, "one pixel: rows %d..%d uploaded", y1, y2);
+	FT2_TEST_CHECK(lastFrame[(97 * FRAME_W) + 300] == 0xFFFFFF, "one pixel: last frame not updated");
+
+	/* A sprite drawn and erased again before the flip */
+	drawRect(200, 150, 16, 16, 0xFF00FF);
+	drawRect(200, 150, 16, 16, 0x000000);
+	frame[(97 * FRAME_W) + 300] = 0xFFFFFF;
+	FT2_TEST_CHECK(!flip(&y1, &y2), "sprite drawn and erased: uploaded");
+
+	/* Marks past the edges are clamped */
+	frameUploadMarkRows(&upload, -20, 30);
+	frameUploadMarkRows(&upload, FRAME_H - 5, 40);
+	frame[0] = frame[(FRAME_H * FRAME_W) - 1] = 0x00FF00;
+	FT2_TEST_CHECK(flip(&y1, &y2) && y1 == 0 && y2 == FRAME_H - 1, "edges: rows %d..%d uploaded", y1, y2);
+	FT2_TEST_CHECK(!flip(&y1, &y2), "edges: uploaded again");
+
+	/* Forced (window exposed), with nothing drawn */
+	upload.forceUpload = true;
+	FT2_TEST_CHECK(flip(&y1, &y2) && y1 == 0 && y2 == FRAME_H - 1, "forced: rows %d..%d uploaded", y1, y2);
+
+	FT2_TEST_CHECK(upload.uploaded == 4 && upload.skipped == 4, "single frames: %llu uploaded, %llu skipped",
+		(unsigned long long)upload.uploaded, (unsigned long long)upload.skipped);
+}
+
+/* Idle playback: the time redrawn the same every frame, and a new second
+ * shown every 60 frames */
+static void testPlayback(void)
+{
+	int32_t y1, y2, wrongRows = 0;
+
+	frameUploadInit(&upload);
+	flip(&y1, &y2);
+
+	for (int32_t i = 0; i < FRAME_COUNT; i++) {
+		drawRect(235, 80, 40, 8, 0x000000);
+		drawRect(235, 80, 8 + ((i / 60) % 32), 8, 0xFFFFFF);
+
+		if (flip(&y1, &y2) && (y1 != 80 || y2 != 87))
+			wrongRows++;
+	}
+
+	const uint64_t uploads = FRAME_COUNT / 60;
+	FT2_TEST_CHECK(upload.uploaded == 1 + uploads && upload.skipped == FRAME_COUNT - uploads,
+		"playback: %llu uploaded, %llu skipped", (unsigned long long)upload.uploaded,
+		(unsigned long long)upload.skipped);
+	FT2_TEST_CHECK(wrongRows == 0, "playback: %d uploads outside the time's rows", wrongRows);
+}
+
+int main(void)
+{
+	testSingleFrames();
+	testPlayback();
+	return ft2_test_finish("frame_upload");
+}
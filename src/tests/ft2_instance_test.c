@@ -0,0 +1,169 @@
+/**
+ * @file ft2_instance_test.c
+ * @brief Whole-instance rendering (ft2_instance.c).
+ *
+ * Each corpus module rendered for two seconds in 1024-frame blocks, to the
+ * stereo and to the multi-out buffers, against the golden hashes. Instances
+ * with nothing to play (stopped, or playing an empty song) must put out
+ * silence and say so; an idle instance must be mixed again from the block
+ * a note comes in and skipped again once the note is over.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ft2_test.h"
+#include "ft2_plugin_loader.h"
+
+#define RENDER_FREQ 48000
+#define RENDER_BLOCK_SIZE 1024
+#define RENDER_SECONDS 2.0
+#define IDLE_INSTANCES 64
+#define IDLE_BLOCK_SIZE 512
+#define IDLE_BLOCKS 200
+
+static float outL[RENDER_BLOCK_SIZE], outR[RENDER_BLOCK_SIZE];
+
+static bool outputIsZero(uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++) {
+		if (outL[i] != 0.0f || outR[i] != 0.0f)
+			return false;
+	}
+	return true;
+}
+
+static void testRender(int32_t file, bool multiOut)
+{
+	const char *name = ft2_test_corpus_name(file);
+	const char *mode = multiOut ? "multiout" : "stereo";
+	uint32_t fileSize = 0;
+	uint8_t *fileData = ft2_test_read_corpus(file, &fileSize);
+	ft2_instance_t *inst = ft2_instance_create(RENDER_FREQ);
+	if (!FT2_TEST_CHECK(fileData != NULL && inst != NULL && ft2_load_module(inst, fileData, fileSize) &&
+		(!multiOut || ft2_instance_set_multiout(inst, true, RENDER_BLOCK_SIZE)), "%s %s: can't set up", name, mode)) {
+		ft2_instance_destroy(inst);
+		free(fileData);
+		return;
+	}
+
+	const uint32_t numBlocks = (uint32_t)((RENDER_SECONDS * RENDER_FREQ) / RENDER_BLOCK_SIZE) + 1;
+	uint64_t hash = FT2_TEST_HASH_INIT;
+
+	ft2_instance_play(inst, FT2_PLAYMODE_SONG, 0);
+	for (uint32_t b = 0; b < numBlocks; b++) {
+		if (multiOut) {
+			ft2_instance_render_multiout(inst, outL, outR, RENDER_BLOCK_SIZE);
+			for (int32_t ch = 0; ch < inst->replayer.song.numChannels; ch++) {
+				if (inst->audio.fChannelBufferL[ch] != NULL) {
+					hash = ft2_test_hash_floats(hash, inst->audio.fChannelBufferL[ch], RENDER_BLOCK_SIZE);
+					hash = ft2_test_hash_floats(hash, inst->audio.fChannelBufferR[ch], RENDER_BLOCK_SIZE);
+				}
+			}
+		} else {
+			ft2_instance_render(inst, outL, outR, RENDER_BLOCK_SIZE);
+		}
+		hash = ft2_test_hash_floats(hash, outL, RENDER_BLOCK_SIZE);
+		hash = ft2_test_hash_floats(hash, outR, RENDER_BLOCK_SIZE);
+	}
+
+	char key[128];
+	snprintf(key, sizeof(key), "render:%s:%u:%u:%s", name, RENDER_FREQ, RENDER_BLOCK_SIZE, mode);
+	ft2_test_check_hash(key, hash);
+
+	ft2_instance_destroy(inst);
+	free(fileData);
+}
+
+static void testIdle(ft2_instance_t **insts, bool playing)
+{
+	const char *name = playing ? "playing empty" : "stopped";
+	int32_t notSilent = 0;
+
+	for (int32_t i = 0; i < IDLE_INSTANCES; i++) {
+		if (playing)
+			ft2_instance_play(insts[i], FT2_PLAYMODE_SONG, 0);
+		else
+			ft2_instance_stop(insts[i]);
+	}
+
+	for (uint32_t b = 0; b < IDLE_BLOCKS; b++) {
+		for (int32_t i = 0; i < IDLE_INSTANCES; i++) {
+			if (playing)
+				ft2_instance_render(insts[i], outL, outR, IDLE_BLOCK_SIZE);
+			else
+				ft2_mix_voices_only(insts[i], outL, outR, IDLE_BLOCK_SIZE);
+
+			if (!insts[i]->audio.outputSilent || !outputIsZero(IDLE_BLOCK_SIZE))
+				notSilent++;
+		}
+	}
+
+	FT2_TEST_CHECK(notSilent == 0, "idle %s: %d instance blocks not silent", name, notSilent);
+}
+
+static void testIdleResume(void)
+{
+	ft2_instance_t *inst = ft2_instance_create(48000);
+	if (!FT2_TEST_CHECK(inst != NULL && ft2_test_setup_mix_instruments(inst), "idle resume: can't set up")) {
+		ft2_instance_destroy(inst);
+		return;
+	}
+
+	for (int32_t b = 0; b < 100; b++)
+		ft2_mix_voices_only(inst, outL, outR, IDLE_BLOCK_SIZE);
+	FT2_TEST_CHECK(inst->audio.outputSilent && outputIsZero(IDLE_BLOCK_SIZE), "idle resume: not idle before the note");
+
+	ft2_instance_trigger_note(inst, 73, 1, 0, 64, 0, 0); /* 8-bit, no loop */
+
+	uint64_t hash = FT2_TEST_HASH_INIT;
+	bool mixedAtOnce = false;
+	int32_t blocksToSound = -1, blocksToSilence = -1;
+	for (int32_t b = 0; b < 4000; b++) {
+		ft2_mix_voices_only(inst, outL, outR, IDLE_BLOCK_SIZE);
+		hash = ft2_test_hash_floats(hash, outL, IDLE_BLOCK_SIZE);
+		hash = ft2_test_hash_floats(hash, outR, IDLE_BLOCK_SIZE);
+
+		if (b == 0)
+			mixedAtOnce = !inst->audio.outputSilent;
+		if (blocksToSound < 0 && !outputIsZero(IDLE_BLOCK_SIZE))
+			blocksToSound = b;
+		if (inst->audio.outputSilent) { /* The sample has run out (no loop) */
+			blocksToSilence = b;
+			break;
+		}
+	}
+
+	/* Audible from the next tick, as the note's volume is set there */
+	const int32_t maxBlocksToSound = (int32_t)(inst->audio.samplesPerTickInt / IDLE_BLOCK_SIZE) + 1;
+	FT2_TEST_CHECK(mixedAtOnce, "idle resume: not mixed in the note's block");
+	FT2_TEST_CHECK(blocksToSound >= 0 && blocksToSound <= maxBlocksToSound,
+		"idle resume: sounded after %d blocks (at most %d)", blocksToSound, maxBlocksToSound);
+	FT2_TEST_CHECK(blocksToSilence > blocksToSound, "idle resume: skipped again after %d blocks", blocksToSilence);
+	ft2_test_check_hash("idle:resume", hash);
+
+	ft2_instance_destroy(inst);
+}
+
+int main(void)
+{
+	for (int32_t i = 0; i < FT2_TEST_CORPUS_FILES; i++) {
+		testRender(i, false);
+		testRender(i, true);
+	}
+
+	ft2_instance_t *insts[IDLE_INSTANCES] = { NULL };
+	bool created = true;
+	for (int32_t i = 0; i < IDLE_INSTANCES && created; i++) {
+		insts[i] = ft2_instance_create(48000);
+		created = insts[i] != NULL;
+	}
+	if (FT2_TEST_CHECK(created, "idle: can't create %d instances", IDLE_INSTANCES)) {
+		testIdle(insts, false);
+		testIdle(insts, true);
+	}
+	for (int32_t i = 0; i < IDLE_INSTANCES; i++)
+		ft2_instance_destroy(insts[i]);
+
+	testIdleResume();
+	return ft2_test_finish("instance");
+}
@@ -0,0 +1,141 @@
+/**
+ * @file ft2_midi_events_test.c
+ * @brief The standalone's MIDI input queue and timing (ft2_midi_events.h).
+ *
+ * A synthetic event stream against audio callbacks on a jittery clock that
+ * play events the way playMidiEvents() and the callback's mixing loop do.
+ * Every event must play once, in order, in the first buffer whose window
+ * holds it, at the sample it came in at (or at 0 if it is late), and the
+ * queue must be drained up to the window's end. Now and then the MIDI
+ * thread stalls for a buffer and a half, so events come in a buffer late
+ * or more, and once the audio stops for three buffers, which must restart
+ * the window. A full queue must drop what doesn't fit.
+ */
+
+#include "ft2_test.h"
+#include "ft2_midi_events.h"
+
+#define MIDI_FREQ 48000
+#define MIDI_BUFFER 512
+#define MIDI_PERF_FREQ 1e9 /* A nanosecond performance counter */
+#define MIDI_CALLBACKS 4000
+#define MIDI_MAX_EVENTS (MIDI_CALLBACKS * 8)
+
+static uint64_t timestamp[MIDI_MAX_EVENTS], delivery[MIDI_MAX_EVENTS];
+static midiEventQueue_t queue;
+
+static void testStream(void)
+{
+	const double bufferNs = MIDI_BUFFER * MIDI_PERF_FREQ / MIDI_FREQ;
+	const uint64_t t0 = 1000000000000ULL;
+	uint32_t seed = 0x4D494449u;
+
+	/* Bursts of up to four events within a few microseconds, a few per buffer */
+	int32_t numEvents = 0;
+	uint64_t t = t0 + (uint64_t)bufferNs, stallEnd = 0;
+	const uint64_t lastTime = t0 + (uint64_t)((MIDI_CALLBACKS - 8) * bufferNs);
+	while (numEvents < MIDI_MAX_EVENTS && t < lastTime) {
+		seed = seed * 1103515245u + 12345u;
+		t += ((seed >> 16) & 3) ? (uint64_t)((seed >> 8) % (uint32_t)(bufferNs / 2)) : (seed >> 20);
+
+		if (t >= stallEnd && (seed & 0xFF) == 0)
+			stallEnd = t + (uint64_t)(bufferNs * 1.5);
+
+		timestamp[numEvents] = t;
+		delivery[numEvents] = (t < stallEnd) ? stallEnd : t;
+		numEvents++;
+	}
+
+	midiEventWindow_t w = { 0, 0 };
+	uint64_t hash = FT2_TEST_HASH_INIT;
+	int32_t pushed = 0, played = 0, dropped = 0, outOfOrder = 0, misplaced = 0, leftBehind = 0;
+	int32_t lateByBuffer = 0, windowResets = 0;
+
+	for (int32_t k = 0; k < MIDI_CALLBACKS; k++) {
+		seed = seed * 1103515245u + 12345u;
+		const double jitter = ((double)(seed >> 8) / (1 << 24) - 0.5) * bufferNs * 0.5;
+		const double gap = (k >= MIDI_CALLBACKS / 2) ? bufferNs * 3.0 : 0.0;
+		const uint64_t timeNow = t0 + (uint64_t)(k * bufferNs + gap + jitter);
+
+		/* What the MIDI thread has queued by now */
+		while (pushed < numEvents && delivery[pushed] <= timeNow) {
+			midiEvent_t e;
+			e.timestamp = timestamp[pushed];
+			e.byte[0] = 0x90;
+			e.byte[1] = (uint8_t)(pushed & 0x7F);
+			e.byte[2] = 64;
+			if (!midiEventQueuePush(&queue, &e))
+				dropped++;
+			pushed++;
+		}
+
+		const uint64_t prevEnd = w.end;
+		midiEventWindowAdvance(&w, timeNow, MIDI_BUFFER, MIDI_FREQ, MIDI_PERF_FREQ);
+		if (k > 0 && w.start != prevEnd)
+			windowResets++;
+
+		int32_t bufferPosition = 0, samplesLeft = MIDI_BUFFER, offset;
+		while (samplesLeft > 0) {
+			while ((offset = midiEventOffset(&queue, &w, MIDI_FREQ, MIDI_PERF_FREQ)) >= 0 && offset <= bufferPosition) {
+				const midiEvent_t *e = midiEventQueuePeek(&queue);
+				const bool isLate = e->timestamp <= w.start;
+				const double exact = isLate ? 0.0 : (double)(e->timestamp - w.start) * MIDI_FREQ / MIDI_PERF_FREQ;
+
+				if (played >= numEvents || e->timestamp != timestamp[played] || e->byte[1] != (played & 0x7F))
+					outOfOrder++;
+				if (bufferPosition != (int32_t)exact || bufferPosition >= MIDI_BUFFER)
+					misplaced++;
+				if (isLate && w.start - e->timestamp >= (uint64_t)bufferNs)
+					lateByBuffer++;
+
+				hash = ft2_test_hash(hash, &k, sizeof(k));
+				hash = ft2_test_hash(hash, &bufferPosition, sizeof(bufferPosition));
+				midiEventQueuePop(&queue);
+				played++;
+			}
+
+			/* Mix up to the next event */
+			int32_t samplesToMix = samplesLeft;
+			offset = midiEventOffset(&queue, &w, MIDI_FREQ, MIDI_PERF_FREQ);
+			if (offset > bufferPosition && offset - bufferPosition < samplesToMix)
+				samplesToMix = offset - bufferPosition;
+
+			bufferPosition += samplesToMix;
+			samplesLeft -= samplesToMix;
+		}
+
+		/* Nothing left behind that this window holds */
+		const midiEvent_t *next = midiEventQueuePeek(&queue);
+		if (next != NULL && next->timestamp < w.end)
+			leftBehind++;
+	}
+
+	FT2_TEST_CHECK(dropped == 0, "stream: %d events dropped", dropped);
+	FT2_TEST_CHECK(played == numEvents, "stream: %d of %d events played", played, numEvents);
+	FT2_TEST_CHECK(outOfOrder == 0, "stream: %d events out of order", outOfOrder);
+	FT2_TEST_CHECK(misplaced == 0, "stream: %d events at the wrong sample", misplaced);
+	FT2_TEST_CHECK(leftBehind == 0, "stream: events left behind in %d buffers", leftBehind);
+	FT2_TEST_CHECK(windowResets == 1, "stream: window restarted %d times", windowResets);
+	FT2_TEST_CHECK(lateByBuffer > 0, "stream: no event came in a buffer late");
+	ft2_test_check_hash("midi:stream", hash);
+}
+
+static void testFullQueue(void)
+{
+	int32_t accepted = 0;
+	for (int32_t i = 0; i < MIDI_EVENT_QUEUE_LEN + 8; i++) {
+		midiEvent_t e = { (uint64_t)i, { 0x90, 60, 64 } };
+		accepted += midiEventQueuePush(&queue, &e) ? 1 : 0;
+	}
+	FT2_TEST_CHECK(accepted == MIDI_EVENT_QUEUE_LEN, "full queue: %d events accepted", accepted);
+
+	while (midiEventQueuePeek(&queue) != NULL)
+		midiEventQueuePop(&queue);
+}
+
+int main(void)
+{
+	testStream();
+	testFullQueue();
+	return ft2_test_finish("midi_events");
+}